@@ -0,0 +1,539 @@
+/*
+ * can_trace.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <strings.h>
+#include <time.h>
+
+// C++ libraries
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Programmer libraries
+#include "can_trace.hpp"
+#include "Live_logger.h"
+
+namespace can_trace {
+
+static_assert(sizeof(tCANCaptureRecord) == 20, "Capture record of the firmware");
+static_assert(sizeof(tLiveLogBlock) == LIVE_LOG_BLOCK_SIZE, "Block of the firmware");
+
+static const char *MONTHS[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+static const char *WEEKDAYS[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+
+
+uint16_t crc16(const uint8_t *data, size_t length){
+
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < length; i++){
+
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++){
+
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+Format format_of(const std::string &path){
+
+    size_t dot = path.rfind('.');
+    std::string extension = (dot == std::string::npos) ? "" : path.substr(dot + 1);
+
+    if (strcasecmp(extension.c_str(), "log") == 0){
+
+        return Format::CANDUMP;
+    }else if (strcasecmp(extension.c_str(), "asc") == 0){
+
+        return Format::ASC;
+    }else if (strcasecmp(extension.c_str(), "bin") == 0){
+
+        return Format::CAPTURE;
+    }
+
+    return Format::UNKNOWN;
+}
+
+static int hex_value(char c){
+
+    if ((c >= '0') && (c <= '9')){
+
+        return c - '0';
+    }
+    c = (char)tolower((unsigned char)c);
+    if ((c >= 'a') && (c <= 'f')){
+
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
+
+// "(seconds.micro) interface ID#data [T|R]"
+static bool parse_candump(const char *line, Frame &frame, bool &skip){
+
+    unsigned long long seconds = 0, micro = 0;
+    int used = 0, digits;
+    const char *p;
+
+    skip = false;
+    if (sscanf(line, " (%llu.%n", &seconds, &used) != 1){
+
+        return false;
+    }
+    p = line + used;
+    for (digits = 0; isdigit((unsigned char)*p); p++, digits++){
+
+        if (digits < 6){
+
+            micro = micro*10 + (unsigned long long)(*p - '0');
+        }
+    }
+    for (; digits < 6; digits++){
+
+        micro *= 10;
+    }
+    if ((*p++ != ')') || (*p != ' ')){
+
+        return false;
+    }
+    while (*p == ' '){
+
+        p++;
+    }
+    while ((*p != ' ') && (*p != '\0')){
+
+        p++;
+    }
+    while (*p == ' '){
+
+        p++;
+    }
+
+    frame = Frame();
+    frame.time_us = seconds*1000000 + micro;
+    const char *ID_start = p;
+    for (; hex_value(*p) >= 0; p++){
+
+        frame.ID = (frame.ID << 4) | (uint32_t)hex_value(*p);
+    }
+    if ((*p != '#') || (p == ID_start) || (p - ID_start > 8)){
+
+        return false;
+    }
+    frame.extended = (p - ID_start) > 3;
+    p++;
+    // Remote and CAN FD frames are not used by the device
+    if ((*p == 'R') || (*p == '#')){
+
+        skip = true;
+        return true;
+    }
+    while ((frame.length < 8) && (hex_value(p[0]) >= 0) && (hex_value(p[1]) >= 0)){
+
+        frame.data[frame.length++] = (uint8_t)((hex_value(p[0]) << 4) | hex_value(p[1]));
+        p += 2;
+    }
+    if ((*p != '\0') && (*p != '\n') && (*p != '\r') && (*p != ' ')){
+
+        return false;
+    }
+    while (*p == ' '){
+
+        p++;
+    }
+    frame.tx = (*p == 'T');
+
+    return true;
+}
+
+bool read_candump(const std::string &path, std::vector<Frame> &frames, ReadStats &stats){
+
+    FILE *file = fopen(path.c_str(), "r");
+    char line[512];
+
+    if (file == nullptr){
+
+        perror(path.c_str());
+        return false;
+    }
+    while (fgets(line, sizeof(line), file) != nullptr){
+
+        Frame frame;
+        bool skip;
+
+        stats.lines++;
+        if ((line[0] == '\n') || (line[0] == '#')){
+
+            stats.skipped++;
+        }else if (!parse_candump(line, frame, skip)){
+
+            stats.errors++;
+        }else if (skip){
+
+            stats.skipped++;
+        }else {
+
+            frames.push_back(frame);
+            stats.frames++;
+        }
+    }
+    fclose(file);
+
+    return true;
+}
+
+bool write_candump(const std::string &path, const std::vector<Frame> &frames, const std::string &interface){
+
+    FILE *file = fopen(path.c_str(), "w");
+    bool written = true;
+
+    if (file == nullptr){
+
+        perror(path.c_str());
+        return false;
+    }
+    for (const Frame &frame : frames){
+
+        char data[17];
+
+        for (int i = 0; i < frame.length; i++){
+
+            snprintf(data + 2*i, 3, "%02X", frame.data[i]);
+        }
+        data[2*frame.length] = '\0';
+        written = written && (fprintf(file, frame.extended ? "(%010llu.%06llu) %s %08X#%s%s\n" : "(%010llu.%06llu) %s %03X#%s%s\n",
+                                      (unsigned long long)(frame.time_us/1000000), (unsigned long long)(frame.time_us % 1000000),
+                                      interface.c_str(), frame.ID, data, frame.tx ? " T" : "") > 0);
+    }
+
+    return (fclose(file) == 0) && written;
+}
+
+// "date Thu Oct 19 10:00:00.000 am 2026" (the am/pm and the ms are not always there)
+static bool parse_asc_date(const char *line, uint64_t &base_us){
+
+    char weekday[8], month[8], time_text[32], field[8];
+    int day, year = 0, hour = 0, minute = 0, second = 0, ms = 0;
+    struct tm date;
+
+    if (sscanf(line, "date %7s %7s %d %31s %7s %d", weekday, month, &day, time_text, field, &year) == 6){
+
+        if ((strcasecmp(field, "pm") == 0) || (strcasecmp(field, "am") == 0)){
+
+            sscanf(time_text, "%d:%d:%d.%d", &hour, &minute, &second, &ms);
+            hour = (hour % 12) + ((strcasecmp(field, "pm") == 0) ? 12 : 0);
+        }else {
+
+            return false;
+        }
+    }else if (sscanf(line, "date %7s %7s %d %31s %d", weekday, month, &day, time_text, &year) == 5){
+
+        sscanf(time_text, "%d:%d:%d.%d", &hour, &minute, &second, &ms);
+    }else {
+
+        return false;
+    }
+
+    memset(&date, 0, sizeof(date));
+    date.tm_mon = -1;
+    for (int m = 0; m < 12; m++){
+
+        if (strcasecmp(month, MONTHS[m]) == 0){
+
+            date.tm_mon = m;
+        }
+    }
+    if (date.tm_mon < 0){
+
+        return false;
+    }
+    date.tm_year = year - 1900;
+    date.tm_mday = day;
+    date.tm_hour = hour;
+    date.tm_min = minute;
+    date.tm_sec = second;
+    base_us = (uint64_t)timegm(&date)*1000000 + (uint64_t)ms*1000;
+
+    return true;
+}
+
+// "time channel ID Rx|Tx d length bytes" (the rest of the events are skipped)
+static bool parse_asc_frame(const char *line, bool hex_IDs, Frame &frame, double &time_s){
+
+    char ID_text[16], direction[4], type[4];
+    int channel, length, used = 0;
+    const char *p;
+    char *end;
+
+    if ((sscanf(line, " %lf %d %15s %3s %3s %d%n", &time_s, &channel, ID_text, direction, type, &length, &used) != 6)
+            || (strcmp(type, "d") != 0) || (length < 0) || (length > 8)
+            || ((strcasecmp(direction, "Rx") != 0) && (strcasecmp(direction, "Tx") != 0))){
+
+        return false;
+    }
+
+    frame = Frame();
+    frame.ID = (uint32_t)strtoul(ID_text, &end, hex_IDs ? 16 : 10);
+    frame.extended = ((*end == 'x') || (*end == 'X'));
+    if ((end == ID_text) || ((*end != '\0') && (!frame.extended))){
+
+        return false;
+    }
+    frame.tx = (strcasecmp(direction, "Tx") == 0);
+    p = line + used;
+    for (int i = 0; i < length; i++){
+
+        unsigned value;
+        int byte_chars = 0;
+
+        if (sscanf(p, " %2x%n", &value, &byte_chars) != 1){
+
+            return false;
+        }
+        frame.data[frame.length++] = (uint8_t)value;
+        p += byte_chars;
+    }
+
+    return true;
+}
+
+bool read_asc(const std::string &path, std::vector<Frame> &frames, ReadStats &stats){
+
+    FILE *file = fopen(path.c_str(), "r");
+    char line[512];
+    uint64_t base_us = 0;
+    bool hex_IDs = true, relative = false;
+    double last_s = 0;
+
+    if (file == nullptr){
+
+        perror(path.c_str());
+        return false;
+    }
+    while (fgets(line, sizeof(line), file) != nullptr){
+
+        Frame frame;
+        double time_s;
+
+        stats.lines++;
+        if (strncmp(line, "date ", 5) == 0){
+
+            if (!parse_asc_date(line, base_us)){
+
+                stats.errors++;
+            }
+            continue;
+        }
+        if (strncmp(line, "base ", 5) == 0){
+
+            hex_IDs = (strstr(line, "base hex") != nullptr);
+            relative = (strstr(line, "timestamps relative") != nullptr);
+            continue;
+        }
+        if (!parse_asc_frame(line, hex_IDs, frame, time_s)){
+
+            stats.skipped++;
+            continue;
+        }
+        if (relative){
+
+            time_s += last_s;
+        }
+        last_s = time_s;
+        frame.time_us = base_us + (uint64_t)llround(time_s*1e6);
+        frames.push_back(frame);
+        stats.frames++;
+    }
+    fclose(file);
+
+    return true;
+}
+
+static void format_asc_date(uint64_t time_us, char text[], size_t size){
+
+    time_t seconds = (time_t)(time_us/1000000);
+    struct tm date;
+    int hour;
+
+    gmtime_r(&seconds, &date);
+    hour = (date.tm_hour % 12 == 0) ? 12 : date.tm_hour % 12;
+    snprintf(text, size, "%s %s %d %02d:%02d:%02d.%03d %s %d", WEEKDAYS[date.tm_wday], MONTHS[date.tm_mon],
+             date.tm_mday, hour, date.tm_min, date.tm_sec, (int)((time_us/1000) % 1000),
+             (date.tm_hour < 12) ? "am" : "pm", date.tm_year + 1900);
+}
+
+// The date of the header is the first frame (ms), the times are from it
+bool write_asc(const std::string &path, const std::vector<Frame> &frames){
+
+    FILE *file = fopen(path.c_str(), "w");
+    uint64_t base_us = frames.empty() ? 0 : frames.front().time_us/1000*1000;
+    char date[64];
+    bool written;
+
+    if (file == nullptr){
+
+        perror(path.c_str());
+        return false;
+    }
+    format_asc_date(base_us, date, sizeof(date));
+    written = fprintf(file, "date %s\nbase hex  timestamps absolute\ninternal events logged\n"
+                            "// version 9.0.0\nBegin Triggerblock %s\n   0.000000 Start of measurement\n", date, date) > 0;
+    for (const Frame &frame : frames){
+
+        uint64_t time_us = frame.time_us - base_us;
+        char ID_text[16];
+
+        snprintf(ID_text, sizeof(ID_text), frame.extended ? "%Xx" : "%X", frame.ID);
+        written = written && (fprintf(file, "%4llu.%06llu 1  %-15s %s   d %u", (unsigned long long)(time_us/1000000),
+                                      (unsigned long long)(time_us % 1000000), ID_text, frame.tx ? "Tx" : "Rx",
+                                      frame.length) > 0);
+        for (int i = 0; i < frame.length; i++){
+
+            written = written && (fprintf(file, " %02X", frame.data[i]) > 0);
+        }
+        written = written && (fputc('\n', file) != EOF);
+    }
+    written = written && (fprintf(file, "End TriggerBlock\n") > 0);
+
+    return (fclose(file) == 0) && written;
+}
+
+bool read_capture(const std::string &path, std::vector<Frame> &frames, ReadStats &stats, uint64_t base_us){
+
+    FILE *file = fopen(path.c_str(), "rb");
+    tLiveLogBlock block;
+
+    if (file == nullptr){
+
+        perror(path.c_str());
+        return false;
+    }
+    while (fread(&block, sizeof(block), 1, file) == 1){
+
+        const tLiveLogHeader &header = block.capture.header;
+
+        stats.lines++;
+        if ((header.magic == 0) && (header.numRecords == 0)){
+
+            stats.skipped++;        // Preallocated and not written
+            continue;
+        }
+        if ((header.magic != CAN_CAPTURE_MAGIC) || (header.version != CAN_CAPTURE_VERSION)
+                || (header.record_size != sizeof(tCANCaptureRecord)) || (header.numRecords > CAN_CAPTURE_RECORDS_PER_BLOCK)
+                || (crc16((const uint8_t *)block.capture.frames, header.numRecords*sizeof(tCANCaptureRecord)) != header.checksum)){
+
+            stats.errors++;
+            continue;
+        }
+        for (uint16_t r = 0; r < header.numRecords; r++){
+
+            const tCANCaptureRecord &record = block.capture.frames[r];
+            Frame frame = Frame();
+
+            frame.time_us = base_us + (uint64_t)record.time_ms*1000 + record.time_us;
+            frame.ID = record.ID;
+            frame.extended = (record.flags & CAN_CAPTURE_EXTENDED) != 0;
+            frame.tx = (record.flags & CAN_CAPTURE_TX) != 0;
+            frame.length = (record.length > 8) ? 8 : record.length;
+            memcpy(frame.data, record.data, frame.length);
+            frames.push_back(frame);
+            stats.frames++;
+        }
+    }
+    fclose(file);
+
+    return true;
+}
+
+// Blocks like the ones of the device (for the tests and to load a trace on a card)
+bool write_capture(const std::string &path, const std::vector<Frame> &frames, uint64_t base_us){
+
+    FILE *file = fopen(path.c_str(), "wb");
+    tLiveLogBlock block;
+    uint32_t sequence = 0;
+    bool written = true;
+
+    if (file == nullptr){
+
+        perror(path.c_str());
+        return false;
+    }
+    for (size_t first = 0; (written) && (first < frames.size()); first += CAN_CAPTURE_RECORDS_PER_BLOCK){
+
+        uint16_t count = (uint16_t)std::min<size_t>(CAN_CAPTURE_RECORDS_PER_BLOCK, frames.size() - first);
+
+        memset(&block, 0, sizeof(block));
+        for (uint16_t r = 0; r < count; r++){
+
+            const Frame &frame = frames[first + r];
+            tCANCaptureRecord &record = block.capture.frames[r];
+            uint64_t time_us = frame.time_us - base_us;
+
+            record.time_ms = (uint32_t)(time_us/1000);
+            record.time_us = (uint16_t)(time_us % 1000);
+            record.flags = (frame.tx ? CAN_CAPTURE_TX : 0) | (frame.extended ? CAN_CAPTURE_EXTENDED : 0);
+            record.length = frame.length;
+            record.ID = frame.ID;
+            memcpy(record.data, frame.data, frame.length);
+        }
+        block.capture.header.magic = CAN_CAPTURE_MAGIC;
+        block.capture.header.sequence = sequence++;
+        block.capture.header.numRecords = count;
+        block.capture.header.version = CAN_CAPTURE_VERSION;
+        block.capture.header.record_size = sizeof(tCANCaptureRecord);
+        block.capture.header.checksum = crc16((const uint8_t *)block.capture.frames, count*sizeof(tCANCaptureRecord));
+        written = fwrite(&block, sizeof(block), 1, file) == 1;
+    }
+
+    return (fclose(file) == 0) && written;
+}
+
+bool read_trace(const std::string &path, std::vector<Frame> &frames, ReadStats &stats, uint64_t base_us){
+
+    switch (format_of(path)){
+
+    case Format::CANDUMP:
+        return read_candump(path, frames, stats);
+    case Format::ASC:
+        return read_asc(path, frames, stats);
+    case Format::CAPTURE:
+        return read_capture(path, frames, stats, base_us);
+    default:
+        fprintf(stderr, "%s: unknown format (.log, .asc or .bin)\n", path.c_str());
+        return false;
+    }
+}
+
+bool write_trace(const std::string &path, const std::vector<Frame> &frames, uint64_t base_us){
+
+    switch (format_of(path)){
+
+    case Format::CANDUMP:
+        return write_candump(path, frames);
+    case Format::ASC:
+        return write_asc(path, frames);
+    case Format::CAPTURE:
+        return write_capture(path, frames, base_us);
+    default:
+        fprintf(stderr, "%s: unknown format (.log, .asc or .bin)\n", path.c_str());
+        return false;
+    }
+}
+
+} // namespace can_trace
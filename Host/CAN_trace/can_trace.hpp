@@ -0,0 +1,71 @@
+/*
+ * can_trace.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Bus traces in memory and the files they come from or go to:
+ *          candump -l:   "(1697712000.123456) can0 7E8#04410C1AF8000000", " T" after the data
+ *                        if the frame was sent by the device
+ *          Vector ASC:   "   0.123456 1  7E8             Rx   d 8 04 41 0C 1A F8 00 00 00"
+ *                        (times from the date of the header, "x" after an extended ID)
+ *          Captures of the device (CAPTnnnn.BIN, Software/Live_logger.h): the times are from
+ *          the reset of the device, a base time (s) can be added
+ *      The times are kept in microseconds.
+ */
+
+#ifndef CAN_TRACE_HPP_
+#define CAN_TRACE_HPP_
+
+// C++ libraries
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace can_trace {
+
+struct Frame{
+
+    uint64_t time_us;
+    uint32_t ID;
+    bool extended;
+    bool tx;                    // Sent by the device (tester)
+    uint8_t length;
+    uint8_t data[8];
+};
+
+struct ReadStats{
+
+    uint64_t lines = 0;         // Lines or blocks of the file
+    uint64_t frames = 0;
+    uint64_t skipped = 0;       // Events, comments, error frames, empty blocks
+    uint64_t errors = 0;        // Broken lines or blocks with a bad CRC
+};
+
+enum class Format{ CANDUMP, ASC, CAPTURE, UNKNOWN };
+
+// By the extension: .log, .asc, .bin
+Format format_of(const std::string &path);
+
+bool read_candump(const std::string &path, std::vector<Frame> &frames, ReadStats &stats);
+bool write_candump(const std::string &path, const std::vector<Frame> &frames, const std::string &interface = "can0");
+bool read_asc(const std::string &path, std::vector<Frame> &frames, ReadStats &stats);
+bool write_asc(const std::string &path, const std::vector<Frame> &frames);
+bool read_capture(const std::string &path, std::vector<Frame> &frames, ReadStats &stats, uint64_t base_us = 0);
+// The times of the file are from base_us (the reset of the device)
+bool write_capture(const std::string &path, const std::vector<Frame> &frames, uint64_t base_us = 0);
+
+bool read_trace(const std::string &path, std::vector<Frame> &frames, ReadStats &stats, uint64_t base_us = 0);
+bool write_trace(const std::string &path, const std::vector<Frame> &frames, uint64_t base_us = 0);
+
+// CRC-16/CCITT of liveLog_CRC16 (Software/Live_logger.c)
+uint16_t crc16(const uint8_t *data, size_t length);
+
+} // namespace can_trace
+
+#endif /* CAN_TRACE_HPP_ */
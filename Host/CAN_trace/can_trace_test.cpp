@@ -0,0 +1,338 @@
+/*
+ * can_trace_test.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host test of the traces. A session of the device is generated: live data polls to 7DF
+ *      answered by 7E8, 7E9 and an ECU with 29 bit IDs, DTCs and the VIN on multi frame
+ *      responses with the flow control of the tester, negative responses, other frames of the
+ *      car, a multi frame response of 7EA that stops (timeout) and one with a wrong sequence. The
+ *      trace goes through candump, ASC and capture files and must come back the same, and a
+ *      capture block with a bad CRC must be left out. Then it is replayed on the OBD stack and
+ *      the results are compared with the ones of the generation, and the replay speed is
+ *      measured.
+ *
+ *      Build and run (from this folder):
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -I../Log_reader -o can_trace_test can_trace_test.cpp can_trace.cpp obd_stack.cpp
+ *          ./can_trace_test /tmp/trace [polls]
+ */
+
+// C++ libraries
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "can_trace.hpp"
+#include "Live_logger.h"
+#include "obd_pids.hpp"
+#include "obd_stack.hpp"
+#include "replay.hpp"
+
+#define REPLAY_PASSES 20
+#define DTC_READ_EVERY 500          // Polls
+#define BROKEN_EVERY 2000
+#define VIN "1M8GDM9AXKP042788"
+
+static uint32_t state = 0x10C2026;
+
+struct Expected{
+
+    uint64_t live_values = 0;
+    uint64_t DTCs = 0;
+    uint64_t VINs = 0;
+    uint64_t negative = 0;
+    uint64_t timeouts = 0;
+    uint64_t isotp_errors = 0;
+    std::map<uint32_t, double> values;
+};
+
+
+static uint32_t next_random(void){
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state;
+}
+
+static can_trace::Frame make_frame(uint64_t time_us, uint32_t ID, bool tx, std::vector<uint8_t> data, uint8_t padding = 0xAA){
+
+    can_trace::Frame frame = can_trace::Frame();
+
+    frame.time_us = time_us;
+    frame.ID = ID;
+    frame.extended = ID > 0x7FF;
+    frame.tx = tx;
+    frame.length = tx ? (uint8_t)data.size() : 8;
+    for (size_t i = 0; i < 8; i++){
+
+        frame.data[i] = (i < data.size()) ? data[i] : padding;
+    }
+
+    return frame;
+}
+
+// First frame, flow control of the tester and consecutive frames (the last ones can be lost)
+static void add_multiframe(std::vector<can_trace::Frame> &frames, uint64_t &time_us, uint32_t request_ID, uint32_t ECU_ID,
+                           const std::vector<uint8_t> &payload, size_t lost_frames, bool wrong_sequence){
+
+    size_t sent = 6, sequence = 1;
+
+    frames.push_back(make_frame(time_us, ECU_ID, false, {(uint8_t)(0x10 | (payload.size() >> 8)), (uint8_t)payload.size(),
+                                payload[0], payload[1], payload[2], payload[3], payload[4], payload[5]}));
+    time_us += 400;
+    frames.push_back(make_frame(time_us, request_ID, true, {0x30, 0x00, 0x0A, 0, 0, 0, 0, 0}));
+    while (sent < payload.size()){
+
+        std::vector<uint8_t> data = {(uint8_t)(0x20 | ((wrong_sequence ? sequence + 1 : sequence) & 0x0F))};
+        for (size_t i = 0; (i < 7) && (sent < payload.size()); i++){
+
+            data.push_back(payload[sent++]);
+        }
+        time_us += 10000;
+        frames.push_back(make_frame(time_us, ECU_ID, false, data, 0x55));
+        sequence++;
+    }
+    frames.resize(frames.size() - lost_frames);
+    time_us += 1000;
+}
+
+// Polls of the live data every 10 ms with a DTC read and the VIN from time to time
+static std::vector<can_trace::Frame> generate_session(uint64_t polls, Expected &expected){
+
+    std::vector<can_trace::Frame> frames;
+    uint64_t time_us = 1697712000ULL*1000000 + 123456;
+    const uint32_t ECUs[] = {0x7E8, 0x7E9, 0x18DAF110};
+    const std::vector<uint8_t> broken_payload = {0x43, 0x06, 0x01, 0x33, 0x02, 0x44, 0x41, 0x23, 0xC1, 0x00, 0x80, 0x01, 0x12, 0x34};
+
+    for (uint64_t poll = 0; poll < polls; poll++){
+
+        const obd::PIDFormula &formula = obd::PID_formulas[poll % obd::NUM_PID_FORMULAS];
+        bool extended_poll = (poll % 3) == 0;
+
+        frames.push_back(make_frame(time_us, extended_poll ? 0x18DB33F1 : 0x7DF, true, {0x02, 0x01, formula.PID}));
+        time_us += 200 + next_random() % 300;
+        for (uint32_t ECU_ID : ECUs){
+
+            if ((ECU_ID > 0x7FF) != extended_poll){
+
+                continue;
+            }
+            if ((ECU_ID == 0x7E9) && (formula.PID == 0x1F)){
+
+                frames.push_back(make_frame(time_us, ECU_ID, false, {0x03, 0x7F, 0x01, 0x12}));
+                expected.negative++;
+            }else {
+
+                uint8_t A = next_random() & 0xFF, B = next_random() & 0xFF;
+                frames.push_back(make_frame(time_us, ECU_ID, false, {(uint8_t)(formula.two_bytes ? 4 : 3), 0x41, formula.PID, A, B}));
+                expected.values[(ECU_ID << 8) | formula.PID] = obd::decode(formula, A, B);
+                expected.live_values++;
+            }
+            time_us += 300 + next_random() % 400;
+        }
+        if ((next_random() % 20) == 0){
+
+            frames.push_back(make_frame(time_us, 0x3A0, false, {1, 2, 3, 4, 5, 6, 7, 8}));
+        }
+
+        if ((poll % DTC_READ_EVERY) == DTC_READ_EVERY - 1){
+
+            // Mode 03 of 7E0: 5 codes on 12 bytes
+            std::vector<uint8_t> payload = {0x43, 0x05, 0x01, 0x33, 0x02, 0x44, 0x41, 0x23, 0xC1, 0x00, 0x80, 0x01};
+            frames.push_back(make_frame(time_us, 0x7E0, true, {0x01, 0x03, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55}));
+            time_us += 800;
+            add_multiframe(frames, time_us, 0x7E0, 0x7E8, payload, 0, false);
+            expected.DTCs += 5;
+
+            // Mode 09 PID 02
+            payload = {0x49, 0x02, 0x01};
+            payload.insert(payload.end(), VIN, VIN + 17);
+            frames.push_back(make_frame(time_us, 0x7E0, true, {0x02, 0x09, 0x02, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5}));
+            time_us += 800;
+            add_multiframe(frames, time_us, 0x7E0, 0x7E8, payload, 0, false);
+            expected.VINs++;
+        }
+        if ((poll % BROKEN_EVERY) == BROKEN_EVERY/2){
+
+            // 7EA (not polled) stops after the first consecutive frame
+            frames.push_back(make_frame(time_us, 0x7E2, true, {0x01, 0x03, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55}));
+            time_us += 800;
+            add_multiframe(frames, time_us, 0x7E2, 0x7EA, broken_payload, 1, false);
+            expected.timeouts++;
+        }
+        if ((poll % BROKEN_EVERY) == BROKEN_EVERY/2 + 200){
+
+            // Some seconds later, a wrong sequence number
+            frames.push_back(make_frame(time_us, 0x7E2, true, {0x01, 0x03, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55}));
+            time_us += 800;
+            add_multiframe(frames, time_us, 0x7E2, 0x7EA, broken_payload, 1, true);
+            expected.isotp_errors++;
+        }
+        time_us += 10000;
+    }
+
+    return frames;
+}
+
+static bool same_frames(const std::vector<can_trace::Frame> &a, const std::vector<can_trace::Frame> &b){
+
+    if (a.size() != b.size()){
+
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++){
+
+        if ((a[i].time_us != b[i].time_us) || (a[i].ID != b[i].ID) || (a[i].extended != b[i].extended)
+                || (a[i].tx != b[i].tx) || (a[i].length != b[i].length) || (memcmp(a[i].data, b[i].data, a[i].length) != 0)){
+
+            fprintf(stderr, "Frame %zu is not the same\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int check_conversions(const std::string &base, const std::vector<can_trace::Frame> &frames){
+
+    std::vector<can_trace::Frame> candump, asc, capture, broken;
+    can_trace::ReadStats candump_stats, asc_stats, capture_stats, broken_stats;
+    uint64_t base_us = frames.front().time_us/1000000*1000000;
+    std::string capture_path = base + ".bin";
+    int errors = 0;
+
+    if ((!can_trace::write_trace(base + ".log", frames)) || (!can_trace::read_trace(base + ".log", candump, candump_stats))
+            || (!same_frames(frames, candump)) || (candump_stats.errors != 0)){
+
+        fprintf(stderr, "candump is not the same\n");
+        errors++;
+    }
+    if ((!can_trace::write_trace(base + ".asc", candump)) || (!can_trace::read_trace(base + ".asc", asc, asc_stats))
+            || (!same_frames(frames, asc)) || (asc_stats.errors != 0)){
+
+        fprintf(stderr, "ASC is not the same\n");
+        errors++;
+    }
+    if ((!can_trace::write_trace(capture_path, asc, base_us)) || (!can_trace::read_trace(capture_path, capture, capture_stats, base_us))
+            || (!same_frames(frames, capture)) || (capture_stats.errors != 0)){
+
+        fprintf(stderr, "The capture is not the same\n");
+        errors++;
+    }
+
+    // A bit changed on the third block: its records are left out
+    FILE *file = fopen(capture_path.c_str(), "r+b");
+    uint8_t byte;
+    if ((file == nullptr) || (fseek(file, 2*512 + 100, SEEK_SET) != 0) || (fread(&byte, 1, 1, file) != 1)
+            || (fseek(file, 2*512 + 100, SEEK_SET) != 0) || (fputc(byte ^ 0x04, file) == EOF) || (fclose(file) != 0)){
+
+        perror(capture_path.c_str());
+        return errors + 1;
+    }
+    can_trace::read_trace(capture_path, broken, broken_stats, base_us);
+    if ((broken_stats.errors != 1) || (broken.size() != frames.size() - CAN_CAPTURE_RECORDS_PER_BLOCK)
+            || (broken[2*CAN_CAPTURE_RECORDS_PER_BLOCK].time_us != frames[3*CAN_CAPTURE_RECORDS_PER_BLOCK].time_us)){
+
+        fprintf(stderr, "The bad block of the capture is taken\n");
+        errors++;
+    }
+    printf("Conversions: %zu frames through candump, ASC and %llu capture blocks\n", frames.size(),
+           (unsigned long long)capture_stats.lines);
+
+    return errors;
+}
+
+static int check_replay(const std::vector<can_trace::Frame> &frames, const Expected &expected){
+
+    can_trace::ObdStack stack;
+    can_trace::ReplayStats replay = can_trace::replay_trace(frames, stack);
+    const can_trace::StackStats &stats = stack.stats();
+    int errors = 0;
+
+    if ((stats.live_values != expected.live_values) || (stats.DTCs != expected.DTCs) || (stats.VINs != expected.VINs)
+            || (stats.negative != expected.negative) || (stats.isotp_timeouts != expected.timeouts)
+            || (stats.isotp_errors != expected.isotp_errors)){
+
+        fprintf(stderr, "Replay: %llu/%llu values, %llu/%llu DTCs, %llu/%llu VINs, %llu/%llu negative, "
+                        "%llu/%llu timeouts, %llu/%llu ISO-TP errors\n",
+                (unsigned long long)stats.live_values, (unsigned long long)expected.live_values,
+                (unsigned long long)stats.DTCs, (unsigned long long)expected.DTCs,
+                (unsigned long long)stats.VINs, (unsigned long long)expected.VINs,
+                (unsigned long long)stats.negative, (unsigned long long)expected.negative,
+                (unsigned long long)stats.isotp_timeouts, (unsigned long long)expected.timeouts,
+                (unsigned long long)stats.isotp_errors, (unsigned long long)expected.isotp_errors);
+        errors++;
+    }
+    if ((stats.requests == 0) || (stats.answered != stats.requests)){
+
+        fprintf(stderr, "Replay: %llu of %llu requests answered\n", (unsigned long long)stats.answered,
+                (unsigned long long)stats.requests);
+        errors++;
+    }
+    if ((stack.VINs().size() != 1) || (stack.VINs().at(0x7E8) != VIN) || (stack.DTCs().at(0x7E8).count("P0133") != 1)
+            || (stack.DTCs().at(0x7E8).count("U0100") != 1) || (stack.DTCs().count(0x7EA) != 0)){
+
+        fprintf(stderr, "Replay: the VIN or the DTCs are not right\n");
+        errors++;
+    }
+    for (const auto &value : expected.values){
+
+        if ((stack.values().count(value.first) == 0) || (std::fabs(stack.values().at(value.first) - value.second) > 1e-9)){
+
+            fprintf(stderr, "Replay: last value of %X is not right\n", value.first);
+            errors++;
+            break;
+        }
+    }
+    printf("Replay: %llu responses, %llu live values, latency %.0f us average, %llu us max, %.0fx real time\n",
+           (unsigned long long)stats.messages, (unsigned long long)stats.live_values,
+           (double)stats.latency_sum_us/stats.answered, (unsigned long long)stats.latency_max_us, replay.speedup);
+
+    return errors;
+}
+
+int main(int argc, char *argv[]){
+
+    uint64_t polls = (argc > 2) ? strtoull(argv[2], nullptr, 0) : 100000;
+    Expected expected;
+    std::vector<can_trace::Frame> frames;
+    int errors = 0;
+
+    if (argc < 2){
+
+        fprintf(stderr, "Usage: %s output_base [polls]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    frames = generate_session(polls, expected);
+    errors += check_conversions(argv[1], frames);
+    errors += check_replay(frames, expected);
+
+    // Speed: the trace replayed several times in a row
+    {
+        can_trace::ObdStack stack;
+        can_trace::ReplayStats replay = can_trace::replay_trace(frames, stack, REPLAY_PASSES);
+        printf("Replay of %.0f s of bus: %.1f ms, %.2f M frames/s, %.0fx real time\n", replay.virtual_us/1e6,
+               replay.wall_s*1000, replay.frames/replay.wall_s/1e6, replay.speedup);
+        if (replay.speedup < 100){
+
+            fprintf(stderr, "The replay is not faster than real time\n");
+            errors++;
+        }
+    }
+
+    printf("%s\n", (errors == 0) ? "Traces correct" : "Traces with errors");
+
+    return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,224 @@
+/*
+ * obd_stack.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C++ libraries
+#include <algorithm>
+
+// Programmer libraries
+#include "obd_stack.hpp"
+#include "obd_pids.hpp"
+
+namespace can_trace {
+
+// decode_DTCbytes of the firmware
+static std::string decode_DTC(uint8_t high, uint8_t low){
+
+    static const char DTC_system[] = {'P', 'C', 'B', 'U'};
+    static const char hex_digits[] = "0123456789ABCDEF";
+    char DTC[6];
+
+    DTC[0] = DTC_system[high >> 6];
+    DTC[1] = (char)('0' + ((high >> 4) & 0x03));
+    DTC[2] = hex_digits[high & 0x0F];
+    DTC[3] = hex_digits[low >> 4];
+    DTC[4] = hex_digits[low & 0x0F];
+    DTC[5] = '\0';
+
+    return DTC;
+}
+
+bool ObdStack::is_response(const Frame &frame){
+
+    if (frame.extended){
+
+        return (frame.ID & 0xFFFFFF00UL) == 0x18DAF100UL;
+    }
+
+    return (frame.ID >= 0x7E8) && (frame.ID <= 0x7EF);
+}
+
+bool ObdStack::is_request(const Frame &frame){
+
+    if (frame.extended){
+
+        return (frame.ID == 0x18DB33F1UL) || ((frame.ID & 0xFFFF00FFUL) == 0x18DA00F1UL);
+    }
+
+    return (frame.ID >= 0x7DF) && (frame.ID <= 0x7E7);
+}
+
+void ObdStack::advance(uint64_t now_us){
+
+    for (auto &channel : channels){
+
+        if ((channel.second.receiving) && (now_us > channel.second.last_us + ISOTP_TIMEOUT_US)){
+
+            channel.second.receiving = false;
+            stack_stats.isotp_timeouts++;
+        }
+    }
+}
+
+void ObdStack::on_frame(const Frame &frame){
+
+    stack_stats.frames++;
+    if (is_request(frame)){
+
+        // Flow control of the tester on a multi frame response
+        if ((frame.length > 0) && ((frame.data[0] >> 4) == 3)){
+
+            stack_stats.flow_controls++;
+        }else {
+
+            stack_stats.requests++;
+            request_pending = true;
+            request_us = frame.time_us;
+        }
+        return;
+    }
+    if ((!is_response(frame)) || (frame.length == 0)){
+
+        stack_stats.other++;
+        return;
+    }
+
+    IsoTpChannel &channel = channels[frame.ID];
+    uint8_t type = frame.data[0] >> 4;
+
+    if ((request_pending) && (type <= 1)){
+
+        uint64_t latency = frame.time_us - request_us;
+        request_pending = false;
+        stack_stats.answered++;
+        stack_stats.latency_sum_us += latency;
+        stack_stats.latency_max_us = std::max(stack_stats.latency_max_us, latency);
+    }
+
+    switch (type){
+
+    case 0:
+    {
+        // Single frame
+        uint8_t length = frame.data[0] & 0x0F;
+        if ((length == 0) || (length > frame.length - 1)){
+
+            stack_stats.isotp_errors++;
+            return;
+        }
+        // A single frame in the middle of a multi frame response interrupts it
+        if (channel.receiving){
+
+            stack_stats.isotp_errors++;
+            channel.receiving = false;
+        }
+        on_message(frame.ID, std::vector<uint8_t>(frame.data + 1, frame.data + 1 + length));
+        return;
+    }
+    case 1:
+        // First frame: 12 bits of length and 6 bytes
+        if (channel.receiving){
+
+            stack_stats.isotp_errors++;
+        }
+        channel.receiving = true;
+        channel.expected = (uint16_t)(((frame.data[0] & 0x0F) << 8) | frame.data[1]);
+        channel.next_sequence = 1;
+        channel.last_us = frame.time_us;
+        channel.payload.assign(frame.data + 2, frame.data + std::max<uint8_t>(frame.length, 2));
+        return;
+
+    case 2:
+        // Consecutive frame
+        if ((!channel.receiving) || ((frame.data[0] & 0x0F) != (channel.next_sequence & 0x0F))){
+
+            stack_stats.isotp_errors++;
+            channel.receiving = false;
+            return;
+        }
+        channel.next_sequence++;
+        channel.last_us = frame.time_us;
+        channel.payload.insert(channel.payload.end(), frame.data + 1, frame.data + frame.length);
+        if (channel.payload.size() >= channel.expected){
+
+            channel.payload.resize(channel.expected);
+            channel.receiving = false;
+            on_message(frame.ID, channel.payload);
+        }
+        return;
+
+    default:
+        stack_stats.isotp_errors++;
+        return;
+    }
+}
+
+void ObdStack::on_message(uint32_t ECU_ID, const std::vector<uint8_t> &payload){
+
+    if (payload.empty()){
+
+        stack_stats.isotp_errors++;
+        return;
+    }
+    stack_stats.messages++;
+
+    switch (payload[0]){
+
+    case 0x41:
+        // Live data: 41 PID A [B], the formulas of the device
+        if (payload.size() >= 3){
+
+            const obd::PIDFormula *formula = obd::find_formula(payload[1]);
+            if ((formula != nullptr) && (payload.size() >= (formula->two_bytes ? 4u : 3u))){
+
+                last_values[(ECU_ID << 8) | payload[1]] = obd::decode(*formula, payload[2], formula->two_bytes ? payload[3] : 0);
+                stack_stats.live_values++;
+                return;
+            }
+        }
+        stack_stats.other++;
+        return;
+
+    case 0x43:
+    case 0x47:
+    case 0x4A:
+        // DTCs: number of codes and 2 bytes for every one
+        for (size_t i = 2; (i + 1 < payload.size()) && ((i - 2)/2 < payload[1]); i += 2){
+
+            if ((payload[i] != 0) || (payload[i+1] != 0)){
+
+                ECU_DTCs[ECU_ID].insert(decode_DTC(payload[i], payload[i+1]));
+                stack_stats.DTCs++;
+            }
+        }
+        return;
+
+    case 0x49:
+        // VIN: 49 02 01 and 17 characters
+        if ((payload.size() >= 3 + 17) && (payload[1] == 0x02)){
+
+            ECU_VINs[ECU_ID] = std::string(payload.begin() + 3, payload.begin() + 3 + 17);
+            stack_stats.VINs++;
+            return;
+        }
+        stack_stats.other++;
+        return;
+
+    case 0x7F:
+        stack_stats.negative++;
+        return;
+
+    default:
+        stack_stats.other++;
+        return;
+    }
+}
+
+} // namespace can_trace
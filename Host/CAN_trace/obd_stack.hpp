@@ -0,0 +1,102 @@
+/*
+ * obd_stack.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      OBD stack of the host for the replay of the traces: ISO-TP reassembly of the responses
+ *      of every ECU (single frame, first frame and consecutive frames, with the N_Cr timeout
+ *      on the virtual time) and the services the device uses: live data (mode 01) with the
+ *      formulas of decode_CANdata, DTCs (modes 03, 07 and 0A) like decode_DTCbytes and the VIN
+ *      (mode 09 PID 02). It also measures the time from every request to its first response.
+ */
+
+#ifndef OBD_STACK_HPP_
+#define OBD_STACK_HPP_
+
+// C++ libraries
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "can_trace.hpp"
+
+namespace can_trace {
+
+static const uint64_t ISOTP_TIMEOUT_US = 1000000;      // N_Cr
+
+// Receiver of the frames of a replay, in virtual time
+class FrameSink{
+
+public:
+    virtual ~FrameSink() = default;
+    // Time goes on until now_us (timeouts) without frames
+    virtual void advance(uint64_t now_us) = 0;
+    virtual void on_frame(const Frame &frame) = 0;
+};
+
+struct StackStats{
+
+    uint64_t frames = 0;
+    uint64_t requests = 0;
+    uint64_t flow_controls = 0;
+    uint64_t messages = 0;              // Responses reassembled
+    uint64_t live_values = 0;
+    uint64_t DTCs = 0;
+    uint64_t VINs = 0;
+    uint64_t negative = 0;              // 7F
+    uint64_t other = 0;                 // Other IDs or services
+    uint64_t isotp_errors = 0;          // Wrong sequence or unexpected consecutive frame
+    uint64_t isotp_timeouts = 0;
+    uint64_t answered = 0;              // Requests with a response
+    uint64_t latency_sum_us = 0;
+    uint64_t latency_max_us = 0;
+};
+
+class ObdStack : public FrameSink{
+
+public:
+    void advance(uint64_t now_us) override;
+    void on_frame(const Frame &frame) override;
+
+    const StackStats &stats() const { return stack_stats; }
+    // Last value of every ECU and PID (ECU << 8 | PID)
+    const std::map<uint32_t, double> &values() const { return last_values; }
+    const std::map<uint32_t, std::set<std::string>> &DTCs() const { return ECU_DTCs; }
+    const std::map<uint32_t, std::string> &VINs() const { return ECU_VINs; }
+
+    // Response of an ECU: 7E8-7EF or 18DAF1xx. Request of the tester: 7DF, 7E0-7E7, 18DB33F1, 18DAxxF1
+    static bool is_response(const Frame &frame);
+    static bool is_request(const Frame &frame);
+
+private:
+    struct IsoTpChannel{
+
+        bool receiving = false;
+        uint16_t expected = 0;
+        uint8_t next_sequence = 0;
+        uint64_t last_us = 0;
+        std::vector<uint8_t> payload;
+    };
+
+    void on_message(uint32_t ECU_ID, const std::vector<uint8_t> &payload);
+
+    StackStats stack_stats;
+    std::map<uint32_t, IsoTpChannel> channels;
+    std::map<uint32_t, double> last_values;
+    std::map<uint32_t, std::set<std::string>> ECU_DTCs;
+    std::map<uint32_t, std::string> ECU_VINs;
+    bool request_pending = false;
+    uint64_t request_us = 0;
+};
+
+} // namespace can_trace
+
+#endif /* OBD_STACK_HPP_ */
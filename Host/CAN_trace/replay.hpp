@@ -0,0 +1,77 @@
+/*
+ * replay.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Replay of a trace in virtual time: the clock jumps to the time of every frame instead of
+ *      waiting for it, so the stack sees the same times as on the bus (timeouts, latencies) and
+ *      the replay runs as fast as the stack can take the frames. The trace can be replayed
+ *      several times in a row, every pass after the end of the previous one.
+ */
+
+#ifndef REPLAY_HPP_
+#define REPLAY_HPP_
+
+// C++ libraries
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Programmer libraries
+#include "can_trace.hpp"
+#include "obd_stack.hpp"
+
+namespace can_trace {
+
+struct ReplayStats{
+
+    uint64_t frames = 0;
+    uint64_t virtual_us = 0;        // Time of the bus replayed
+    double wall_s = 0;
+    double speedup = 0;             // Virtual time / wall time
+};
+
+inline ReplayStats replay_trace(const std::vector<Frame> &frames, FrameSink &sink, unsigned passes = 1){
+
+    ReplayStats stats;
+    uint64_t first_us, duration_us, offset_us = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    if (frames.empty()){
+
+        return stats;
+    }
+    first_us = frames.front().time_us;
+    // One ms between the passes, so the times go on growing
+    duration_us = frames.back().time_us - first_us + 1000;
+
+    for (unsigned pass = 0; pass < passes; pass++){
+
+        for (const Frame &frame : frames){
+
+            Frame shifted = frame;
+            shifted.time_us = frame.time_us + offset_us;
+            sink.advance(shifted.time_us);
+            sink.on_frame(shifted);
+            stats.frames++;
+        }
+        offset_us += duration_us;
+    }
+    // The last messages can still time out
+    sink.advance(first_us + offset_us + ISOTP_TIMEOUT_US);
+
+    stats.virtual_us = offset_us;
+    stats.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.speedup = (stats.wall_s > 0) ? (stats.virtual_us/1e6)/stats.wall_s : 0;
+
+    return stats;
+}
+
+} // namespace can_trace
+
+#endif /* REPLAY_HPP_ */
@@ -0,0 +1,108 @@
+/*
+ * trace_tool.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Conversion of traces between candump (.log), Vector ASC (.asc) and the captures of the
+ *      device (.bin), and replay of a trace on the OBD stack in virtual time. The base time
+ *      (s since 1970) is added to the times of a capture, or taken from them when a capture
+ *      is written.
+ *
+ *      Build and run (from this folder):
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -I../Log_reader -o trace_tool trace_tool.cpp can_trace.cpp obd_stack.cpp
+ *          ./trace_tool CAPT0000.BIN convert capture.log 1697712000
+ *          ./trace_tool capture.log convert capture.asc
+ *          ./trace_tool capture.asc replay [passes]
+ */
+
+// C++ libraries
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "can_trace.hpp"
+#include "obd_stack.hpp"
+#include "replay.hpp"
+
+static void print_usage(const char *program){
+
+    fprintf(stderr, "Usage: %s trace convert output [base_s]\n"
+                    "       %s trace replay [passes]\n"
+                    "The format is taken from the extension: .log (candump), .asc or .bin (capture)\n", program, program);
+}
+
+static void print_replay(const can_trace::ObdStack &stack, const can_trace::ReplayStats &replay){
+
+    const can_trace::StackStats &stats = stack.stats();
+
+    printf("%llu frames: %llu requests, %llu flow controls, %llu responses, %llu other\n",
+           (unsigned long long)stats.frames, (unsigned long long)stats.requests,
+           (unsigned long long)stats.flow_controls, (unsigned long long)stats.messages, (unsigned long long)stats.other);
+    printf("%llu live values, %llu DTCs, %llu VINs, %llu negative responses\n", (unsigned long long)stats.live_values,
+           (unsigned long long)stats.DTCs, (unsigned long long)stats.VINs, (unsigned long long)stats.negative);
+    printf("ISO-TP: %llu errors, %llu timeouts\n", (unsigned long long)stats.isotp_errors,
+           (unsigned long long)stats.isotp_timeouts);
+    if (stats.answered > 0){
+
+        printf("Latency of %llu answered requests: %.0f us average, %llu us max\n", (unsigned long long)stats.answered,
+               (double)stats.latency_sum_us/stats.answered, (unsigned long long)stats.latency_max_us);
+    }
+    for (const auto &VIN : stack.VINs()){
+
+        printf("  %X VIN %s\n", VIN.first, VIN.second.c_str());
+    }
+    for (const auto &DTCs : stack.DTCs()){
+
+        printf("  %X DTCs:", DTCs.first);
+        for (const std::string &DTC : DTCs.second){
+
+            printf(" %s", DTC.c_str());
+        }
+        printf("\n");
+    }
+    printf("%.1f s of bus in %.1f ms: %.0fx real time, %.2f M frames/s\n", replay.virtual_us/1e6, replay.wall_s*1000,
+           replay.speedup, replay.frames/replay.wall_s/1e6);
+}
+
+int main(int argc, char *argv[]){
+
+    std::string command = (argc > 2) ? argv[2] : "";
+    std::vector<can_trace::Frame> frames;
+    can_trace::ReadStats stats;
+    uint64_t base_us = 0;
+
+    if ((argc < 3) || ((command != "convert") && (command != "replay")) || ((command == "convert") && (argc < 4))){
+
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if ((command == "convert") && (argc > 4)){
+
+        base_us = strtoull(argv[4], nullptr, 0)*1000000;
+    }
+    if (!can_trace::read_trace(argv[1], frames, stats, base_us)){
+
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "%s: %llu frames, %llu skipped, %llu errors\n", argv[1], (unsigned long long)stats.frames,
+            (unsigned long long)stats.skipped, (unsigned long long)stats.errors);
+
+    if (command == "convert"){
+
+        return can_trace::write_trace(argv[3], frames, base_us) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    can_trace::ObdStack stack;
+    unsigned passes = (argc > 3) ? (unsigned)strtoul(argv[3], nullptr, 0) : 1;
+    can_trace::ReplayStats replay = can_trace::replay_trace(frames, stack, passes);
+    print_replay(stack, replay);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/*
+ * dtc_bench.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host check of the generated DTC dictionary: every description of the TSV file is
+ *      looked up and decompressed with the firmware code (Software/DTC_dictionary.c) and
+ *      compared with the original text. Then the mean lookup latency is measured.
+ *
+ *      Build and run (from this folder, after dtc_gen):
+ *          cc -O2 -Wall -I../../Software -o dtc_bench dtc_bench.c ../../Software/DTC_dictionary.c ../../Software/DTC_dictionary_data.c
+ *          ./dtc_bench dtc_descriptions.tsv
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Programmer libraries
+#include "DTC_dictionary.h"
+
+#define MAX_LINE 512
+#define ROUNDS 2000
+
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *end){
+
+    return (end->tv_sec - start->tv_sec)*1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+int main(int argc, char *argv[]){
+
+    char line[MAX_LINE];
+    char description[MAX_LINE];
+    char *tab;
+    uint16_t key;
+    uint32_t checked = 0, errors = 0;
+    volatile uint32_t found = 0;
+    struct timespec start, end;
+    FILE *file;
+
+    if (argc != 2){
+
+        fprintf(stderr, "Usage: %s descriptions.tsv\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    file = fopen(argv[1], "r");
+    if (file == NULL){
+
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL){
+
+        line[strcspn(line, "\r\n")] = '\0';
+        tab = strchr(line, '\t');
+        if ((line[0] == '#') || (tab == NULL)){
+
+            continue;
+        }
+        *tab = '\0';
+
+        if ((!DTC_code2key(line, &key)) || (!get_DTCdescription(key, description, sizeof(description)))
+                || (strcmp(description, tab+1) != 0)){
+
+            fprintf(stderr, "Mismatch on %s\n", line);
+            errors++;
+        }
+        checked++;
+    }
+    fclose(file);
+
+    // Lookup and decompression on the small buffer used by the firmware
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t round = 0; round < ROUNDS; round++){
+
+        for (uint16_t i = 0; i < DTC_dictionary_numDTCs; i++){
+
+            found += get_DTCdescription(DTC_dictionary_keys[i], description, DTC_DESCRIPTION_MAX_CHARS);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("Checked: %u DTCs, %u errors\n", checked, errors);
+    printf("Lookup + decompression: %.1f ns per DTC (host)\n",
+           elapsed_ns(&start, &end) / ((double)ROUNDS * DTC_dictionary_numDTCs));
+
+    // Only the bisection
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t round = 0; round < ROUNDS; round++){
+
+        for (uint16_t i = 0; i < DTC_dictionary_numDTCs; i++){
+
+            found += (find_DTCkey(DTC_dictionary_keys[i]) >= 0);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("Lookup: %.1f ns per DTC (host)\n",
+           elapsed_ns(&start, &end) / ((double)ROUNDS * DTC_dictionary_numDTCs));
+
+    return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
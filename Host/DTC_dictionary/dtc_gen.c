@@ -0,0 +1,450 @@
+/*
+ * dtc_gen.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host generator of the DTC dictionary of the firmware (Software/DTC_dictionary_data.c).
+ *      It reads a TSV file (code<TAB>description), sorts the codes by their 16 bits key and
+ *      compresses the descriptions with a shared dictionary of the most repeated words.
+ *      The format is described on Software/DTC_dictionary.h.
+ *
+ *      Build and run (from this folder):
+ *          cc -O2 -Wall -o dtc_gen dtc_gen.c
+ *          ./dtc_gen dtc_descriptions.tsv ../../Software/DTC_dictionary_data.c
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Generator configuration
+#define MAX_DTCS 8192
+#define MAX_LINE 512
+#define WORD_CODE 0x80
+#define WORD_ESCAPE 0xFF
+#define MAX_SHORT_WORDS (WORD_ESCAPE - WORD_CODE)     // 1 byte codes
+#define MAX_WORDS (MAX_SHORT_WORDS + 256)               // + 2 bytes codes
+#define MIN_WORD_LENGTH 3
+#define HASH_SIZE 65536                                 // Power of 2
+#define VALUES_PER_LINE 12
+#define BLOCK_BITS 6                                    // DTC_DICTIONARY_BLOCK_BITS
+
+typedef struct{
+
+    uint16_t key;
+    char *description;
+}tDTCEntry;
+
+typedef struct{
+
+    char *word;                 // Word with its trailing space (if any)
+    uint32_t count;
+    int32_t savings;
+    int16_t index;              // Position on the dictionary, -1 if it is not there
+}tWord;
+
+// Global variables
+static tDTCEntry DTCs[MAX_DTCS];
+static uint16_t numDTCs = 0;
+static tWord *words_hash[HASH_SIZE];
+static tWord *candidates[HASH_SIZE];
+static uint32_t numCandidates = 0;
+static tWord *dictionary[MAX_WORDS];
+static uint16_t numWords = 0;
+
+
+static uint32_t hash_word(const char *word, size_t length){
+
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < length; i++){
+
+        hash = (hash ^ (uint8_t)word[i]) * 16777619u;
+    }
+
+    return hash & (HASH_SIZE - 1);
+}
+
+// Return the entry of the word (length chars), created if create is true
+static tWord *find_word(const char *word, size_t length, bool create){
+
+    uint32_t pos = hash_word(word, length);
+
+    while (words_hash[pos] != NULL){
+
+        if ((strlen(words_hash[pos]->word) == length) && (memcmp(words_hash[pos]->word, word, length) == 0)){
+
+            return words_hash[pos];
+        }
+        pos = (pos + 1) & (HASH_SIZE - 1);
+    }
+
+    if (!create){
+
+        return NULL;
+    }
+    if (numCandidates >= (HASH_SIZE / 2)){
+
+        fprintf(stderr, "Too many different words\n");
+        exit(EXIT_FAILURE);
+    }
+
+    words_hash[pos] = calloc(1, sizeof(tWord));
+    words_hash[pos]->word = malloc(length + 1);
+    memcpy(words_hash[pos]->word, word, length);
+    words_hash[pos]->word[length] = '\0';
+    words_hash[pos]->index = -1;
+    candidates[numCandidates++] = words_hash[pos];
+
+    return words_hash[pos];
+}
+
+// Length of the token that starts on text: a word and its trailing space
+static size_t token_length(const char *text){
+
+    size_t length = 0;
+
+    while ((text[length] != '\0') && (text[length] != ' ')){
+
+        length++;
+    }
+    if (text[length] == ' '){
+
+        length++;
+    }
+
+    return length;
+}
+
+static bool code2key(const char *code, uint16_t *key){
+
+    static const char DTC_system[] = "PCBU";
+    const char *system = strchr(DTC_system, code[0]);
+    unsigned int digits;
+
+    if ((code[0] == '\0') || (system == NULL) || (code[1] < '0') || (code[1] > '3') || (strlen(code) != 5)){
+
+        return false;
+    }
+    if (sscanf(code+2, "%3x", &digits) != 1){
+
+        return false;
+    }
+
+    *key = (uint16_t)(((system - DTC_system) << 14) | ((code[1] - '0') << 12) | digits);
+
+    return true;
+}
+
+static int compare_DTCs(const void *a, const void *b){
+
+    return (int)((const tDTCEntry*)a)->key - (int)((const tDTCEntry*)b)->key;
+}
+
+static int compare_savings(const void *a, const void *b){
+
+    int32_t savings_a = (*(tWord * const *)a)->savings;
+    int32_t savings_b = (*(tWord * const *)b)->savings;
+
+    if (savings_a != savings_b){
+
+        return (savings_a < savings_b) ? 1 : -1;
+    }
+
+    return strcmp((*(tWord * const *)a)->word, (*(tWord * const *)b)->word);
+}
+
+static void read_TSV(const char *path){
+
+    FILE *file = fopen(path, "r");
+    char line[MAX_LINE];
+    char *tab, *end;
+    uint16_t key;
+
+    if (file == NULL){
+
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL){
+
+        end = line + strcspn(line, "\r\n");
+        *end = '\0';
+        if ((line[0] == '#') || (line[0] == '\0')){
+
+            continue;
+        }
+
+        tab = strchr(line, '\t');
+        if (tab == NULL){
+
+            fprintf(stderr, "Line without description: %s\n", line);
+            exit(EXIT_FAILURE);
+        }
+        *tab = '\0';
+        if (!code2key(line, &key)){
+
+            fprintf(stderr, "Wrong DTC: %s\n", line);
+            exit(EXIT_FAILURE);
+        }
+        for (const char *c = tab+1; *c != '\0'; c++){
+
+            if ((uint8_t)*c >= WORD_CODE){
+
+                fprintf(stderr, "Only ASCII descriptions (%s)\n", line);
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (numDTCs >= MAX_DTCS){
+
+            fprintf(stderr, "Too many DTCs\n");
+            exit(EXIT_FAILURE);
+        }
+
+        DTCs[numDTCs].key = key;
+        DTCs[numDTCs].description = strdup(tab+1);
+        numDTCs++;
+    }
+    fclose(file);
+
+    qsort(DTCs, numDTCs, sizeof(tDTCEntry), compare_DTCs);
+    for (uint16_t i = 1; i < numDTCs; i++){
+
+        if (DTCs[i].key == DTCs[i-1].key){
+
+            fprintf(stderr, "Repeated DTC: 0x%04X\n", DTCs[i].key);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Choose the words that save more bytes: every use saves its length minus the code,
+// but the word has to be stored once with its offset (2 bytes)
+static void build_dictionary(void){
+
+    const char *text;
+    size_t length;
+
+    for (uint16_t i = 0; i < numDTCs; i++){
+
+        for (text = DTCs[i].description; *text != '\0'; text += length){
+
+            length = token_length(text);
+            if (length >= MIN_WORD_LENGTH){
+
+                find_word(text, length, true)->count++;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < numCandidates; i++){
+
+        length = strlen(candidates[i]->word);
+        candidates[i]->savings = (int32_t)(candidates[i]->count * (length - 1)) - (int32_t)(length + 2);
+    }
+    qsort(candidates, numCandidates, sizeof(tWord*), compare_savings);
+
+    for (uint32_t i = 0; (i < numCandidates) && (numWords < MAX_WORDS); i++){
+
+        length = strlen(candidates[i]->word);
+        // The 2 bytes codes save one byte less per use
+        if ((numWords >= MAX_SHORT_WORDS) && ((int32_t)(candidates[i]->count * (length - 2)) - (int32_t)(length + 2) <= 0)){
+
+            continue;
+        }
+        if (candidates[i]->savings <= 0){
+
+            break;
+        }
+        candidates[i]->index = numWords;
+        dictionary[numWords++] = candidates[i];
+    }
+}
+
+// Compress a description on out, return its size
+static size_t encode_description(const char *text, uint8_t *out){
+
+    size_t size = 0, length;
+    tWord *word;
+
+    for (; *text != '\0'; text += length){
+
+        length = token_length(text);
+        word = find_word(text, length, false);
+
+        if ((word != NULL) && (word->index >= 0)){
+
+            if (word->index < MAX_SHORT_WORDS){
+
+                out[size++] = (uint8_t)(WORD_CODE + word->index);
+            }else {
+
+                out[size++] = WORD_ESCAPE;
+                out[size++] = (uint8_t)(word->index - MAX_SHORT_WORDS);
+            }
+        }else {
+
+            memcpy(out+size, text, length);
+            size += length;
+        }
+    }
+
+    return size;
+}
+
+static void print_values(FILE *file, const char *type, const char *name, const uint32_t *values, size_t numValues){
+
+    fprintf(file, "const %s %s[%u] = {", type, name, (unsigned int)numValues);
+    for (size_t i = 0; i < numValues; i++){
+
+        if ((i % VALUES_PER_LINE) == 0){
+
+            fprintf(file, "%s\n    ", (i > 0) ? "," : "");
+        }else {
+
+            fprintf(file, ", ");
+        }
+        fprintf(file, "0x%02X", values[i]);
+    }
+    fprintf(file, "\n};\n\n");
+}
+
+int main(int argc, char *argv[]){
+
+    static uint8_t text[MAX_DTCS * MAX_LINE];
+    static uint32_t values[MAX_DTCS * MAX_LINE];
+    static uint32_t offsets[MAX_DTCS + 1];
+    size_t text_size = 0, words_size = 0, raw_size = 0, image_size;
+    uint16_t numBlocks;
+    uint16_t comparisons = 0;
+    FILE *file;
+
+    if (argc != 3){
+
+        fprintf(stderr, "Usage: %s descriptions.tsv DTC_dictionary_data.c\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    read_TSV(argv[1]);
+    build_dictionary();
+
+    file = fopen(argv[2], "w");
+    if (file == NULL){
+
+        perror(argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    // Compress all the descriptions before writing to know the sizes
+    for (uint16_t i = 0; i < numDTCs; i++){
+
+        offsets[i] = (uint32_t)text_size;
+        text_size += encode_description(DTCs[i].description, text+text_size);
+        raw_size += strlen(DTCs[i].description) + 1 + sizeof(uint16_t) + sizeof(uint32_t);
+    }
+    offsets[numDTCs] = (uint32_t)text_size;
+    for (uint16_t i = 0; i < numWords; i++){
+
+        words_size += strlen(dictionary[i]->word);
+    }
+    // The end of the last DTC is on the block after it
+    numBlocks = (numDTCs >> BLOCK_BITS) + 1;
+    for (uint16_t i = 0; i <= numDTCs; i++){
+
+        if ((offsets[i] - offsets[i & ~((1u << BLOCK_BITS) - 1)]) > UINT16_MAX){
+
+            fprintf(stderr, "The text of a block does not fit on 16 bits offsets\n");
+            return EXIT_FAILURE;
+        }
+    }
+    if (words_size > UINT16_MAX){
+
+        fprintf(stderr, "The offsets of the words do not fit on 16 bits\n");
+        return EXIT_FAILURE;
+    }
+
+    image_size = numDTCs*sizeof(uint16_t) + numBlocks*sizeof(uint32_t) + (numDTCs+1)*sizeof(uint16_t) + text_size
+               + (numWords+1)*sizeof(uint16_t) + words_size + 1;
+    while ((1u << comparisons) <= numDTCs){
+
+        comparisons++;
+    }
+
+    fprintf(file, "/*\n * DTC_dictionary_data.c\n *\n");
+    fprintf(file, " *      Generated by Host/DTC_dictionary/dtc_gen.c from %s, do not edit it.\n", argv[1]);
+    fprintf(file, " *      %u DTCs, %u words on the dictionary.\n", numDTCs, numWords);
+    fprintf(file, " *      Flash image: %u bytes (plain strings with pointers: %u bytes).\n", (unsigned int)image_size, (unsigned int)raw_size);
+    fprintf(file, " *      Lookup: %u comparisons at most.\n */\n\n", comparisons);
+    fprintf(file, "#include <stdint.h>\n\n#include \"DTC_dictionary.h\"\n\n");
+
+    fprintf(file, "const uint16_t DTC_dictionary_numDTCs = %u;\n\n", numDTCs);
+    for (uint16_t i = 0; i < numBlocks; i++){
+
+        values[i] = offsets[i << BLOCK_BITS];
+    }
+    print_values(file, "uint32_t", "DTC_dictionary_blockOffsets", values, numBlocks);
+    for (uint16_t i = 0; i <= numDTCs; i++){
+
+        values[i] = offsets[i] - offsets[i & ~((1u << BLOCK_BITS) - 1)];
+    }
+    print_values(file, "uint16_t", "DTC_dictionary_offsets", values, numDTCs+1);
+    for (uint16_t i = 0; i < numDTCs; i++){
+
+        values[i] = DTCs[i].key;
+    }
+    print_values(file, "uint16_t", "DTC_dictionary_keys", values, numDTCs);
+    for (size_t i = 0; i < text_size; i++){
+
+        values[i] = text[i];
+    }
+    print_values(file, "uint8_t", "DTC_dictionary_text", values, text_size);
+
+    fprintf(file, "const uint16_t DTC_dictionary_numWords = %u;\n\n", numWords);
+    words_size = 0;
+    for (uint16_t i = 0; i < numWords; i++){
+
+        values[i] = (uint32_t)words_size;
+        words_size += strlen(dictionary[i]->word);
+    }
+    values[numWords] = (uint32_t)words_size;
+    print_values(file, "uint16_t", "DTC_dictionary_wordOffsets", values, numWords+1);
+
+    fprintf(file, "const char DTC_dictionary_words[] =");
+    for (uint16_t i = 0; i < numWords; i++){
+
+        if ((i % 4) == 0){
+
+            fprintf(file, "\n    ");
+        }
+        fprintf(file, "\"");
+        for (const char *c = dictionary[i]->word; *c != '\0'; c++){
+
+            if ((*c == '"') || (*c == '\\')){
+
+                fputc('\\', file);
+            }
+            fputc(*c, file);
+        }
+        fprintf(file, "\"");
+    }
+    fprintf(file, "%s;\n", (numWords == 0) ? " \"\"" : "");
+    fclose(file);
+
+    printf("DTCs: %u\n", numDTCs);
+    printf("Dictionary words: %u (%u bytes)\n", numWords, (unsigned int)words_size);
+    printf("Compressed descriptions: %u bytes\n", (unsigned int)text_size);
+    printf("Flash image: %u bytes (plain strings with pointers: %u bytes, %.1f%%)\n",
+           (unsigned int)image_size, (unsigned int)raw_size, (raw_size > 0) ? (100.0*image_size/raw_size) : 0.0);
+    printf("Lookup: %u comparisons at most\n", comparisons);
+
+    return EXIT_SUCCESS;
+}
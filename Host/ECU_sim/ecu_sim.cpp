@@ -0,0 +1,943 @@
+/*
+ * ecu_sim.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C++ libraries
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// Programmer libraries
+#include "ecu_sim.hpp"
+
+namespace ecu_sim {
+
+// Data bytes of the mode 01 PIDs 00 to 60 (SAE J1979)
+static const uint8_t PID_LENGTHS[] = {
+    4, 4, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1,     // 00
+    2, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2,     // 10
+    4, 2, 2, 2, 4, 4, 4, 4, 4, 4, 4, 4, 1, 1, 1, 1,     // 20
+    1, 2, 2, 1, 4, 4, 4, 4, 4, 4, 4, 4, 2, 2, 2, 2,     // 30
+    4, 4, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 4,     // 40
+    4, 1, 1, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2, 1,     // 50
+    4                                                   // 60
+};
+static const char DTC_LETTERS[] = "PCBU";
+static const uint8_t NRC_SERVICE_NOT_SUPPORTED = 0x11;
+static const uint8_t NRC_OUT_OF_RANGE = 0x31;
+static const uint8_t NRC_RESPONSE_PENDING = 0x78;
+static const size_t CALID_BYTES = 16;
+static const size_t ECU_NAME_BYTES = 20;
+
+
+uint8_t PID_length(uint8_t PID){
+
+    return (PID < sizeof(PID_LENGTHS)) ? PID_LENGTHS[PID] : 0;
+}
+
+uint32_t frame_time_us(uint8_t length, bool extended, uint32_t bitrate){
+
+    // Header, CRC and spaces: 47 bits (11 bit ID) or 67 bits (29 bit ID)
+    uint64_t bits = (extended ? 67 : 47) + 8*(uint64_t)length;
+
+    return (uint32_t)((bits*1000000 + bitrate - 1)/bitrate);
+}
+
+bool encode_DTC(const std::string &code, uint16_t &DTC){
+
+    const char *letter;
+    char *end;
+    unsigned long digits;
+
+    if ((code.size() != 5) || (code[0] == '\0') ||
+        ((letter = strchr(DTC_LETTERS, toupper((unsigned char)code[0]))) == nullptr) ||
+        (code[1] < '0') || (code[1] > '3')){
+
+        return false;
+    }
+    digits = strtoul(code.c_str() + 1, &end, 16);
+    if (*end != '\0'){
+
+        return false;
+    }
+    DTC = (uint16_t)(((letter - DTC_LETTERS) << 14) | digits);
+
+    return true;
+}
+
+std::string decode_DTC(uint16_t DTC){
+
+    char code[6];
+
+    snprintf(code, sizeof(code), "%c%04X", DTC_LETTERS[DTC >> 14], DTC & 0x3FFF);
+
+    return code;
+}
+
+/*****************************************************************************************
+ * Scenario files
+ *****************************************************************************************/
+
+static bool parse_number(const std::string &text, int base, uint32_t &value){
+
+    char *end;
+
+    if (text.empty()){
+
+        return false;
+    }
+    value = (uint32_t)strtoul(text.c_str(), &end, base);
+
+    return (*end == '\0');
+}
+
+static bool parse_probability(const std::string &text, double &value){
+
+    char *end;
+
+    value = strtod(text.c_str(), &end);
+
+    return (!text.empty()) && (*end == '\0') && (value >= 0) && (value <= 1);
+}
+
+// Rest of the line after the keyword, without the spaces at the sides
+static std::string rest_of_line(std::istringstream &tokens){
+
+    std::string text;
+
+    std::getline(tokens, text);
+    text.erase(0, text.find_first_not_of(" \t"));
+    text.erase(text.find_last_not_of(" \t\r") + 1);
+
+    return text;
+}
+
+static bool parse_signal(std::istringstream &tokens, Signal &signal, std::string &error){
+
+    std::string PID, shape, min, max, period;
+    uint32_t value;
+
+    tokens >> PID >> shape >> min >> max >> period;
+    if ((!parse_number(PID, 16, value)) || (value > 0xFF) || (PID_length((uint8_t)value) == 0)){
+
+        error = "unknown PID " + PID;
+        return false;
+    }
+    signal.PID = (uint8_t)value;
+    if ((value & 0x1F) == 0){
+
+        error = "PID " + PID + " is a supported PIDs bitmap";
+        return false;
+    }
+
+    if (shape == "const"){
+
+        signal.shape = Shape::CONSTANT;
+        if (!parse_number(min, 0, signal.min)){
+
+            error = "pid const needs a raw value";
+            return false;
+        }
+        signal.max = signal.min;
+        return true;
+    }
+    if (shape == "ramp"){
+
+        signal.shape = Shape::RAMP;
+    }else if (shape == "sine"){
+
+        signal.shape = Shape::SINE;
+    }else if (shape == "random"){
+
+        signal.shape = Shape::RANDOM;
+    }else {
+
+        error = "unknown shape " + shape;
+        return false;
+    }
+    if ((!parse_number(min, 0, signal.min)) || (!parse_number(max, 0, signal.max)) || (signal.min > signal.max)){
+
+        error = "pid " + shape + " needs MIN <= MAX";
+        return false;
+    }
+    if ((signal.shape != Shape::RANDOM) && ((!parse_number(period, 0, signal.period_ms)) || (signal.period_ms == 0))){
+
+        error = "pid " + shape + " needs a period in ms";
+        return false;
+    }
+
+    return true;
+}
+
+static bool parse_fault(std::istringstream &tokens, Faults &faults, std::string &error){
+
+    std::string kind, probability, argument;
+    double value;
+    uint32_t number = 0;
+
+    tokens >> kind >> probability >> argument;
+    if (!parse_probability(probability, value)){
+
+        error = "fault needs a probability from 0 to 1";
+        return false;
+    }
+    if ((!argument.empty()) && (!parse_number(argument, (kind == "negative") ? 16 : 0, number))){
+
+        error = "bad argument " + argument;
+        return false;
+    }
+
+    if (kind == "silent"){
+
+        faults.silent = value;
+    }else if (kind == "negative"){
+
+        faults.negative = value;
+        if (!argument.empty()){
+
+            faults.negative_code = (uint8_t)number;
+        }
+    }else if (kind == "pending"){
+
+        faults.pending = value;
+        if (!argument.empty()){
+
+            faults.pending_count = (uint8_t)std::min<uint32_t>(std::max<uint32_t>(number, 1), 255);
+        }
+    }else if (kind == "late"){
+
+        faults.late = value;
+        if (!argument.empty()){
+
+            faults.late_us = number;
+        }
+    }else if (kind == "sequence"){
+
+        faults.wrong_sequence = value;
+    }else if (kind == "drop"){
+
+        faults.drop_frame = value;
+    }else {
+
+        error = "unknown fault " + kind;
+        return false;
+    }
+
+    return true;
+}
+
+static bool parse_line(const std::string &line, Scenario &scenario, std::string &error){
+
+    std::istringstream tokens(line);
+    std::string keyword, argument;
+    uint32_t value;
+
+    if (!(tokens >> keyword) || (keyword[0] == '#')){
+
+        return true;
+    }
+
+    if (keyword == "seed"){
+
+        tokens >> argument;
+        if (!parse_number(argument, 0, scenario.seed)){
+
+            error = "seed needs a number";
+            return false;
+        }
+        return true;
+    }
+    if (keyword == "bitrate"){
+
+        tokens >> argument;
+        if ((!parse_number(argument, 0, scenario.bitrate)) || (scenario.bitrate == 0)){
+
+            error = "bitrate needs a number";
+            return false;
+        }
+        return true;
+    }
+    if (keyword == "ecu"){
+
+        EcuConfig ECU;
+        std::string request, response;
+
+        tokens >> ECU.name >> request >> response >> argument;
+        if ((!parse_number(request, 16, ECU.request_ID)) || (!parse_number(response, 16, ECU.response_ID))){
+
+            error = "ecu needs NAME REQUEST_ID RESPONSE_ID";
+            return false;
+        }
+        ECU.extended = (argument == "extended") || (ECU.request_ID > 0x7FF) || (ECU.response_ID > 0x7FF);
+        if ((ECU.request_ID > 0x1FFFFFFF) || (ECU.response_ID > 0x1FFFFFFF)){
+
+            error = "ID out of range";
+            return false;
+        }
+        scenario.ECUs.push_back(ECU);
+        return true;
+    }
+
+    if (scenario.ECUs.empty()){
+
+        error = keyword + " before the first ecu";
+        return false;
+    }
+    EcuConfig &ECU = scenario.ECUs.back();
+
+    if (keyword == "p2"){
+
+        std::string min, max;
+
+        tokens >> min >> max;
+        if ((!parse_number(min, 0, ECU.p2_min_us)) || (!parse_number(max, 0, ECU.p2_max_us)) ||
+            (ECU.p2_min_us > ECU.p2_max_us)){
+
+            error = "p2 needs MIN_US <= MAX_US";
+            return false;
+        }
+    }else if (keyword == "pid"){
+
+        Signal signal;
+
+        if (!parse_signal(tokens, signal, error)){
+
+            return false;
+        }
+        ECU.signals.erase(std::remove_if(ECU.signals.begin(), ECU.signals.end(),
+                                         [&](const Signal &other){ return other.PID == signal.PID; }),
+                          ECU.signals.end());
+        ECU.signals.push_back(signal);
+    }else if (keyword == "dtc"){
+
+        std::string kind, code;
+        std::vector<uint16_t> *list;
+        uint16_t DTC;
+
+        tokens >> kind;
+        if (kind == "stored"){
+
+            list = &ECU.stored;
+        }else if (kind == "pending"){
+
+            list = &ECU.pending;
+        }else if (kind == "permanent"){
+
+            list = &ECU.permanent;
+        }else {
+
+            error = "dtc needs stored, pending or permanent";
+            return false;
+        }
+        while (tokens >> code){
+
+            if (!encode_DTC(code, DTC)){
+
+                error = "bad DTC " + code;
+                return false;
+            }
+            list->push_back(DTC);
+        }
+    }else if (keyword == "freeze"){
+
+        std::string code, pair;
+
+        tokens >> code;
+        if (!encode_DTC(code, ECU.freeze.DTC)){
+
+            error = "bad DTC " + code;
+            return false;
+        }
+        ECU.freeze.valid = true;
+        ECU.freeze.PIDs.clear();
+        while (tokens >> pair){
+
+            size_t equal = pair.find('=');
+            uint32_t raw;
+
+            if ((equal == std::string::npos) || (!parse_number(pair.substr(0, equal), 16, value)) ||
+                (value > 0xFF) || (PID_length((uint8_t)value) == 0) || (!parse_number(pair.substr(equal + 1), 0, raw))){
+
+                error = "freeze needs PID=RAW, not " + pair;
+                return false;
+            }
+            ECU.freeze.PIDs[(uint8_t)value] = raw;
+        }
+    }else if (keyword == "vin"){
+
+        ECU.VIN = rest_of_line(tokens);
+        if (ECU.VIN.size() != 17){
+
+            error = "the VIN has 17 characters";
+            return false;
+        }
+    }else if (keyword == "calid"){
+
+        ECU.calibration = rest_of_line(tokens).substr(0, CALID_BYTES);
+    }else if (keyword == "name"){
+
+        ECU.ECU_name = rest_of_line(tokens).substr(0, ECU_NAME_BYTES);
+    }else if (keyword == "padding"){
+
+        tokens >> argument;
+        if ((!parse_number(argument, 16, value)) || (value > 0xFF)){
+
+            error = "padding needs a byte";
+            return false;
+        }
+        ECU.padding = (uint8_t)value;
+    }else if (keyword == "fault"){
+
+        return parse_fault(tokens, ECU.faults, error);
+    }else {
+
+        error = "unknown setting " + keyword;
+        return false;
+    }
+
+    return true;
+}
+
+bool parse_scenario(std::istream &input, Scenario &scenario, std::string &error){
+
+    std::string line;
+    unsigned number = 0;
+
+    scenario = Scenario();
+    while (std::getline(input, line)){
+
+        number++;
+        if (!parse_line(line, scenario, error)){
+
+            error = "line " + std::to_string(number) + ": " + error;
+            return false;
+        }
+    }
+    if (scenario.ECUs.empty()){
+
+        error = "no ecu";
+        return false;
+    }
+
+    return true;
+}
+
+bool load_scenario(const std::string &path, Scenario &scenario, std::string &error){
+
+    std::ifstream input(path);
+
+    if (!input){
+
+        error = "cannot open " + path;
+        return false;
+    }
+    if (!parse_scenario(input, scenario, error)){
+
+        error = path + ": " + error;
+        return false;
+    }
+
+    return true;
+}
+
+/*****************************************************************************************
+ * Simulator
+ *****************************************************************************************/
+
+Simulator::Simulator(const Scenario &scenario) : bus_bitrate(scenario.bitrate){
+
+    for (size_t i = 0; i < scenario.ECUs.size(); i++){
+
+        Ecu ECU;
+
+        ECU.config = scenario.ECUs[i];
+        // Every ECU has its own draws, so adding an ECU does not change the others
+        ECU.random.seed(scenario.seed*2654435761U + (uint32_t)i);
+        ECUs.push_back(ECU);
+    }
+}
+
+bool Simulator::is_addressed(const Ecu &ECU, const Frame &frame, bool &functional) const{
+
+    if (frame.extended != ECU.config.extended){
+
+        return false;
+    }
+    functional = (frame.ID == (frame.extended ? FUNCTIONAL_EXTENDED_ID : FUNCTIONAL_ID));
+
+    return functional || (frame.ID == ECU.config.request_ID);
+}
+
+bool Simulator::draw(Ecu &ECU, double probability){
+
+    if (probability <= 0){
+
+        return false;
+    }
+
+    return (ECU.random() >> 8)*(1.0/16777216.0) < probability;
+}
+
+uint32_t Simulator::signal_value(Ecu &ECU, const Signal &signal, uint64_t time_us){
+
+    uint64_t period_us = (uint64_t)signal.period_ms*1000;
+    uint32_t span = signal.max - signal.min;
+    double phase;
+
+    switch (signal.shape){
+
+    case Shape::RAMP:
+        return signal.min + (uint32_t)((uint64_t)span*(time_us % period_us)/period_us);
+
+    case Shape::SINE:
+        phase = 2*M_PI*(double)(time_us % period_us)/period_us;
+        return signal.min + (uint32_t)lround(span*(1 - cos(phase))/2);
+
+    case Shape::RANDOM:
+        return signal.min + ((span == 0xFFFFFFFF) ? ECU.random() : ECU.random() % (span + 1));
+
+    default:
+        return signal.min;
+    }
+}
+
+// Bitmap of the PIDs base+1 to base+0x20 on 4 bytes. The last bit says that the next
+// bitmap is supported.
+void Simulator::supported_bitmap(uint8_t base, const std::vector<uint8_t> &PIDs, std::vector<uint8_t> &payload){
+
+    uint32_t bitmap = 0;
+
+    for (uint8_t PID : PIDs){
+
+        if ((PID > base) && (PID - base <= 0x20)){
+
+            bitmap |= 0x80000000U >> (PID - base - 1);
+        }else if (PID - base > 0x20){
+
+            bitmap |= 1;
+        }
+    }
+    payload.push_back((uint8_t)(bitmap >> 24));
+    payload.push_back((uint8_t)(bitmap >> 16));
+    payload.push_back((uint8_t)(bitmap >> 8));
+    payload.push_back((uint8_t)bitmap);
+}
+
+static bool is_supported(uint8_t service){
+
+    return (service == 0x01) || (service == 0x02) || (service == 0x03) || (service == 0x04) ||
+           (service == 0x07) || (service == 0x09) || (service == 0x0A);
+}
+
+static void push_value(uint32_t value, uint8_t bytes, std::vector<uint8_t> &payload){
+
+    for (int i = bytes - 1; i >= 0; i--){
+
+        payload.push_back((uint8_t)(value >> (8*i)));
+    }
+}
+
+static void push_text(const std::string &text, size_t bytes, std::vector<uint8_t> &payload){
+
+    for (size_t i = 0; i < bytes; i++){
+
+        payload.push_back((i < text.size()) ? (uint8_t)text[i] : 0);
+    }
+}
+
+static void push_DTCs(const std::vector<uint16_t> &DTCs, std::vector<uint8_t> &payload){
+
+    payload.push_back((uint8_t)std::min<size_t>(DTCs.size(), 0xFF));
+    for (size_t i = 0; (i < DTCs.size()) && (i < 0xFF); i++){
+
+        push_value(DTCs[i], 2, payload);
+    }
+}
+
+// Positive response of a request on payload (from the service + 0x40). Return false if
+// the ECU has nothing to answer.
+bool Simulator::answer(Ecu &ECU, uint8_t service, const uint8_t parameters[], uint8_t numParameters, uint64_t time_us,
+                       std::vector<uint8_t> &payload){
+
+    EcuConfig &config = ECU.config;
+    std::vector<uint8_t> PIDs;
+
+    payload.assign(1, (uint8_t)(service + 0x40));
+
+    switch (service){
+
+    case 0x01:
+        // Several PIDs per request, the ones not supported are left out
+        PIDs.push_back(0x01);
+        for (const Signal &signal : config.signals){
+
+            PIDs.push_back(signal.PID);
+        }
+        for (uint8_t i = 0; i < numParameters; i++){
+
+            uint8_t PID = parameters[i];
+            auto signal = std::find_if(config.signals.begin(), config.signals.end(),
+                                       [&](const Signal &other){ return other.PID == PID; });
+
+            if ((PID & 0x1F) == 0){
+
+                if ((PID == 0) || (*std::max_element(PIDs.begin(), PIDs.end()) > PID)){
+
+                    payload.push_back(PID);
+                    supported_bitmap(PID, PIDs, payload);
+                }
+            }else if (PID == 0x01){
+
+                // MIL and number of DTCs, then the readiness of the monitors
+                payload.push_back(PID);
+                payload.push_back((uint8_t)((config.stored.empty() ? 0 : 0x80) | std::min<size_t>(config.stored.size(), 0x7F)));
+                payload.push_back(0x07);
+                payload.push_back(0x65);
+                payload.push_back(0x00);
+            }else if (signal != config.signals.end()){
+
+                uint8_t bytes = PID_length(PID);
+                uint32_t value = signal_value(ECU, *signal, time_us);
+
+                if (bytes < 4){
+
+                    value = std::min<uint32_t>(value, (1U << (8*bytes)) - 1);
+                }
+                payload.push_back(PID);
+                push_value(value, bytes, payload);
+            }
+        }
+        return payload.size() > 1;
+
+    case 0x02:
+        // PID and frame number pairs, only the frame 0
+        if (!config.freeze.valid){
+
+            return false;
+        }
+        for (const auto &PID : config.freeze.PIDs){
+
+            PIDs.push_back(PID.first);
+        }
+        PIDs.push_back(0x02);
+        for (uint8_t i = 0; i + 1 < numParameters; i += 2){
+
+            uint8_t PID = parameters[i];
+
+            if (parameters[i+1] != 0){
+
+                continue;
+            }
+            if ((PID & 0x1F) == 0){
+
+                if ((PID == 0) || (*std::max_element(PIDs.begin(), PIDs.end()) > PID)){
+
+                    payload.push_back(PID);
+                    payload.push_back(0);
+                    supported_bitmap(PID, PIDs, payload);
+                }
+            }else if (PID == 0x02){
+
+                payload.push_back(PID);
+                payload.push_back(0);
+                push_value(config.freeze.DTC, 2, payload);
+            }else if (config.freeze.PIDs.count(PID) > 0){
+
+                payload.push_back(PID);
+                payload.push_back(0);
+                push_value(config.freeze.PIDs[PID], PID_length(PID), payload);
+            }
+        }
+        return payload.size() > 1;
+
+    case 0x03:
+        push_DTCs(config.stored, payload);
+        return true;
+
+    case 0x04:
+        // The permanent DTCs stay until the monitors pass again
+        config.stored.clear();
+        config.pending.clear();
+        config.freeze.valid = false;
+        return true;
+
+    case 0x07:
+        push_DTCs(config.pending, payload);
+        return true;
+
+    case 0x0A:
+        push_DTCs(config.permanent, payload);
+        return true;
+
+    case 0x09:
+        if (numParameters < 1){
+
+            return false;
+        }
+        payload.push_back(parameters[0]);
+        switch (parameters[0]){
+
+        case 0x00:
+            PIDs.push_back(config.VIN.empty() ? 0 : 0x02);
+            PIDs.push_back(config.calibration.empty() ? 0 : 0x04);
+            PIDs.push_back(config.ECU_name.empty() ? 0 : 0x0A);
+            supported_bitmap(0, PIDs, payload);
+            return true;
+
+        case 0x02:
+            payload.push_back(1);
+            push_text(config.VIN, config.VIN.size(), payload);
+            return !config.VIN.empty();
+
+        case 0x04:
+            payload.push_back(1);
+            push_text(config.calibration, CALID_BYTES, payload);
+            return !config.calibration.empty();
+
+        case 0x0A:
+            payload.push_back(1);
+            push_text(config.ECU_name, ECU_NAME_BYTES, payload);
+            return !config.ECU_name.empty();
+
+        default:
+            return false;
+        }
+
+    default:
+        return false;
+    }
+}
+
+void Simulator::emit(Ecu &ECU, const uint8_t data[], uint8_t length, uint64_t start_us, std::vector<Frame> &out){
+
+    Frame frame;
+
+    // ISO 15765-4: always 8 bytes, the rest with the padding
+    frame.time_us = start_us;
+    frame.ID = ECU.config.response_ID;
+    frame.extended = ECU.config.extended;
+    frame.length = 8;
+    memset(frame.data, ECU.config.padding, sizeof(frame.data));
+    memcpy(frame.data, data, std::min<uint8_t>(length, 8));
+    out.push_back(frame);
+    sim_stats.frames++;
+}
+
+void Simulator::send_payload(Ecu &ECU, const std::vector<uint8_t> &payload, uint64_t start_us, std::vector<Frame> &out){
+
+    Transmission &transmission = ECU.transmission;
+    uint8_t data[8];
+    size_t numCFs;
+
+    sim_stats.responses++;
+    if (payload.size() <= 7){
+
+        data[0] = (uint8_t)payload.size();
+        std::copy(payload.begin(), payload.end(), data + 1);
+        emit(ECU, data, (uint8_t)(payload.size() + 1), start_us, out);
+        return;
+    }
+
+    // First frame and wait for the flow control of the tester
+    data[0] = (uint8_t)(0x10 | ((payload.size() >> 8) & 0x0F));
+    data[1] = (uint8_t)payload.size();
+    std::copy(payload.begin(), payload.begin() + 6, data + 2);
+    emit(ECU, data, 8, start_us, out);
+
+    transmission = Transmission();
+    transmission.active = true;
+    transmission.waiting_flow_control = true;
+    transmission.payload = payload;
+    transmission.offset = 6;
+    transmission.deadline_us = start_us + frame_time_us(8, ECU.config.extended, bus_bitrate) + N_BS_US;
+
+    numCFs = (payload.size() - 6 + 6)/7;
+    if (draw(ECU, ECU.config.faults.wrong_sequence)){
+
+        transmission.wrong_frame = (int)(ECU.random() % numCFs);
+        sim_stats.faults++;
+    }else if (draw(ECU, ECU.config.faults.drop_frame)){
+
+        transmission.dropped_frame = (int)(ECU.random() % numCFs);
+        sim_stats.faults++;
+    }
+}
+
+// Consecutive frames after a flow control (continue to send) that ended at time_us
+void Simulator::send_consecutive(Ecu &ECU, uint8_t block_size, uint8_t separation, uint64_t time_us, std::vector<Frame> &out){
+
+    Transmission &transmission = ECU.transmission;
+    uint32_t frame_us = frame_time_us(8, ECU.config.extended, bus_bitrate);
+    uint32_t separation_us;
+    uint64_t start_us = time_us + N_CS_US;
+    uint8_t data[8];
+
+    // STmin: 0 to 127 ms, F1 to F9 100 to 900 us, the reserved values as 127 ms
+    if (separation <= 0x7F){
+
+        separation_us = separation*1000U;
+    }else if ((separation >= 0xF1) && (separation <= 0xF9)){
+
+        separation_us = (separation - 0xF0)*100U;
+    }else {
+
+        separation_us = 127000;
+    }
+
+    transmission.waiting_flow_control = false;
+    for (uint8_t sent = 1; transmission.offset < transmission.payload.size(); sent++){
+
+        size_t bytes = std::min<size_t>(7, transmission.payload.size() - transmission.offset);
+        uint8_t sequence = transmission.sequence;
+
+        if ((int)transmission.frames_sent == transmission.wrong_frame){
+
+            sequence++;
+        }
+        data[0] = (uint8_t)(0x20 | (sequence & 0x0F));
+        std::copy(transmission.payload.begin() + transmission.offset,
+                  transmission.payload.begin() + transmission.offset + bytes, data + 1);
+        if ((int)transmission.frames_sent != transmission.dropped_frame){
+
+            emit(ECU, data, (uint8_t)(bytes + 1), start_us, out);
+        }
+        transmission.offset += bytes;
+        transmission.sequence++;
+        transmission.frames_sent++;
+
+        if ((block_size != 0) && (sent == block_size) && (transmission.offset < transmission.payload.size())){
+
+            // Next flow control
+            transmission.waiting_flow_control = true;
+            transmission.deadline_us = start_us + frame_us + N_BS_US;
+            return;
+        }
+        start_us += frame_us + separation_us;
+    }
+    transmission.active = false;
+}
+
+void Simulator::on_frame(const Frame &frame, std::vector<Frame> &out){
+
+    uint8_t type = frame.data[0] >> 4;
+    bool taken = false;
+
+    for (Ecu &ECU : ECUs){
+
+        Transmission &transmission = ECU.transmission;
+        const Faults &faults = ECU.config.faults;
+        std::vector<uint8_t> payload;
+        bool functional;
+        uint64_t start_us;
+
+        // N_Bs: the answer is abandoned without flow control
+        if ((transmission.active) && (transmission.waiting_flow_control) && (frame.time_us > transmission.deadline_us)){
+
+            transmission.active = false;
+            sim_stats.flow_timeouts++;
+        }
+        if ((frame.length == 0) || (!is_addressed(ECU, frame, functional))){
+
+            continue;
+        }
+
+        if (type == 3){
+
+            // Flow control: the tester may send it to the functional ID too
+            if ((!transmission.active) || (!transmission.waiting_flow_control)){
+
+                continue;
+            }
+            taken = true;
+            sim_stats.flow_controls++;
+            switch (frame.data[0] & 0x0F){
+
+            case 0:
+                send_consecutive(ECU, frame.data[1], frame.data[2], frame.time_us, out);
+                break;
+
+            case 1:
+                transmission.deadline_us = frame.time_us + N_BS_US;
+                break;
+
+            default:
+                transmission.active = false;
+                break;
+            }
+            continue;
+        }
+        if ((type != 0) || (frame.data[0] == 0) || (frame.data[0] > frame.length - 1)){
+
+            continue;
+        }
+
+        // Single frame request: a new request ends the answer in progress
+        taken = true;
+        transmission.active = false;
+        sim_stats.requests++;
+        if (draw(ECU, faults.silent)){
+
+            sim_stats.faults++;
+            continue;
+        }
+        start_us = frame.time_us + ECU.config.p2_min_us +
+                   ECU.random() % (ECU.config.p2_max_us - ECU.config.p2_min_us + 1);
+        if (draw(ECU, faults.late)){
+
+            start_us += faults.late_us;
+            sim_stats.faults++;
+        }
+
+        uint8_t service = frame.data[1];
+        uint8_t negative[3] = {0x7F, service, 0};
+
+        if (draw(ECU, faults.negative)){
+
+            negative[2] = faults.negative_code;
+            sim_stats.faults++;
+        }else if (!answer(ECU, service, frame.data + 2, (uint8_t)(frame.data[0] - 1), start_us, payload)){
+
+            // The functional requests that an ECU does not support are not answered
+            if (functional){
+
+                continue;
+            }
+            negative[2] = is_supported(service) ? NRC_OUT_OF_RANGE : NRC_SERVICE_NOT_SUPPORTED;
+        }
+        if (negative[2] != 0){
+
+            payload.assign(negative, negative + 3);
+            sim_stats.negative++;
+        }else if (draw(ECU, faults.pending)){
+
+            uint8_t pending[4] = {3, 0x7F, service, NRC_RESPONSE_PENDING};
+
+            sim_stats.faults++;
+            for (uint8_t i = 0; i < faults.pending_count; i++){
+
+                emit(ECU, pending, sizeof(pending), start_us, out);
+                start_us += PENDING_INTERVAL_US;
+            }
+        }
+        send_payload(ECU, payload, start_us, out);
+    }
+
+    if (!taken){
+
+        sim_stats.ignored++;
+    }
+}
+
+} // namespace ecu_sim
@@ -0,0 +1,203 @@
+/*
+ * ecu_sim.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Simulator of the ECUs of a car on the bus, like the OZEN OE91C1610 the device was
+ *      developed with, but with any number of ECUs (11 and 29 bit IDs):
+ *      - modes 01 (with the supported PIDs bitmaps and several PIDs per request), 02 (freeze
+ *        frame), 03, 04, 07, 09 (VIN, calibration ID, ECU name) and 0A,
+ *      - a P2 response time drawn between a minimum and a maximum for every answer,
+ *      - ISO-TP multi frame answers that wait for the flow control and follow its block size
+ *        and separation time (N_Bs timeout),
+ *      - faults drawn with a probability on every request: no answer, negative response,
+ *        response pending (7F xx 78) before the answer, late answer, wrong sequence number
+ *        and a lost consecutive frame.
+ *      The simulator has no clock: every frame of the tester comes with its time and the
+ *      frames of the ECUs go out with the time they start on the bus, so it runs in virtual
+ *      time as fast as the PC can go. The draws come from the seed of the scenario.
+ */
+
+#ifndef ECU_SIM_HPP_
+#define ECU_SIM_HPP_
+
+// C++ libraries
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ecu_sim {
+
+static const uint32_t FUNCTIONAL_ID = 0x7DF;
+static const uint32_t FUNCTIONAL_EXTENDED_ID = 0x18DB33F1;
+static const uint32_t N_BS_US = 1000000;                // Wait for a flow control
+static const uint32_t N_CS_US = 100;                    // Flow control to the first consecutive frame
+static const uint32_t PENDING_INTERVAL_US = 25000;      // Between the response pending answers
+
+struct Frame{
+
+    uint64_t time_us;           // Tester: end of the frame. ECU: start of the frame.
+    uint32_t ID;
+    bool extended;
+    uint8_t length;
+    uint8_t data[8];
+};
+
+enum class Shape{ CONSTANT, RAMP, SINE, RANDOM };
+
+// Raw value of a mode 01 PID (the bytes A, B... as a number) along the time
+struct Signal{
+
+    uint8_t PID = 0;
+    Shape shape = Shape::CONSTANT;
+    uint32_t min = 0;
+    uint32_t max = 0;
+    uint32_t period_ms = 1000;
+};
+
+struct FreezeFrame{
+
+    bool valid = false;
+    uint16_t DTC = 0;                       // DTC that stored the frame
+    std::map<uint8_t, uint32_t> PIDs;       // Raw values
+};
+
+// Probabilities (0 to 1) drawn on every request
+struct Faults{
+
+    double silent = 0;
+    double negative = 0;
+    uint8_t negative_code = 0x22;           // Conditions not correct
+    double pending = 0;
+    uint8_t pending_count = 1;              // 7F xx 78 before the answer
+    double late = 0;
+    uint32_t late_us = 300000;              // Added to P2
+    double wrong_sequence = 0;              // On a consecutive frame of the answer
+    double drop_frame = 0;                  // A consecutive frame is not sent
+};
+
+struct EcuConfig{
+
+    std::string name;
+    uint32_t request_ID = 0;
+    uint32_t response_ID = 0;
+    bool extended = false;
+    uint32_t p2_min_us = 1000;
+    uint32_t p2_max_us = 10000;
+    uint8_t padding = 0xAA;
+    std::vector<Signal> signals;
+    std::vector<uint16_t> stored;           // Mode 03
+    std::vector<uint16_t> pending;          // Mode 07
+    std::vector<uint16_t> permanent;        // Mode 0A
+    FreezeFrame freeze;
+    std::string VIN;
+    std::string calibration;
+    std::string ECU_name;
+    Faults faults;
+};
+
+struct Scenario{
+
+    uint32_t seed = 1;
+    uint32_t bitrate = 500000;
+    std::vector<EcuConfig> ECUs;
+};
+
+struct SimStats{
+
+    uint64_t requests = 0;                  // Requests taken by an ECU
+    uint64_t responses = 0;                 // Answers (single frame or first frame)
+    uint64_t frames = 0;                    // Frames sent by the ECUs
+    uint64_t flow_controls = 0;
+    uint64_t negative = 0;                  // 7F sent (not the response pending ones)
+    uint64_t faults = 0;                    // Faults injected
+    uint64_t ignored = 0;                   // Frames of the tester nobody took
+    uint64_t flow_timeouts = 0;             // Answers abandoned without flow control
+};
+
+// Scenario files: one setting per line, # for comments. IDs, PIDs and DTC bytes in hex,
+// raw values in decimal or 0x hex:
+//     seed 2026
+//     bitrate 500000
+//     ecu ECM 7E0 7E8 [extended]
+//     p2 MIN_US MAX_US
+//     pid 0C const RAW | ramp MIN MAX PERIOD_MS | sine MIN MAX PERIOD_MS | random MIN MAX
+//     dtc stored|pending|permanent P0133 C0123...
+//     freeze P0133 0C=0x1AF8 0D=88...
+//     vin 1M8GDM9AXKP042788 | calid TEXT | name TEXT
+//     padding 55
+//     fault silent|late|pending|sequence|drop PROBABILITY [late_us|count]
+//     fault negative PROBABILITY [NRC]
+// Every setting after an ecu line belongs to that ECU.
+bool parse_scenario(std::istream &input, Scenario &scenario, std::string &error);
+bool load_scenario(const std::string &path, Scenario &scenario, std::string &error);
+
+// "P0133" to 0x0133 and back (the format of decode_DTCbytes)
+bool encode_DTC(const std::string &code, uint16_t &DTC);
+std::string decode_DTC(uint16_t DTC);
+// Data bytes of a mode 01 PID (SAE J1979), 0 if unknown
+uint8_t PID_length(uint8_t PID);
+// Time of a frame on the bus (without stuff bits)
+uint32_t frame_time_us(uint8_t length, bool extended, uint32_t bitrate);
+
+class Simulator{
+
+public:
+    explicit Simulator(const Scenario &scenario);
+
+    // Frame of the tester, ended at frame.time_us. The answers of the ECUs are appended to out.
+    void on_frame(const Frame &frame, std::vector<Frame> &out);
+
+    const SimStats &stats() const { return sim_stats; }
+    size_t num_ECUs() const { return ECUs.size(); }
+    // The configuration can change between requests (new DTCs, faults...)
+    EcuConfig &config(size_t ECU) { return ECUs[ECU].config; }
+    uint32_t bitrate() const { return bus_bitrate; }
+
+private:
+    struct Transmission{
+
+        bool active = false;
+        bool waiting_flow_control = false;
+        std::vector<uint8_t> payload;
+        size_t offset = 0;                  // Next byte to send
+        uint8_t sequence = 1;
+        uint64_t deadline_us = 0;           // N_Bs
+        int wrong_frame = -1;               // Consecutive frame with a wrong sequence number
+        int dropped_frame = -1;             // Consecutive frame not sent
+        uint32_t frames_sent = 0;
+    };
+
+    struct Ecu{
+
+        EcuConfig config;
+        Transmission transmission;
+        std::mt19937 random;
+    };
+
+    bool is_addressed(const Ecu &ECU, const Frame &frame, bool &functional) const;
+    bool draw(Ecu &ECU, double probability);
+    uint32_t signal_value(Ecu &ECU, const Signal &signal, uint64_t time_us);
+    bool answer(Ecu &ECU, uint8_t service, const uint8_t parameters[], uint8_t numParameters, uint64_t time_us,
+                std::vector<uint8_t> &payload);
+    void supported_bitmap(uint8_t base, const std::vector<uint8_t> &PIDs, std::vector<uint8_t> &payload);
+    void send_payload(Ecu &ECU, const std::vector<uint8_t> &payload, uint64_t start_us, std::vector<Frame> &out);
+    void send_consecutive(Ecu &ECU, uint8_t block_size, uint8_t separation, uint64_t time_us, std::vector<Frame> &out);
+    void emit(Ecu &ECU, const uint8_t data[], uint8_t length, uint64_t start_us, std::vector<Frame> &out);
+
+    std::vector<Ecu> ECUs;
+    uint32_t bus_bitrate;
+    SimStats sim_stats;
+};
+
+} // namespace ecu_sim
+
+#endif /* ECU_SIM_HPP_ */
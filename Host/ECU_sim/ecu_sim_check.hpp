@@ -0,0 +1,65 @@
+/*
+ * ecu_sim_check.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Shared by the host tests that run on the ECUs of the simulator (ecu_sim_test.cpp,
+ *      Host/ELM327_host/elm327_test.cpp and Host/Live_stream/live_stream_test.cpp): the count of
+ *      the failed checks, the parse of a scenario written in the test and the ECM and TCM every
+ *      test starts from. The test adds the PIDs of the ECM after ECU_SIM_CHECK_ECM.
+ */
+
+#ifndef ECU_SIM_CHECK_HPP_
+#define ECU_SIM_CHECK_HPP_
+
+// C++ libraries
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+// Programmer libraries
+#include "ecu_sim.hpp"
+
+#define ECU_SIM_CHECK_ECM \
+    "seed 2026\n" \
+    "ecu ECM 7E0 7E8\n" \
+    "p2 1000 1000\n"
+#define ECU_SIM_CHECK_TCM \
+    "ecu TCM 7E1 7E9\n" \
+    "p2 5000 20000\n" \
+    "pid 0D const 87\n"
+
+inline int failures = 0;
+
+inline void check(bool condition, const char *what){
+
+    if (!condition){
+
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// A wrong scenario ends the test
+inline ecu_sim::Scenario parse(const char *text){
+
+    std::istringstream input(text);
+    ecu_sim::Scenario scenario;
+    std::string error;
+
+    if (!ecu_sim::parse_scenario(input, scenario, error)){
+
+        printf("FAIL: %s\n", error.c_str());
+        exit(EXIT_FAILURE);
+    }
+
+    return scenario;
+}
+
+#endif /* ECU_SIM_CHECK_HPP_ */
@@ -0,0 +1,454 @@
+/*
+ * ecu_sim_test.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host test of the ECU simulator, frame by frame like a tester on the bus: the supported
+ *      PIDs bitmaps against the ones computed by hand, several PIDs in a request, the flow
+ *      control (block size and separation time), 29 bit IDs, the clear of the DTCs, the freeze
+ *      frame, the negative responses, the P2 range, every fault and the errors of the scenario
+ *      files. Then the responses per second of the simulator are measured.
+ *
+ *      Build and run (from this folder):
+ *          c++ -std=c++17 -O2 -Wall -o ecu_sim_test ecu_sim_test.cpp ecu_sim.cpp
+ *          ./ecu_sim_test [requests]
+ */
+
+// C++ libraries
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "ecu_sim.hpp"
+#include "ecu_sim_check.hpp"
+
+#define BENCH_REQUESTS 1000000
+#define P2_REQUESTS 10000
+
+static const char *SCENARIO =
+    "# Test car\n"
+    ECU_SIM_CHECK_ECM
+    "pid 05 const 130\n"
+    "pid 0C const 0x1AF8\n"
+    "pid 0D const 88\n"
+    "pid 2F const 200\n"
+    "dtc stored P0133 C0123\n"
+    "dtc pending P0128\n"
+    "dtc permanent P0133\n"
+    "freeze P0133 0C=0x0C80 0D=40\n"
+    "vin 1M8GDM9AXKP042788\n"
+    "calid CAL-1\n"
+    "name ECM-EngineControl\n"
+    ECU_SIM_CHECK_TCM
+    "ecu BCM 18DA40F1 18DAF140\n"
+    "p2 2000 2000\n"
+    "pid 0D const 86\n"
+    "padding 55\n";
+
+
+// Frame of the tester (8 bytes, padding 0x55) that ends at time_us
+static std::vector<ecu_sim::Frame> send(ecu_sim::Simulator &simulator, uint64_t time_us, uint32_t ID,
+                                        std::initializer_list<uint8_t> bytes){
+
+    ecu_sim::Frame frame;
+    std::vector<ecu_sim::Frame> out;
+    size_t i = 0;
+
+    frame.time_us = time_us;
+    frame.ID = ID;
+    frame.extended = (ID > 0x7FF);
+    frame.length = 8;
+    memset(frame.data, 0x55, sizeof(frame.data));
+    for (uint8_t byte : bytes){
+
+        frame.data[i++] = byte;
+    }
+    simulator.on_frame(frame, out);
+
+    return out;
+}
+
+static bool has_data(const ecu_sim::Frame &frame, std::initializer_list<uint8_t> bytes){
+
+    size_t i = 0;
+
+    for (uint8_t byte : bytes){
+
+        if (frame.data[i++] != byte){
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void test_services(void){
+
+    ecu_sim::Simulator simulator(parse(SCENARIO));
+    std::vector<ecu_sim::Frame> out;
+
+    // Supported PIDs: 01 05 0C 0D on 00, 2F on 20. A: 01 05 = 1000 1000, B: 0C 0D =
+    // 0001 1000, D: the bitmap of 20. 20: 2F = bit 15 from the top, B = 0000 0010.
+    out = send(simulator, 0, ecu_sim::FUNCTIONAL_ID, {0x02, 0x01, 0x00});
+    check((out.size() == 2) && (out[0].ID == 0x7E8) && has_data(out[0], {0x06, 0x41, 0x00, 0x88, 0x18, 0x00, 0x01, 0xAA}),
+          "Supported PIDs 00 of the ECM");
+    check((out.size() == 2) && (out[1].ID == 0x7E9) && has_data(out[1], {0x06, 0x41, 0x00, 0x80, 0x08, 0x00, 0x00}),
+          "Supported PIDs 00 of the TCM");
+    out = send(simulator, 100000, 0x7E0, {0x02, 0x01, 0x20});
+    check((out.size() == 1) && has_data(out[0], {0x06, 0x41, 0x20, 0x00, 0x02, 0x00, 0x00}), "Supported PIDs 20");
+    out = send(simulator, 200000, 0x7E1, {0x02, 0x01, 0x20});
+    check((out.size() == 1) && has_data(out[0], {0x03, 0x7F, 0x01, 0x31}), "Supported PIDs 20 of the TCM: out of range");
+    out = send(simulator, 300000, ecu_sim::FUNCTIONAL_ID, {0x02, 0x01, 0x20});
+    check((out.size() == 1) && (out[0].ID == 0x7E8), "Functional request not answered by the TCM");
+
+    // Monitor status: MIL on and 2 DTCs
+    out = send(simulator, 400000, 0x7E0, {0x02, 0x01, 0x01});
+    check((out.size() == 1) && has_data(out[0], {0x06, 0x41, 0x01, 0x82}), "MIL and number of DTCs");
+
+    // Several PIDs: 41 0C 1A F8 0D 58 05 82 are 8 bytes, a first frame and a consecutive one
+    out = send(simulator, 500000, 0x7E0, {0x04, 0x01, 0x0C, 0x0D, 0x05});
+    check((out.size() == 1) && has_data(out[0], {0x10, 0x08, 0x41, 0x0C, 0x1A, 0xF8, 0x0D, 0x58}), "Several PIDs, first frame");
+    out = send(simulator, 502000, 0x7E0, {0x30, 0x00, 0x00});
+    check((out.size() == 1) && has_data(out[0], {0x21, 0x05, 0x82, 0xAA}) && (out[0].time_us == 502000 + ecu_sim::N_CS_US),
+          "Several PIDs, consecutive frame");
+
+    // DTCs: the count and 2 bytes each (C0123 = 0x4123)
+    out = send(simulator, 600000, 0x7E0, {0x01, 0x03});
+    check((out.size() == 1) && has_data(out[0], {0x06, 0x43, 0x02, 0x01, 0x33, 0x41, 0x23}), "Stored DTCs");
+    out = send(simulator, 700000, 0x7E0, {0x01, 0x07});
+    check((out.size() == 1) && has_data(out[0], {0x04, 0x47, 0x01, 0x01, 0x28}), "Pending DTCs");
+
+    // Freeze frame
+    out = send(simulator, 800000, 0x7E0, {0x03, 0x02, 0x02, 0x00});
+    check((out.size() == 1) && has_data(out[0], {0x05, 0x42, 0x02, 0x00, 0x01, 0x33}), "DTC of the freeze frame");
+    out = send(simulator, 900000, 0x7E0, {0x03, 0x02, 0x0C, 0x00});
+    check((out.size() == 1) && has_data(out[0], {0x05, 0x42, 0x0C, 0x00, 0x0C, 0x80}), "RPM of the freeze frame");
+
+    // Services 09 and one that is not supported
+    out = send(simulator, 1000000, 0x7E0, {0x02, 0x09, 0x00});
+    check((out.size() == 1) && has_data(out[0], {0x06, 0x49, 0x00, 0x50, 0x40, 0x00, 0x00}), "Supported infotypes");
+    out = send(simulator, 1100000, 0x7E0, {0x01, 0x05});
+    check((out.size() == 1) && has_data(out[0], {0x03, 0x7F, 0x05, 0x11}), "Service not supported");
+    out = send(simulator, 1200000, ecu_sim::FUNCTIONAL_ID, {0x01, 0x05});
+    check(out.empty(), "Service not supported on a functional request");
+
+    // Clear: the stored and pending DTCs and the freeze frame go, the permanent ones stay
+    out = send(simulator, 1300000, 0x7E0, {0x01, 0x04});
+    check((out.size() == 1) && has_data(out[0], {0x01, 0x44}), "Clear DTCs");
+    out = send(simulator, 1400000, 0x7E0, {0x01, 0x03});
+    check((out.size() == 1) && has_data(out[0], {0x02, 0x43, 0x00}), "No stored DTCs after the clear");
+    out = send(simulator, 1500000, 0x7E0, {0x01, 0x0A});
+    check((out.size() == 1) && has_data(out[0], {0x04, 0x4A, 0x01, 0x01, 0x33}), "Permanent DTC after the clear");
+    out = send(simulator, 1600000, 0x7E0, {0x02, 0x01, 0x01});
+    check((out.size() == 1) && has_data(out[0], {0x06, 0x41, 0x01, 0x00}), "MIL off after the clear");
+    out = send(simulator, 1700000, 0x7E0, {0x03, 0x02, 0x02, 0x00});
+    check((out.size() == 1) && has_data(out[0], {0x03, 0x7F, 0x02, 0x31}), "No freeze frame after the clear");
+
+    // 29 bit IDs: functional 18DB33F1 and physical 18DA40F1, 11 bit requests are not for the BCM
+    out = send(simulator, 1800000, ecu_sim::FUNCTIONAL_EXTENDED_ID, {0x02, 0x01, 0x0D});
+    check((out.size() == 1) && (out[0].ID == 0x18DAF140) && out[0].extended &&
+          has_data(out[0], {0x03, 0x41, 0x0D, 86, 0x55}) && (out[0].time_us == 1802000), "29 bit functional request");
+    out = send(simulator, 1900000, 0x18DA40F1, {0x02, 0x01, 0x0D});
+    check((out.size() == 1) && (out[0].ID == 0x18DAF140), "29 bit physical request");
+    out = send(simulator, 2000000, ecu_sim::FUNCTIONAL_ID, {0x02, 0x01, 0x0D});
+    check((out.size() == 2) && (!out[0].extended) && (!out[1].extended), "11 bit functional request");
+
+    check(simulator.stats().ignored == 0, "Every frame taken");
+    check(simulator.stats().negative == 3, "Negative responses counted");
+}
+
+static void test_flow_control(void){
+
+    ecu_sim::Simulator simulator(parse(SCENARIO));
+    std::vector<ecu_sim::Frame> out;
+    uint32_t frame_us = ecu_sim::frame_time_us(8, false, 500000);
+    std::string VIN;
+
+    // VIN: 49 02 01 and 17 characters = 20 bytes, first frame and 2 consecutive frames.
+    // Block size 1: a flow control before every consecutive frame.
+    out = send(simulator, 0, 0x7E0, {0x02, 0x09, 0x02});
+    check((out.size() == 1) && has_data(out[0], {0x10, 0x14, 0x49, 0x02, 0x01}), "VIN first frame");
+    VIN.append((const char *)out[0].data + 5, 3);
+    out = send(simulator, 2000, 0x7E0, {0x30, 0x01, 0x00});
+    check((out.size() == 1) && (out[0].data[0] == 0x21), "First block of 1 frame");
+    VIN.append((const char *)out[0].data + 1, 7);
+    out = send(simulator, 3000, 0x7E0, {0x30, 0x01, 0x00});
+    check((out.size() == 1) && (out[0].data[0] == 0x22), "Second block of 1 frame");
+    VIN.append((const char *)out[0].data + 1, 7);
+    check(VIN == "1M8GDM9AXKP042788", "VIN reassembled");
+    out = send(simulator, 4000, 0x7E0, {0x30, 0x00, 0x00});
+    check(out.empty(), "Flow control after the end");
+
+    // ECU name: 3 + 20 bytes = first frame and 3 consecutive frames. Block size 2 and
+    // STmin F5 (500 us) between them, then wait (31) and continue.
+    out = send(simulator, 10000, 0x7E0, {0x02, 0x09, 0x0A});
+    check((out.size() == 1) && has_data(out[0], {0x10, 0x17, 0x49, 0x0A, 0x01, 'E', 'C', 'M'}), "Name first frame");
+    out = send(simulator, 12000, 0x7E0, {0x30, 0x02, 0xF5});
+    check((out.size() == 2) && (out[0].time_us == 12000 + ecu_sim::N_CS_US) &&
+          (out[1].time_us == out[0].time_us + frame_us + 500), "Separation time of 500 us");
+    out = send(simulator, 20000, 0x7E0, {0x31, 0x00, 0x00});
+    check(out.empty(), "Wait flow control");
+    out = send(simulator, 30000, 0x7E0, {0x30, 0x00, 0x14});
+    check((out.size() == 1) && (out[0].data[0] == 0x23), "Last block after the wait");
+
+    // Separation time in ms
+    out = send(simulator, 40000, 0x7E0, {0x02, 0x09, 0x0A});
+    out = send(simulator, 42000, 0x7E0, {0x30, 0x00, 0x05});
+    check((out.size() == 3) && (out[2].time_us - out[1].time_us == frame_us + 5000), "Separation time of 5 ms");
+
+    // No flow control: the answer is abandoned after N_Bs
+    out = send(simulator, 50000, 0x7E0, {0x02, 0x09, 0x02});
+    out = send(simulator, 50000 + ecu_sim::N_BS_US + 10000, 0x7E0, {0x30, 0x00, 0x00});
+    check(out.empty() && (simulator.stats().flow_timeouts == 1), "N_Bs timeout");
+
+    // Overflow (32): the answer is abandoned
+    out = send(simulator, 2000000, 0x7E0, {0x02, 0x09, 0x02});
+    out = send(simulator, 2002000, 0x7E0, {0x32, 0x00, 0x00});
+    out = send(simulator, 2003000, 0x7E0, {0x30, 0x00, 0x00});
+    check(out.empty(), "Overflow flow control");
+
+    // The flow control of a functional request can come on the functional ID too
+    out = send(simulator, 3000000, ecu_sim::FUNCTIONAL_ID, {0x02, 0x09, 0x02});
+    out = send(simulator, 3002000, ecu_sim::FUNCTIONAL_ID, {0x30, 0x00, 0x00});
+    check(out.size() == 2, "Flow control on the functional ID");
+}
+
+static void test_P2(void){
+
+    ecu_sim::Simulator simulator(parse(SCENARIO));
+    std::vector<ecu_sim::Frame> out;
+    uint64_t min_us = UINT64_MAX, max_us = 0;
+    bool in_range = true;
+
+    for (uint64_t i = 0; i < P2_REQUESTS; i++){
+
+        uint64_t time_us = i*100000;
+
+        out = send(simulator, time_us, 0x7E1, {0x02, 0x01, 0x0D});
+        if (out.size() != 1){
+
+            in_range = false;
+            continue;
+        }
+        uint64_t p2_us = out[0].time_us - time_us;
+
+        in_range = in_range && (p2_us >= 5000) && (p2_us <= 20000);
+        min_us = std::min(min_us, p2_us);
+        max_us = std::max(max_us, p2_us);
+    }
+    check(in_range, "P2 between 5 and 20 ms");
+    check((min_us < 5100) && (max_us > 19900), "P2 over the whole range");
+
+    // Same seed, same answers
+    ecu_sim::Simulator first(parse(SCENARIO)), second(parse(SCENARIO));
+    bool same = true;
+
+    for (uint64_t i = 0; i < 100; i++){
+
+        std::vector<ecu_sim::Frame> a = send(first, i*100000, ecu_sim::FUNCTIONAL_ID, {0x02, 0x01, 0x0D});
+        std::vector<ecu_sim::Frame> b = send(second, i*100000, ecu_sim::FUNCTIONAL_ID, {0x02, 0x01, 0x0D});
+
+        same = same && (a.size() == b.size()) && (a[1].time_us == b[1].time_us);
+    }
+    check(same, "Same seed, same answers");
+}
+
+static void test_signals(void){
+
+    ecu_sim::Simulator simulator(parse("ecu ECM 7E0 7E8\n"
+                                       "p2 0 0\n"
+                                       "pid 0C ramp 0 1000 1000\n"
+                                       "pid 0D sine 0 200 1000\n"
+                                       "pid 04 random 10 20\n"
+                                       "pid 05 const 300\n"));
+    std::vector<ecu_sim::Frame> out;
+    bool in_range = true;
+
+    out = send(simulator, 250000, 0x7E0, {0x02, 0x01, 0x0C});
+    check((out.size() == 1) && has_data(out[0], {0x04, 0x41, 0x0C, 0x00, 250}), "Ramp at a quarter");
+    out = send(simulator, 500000, 0x7E0, {0x02, 0x01, 0x0D});
+    check((out.size() == 1) && has_data(out[0], {0x03, 0x41, 0x0D, 200}), "Sine at the middle");
+    out = send(simulator, 1000000, 0x7E0, {0x02, 0x01, 0x0D});
+    check((out.size() == 1) && has_data(out[0], {0x03, 0x41, 0x0D, 0}), "Sine at the end");
+    out = send(simulator, 1100000, 0x7E0, {0x02, 0x01, 0x05});
+    check((out.size() == 1) && has_data(out[0], {0x03, 0x41, 0x05, 0xFF}), "Value limited to the bytes of the PID");
+    for (int i = 0; i < 1000; i++){
+
+        out = send(simulator, 2000000 + i*1000, 0x7E0, {0x02, 0x01, 0x04});
+        in_range = in_range && (out.size() == 1) && (out[0].data[3] >= 10) && (out[0].data[3] <= 20);
+    }
+    check(in_range, "Random between MIN and MAX");
+}
+
+static void test_faults(void){
+
+    std::vector<ecu_sim::Frame> out;
+    std::string base = "ecu ECM 7E0 7E8\np2 1000 1000\npid 0D const 88\nvin 1M8GDM9AXKP042788\n";
+
+    {
+        ecu_sim::Simulator simulator(parse((base + "fault silent 1\n").c_str()));
+
+        out = send(simulator, 0, 0x7E0, {0x02, 0x01, 0x0D});
+        check(out.empty() && (simulator.stats().faults == 1), "Silent ECU");
+    }
+    {
+        ecu_sim::Simulator simulator(parse((base + "fault negative 1 21\n").c_str()));
+
+        out = send(simulator, 0, 0x7E0, {0x02, 0x01, 0x0D});
+        check((out.size() == 1) && has_data(out[0], {0x03, 0x7F, 0x01, 0x21}), "Negative response (busy, repeat)");
+    }
+    {
+        ecu_sim::Simulator simulator(parse((base + "fault pending 1 2\n").c_str()));
+
+        out = send(simulator, 0, 0x7E0, {0x02, 0x01, 0x0D});
+        check((out.size() == 3) && has_data(out[0], {0x03, 0x7F, 0x01, 0x78}) && has_data(out[1], {0x03, 0x7F, 0x01, 0x78}) &&
+              has_data(out[2], {0x03, 0x41, 0x0D, 88}) && (out[2].time_us == 1000 + 2*ecu_sim::PENDING_INTERVAL_US),
+              "Response pending twice");
+    }
+    {
+        ecu_sim::Simulator simulator(parse((base + "fault late 1 250000\n").c_str()));
+
+        out = send(simulator, 0, 0x7E0, {0x02, 0x01, 0x0D});
+        check((out.size() == 1) && (out[0].time_us == 251000), "Late answer");
+    }
+    {
+        ecu_sim::Simulator simulator(parse((base + "fault sequence 1\n").c_str()));
+        int wrong = 0;
+
+        send(simulator, 0, 0x7E0, {0x02, 0x09, 0x02});
+        out = send(simulator, 2000, 0x7E0, {0x30, 0x00, 0x00});
+        for (size_t i = 0; i < out.size(); i++){
+
+            wrong += (out[i].data[0] != 0x21 + i);
+        }
+        check((out.size() == 2) && (wrong == 1), "Wrong sequence number");
+    }
+    {
+        ecu_sim::Simulator simulator(parse((base + "fault drop 1\n").c_str()));
+
+        send(simulator, 0, 0x7E0, {0x02, 0x09, 0x02});
+        out = send(simulator, 2000, 0x7E0, {0x30, 0x00, 0x00});
+        check(out.size() == 1, "Consecutive frame lost");
+    }
+    {
+        ecu_sim::Simulator simulator(parse((base + "fault silent 0.25\n").c_str()));
+        int answered = 0;
+
+        for (int i = 0; i < 10000; i++){
+
+            answered += (int)send(simulator, i*10000, 0x7E0, {0x02, 0x01, 0x0D}).size();
+        }
+        check((answered > 7300) && (answered < 7700), "Silent a quarter of the times");
+    }
+}
+
+static void test_scenario_files(void){
+
+    static const struct{
+
+        const char *text;
+        const char *error;
+    }wrong[] = {
+        {"pid 0C const 1\n", "line 1: pid before the first ecu"},
+        {"ecu ECM 7E0 7E8\n\n# PID\npid 99 const 1\n", "line 4: unknown PID 99"},
+        {"ecu ECM 7E0 7E8\npid 20 const 1\n", "line 2: PID 20 is a supported PIDs bitmap"},
+        {"ecu ECM 7E0 7E8\npid 0C ramp 10 5 1000\n", "line 2: pid ramp needs MIN <= MAX"},
+        {"ecu ECM 7E0 7E8\npid 0C sine 0 5\n", "line 2: pid sine needs a period in ms"},
+        {"ecu ECM 7E0 7E8\ndtc stored P0133 X1234\n", "line 2: bad DTC X1234"},
+        {"ecu ECM 7E0 7E8\nvin 1234\n", "line 2: the VIN has 17 characters"},
+        {"ecu ECM 7E0 7E8\nfault silent 2\n", "line 2: fault needs a probability from 0 to 1"},
+        {"ecu ECM 7E0 7E8\nfault broken 0.5\n", "line 2: unknown fault broken"},
+        {"ecu ECM 7E0 7E8\nfreeze P0133 0C\n", "line 2: freeze needs PID=RAW, not 0C"},
+        {"ecu ECM 7E0 7E8\nspeed 10\n", "line 2: unknown setting speed"},
+        {"# nothing\n", "no ecu"},
+    };
+    ecu_sim::Scenario scenario;
+    std::string error;
+    uint16_t DTC;
+
+    for (const auto &file : wrong){
+
+        std::istringstream input(file.text);
+
+        check((!ecu_sim::parse_scenario(input, scenario, error)) && (error == file.error), file.error);
+    }
+
+    check(ecu_sim::encode_DTC("U0121", DTC) && (DTC == 0xC121) && (ecu_sim::decode_DTC(DTC) == "U0121"), "DTC U0121");
+    check(ecu_sim::encode_DTC("b1000", DTC) && (ecu_sim::decode_DTC(DTC) == "B1000"), "DTC B1000");
+    check(!ecu_sim::encode_DTC("P4000", DTC), "DTC P4000");
+
+    scenario = parse(SCENARIO);
+    check((scenario.ECUs.size() == 3) && scenario.ECUs[2].extended && (scenario.ECUs[2].padding == 0x55) &&
+          (scenario.ECUs[0].calibration == "CAL-1") && (scenario.ECUs[0].freeze.PIDs.size() == 2), "Scenario read");
+}
+
+static void bench(uint64_t requests){
+
+    ecu_sim::Simulator simulator(parse(SCENARIO));
+    std::vector<ecu_sim::Frame> out;
+    ecu_sim::Frame frame;
+    static const uint8_t PIDs[] = {0x05, 0x0C, 0x0D, 0x2F};
+
+    frame.ID = ecu_sim::FUNCTIONAL_ID;
+    frame.extended = false;
+    frame.length = 8;
+    memset(frame.data, 0x55, sizeof(frame.data));
+    frame.data[0] = 0x02;
+    frame.data[1] = 0x01;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < requests; i++){
+
+        frame.time_us = i*1000;
+        frame.data[2] = PIDs[i % sizeof(PIDs)];
+        out.clear();
+        simulator.on_frame(frame, out);
+    }
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double responses_s = simulator.stats().responses/wall_s;
+
+    printf("%llu functional requests, %llu responses in %.1f ms: %.0f responses/s\n", (unsigned long long)requests,
+           (unsigned long long)simulator.stats().responses, wall_s*1000, responses_s);
+    check(responses_s > 10000, "Thousands of responses per second");
+}
+
+int main(int argc, char *argv[]){
+
+    uint64_t requests = (argc > 1) ? strtoull(argv[1], nullptr, 0) : BENCH_REQUESTS;
+
+    test_services();
+    test_flow_control();
+    test_P2();
+    test_signals();
+    test_faults();
+    test_scenario_files();
+    for (const char *path : {"scenarios/oe91c1610.scn", "scenarios/fleet.scn"}){
+
+        ecu_sim::Scenario scenario;
+        std::string error;
+
+        check(ecu_sim::load_scenario(path, scenario, error), path);
+    }
+    bench(requests);
+
+    if (failures > 0){
+
+        printf("%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("ECU simulator correct\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,251 @@
+/*
+ * ecu_sim_tool.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      The ECUs of a scenario on the bus of the host HAL (Host/OBD_host), with the OBD protocol
+ *      of the firmware (Software/OBD_protocol.c) as the tester:
+ *      - session: what the device shows of every ECU (live data, DTCs, VIN).
+ *      - load: the device polls the ECUs for some seconds of virtual time, like the live data
+ *        logger with the DTC monitor, and the results of the stack, the simulator and the bus
+ *        are printed. The 29 bit ECUs are left out, the firmware only uses 11 bit IDs.
+ *
+ *      Build and run (from this folder):
+ *          cc -std=gnu99 -O2 -Wall -DPROBES_HOST -I../../Software -I../OBD_host -c ../../Software/OBD_protocol.c ../../Software/Cycle_probes.c ../OBD_host/obd_hal_host.c
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -I../OBD_host -o ecu_sim ecu_sim_tool.cpp ecu_sim.cpp OBD_protocol.o Cycle_probes.o obd_hal_host.o
+ *          ./ecu_sim scenarios/oe91c1610.scn session
+ *          ./ecu_sim scenarios/fleet.scn load 60
+ */
+
+// C++ libraries
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+extern "C" {
+#include "OBD_protocol.h"
+#include "obd_hal_host.h"
+}
+#include "ecu_sim.hpp"
+
+#define DTC_READ_EVERY 50           // Rounds of live data
+
+struct Bench{
+
+    ecu_sim::Simulator *simulator;
+    std::vector<ecu_sim::Frame> out;
+    uint64_t bus_us = 0;            // Time of the frames on the bus
+};
+
+static void print_usage(const char *program){
+
+    fprintf(stderr, "Usage: %s scenario session\n"
+                    "       %s scenario load seconds\n", program, program);
+}
+
+// The frames of the tester go to the simulator and its answers to the queue of the HAL
+static void respond(const tHostFrame *frame, void *context){
+
+    Bench &bench = *(Bench *)context;
+    ecu_sim::Frame request;
+    uint32_t bitrate = bench.simulator->bitrate();
+
+    request.time_us = frame->time_us;
+    request.ID = frame->ID;
+    request.extended = false;
+    request.length = frame->length;
+    memcpy(request.data, frame->data, sizeof(request.data));
+    bench.bus_us += ecu_sim::frame_time_us(frame->length, false, bitrate);
+
+    bench.out.clear();
+    bench.simulator->on_frame(request, bench.out);
+    for (const ecu_sim::Frame &answer : bench.out){
+
+        host_CANinject(answer.ID, answer.data, answer.length, (uint32_t)(answer.time_us - host_timeUs()));
+        bench.bus_us += ecu_sim::frame_time_us(answer.length, answer.extended, bitrate);
+    }
+}
+
+// Positions on pids_liveData of the PIDs of an ECU
+static std::vector<uint8_t> live_PIDs(const ecu_sim::EcuConfig &config){
+
+    std::vector<uint8_t> positions;
+
+    for (uint8_t posPID = 0; posPID < NUM_LIVE_DATA_PIDS; posPID++){
+
+        for (const ecu_sim::Signal &signal : config.signals){
+
+            if (signal.PID == pids_liveData[posPID]){
+
+                positions.push_back(posPID);
+            }
+        }
+    }
+
+    return positions;
+}
+
+static void print_DTCs(const ecu_sim::EcuConfig &config, uint8_t mode, const char *name){
+
+    char codes[OBD_MAX_DTCS][NUM_CHAR_DTC+1];
+    int16_t numDTCs = read_DTCs(config.request_ID, config.response_ID, mode, codes, OBD_MAX_DTCS);
+
+    printf("  %-10s", name);
+    if (numDTCs < 0){
+
+        printf(" no answer\n");
+        return;
+    }
+    for (int16_t i = 0; i < numDTCs; i++){
+
+        printf(" %s", codes[i]);
+    }
+    printf("%s\n", (numDTCs == 0) ? " none" : "");
+}
+
+static void run_session(ecu_sim::Simulator &simulator){
+
+    for (size_t i = 0; i < simulator.num_ECUs(); i++){
+
+        const ecu_sim::EcuConfig &config = simulator.config(i);
+        char VIN[MAX_VIN_BYTES];
+
+        printf("%s %X -> %X\n", config.name.c_str(), config.request_ID, config.response_ID);
+        if (config.extended){
+
+            printf("  29 bit IDs, not used by the device\n");
+            continue;
+        }
+        for (uint8_t posPID : live_PIDs(config)){
+
+            tOBDValue value;
+            char text[7];
+
+            if (read_PIDvalue(REMOTE_REQUEST_ID, config.response_ID, posPID, &value)){
+
+                format_liveDataValue(value.value, text);
+                printf("  %-19s %s\n", liveData_strings[posPID], text);
+            }else {
+
+                printf("  %-19s no answer\n", liveData_strings[posPID]);
+            }
+        }
+        print_DTCs(config, 0x03, "Stored:");
+        print_DTCs(config, 0x07, "Pending:");
+        print_DTCs(config, 0x0A, "Permanent:");
+        if (!config.VIN.empty()){
+
+            printf("  %-10s %s\n", "VIN:", read_VIN(config.request_ID, config.response_ID, VIN) ? VIN : "no answer");
+        }
+    }
+}
+
+static void run_load(ecu_sim::Simulator &simulator, const Bench &bench, double seconds){
+
+    std::vector<std::vector<uint8_t>> PIDs;
+    uint64_t end_us = (uint64_t)(seconds*1e6);
+    uint32_t rounds = 0;
+    char codes[OBD_MAX_DTCS][NUM_CHAR_DTC+1];
+    char VIN[MAX_VIN_BYTES];
+    tOBDValue value;
+    tOBDStats stats;
+
+    for (size_t i = 0; i < simulator.num_ECUs(); i++){
+
+        PIDs.push_back(live_PIDs(simulator.config(i)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (host_timeUs() < end_us){
+
+        for (size_t i = 0; i < simulator.num_ECUs(); i++){
+
+            const ecu_sim::EcuConfig &config = simulator.config(i);
+
+            if (config.extended){
+
+                continue;
+            }
+            for (uint8_t posPID : PIDs[i]){
+
+                read_PIDvalue(REMOTE_REQUEST_ID, config.response_ID, posPID, &value);
+            }
+            if ((rounds % DTC_READ_EVERY) == 0){
+
+                read_DTCs(config.request_ID, config.response_ID, 0x03, codes, OBD_MAX_DTCS);
+                if (!config.VIN.empty()){
+
+                    read_VIN(config.request_ID, config.response_ID, VIN);
+                }
+            }
+        }
+        rounds++;
+    }
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double virtual_s = host_timeUs()/1e6;
+
+    const ecu_sim::SimStats &simulated = simulator.stats();
+    const tHostCANStats *bus = host_CANstats();
+
+    get_OBDstats(&stats);
+    printf("Device: %u requests, %u responses, %u timeouts, %u errors", stats.requests, stats.responses,
+           stats.timeouts, stats.errors);
+    if (stats.responses > 0){
+
+        printf(", latency %.1f ms average, %u ms max", (double)stats.latency_sum_ms/stats.responses, stats.latency_max_ms);
+    }
+    printf("\nECUs: %llu requests, %llu responses, %llu frames, %llu flow controls, %llu negative, %llu faults, "
+           "%llu flow control timeouts\n", (unsigned long long)simulated.requests, (unsigned long long)simulated.responses,
+           (unsigned long long)simulated.frames, (unsigned long long)simulated.flow_controls,
+           (unsigned long long)simulated.negative, (unsigned long long)simulated.faults,
+           (unsigned long long)simulated.flow_timeouts);
+    printf("Bus: %.1f %% load, %llu frames filtered, %llu late, %llu overflows\n", 100.0*bench.bus_us/host_timeUs(),
+           (unsigned long long)bus->filtered, (unsigned long long)bus->late, (unsigned long long)bus->overflows);
+    printf("%.1f s of bus in %.1f ms: %.0fx real time, %.0f responses/s\n", virtual_s, wall_s*1000, virtual_s/wall_s,
+           simulated.responses/wall_s);
+}
+
+int main(int argc, char *argv[]){
+
+    std::string command = (argc > 2) ? argv[2] : "";
+    ecu_sim::Scenario scenario;
+    std::string error;
+    Bench bench;
+
+    if ((argc < 3) || ((command != "session") && (command != "load")) || ((command == "load") && (argc < 4))){
+
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!ecu_sim::load_scenario(argv[1], scenario, error)){
+
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    if (scenario.bitrate != 1000000/HOST_CAN_BIT_US){
+
+        fprintf(stderr, "The host HAL runs the bus at %u bit/s\n", 1000000/HOST_CAN_BIT_US);
+        return EXIT_FAILURE;
+    }
+
+    ecu_sim::Simulator simulator(scenario);
+    bench.simulator = &simulator;
+    host_resetHAL();
+    host_setResponder(respond, &bench);
+    reset_OBDstats();
+
+    if (command == "session"){
+
+        run_session(simulator);
+    }else {
+
+        run_load(simulator, bench, strtod(argv[3], nullptr));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/*
+ * elm327_host.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C++ libraries
+#include <cerrno>
+#include <cstring>
+
+// POSIX
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Programmer libraries
+extern "C" {
+#include "ELM327_interface.h"
+}
+#include "elm327_host.hpp"
+
+namespace elm327_host {
+
+static Device *current_device = nullptr;
+
+bool open_pty(Pty &pty, std::string &error){
+
+    struct termios settings;
+    const char *name;
+
+    pty.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((pty.master < 0) || (grantpt(pty.master) != 0) || (unlockpt(pty.master) != 0) ||
+        ((name = ptsname(pty.master)) == nullptr)){
+
+        error = std::string("Pseudo-terminal: ") + strerror(errno);
+        close_pty(pty);
+        return false;
+    }
+    pty.slave_name = name;
+    pty.slave = open(name, O_RDWR | O_NOCTTY);
+    if ((pty.slave < 0) || (tcgetattr(pty.slave, &settings) != 0)){
+
+        error = pty.slave_name + ": " + strerror(errno);
+        close_pty(pty);
+        return false;
+    }
+    // Like a serial port: no echo nor conversion of the line ends
+    cfmakeraw(&settings);
+    cfsetispeed(&settings, B115200);
+    cfsetospeed(&settings, B115200);
+    tcsetattr(pty.slave, TCSANOW, &settings);
+
+    return true;
+}
+
+void close_pty(Pty &pty){
+
+    if (pty.slave >= 0){
+
+        close(pty.slave);
+    }
+    if (pty.master >= 0){
+
+        close(pty.master);
+    }
+    pty.slave = pty.master = -1;
+}
+
+Device::Device(const ecu_sim::Scenario &scenario, int fd) : ECUs(scenario), output_fd(fd){
+
+    current_device = this;
+    host_resetHAL();
+    host_setResponder(respond, this);
+    init_ELM327(write_output);
+}
+
+Device::~Device(){
+
+    host_setResponder(nullptr, nullptr);
+    current_device = nullptr;
+}
+
+void Device::write_output(const char *text, uint32_t length){
+
+    Device &device = *current_device;
+
+    device.device_traffic.chars_out += length;
+    device.unclocked_chars += length;
+    while (length > 0){
+
+        ssize_t written = write(device.output_fd, text, length);
+
+        if (written < 0){
+
+            if (errno == EINTR){
+
+                continue;
+            }
+            return;
+        }
+        text += written;
+        length -= (uint32_t)written;
+    }
+}
+
+// The frames of the interface go to the simulator and its answers to the queue of the HAL
+void Device::respond(const tHostFrame *frame, void *context){
+
+    Device &device = *(Device *)context;
+    ecu_sim::Frame request;
+    uint32_t bitrate = device.ECUs.bitrate();
+
+    request.time_us = frame->time_us;
+    request.ID = frame->ID;
+    request.extended = (frame->ID > 0x7FF);
+    request.length = frame->length;
+    memcpy(request.data, frame->data, sizeof(request.data));
+    device.device_traffic.bus_us += ecu_sim::frame_time_us(frame->length, request.extended, bitrate);
+
+    device.out.clear();
+    device.ECUs.on_frame(request, device.out);
+    for (const ecu_sim::Frame &answer : device.out){
+
+        host_CANinject(answer.ID, answer.data, answer.length, (uint32_t)(answer.time_us - host_timeUs()));
+        device.device_traffic.bus_us += ecu_sim::frame_time_us(answer.length, answer.extended, bitrate);
+    }
+}
+
+// The lines end with CR, the LF of the terminals is skipped. A line is processed once it and
+// the answer before it have gone through the UART.
+void Device::input(const char *chars, size_t length){
+
+    device_traffic.chars_in += length;
+    for (size_t i = 0; i < length; i++){
+
+        unclocked_chars++;
+        if (chars[i] == '\r'){
+
+            host_advanceUs(unclocked_chars*UART_BITS_PER_CHAR*1000000/UART_BAUD);
+            unclocked_chars = 0;
+            device_traffic.lines++;
+            process_ELMcommand(line.c_str());
+            line.clear();
+        }else if ((chars[i] != '\n') && (line.size() < ELM_LINE_CHARS)){
+
+            line += chars[i];
+        }
+    }
+}
+
+bool Device::service(){
+
+    char buffer[256];
+    ssize_t length = read(output_fd, buffer, sizeof(buffer));
+
+    if (length <= 0){
+
+        return (length < 0) && ((errno == EINTR) || (errno == EAGAIN));
+    }
+    input(buffer, (size_t)length);
+
+    return true;
+}
+
+} // namespace elm327_host
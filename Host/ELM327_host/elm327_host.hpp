@@ -0,0 +1,92 @@
+/*
+ * elm327_host.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      The ELM327 interface of the firmware (Software/ELM327_interface.c) on a pseudo-terminal of
+ *      the PC, with the ECUs of a Host/ECU_sim scenario on the bus of the host HAL
+ *      (Host/OBD_host). The scan tools open the slave side like the serial port of an adapter.
+ *      The bus runs in virtual time, and the characters of every command and its answer move
+ *      the clock by their time on the UART before the next command is processed, like on the
+ *      device. So the late answers of the ECUs arrive when they would, and the throughput can
+ *      be compared with an adapter.
+ */
+
+#ifndef ELM327_HOST_HPP_
+#define ELM327_HOST_HPP_
+
+// C++ libraries
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+extern "C" {
+#include "obd_hal_host.h"
+}
+#include "ecu_sim.hpp"
+
+namespace elm327_host {
+
+static const uint32_t UART_BAUD = 115200;
+static const uint32_t UART_BITS_PER_CHAR = 10;         // 8N1
+
+// Both sides of a pseudo-terminal, raw
+struct Pty{
+
+    int master = -1;            // The device
+    int slave = -1;             // The scan tool (kept open, so the device does not see a hang up)
+    std::string slave_name;
+};
+
+bool open_pty(Pty &pty, std::string &error);
+void close_pty(Pty &pty);
+
+struct Traffic{
+
+    uint64_t chars_in = 0;      // From the scan tool
+    uint64_t chars_out = 0;     // Echo, responses and prompts
+    uint64_t lines = 0;
+    uint64_t bus_us = 0;        // Frames on the bus, both ways
+
+    // Time of the characters on the UART
+    double serial_us() const { return (chars_in + chars_out)*UART_BITS_PER_CHAR*1e6/UART_BAUD; }
+};
+
+// The interface and the HAL are global: one Device at a time
+class Device{
+
+public:
+    // The answers go to fd
+    Device(const ecu_sim::Scenario &scenario, int fd);
+    ~Device();
+
+    // Read what is waiting on fd and process the whole lines. False on the end of fd.
+    bool service();
+    // Characters of the scan tool
+    void input(const char *chars, size_t length);
+
+    const Traffic &traffic() const { return device_traffic; }
+    ecu_sim::Simulator &simulator() { return ECUs; }
+
+private:
+    static void write_output(const char *text, uint32_t length);
+    static void respond(const tHostFrame *frame, void *context);
+
+    ecu_sim::Simulator ECUs;
+    int output_fd;
+    std::string line;
+    uint64_t unclocked_chars = 0;           // Not yet on the clock
+    Traffic device_traffic;
+    std::vector<ecu_sim::Frame> out;
+};
+
+} // namespace elm327_host
+
+#endif /* ELM327_HOST_HPP_ */
@@ -0,0 +1,126 @@
+/*
+ * elm327_pty.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      The ELM327 interface of the firmware on a pseudo-terminal, with the ECUs of a scenario:
+ *      a scan tool of the PC opens the printed device (or the link) as the port of its adapter.
+ *      The clock of the bus follows the clock of the PC, so the signals of the scenario move
+ *      while the tool reads them. Ctrl+C prints the statistics.
+ *
+ *      Build and run (from this folder):
+ *          cc -std=gnu99 -O2 -Wall -I../../Software -I../OBD_host -c ../../Software/ELM327_interface.c ../OBD_host/obd_hal_host.c
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -I../OBD_host -I../ECU_sim -o elm327_pty elm327_pty.cpp elm327_host.cpp ../ECU_sim/ecu_sim.cpp ELM327_interface.o obd_hal_host.o
+ *          ./elm327_pty ../ECU_sim/scenarios/fleet.scn /tmp/ttyELM
+ *          picocom --omap crlf /tmp/ttyELM
+ */
+
+// C++ libraries
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// POSIX
+#include <poll.h>
+#include <unistd.h>
+
+// Programmer libraries
+extern "C" {
+#include "ELM327_interface.h"
+}
+#include "elm327_host.hpp"
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int signal){
+
+    (void)signal;
+    stop = 1;
+}
+
+int main(int argc, char *argv[]){
+
+    ecu_sim::Scenario scenario;
+    elm327_host::Pty pty;
+    std::string error;
+    tELMStats stats;
+
+    if (argc < 2){
+
+        fprintf(stderr, "Usage: %s scenario [link]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!ecu_sim::load_scenario(argv[1], scenario, error)){
+
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    if (scenario.bitrate != 1000000/HOST_CAN_BIT_US){
+
+        fprintf(stderr, "The host HAL runs the bus at %u bit/s\n", 1000000/HOST_CAN_BIT_US);
+        return EXIT_FAILURE;
+    }
+    if (!elm327_host::open_pty(pty, error)){
+
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    if (argc > 2){
+
+        unlink(argv[2]);
+        if (symlink(pty.slave_name.c_str(), argv[2]) != 0){
+
+            perror(argv[2]);
+            return EXIT_FAILURE;
+        }
+    }
+    printf("ELM327 on %s%s%s, %zu ECUs\n", pty.slave_name.c_str(), (argc > 2) ? " -> " : "", (argc > 2) ? argv[2] : "",
+           scenario.ECUs.size());
+    fflush(stdout);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    elm327_host::Device device(scenario, pty.master);
+    auto start = std::chrono::steady_clock::now();
+    struct pollfd master = {pty.master, POLLIN, 0};
+
+    while (!stop){
+
+        if (poll(&master, 1, 500) <= 0){
+
+            continue;
+        }
+        // The virtual clock catches up with the PC (it is ahead after the timeouts)
+        uint64_t now_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - start).count();
+        if (now_us > host_timeUs()){
+
+            host_advanceUs(now_us - host_timeUs());
+        }
+        if (!device.service()){
+
+            break;
+        }
+    }
+
+    const elm327_host::Traffic &traffic = device.traffic();
+    get_ELMstats(&stats);
+    printf("%llu lines, %llu characters in, %llu out, %.1f ms of frames on the bus\n", (unsigned long long)traffic.lines,
+           (unsigned long long)traffic.chars_in, (unsigned long long)traffic.chars_out, traffic.bus_us/1000.0);
+    printf("%u requests, %u responses, %u without data, %u errors, %u ms waiting, response time %u ms\n",
+           stats.requests, stats.responses, stats.no_data, stats.errors, stats.wait_ms, stats.response_ms);
+    if (argc > 2){
+
+        unlink(argv[2]);
+    }
+    elm327_host::close_pty(pty);
+
+    return EXIT_SUCCESS;
+}
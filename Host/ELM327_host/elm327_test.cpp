@@ -0,0 +1,314 @@
+/*
+ * elm327_test.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host test of the ELM327 interface through a pseudo-terminal, like a scan tool: the
+ *      commands are written on the slave side and the answers read from it, up to the prompt.
+ *      An ECM and a TCM answer on 11 bits (and a BCM alone on 29 bits for the search of the
+ *      protocol). The answers are compared with the ones of an ELM327 written by hand: the
+ *      AT settings, single and multi frame responses with and without headers, the number of
+ *      responses, multi PID requests, physical requests, negative responses, NO DATA and the
+ *      timing. Then the PIDs per second on the ECM of the bench simulator are measured, with
+ *      the serial time at 115200 baud and the bus time at 500 kbit/s, for the settings a
+ *      scan tool can choose.
+ *
+ *      Build and run (from this folder):
+ *          cc -std=gnu99 -O2 -Wall -I../../Software -I../OBD_host -c ../../Software/ELM327_interface.c ../OBD_host/obd_hal_host.c
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -I../OBD_host -I../ECU_sim -o elm327_test elm327_test.cpp elm327_host.cpp ../ECU_sim/ecu_sim.cpp ELM327_interface.o obd_hal_host.o
+ *          ./elm327_test [requests]
+ */
+
+// C++ libraries
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+// POSIX
+#include <poll.h>
+#include <unistd.h>
+
+// Programmer libraries
+extern "C" {
+#include "ELM327_interface.h"
+}
+#include "elm327_host.hpp"
+#include "ecu_sim_check.hpp"
+
+#define BENCH_REQUESTS 500
+
+static const char *SCENARIO =
+    ECU_SIM_CHECK_ECM
+    "pid 05 const 130\n"
+    "pid 0C const 0x1AF8\n"
+    "pid 0D const 88\n"
+    "dtc stored P0133\n"
+    "vin 1M8GDM9AXKP042788\n"
+    ECU_SIM_CHECK_TCM;
+
+static const char *EXTENDED_SCENARIO =
+    "seed 2026\n"
+    "ecu BCM 18DA40F1 18DAF140 extended\n"
+    "p2 2000 2000\n"
+    "pid 0D const 86\n"
+    "vin 1M8GDM9AXKP042788\n";
+
+
+// What the scan tool reads up to the prompt
+static std::string read_answer(const elm327_host::Pty &pty){
+
+    std::string answer;
+    char buffer[256];
+    struct pollfd slave = {pty.slave, POLLIN, 0};
+
+    while ((answer.empty() || (answer.back() != '>')) && (poll(&slave, 1, 1000) > 0)){
+
+        ssize_t length = read(pty.slave, buffer, sizeof(buffer));
+
+        if (length <= 0){
+
+            break;
+        }
+        answer.append(buffer, (size_t)length);
+    }
+
+    return answer;
+}
+
+// Line of the scan tool, processed by the device, and its answer
+static std::string command(const elm327_host::Pty &pty, elm327_host::Device &device, const std::string &line){
+
+    std::string text = line + "\r";
+
+    if (write(pty.slave, text.data(), text.size()) != (ssize_t)text.size()){
+
+        return "";
+    }
+    device.service();
+
+    return read_answer(pty);
+}
+
+static void expect(const elm327_host::Pty &pty, elm327_host::Device &device, const std::string &line,
+                   const std::string &answer){
+
+    std::string got = command(pty, device, line);
+
+    if (got != answer){
+
+        for (char &c : got){
+
+            c = (c == '\r') ? '|' : c;
+        }
+        printf("FAIL: %s -> %s\n", line.c_str(), got.c_str());
+        failures++;
+    }
+}
+
+// Virtual ms of a command, with the characters of the one before on the UART
+static uint32_t timed(const elm327_host::Pty &pty, elm327_host::Device &device, const std::string &line){
+
+    uint64_t start_us = host_timeUs();
+
+    command(pty, device, line);
+
+    return (uint32_t)((host_timeUs() - start_us)/1000);
+}
+
+static void test_commands(const elm327_host::Pty &pty){
+
+    elm327_host::Device device(parse(SCENARIO), pty.master);
+
+    check(read_answer(pty) == "ELM327 v1.5\r\r>", "Identification at the start");
+    expect(pty, device, "ATZ", "ATZ\rELM327 v1.5\r\r>");
+    expect(pty, device, "AT E0", "AT E0\rOK\r\r>");
+    expect(pty, device, "ati", "ELM327 v1.5\r\r>");
+    expect(pty, device, "AT@1", ELM_DESCRIPTION_TEXT "\r\r>");
+    expect(pty, device, "ATDP", "AUTO, ISO 15765-4 (CAN 11/500)\r\r>");
+    expect(pty, device, "ATXX", "?\r\r>");
+    expect(pty, device, "ATSP5", "?\r\r>");
+    expect(pty, device, "01 0G", "?\r\r>");
+    expect(pty, device, "0102030405060708", "?\r\r>");
+
+    // The automatic protocol finds the ECUs on 11 bits. The TCM answers later (P2 5 to 20 ms).
+    expect(pty, device, "010D", "SEARCHING...\r41 0D 58\r41 0D 57\r\r>");
+    expect(pty, device, "ATDPN", "A6\r\r>");
+    // The TCM does not have 0C, its late answers to 0D would come on the next request
+    expect(pty, device, "01 0C 1", "41 0C 1A F8\r\r>");
+    expect(pty, device, "", "41 0C 1A F8\r\r>");
+
+    // Headers, spaces and line feeds
+    expect(pty, device, "ATH1", "OK\r\r>");
+    expect(pty, device, "010C1", "7E8 04 41 0C 1A F8\r\r>");
+    expect(pty, device, "ATS0", "OK\r\r>");
+    expect(pty, device, "010C1", "7E804410C1AF8\r\r>");
+    expect(pty, device, "ATL1", "OK\r\n\r\n>");
+    expect(pty, device, "010C1", "7E804410C1AF8\r\n\r\n>");
+    expect(pty, device, "ATL0", "OK\r\r>");
+    expect(pty, device, "ATS1", "OK\r\r>");
+
+    // Multi frame responses: the flow control is sent by the interface
+    expect(pty, device, "09021", "7E8 10 14 49 02 01 31 4D 38\r7E8 21 47 44 4D 39 41 58 4B\r7E8 22 50 30 34 32 37 38 38\r\r>");
+    expect(pty, device, "ATH0", "OK\r\r>");
+    expect(pty, device, "09021", "014\r0: 49 02 01 31 4D 38\r1: 47 44 4D 39 41 58 4B\r2: 50 30 34 32 37 38 38\r\r>");
+    // Several PIDs in a request: 8 bytes of the ECM in a multi frame response, then the TCM
+    expect(pty, device, "01 0C 0D 05", "008\r0: 41 0C 1A F8 0D 58\r1: 05 82\r41 0D 57\r\r>");
+
+    // Physical requests, negative response and no answer
+    expect(pty, device, "ATSH 7E0", "OK\r\r>");
+    expect(pty, device, "03", "43 01 01 33\r\r>");
+    expect(pty, device, "22F190", "7F 22 11\r\r>");
+    expect(pty, device, "ATSH7E5", "OK\r\r>");
+    check(timed(pty, device, "0100") >= ELM_DEFAULT_TIMEOUT*ELM_TIMEOUT_UNIT_MS, "NO DATA after the timeout");
+    expect(pty, device, "0100", "NO DATA\r\r>");
+    expect(pty, device, "ATST19", "OK\r\r>");
+    check(timed(pty, device, "0100") <= 0x19*ELM_TIMEOUT_UNIT_MS + 1, "AT ST");
+    expect(pty, device, "ATD", "OK\r\r>");
+    expect(pty, device, "ATE0", "ATE0\rOK\r\r>");
+    expect(pty, device, "ATSP6", "OK\r\r>");
+
+    // Without auto format: the bytes of the request and the frames as they are
+    expect(pty, device, "ATCAF0", "OK\r\r>");
+    expect(pty, device, "ATCRA7E8", "OK\r\r>");
+    expect(pty, device, "02010D", "03 41 0D 58 AA AA AA AA\r\r>");
+    expect(pty, device, "ATCRA", "OK\r\r>");
+    expect(pty, device, "ATCAF1", "OK\r\r>");
+
+    // Adaptive timing: the wait after the last answer comes down to the response time
+    expect(pty, device, "ATAT0", "OK\r\r>");
+    check(timed(pty, device, "010D") >= ELM_DEFAULT_TIMEOUT*ELM_TIMEOUT_UNIT_MS, "AT0 waits the timeout");
+    expect(pty, device, "ATAT1", "OK\r\r>");
+    for (int i = 0; i < 20; i++){
+
+        command(pty, device, "010D");
+    }
+    tELMStats stats;
+    get_ELMstats(&stats);
+    check((stats.response_ms >= 5) && (stats.response_ms <= 25), "Response time of the TCM");
+    // The TCM answers within 20 ms, then the wait of twice the response time
+    check(timed(pty, device, "010D") <= 20 + 2*stats.response_ms + ELM_ADAPTIVE_MARGIN_MS + 2, "AT1 waits twice the response time");
+    expect(pty, device, "ATAT2", "OK\r\r>");
+    for (int i = 0; i < 20; i++){
+
+        check(command(pty, device, "010D") == "41 0D 58\r41 0D 57\r\r>", "AT2 keeps both answers");
+    }
+    check(timed(pty, device, "010C1") <= 3, "One answer");
+}
+
+static void test_extended(const elm327_host::Pty &pty){
+
+    elm327_host::Device device(parse(EXTENDED_SCENARIO), pty.master);
+
+    read_answer(pty);
+    expect(pty, device, "ATE0", "ATE0\rOK\r\r>");
+    expect(pty, device, "010D", "SEARCHING...\r41 0D 56\r\r>");
+    expect(pty, device, "ATDPN", "A7\r\r>");
+    expect(pty, device, "ATDP", "AUTO, ISO 15765-4 (CAN 29/500)\r\r>");
+    expect(pty, device, "ATH1", "OK\r\r>");
+    expect(pty, device, "010D", "18 DA F1 40 03 41 0D 56\r\r>");
+    // The flow control goes to 18 DA 40 F1
+    expect(pty, device, "ATSH DA40F1", "OK\r\r>");
+    expect(pty, device, "0902", "18 DA F1 40 10 14 49 02 01 31 4D 38\r18 DA F1 40 21 47 44 4D 39 41 58 4B\r"
+                                "18 DA F1 40 22 50 30 34 32 37 38 38\r\r>");
+    expect(pty, device, "ATSP6", "OK\r\r>");
+    expect(pty, device, "010D", "NO DATA\r\r>");
+}
+
+// PIDs per second with the time of the characters on the UART and of the frames on the bus
+static void bench(const elm327_host::Pty &pty, uint32_t requests){
+
+    struct Setting{
+
+        const char *name;
+        const char *commands;               // AT commands before the requests
+        const char *request;
+        uint32_t PIDs;
+    };
+    static const Setting settings[] = {
+        {"E1 S1, wait the timeout (AT0)",  "ATE1;ATAT0", "010C", 1},
+        {"E0 S1, adaptive (AT1)",          "ATE0;ATAT1", "010C", 1},
+        {"E0 S0, aggressive (AT2)",        "ATE0;ATS0;ATAT2", "010C", 1},
+        {"E0 S0 AT2, 1 answer",            "ATE0;ATS0;ATAT2", "010C1", 1},
+        {"E0 S0 AT2, 6 PIDs, 1 answer",    "ATE0;ATS0;ATAT2", "01040C0D0F11051", 6},
+    };
+    ecu_sim::Scenario scenario;
+    std::string error;
+
+    if (!ecu_sim::load_scenario("../ECU_sim/scenarios/oe91c1610.scn", scenario, error)){
+
+        printf("FAIL: %s\n", error.c_str());
+        failures++;
+        return;
+    }
+    printf("%u requests on the ECM of oe91c1610.scn, %u baud and 500 kbit/s:\n", requests, elm327_host::UART_BAUD);
+    double last = 0;
+    for (const Setting &setting : settings){
+
+        elm327_host::Device device(scenario, pty.master);
+        std::string commands = setting.commands;
+        size_t start = 0, end;
+        uint32_t answered = 0;
+
+        read_answer(pty);
+        while ((end = commands.find(';', start)) != std::string::npos){
+
+            command(pty, device, commands.substr(start, end - start));
+            start = end + 1;
+        }
+        command(pty, device, commands.substr(start));
+        // The adaptive timing learns the ECM first
+        for (int i = 0; i < 10; i++){
+
+            command(pty, device, setting.request);
+        }
+
+        elm327_host::Traffic before = device.traffic();
+        uint64_t start_us = host_timeUs();
+        for (uint32_t i = 0; i < requests; i++){
+
+            answered += (command(pty, device, setting.request).find("NO DATA") == std::string::npos);
+        }
+        double serial_us = device.traffic().serial_us() - before.serial_us();
+        double total_us = (double)(host_timeUs() - start_us);
+        double PIDs = (double)answered*setting.PIDs/(total_us/1e6);
+
+        printf("  %-30s %6.1f ms per request (%4.1f ms on the UART): %6.1f PIDs/s\n", setting.name,
+               total_us/requests/1000, serial_us/requests/1000, PIDs);
+        check(answered == requests, "Every request answered");
+        check(PIDs > last, "Faster than the setting before");
+        last = PIDs;
+    }
+}
+
+int main(int argc, char *argv[]){
+
+    uint32_t requests = (argc > 1) ? strtoul(argv[1], nullptr, 0) : BENCH_REQUESTS;
+    elm327_host::Pty pty;
+    std::string error;
+
+    if (!elm327_host::open_pty(pty, error)){
+
+        printf("FAIL: %s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    test_commands(pty);
+    test_extended(pty);
+    bench(pty, requests);
+    elm327_host::close_pty(pty);
+
+    if (failures > 0){
+
+        printf("%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("ELM327 interface correct\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,49 @@
+/*
+ * FreeRTOSConfig.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Configuration of FreeRTOS of the firmware simulator: the one of the firmware with the
+ *      changes the PC needs. It is found before Software/FreeRTOSConfig.h on the include path.
+ */
+
+#ifndef HOST_FREERTOS_CONFIG_H_
+#define HOST_FREERTOS_CONFIG_H_
+
+#include "../../Software/FreeRTOSConfig.h"
+
+// The Idle task sleeps (vApplicationIdleHook of main.c) until the next event of the virtual
+// clock. Without the hook it would be a busy wait of every tick.
+#undef configUSE_IDLE_HOOK
+#define configUSE_IDLE_HOOK 1
+
+// The heap of the board and the bytes the 64 bit pointers of the PC add to what it keeps (the
+// RAM budget of Software/FreeRTOSConfig.h), so the simulator runs out of heap where the board
+// does. The sizes of the Tiva are the ones of an ILP32 build: TCB 92 bytes, queue 80, event
+// group 28. Every block of heap_4 has a header of 16 bytes instead of 8. A new task or object of
+// the firmware is counted here too.
+#define SIM_TASKS 12
+#define SIM_QUEUES 7                // Timer, SD writer, buttons, CAN mutex, RX, TX and mutex of uartstdio
+#define SIM_EVENT_GROUPS 2          // CAN_device.c, PID_cache.c
+#define SIM_OTHER_BLOCKS 8          // Rings of slcan and sniff, answers of the ECUs and texts
+#define SIM_BLOCKS (2*SIM_TASKS + SIM_QUEUES + SIM_EVENT_GROUPS + SIM_OTHER_BLOCKS)
+#define SIM_TIMER_MESSAGE_MARGIN 16 // DaemonTaskMessage_t of timers.c: 16 bytes on the Tiva, 32 on the PC
+#define SIM_SD_JOB_MARGIN (4*12)    // The SD_WRITER_QUEUE_LENGTH jobs: 116 bytes on the Tiva, 128 on the PC
+#define SIM_POINTER_MARGIN (SIM_TASKS*(sizeof(StaticTask_t) - 92) + SIM_QUEUES*(sizeof(StaticQueue_t) - 80) + \
+                            SIM_EVENT_GROUPS*(sizeof(StaticEventGroup_t) - 28) + SIM_BLOCKS*8 + \
+                            configTIMER_QUEUE_LENGTH*SIM_TIMER_MESSAGE_MARGIN + SIM_SD_JOB_MARGIN)
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE ((size_t)(19*1024 + SIM_POINTER_MARGIN))   // 19 KB on the board
+
+// A failed assert stops the simulator instead of hanging it
+#include <stdio.h>
+#include <stdlib.h>
+#undef configASSERT
+#define configASSERT(x) if ((x) == 0){ fprintf(stderr, "configASSERT %s:%d\n", __FILE__, __LINE__); abort(); }
+
+#endif /* HOST_FREERTOS_CONFIG_H_ */
@@ -0,0 +1,69 @@
+/*
+ * SD_device.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      SD_device.h of the firmware simulator: the card is the disk image of Host/SD_image,
+ *      opened by the runner (or no card if there is no image). It takes no virtual time.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Programmer libraries
+#include "SD_fat.h"
+#include "SD_device.h"
+#include "Cycle_probes.h"
+#include "sd_image.h"
+
+
+static bool read_SDcard(uint32_t lba, uint8_t *buffer, uint32_t count){
+
+    return SD_image.read(lba, buffer, count);
+}
+
+static bool write_SDcard(uint32_t lba, const uint8_t *buffer, uint32_t count){
+
+    uint32_t probe = PROBE_START();
+    bool ok = SD_image.write(lba, buffer, count);
+
+    probe_end(PROBE_SD_WRITE, probe);
+    return ok;
+}
+
+static bool start_SDstream(uint32_t lba){
+
+    return SD_image.stream_start(lba);
+}
+
+static bool write_SDstream(const uint8_t *buffer){
+
+    uint32_t probe = PROBE_START();
+    bool ok = SD_image.stream_write(buffer);
+
+    probe_end(PROBE_SD_WRITE, probe);
+    return ok;
+}
+
+static bool stop_SDstream(void){
+
+    return SD_image.stream_stop();
+}
+
+// Block device of the card for SD_fat.c
+const tSDBlockDevice SD_card = {read_SDcard, write_SDcard, start_SDstream, write_SDstream, stop_SDstream};
+
+void init_SDdevice(void){
+
+}
+
+void start_SDdevice(void){
+
+}
@@ -0,0 +1,640 @@
+/*
+ * firmware_bench.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Microbenchmarks of the decode and formatting functions of the firmware, built with the
+ *      objects of the simulator (the heap of FreeRTOS works before the scheduler starts, so the
+ *      functions are called directly). drawString and drawChar are wrapped by a null display,
+ *      so the formatting is measured without the SSI.
+ *
+ *      The harness works like Google Benchmark: every benchmark loops on the State until it
+ *      has run for the minimum time, the number of iterations grows until then. The frame
+ *      benchmarks run once per frame of the corpus (a single frame, the first frame and a
+ *      consecutive frame of ISO-TP), named function/frame. When a function gets a faster
+ *      version, its benchmark goes next to the one of the old version.
+ *
+ *      Options (the ones of Google Benchmark, so the JSON can go to its compare.py):
+ *          --benchmark_filter=REGEX        only the benchmarks whose name matches
+ *          --benchmark_min_time=S          time of every benchmark (0.5 s)
+ *          --benchmark_repetitions=N       N runs, with the mean, median and stddev
+ *          --benchmark_format=console|json output on stdout
+ *          --benchmark_out=FILE            JSON results on a file too
+ *
+ *      Build and run (from this folder, with the objects of the firmware of Host/README.md):
+ *          c++ -std=c++17 -O2 -Wall -I. -I../../Software -c firmware_bench.cpp
+ *          c++ -o firmware_bench firmware_bench.o $(ls *.o | grep -v "firmware_sim_tool\|ecu_sim\|can_trace\|firmware_bench") -Wl,--wrap=drawString,--wrap=drawChar
+ *          ./firmware_bench --benchmark_out=bench.json
+ */
+
+// C++ libraries
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+// Programmer libraries
+extern "C" {
+#include "OBD_protocol.h"
+
+// CAN_device.c
+void get_CANframe(char **CAN_frame, char *cadena, bool only_data, bool ascii);
+bool get_DTC_decoded(char input_buffer_DTC[], char decoded_DTC_buffer[]);
+bool decode_DTC(char *cadena_DTC_bin, char *cadena_DTC_hex, char DTC_decoded[]);
+void find_PIDsupported(char *CAN_frame_binary, char *decimal);
+void show_liveData(double value, uint8_t dataPos);
+// Graphic_interface.c
+void decimal2Hex(const char cadena[], char *cadenaHex);
+uint16_t hex2Decimal(const char cadenaHex[]);
+void hex2Binary(char *cadena_hex, char **cadena_bin_output);
+// heap_4.c
+void *pvPortMalloc(size_t xWantedSize);
+void vPortFree(void *pv);
+}
+
+#define DEFAULT_MIN_TIME_S 0.5
+#define MAX_ITERATIONS 1000000000ULL
+#define HEX_FRAME_CHARS 16
+
+// Null display: the characters are only counted
+static volatile uint32_t drawn_chars = 0;
+
+extern "C" void __wrap_drawString(int16_t x, int16_t y, const char *c, uint16_t colour, uint16_t bg, uint8_t size, uint8_t align){
+
+    (void)x; (void)y; (void)colour; (void)bg; (void)size; (void)align;
+    drawn_chars = drawn_chars + strlen(c);
+}
+
+extern "C" void __wrap_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t colour, uint16_t bg, uint8_t size){
+
+    (void)x; (void)y; (void)c; (void)colour; (void)bg; (void)size;
+    drawn_chars = drawn_chars + 1;
+}
+
+namespace bench {
+
+// A frame of the bus as the firmware gets it from CANMessageGet
+struct Frame{
+
+    const char *name;
+    uint8_t data[8];
+};
+
+// Responses of the ECM of Host/ECU_sim/scenarios/oe91c1610.scn
+static const Frame corpus[] = {
+    {"single_frame", {0x04, 0x41, 0x0C, 0x1A, 0xF8, 0x55, 0x55, 0x55}},         // RPM
+    {"first_frame", {0x10, 0x14, 0x49, 0x02, 0x01, '1', 'M', '8'}},             // VIN
+    {"consecutive_frame", {0x21, 'G', 'D', 'M', '9', 'A', 'X', 'K'}},
+};
+
+// Loop of a benchmark: for (auto _ : state) { ... }
+class State{
+
+public:
+    // Nothing to use in the loop (as in Google Benchmark, the type is marked so _ is not warned)
+    struct __attribute__((unused)) Value{};
+
+    struct Iterator{
+
+        uint64_t left;
+
+        bool operator!=(const Iterator &) const { return left != 0; }
+        void operator++() { left--; }
+        Value operator*() const { return Value(); }
+    };
+
+    State(uint64_t iterations, const Frame *frame) : iterations(iterations), frame(frame) {}
+
+    Iterator begin(){
+
+        start_wall = std::chrono::steady_clock::now();
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start_CPU);
+        return Iterator{iterations};
+    }
+
+    Iterator end(){
+
+        return Iterator{0};
+    }
+
+    const uint64_t iterations;
+    const Frame *const frame;           // Of the corpus, or null
+    std::chrono::steady_clock::time_point start_wall;
+    struct timespec start_CPU;
+};
+
+// The compiler has to keep the value
+template <typename T> inline void do_not_optimize(T const &value){
+
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+typedef void (*tFunction)(State &state);
+
+struct Benchmark{
+
+    std::string name;
+    tFunction function;
+    const Frame *frame;
+};
+
+static std::vector<Benchmark> &registered(void){
+
+    static std::vector<Benchmark> benchmarks;
+
+    return benchmarks;
+}
+
+struct Register{
+
+    Register(const char *name, tFunction function, bool frames){
+
+        if (!frames){
+
+            registered().push_back({name, function, nullptr});
+            return;
+        }
+        for (const Frame &frame : corpus){
+
+            registered().push_back({std::string(name) + "/" + frame.name, function, &frame});
+        }
+    }
+};
+
+#define BENCHMARK(function) static bench::Register register_##function(#function, function, false)
+#define BENCHMARK_FRAMES(function) static bench::Register register_##function(#function, function, true)
+
+struct Result{
+
+    std::string name;
+    uint64_t iterations;
+    double real_ns;                     // Per iteration
+    double CPU_ns;
+};
+
+static Result run(const Benchmark &benchmark, double min_time_s){
+
+    uint64_t iterations = 1;
+
+    for (;;){
+
+        State state(iterations, benchmark.frame);
+        struct timespec end_CPU;
+
+        benchmark.function(state);
+        double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - state.start_wall).count();
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &end_CPU);
+        double CPU_s = (end_CPU.tv_sec - state.start_CPU.tv_sec) + (end_CPU.tv_nsec - state.start_CPU.tv_nsec)/1e9;
+
+        if ((wall_s >= min_time_s) || (iterations >= MAX_ITERATIONS)){
+
+            return {benchmark.name, iterations, wall_s*1e9/iterations, CPU_s*1e9/iterations};
+        }
+        // Like Google Benchmark: 40 % more than the prediction, at most 10 times more
+        double next = (wall_s > 0) ? iterations*min_time_s*1.4/wall_s : iterations*10.0;
+        iterations = (uint64_t)std::min(std::max(next, iterations + 1.0), iterations*10.0);
+        iterations = std::min<uint64_t>(iterations, MAX_ITERATIONS);
+    }
+}
+
+} // namespace bench
+
+using bench::State;
+
+
+// Hex of the frame, as decimal2Hex leaves it for the rest of the firmware
+static void frame_hex(const bench::Frame *frame, char hex[]){
+
+    decimal2Hex((const char*)frame->data, hex);
+}
+
+static void get_CANframe(State &state){
+
+    // The flags of the firmware: a whole single frame (Read codes), the data of ISO-TP (VIN)
+    bool only_data = (state.frame->data[0] >> 4) != 0;
+
+    for (auto _ : state){
+
+        char *CAN_frame = NULL;
+
+        get_CANframe(&CAN_frame, (char*)state.frame->data, only_data, false);
+        bench::do_not_optimize(CAN_frame[0]);
+        vPortFree(CAN_frame);
+    }
+}
+BENCHMARK_FRAMES(get_CANframe);
+
+static void decimal2Hex(State &state){
+
+    char hex[HEX_FRAME_CHARS+1];
+
+    for (auto _ : state){
+
+        decimal2Hex((const char*)state.frame->data, hex);
+        bench::do_not_optimize(hex);
+    }
+}
+BENCHMARK_FRAMES(decimal2Hex);
+
+static void hex2Binary(State &state){
+
+    char hex[HEX_FRAME_CHARS+1];
+
+    frame_hex(state.frame, hex);
+    for (auto _ : state){
+
+        char *binary = NULL;
+
+        hex2Binary(hex, &binary);
+        bench::do_not_optimize(binary[0]);
+        vPortFree(binary);
+    }
+}
+BENCHMARK_FRAMES(hex2Binary);
+
+// The two characters of every byte of the frame
+static void hex2Decimal(State &state){
+
+    char hex[HEX_FRAME_CHARS+1];
+    char byte[MAX_BYTES][3];
+
+    frame_hex(state.frame, hex);
+    for (int i = 0; i < MAX_BYTES; i++){
+
+        byte[i][0] = hex[2*i];
+        byte[i][1] = hex[2*i+1];
+        byte[i][2] = '\0';
+    }
+    for (auto _ : state){
+
+        uint32_t sum = 0;
+
+        for (int i = 0; i < MAX_BYTES; i++){
+
+            sum += hex2Decimal(byte[i]);
+        }
+        bench::do_not_optimize(sum);
+    }
+}
+BENCHMARK_FRAMES(hex2Decimal);
+
+// Stored DTC P0133, on the response to the DTC of the freeze frame (02 02)
+static void get_DTC_decoded(State &state){
+
+    char input[] = "0133";
+    char decoded[NUM_CHAR_DTC+1];
+
+    for (auto _ : state){
+
+        bench::do_not_optimize(get_DTC_decoded(input, decoded));
+        bench::do_not_optimize(decoded);
+    }
+}
+BENCHMARK(get_DTC_decoded);
+
+static void decode_DTC(State &state){
+
+    char input[] = "0133";
+    char decoded[NUM_CHAR_DTC+1];
+    char *binary = NULL;
+
+    hex2Binary(input, &binary);
+    for (auto _ : state){
+
+        bench::do_not_optimize(decode_DTC(binary, input, decoded));
+        bench::do_not_optimize(decoded);
+    }
+    vPortFree(binary);
+}
+BENCHMARK(decode_DTC);
+
+// Replacement of get_DTC_decoded (OBD_protocol.c): from the bytes of the frame
+static void decode_DTCbytes(State &state){
+
+    char decoded[NUM_CHAR_DTC+1];
+
+    for (auto _ : state){
+
+        decode_DTCbytes(0x01, 0x33, decoded);
+        bench::do_not_optimize(decoded);
+    }
+}
+BENCHMARK(decode_DTCbytes);
+
+// Bitmap of PID 00 of the ECM (32 bits, the ones above 0x80 included)
+static void find_PIDsupported(State &state){
+
+    char bitmap_hex[] = "BE1FA813";
+    char *binary = NULL;
+    char decimal[33];
+
+    hex2Binary(bitmap_hex, &binary);
+    for (auto _ : state){
+
+        find_PIDsupported(binary, decimal);
+        bench::do_not_optimize(decimal);
+    }
+    vPortFree(binary);
+}
+BENCHMARK(find_PIDsupported);
+
+// Every PID of the live data
+static void decode_CANdata(State &state){
+
+    for (auto _ : state){
+
+        double sum = 0;
+
+        for (uint8_t posPID = 0; posPID < NUM_LIVE_DATA_PIDS; posPID++){
+
+            sum += decode_CANdata(posPID, 0x1A, 0xF8);
+        }
+        bench::do_not_optimize(sum);
+    }
+}
+BENCHMARK(decode_CANdata);
+
+static void format_liveDataValue(State &state){
+
+    static const double values[] = {1726.0, 98.0, -6.25, 0.25, 65535.0, 3.5};
+    char output[7];
+    size_t i = 0;
+
+    for (auto _ : state){
+
+        format_liveDataValue(values[i], output);
+        bench::do_not_optimize(output);
+        i = (i + 1) % (sizeof(values)/sizeof(values[0]));
+    }
+}
+BENCHMARK(format_liveDataValue);
+
+// The value and the name of the PID on the null display (CAN_device.c)
+static void show_liveData(State &state){
+
+    uint8_t row = 0;
+
+    for (auto _ : state){
+
+        show_liveData(1726.0, row);
+        row = (row + 1) % NUM_LIVE_DATA_PIDS;
+    }
+}
+BENCHMARK(show_liveData);
+
+// Only the value (OBD_protocol.c, used by the rows of the live data view)
+static void show_liveDataValue(State &state){
+
+    uint8_t row = 0;
+
+    for (auto _ : state){
+
+        show_liveDataValue(1726.0, row);
+        row = (row + 1) % NUM_LIVE_DATA_PIDS;
+    }
+}
+BENCHMARK(show_liveDataValue);
+
+// A response of the live data to the screen, the way Live_data_task of CAN_device.c does it
+static void live_data_strings(State &state){
+
+    uint8_t response[8] = {0x04, 0x41, 0x0C, 0x1A, 0xF8, 0x55, 0x55, 0x55};
+    uint8_t posPID = 4;
+
+    for (auto _ : state){
+
+        char *CAN_data = NULL;
+        char A[3], B[3];
+
+        get_CANframe(&CAN_data, (char*)response, true, false);
+        memcpy(A, CAN_data, 2);
+        memcpy(B, CAN_data+2, 2);
+        A[2] = B[2] = '\0';
+        show_liveData(decode_CANdata(posPID, (double)hex2Decimal(A), (double)hex2Decimal(B)), posPID);
+        vPortFree(CAN_data);
+    }
+}
+BENCHMARK(live_data_strings);
+
+// The same with the bytes of the frame (read_PIDvalue of OBD_protocol.c)
+static void live_data_bytes(State &state){
+
+    uint8_t response[8] = {0x04, 0x41, 0x0C, 0x1A, 0xF8, 0x55, 0x55, 0x55};
+    uint8_t posPID = 4;
+
+    for (auto _ : state){
+
+        bench::do_not_optimize(response);
+        show_liveDataValue(decode_CANdata(posPID, (double)response[3], (double)response[4]), posPID);
+    }
+}
+BENCHMARK(live_data_bytes);
+
+
+static void print_usage(const char *program){
+
+    fprintf(stderr, "Usage: %s [--benchmark_filter=REGEX] [--benchmark_min_time=S] [--benchmark_repetitions=N]\n"
+            "       [--benchmark_format=console|json] [--benchmark_out=FILE]\n", program);
+}
+
+static std::string json_string(const std::string &text){
+
+    std::string escaped;
+
+    for (char c : text){
+
+        if ((c == '"') || (c == '\\')){
+
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+
+    return "\"" + escaped + "\"";
+}
+
+static void write_json(FILE *file, const char *program, const std::vector<bench::Result> &results,
+                       const std::vector<std::string> &run_types, int repetitions){
+
+    char host[256] = "";
+    char date[32];
+    time_t now = time(nullptr);
+
+    gethostname(host, sizeof(host) - 1);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+    fprintf(file, "{\n  \"context\": {\n");
+    fprintf(file, "    \"date\": %s,\n", json_string(date).c_str());
+    fprintf(file, "    \"host_name\": %s,\n", json_string(host).c_str());
+    fprintf(file, "    \"executable\": %s,\n", json_string(program).c_str());
+    fprintf(file, "    \"num_cpus\": %u,\n", std::max(1u, std::thread::hardware_concurrency()));
+#ifdef NDEBUG
+    fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+    fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+    fprintf(file, "  },\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++){
+
+        const bench::Result &result = results[i];
+        bool aggregate = (run_types[i] != "iteration");
+        std::string run_name = result.name;
+
+        if (aggregate){
+
+            run_name = run_name.substr(0, run_name.rfind('_'));
+        }
+        fprintf(file, "    {\n      \"name\": %s,\n      \"run_name\": %s,\n      \"run_type\": \"%s\",\n",
+                json_string(result.name).c_str(), json_string(run_name).c_str(), aggregate ? "aggregate" : "iteration");
+        fprintf(file, "      \"repetitions\": %d,\n", repetitions);
+        if (aggregate){
+
+            fprintf(file, "      \"aggregate_name\": \"%s\",\n", run_types[i].c_str());
+        }
+        fprintf(file, "      \"threads\": 1,\n      \"iterations\": %llu,\n", (unsigned long long)result.iterations);
+        fprintf(file, "      \"real_time\": %.4f,\n      \"cpu_time\": %.4f,\n      \"time_unit\": \"ns\"\n    }%s\n",
+                result.real_ns, result.CPU_ns, (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+// Mean, median and standard deviation of the repetitions
+static void add_aggregates(const std::vector<bench::Result> &runs, std::vector<bench::Result> &results,
+                           std::vector<std::string> &run_types){
+
+    std::vector<double> real, CPU;
+    double mean_real = 0, mean_CPU = 0, var_real = 0, var_CPU = 0;
+
+    for (const bench::Result &result : runs){
+
+        real.push_back(result.real_ns);
+        CPU.push_back(result.CPU_ns);
+        mean_real += result.real_ns/runs.size();
+        mean_CPU += result.CPU_ns/runs.size();
+    }
+    for (const bench::Result &result : runs){
+
+        var_real += (result.real_ns - mean_real)*(result.real_ns - mean_real)/(runs.size() - 1);
+        var_CPU += (result.CPU_ns - mean_CPU)*(result.CPU_ns - mean_CPU)/(runs.size() - 1);
+    }
+    std::sort(real.begin(), real.end());
+    std::sort(CPU.begin(), CPU.end());
+    size_t half = runs.size()/2;
+    double median_real = (runs.size() % 2) ? real[half] : (real[half-1] + real[half])/2;
+    double median_CPU = (runs.size() % 2) ? CPU[half] : (CPU[half-1] + CPU[half])/2;
+
+    results.push_back({runs[0].name + "_mean", runs[0].iterations, mean_real, mean_CPU});
+    run_types.push_back("mean");
+    results.push_back({runs[0].name + "_median", runs[0].iterations, median_real, median_CPU});
+    run_types.push_back("median");
+    results.push_back({runs[0].name + "_stddev", runs[0].iterations, std::sqrt(var_real), std::sqrt(var_CPU)});
+    run_types.push_back("stddev");
+}
+
+int main(int argc, char *argv[]){
+
+    std::regex filter(".");
+    double min_time_s = DEFAULT_MIN_TIME_S;
+    int repetitions = 1;
+    bool json = false;
+    std::string out_path;
+    std::vector<bench::Result> results;
+    std::vector<std::string> run_types;
+
+    for (int i = 1; i < argc; i++){
+
+        std::string option = argv[i];
+        std::string value = option.substr(option.find('=') + 1);
+
+        if (option.rfind("--benchmark_filter=", 0) == 0){
+
+            filter = std::regex(value);
+        }else if (option.rfind("--benchmark_min_time=", 0) == 0){
+
+            // Also "0.5s", as Google Benchmark takes it
+            min_time_s = strtod(value.c_str(), nullptr);
+        }else if (option.rfind("--benchmark_repetitions=", 0) == 0){
+
+            repetitions = std::max(1, atoi(value.c_str()));
+        }else if ((option == "--benchmark_format=json") || (option == "--benchmark_format=console")){
+
+            json = (value == "json");
+        }else if (option.rfind("--benchmark_out=", 0) == 0){
+
+            out_path = value;
+        }else {
+
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!json){
+
+        printf("%-36s %14s %14s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+    }
+    for (const bench::Benchmark &benchmark : bench::registered()){
+
+        std::vector<bench::Result> runs;
+
+        if (!std::regex_search(benchmark.name, filter)){
+
+            continue;
+        }
+        for (int repetition = 0; repetition < repetitions; repetition++){
+
+            runs.push_back(bench::run(benchmark, min_time_s));
+            results.push_back(runs.back());
+            run_types.push_back("iteration");
+            if (!json){
+
+                printf("%-36s %11.1f ns %11.1f ns %12llu\n", runs.back().name.c_str(), runs.back().real_ns,
+                       runs.back().CPU_ns, (unsigned long long)runs.back().iterations);
+            }
+        }
+        if (repetitions > 1){
+
+            add_aggregates(runs, results, run_types);
+            for (size_t i = results.size() - 3; !json && (i < results.size()); i++){
+
+                printf("%-36s %11.1f ns %11.1f ns %12llu\n", results[i].name.c_str(), results[i].real_ns,
+                       results[i].CPU_ns, (unsigned long long)results[i].iterations);
+            }
+        }
+    }
+
+    if (json){
+
+        write_json(stdout, argv[0], results, run_types, repetitions);
+    }
+    if (!out_path.empty()){
+
+        FILE *file = fopen(out_path.c_str(), "w");
+
+        if (file == nullptr){
+
+            perror(out_path.c_str());
+            return EXIT_FAILURE;
+        }
+        write_json(file, argv[0], results, run_types, repetitions);
+        if (fclose(file) != 0){
+
+            perror(out_path.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    return results.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,1163 @@
+/*
+ * firmware_sim.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Virtual clock, interrupts and the simple peripherals of the simulator (firmware_sim.h).
+ *      The busy waits of the firmware (while(!time_expired);) never call the simulator, so a
+ *      watchdog (SIGVTALRM, CPU time of the process) looks at the progress of the running task: a
+ *      task that has not called the simulator nor been switched during two whole periods is
+ *      waiting for an interrupt. The
+ *      watchdog then takes the events of the clock until an interrupt of a peripheral or a task
+ *      made ready can end the wait. The time is the same whenever the PC sends the signal, so the
+ *      runs stay deterministic.
+ */
+
+// C libraries
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+
+// TIVA libraries
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_nvic.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/gpio.h"
+#include "driverlib/timer.h"
+#include "driverlib/ssi.h"
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+// Programmer libraries
+#include "firmware_sim.h"
+
+#define NUM_PORTS 6
+#define NUM_TIMERS 12
+#define WATCHDOG_BUSY_PERIODS 2             // No progress: busy wait (one period can be cut by the signal)
+#define WATCHDOG_STUCK_PERIODS 4000         // Busy wait with the interrupts masked: the firmware hangs
+#define ISR_REPEAT_LIMIT 100000             // Same interrupt again and again: the ISR does not clear it
+#define LCD_DC_PIN GPIO_PIN_6               // Data/command of the display (PA6, ST7735.c)
+#define LCD_RST_PIN GPIO_PIN_7
+#define UART0_RX_CHARS 128                  // UART_RX_BUFFER_SIZE of uartstdio
+#define UART0_TX_CHARS 256                  // UART_TX_BUFFER_SIZE of uartstdio
+#define UART0_INPUT_CHARS 1024
+#define UART0_RAW_BYTES 512                 // UART_RAW_BUFFER_SIZE of uartstdio
+#define UART0_BITS_PER_CHAR 10              // 8N1
+
+typedef struct{
+
+    uint32_t base;
+    uint32_t interrupt;
+    uint8_t data;
+    uint8_t direction;
+    uint8_t input;              // Level of the pins from outside (pull-ups)
+    uint8_t mask;               // GPIOIM
+    uint8_t raw;                // GPIORIS
+    uint8_t sense;              // GPIOIS (level)
+    uint8_t both;               // GPIOIBE
+    uint8_t event;              // GPIOIEV (rising or high)
+}tPort;
+
+typedef struct{
+
+    uint32_t base;
+    uint32_t peripheral;
+    uint32_t interrupt;
+    bool enabled;
+    bool periodic;
+    bool run_in_sleep;
+    uint64_t load;
+    uint64_t elapsed;           // Cycles of the period before the last enable
+    uint64_t start_ns;          // Clock (or CPU time) of the last enable
+    uint32_t mask;              // GPTMIMR
+    uint32_t raw;               // GPTMRIS
+    tSimAlarm timeout;
+}tTimer;
+
+// Vector table of tm4c123gh6pm_startup_ccs.c
+extern void AntiBounceIntHandler(void);
+extern void systemPause_TimerISR(void);
+extern void ButtonsIntHandler(void);
+extern void CANIntHandler(void);
+extern void UARTStdioIntHandler(void);
+extern void xPortSysTickHandler(void);
+
+typedef struct{
+
+    uint32_t interrupt;
+    void (*handler)(void);
+}tVector;
+
+static const tVector vectors[] = {
+    {FAULT_SYSTICK, xPortSysTickHandler},
+    {INT_GPIOE, AntiBounceIntHandler},
+    {INT_TIMER2A, systemPause_TimerISR},
+    {INT_TIMER3A, ButtonsIntHandler},
+    {INT_CAN0, CANIntHandler},
+    {INT_UART0, UARTStdioIntHandler},
+};
+#define NUM_VECTORS (sizeof(vectors)/sizeof(vectors[0]))
+
+// Global variables
+static uint64_t now_ns = 0;
+static uint64_t CPU_ns = 0;                 // Not sleeping
+static uint32_t clock_hz = 16000000;        // PIOSC after the reset
+static tSimAlarm *alarms = NULL;
+static tSimStats stats;
+static bool sleeping = false;
+static bool busy_waiting = false;
+static volatile uint32_t inside = 0;        // Simulator code running (the watchdog waits)
+static volatile uint32_t progress = 0;
+
+static bool line[NUM_INTERRUPTS];
+static bool pending[NUM_INTERRUPTS];
+static bool enabled[NUM_INTERRUPTS];
+static uint8_t priority[NUM_INTERRUPTS];
+static bool master_disabled = false;
+static FILE *UART0_file = NULL;
+static QueueHandle_t UART0_rx = NULL;
+static QueueHandle_t UART0_tx = NULL;           // Not used, the heap keeps them like on the board
+static SemaphoreHandle_t UART0_txMutex = NULL;
+static char UART0_input[UART0_INPUT_CHARS];   // Typed, not in the queue yet
+static size_t UART0_inputChars = 0;
+static uint32_t UART0_baud = 115200;
+static uint64_t UART0_rawEndNs = 0;         // The ring of UARTwriteRaw is empty at this time
+
+static tSimAlarm tick_alarm;
+static uint64_t last_tick_ns;
+static uint64_t tick_ns;
+
+static uint32_t SSI0_bitrate = 1000000;
+
+static tPort ports[NUM_PORTS] = {
+    {GPIO_PORTA_BASE, INT_GPIOA, 0, 0, 0xFF, 0, 0, 0, 0, 0},
+    {GPIO_PORTB_BASE, INT_GPIOB, 0, 0, 0xFF, 0, 0, 0, 0, 0},
+    {GPIO_PORTC_BASE, INT_GPIOC, 0, 0, 0xFF, 0, 0, 0, 0, 0},
+    {GPIO_PORTD_BASE, INT_GPIOD, 0, 0, 0xFF, 0, 0, 0, 0, 0},
+    {GPIO_PORTE_BASE, INT_GPIOE, 0, 0, 0xFF, 0, 0, 0, 0, 0},
+    {GPIO_PORTF_BASE, INT_GPIOF, 0, 0, 0xFF, 0, 0, 0, 0, 0},
+};
+
+static tTimer timers[NUM_TIMERS] = {
+    {.base = TIMER0_BASE, .peripheral = SYSCTL_PERIPH_TIMER0, .interrupt = INT_TIMER0A, .run_in_sleep = true},
+    {.base = TIMER1_BASE, .peripheral = SYSCTL_PERIPH_TIMER1, .interrupt = INT_TIMER1A, .run_in_sleep = true},
+    {.base = TIMER2_BASE, .peripheral = SYSCTL_PERIPH_TIMER2, .interrupt = INT_TIMER2A, .run_in_sleep = true},
+    {.base = TIMER3_BASE, .peripheral = SYSCTL_PERIPH_TIMER3, .interrupt = INT_TIMER3A, .run_in_sleep = true},
+    {.base = TIMER4_BASE, .peripheral = SYSCTL_PERIPH_TIMER4, .interrupt = INT_TIMER4A, .run_in_sleep = true},
+    {.base = TIMER5_BASE, .peripheral = SYSCTL_PERIPH_TIMER5, .interrupt = INT_TIMER5A, .run_in_sleep = true},
+    {.base = WTIMER0_BASE, .peripheral = SYSCTL_PERIPH_WTIMER0, .interrupt = INT_WTIMER0A, .run_in_sleep = true},
+    {.base = WTIMER1_BASE, .peripheral = SYSCTL_PERIPH_WTIMER1, .interrupt = INT_WTIMER1A, .run_in_sleep = true},
+    {.base = WTIMER2_BASE, .peripheral = SYSCTL_PERIPH_WTIMER2, .interrupt = INT_WTIMER2A, .run_in_sleep = true},
+    {.base = WTIMER3_BASE, .peripheral = SYSCTL_PERIPH_WTIMER3, .interrupt = INT_WTIMER3A, .run_in_sleep = true},
+    {.base = WTIMER4_BASE, .peripheral = SYSCTL_PERIPH_WTIMER4, .interrupt = INT_WTIMER4A, .run_in_sleep = true},
+    {.base = WTIMER5_BASE, .peripheral = SYSCTL_PERIPH_WTIMER5, .interrupt = INT_WTIMER5A, .run_in_sleep = true},
+};
+
+
+static void fail(const char *message, uint32_t value){
+
+    fprintf(stderr, "Simulator: %s (0x%08X) at %.6f s\n", message, value, now_ns/1e9);
+    abort();
+}
+
+static uint64_t cycles_ns(uint64_t cycles){
+
+    return (uint64_t)((unsigned __int128)cycles*1000000000u/clock_hz);
+}
+
+static uint64_t ns_cycles(uint64_t ns){
+
+    return (uint64_t)((unsigned __int128)ns*clock_hz/1000000000u);
+}
+
+
+// Clock and events
+uint64_t sim_timeNs(void){
+
+    return now_ns;
+}
+
+uint32_t sim_clockHz(void){
+
+    return clock_hz;
+}
+
+const tSimStats *sim_stats(void){
+
+    return &stats;
+}
+
+bool sim_inside(void){
+
+    return inside > 0;
+}
+
+void sim_setAlarm(tSimAlarm *alarm, uint64_t time_ns){
+
+    tSimAlarm *listed = alarms;
+
+    while ((listed != NULL) && (listed != alarm)){
+
+        listed = listed->next;
+    }
+    if (listed == NULL){
+
+        alarm->next = alarms;
+        alarms = alarm;
+    }
+    alarm->time_ns = (time_ns < now_ns) ? now_ns : time_ns;
+    alarm->armed = true;
+}
+
+void sim_cancelAlarm(tSimAlarm *alarm){
+
+    alarm->armed = false;
+}
+
+static tSimAlarm *next_alarm(void){
+
+    tSimAlarm *next = NULL;
+
+    for (tSimAlarm *alarm = alarms; alarm != NULL; alarm = alarm->next){
+
+        if (alarm->armed && ((next == NULL) || (alarm->time_ns < next->time_ns))){
+
+            next = alarm;
+        }
+    }
+
+    return next;
+}
+
+static void advance(uint64_t time_ns){
+
+    uint64_t elapsed;
+
+    if (time_ns <= now_ns){
+
+        return;
+    }
+    elapsed = time_ns - now_ns;
+    if (sleeping){
+
+        stats.sleep_ns += elapsed;
+    }else {
+
+        CPU_ns += elapsed;
+        if (busy_waiting){
+
+            stats.busy_wait_ns += elapsed;
+        }
+    }
+    now_ns = time_ns;
+}
+
+static void fire(tSimAlarm *alarm){
+
+    advance(alarm->time_ns);
+    alarm->armed = false;
+    alarm->fire(alarm->context);
+    sim_deliverInterrupts();
+}
+
+// Events up to time_ns. It stops at the one that asks for a context switch (true).
+static bool run_until(uint64_t time_ns){
+
+    tSimAlarm *alarm;
+
+    while (((alarm = next_alarm()) != NULL) && (alarm->time_ns <= time_ns)){
+
+        fire(alarm);
+        if (sim_portYieldPending() && (!sim_portMasked())){
+
+            return true;
+        }
+    }
+    advance(time_ns);
+
+    return false;
+}
+
+void sim_spendNs(uint64_t ns){
+
+    uint64_t end_ns = now_ns + ns;
+
+    progress++;
+    inside++;
+    while (run_until(end_ns)){
+
+        inside--;
+        sim_portSwitch();
+        inside++;
+    }
+    inside--;
+}
+
+// Idle task: sleep until the next event
+void SysCtlSleep(void){
+
+    tSimAlarm *alarm = next_alarm();
+
+    progress++;
+    if ((alarm == NULL) || sim_portMasked()){
+
+        return;
+    }
+    inside++;
+    sleeping = true;
+    run_until(alarm->time_ns);
+    sleeping = false;
+    inside--;
+    sim_portSwitch();
+}
+
+// The running task waits for an interrupt without calling anything: the events go on until one
+// can end the wait (not the tick alone, it only slices the time with the Idle task)
+static void busy_wait(void){
+
+    uint32_t readied = ulPortTasksReadied;
+    uint64_t interrupts = stats.interrupts;
+    tSimAlarm *alarm;
+
+    stats.busy_waits++;
+    inside++;
+    busy_waiting = true;
+    while ((alarm = next_alarm()) != NULL){
+
+        fire(alarm);
+        if ((ulPortTasksReadied != readied) || (stats.interrupts != interrupts)){
+
+            break;
+        }
+        sim_portClearYield();
+    }
+    busy_waiting = false;
+    inside--;
+    sim_portSwitch();
+}
+
+static void watchdog(int signal){
+
+    static uint64_t last_progress = 0;
+    static uint32_t stuck = 0;
+    uint64_t current = progress + sim_portSwitches();
+
+    (void)signal;
+    if ((inside > 0) || (!sim_portStarted())){
+
+        return;
+    }
+    if (current != last_progress){
+
+        last_progress = current;
+        stuck = 0;
+        return;
+    }
+    if (sim_portMasked()){
+
+        if (++stuck == WATCHDOG_STUCK_PERIODS){
+
+            fail("busy wait with the interrupts masked", 0);
+        }
+        return;
+    }
+    if (++stuck < WATCHDOG_BUSY_PERIODS){
+
+        return;
+    }
+    busy_wait();
+    last_progress = progress + sim_portSwitches();
+    stuck = 0;
+}
+
+void sim_startWatchdog(void){
+
+    struct sigaction action;
+    struct itimerval period;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = watchdog;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGVTALRM, &action, NULL);
+
+    period.it_interval.tv_sec = 0;
+    period.it_interval.tv_usec = SIM_WATCHDOG_US;
+    period.it_value = period.it_interval;
+    // CPU time: a PC busy with other runs does not look like a busy wait
+    setitimer(ITIMER_VIRTUAL, &period, NULL);
+}
+
+
+// NVIC
+void sim_setInterruptLine(uint32_t interrupt, bool level){
+
+    line[interrupt] = level;
+}
+
+// Pending interrupts, by priority (and number), while the interrupts are not masked
+void sim_deliverInterrupts(void){
+
+    const tVector *last = NULL;
+    uint32_t repeated = 0;
+
+    inside++;
+    while ((!master_disabled) && (!sim_portMasked())){
+
+        const tVector *next = NULL;
+
+        for (uint32_t i = 0; i < NUM_VECTORS; i++){
+
+            uint32_t interrupt = vectors[i].interrupt;
+
+            if (enabled[interrupt] && (line[interrupt] || pending[interrupt])){
+
+                if ((next == NULL) || (priority[interrupt] < priority[next->interrupt])){
+
+                    next = &vectors[i];
+                }
+            }
+        }
+        if (next == NULL){
+
+            break;
+        }
+        repeated = (next == last) ? repeated+1 : 0;
+        if (repeated == ISR_REPEAT_LIMIT){
+
+            fail("interrupt not cleared by its ISR", next->interrupt);
+        }
+        last = next;
+        pending[next->interrupt] = false;
+        if (next->interrupt == FAULT_SYSTICK){
+
+            stats.ticks++;
+        }else {
+
+            stats.interrupts++;
+        }
+        sim_portISR(next->handler);
+    }
+    inside--;
+}
+
+void IntEnable(uint32_t ui32Interrupt){
+
+    progress++;
+    enabled[ui32Interrupt] = true;
+    sim_deliverInterrupts();
+}
+
+void IntDisable(uint32_t ui32Interrupt){
+
+    enabled[ui32Interrupt] = false;
+}
+
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority){
+
+    priority[ui32Interrupt] = ui8Priority;
+}
+
+bool IntMasterEnable(void){
+
+    bool previous = master_disabled;
+
+    master_disabled = false;
+    sim_deliverInterrupts();
+
+    return previous;
+}
+
+bool IntMasterDisable(void){
+
+    bool previous = master_disabled;
+
+    master_disabled = true;
+
+    return previous;
+}
+
+
+// SysTick
+static void tick(void *context){
+
+    (void)context;
+    last_tick_ns = tick_alarm.time_ns;
+    pending[FAULT_SYSTICK] = true;
+    sim_setAlarm(&tick_alarm, last_tick_ns + tick_ns);
+}
+
+void sim_startTick(void){
+
+    tick_ns = 1000000000u/configTICK_RATE_HZ;
+    last_tick_ns = now_ns;
+    stats.boot_ns = now_ns;
+    enabled[FAULT_SYSTICK] = true;
+    priority[FAULT_SYSTICK] = configKERNEL_INTERRUPT_PRIORITY;
+    tick_alarm.fire = tick;
+    tick_alarm.context = NULL;
+    sim_setAlarm(&tick_alarm, now_ns + tick_ns);
+}
+
+// Registers read by the firmware with HWREG (host_target.h)
+volatile uint32_t *sim_HWREG(uint32_t address){
+
+    static uint32_t value;
+    uint32_t reload = (uint32_t)(ns_cycles(tick_ns) - 1);
+
+    switch (address){
+
+        case NVIC_ST_RELOAD:
+            value = reload;
+            break;
+
+        case NVIC_ST_CURRENT:
+            value = reload - (uint32_t)ns_cycles(now_ns - last_tick_ns);
+            break;
+
+        case NVIC_INT_CTRL:
+            value = pending[FAULT_SYSTICK] ? NVIC_INT_CTRL_PENDSTSET : 0;
+            break;
+
+        default:
+            if ((address >= CAN0_BASE) && (address < CAN0_BASE + 0x1000)){
+
+                return sim_CANregister(address - CAN0_BASE);
+            }
+            fail("register not simulated", address);
+    }
+
+    return &value;
+}
+
+
+// SysCtl
+void SysCtlClockSet(uint32_t ui32Config){
+
+    uint32_t divider = ((ui32Config >> 23) & 0x0F) + 1;
+
+    if (ui32Config & SYSCTL_USE_OSC){
+
+        clock_hz = 16000000/divider;
+    }else {
+
+        clock_hz = 200000000/divider;
+    }
+}
+
+uint32_t SysCtlClockGet(void){
+
+    return clock_hz;
+}
+
+// 3 cycles every loop
+void SysCtlDelay(uint32_t ui32Count){
+
+    sim_spendNs(cycles_ns(3*(uint64_t)ui32Count));
+}
+
+static tTimer *timer_of_peripheral(uint32_t peripheral){
+
+    for (uint32_t i = 0; i < NUM_TIMERS; i++){
+
+        if (timers[i].peripheral == peripheral){
+
+            return &timers[i];
+        }
+    }
+
+    return NULL;
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral){
+
+    (void)ui32Peripheral;
+}
+
+void SysCtlPeripheralClockGating(bool bEnable){
+
+    (void)bEnable;
+}
+
+// The timers that do not run in sleep mode only count the CPU time (utils/cpu_usage.c). The
+// others run: the firmware only sleeps on the simulator (idle hook), so it does not enable them.
+void SysCtlPeripheralSleepEnable(uint32_t ui32Peripheral){
+
+    tTimer *timer = timer_of_peripheral(ui32Peripheral);
+
+    if (timer != NULL){
+
+        timer->run_in_sleep = true;
+    }
+}
+
+void SysCtlPeripheralSleepDisable(uint32_t ui32Peripheral){
+
+    tTimer *timer = timer_of_peripheral(ui32Peripheral);
+
+    if (timer != NULL){
+
+        timer->run_in_sleep = false;
+    }
+}
+
+
+// Timers: full width, counting down from the load value
+static tTimer *timer_of(uint32_t base){
+
+    for (uint32_t i = 0; i < NUM_TIMERS; i++){
+
+        if (timers[i].base == base){
+
+            return &timers[i];
+        }
+    }
+    fail("unknown timer", base);
+
+    return NULL;
+}
+
+static uint64_t timer_clock(const tTimer *timer){
+
+    return timer->run_in_sleep ? now_ns : CPU_ns;
+}
+
+static uint64_t timer_cycles(const tTimer *timer){
+
+    uint64_t cycles = timer->elapsed;
+
+    if (timer->enabled){
+
+        cycles += ns_cycles(timer_clock(timer) - timer->start_ns);
+    }
+    if (timer->load == UINT64_MAX){
+
+        return cycles;
+    }
+
+    return cycles % (timer->load + 1);
+}
+
+static void timer_timeout(void *context);
+
+// Only the timers of the clock with the timeout interrupt enabled need an event
+static void timer_schedule(tTimer *timer){
+
+    sim_cancelAlarm(&timer->timeout);
+    if (timer->enabled && timer->run_in_sleep && (timer->mask & TIMER_TIMA_TIMEOUT) && (timer->load != UINT64_MAX)){
+
+        timer->timeout.fire = timer_timeout;
+        timer->timeout.context = timer;
+        sim_setAlarm(&timer->timeout, now_ns + cycles_ns(timer->load + 1 - timer_cycles(timer)));
+    }
+}
+
+static void timer_line(const tTimer *timer){
+
+    sim_setInterruptLine(timer->interrupt, (timer->raw & timer->mask) != 0);
+}
+
+static void timer_timeout(void *context){
+
+    tTimer *timer = context;
+
+    timer->raw |= TIMER_TIMA_TIMEOUT;
+    timer->elapsed = 0;
+    timer->start_ns = timer_clock(timer);
+    if (!timer->periodic){
+
+        timer->enabled = false;
+    }
+    timer_schedule(timer);
+    timer_line(timer);
+}
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config){
+
+    tTimer *timer = timer_of(ui32Base);
+
+    timer->enabled = false;
+    timer->periodic = (ui32Config & 0x03) == (TIMER_CFG_PERIODIC & 0x03);
+    timer->elapsed = 0;
+    timer->raw = 0;
+    timer_schedule(timer);
+    timer_line(timer);
+}
+
+void TimerControlStall(uint32_t ui32Base, uint32_t ui32Timer, bool bStall){
+
+    (void)ui32Base;
+    (void)ui32Timer;
+    (void)bStall;
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value){
+
+    tTimer *timer = timer_of(ui32Base);
+
+    (void)ui32Timer;
+    timer->load = ui32Value;
+    timer->elapsed = 0;
+    timer->start_ns = timer_clock(timer);
+    timer_schedule(timer);
+}
+
+void TimerLoadSet64(uint32_t ui32Base, uint64_t ui64Value){
+
+    tTimer *timer = timer_of(ui32Base);
+
+    timer->load = ui64Value;
+    timer->elapsed = 0;
+    timer->start_ns = timer_clock(timer);
+    timer_schedule(timer);
+}
+
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer){
+
+    tTimer *timer = timer_of(ui32Base);
+
+    (void)ui32Timer;
+    progress++;
+    if (!timer->enabled){
+
+        timer->enabled = true;
+        timer->start_ns = timer_clock(timer);
+        timer_schedule(timer);
+    }
+}
+
+void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer){
+
+    tTimer *timer = timer_of(ui32Base);
+
+    (void)ui32Timer;
+    if (timer->enabled){
+
+        timer->elapsed = timer_cycles(timer);
+        timer->enabled = false;
+        timer_schedule(timer);
+    }
+}
+
+uint32_t TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer){
+
+    tTimer *timer = timer_of(ui32Base);
+
+    (void)ui32Timer;
+    progress++;
+
+    return (uint32_t)(timer->load - timer_cycles(timer));
+}
+
+uint64_t TimerValueGet64(uint32_t ui32Base){
+
+    tTimer *timer = timer_of(ui32Base);
+
+    progress++;
+
+    return timer->load - timer_cycles(timer);
+}
+
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    tTimer *timer = timer_of(ui32Base);
+
+    timer->mask |= ui32IntFlags;
+    timer_schedule(timer);
+    timer_line(timer);
+}
+
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    tTimer *timer = timer_of(ui32Base);
+
+    timer->raw &= ~ui32IntFlags;
+    timer_line(timer);
+}
+
+
+// GPIO
+static tPort *port_of(uint32_t base){
+
+    for (uint32_t i = 0; i < NUM_PORTS; i++){
+
+        if (ports[i].base == base){
+
+            return &ports[i];
+        }
+    }
+    fail("unknown GPIO port", base);
+
+    return NULL;
+}
+
+static uint8_t pin_levels(const tPort *port){
+
+    return (port->data & port->direction) | (port->input & ~port->direction);
+}
+
+static void port_line(tPort *port){
+
+    uint8_t levels = pin_levels(port);
+
+    // Level interrupts stay while the level is there
+    port->raw |= port->sense & ((levels & port->event) | (~levels & ~port->event));
+    sim_setInterruptLine(port->interrupt, (port->raw & port->mask) != 0);
+}
+
+static void set_input(tPort *port, uint8_t input){
+
+    uint8_t before = pin_levels(port);
+    uint8_t after;
+    uint8_t edges = ~port->sense;
+
+    port->input = input;
+    after = pin_levels(port);
+    port->raw |= edges & before & ~after & (port->both | ~port->event);     // Falling
+    port->raw |= edges & ~before & after & (port->both | port->event);      // Rising
+    port_line(port);
+}
+
+void sim_setButtons(uint8_t pins, bool pressed){
+
+    tPort *port = port_of(GPIO_PORTE_BASE);
+
+    // Active low, with pull-up
+    set_input(port, pressed ? (port->input & ~pins) : (port->input | pins));
+}
+
+void GPIODirModeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32PinIO){
+
+    tPort *port = port_of(ui32Port);
+
+    if (ui32PinIO == GPIO_DIR_MODE_OUT){
+
+        port->direction |= ui8Pins;
+    }else {
+
+        port->direction &= ~ui8Pins;
+    }
+}
+
+void GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength, uint32_t ui32PadType){
+
+    (void)ui32Port;
+    (void)ui8Pins;
+    (void)ui32Strength;
+    (void)ui32PadType;
+}
+
+void GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType){
+
+    tPort *port = port_of(ui32Port);
+
+    port->sense &= ~ui8Pins;
+    port->both &= ~ui8Pins;
+    port->event &= ~ui8Pins;
+    if (ui32IntType & GPIO_LOW_LEVEL & ~GPIO_BOTH_EDGES){
+
+        port->sense |= ui8Pins;
+    }
+    if ((ui32IntType & 0x07) == GPIO_BOTH_EDGES){
+
+        port->both |= ui8Pins;
+    }
+    if (ui32IntType & GPIO_RISING_EDGE){
+
+        port->event |= ui8Pins;
+    }
+    port_line(port);
+}
+
+void GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags){
+
+    tPort *port = port_of(ui32Port);
+
+    port->mask |= ui32IntFlags;
+    port_line(port);
+}
+
+void GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags){
+
+    tPort *port = port_of(ui32Port);
+
+    port->raw &= ~ui32IntFlags;
+    port_line(port);
+}
+
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins){
+
+    progress++;
+
+    return pin_levels(port_of(ui32Port)) & ui8Pins;
+}
+
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val){
+
+    tPort *port = port_of(ui32Port);
+    uint8_t before = port->data;
+
+    progress++;
+    port->data = (port->data & ~ui8Pins) | (ui8Val & ui8Pins);
+    if ((ui32Port == GPIO_PORTA_BASE) && (before & LCD_RST_PIN) && (!(port->data & LCD_RST_PIN))){
+
+        sim_LCDreset();
+    }
+    port_line(port);
+}
+
+void GPIOPinConfigure(uint32_t ui32PinConfig){
+
+    (void)ui32PinConfig;
+}
+
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins){
+
+    port_of(ui32Port)->direction |= ui8Pins;
+}
+
+void GPIOPinTypeCAN(uint32_t ui32Port, uint8_t ui8Pins){
+
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPinTypeSSI(uint32_t ui32Port, uint8_t ui8Pins){
+
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins){
+
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+
+// SSI0: the display. Every byte takes its time on the wire.
+void SSIConfigSetExpClk(uint32_t ui32Base, uint32_t ui32SSIClk, uint32_t ui32Protocol, uint32_t ui32Mode,
+                        uint32_t ui32BitRate, uint32_t ui32DataWidth){
+
+    (void)ui32SSIClk;
+    (void)ui32Protocol;
+    (void)ui32Mode;
+    (void)ui32DataWidth;
+    if (ui32Base == SSI0_BASE){
+
+        SSI0_bitrate = ui32BitRate;
+    }
+}
+
+void SSIEnable(uint32_t ui32Base){
+
+    (void)ui32Base;
+}
+
+void SSIDataPut(uint32_t ui32Base, uint32_t ui32Data){
+
+    if (ui32Base != SSI0_BASE){
+
+        fail("SSI not simulated", ui32Base);
+    }
+    stats.SSI_bytes++;
+    sim_LCDwrite((port_of(GPIO_PORTA_BASE)->data & LCD_DC_PIN) != 0, (uint8_t)ui32Data);
+    sim_spendNs(8*1000000000ull/SSI0_bitrate);
+}
+
+bool SSIBusy(uint32_t ui32Base){
+
+    (void)ui32Base;
+
+    return false;
+}
+
+
+// UART0 (utils/uartstdio.c): the console of the shell (Diag_shell.c). The characters typed
+// with sim_UART0input come through the interrupt to the reception queue, as in uartstdio, so
+// the shell task waits the same way. The texts and the stream of the trace (Trace_recorder.c)
+// go to the file of sim_setUART0 at once. The ring of the binary output (Live_stream.c) drains
+// at the baud rate in virtual time, so a stream faster than the UART drops frames as on the board.
+void UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock){
+
+    (void)ui32PortNum;
+    (void)ui32SrcClock;
+    UART0_baud = ui32Baud;
+    UART0_rx = xQueueCreate(UART0_RX_CHARS, sizeof(char));
+    UART0_tx = xQueueCreate(UART0_TX_CHARS, sizeof(char));
+    UART0_txMutex = xSemaphoreCreateMutex();
+    IntPrioritySet(INT_UART0, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    IntEnable(INT_UART0);
+}
+
+void sim_setUART0(FILE *file){
+
+    UART0_file = file;
+}
+
+void sim_UART0input(const char *text){
+
+    sim_UART0inputBytes(text, strlen(text));
+}
+
+void sim_UART0inputBytes(const char *bytes, size_t length){
+
+    if (UART0_inputChars + length > UART0_INPUT_CHARS){
+
+        fprintf(stderr, "Simulator: too many characters typed on UART0\n");
+        abort();
+    }
+    memcpy(UART0_input + UART0_inputChars, bytes, length);
+    UART0_inputChars += length;
+    sim_setInterruptLine(INT_UART0, UART0_inputChars > 0);
+}
+
+// Reception: the characters that fit on the queue, the rest wait for the next interrupt
+void UARTStdioIntHandler(void){
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    size_t taken = 0;
+
+    while ((taken < UART0_inputChars) && (xQueueSendFromISR(UART0_rx, &UART0_input[taken], &xHigherPriorityTaskWoken) == pdTRUE)){
+
+        taken++;
+    }
+    memmove(UART0_input, UART0_input + taken, UART0_inputChars - taken);
+    UART0_inputChars -= taken;
+    sim_setInterruptLine(INT_UART0, false);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+// '\n' goes out as "\r\n", like in uartstdio
+int UARTwrite(const char *pcBuf, uint32_t ui32Len){
+
+    progress++;
+    for (uint32_t i = 0; (UART0_file != NULL) && (i < ui32Len); i++){
+
+        if (pcBuf[i] == '\n'){
+
+            fputc('\r', UART0_file);
+        }
+        fputc(pcBuf[i], UART0_file);
+    }
+
+    return ui32Len;
+}
+
+int UARTwriteRaw(const uint8_t *pui8Buf, uint32_t ui32Len){
+
+    uint64_t now = sim_timeNs(), byte_ns = UART0_BITS_PER_CHAR*1000000000ull/UART0_baud;
+    uint64_t queued = (UART0_rawEndNs > now) ? (UART0_rawEndNs - now + byte_ns - 1)/byte_ns : 0;
+
+    progress++;
+    if (queued + ui32Len > UART0_RAW_BYTES){
+
+        return 0;
+    }
+    UART0_rawEndNs = ((UART0_rawEndNs > now) ? UART0_rawEndNs : now) + ui32Len*byte_ns;
+    if (UART0_file != NULL){
+
+        fwrite(pui8Buf, 1, ui32Len, UART0_file);
+    }
+
+    return ui32Len;
+}
+
+// The output is already written, so only the rate changes
+void UARTBaudSet(uint32_t ui32Baud){
+
+    UART0_baud = ui32Baud;
+    UART0_rawEndNs = sim_timeNs();
+}
+
+int UARTRxBytesAvail(void){
+
+    return (int)uxQueueMessagesWaiting(UART0_rx);
+}
+
+// The formats of the firmware (%u, %d, %x, %s, %c, widths) are the ones of printf
+void UARTprintf(const char *pcString, ...){
+
+    char text[512];
+    va_list arguments;
+    int length;
+
+    va_start(arguments, pcString);
+    length = vsnprintf(text, sizeof(text), pcString, arguments);
+    va_end(arguments);
+    if (length > 0){
+
+        UARTwrite(text, ((size_t)length < sizeof(text)) ? (uint32_t)length : sizeof(text) - 1);
+    }
+}
+
+// The characters that did not fit on the queue come with the next interrupt, as from a PC that
+// waits for the room (flow control)
+static void take_UART0char(char *c){
+
+    xQueueReceive(UART0_rx, c, portMAX_DELAY);
+    if (UART0_inputChars > 0){
+
+        sim_setInterruptLine(INT_UART0, true);
+    }
+}
+
+unsigned char UARTgetc(void){
+
+    char c;
+
+    take_UART0char(&c);
+
+    return c;
+}
+
+// A line up to '\r' or '\n' with the echo and the backspace
+int UARTgets(char *pcBuf, uint32_t ui32Len){
+
+    uint32_t count = 0;
+    char c;
+
+    while (1){
+
+        take_UART0char(&c);
+        if ((c == '\r') || (c == '\n')){
+
+            break;
+        }
+        if ((c == '\b') || (c == 0x7F)){
+
+            if (count > 0){
+
+                UARTwrite("\b \b", 3);
+                count--;
+            }
+            continue;
+        }
+        if (count + 1 < ui32Len){
+
+            pcBuf[count++] = c;
+            UARTwrite(&c, 1);
+        }
+    }
+    pcBuf[count] = '\0';
+    UARTwrite("\n", 1);
+
+    return count;
+}
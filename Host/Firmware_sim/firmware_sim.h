@@ -0,0 +1,141 @@
+/*
+ * firmware_sim.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Simulator of the Tiva board, so the whole firmware (main.c and every task) runs on a PC:
+ *      - firmware_sim.c: the virtual clock and its events, the NVIC, SysCtl, SysTick, the timers,
+ *        the GPIO ports (the buttons on port E) and the SSI of the display. The driverlib
+ *        functions used by the firmware are implemented here instead of the ones of the Tiva.
+ *      - sim_can.c: the CAN controller (message objects, interrupts) and the bus in virtual time.
+ *        The frames of the device go to the responder (the simulated ECUs).
+ *      - sim_st7735.c: the controller of the display (frame memory, windows, rotation and vertical
+ *        scrolling), fed with the bytes of the SSI.
+ *      - port/: the FreeRTOS port, with the tasks as coroutines of one thread.
+ *      The clock only moves with the events: the CPU time of the SSI and SysCtlDelay, the sleep of
+ *      the Idle task until the next event and the busy waits of the tasks, which are found by a
+ *      watchdog and jump to the next event too. Everything else the firmware does takes no time.
+ */
+
+#ifndef FIRMWARE_SIM_H_
+#define FIRMWARE_SIM_H_
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_LCD_COLUMNS 132                 // Frame memory of the ST7735
+#define SIM_LCD_ROWS 162
+#define SIM_WATCHDOG_US 500                 // Period of the busy wait detector (CPU time of the PC)
+
+// Event of the virtual clock, called once at its time
+typedef struct tSimAlarm{
+
+    uint64_t time_ns;
+    void (*fire)(void *context);
+    void *context;
+    bool armed;
+    struct tSimAlarm *next;
+}tSimAlarm;
+
+typedef struct{
+
+    uint64_t boot_ns;           // Until the scheduler started
+    uint64_t sleep_ns;          // Idle task in SysCtlSleep
+    uint64_t busy_wait_ns;      // Tasks in a busy wait
+    uint64_t ticks;
+    uint64_t interrupts;        // Interrupts of the peripherals
+    uint64_t busy_waits;        // Busy waits found by the watchdog
+    uint64_t SSI_bytes;
+}tSimStats;
+
+typedef struct{
+
+    uint32_t ID;
+    bool extended;
+    uint8_t length;
+    uint8_t data[8];
+    uint64_t time_ns;           // Device: end of the frame. ECU: when it asks for the bus.
+}tSimFrame;
+
+typedef struct{
+
+    uint64_t sent;              // By the device
+    uint64_t received;          // Taken by a message object
+    uint64_t filtered;          // No message object for the ID
+    uint64_t lost;              // Overwritten before the firmware read it
+    uint64_t bus_ns;            // Time of the frames on the bus
+}tSimCANStats;
+
+// Called with every frame of the device, at the end of the frame on the bus
+typedef void (*tSimResponder)(const tSimFrame *frame, void *context);
+
+// Clock and events (firmware_sim.c)
+uint64_t sim_timeNs(void);
+uint32_t sim_clockHz(void);
+void sim_setAlarm(tSimAlarm *alarm, uint64_t time_ns);
+void sim_cancelAlarm(tSimAlarm *alarm);
+// CPU time of the firmware: the events due meanwhile are taken and the task can be preempted
+void sim_spendNs(uint64_t ns);
+void sim_startWatchdog(void);
+const tSimStats *sim_stats(void);
+// The simulator takes its events: the firmware it calls is not the one of the running task
+bool sim_inside(void);
+
+// Interrupts: level of the interrupt line of a peripheral (INT_xxx of hw_ints.h)
+void sim_setInterruptLine(uint32_t interrupt, bool level);
+void sim_deliverInterrupts(void);
+void sim_startTick(void);
+
+// FreeRTOS port (port/port.c)
+bool sim_portStarted(void);
+bool sim_portMasked(void);
+void sim_portISR(void (*handler)(void));
+bool sim_portYieldPending(void);
+void sim_portClearYield(void);
+void sim_portSwitch(void);
+uint64_t sim_portSwitches(void);
+
+// Buttons of port E (pins of Buttons.h)
+void sim_setButtons(uint8_t pins, bool pressed);
+
+// UART0 (uartstdio): the bytes the firmware writes go to the file (none: they are dropped) and
+// the text typed goes to the console (the shell takes a line at a '\r'), or any bytes (the
+// commands of Live_stream.h)
+void sim_setUART0(FILE *file);
+void sim_UART0input(const char *text);
+void sim_UART0inputBytes(const char *bytes, size_t length);
+
+// CAN bus (sim_can.c)
+void sim_setCANresponder(tSimResponder responder, void *context);
+void sim_CANinject(const tSimFrame *frame);
+uint64_t sim_CANframeNs(uint8_t length, bool extended);
+uint32_t sim_CANbitRate(void);
+const tSimCANStats *sim_CANstats(void);
+volatile uint32_t *sim_CANregister(uint32_t offset);
+
+// Display (sim_st7735.c)
+void sim_LCDreset(void);
+void sim_LCDwrite(bool data, uint8_t byte);
+// Screen as it is seen with the rotation of MADCTL, RGB565
+uint16_t sim_LCDwidth(void);
+uint16_t sim_LCDheight(void);
+uint16_t sim_LCDpixel(uint16_t x, uint16_t y);
+bool sim_LCDsavePPM(const char path[]);
+uint64_t sim_LCDpixels(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FIRMWARE_SIM_H_ */
@@ -0,0 +1,687 @@
+/*
+ * firmware_sim_tool.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Runs the whole firmware (Software/main.c and every task) on the simulated board
+ *      (firmware_sim.h), with the ECUs of a scenario of Host/ECU_sim on the bus. A script
+ *      presses the buttons and checks the texts drawn on the display, so the menus can be
+ *      tested without the board:
+ *          wait MS                     virtual time
+ *          press BUTTON [MS]           MENU, RIGHT, DOWN, UP, OK or LEFT, held 100 ms
+ *          expect "TEXT" [MS]          drawn since the last expect, within 5000 ms
+ *          screenshot FILE             the display as a PPM image
+ *          type "TEXT"                 a line on the console of UART0 (the shell, Diag_shell.h)
+ *          send HEX...                 bytes on UART0 (the commands of the stream, Live_stream.h)
+ *          load PERCENT MS             frames of other nodes on the bus for MS, at PERCENT % of the
+ *                                      bus (the script goes on at once)
+ *          replay FILE                 frames of a trace of Host/CAN_trace (.log, .asc or .bin) on the
+ *                                      bus at their times from now, but the ones sent by the tester
+ *                                      (the script goes on at once)
+ *      The run ends with the script, or at the time limit without a script, and prints the
+ *      results of the firmware and of the simulator. The texts come from drawString and drawChar
+ *      (the characters of one row make one text), wrapped by the linker (-Wl,--wrap=...).
+ *      With -u what the firmware writes on UART0 (the shell) is saved to a file, and with -r also
+ *      the stream of the trace (Trace_recorder.h) from the boot, for Host/RTOS_trace.
+ *
+ *      Build and run (from this folder, the commands of the firmware files are on Host/README.md):
+ *          c++ -std=c++17 -O2 -Wall -I. -I../../Software -I../SD_image -I../ECU_sim -I../CAN_trace -c firmware_sim_tool.cpp ../ECU_sim/ecu_sim.cpp ../CAN_trace/can_trace.cpp
+ *          c++ -o firmware_sim *.o -Wl,--wrap=drawString,--wrap=drawChar
+ *          ./firmware_sim ../ECU_sim/scenarios/oe91c1610.scn -s scripts/read_dtcs.txt
+ */
+
+// C++ libraries
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+extern "C" {
+#include "firmware_sim.h"
+#include "SD_fat.h"
+#include "sd_image.h"
+#include "OBD_protocol.h"
+#include "Cycle_probes.h"
+#include "Trace_recorder.h"
+
+int firmware_main(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
+extern uint32_t g_ui32CPUUsage;
+void __real_drawString(int16_t x, int16_t y, const char *c, uint16_t colour, uint16_t bg, uint8_t size, uint8_t align);
+void __real_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t colour, uint16_t bg, uint8_t size);
+}
+#include "ecu_sim.hpp"
+#include "can_trace.hpp"
+
+#define PRESS_MS 100
+#define EXPECT_TIMEOUT_MS 5000
+#define DEFAULT_LIMIT_S 120
+
+enum class Command{ WAIT, PRESS, EXPECT, SCREENSHOT, TYPE, SEND, LOAD, REPLAY };
+
+struct Step{
+
+    Command command;
+    uint32_t ms = 0;
+    uint8_t pins = 0;
+    uint32_t percent = 0;
+    std::string text;
+    int line = 0;
+};
+
+struct Drawn{
+
+    uint64_t time_ns;
+    std::string text;
+};
+
+struct Run{
+
+    ecu_sim::Scenario scenario;
+    std::unique_ptr<ecu_sim::Simulator> simulator;
+    std::vector<ecu_sim::Frame> out;
+    std::vector<Step> script;
+    size_t step = 0;
+    bool has_script = false;
+    std::vector<Drawn> drawn;
+    std::string chars;                  // drawChar on one row, not on drawn yet
+    int16_t chars_y = -1;
+    size_t expect_from = 0;             // First text the expect can take
+    bool expecting = false;
+    bool print_texts = false;
+    tSimAlarm step_alarm = {};
+    tSimAlarm timeout_alarm = {};
+    tSimAlarm limit_alarm = {};
+    tSimAlarm load_alarm = {};
+    uint64_t load_end_ns = 0;
+    uint64_t load_period_ns = 0;
+    uint64_t load_frames = 0;
+    tSimAlarm replay_alarm = {};
+    std::vector<can_trace::Frame> replay;
+    size_t replay_next = 0;
+    uint64_t replay_start_ns = 0;
+    uint64_t replay_frames = 0;
+    std::chrono::steady_clock::time_point wall_start;
+};
+
+static Run run;
+
+static void print_usage(const char *program){
+
+    fprintf(stderr, "Usage: %s scenario [-s script] [-d sd_image] [-t seconds] [-l] [-u console | -r trace]\n", program);
+}
+
+static bool button_pins(const std::string &name, uint8_t &pins){
+
+    static const struct{ const char *name; uint8_t pins; } buttons[] = {
+        {"MENU", 0x01}, {"RIGHT", 0x02}, {"DOWN", 0x04}, {"UP", 0x08}, {"OK", 0x10}, {"LEFT", 0x20},
+    };
+
+    for (const auto &button : buttons){
+
+        if (name == button.name){
+
+            pins = button.pins;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool load_script(const std::string &path, std::vector<Step> &script){
+
+    std::ifstream file(path);
+    std::string line;
+    int numLine = 0;
+
+    if (!file){
+
+        fprintf(stderr, "%s: can not open\n", path.c_str());
+        return false;
+    }
+    while (std::getline(file, line)){
+
+        std::istringstream words(line);
+        std::string command;
+        Step step;
+
+        numLine++;
+        step.line = numLine;
+        if (!(words >> command) || (command[0] == '#')){
+
+            continue;
+        }
+        if (command == "wait"){
+
+            step.command = Command::WAIT;
+            if (!(words >> step.ms)){
+
+                fprintf(stderr, "%s:%d: wait MS\n", path.c_str(), numLine);
+                return false;
+            }
+        }else if (command == "press"){
+
+            std::string button;
+
+            step.command = Command::PRESS;
+            step.ms = PRESS_MS;
+            if (!(words >> button) || !button_pins(button, step.pins)){
+
+                fprintf(stderr, "%s:%d: press MENU|RIGHT|DOWN|UP|OK|LEFT [MS]\n", path.c_str(), numLine);
+                return false;
+            }
+            words >> step.ms;
+        }else if (command == "expect"){
+
+            size_t first = line.find('"'), last = line.rfind('"');
+
+            step.command = Command::EXPECT;
+            step.ms = EXPECT_TIMEOUT_MS;
+            if ((first == std::string::npos) || (last == first)){
+
+                fprintf(stderr, "%s:%d: expect \"TEXT\" [MS]\n", path.c_str(), numLine);
+                return false;
+            }
+            step.text = line.substr(first + 1, last - first - 1);
+            std::istringstream(line.substr(last + 1)) >> step.ms;
+        }else if (command == "screenshot"){
+
+            step.command = Command::SCREENSHOT;
+            if (!(words >> step.text)){
+
+                fprintf(stderr, "%s:%d: screenshot FILE\n", path.c_str(), numLine);
+                return false;
+            }
+        }else if (command == "type"){
+
+            size_t first = line.find('"'), last = line.rfind('"');
+
+            step.command = Command::TYPE;
+            if ((first == std::string::npos) || (last == first)){
+
+                fprintf(stderr, "%s:%d: type \"TEXT\"\n", path.c_str(), numLine);
+                return false;
+            }
+            step.text = line.substr(first + 1, last - first - 1);
+        }else if (command == "send"){
+
+            std::string byte;
+            unsigned long value;
+            char *end;
+
+            step.command = Command::SEND;
+            while (words >> byte){
+
+                value = strtoul(byte.c_str(), &end, 16);
+                if ((*end != '\0') || (value > 0xFF)){
+
+                    break;
+                }
+                step.text += (char)value;
+            }
+            if ((step.text.empty()) || (!words.eof())){
+
+                fprintf(stderr, "%s:%d: send HEX...\n", path.c_str(), numLine);
+                return false;
+            }
+        }else if (command == "load"){
+
+            step.command = Command::LOAD;
+            if (!(words >> step.percent >> step.ms) || (step.percent == 0) || (step.percent > 100)){
+
+                fprintf(stderr, "%s:%d: load PERCENT MS\n", path.c_str(), numLine);
+                return false;
+            }
+        }else if (command == "replay"){
+
+            step.command = Command::REPLAY;
+            if (!(words >> step.text)){
+
+                fprintf(stderr, "%s:%d: replay FILE\n", path.c_str(), numLine);
+                return false;
+            }
+        }else {
+
+            fprintf(stderr, "%s:%d: unknown command %s\n", path.c_str(), numLine, command.c_str());
+            return false;
+        }
+        script.push_back(step);
+    }
+
+    return true;
+}
+
+static void print_report(void){
+
+    const tSimStats &stats = *sim_stats();
+    const tSimCANStats &CAN = *sim_CANstats();
+    const ecu_sim::SimStats &ECUs = run.simulator->stats();
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - run.wall_start).count();
+    double virtual_s = sim_timeNs()/1e9;
+    double running_s = (sim_timeNs() - stats.boot_ns)/1e9;
+    tOBDStats OBD;
+
+    get_OBDstats(&OBD);
+    printf("Virtual time:   %.3f s in %.3f s of the PC (x%.1f)\n", virtual_s, wall_s, (wall_s > 0) ? virtual_s/wall_s : 0.0);
+    printf("Boot:           %.3f s until the scheduler\n", stats.boot_ns/1e9);
+    printf("Scheduler:      %llu ticks, %llu context switches, %llu interrupts\n",
+           (unsigned long long)stats.ticks, (unsigned long long)sim_portSwitches(), (unsigned long long)stats.interrupts);
+    printf("CPU:            %.1f %% asleep, %llu busy waits (%.3f s), usage of the firmware %u %%\n",
+           (running_s > 0) ? 100.0*stats.sleep_ns/1e9/running_s : 0.0, (unsigned long long)stats.busy_waits,
+           stats.busy_wait_ns/1e9, (unsigned)(g_ui32CPUUsage >> 16));
+    printf("Heap:           %u bytes free at the least\n", (unsigned)xPortGetMinimumEverFreeHeapSize());
+    printf("Display:        %llu bytes on the SSI, %llu pixels\n", (unsigned long long)stats.SSI_bytes,
+           (unsigned long long)sim_LCDpixels());
+    printf("CAN bus:        %llu sent, %llu received, %llu filtered, %llu lost, %.1f %% load\n",
+           (unsigned long long)CAN.sent, (unsigned long long)CAN.received, (unsigned long long)CAN.filtered,
+           (unsigned long long)CAN.lost, (virtual_s > 0) ? 100.0*CAN.bus_ns/1e9/virtual_s : 0.0);
+    printf("ECUs:           %llu requests, %llu responses, %llu frames, %llu faults\n",
+           (unsigned long long)ECUs.requests, (unsigned long long)ECUs.responses, (unsigned long long)ECUs.frames,
+           (unsigned long long)ECUs.faults);
+    printf("OBD protocol:   %u requests, %u responses, %u timeouts, %u errors, latency %.1f ms (max %u ms)\n",
+           OBD.requests, OBD.responses, OBD.timeouts, OBD.errors,
+           OBD.responses ? (double)OBD.latency_sum_ms/OBD.responses : 0.0, OBD.latency_max_ms);
+    if (run.load_frames > 0){
+
+        printf("Bus load:       %llu frames of other nodes\n", (unsigned long long)run.load_frames);
+    }
+    if (run.replay_frames > 0){
+
+        printf("Replay:         %llu of %zu frames of the trace\n", (unsigned long long)run.replay_frames, run.replay.size());
+    }
+    if (run.has_script){
+
+        printf("Script:         %zu of %zu steps\n", run.step, run.script.size());
+    }
+    dump_probes();
+}
+
+static void finish(bool ok){
+
+    print_report();
+    fflush(stdout);
+    std::exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static void next_step(void *context);
+
+static void go_on(uint64_t time_ns){
+
+    run.step++;
+    run.step_alarm.fire = next_step;
+    sim_setAlarm(&run.step_alarm, time_ns);
+}
+
+// The text of the expect among the ones drawn since the last one
+static bool find_expected(void){
+
+    const Step &step = run.script[run.step];
+
+    for (size_t i = run.expect_from; i < run.drawn.size(); i++){
+
+        if (run.drawn[i].text.find(step.text) != std::string::npos){
+
+            run.expect_from = i + 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void add_drawn(const std::string &text){
+
+    run.drawn.push_back({sim_timeNs(), text});
+    if (run.print_texts){
+
+        printf("%10.3f  %s\n", sim_timeNs()/1e9, text.c_str());
+    }
+    if (run.expecting && find_expected()){
+
+        run.expecting = false;
+        sim_cancelAlarm(&run.timeout_alarm);
+        go_on(sim_timeNs());
+    }
+}
+
+static void end_chars(void){
+
+    if (!run.chars.empty()){
+
+        std::string text;
+
+        text.swap(run.chars);
+        add_drawn(text);
+    }
+    run.chars_y = -1;
+}
+
+static void expect_timeout(void *context){
+
+    const Step &step = run.script[run.step];
+
+    (void)context;
+    fprintf(stderr, "Line %d: \"%s\" not drawn in %u ms\n", step.line, step.text.c_str(), step.ms);
+    finish(false);
+}
+
+static void release(void *context){
+
+    (void)context;
+    sim_setButtons(run.script[run.step].pins, false);
+    go_on(sim_timeNs());
+}
+
+// A frame of the load every period: 11 bit IDs out of the ones of OBD and one of 29 bits in four,
+// with a counter on the data
+static void load_frame(void *context){
+
+    tSimFrame frame;
+    uint64_t count = run.load_frames++;
+
+    (void)context;
+    frame.extended = (count % 4 == 3);
+    frame.ID = frame.extended ? 0x18FE0000 + (uint32_t)(count % 0x100) : 0x100 + (uint32_t)(count % 0x400);
+    frame.length = 8;
+    for (uint8_t i = 0; i < 8; i++){
+
+        frame.data[i] = (uint8_t)(count >> (8*(i % 4)));
+    }
+    frame.time_ns = sim_timeNs();
+    sim_CANinject(&frame);
+    if (sim_timeNs() + run.load_period_ns < run.load_end_ns){
+
+        sim_setAlarm(&run.load_alarm, sim_timeNs() + run.load_period_ns);
+    }
+}
+
+// The frames of the trace due now, the times are from its first frame
+static void replay_frame(void *context){
+
+    (void)context;
+    while (run.replay_next < run.replay.size()){
+
+        const can_trace::Frame &trace = run.replay[run.replay_next];
+        uint64_t time_ns = run.replay_start_ns + (trace.time_us - run.replay.front().time_us)*1000;
+        tSimFrame frame;
+
+        if (time_ns > sim_timeNs()){
+
+            sim_setAlarm(&run.replay_alarm, time_ns);
+            return;
+        }
+        run.replay_next++;
+        if (trace.tx){
+
+            continue;
+        }
+        frame.ID = trace.ID;
+        frame.extended = trace.extended;
+        frame.length = trace.length;
+        memcpy(frame.data, trace.data, sizeof(frame.data));
+        frame.time_ns = sim_timeNs();
+        sim_CANinject(&frame);
+        run.replay_frames++;
+    }
+}
+
+static void next_step(void *context){
+
+    (void)context;
+    if (run.step == run.script.size()){
+
+        finish(true);
+    }
+
+    const Step &step = run.script[run.step];
+
+    switch (step.command){
+
+        case Command::WAIT:
+            go_on(sim_timeNs() + step.ms*1000000ull);
+            break;
+
+        case Command::PRESS:
+            // The step goes on after the release
+            sim_setButtons(step.pins, true);
+            run.step_alarm.fire = release;
+            sim_setAlarm(&run.step_alarm, sim_timeNs() + step.ms*1000000ull);
+            break;
+
+        case Command::EXPECT:
+            end_chars();
+            if (find_expected()){
+
+                go_on(sim_timeNs());
+            }else {
+
+                run.expecting = true;
+                run.timeout_alarm.fire = expect_timeout;
+                sim_setAlarm(&run.timeout_alarm, sim_timeNs() + step.ms*1000000ull);
+            }
+            break;
+
+        case Command::SCREENSHOT:
+            if (!sim_LCDsavePPM(step.text.c_str())){
+
+                fprintf(stderr, "Line %d: can not write %s\n", step.line, step.text.c_str());
+                finish(false);
+            }
+            go_on(sim_timeNs());
+            break;
+
+        case Command::TYPE:
+            sim_UART0input((step.text + "\r").c_str());
+            go_on(sim_timeNs());
+            break;
+
+        case Command::SEND:
+            sim_UART0inputBytes(step.text.data(), step.text.size());
+            go_on(sim_timeNs());
+            break;
+
+        case Command::LOAD:
+            // The frames of 8 bytes are spaced so they fill the percent of the bus
+            run.load_period_ns = (sim_CANframeNs(8, false)*3 + sim_CANframeNs(8, true))/4*100/step.percent;
+            run.load_end_ns = sim_timeNs() + step.ms*1000000ull;
+            run.load_alarm.fire = load_frame;
+            sim_setAlarm(&run.load_alarm, sim_timeNs());
+            go_on(sim_timeNs());
+            break;
+
+        case Command::REPLAY:{
+
+            can_trace::ReadStats stats;
+
+            run.replay.clear();
+            if (!can_trace::read_trace(step.text, run.replay, stats) || run.replay.empty()){
+
+                fprintf(stderr, "Line %d: no frames on %s\n", step.line, step.text.c_str());
+                finish(false);
+            }
+            run.replay_next = 0;
+            run.replay_start_ns = sim_timeNs();
+            run.replay_alarm.fire = replay_frame;
+            sim_setAlarm(&run.replay_alarm, sim_timeNs());
+            go_on(sim_timeNs());
+            break;
+        }
+    }
+}
+
+static void time_limit(void *context){
+
+    (void)context;
+    if (run.has_script){
+
+        fprintf(stderr, "Time limit before the end of the script\n");
+        finish(false);
+    }
+    finish(true);
+}
+
+extern "C" void __wrap_drawString(int16_t x, int16_t y, const char *c, uint16_t colour, uint16_t bg, uint8_t size, uint8_t align){
+
+    end_chars();
+    __real_drawString(x, y, c, colour, bg, size, align);
+    add_drawn(c);
+}
+
+extern "C" void __wrap_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t colour, uint16_t bg, uint8_t size){
+
+    if (y != run.chars_y){
+
+        end_chars();
+        run.chars_y = y;
+    }
+    __real_drawChar(x, y, c, colour, bg, size);
+    run.chars += (char)c;
+    if (run.expecting && (run.chars.find(run.script[run.step].text) != std::string::npos)){
+
+        end_chars();
+    }
+}
+
+// The frames of the device go to the ECUs and their answers to the bus
+static void respond(const tSimFrame *frame, void *context){
+
+    ecu_sim::Frame request;
+
+    (void)context;
+    request.time_us = frame->time_ns/1000;
+    request.ID = frame->ID;
+    request.extended = frame->extended;
+    request.length = frame->length;
+    memcpy(request.data, frame->data, sizeof(request.data));
+
+    run.out.clear();
+    run.simulator->on_frame(request, run.out);
+    for (const ecu_sim::Frame &answer : run.out){
+
+        tSimFrame injected;
+
+        injected.ID = answer.ID;
+        injected.extended = answer.extended;
+        injected.length = answer.length;
+        memcpy(injected.data, answer.data, sizeof(injected.data));
+        injected.time_ns = answer.time_us*1000;
+        sim_CANinject(&injected);
+    }
+}
+
+// Options, scenario, script and card of the run (nothing is left on the stack of main)
+static bool load_run(int argc, char *argv[], double &limit_s){
+
+    std::string error, script_path, image_path, UART_path;
+    bool trace = false;
+
+    if (argc < 2){
+
+        print_usage(argv[0]);
+        return false;
+    }
+    for (int i = 2; i < argc; i++){
+
+        std::string option = argv[i];
+
+        if ((option == "-s") && (i + 1 < argc)){
+
+            script_path = argv[++i];
+        }else if ((option == "-d") && (i + 1 < argc)){
+
+            image_path = argv[++i];
+        }else if ((option == "-t") && (i + 1 < argc)){
+
+            limit_s = strtod(argv[++i], nullptr);
+        }else if (((option == "-u") || (option == "-r")) && (i + 1 < argc)){
+
+            UART_path = argv[++i];
+            trace = (option == "-r");
+        }else if (option == "-l"){
+
+            // Line by line, the run can end on an abort of the simulator
+            run.print_texts = true;
+            setvbuf(stdout, nullptr, _IOLBF, 0);
+        }else {
+
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    if (!ecu_sim::load_scenario(argv[1], run.scenario, error)){
+
+        fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+        return false;
+    }
+    if (!script_path.empty()){
+
+        if (!load_script(script_path, run.script)){
+
+            return false;
+        }
+        run.has_script = true;
+    }
+    // Without an image the firmware finds no card
+    if (!image_path.empty() && !open_SDimage(image_path.c_str(), 0)){
+
+        return false;
+    }
+    // The stream of the trace from the boot, as if 'trace on' had been typed on the shell
+    if (!UART_path.empty()){
+
+        FILE *file = fopen(UART_path.c_str(), "wb");
+
+        if (file == nullptr){
+
+            fprintf(stderr, "Can not write %s\n", UART_path.c_str());
+            return false;
+        }
+        sim_setUART0(file);
+        trace_stream(trace);
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[]){
+
+    double limit_s = DEFAULT_LIMIT_S;
+
+    if (!load_run(argc, argv, limit_s)){
+
+        return EXIT_FAILURE;
+    }
+
+    // The firmware never returns: the run ends with exit() and everything is kept on run
+    run.simulator.reset(new ecu_sim::Simulator(run.scenario));
+    sim_setCANresponder(respond, nullptr);
+    run.step_alarm.fire = next_step;
+    if (run.has_script){
+
+        sim_setAlarm(&run.step_alarm, 0);
+    }
+    run.limit_alarm.fire = time_limit;
+    sim_setAlarm(&run.limit_alarm, (uint64_t)(limit_s*1e9));
+    if (run.simulator->bitrate() != 500000){
+
+        fprintf(stderr, "The scenario is at %u bit/s, the firmware at 500000\n", run.simulator->bitrate());
+    }
+
+    run.wall_start = std::chrono::steady_clock::now();
+    sim_startWatchdog();
+    firmware_main();
+
+    return EXIT_FAILURE;
+}
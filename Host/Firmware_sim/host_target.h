@@ -0,0 +1,56 @@
+/*
+ * host_target.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Included before every file of the firmware (-include host_target.h). The files of
+ *      Software/ include "inc/hw_types.h" and "driverlib/rom.h" from their own folder, so they
+ *      can not be replaced on the include path:
+ *      - HWREG reads the registers of the simulator (firmware_sim.c) instead of the addresses
+ *        of the Tiva.
+ *      - Without TARGET_IS_xxx the functions of the ROM are not declared, so the ones used by
+ *        the firmware go to the driverlib functions of the simulator.
+ *      - The events of the trace (Trace_recorder.c) have the virtual time, in ns.
+ */
+
+#ifndef HOST_TARGET_H_
+#define HOST_TARGET_H_
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+
+// inc/hw_types.h
+#define __HW_TYPES_H__
+volatile uint32_t *sim_HWREG(uint32_t address);
+#define HWREG(x) (*sim_HWREG(x))
+
+// driverlib/rom.h
+#define ROM_GPIODirModeSet GPIODirModeSet
+#define ROM_GPIOIntTypeSet GPIOIntTypeSet
+#define ROM_GPIOPadConfigSet GPIOPadConfigSet
+#define ROM_IntDisable IntDisable
+#define ROM_IntEnable IntEnable
+#define ROM_IntMasterEnable IntMasterEnable
+#define ROM_IntPrioritySet IntPrioritySet
+#define ROM_SysCtlClockGet SysCtlClockGet
+#define ROM_SysCtlClockSet SysCtlClockSet
+#define ROM_SysCtlPeripheralEnable SysCtlPeripheralEnable
+#define ROM_TimerConfigure TimerConfigure
+#define ROM_TimerDisable TimerDisable
+#define ROM_TimerEnable TimerEnable
+#define ROM_TimerIntClear TimerIntClear
+#define ROM_TimerIntEnable TimerIntEnable
+#define ROM_TimerLoadSet TimerLoadSet
+
+// Trace_recorder.c
+uint64_t sim_timeNs(void);
+#define TRACE_TIMESTAMP() ((uint32_t)sim_timeNs())
+#define TRACE_COUNTER_HZ() 1000000000UL
+
+#endif /* HOST_TARGET_H_ */
@@ -0,0 +1,367 @@
+/*
+ * port.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      FreeRTOS port of the firmware simulator (portmacro.h). A context switch is a swapcontext
+ *      between the coroutines of the tasks. The interrupts only run when the simulator takes the
+ *      events of the virtual clock (firmware_sim.c), never inside a critical section, and the
+ *      yields they ask for are done when they return.
+ *
+ *      The task runs on a stack of the PC, the one of FreeRTOS (of the size of the Tiva) only keeps
+ *      the coroutine. Built with -finstrument-functions, every function of the firmware and FreeRTOS
+ *      marks its depth on the stack of the PC as used on the one of FreeRTOS, so
+ *      uxTaskGetStackHighWaterMark gives what the task used, and the simulator stops when a task
+ *      goes beyond its stack. The frames of the PC and of the Cortex-M4 are close (8 byte registers
+ *      and return addresses against the spills of the 4 byte ones). The libraries of the PC are
+ *      not instrumented: snprintf, linked with --wrap=snprintf, counts PORT_SNPRINTF_STACK bytes.
+ *      The context saved on a switch (51 words with the FPU) is not counted either: the RAM
+ *      budget of Software/FreeRTOSConfig.h adds it to every stack.
+ */
+
+// C libraries
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ucontext.h>
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Programmer libraries
+#include "firmware_sim.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+#define PORT_TASK_STACK (256*1024)      // Stack of the PC of every task
+#define PORT_SNPRINTF_STACK 512         // Of snprintf of the C library of the Tiva (TI), an estimate
+
+typedef struct{
+
+    ucontext_t context;
+    void *stack;
+    TaskFunction_t code;
+    void *parameters;
+    StackType_t *top;               // Of the stack of FreeRTOS
+    StackType_t *used;              // Lowest word marked as used
+    StackType_t *base;              // Found on the first call of the task
+}tPortTask;
+
+// The first field of the TCB is the top of its stack, where pxPortInitialiseStack left the task
+extern void * volatile pxCurrentTCB;
+
+// Global variables
+volatile uint32_t ulPortTasksReadied = 0;
+static ucontext_t scheduler_context;
+static uint32_t critical_nesting = 0xaaaaaaaa;      // The interrupts stay masked until the scheduler starts
+static bool interrupts_disabled = false;
+static bool in_ISR = false;
+static bool in_switch = false;                      // PendSV of the Tiva, on the main stack
+static bool yield_pending = false;
+static bool started = false;
+static uint64_t switches = 0;
+static bool marking = false;
+
+
+static tPortTask *task_of(void *TCB){
+
+    tPortTask *task;
+
+    memcpy(&task, *(StackType_t * volatile *)TCB, sizeof(task));
+
+    return task;
+}
+
+static void run_task(void){
+
+    tPortTask *task = task_of(pxCurrentTCB);
+
+#if defined(__SANITIZE_ADDRESS__)
+    __sanitizer_finish_switch_fiber(NULL, NULL, NULL);
+#endif
+    task->code(task->parameters);
+
+    // The tasks of FreeRTOS never return
+    fprintf(stderr, "Task %s returned\n", pcTaskGetName(NULL));
+    abort();
+}
+
+StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters){
+
+    tPortTask *task = malloc(sizeof(tPortTask));
+
+    if ((task == NULL) || ((task->stack = malloc(PORT_TASK_STACK)) == NULL)){
+
+        fprintf(stderr, "No memory for the stack of a task\n");
+        abort();
+    }
+    task->code = pxCode;
+    task->parameters = pvParameters;
+    task->top = pxTopOfStack;
+    task->base = NULL;
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack;
+    task->context.uc_stack.ss_size = PORT_TASK_STACK;
+    task->context.uc_link = NULL;
+    makecontext(&task->context, run_task, 0);
+
+    pxTopOfStack -= (sizeof(task) + sizeof(StackType_t) - 1)/sizeof(StackType_t);
+    memcpy(pxTopOfStack, &task, sizeof(task));
+    task->used = pxTopOfStack;
+
+    return pxTopOfStack;
+}
+
+void vPortCleanUpTCB(void *pxTCB){
+
+    tPortTask *task = task_of(pxTCB);
+
+    free(task->stack);
+    free(task);
+}
+
+static void switch_context(void){
+
+    void *previous = pxCurrentTCB;
+    tPortTask *next;
+
+    yield_pending = false;
+    in_switch = true;
+    vTaskSwitchContext();
+    in_switch = false;
+    if (pxCurrentTCB == previous){
+
+        return;
+    }
+    switches++;
+    next = task_of(pxCurrentTCB);
+#if defined(__SANITIZE_ADDRESS__)
+    void *fake_stack = NULL;
+
+    __sanitizer_start_switch_fiber(&fake_stack, next->stack, PORT_TASK_STACK);
+    swapcontext(&task_of(previous)->context, &next->context);
+    __sanitizer_finish_switch_fiber(fake_stack, NULL, NULL);
+#else
+    swapcontext(&task_of(previous)->context, &next->context);
+#endif
+}
+
+// Interrupts enabled again: the ones that came meanwhile and then the yield
+static void unmasked(void){
+
+    if ((!started) || in_ISR){
+
+        return;
+    }
+    sim_deliverInterrupts();
+    if (yield_pending){
+
+        switch_context();
+    }
+}
+
+BaseType_t xPortStartScheduler(void){
+
+    tPortTask *first = task_of(pxCurrentTCB);
+
+    critical_nesting = 0;
+    interrupts_disabled = false;
+    started = true;
+    sim_startTick();
+#if defined(__SANITIZE_ADDRESS__)
+    void *fake_stack = NULL;
+
+    __sanitizer_start_switch_fiber(&fake_stack, first->stack, PORT_TASK_STACK);
+    swapcontext(&scheduler_context, &first->context);
+    __sanitizer_finish_switch_fiber(fake_stack, NULL, NULL);
+#else
+    swapcontext(&scheduler_context, &first->context);
+#endif
+
+    return pdFALSE;
+}
+
+void vPortEndScheduler(void){
+
+    started = false;
+    swapcontext(&task_of(pxCurrentTCB)->context, &scheduler_context);
+}
+
+void vPortYield(void){
+
+    if (sim_portMasked()){
+
+        yield_pending = true;
+    }else {
+
+        switch_context();
+    }
+}
+
+void vPortYieldFromISR(void){
+
+    yield_pending = true;
+}
+
+void vPortEnterCritical(void){
+
+    interrupts_disabled = true;
+    critical_nesting++;
+}
+
+void vPortExitCritical(void){
+
+    configASSERT(critical_nesting > 0);
+    critical_nesting--;
+    if (critical_nesting == 0){
+
+        interrupts_disabled = false;
+        unmasked();
+    }
+}
+
+void vPortDisableInterrupts(void){
+
+    interrupts_disabled = true;
+}
+
+void vPortEnableInterrupts(void){
+
+    interrupts_disabled = false;
+    unmasked();
+}
+
+// SysTick interrupt
+void xPortSysTickHandler(void){
+
+    if (xTaskIncrementTick() != pdFALSE){
+
+        yield_pending = true;
+    }
+}
+
+bool sim_portStarted(void){
+
+    return started;
+}
+
+bool sim_portMasked(void){
+
+    return (!started) || interrupts_disabled || (critical_nesting > 0) || in_ISR;
+}
+
+void sim_portISR(void (*handler)(void)){
+
+    in_ISR = true;
+    handler();
+    in_ISR = false;
+}
+
+bool sim_portYieldPending(void){
+
+    return yield_pending;
+}
+
+void sim_portClearYield(void){
+
+    yield_pending = false;
+}
+
+void sim_portSwitch(void){
+
+    if (yield_pending && (!sim_portMasked())){
+
+        switch_context();
+    }
+}
+
+uint64_t sim_portSwitches(void){
+
+    return switches;
+}
+
+// Marks the stack of FreeRTOS of the running task down to the frame (of the stack of the PC)
+static void mark_stack(uint8_t *frame) __attribute__((no_instrument_function));
+static void mark_stack(uint8_t *frame){
+
+    tPortTask *task;
+    StackType_t *mark;
+
+    // The interrupts run on the main stack of the Tiva, not on the one of the task
+    if ((!started) || in_ISR || in_switch || marking || sim_inside()){
+
+        return;
+    }
+    task = task_of(pxCurrentTCB);
+    if ((frame < (uint8_t *)task->stack) || (frame >= (uint8_t *)task->stack + PORT_TASK_STACK)){
+
+        return;     // In vTaskSwitchContext, still on the stack of the previous task
+    }
+    mark = task->top - ((uint8_t *)task->stack + PORT_TASK_STACK - frame)/sizeof(StackType_t);
+    if (mark >= task->used){
+
+        return;
+    }
+    if (task->base == NULL){
+
+        TaskStatus_t status;
+
+        marking = true;
+        vTaskGetInfo(NULL, &status, pdFALSE, eRunning);
+        marking = false;
+        task->base = status.pxStackBase;
+    }
+    // The last words are the ones of the check of configCHECK_FOR_STACK_OVERFLOW
+    if (mark < task->base + 4){
+
+        marking = true;
+        fprintf(stderr, "Stack overflow of task %s: %u bytes of the PC, %u of FreeRTOS\n", pcTaskGetName(NULL),
+                (unsigned)((uint8_t *)task->stack + PORT_TASK_STACK - frame),
+                (unsigned)((task->top - task->base + 1)*sizeof(StackType_t)));
+        abort();
+    }
+    memset(mark, 0, (task->used - mark)*sizeof(StackType_t));
+    task->used = mark;
+}
+
+void __cyg_profile_func_enter(void *function, void *caller) __attribute__((no_instrument_function));
+void __cyg_profile_func_enter(void *function, void *caller){
+
+    (void)function;
+    (void)caller;
+    mark_stack(__builtin_frame_address(0));
+}
+
+void __cyg_profile_func_exit(void *function, void *caller) __attribute__((no_instrument_function));
+void __cyg_profile_func_exit(void *function, void *caller){
+
+    (void)function;
+    (void)caller;
+}
+
+// snprintf of the PC is not instrumented. Linked with --wrap=snprintf it takes the stack of the
+// one of the C library of the Tiva.
+int __wrap_snprintf(char *text, size_t size, const char *format, ...){
+
+    va_list arguments;
+    int length;
+
+    mark_stack((uint8_t *)__builtin_frame_address(0) - PORT_SNPRINTF_STACK);
+    va_start(arguments, format);
+    length = vsnprintf(text, size, format, arguments);
+    va_end(arguments);
+
+    return length;
+}
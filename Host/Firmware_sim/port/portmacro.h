@@ -0,0 +1,92 @@
+/*
+ * portmacro.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      FreeRTOS port of the firmware simulator. The tasks are coroutines (ucontext) of a single
+ *      thread and the interrupts are the events of the virtual clock (firmware_sim.h), so nothing
+ *      runs at the same time and the same run gives the same result on any PC.
+ *      The types are the ones of the ARM_CM4F port (32 bit stack words and ticks), so the stack
+ *      sizes of the tasks take the same heap as on the Tiva. The C code of a task runs on its own
+ *      stack of the PC, the FreeRTOS stack only keeps the pointer to the coroutine.
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// C libraries
+#include <stdint.h>
+
+#define portCHAR        char
+#define portFLOAT       float
+#define portDOUBLE      double
+#define portLONG        long
+#define portSHORT       short
+#define portSTACK_TYPE  uint32_t
+#define portBASE_TYPE   long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if (configUSE_16_BIT_TICKS == 1)
+    typedef uint16_t TickType_t;
+    #define portMAX_DELAY (TickType_t)0xffff
+#else
+    typedef uint32_t TickType_t;
+    #define portMAX_DELAY (TickType_t)0xffffffffUL
+    #define portTICK_TYPE_IS_ATOMIC 1
+#endif
+
+#define portSTACK_GROWTH            (-1)
+#define portTICK_PERIOD_MS          ((TickType_t)1000/configTICK_RATE_HZ)
+#define portBYTE_ALIGNMENT          8
+#define portPOINTER_SIZE_TYPE       uintptr_t       // The stacks are aligned on their 64 bit address
+
+// A yield inside a critical section or an interrupt is taken when the interrupts are enabled
+// again, like the PendSV of the Cortex-M4
+void vPortYield(void);
+void vPortYieldFromISR(void);
+#define portYIELD()                                 vPortYield()
+#define portEND_SWITCHING_ISR(xSwitchRequired)      if ((xSwitchRequired) != pdFALSE) vPortYieldFromISR()
+#define portYIELD_FROM_ISR(x)                       portEND_SWITCHING_ISR(x)
+
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+void vPortDisableInterrupts(void);
+void vPortEnableInterrupts(void);
+#define portDISABLE_INTERRUPTS()                    vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()                     vPortEnableInterrupts()
+#define portENTER_CRITICAL()                        vPortEnterCritical()
+#define portEXIT_CRITICAL()                         vPortExitCritical()
+// The interrupts never nest
+#define portSET_INTERRUPT_MASK_FROM_ISR()           0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)        (void)(x)
+
+// The coroutine of a deleted task is freed with its TCB
+void vPortCleanUpTCB(void *pxTCB);
+#define portCLEAN_UP_TCB(pxTCB)                     vPortCleanUpTCB(pxTCB)
+
+// Tasks made ready (not the time slicing), so the simulator knows when a busy wait can end
+extern volatile uint32_t ulPortTasksReadied;
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)       ulPortTasksReadied++
+
+#define portTASK_FUNCTION_PROTO(vFunction, pvParameters) void vFunction(void *pvParameters)
+#define portTASK_FUNCTION(vFunction, pvParameters) void vFunction(void *pvParameters)
+
+#define portNOP()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
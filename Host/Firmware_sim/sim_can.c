@@ -0,0 +1,562 @@
+/*
+ * sim_can.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      CAN0 of the firmware simulator (firmware_sim.h): the 32 message objects of the Tiva with
+ *      their interrupts, and the bus in virtual time. One frame is on the bus at a time. When
+ *      the bus is free, the lowest ID of the frames waiting wins the arbitration (the frame of
+ *      the device or the ones of the responder). Every frame on the bus sets RXOK or TXOK, so
+ *      the status interrupt comes before the one of the message object, as on the Tiva.
+ *      The internal loopback of the test mode (CANCTL.TEST, CANTST.LBACK and SILENT, written with
+ *      HWREG) gives the frames of the device to its own message objects instead of the bus. SILENT
+ *      alone receives the bus and sends nothing to it.
+ *      As on the Tiva, the device sends its lowest message object first, a frame goes to the first
+ *      object of a FIFO (MSG_OBJ_FIFO) without new data, and a filter without MSG_OBJ_USE_EXT_FILTER
+ *      takes the IDs of 11 and 29 bits.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// TIVA libraries
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_can.h"
+#include "driverlib/can.h"
+
+// Programmer libraries
+#include "firmware_sim.h"
+
+#define NUM_OBJECTS 32
+#define STANDARD_ID_MASK 0x7FF
+#define EXTENDED_ID_MASK 0x1FFFFFFF
+#define FRAME_OF_RESPONDER -1
+#define OBJECT_CHANGED -2            // Set again while its frame was on the bus
+
+typedef struct{
+
+    bool valid;
+    bool transmit;
+    bool request;               // TXRQST: waiting for the bus
+    bool new_data;
+    bool lost;
+    bool interrupt;             // INTPND
+    uint32_t ID;
+    uint32_t filter_ID;         // ID of CANMessageSet (ID is the one of the last frame)
+    uint32_t mask;
+    uint32_t flags;
+    bool extended;
+    uint8_t length;
+    uint8_t data[8];
+    uint64_t request_ns;
+}tObject;
+
+// Global variables
+static tObject objects[NUM_OBJECTS];
+static bool enabled = false;
+static uint32_t interrupt_flags = 0;
+static uint32_t status = 0;
+static bool status_interrupt = false;
+static uint32_t bit_rate = 500000;
+static volatile uint32_t control = 0;       // CANCTL: only TEST
+static volatile uint32_t test = 0;          // CANTST: LBACK and SILENT
+static tSimCANStats stats;
+
+static tSimFrame *waiting = NULL;       // Frames of the responder, not on the bus yet
+static size_t numWaiting = 0, sizeWaiting = 0;
+
+// Frame on the bus: a message object of the device or a frame of the responder
+static bool busy = false;
+static int32_t on_bus_object = FRAME_OF_RESPONDER;
+static tSimFrame on_bus;
+static tSimAlarm bus_alarm;
+
+static tSimResponder responder = NULL;
+static void *responder_context = NULL;
+
+
+static void check_base(uint32_t base){
+
+    if (base != CAN0_BASE){
+
+        fprintf(stderr, "Simulator: CAN 0x%08X not simulated\n", base);
+        abort();
+    }
+}
+
+uint64_t sim_CANframeNs(uint8_t length, bool extended){
+
+    // Header, CRC and spaces: 47 bits (11 bit ID) or 67 bits (29 bit ID), without stuff bits
+    uint64_t bits = (extended ? 67 : 47) + 8*(uint64_t)length;
+
+    return bits*1000000000u/bit_rate;
+}
+
+uint32_t sim_CANbitRate(void){
+
+    return bit_rate;
+}
+
+const tSimCANStats *sim_CANstats(void){
+
+    return &stats;
+}
+
+void sim_setCANresponder(tSimResponder new_responder, void *context){
+
+    responder = new_responder;
+    responder_context = context;
+}
+
+static void update_line(void){
+
+    bool pending = false;
+
+    if (interrupt_flags & CAN_INT_MASTER){
+
+        pending = status_interrupt;
+        for (uint32_t i = 0; i < NUM_OBJECTS; i++){
+
+            pending |= objects[i].interrupt;
+        }
+    }
+    sim_setInterruptLine(INT_CAN0, pending);
+}
+
+static void set_status(uint32_t bits){
+
+    status |= bits;
+    if (interrupt_flags & CAN_INT_STATUS){
+
+        status_interrupt = true;
+    }
+}
+
+// Receiving message object of the first filter that takes the frame
+static void receive(const tSimFrame *frame){
+
+    set_status(CAN_STATUS_RXOK);
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++){
+
+        tObject *object = &objects[i];
+
+        if ((!object->valid) || object->transmit){
+
+            continue;
+        }
+        if (((object->flags & MSG_OBJ_USE_EXT_FILTER) != MSG_OBJ_USE_ID_FILTER) && (object->extended != frame->extended)){
+
+            continue;
+        }
+        if ((object->flags & MSG_OBJ_USE_ID_FILTER) && ((frame->ID & object->mask) != (object->filter_ID & object->mask))){
+
+            continue;
+        }
+        if (object->new_data){
+
+            if (object->flags & MSG_OBJ_FIFO){
+
+                continue;
+            }
+            object->lost = true;
+            stats.lost++;
+        }
+        object->new_data = true;
+        object->ID = frame->ID;
+        object->extended = frame->extended;
+        object->length = frame->length;
+        memcpy(object->data, frame->data, sizeof(object->data));
+        if (object->flags & MSG_OBJ_RX_INT_ENABLE){
+
+            object->interrupt = true;
+        }
+        stats.received++;
+        return;
+    }
+    stats.filtered++;
+}
+
+static bool loopback(void){
+
+    return (control & CAN_CTL_TEST) && (test & CAN_TST_LBACK);
+}
+
+static bool silent(void){
+
+    return (control & CAN_CTL_TEST) && (test & CAN_TST_SILENT);
+}
+
+static void schedule_bus(void);
+
+// End of the frame on the bus, then the arbitration of the next one
+static void bus_event(void *context){
+
+    (void)context;
+    if (busy){
+
+        uint64_t end_ns = sim_timeNs();
+
+        busy = false;
+        stats.bus_ns += sim_CANframeNs(on_bus.length, on_bus.extended);
+        if (on_bus_object != FRAME_OF_RESPONDER){
+
+            if (on_bus_object >= 0){
+
+                tObject *object = &objects[on_bus_object];
+
+                object->request = false;
+                if (object->flags & MSG_OBJ_TX_INT_ENABLE){
+
+                    object->interrupt = true;
+                }
+            }
+            set_status(CAN_STATUS_TXOK);
+            stats.sent++;
+            update_line();
+            on_bus.time_ns = end_ns;
+            if (loopback()){
+
+                receive(&on_bus);
+                update_line();
+            }
+            if ((responder != NULL) && (!silent())){
+
+                responder(&on_bus, responder_context);
+            }
+        }else if (!(silent() && loopback())){
+
+            receive(&on_bus);
+            update_line();
+        }
+    }
+    schedule_bus();
+}
+
+static void schedule_bus(void){
+
+    uint64_t now_ns = sim_timeNs();
+    uint64_t next_ns = UINT64_MAX;
+    int32_t object_won = FRAME_OF_RESPONDER;
+    size_t frame_won = SIZE_MAX;
+    uint32_t ID_won = UINT32_MAX;
+
+    if (busy || (!enabled)){
+
+        return;
+    }
+    // Only the lowest object of the device that waits goes to the arbitration
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++){
+
+        if (objects[i].valid && objects[i].request){
+
+            if (objects[i].request_ns > now_ns){
+
+                next_ns = (objects[i].request_ns < next_ns) ? objects[i].request_ns : next_ns;
+            }else if (object_won == FRAME_OF_RESPONDER){
+
+                ID_won = objects[i].ID;
+                object_won = (int32_t)i;
+            }
+        }
+    }
+    for (size_t i = 0; i < numWaiting; i++){
+
+        if (waiting[i].time_ns > now_ns){
+
+            next_ns = (waiting[i].time_ns < next_ns) ? waiting[i].time_ns : next_ns;
+        }else if (waiting[i].ID < ID_won){
+
+            ID_won = waiting[i].ID;
+            object_won = FRAME_OF_RESPONDER;
+            frame_won = i;
+        }
+    }
+    if (ID_won == UINT32_MAX){
+
+        if (next_ns != UINT64_MAX){
+
+            bus_alarm.fire = bus_event;
+            sim_setAlarm(&bus_alarm, next_ns);
+        }
+        return;
+    }
+
+    busy = true;
+    on_bus_object = object_won;
+    if (object_won >= 0){
+
+        tObject *object = &objects[object_won];
+
+        on_bus.ID = object->ID;
+        on_bus.extended = object->extended;
+        on_bus.length = object->length;
+        memcpy(on_bus.data, object->data, sizeof(on_bus.data));
+    }else {
+
+        // The order is kept: the frames of one ID go out in the order they came
+        on_bus = waiting[frame_won];
+        numWaiting--;
+        memmove(&waiting[frame_won], &waiting[frame_won + 1], (numWaiting - frame_won)*sizeof(tSimFrame));
+    }
+    bus_alarm.fire = bus_event;
+    sim_setAlarm(&bus_alarm, now_ns + sim_CANframeNs(on_bus.length, on_bus.extended));
+}
+
+// Frame of the responder: it asks for the bus at frame->time_ns
+void sim_CANinject(const tSimFrame *frame){
+
+    if (numWaiting == sizeWaiting){
+
+        sizeWaiting = sizeWaiting ? 2*sizeWaiting : 64;
+        waiting = realloc(waiting, sizeWaiting*sizeof(tSimFrame));
+        if (waiting == NULL){
+
+            fprintf(stderr, "Simulator: no memory for the CAN frames\n");
+            abort();
+        }
+    }
+    waiting[numWaiting++] = *frame;
+    if (!busy){
+
+        schedule_bus();
+    }
+}
+
+
+// Registers of CAN0 written by the firmware with HWREG (host_target.h)
+volatile uint32_t *sim_CANregister(uint32_t offset){
+
+    switch (offset){
+
+        case CAN_O_CTL:
+            return &control;
+
+        case CAN_O_TST:
+            return &test;
+
+        default:
+            fprintf(stderr, "Simulator: CAN register 0x%03X not simulated\n", offset);
+            abort();
+    }
+}
+
+
+// driverlib
+void CANInit(uint32_t ui32Base){
+
+    check_base(ui32Base);
+    memset(objects, 0, sizeof(objects));
+    enabled = false;
+    status = 0;
+    status_interrupt = false;
+    control = 0;
+    test = 0;
+    update_line();
+}
+
+uint32_t CANBitRateSet(uint32_t ui32Base, uint32_t ui32SourceClock, uint32_t ui32BitRate){
+
+    check_base(ui32Base);
+    (void)ui32SourceClock;
+    bit_rate = ui32BitRate;
+
+    return ui32BitRate;
+}
+
+void CANEnable(uint32_t ui32Base){
+
+    check_base(ui32Base);
+    enabled = true;
+    schedule_bus();
+}
+
+void CANDisable(uint32_t ui32Base){
+
+    check_base(ui32Base);
+    enabled = false;
+}
+
+void CANIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    check_base(ui32Base);
+    interrupt_flags |= ui32IntFlags;
+    update_line();
+}
+
+void CANIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags){
+
+    check_base(ui32Base);
+    interrupt_flags &= ~ui32IntFlags;
+    update_line();
+}
+
+uint32_t CANIntStatus(uint32_t ui32Base, tCANIntStsReg eIntStsReg){
+
+    uint32_t value = 0;
+
+    check_base(ui32Base);
+    if (eIntStsReg == CAN_INT_STS_CAUSE){
+
+        if (status_interrupt){
+
+            return CAN_INT_INTID_STATUS;
+        }
+        for (uint32_t i = 0; i < NUM_OBJECTS; i++){
+
+            if (objects[i].interrupt){
+
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+    for (uint32_t i = 0; i < NUM_OBJECTS; i++){
+
+        value |= objects[i].interrupt ? (1UL << i) : 0;
+    }
+
+    return value;
+}
+
+void CANIntClear(uint32_t ui32Base, uint32_t ui32IntClr){
+
+    check_base(ui32Base);
+    if (ui32IntClr == CAN_INT_INTID_STATUS){
+
+        status_interrupt = false;
+    }else if ((ui32IntClr >= 1) && (ui32IntClr <= NUM_OBJECTS)){
+
+        objects[ui32IntClr - 1].interrupt = false;
+    }
+    update_line();
+}
+
+// Reading the status register clears TXOK, RXOK and the status interrupt
+uint32_t CANStatusGet(uint32_t ui32Base, tCANStsReg eStatusReg){
+
+    uint32_t value = 0;
+
+    check_base(ui32Base);
+    switch (eStatusReg){
+
+        case CAN_STS_CONTROL:
+            value = status;
+            status &= ~(CAN_STATUS_RXOK | CAN_STATUS_TXOK);
+            status_interrupt = false;
+            update_line();
+            break;
+
+        case CAN_STS_TXREQUEST:
+        case CAN_STS_NEWDAT:
+        case CAN_STS_MSGVAL:
+            for (uint32_t i = 0; i < NUM_OBJECTS; i++){
+
+                bool bit = (eStatusReg == CAN_STS_TXREQUEST) ? objects[i].request :
+                           (eStatusReg == CAN_STS_NEWDAT) ? objects[i].new_data : objects[i].valid;
+
+                value |= bit ? (1UL << i) : 0;
+            }
+            break;
+    }
+
+    return value;
+}
+
+// No errors on the simulated bus
+bool CANErrCntrGet(uint32_t ui32Base, uint32_t *pui32RxCount, uint32_t *pui32TxCount){
+
+    check_base(ui32Base);
+    *pui32RxCount = 0;
+    *pui32TxCount = 0;
+
+    return false;
+}
+
+void CANMessageSet(uint32_t ui32Base, uint32_t ui32ObjID, tCANMsgObject *psMsgObject, tMsgObjType eMsgType){
+
+    tObject *object;
+
+    check_base(ui32Base);
+    if ((ui32ObjID < 1) || (ui32ObjID > NUM_OBJECTS) || ((eMsgType != MSG_OBJ_TYPE_TX) && (eMsgType != MSG_OBJ_TYPE_RX))){
+
+        fprintf(stderr, "Simulator: CAN message object %u (type %d) not simulated\n", ui32ObjID, (int)eMsgType);
+        abort();
+    }
+    object = &objects[ui32ObjID - 1];
+    if ((ui32ObjID - 1 == (uint32_t)on_bus_object) && busy){
+
+        // The frame on the bus ends anyway, without the interrupt of the object
+        on_bus_object = OBJECT_CHANGED;
+    }
+
+    // Like driverlib: a 29 bit ID if it does not fit on 11 bits or the flag says so
+    object->extended = (psMsgObject->ui32MsgID > STANDARD_ID_MASK) || (psMsgObject->ui32Flags & MSG_OBJ_EXTENDED_ID);
+    object->ID = psMsgObject->ui32MsgID & (object->extended ? EXTENDED_ID_MASK : STANDARD_ID_MASK);
+    object->filter_ID = object->ID;
+    object->mask = psMsgObject->ui32MsgIDMask;
+    object->flags = psMsgObject->ui32Flags;
+    object->length = (psMsgObject->ui32MsgLen > 8) ? 8 : (uint8_t)psMsgObject->ui32MsgLen;
+    object->valid = true;
+    object->transmit = (eMsgType == MSG_OBJ_TYPE_TX);
+    object->new_data = false;
+    object->lost = false;
+    object->interrupt = false;
+    object->request = object->transmit;
+    if (object->transmit){
+
+        memcpy(object->data, psMsgObject->pui8MsgData, object->length);
+        object->request_ns = sim_timeNs();
+        schedule_bus();
+    }
+    update_line();
+}
+
+void CANMessageGet(uint32_t ui32Base, uint32_t ui32ObjID, tCANMsgObject *psMsgObject, bool bClrPendingInt){
+
+    tObject *object;
+
+    check_base(ui32Base);
+    object = &objects[ui32ObjID - 1];
+    psMsgObject->ui32MsgID = object->ID;
+    psMsgObject->ui32MsgIDMask = object->mask;
+    psMsgObject->ui32Flags = (object->flags & ~MSG_OBJ_STATUS_MASK) | (object->extended ? MSG_OBJ_EXTENDED_ID : 0);
+    if (object->new_data){
+
+        psMsgObject->ui32MsgLen = object->length;
+        memcpy(psMsgObject->pui8MsgData, object->data, object->length);
+        psMsgObject->ui32Flags |= MSG_OBJ_NEW_DATA;
+    }
+    if (object->lost){
+
+        psMsgObject->ui32Flags |= MSG_OBJ_DATA_LOST;
+    }
+    object->new_data = false;
+    object->lost = false;
+    if (bClrPendingInt){
+
+        object->interrupt = false;
+    }
+    update_line();
+}
+
+void CANMessageClear(uint32_t ui32Base, uint32_t ui32ObjID){
+
+    check_base(ui32Base);
+    if ((ui32ObjID < 1) || (ui32ObjID > NUM_OBJECTS)){
+
+        fprintf(stderr, "Simulator: CAN message object %u not simulated\n", ui32ObjID);
+        abort();
+    }
+    if ((ui32ObjID - 1 == (uint32_t)on_bus_object) && busy){
+
+        on_bus_object = OBJECT_CHANGED;
+    }
+    memset(&objects[ui32ObjID - 1], 0, sizeof(tObject));
+    update_line();
+}
@@ -0,0 +1,292 @@
+/*
+ * sim_st7735.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      ST7735 controller of the firmware simulator (firmware_sim.h), fed with the bytes of SSI0
+ *      and the level of the data/command pin. It keeps the frame memory (132x162, 16 bit
+ *      colour) and the commands ST7735.c uses: the window (CASET, RASET), the memory write, the
+ *      rotation (MADCTL), the inversion and the vertical scrolling (SCRLAR, VSCSAD), which works
+ *      on the lines of the frame memory. The screen is read back the way the panel shows it.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// Programmer libraries
+#include "firmware_sim.h"
+#include "ST7735.h"
+
+#define MAX_ARGUMENTS 6
+
+// Global variables
+static uint16_t memory[SIM_LCD_ROWS][SIM_LCD_COLUMNS];
+static uint8_t command = ST7735_NOP;
+static uint8_t arguments[MAX_ARGUMENTS];
+static uint8_t numArguments = 0;
+static uint8_t MADCTL = 0;
+static bool inverted = false;
+static bool display_on = false;
+// Window and the address counters (before the exchange and the mirrors of MADCTL)
+static uint16_t column_start = 0, column_end = SIM_LCD_COLUMNS - 1;
+static uint16_t row_start = 0, row_end = SIM_LCD_ROWS - 1;
+static uint16_t column, row;
+static uint8_t high_byte;
+static bool has_high_byte = false;
+// Scrolling: top fixed area, scrolling area, start line
+static uint16_t TFA = 0, VSA = SIM_LCD_ROWS, SSA = 0;
+static uint64_t pixels = 0;
+
+
+static void software_reset(void){
+
+    command = ST7735_NOP;
+    numArguments = 0;
+    MADCTL = 0;
+    inverted = false;
+    display_on = false;
+    column_start = 0;
+    column_end = SIM_LCD_COLUMNS - 1;
+    row_start = 0;
+    row_end = SIM_LCD_ROWS - 1;
+    TFA = 0;
+    VSA = SIM_LCD_ROWS;
+    SSA = 0;
+    has_high_byte = false;
+}
+
+// Hardware reset (RST pin low)
+void sim_LCDreset(void){
+
+    software_reset();
+}
+
+// Address of the window (as the firmware sees it) on the frame memory
+static void to_memory(uint16_t x, uint16_t y, uint16_t *memory_column, uint16_t *memory_row){
+
+    uint16_t c = x, r = y;
+
+    if (MADCTL & MADCTL_MV){
+
+        c = y;
+        r = x;
+    }
+    if (MADCTL & MADCTL_MX){
+
+        c = SIM_LCD_COLUMNS - 1 - c;
+    }
+    if (MADCTL & MADCTL_MY){
+
+        r = SIM_LCD_ROWS - 1 - r;
+    }
+    *memory_column = c;
+    *memory_row = r;
+}
+
+static void write_pixel(uint16_t colour){
+
+    uint16_t c, r;
+
+    to_memory(column, row, &c, &r);
+    if ((c < SIM_LCD_COLUMNS) && (r < SIM_LCD_ROWS)){
+
+        memory[r][c] = colour;
+    }
+    pixels++;
+    if (column < column_end){
+
+        column++;
+    }else {
+
+        column = column_start;
+        row = (row < row_end) ? row + 1 : row_start;
+    }
+}
+
+static void end_of_arguments(void){
+
+    switch (command){
+
+        case ST7735_CASET:
+            column_start = (arguments[0] << 8) | arguments[1];
+            column_end = (arguments[2] << 8) | arguments[3];
+            break;
+
+        case ST7735_RASET:
+            row_start = (arguments[0] << 8) | arguments[1];
+            row_end = (arguments[2] << 8) | arguments[3];
+            break;
+
+        case ST7735_MADCTL:
+            MADCTL = arguments[0];
+            break;
+
+        case ST7735_SCRLAR:
+            TFA = (arguments[0] << 8) | arguments[1];
+            VSA = (arguments[2] << 8) | arguments[3];
+            break;
+
+        case ST7735_VSCSAD:
+            SSA = (arguments[0] << 8) | arguments[1];
+            break;
+    }
+}
+
+static uint8_t num_arguments(uint8_t command){
+
+    switch (command){
+
+        case ST7735_SCRLAR:
+            return 6;
+
+        case ST7735_CASET:
+        case ST7735_RASET:
+            return 4;
+
+        case ST7735_MADCTL:
+            return 1;
+
+        case ST7735_VSCSAD:
+            return 2;
+
+        default:
+            return 0;
+    }
+}
+
+void sim_LCDwrite(bool data, uint8_t byte){
+
+    if (!data){
+
+        command = byte;
+        numArguments = 0;
+        has_high_byte = false;
+        switch (command){
+
+            case ST7735_SWRESET:
+                software_reset();
+                break;
+
+            case ST7735_RAMWR:
+                column = column_start;
+                row = row_start;
+                break;
+
+            case ST7735_INVON:
+            case ST7735_INVOFF:
+                inverted = (command == ST7735_INVON);
+                break;
+
+            case ST7735_DISPON:
+            case ST7735_DISPOFF:
+                display_on = (command == ST7735_DISPON);
+                break;
+        }
+        return;
+    }
+
+    if (command == ST7735_RAMWR){
+
+        if (has_high_byte){
+
+            write_pixel((high_byte << 8) | byte);
+        }else {
+
+            high_byte = byte;
+        }
+        has_high_byte = !has_high_byte;
+    }else if (numArguments < num_arguments(command)){
+
+        arguments[numArguments++] = byte;
+        if (numArguments == num_arguments(command)){
+
+            end_of_arguments();
+        }
+    }
+}
+
+uint16_t sim_LCDwidth(void){
+
+    return (MADCTL & MADCTL_MV) ? SCREEN_HEIGHT : SCREEN_WIDTH;
+}
+
+uint16_t sim_LCDheight(void){
+
+    return (MADCTL & MADCTL_MV) ? SCREEN_WIDTH : SCREEN_HEIGHT;
+}
+
+// Line of the frame memory on a line of the panel
+static uint16_t scrolled(uint16_t line){
+
+    if ((line < TFA) || (line >= TFA + VSA) || (VSA == 0)){
+
+        return line;
+    }
+
+    return TFA + ((SSA - TFA) + (line - TFA)) % VSA;
+}
+
+uint16_t sim_LCDpixel(uint16_t x, uint16_t y){
+
+    uint16_t c, r, colour;
+
+    if (!display_on){
+
+        return 0;
+    }
+    to_memory(x, y, &c, &r);
+    if ((c >= SIM_LCD_COLUMNS) || (r >= SIM_LCD_ROWS)){
+
+        return 0;
+    }
+    colour = memory[scrolled(r)][c];
+    if (inverted){
+
+        colour = ~colour;
+    }
+    // The firmware colours are BGR (ST7735_RED is 0x001F)
+    if (MADCTL & MADCTL_BGR){
+
+        colour = (colour << 11) | (colour & 0x07E0) | (colour >> 11);
+    }
+
+    return colour;
+}
+
+bool sim_LCDsavePPM(const char path[]){
+
+    uint16_t width = sim_LCDwidth(), height = sim_LCDheight();
+    FILE *file = fopen(path, "wb");
+    bool ok;
+
+    if (file == NULL){
+
+        return false;
+    }
+    fprintf(file, "P6\n%u %u\n255\n", width, height);
+    for (uint16_t y = 0; y < height; y++){
+
+        for (uint16_t x = 0; x < width; x++){
+
+            uint16_t colour = sim_LCDpixel(x, y);
+            uint8_t rgb[3];
+
+            rgb[0] = ((colour >> 11) & 0x1F)*255/31;
+            rgb[1] = ((colour >> 5) & 0x3F)*255/63;
+            rgb[2] = (colour & 0x1F)*255/31;
+            fwrite(rgb, 1, sizeof(rgb), file);
+        }
+    }
+    ok = !ferror(file);
+
+    return (fclose(file) == 0) && ok;
+}
+
+uint64_t sim_LCDpixels(void){
+
+    return pixels;
+}
@@ -0,0 +1,321 @@
+/*
+ * live_stream.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C++ libraries
+#include <cstdint>
+#include <cstring>
+
+// Programmer libraries
+extern "C" {
+#include "driverlib/sw_crc.h"
+}
+#include "live_stream.hpp"
+
+namespace live_stream {
+
+static uint16_t get_uint16(const uint8_t *bytes){
+
+    return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+static uint32_t get_uint32(const uint8_t *bytes){
+
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static uint16_t CRC16(const uint8_t *bytes, size_t length){
+
+    return Crc16(0, bytes, (uint32_t)length);
+}
+
+std::vector<uint8_t> encode_COBS(const std::vector<uint8_t> &packet){
+
+    std::vector<uint8_t> frame(1);
+    size_t code_position = 0;
+    uint8_t code = 1;
+
+    for (uint8_t byte : packet){
+
+        if (byte != 0){
+
+            frame.push_back(byte);
+            code++;
+        }
+        if ((byte == 0) || (code == 0xFF)){
+
+            frame[code_position] = code;
+            code_position = frame.size();
+            frame.push_back(0);
+            code = 1;
+        }
+    }
+    frame[code_position] = code;
+    frame.push_back(0);
+
+    return frame;
+}
+
+bool decode_COBS(const uint8_t *frame, size_t length, std::vector<uint8_t> &packet){
+
+    size_t i = 0;
+
+    packet.clear();
+    while (i < length){
+
+        uint8_t code = frame[i++];
+
+        if ((code == 0) || (i + code - 1 > length)){
+
+            return false;
+        }
+        packet.insert(packet.end(), frame + i, frame + i + code - 1);
+        i += code - 1;
+        if ((code < 0xFF) && (i < length)){
+
+            packet.push_back(0);
+        }
+    }
+
+    return true;
+}
+
+std::vector<uint8_t> encode_packet(uint8_t type, const std::vector<uint8_t> &payload){
+
+    std::vector<uint8_t> packet;
+    uint16_t CRC;
+
+    packet.reserve(1 + payload.size() + 2);
+    packet.push_back(type);
+    for (uint8_t byte : payload){
+
+        packet.push_back(byte);
+    }
+    CRC = CRC16(packet.data(), packet.size());
+    packet.push_back((uint8_t)CRC);
+    packet.push_back((uint8_t)(CRC >> 8));
+
+    return encode_COBS(packet);
+}
+
+std::vector<uint8_t> subscribe(uint8_t channel, uint16_t period_ms){
+
+    return encode_packet(STREAM_SUBSCRIBE, {channel, (uint8_t)period_ms, (uint8_t)(period_ms >> 8)});
+}
+
+std::vector<uint8_t> raw_frames(bool on){
+
+    return encode_packet(STREAM_RAW, {(uint8_t)(on ? 1 : 0)});
+}
+
+std::vector<uint8_t> info(){
+
+    return encode_packet(STREAM_INFO, {});
+}
+
+std::vector<uint8_t> stop(){
+
+    return encode_packet(STREAM_STOP, {});
+}
+
+std::string Decoder::channel_name(uint8_t channel) const{
+
+    auto found = channel_list.find(channel);
+
+    return (found != channel_list.end()) ? found->second.name : std::to_string(channel);
+}
+
+void Decoder::feed(const uint8_t *bytes, size_t length){
+
+    decoder_stats.bytes += length;
+    for (size_t i = 0; i < length; i++){
+
+        if (bytes[i] == 0){
+
+            end_frame();
+        }else if (frame.size() < STREAM_MAX_FRAME){
+
+            frame.push_back(bytes[i]);
+        }else {
+
+            overflow = true;
+        }
+    }
+}
+
+void Decoder::end_frame(){
+
+    bool right = (!overflow) && decode_COBS(frame.data(), frame.size(), packet) && (packet.size() >= 3) &&
+                 (CRC16(packet.data(), packet.size() - 2) == get_uint16(&packet[packet.size() - 2]));
+
+    // A 0 alone only ends what was before it
+    if (!frame.empty() || overflow){
+
+        if (right){
+
+            packet.resize(packet.size() - 2);
+            right = packet_done(packet);
+        }
+        if (right){
+
+            decoder_stats.frames++;
+        }else {
+
+            decoder_stats.bad_frames++;
+        }
+    }
+    frame.clear();
+    overflow = false;
+}
+
+// Type and payload, false if the length is wrong
+bool Decoder::packet_done(const std::vector<uint8_t> &packet){
+
+    const uint8_t *payload = packet.data() + 1;
+    size_t length = packet.size() - 1;
+
+    switch (packet[0]){
+
+    case STREAM_HELLO:{
+
+        if (length != 6){
+
+            return false;
+        }
+        last_hello.version = payload[0];
+        last_hello.channels = payload[1];
+        last_hello.response_ID = get_uint32(payload + 2);
+        channel_list.clear();
+        if (on_hello){
+
+            on_hello(last_hello);
+        }
+        break;
+    }
+    case STREAM_CHANNEL:{
+
+        Channel channel;
+
+        if (length < 6){
+
+            return false;
+        }
+        channel.number = payload[0];
+        channel.PID = payload[1];
+        channel.min = (int16_t)get_uint16(payload + 2);
+        channel.max = (int16_t)get_uint16(payload + 4);
+        channel.name.assign((const char *)payload + 6, length - 6);
+        channel_list[channel.number] = channel;
+        if (on_channel){
+
+            on_channel(channel);
+        }
+        break;
+    }
+    case STREAM_SAMPLES:{
+
+        Sample sample;
+
+        if ((length < 4) || ((length - 4) % 5 != 0)){
+
+            return false;
+        }
+        sample.time_ms = get_uint32(payload);
+        for (size_t i = 4; i < length; i += 5){
+
+            uint32_t bits = get_uint32(payload + i + 1);
+
+            sample.channel = payload[i];
+            memcpy(&sample.value, &bits, sizeof(sample.value));
+            decoder_stats.samples++;
+            if (on_sample){
+
+                on_sample(sample);
+            }
+        }
+        break;
+    }
+    case STREAM_CAN:{
+
+        size_t i = 0;
+
+        // The whole packet is checked before the frames are given
+        while (i + 9 <= length){
+
+            i += 9 + payload[i + 8];
+        }
+        if ((i != length) || (length == 0)){
+
+            return false;
+        }
+        for (i = 0; i < length; i += 9 + payload[i + 8]){
+
+            CANFrame frame;
+            uint32_t ID = get_uint32(payload + i + 4);
+
+            frame.time_ms = get_uint32(payload + i);
+            frame.extended = (ID & STREAM_CAN_EXTENDED) != 0;
+            frame.sent = (ID & STREAM_CAN_TX) != 0;
+            frame.ID = ID & ~(STREAM_CAN_EXTENDED | STREAM_CAN_TX);
+            frame.length = (payload[i + 8] > 8) ? 8 : payload[i + 8];
+            memcpy(frame.data, payload + i + 9, frame.length);
+            decoder_stats.CAN_frames++;
+            if (on_CANframe){
+
+                on_CANframe(frame);
+            }
+        }
+        break;
+    }
+    case STREAM_STATUS:{
+
+        Status status;
+        uint32_t *counters = (uint32_t *)&status.stats;
+
+        if (length != 4 + sizeof(tStreamStats)){
+
+            return false;
+        }
+        status.time_ms = get_uint32(payload);
+        for (size_t i = 0; i < sizeof(tStreamStats)/sizeof(uint32_t); i++){
+
+            counters[i] = get_uint32(payload + 4 + 4*i);
+        }
+        if (on_status){
+
+            on_status(status);
+        }
+        break;
+    }
+    case STREAM_ACK:{
+
+        Ack ack;
+
+        if (length != 2){
+
+            return false;
+        }
+        ack.command = payload[0];
+        ack.done = (payload[1] == 0);
+        if (on_ack){
+
+            on_ack(ack);
+        }
+        break;
+    }
+    default:
+        decoder_stats.unknown++;
+        break;
+    }
+
+    return true;
+}
+
+} // namespace live_stream
@@ -0,0 +1,137 @@
+/*
+ * live_stream.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      The PC side of the binary stream of the live data (Software/Live_stream.h): the decoder of
+ *      the frames of the device and the encoder of the commands. The bytes can come in pieces of
+ *      any size. A frame with a wrong COBS code or CRC is counted and skipped, and the next 0
+ *      starts a new one, so the decoder finds the stream again after the text of the console or
+ *      lost bytes. The CRC is the one of the firmware (Software/driverlib/sw_crc.c).
+ */
+
+#ifndef LIVE_STREAM_HPP_
+#define LIVE_STREAM_HPP_
+
+// C++ libraries
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+extern "C" {
+#include "Live_stream.h"
+}
+
+namespace live_stream {
+
+struct Hello{
+
+    uint8_t version = 0;
+    uint8_t channels = 0;
+    uint32_t response_ID = 0;
+};
+
+struct Channel{
+
+    uint8_t number = 0;
+    uint8_t PID = 0;
+    int16_t min = 0;
+    int16_t max = 0;
+    std::string name;
+};
+
+struct Sample{
+
+    uint32_t time_ms = 0;
+    uint8_t channel = 0;
+    float value = 0;
+};
+
+struct CANFrame{
+
+    uint32_t time_ms = 0;
+    uint32_t ID = 0;            // Without the flags
+    bool extended = false;
+    bool sent = false;          // By the device
+    uint8_t length = 0;
+    uint8_t data[8] = {0};
+};
+
+struct Status{
+
+    uint32_t time_ms = 0;
+    tStreamStats stats = {};
+};
+
+struct Ack{
+
+    uint8_t command = 0;
+    bool done = false;
+};
+
+struct DecoderStats{
+
+    uint64_t bytes = 0;
+    uint64_t frames = 0;        // Right ones
+    uint64_t bad_frames = 0;    // COBS, CRC or length
+    uint64_t unknown = 0;       // Right frames of an unknown type
+    uint64_t samples = 0;
+    uint64_t CAN_frames = 0;
+};
+
+std::vector<uint8_t> encode_COBS(const std::vector<uint8_t> &packet);
+// Frame without the final 0. False if it is wrong.
+bool decode_COBS(const uint8_t *frame, size_t length, std::vector<uint8_t> &packet);
+// Type, payload and CRC, encoded and ended by the 0
+std::vector<uint8_t> encode_packet(uint8_t type, const std::vector<uint8_t> &payload);
+
+// Commands of the PC
+std::vector<uint8_t> subscribe(uint8_t channel, uint16_t period_ms);
+std::vector<uint8_t> raw_frames(bool on);
+std::vector<uint8_t> info();
+std::vector<uint8_t> stop();
+
+class Decoder{
+
+public:
+    // Called for every packet, in the order of the stream
+    std::function<void(const Hello &)> on_hello;
+    std::function<void(const Channel &)> on_channel;
+    std::function<void(const Sample &)> on_sample;
+    std::function<void(const CANFrame &)> on_CANframe;
+    std::function<void(const Status &)> on_status;
+    std::function<void(const Ack &)> on_ack;
+
+    void feed(const uint8_t *bytes, size_t length);
+    void feed(const std::vector<uint8_t> &bytes) { feed(bytes.data(), bytes.size()); }
+
+    const DecoderStats &stats() const { return decoder_stats; }
+    const Hello &hello() const { return last_hello; }
+    // Channels of the last HELLO, by number
+    const std::map<uint8_t, Channel> &channels() const { return channel_list; }
+    std::string channel_name(uint8_t channel) const;
+
+private:
+    void end_frame();
+    bool packet_done(const std::vector<uint8_t> &packet);
+
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> packet;
+    bool overflow = false;
+    DecoderStats decoder_stats;
+    Hello last_hello;
+    std::map<uint8_t, Channel> channel_list;
+};
+
+} // namespace live_stream
+
+#endif /* LIVE_STREAM_HPP_ */
@@ -0,0 +1,372 @@
+/*
+ * live_stream_test.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      Host test of the binary stream of the live data: Software/Live_stream.c runs on the bus of
+ *      Host/OBD_host with the ECUs of Host/ECU_sim, and its output goes through a model of the
+ *      ring of UARTwriteRaw (UART_RAW_BUFFER_SIZE bytes drained at the baud rate, in virtual
+ *      time) to the decoder of live_stream.hpp. The test checks the COBS framing on the edge
+ *      cases, HELLO and the channels, the values and periods of the samples, the grouping of the
+ *      PIDs in the requests, the commands with a wrong CRC or arguments, the CAN frames, the
+ *      status, a corrupted frame and STOP. Then it measures the samples per second with every
+ *      channel at the shortest period on the ECM of oe91c1610.scn, and the bytes on the UART per
+ *      sample against an ELM327.
+ *
+ *      Build and run (from this folder):
+ *          cc -std=gnu99 -O2 -Wall -DPROBES_HOST -DLIVE_STREAM_HOST -I../../Software -I../OBD_host -c ../../Software/Live_stream.c ../../Software/OBD_protocol.c ../../Software/Cycle_probes.c ../OBD_host/obd_hal_host.c
+ *          cc -std=gnu99 -O2 -Wno-pointer-to-int-cast -I../../Software -c ../../Software/driverlib/sw_crc.c
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -I../OBD_host -I../ECU_sim -o live_stream_test live_stream_test.cpp live_stream.cpp ../ECU_sim/ecu_sim.cpp Live_stream.o OBD_protocol.o Cycle_probes.o sw_crc.o obd_hal_host.o -lm
+ *          ./live_stream_test [seconds]
+ */
+
+// C++ libraries
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+extern "C" {
+#include "obd_hal_host.h"
+#include "OBD_protocol.h"
+#include "Live_logger.h"
+#include "Live_stream.h"
+}
+#include "ecu_sim.hpp"
+#include "ecu_sim_check.hpp"
+#include "live_stream.hpp"
+
+#define BENCH_SECONDS 10
+#define RAW_BUFFER_BYTES 1024               // UART_RAW_BUFFER_SIZE of uartstdio
+#define UART_BITS_PER_CHAR 10               // 8N1
+#define RPM_CHANNEL 4
+#define SPEED_CHANNEL 5
+
+static const char *SCENARIO =
+    ECU_SIM_CHECK_ECM
+    "pid 04 const 128\n"
+    "pid 05 const 130\n"
+    "pid 0C const 0x1AF8\n"
+    "pid 0D const 88\n"
+    "pid 10 const 0x0190\n"
+    "pid 1F const 600\n"
+    ECU_SIM_CHECK_TCM;
+
+// The device: the stream, the ECUs and the UART
+struct Device{
+
+    ecu_sim::Simulator ECUs;
+    std::vector<ecu_sim::Frame> out;
+    live_stream::Decoder decoder;
+    uint32_t baud = 115200;
+    uint64_t UART_endUs = 0;                // The ring is empty at this time
+    uint64_t UART_bytes = 0;
+    uint8_t corrupt_next = 0;               // Bytes of the next frame to change
+
+    explicit Device(const ecu_sim::Scenario &scenario) : ECUs(scenario){}
+};
+
+static Device *device = nullptr;
+
+
+// The ring of UARTwriteRaw: a frame that does not fit is not written
+static uint32_t write_UART(const uint8_t data[], uint32_t length){
+
+    uint64_t now = host_timeUs();
+    double byte_us = UART_BITS_PER_CHAR*1e6/device->baud;
+    uint64_t queued = (device->UART_endUs > now) ? (uint64_t)ceil((device->UART_endUs - now)/byte_us) : 0;
+    std::vector<uint8_t> bytes(data, data + length);
+
+    if (queued + length > RAW_BUFFER_BYTES){
+
+        return 0;
+    }
+    device->UART_endUs = ((device->UART_endUs > now) ? device->UART_endUs : now) + (uint64_t)ceil(length*byte_us);
+    device->UART_bytes += length;
+    for (size_t i = 0; (i < device->corrupt_next) && (i + 1 < bytes.size()); i++){
+
+        bytes[bytes.size()/2 + i/2] ^= 0x10;
+    }
+    device->corrupt_next = 0;
+    device->decoder.feed(bytes);
+
+    return length;
+}
+
+// The frames of the device go to the ECUs and their answers to the queue of the HAL. Both go to
+// the stream like in CAN_device.c (the answers when they are injected).
+static void respond(const tHostFrame *frame, void *context){
+
+    ecu_sim::Frame request;
+
+    (void)context;
+    request.time_us = frame->time_us;
+    request.ID = frame->ID;
+    request.extended = (frame->ID > 0x7FF);
+    request.length = frame->length;
+    memcpy(request.data, frame->data, sizeof(request.data));
+    stream_CANframe(frame->ID, frame->data, frame->length, CAN_CAPTURE_TX);
+
+    device->out.clear();
+    device->ECUs.on_frame(request, device->out);
+    for (const ecu_sim::Frame &answer : device->out){
+
+        host_CANinject(answer.ID, answer.data, answer.length, (uint32_t)(answer.time_us - host_timeUs()));
+        stream_CANframe(answer.ID, answer.data, answer.length, answer.extended ? CAN_CAPTURE_EXTENDED : 0);
+    }
+}
+
+static void start(Device &new_device, uint32_t baud){
+
+    device = &new_device;
+    device->baud = baud;
+    host_resetHAL();
+    host_setResponder(respond, nullptr);
+    init_stream(write_UART, ECM_REQUEST, ECM_RESPONSE);
+}
+
+// Commands of the PC
+static void send(const std::vector<uint8_t> &bytes){
+
+    for (uint8_t byte : bytes){
+
+        stream_input(byte);
+    }
+}
+
+// The loop of the shell (Diag_shell.c) for ms of virtual time
+static void run(uint32_t ms){
+
+    uint64_t end_us = host_timeUs() + ms*1000ull;
+
+    while (stream_active() && (host_timeUs() < end_us)){
+
+        uint64_t before_us = host_timeUs();
+        uint32_t wait_ms = stream_service();
+
+        if ((wait_ms == 0) && (host_timeUs() == before_us)){
+
+            wait_ms = 1;
+        }
+        host_advanceUs(wait_ms*1000ull);
+    }
+}
+
+static void test_COBS(void){
+
+    std::vector<std::vector<uint8_t>> packets = {{}, {0}, {0, 0}, {1}, {1, 0, 2}, {0, 1, 0}};
+    std::vector<uint8_t> long_packet, packet;
+
+    for (int i = 0; i < 600; i++){
+
+        long_packet.push_back((uint8_t)((i % 300 == 299) ? 0 : 1 + i % 255));
+    }
+    packets.push_back(long_packet);
+    packets.push_back(std::vector<uint8_t>(254, 0x7F));
+    for (const std::vector<uint8_t> &original : packets){
+
+        std::vector<uint8_t> frame = live_stream::encode_COBS(original);
+        bool zeros = false;
+
+        for (size_t i = 0; i + 1 < frame.size(); i++){
+
+            zeros |= (frame[i] == 0);
+        }
+        check(!zeros && (frame.back() == 0), "COBS: only the last byte is 0");
+        check(live_stream::decode_COBS(frame.data(), frame.size() - 1, packet) && (packet == original), "COBS round trip");
+    }
+    packet.clear();
+    check(!live_stream::decode_COBS((const uint8_t *)"\x05\x01", 2, packet), "COBS: block longer than the frame");
+}
+
+static void test_stream(void){
+
+    Device test(parse(SCENARIO));
+    std::vector<live_stream::Sample> samples;
+    std::vector<live_stream::CANFrame> frames;
+    std::vector<live_stream::Ack> acks;
+    std::vector<live_stream::Status> status;
+    int hellos = 0;
+    tStreamStats stats;
+
+    test.decoder.on_hello = [&](const live_stream::Hello &){ hellos++; };
+    test.decoder.on_sample = [&](const live_stream::Sample &sample){ samples.push_back(sample); };
+    test.decoder.on_CANframe = [&](const live_stream::CANFrame &frame){ frames.push_back(frame); };
+    test.decoder.on_ack = [&](const live_stream::Ack &ack){ acks.push_back(ack); };
+    test.decoder.on_status = [&](const live_stream::Status &new_status){ status.push_back(new_status); };
+    start(test, 115200);
+
+    // HELLO and the channels of pids_liveData
+    check(hellos == 1, "HELLO at the start");
+    check((test.decoder.hello().version == STREAM_VERSION) && (test.decoder.hello().channels == NUM_LIVE_DATA_PIDS) &&
+          (test.decoder.hello().response_ID == ECM_RESPONSE), "HELLO: version, channels and ECU");
+    check(test.decoder.channels().size() == NUM_LIVE_DATA_PIDS, "Every channel");
+    check((test.decoder.channel_name(RPM_CHANNEL) == "RPM") && (test.decoder.channels().at(RPM_CHANNEL).PID == 0x0C) &&
+          (test.decoder.channels().at(RPM_CHANNEL).max == 8000), "Channel of the RPM");
+    check(test.decoder.channels().at(1).min == -40, "Negative minimum");
+    check(test.decoder.stats().bad_frames == 0, "No bad frame");
+
+    // Nothing without subscriptions
+    run(500);
+    check(samples.empty(), "No samples before a subscription");
+
+    // The RPM every 100 ms
+    send(live_stream::subscribe(RPM_CHANNEL, 100));
+    check((acks.size() == 1) && (acks[0].command == STREAM_SUBSCRIBE) && acks[0].done, "ACK of the subscription");
+    run(1000);
+    check((samples.size() >= 10) && (samples.size() <= 11), "10 samples in 1 s");
+    for (size_t i = 0; i < samples.size(); i++){
+
+        check((samples[i].channel == RPM_CHANNEL) && (samples[i].value == 1726.0f), "RPM of the ECM");
+        check((i == 0) || ((samples[i].time_ms - samples[i-1].time_ms >= 98) && (samples[i].time_ms - samples[i-1].time_ms <= 102)),
+              "Period of 100 ms");
+    }
+
+    // Every channel: the PIDs of the ECM only, several in a request
+    samples.clear();
+    get_streamStats(&stats);
+    uint32_t requests = stats.requests;
+    send(live_stream::subscribe(STREAM_ALL_CHANNELS, 50));
+    run(1000);
+    get_streamStats(&stats);
+    bool values = true, others = false;
+    for (const live_stream::Sample &sample : samples){
+
+        switch (sample.channel){
+
+        case 0: values &= (fabsf(sample.value - 50.196f) < 0.01f); break;
+        case 1: values &= (sample.value == 90.0f); break;
+        case 4: values &= (sample.value == 1726.0f); break;
+        case 5: values &= (sample.value == 88.0f); break;
+        case 9: values &= (sample.value == 4.0f); break;
+        case 11: values &= (sample.value == 600.0f); break;
+        default: others = true; break;
+        }
+    }
+    check(values, "Values of every PID");
+    check(!others, "Only the PIDs of the ECM");
+    check((samples.size() >= 6*19) && (samples.size() <= 6*21), "6 PIDs every 50 ms");
+    check(stats.requests - requests <= 2*21, "12 PIDs in 2 requests");
+
+    // Commands with a wrong CRC, channel or length
+    std::vector<uint8_t> wrong = live_stream::subscribe(RPM_CHANNEL, 10);
+    wrong[2] ^= 0x01;
+    size_t numAcks = acks.size();
+    send(wrong);
+    send(live_stream::subscribe(NUM_LIVE_DATA_PIDS, 10));
+    send(live_stream::encode_packet(STREAM_RAW, {}));
+    send({0, 0});
+    get_streamStats(&stats);
+    check(stats.bad_commands == 3, "Wrong commands counted");
+    check((acks.size() == numAcks + 2) && (!acks[numAcks].done) && (!acks[numAcks+1].done), "Wrong arguments not done");
+
+    // Only the RPM, with the CAN frames: request and response of the ECM
+    send(live_stream::subscribe(STREAM_ALL_CHANNELS, 0));
+    send(live_stream::subscribe(RPM_CHANNEL, 100));
+    send(live_stream::raw_frames(true));
+    run(1000);
+    bool request = false, response = false;
+    for (const live_stream::CANFrame &frame : frames){
+
+        request |= (frame.sent && (frame.ID == ECM_REQUEST) && (frame.length == 8) && (frame.data[0] == 2) &&
+                    (frame.data[1] == 0x01) && (frame.data[2] == 0x0C));
+        response |= ((!frame.sent) && (frame.ID == ECM_RESPONSE) && (frame.data[1] == 0x41) && (frame.data[3] == 0x1A));
+    }
+    check(request && response, "CAN frames of the request and the response");
+    check(frames.size() >= 20, "2 frames per request");
+    send(live_stream::raw_frames(false));
+    frames.clear();
+    run(500);
+    check(frames.empty(), "No CAN frames after RAW 0");
+
+    // A corrupted frame is skipped, the next ones are read
+    uint64_t bad = test.decoder.stats().bad_frames;
+    size_t numSamples = samples.size();
+    test.corrupt_next = 1;
+    run(1000);
+    check(test.decoder.stats().bad_frames == bad + 1, "Corrupted frame found");
+    check(samples.size() - numSamples >= 8, "Stream found again");
+
+    // Status every second, with the counters of the device
+    check(status.size() >= 4, "Status every second");
+    get_streamStats(&stats);
+    check((status.back().stats.samples <= stats.samples) && (status.back().stats.samples + 10 >= stats.samples),
+          "Samples of the status");
+    check(status.back().stats.dropped == 0, "Nothing dropped at 115200 baud");
+
+    // INFO and STOP
+    send(live_stream::info());
+    run(20);
+    check(hellos == 2, "HELLO again for INFO");
+    send(live_stream::stop());
+    check(!stream_active(), "STOP");
+    check((acks.back().command == STREAM_STOP) && acks.back().done, "ACK of STOP");
+    host_setResponder(nullptr, nullptr);
+}
+
+// Samples per second with every channel at the shortest period
+static void bench(uint32_t seconds){
+
+    static const uint32_t bauds[] = {115200, 460800, 921600};
+    ecu_sim::Scenario scenario;
+    std::string error;
+    // "41 0C 1A F8 \r" of an ELM327 with the spaces, echo off and one PID per request, and the request
+    const double ELM_bytes = 13 + 5;
+
+    if (!ecu_sim::load_scenario("../ECU_sim/scenarios/oe91c1610.scn", scenario, error)){
+
+        printf("FAIL: %s\n", error.c_str());
+        failures++;
+        return;
+    }
+    printf("Every channel every %u ms for %u s on the ECM of oe91c1610.scn, 500 kbit/s:\n", STREAM_MIN_PERIOD_MS, seconds);
+    for (uint32_t baud : bauds){
+
+        for (bool raw : {false, true}){
+
+            Device test(scenario);
+            tStreamStats stats;
+
+            start(test, baud);
+            send(live_stream::subscribe(STREAM_ALL_CHANNELS, STREAM_MIN_PERIOD_MS));
+            send(live_stream::raw_frames(raw));
+            run(seconds*1000);
+            get_streamStats(&stats);
+
+            double samples_s = (double)test.decoder.stats().samples/seconds;
+            double UART_use = 100.0*test.UART_bytes*UART_BITS_PER_CHAR/baud/seconds;
+
+            printf("  %6u baud%s: %6.0f samples/s, %5.0f CAN frames/s, %4.1f bytes per sample (ELM327 %.0f), "
+                   "UART %3.0f %%, %u frames dropped\n", baud, raw ? " + CAN" : "      ", samples_s,
+                   (double)test.decoder.stats().CAN_frames/seconds, (double)test.UART_bytes/test.decoder.stats().samples,
+                   ELM_bytes, UART_use, stats.dropped);
+            check(test.decoder.stats().bad_frames == 0, "No bad frames in the bench");
+            check((raw) || (stats.dropped == 0), "Samples alone fit at every baud rate");
+            check(samples_s > 500, "More than 500 samples/s");
+            host_setResponder(nullptr, nullptr);
+        }
+    }
+}
+
+int main(int argc, char *argv[]){
+
+    uint32_t seconds = (argc > 1) ? strtoul(argv[1], nullptr, 0) : BENCH_SECONDS;
+
+    test_COBS();
+    test_stream();
+    bench(seconds);
+
+    if (failures > 0){
+
+        printf("%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("Live stream correct\n");
+
+    return EXIT_SUCCESS;
+}
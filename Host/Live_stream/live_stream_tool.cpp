@@ -0,0 +1,298 @@
+/*
+ * live_stream_tool.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      Writes the samples and the CAN frames of the binary stream of the live data
+ *      (Software/Live_stream.h) as CSV: "time_ms,name,value" for a sample and
+ *      "time_ms,CAN,ID,TX|RX,data" for a frame. The counters go to stderr.
+ *
+ *      From a capture (the console of the firmware simulator with -u, or cat of the port):
+ *          ./live_stream capture.bin > samples.csv
+ *      From the device: 'stream' is typed on the shell at 115200, the port goes to the baud rate of
+ *      the stream and the subscriptions are sent (-s channel:ms or all:ms, -r for the CAN frames).
+ *      Ctrl+C or the end of -t seconds sends STOP.
+ *          ./live_stream -d /dev/ttyACM0 -b 460800 -s all:100 -s 1:20 -t 60 > samples.csv
+ *
+ *      Build (from this folder):
+ *          cc -std=gnu99 -O2 -Wno-pointer-to-int-cast -I../../Software -c ../../Software/driverlib/sw_crc.c
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -o live_stream live_stream_tool.cpp live_stream.cpp sw_crc.o
+ */
+
+// C libraries
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+// C++ libraries
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "live_stream.hpp"
+
+#define SHELL_BAUD 115200
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int){
+
+    stop_requested = 1;
+}
+
+static void print_sample(const live_stream::Decoder &decoder, const live_stream::Sample &sample){
+
+    printf("%u,%s,%g\n", sample.time_ms, decoder.channel_name(sample.channel).c_str(), sample.value);
+}
+
+static void print_CANframe(const live_stream::CANFrame &frame){
+
+    printf("%u,CAN,%0*X,%s,", frame.time_ms, frame.extended ? 8 : 3, frame.ID, frame.sent ? "TX" : "RX");
+    for (uint8_t i = 0; i < frame.length; i++){
+
+        printf("%02X", frame.data[i]);
+    }
+    printf("\n");
+}
+
+static void print_stats(const live_stream::Decoder &decoder, const live_stream::Status *status){
+
+    const live_stream::DecoderStats &stats = decoder.stats();
+
+    fprintf(stderr, "%llu bytes: %llu frames, %llu bad frames, %llu unknown, %llu samples, %llu CAN frames\n",
+            (unsigned long long)stats.bytes, (unsigned long long)stats.frames, (unsigned long long)stats.bad_frames,
+            (unsigned long long)stats.unknown, (unsigned long long)stats.samples,
+            (unsigned long long)stats.CAN_frames);
+    if (status != nullptr){
+
+        fprintf(stderr, "Device at %u ms: %u packets, %u dropped, %u samples, %u CAN frames (%u lost), "
+                "%u requests, %u timeouts, %u bad commands\n", status->time_ms, status->stats.packets,
+                status->stats.dropped, status->stats.samples, status->stats.CAN_frames, status->stats.CAN_lost,
+                status->stats.requests, status->stats.timeouts, status->stats.bad_commands);
+    }
+}
+
+static speed_t get_speed(uint32_t baud){
+
+    switch (baud){
+
+    case 9600:      return B9600;
+    case 19200:     return B19200;
+    case 38400:     return B38400;
+    case 57600:     return B57600;
+    case 115200:    return B115200;
+    case 230400:    return B230400;
+    case 460800:    return B460800;
+    case 921600:    return B921600;
+    default:        return B0;
+    }
+}
+
+static bool set_baud(int port, uint32_t baud){
+
+    struct termios settings;
+
+    if (tcgetattr(port, &settings) != 0){
+
+        return false;
+    }
+    cfmakeraw(&settings);
+    cfsetispeed(&settings, get_speed(baud));
+    cfsetospeed(&settings, get_speed(baud));
+
+    return tcsetattr(port, TCSADRAIN, &settings) == 0;
+}
+
+static bool write_all(int port, const std::vector<uint8_t> &bytes){
+
+    return write(port, bytes.data(), bytes.size()) == (ssize_t)bytes.size();
+}
+
+// Bytes of the port to the decoder for the ms given (or until Ctrl+C)
+static void read_port(int port, live_stream::Decoder &decoder, uint32_t time_ms){
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(time_ms);
+    uint8_t buffer[4096];
+
+    while ((!stop_requested) && (std::chrono::steady_clock::now() < end)){
+
+        struct pollfd input = {port, POLLIN, 0};
+
+        if ((poll(&input, 1, 50) > 0) && (input.revents & POLLIN)){
+
+            ssize_t length = read(port, buffer, sizeof(buffer));
+
+            if (length > 0){
+
+                decoder.feed(buffer, (size_t)length);
+            }
+        }
+    }
+}
+
+// "all:ms" or "channel:ms"
+static bool get_subscription(const char *text, uint8_t &channel, uint16_t &period_ms){
+
+    const char *colon = strchr(text, ':');
+    char *end;
+    unsigned long number;
+
+    if (colon == nullptr){
+
+        return false;
+    }
+    if (strncmp(text, "all:", 4) == 0){
+
+        channel = STREAM_ALL_CHANNELS;
+    }else {
+
+        number = strtoul(text, &end, 10);
+        if ((end != colon) || (number >= STREAM_ALL_CHANNELS)){
+
+            return false;
+        }
+        channel = (uint8_t)number;
+    }
+    number = strtoul(colon + 1, &end, 10);
+    period_ms = (uint16_t)number;
+
+    return (*end == '\0') && (number <= 0xFFFF);
+}
+
+static int usage(const char *name){
+
+    fprintf(stderr, "Usage: %s capture\n"
+            "       %s -d port [-b baud] [-s channel:ms|all:ms]... [-r] [-t seconds]\n", name, name);
+
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[]){
+
+    live_stream::Decoder decoder;
+    live_stream::Status last_status;
+    bool have_status = false;
+    const char *device = nullptr;
+    uint32_t baud = SHELL_BAUD;
+    uint32_t time_s = 0;
+    bool raw = false;
+    std::vector<std::vector<uint8_t>> subscriptions;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:b:s:rt:")) != -1){
+
+        uint8_t channel;
+        uint16_t period_ms;
+
+        switch (opt){
+
+        case 'd':
+            device = optarg;
+            break;
+        case 'b':
+            baud = (uint32_t)strtoul(optarg, nullptr, 10);
+            if (get_speed(baud) == B0){
+
+                fprintf(stderr, "Baud rate not supported: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 's':
+            if (!get_subscription(optarg, channel, period_ms)){
+
+                return usage(argv[0]);
+            }
+            subscriptions.push_back(live_stream::subscribe(channel, period_ms));
+            break;
+        case 'r':
+            raw = true;
+            break;
+        case 't':
+            time_s = (uint32_t)strtoul(optarg, nullptr, 10);
+            break;
+        default:
+            return usage(argv[0]);
+        }
+    }
+    if ((device == nullptr) == (optind >= argc)){
+
+        return usage(argv[0]);
+    }
+
+    decoder.on_sample = [&decoder](const live_stream::Sample &sample){ print_sample(decoder, sample); };
+    decoder.on_CANframe = print_CANframe;
+    decoder.on_status = [&](const live_stream::Status &status){ last_status = status; have_status = true; };
+    decoder.on_ack = [](const live_stream::Ack &ack){
+        if (!ack.done){
+
+            fprintf(stderr, "Command 0x%02X refused by the device\n", ack.command);
+        }
+    };
+    printf("time_ms,name,value\n");
+
+    if (device == nullptr){
+
+        FILE *file = fopen(argv[optind], "rb");
+        uint8_t buffer[4096];
+        size_t length;
+
+        if (file == nullptr){
+
+            fprintf(stderr, "Can't open %s\n", argv[optind]);
+            return EXIT_FAILURE;
+        }
+        while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0){
+
+            decoder.feed(buffer, length);
+        }
+        fclose(file);
+        print_stats(decoder, have_status ? &last_status : nullptr);
+
+        return EXIT_SUCCESS;
+    }
+
+    int port = open(device, O_RDWR | O_NOCTTY);
+    std::string command = "stream " + std::to_string(baud) + "\r";
+
+    if ((port < 0) || (!set_baud(port, SHELL_BAUD))){
+
+        fprintf(stderr, "Can't open %s\n", device);
+        return EXIT_FAILURE;
+    }
+    signal(SIGINT, on_signal);
+    tcflush(port, TCIOFLUSH);
+    write_all(port, std::vector<uint8_t>(command.begin(), command.end()));
+    // The line "Stream at" goes out at 115200 before the device changes the baud rate
+    tcdrain(port);
+    usleep(100000);
+    set_baud(port, baud);
+    // HELLO may be lost in the change of the baud rate
+    write_all(port, live_stream::info());
+    for (const std::vector<uint8_t> &subscription : subscriptions){
+
+        write_all(port, subscription);
+    }
+    if (raw){
+
+        write_all(port, live_stream::raw_frames(true));
+    }
+    read_port(port, decoder, (time_s != 0) ? time_s*1000 : UINT32_MAX);
+    stop_requested = 0;
+    write_all(port, live_stream::stop());
+    read_port(port, decoder, 200);
+    set_baud(port, SHELL_BAUD);
+    close(port);
+
+    fprintf(stderr, "Device %s, response ID %X, %u channels\n", (decoder.hello().version != 0) ? "found" : "not found",
+            decoder.hello().response_ID, decoder.hello().channels);
+    print_stats(decoder, have_status ? &last_status : nullptr);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,545 @@
+/*
+ * candump_decoder.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C++ libraries
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Programmer libraries
+#include "candump_decoder.hpp"
+
+namespace decoder {
+
+// Hex characters in a frame: 8 data bytes
+static const size_t FULL_FRAME_CHARS = 16;
+static const uint8_t NO_FORMULA = 0xFF;
+
+
+MappedFile::~MappedFile(){
+
+    close();
+}
+
+bool MappedFile::open(const std::string &path){
+
+    struct stat info;
+    int fd;
+
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if ((fd < 0) || (fstat(fd, &info) != 0)){
+
+        perror(path.c_str());
+        if (fd >= 0){
+
+            ::close(fd);
+        }
+        return false;
+    }
+    length = (size_t)info.st_size;
+    if (length > 0){
+
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED){
+
+            perror(path.c_str());
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        address = (const char *)mapped;
+        madvise(mapped, length, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+
+    return true;
+}
+
+void MappedFile::close(){
+
+    if (address != nullptr){
+
+        munmap((void *)address, length);
+        address = nullptr;
+    }
+    length = 0;
+}
+
+const char *simd_name(){
+
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+std::vector<size_t> split_blocks(const char *data, size_t length, size_t block_size){
+
+    std::vector<size_t> starts;
+    size_t position = 0;
+
+    while (position < length){
+
+        starts.push_back(position);
+        if (length - position <= block_size){
+
+            break;
+        }
+        const char *line_end = (const char *)memchr(data + position + block_size, '\n', length - position - block_size);
+        position = (line_end == nullptr) ? length : (size_t)(line_end - data) + 1;
+    }
+    starts.push_back(length);
+
+    return starts;
+}
+
+struct FormulaPositions{
+
+    uint8_t position[256];
+
+    FormulaPositions(){
+
+        memset(position, NO_FORMULA, sizeof(position));
+        for (size_t i = 0; i < obd::NUM_PID_FORMULAS; i++){
+
+            position[obd::PID_formulas[i].PID] = (uint8_t)i;
+        }
+    }
+};
+
+// Column of every live data PID (position on the table of formulas), built once for all the threads
+static const uint8_t *formula_positions(){
+
+    static const FormulaPositions positions;
+
+    return positions.position;
+}
+
+static inline int hex_value(char c){
+
+    if ((c >= '0') && (c <= '9')){
+
+        return c - '0';
+    }
+    c |= 0x20;
+    if ((c >= 'a') && (c <= 'f')){
+
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
+
+// Bytes of the data field, until the first character that is not hex
+static size_t parse_hex_scalar(const char *&p, const char *end, uint8_t *bytes){
+
+    size_t count = 0;
+
+    while ((p + 1 < end) && (count < 8)){
+
+        int high = hex_value(p[0]);
+        int low = hex_value(p[1]);
+        if ((high < 0) || (low < 0)){
+
+            break;
+        }
+        bytes[count++] = (uint8_t)((high << 4) | low);
+        p += 2;
+    }
+
+    return count;
+}
+
+#if defined(__SSE2__)
+// 16 hex characters to 8 bytes at once, false if one of them is not hex
+static inline bool parse_hex16(const char *p, uint8_t *bytes){
+
+    __m128i text = _mm_loadu_si128((const __m128i *)p);
+    __m128i lower = _mm_or_si128(text, _mm_set1_epi8(0x20));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(text, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(text, _mm_set1_epi8('9' + 1)));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    __m128i nibbles, pairs;
+
+    if (_mm_movemask_epi8(_mm_or_si128(digit, letter)) != 0xFFFF){
+
+        return false;
+    }
+    nibbles = _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(text, _mm_set1_epi8('0'))),
+                           _mm_andnot_si128(digit, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+    // Every 16 bit lane has the high nibble on the low byte
+    pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4), _mm_srli_epi16(nibbles, 8));
+    _mm_storel_epi64((__m128i *)bytes, _mm_packus_epi16(pairs, _mm_setzero_si128()));
+
+    return true;
+}
+#endif
+
+static inline bool is_line_end(const char *p, const char *end){
+
+    return (p == end) || (*p == '\n') || (*p == '\r') || (*p == ' ');
+}
+
+// One line: "(seconds.micro) interface ID#data"
+static void parse_line(const char *p, const char *end, bool simd,
+                       std::vector<Column> &columns, DecodeStats &stats){
+
+    const uint8_t *positions = formula_positions();
+    uint64_t seconds = 0, micro = 0;
+    uint32_t ID = 0;
+    size_t ID_chars = 0, num_bytes, digits = 0;
+    uint8_t bytes[8];
+
+    if ((p == end) || (*p++ != '(')){
+
+        stats.errors++;
+        return;
+    }
+    while ((p < end) && (*p >= '0') && (*p <= '9')){
+
+        seconds = seconds*10 + (uint64_t)(*p++ - '0');
+    }
+    if ((p < end) && (*p == '.')){
+
+        p++;
+        while ((p < end) && (*p >= '0') && (*p <= '9')){
+
+            if (digits++ < 6){
+
+                micro = micro*10 + (uint64_t)(*p - '0');
+            }
+            p++;
+        }
+    }
+    for (; digits < 6; digits++){
+
+        micro *= 10;
+    }
+    if ((p + 1 >= end) || (p[0] != ')') || (p[1] != ' ')){
+
+        stats.errors++;
+        return;
+    }
+    p = (const char *)memchr(p + 2, ' ', end - p - 2);
+    if (p == nullptr){
+
+        stats.errors++;
+        return;
+    }
+    for (p++; (p < end) && (*p != '#'); p++){
+
+        int value = hex_value(*p);
+        if (value < 0){
+
+            stats.errors++;
+            return;
+        }
+        ID = (ID << 4) | (uint32_t)value;
+        ID_chars++;
+    }
+    if ((p == end) || (ID_chars == 0)){
+
+        stats.errors++;
+        return;
+    }
+    p++;
+
+    // Only the responses of the ECUs (11 bit IDs) are decoded
+    if ((ID_chars > 3) || (ID < FIRST_ECU) || (ID >= FIRST_ECU + NUM_ECUS)){
+
+        stats.skipped++;
+        return;
+    }
+
+#if defined(__SSE2__)
+    if ((simd) && (p + FULL_FRAME_CHARS <= end) && (is_line_end(p + FULL_FRAME_CHARS, end)) && (parse_hex16(p, bytes))){
+
+        num_bytes = 8;
+    }else
+#endif
+    {
+        (void)simd;
+        num_bytes = parse_hex_scalar(p, end, bytes);
+    }
+
+    // Single frame of mode 01: length, 0x41, PID, A [, B]
+    if ((num_bytes < 4) || (bytes[1] != 0x41) || (positions[bytes[2]] == NO_FORMULA)){
+
+        stats.skipped++;
+        return;
+    }
+    const obd::PIDFormula &formula = obd::PID_formulas[positions[bytes[2]]];
+    size_t data_bytes = formula.two_bytes ? 2 : 1;
+    if ((bytes[0] < 2 + data_bytes) || (num_bytes < 3 + data_bytes)){
+
+        stats.skipped++;
+        return;
+    }
+
+    Column &column = columns[(ID - FIRST_ECU)*obd::NUM_PID_FORMULAS + positions[bytes[2]]];
+    column.time_us.push_back(seconds*1000000 + micro);
+    column.raw.push_back(formula.two_bytes ? (uint16_t)((bytes[3] << 8) | bytes[4]) : bytes[3]);
+    stats.records++;
+}
+
+void parse_block(const char *begin, const char *end, bool simd,
+                 std::vector<Column> &columns, DecodeStats &stats){
+
+    const char *p = begin;
+
+    while (p < end){
+
+        const char *line_end = (const char *)memchr(p, '\n', end - p);
+        if (line_end == nullptr){
+
+            line_end = end;
+        }
+        if (line_end > p){
+
+            stats.lines++;
+            parse_line(p, line_end, simd, columns, stats);
+        }
+        p = line_end + 1;
+    }
+}
+
+void decode_values(const uint16_t *raw, size_t count, double scale, double offset, double *values, bool simd){
+
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    if (simd){
+
+        __m256d scales = _mm256_set1_pd(scale);
+        __m256d offsets = _mm256_set1_pd(offset);
+
+        for (; i + 8 <= count; i += 8){
+
+            __m128i words = _mm_loadu_si128((const __m128i *)(raw + i));
+            __m256i integers = _mm256_cvtepu16_epi32(words);
+            __m256d low = _mm256_cvtepi32_pd(_mm256_castsi256_si128(integers));
+            __m256d high = _mm256_cvtepi32_pd(_mm256_extracti128_si256(integers, 1));
+            _mm256_storeu_pd(values + i, _mm256_add_pd(_mm256_mul_pd(low, scales), offsets));
+            _mm256_storeu_pd(values + i + 4, _mm256_add_pd(_mm256_mul_pd(high, scales), offsets));
+        }
+    }
+#elif defined(__SSE2__)
+    if (simd){
+
+        __m128d scales = _mm_set1_pd(scale);
+        __m128d offsets = _mm_set1_pd(offset);
+
+        for (; i + 4 <= count; i += 4){
+
+            __m128i words = _mm_loadl_epi64((const __m128i *)(raw + i));
+            __m128i integers = _mm_unpacklo_epi16(words, _mm_setzero_si128());
+            __m128d low = _mm_cvtepi32_pd(integers);
+            __m128d high = _mm_cvtepi32_pd(_mm_srli_si128(integers, 8));
+            _mm_storeu_pd(values + i, _mm_add_pd(_mm_mul_pd(low, scales), offsets));
+            _mm_storeu_pd(values + i + 2, _mm_add_pd(_mm_mul_pd(high, scales), offsets));
+        }
+    }
+#else
+    (void)simd;
+#endif
+
+    for (; i < count; i++){
+
+        values[i] = (double)raw[i]*scale + offset;
+    }
+}
+
+static std::vector<Column> empty_columns(){
+
+    std::vector<Column> columns(NUM_COLUMNS);
+
+    for (size_t c = 0; c < NUM_COLUMNS; c++){
+
+        columns[c].ECU_ID = (uint16_t)(FIRST_ECU + c/obd::NUM_PID_FORMULAS);
+        columns[c].formula = &obd::PID_formulas[c % obd::NUM_PID_FORMULAS];
+    }
+
+    return columns;
+}
+
+// Blocks parsed and decoded on the pool, then every column joined in the order of the blocks
+void decode_capture(const char *data, size_t length, WorkStealingPool &pool, const DecodeOptions &options,
+                    Capture &capture){
+
+    std::vector<size_t> starts = split_blocks(data, length, options.block_size);
+    size_t num_blocks = starts.size() - 1;
+    std::vector<std::vector<Column>> blocks(num_blocks);
+    std::vector<DecodeStats> block_stats(num_blocks);
+    std::vector<Column> joined = empty_columns();
+
+    pool.run(num_blocks, [&](size_t b, unsigned){
+
+        blocks[b] = empty_columns();
+        parse_block(data + starts[b], data + starts[b+1], options.simd, blocks[b], block_stats[b]);
+        for (Column &column : blocks[b]){
+
+            column.values.resize(column.raw.size());
+            decode_values(column.raw.data(), column.raw.size(), column.formula->scale, column.formula->offset,
+                          column.values.data(), options.simd);
+        }
+    });
+
+    pool.run(NUM_COLUMNS, [&](size_t c, unsigned){
+
+        Column &column = joined[c];
+        size_t records = 0;
+
+        for (const std::vector<Column> &block : blocks){
+
+            records += block[c].raw.size();
+        }
+        column.time_us.reserve(records);
+        column.raw.reserve(records);
+        column.values.reserve(records);
+        for (std::vector<Column> &block : blocks){
+
+            column.time_us.insert(column.time_us.end(), block[c].time_us.begin(), block[c].time_us.end());
+            column.raw.insert(column.raw.end(), block[c].raw.begin(), block[c].raw.end());
+            column.values.insert(column.values.end(), block[c].values.begin(), block[c].values.end());
+            block[c] = Column();
+        }
+    });
+
+    capture = Capture();
+    capture.blocks = num_blocks;
+    for (const DecodeStats &stats : block_stats){
+
+        capture.stats.lines += stats.lines;
+        capture.stats.records += stats.records;
+        capture.stats.skipped += stats.skipped;
+        capture.stats.errors += stats.errors;
+    }
+    for (Column &column : joined){
+
+        if (!column.raw.empty()){
+
+            capture.columns.push_back(std::move(column));
+        }
+    }
+}
+
+template <typename T> static bool write_value(FILE *file, const T &value){
+
+    return fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+static bool write_text(FILE *file, const char *text){
+
+    char field[8] = {0};
+
+    memcpy(field, text, strnlen(text, sizeof(field)));
+    return fwrite(field, sizeof(field), 1, file) == 1;
+}
+
+bool write_columnar(const std::string &path, const Capture &capture){
+
+    FILE *file = fopen(path.c_str(), "wb");
+    uint64_t offset = 24 + 48*(uint64_t)capture.columns.size();
+    uint64_t records = 0;
+    bool written;
+
+    if (file == nullptr){
+
+        perror(path.c_str());
+        return false;
+    }
+    for (const Column &column : capture.columns){
+
+        records += column.values.size();
+    }
+
+    written = write_value(file, COLUMNAR_MAGIC) && write_value(file, COLUMNAR_VERSION)
+              && write_value(file, (uint32_t)capture.columns.size()) && write_value(file, (uint32_t)0)
+              && write_value(file, records);
+    for (const Column &column : capture.columns){
+
+        uint64_t count = column.values.size();
+
+        written = written && write_value(file, column.ECU_ID) && write_value(file, column.formula->PID)
+                  && write_value(file, (uint8_t)column.formula->two_bytes) && write_value(file, (uint32_t)0)
+                  && write_value(file, count) && write_value(file, offset) && write_value(file, offset + 8*count)
+                  && write_text(file, column.formula->name) && write_text(file, column.formula->unit);
+        offset += 16*count;
+    }
+    for (const Column &column : capture.columns){
+
+        written = written && (fwrite(column.time_us.data(), 8, column.time_us.size(), file) == column.time_us.size())
+                  && (fwrite(column.values.data(), 8, column.values.size(), file) == column.values.size());
+    }
+
+    return (fclose(file) == 0) && written;
+}
+
+// The columns of the file (the raw values are not in it)
+bool read_columnar(const std::string &path, Capture &capture){
+
+    MappedFile file;
+    const char *data;
+    uint32_t magic, version, num_columns;
+
+    if (!file.open(path) || (file.size() < 24)){
+
+        return false;
+    }
+    data = file.data();
+    memcpy(&magic, data, 4);
+    memcpy(&version, data + 4, 4);
+    memcpy(&num_columns, data + 8, 4);
+    if ((magic != COLUMNAR_MAGIC) || (version != COLUMNAR_VERSION) || (24 + 48*(uint64_t)num_columns > file.size())){
+
+        return false;
+    }
+
+    capture = Capture();
+    for (uint32_t c = 0; c < num_columns; c++){
+
+        const char *entry = data + 24 + 48*(size_t)c;
+        uint64_t count, times, values;
+        Column column;
+
+        memcpy(&column.ECU_ID, entry, 2);
+        memcpy(&count, entry + 8, 8);
+        memcpy(&times, entry + 16, 8);
+        memcpy(&values, entry + 24, 8);
+        column.formula = obd::find_formula((uint8_t)entry[2]);
+        if ((column.formula == nullptr) || (times + 8*count > file.size()) || (values + 8*count > file.size())){
+
+            return false;
+        }
+        column.time_us.resize(count);
+        column.values.resize(count);
+        memcpy(column.time_us.data(), data + times, 8*count);
+        memcpy(column.values.data(), data + values, 8*count);
+        capture.stats.records += count;
+        capture.columns.push_back(std::move(column));
+    }
+
+    return true;
+}
+
+} // namespace decoder
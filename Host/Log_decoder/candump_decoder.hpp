@@ -0,0 +1,108 @@
+/*
+ * candump_decoder.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      Decoder of the OBD responses of a bus capture (candump -l format:
+ *      "(1697712000.123456) can0 7E8#04410C1AF8000000"). The capture is split in blocks of
+ *      whole lines that are parsed on a work-stealing pool. Every block keeps a column for
+ *      every ECU and live data PID (time and raw value), and the values are decoded with the
+ *      formulas of decode_CANdata over the whole column (SSE2/AVX2 when the compiler has them).
+ *      Only the single frame responses of mode 01 of the ECUs 7E8-7EF are taken; the rest
+ *      of the frames (requests, other IDs, negative responses) are counted as skipped.
+ *
+ *      Columnar file (.obdc, little endian):
+ *          magic "OBDC", version, number of columns, 0 (u32), records (u64)
+ *          for each column: ECU (u16), PID, flags (u8), 0 (u32), records, offset of the times,
+ *          offset of the values (u64), short name, unit (char[8])
+ *          the times (u64, us) and the values (f64) of every column, 8 bytes aligned
+ */
+
+#ifndef CANDUMP_DECODER_HPP_
+#define CANDUMP_DECODER_HPP_
+
+// C++ libraries
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "obd_pids.hpp"
+#include "work_pool.hpp"
+
+namespace decoder {
+
+static const uint32_t COLUMNAR_MAGIC = 0x4344424FUL;        // "OBDC"
+static const uint32_t COLUMNAR_VERSION = 1;
+static const uint16_t FIRST_ECU = 0x7E8;
+static const size_t NUM_ECUS = 8;                           // 7E8-7EF
+static const size_t NUM_COLUMNS = NUM_ECUS*obd::NUM_PID_FORMULAS;
+
+struct Column{
+
+    uint16_t ECU_ID = 0;
+    const obd::PIDFormula *formula = nullptr;
+    std::vector<uint64_t> time_us;
+    std::vector<uint16_t> raw;          // A or 256*A + B
+    std::vector<double> values;
+};
+
+struct DecodeStats{
+
+    uint64_t lines = 0;
+    uint64_t records = 0;
+    uint64_t skipped = 0;               // Frames that are not live data responses
+    uint64_t errors = 0;                // Lines that are not candump frames
+};
+
+struct DecodeOptions{
+
+    size_t block_size = 1 << 20;        // Bytes of the capture of every task
+    bool simd = true;                   // Vector hex parsing and decoding
+};
+
+struct Capture{
+
+    std::vector<Column> columns;        // Only the ones with records, by ECU and PID
+    DecodeStats stats;
+    size_t blocks = 0;
+};
+
+class MappedFile{
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+    const char *data() const { return address; }
+    size_t size() const { return length; }
+
+private:
+    const char *address = nullptr;
+    size_t length = 0;
+};
+
+// Start of the blocks: lines are never split, the end of one block is the start of the next
+std::vector<size_t> split_blocks(const char *data, size_t length, size_t block_size);
+// Lines of [begin, end) in the columns (NUM_COLUMNS, times and raw values only)
+void parse_block(const char *begin, const char *end, bool simd,
+                 std::vector<Column> &columns, DecodeStats &stats);
+// values[i] = scale*raw[i] + offset
+void decode_values(const uint16_t *raw, size_t count, double scale, double offset, double *values, bool simd);
+const char *simd_name();
+
+void decode_capture(const char *data, size_t length, WorkStealingPool &pool, const DecodeOptions &options,
+                    Capture &capture);
+
+bool write_columnar(const std::string &path, const Capture &capture);
+bool read_columnar(const std::string &path, Capture &capture);
+
+} // namespace decoder
+
+#endif /* CANDUMP_DECODER_HPP_ */
@@ -0,0 +1,101 @@
+/*
+ * log_decoder.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Command line decoder of bus captures (candump -l) to the columnar format. Without the
+ *      number of threads it takes one for every core.
+ *
+ *      Build and run (from this folder):
+ *          c++ -std=c++17 -O2 -march=native -Wall -pthread -I../Log_reader -o log_decoder log_decoder.cpp candump_decoder.cpp
+ *          ./log_decoder capture.log decode capture.obdc [threads]
+ *          ./log_decoder capture.obdc info
+ */
+
+// C++ libraries
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+// Programmer libraries
+#include "candump_decoder.hpp"
+
+static void print_usage(const char *program){
+
+    fprintf(stderr, "Usage: %s capture.log decode output.obdc [threads]\n"
+                    "       %s file.obdc info\n", program, program);
+}
+
+static void print_columns(const decoder::Capture &capture){
+
+    for (const decoder::Column &column : capture.columns){
+
+        printf("  %03X %-6s PID 0x%02X: %10zu records", column.ECU_ID, column.formula->name,
+               column.formula->PID, column.values.size());
+        if (!column.values.empty()){
+
+            printf(", %.6f-%.6f s, last %g %s", column.time_us.front()/1e6, column.time_us.back()/1e6,
+                   column.values.back(), column.formula->unit);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char *argv[]){
+
+    std::string command = (argc > 2) ? argv[2] : "";
+    unsigned threads = std::thread::hardware_concurrency();
+    decoder::MappedFile input;
+    decoder::Capture capture;
+    decoder::DecodeOptions options;
+
+    if ((command == "info") && (argc == 3)){
+
+        if (!decoder::read_columnar(argv[1], capture)){
+
+            fprintf(stderr, "%s is not a columnar file\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+        printf("%zu columns, %llu records\n", capture.columns.size(), (unsigned long long)capture.stats.records);
+        print_columns(capture);
+        return EXIT_SUCCESS;
+    }
+    if ((command != "decode") || (argc < 4)){
+
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 4){
+
+        threads = (unsigned)strtoul(argv[4], nullptr, 0);
+    }
+    if (!input.open(argv[1])){
+
+        return EXIT_FAILURE;
+    }
+
+    decoder::WorkStealingPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+    decoder::decode_capture(input.data(), input.size(), pool, options, capture);
+    double decode_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!decoder::write_columnar(argv[3], capture)){
+
+        return EXIT_FAILURE;
+    }
+
+    printf("%llu lines: %llu records, %llu skipped, %llu errors\n", (unsigned long long)capture.stats.lines,
+           (unsigned long long)capture.stats.records, (unsigned long long)capture.stats.skipped,
+           (unsigned long long)capture.stats.errors);
+    print_columns(capture);
+    printf("%zu blocks on %zu threads (%s): %.1f ms, %.2f M lines/s\n", capture.blocks, pool.size(),
+           decoder::simd_name(), decode_s*1000, capture.stats.lines/decode_s/1e6);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,367 @@
+/*
+ * log_decoder_bench.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host test and benchmark of the capture decoder. A capture like the one of the bus when
+ *      the device polls the live data is generated: requests to 7DF, responses of 7E8 and 7E9
+ *      (padded and not padded, upper and lower case), negative responses, other frames of the
+ *      car and some broken lines. The decoded columns are compared with a line by line parse
+ *      and the formulas of decode_CANdata (Software/CAN_device.c), and the columnar file is
+ *      read back. Then the decode is timed with 1, 2, 4... threads up to the number of cores,
+ *      and the scalar and vector kernels alone.
+ *
+ *      Build and run (from this folder):
+ *          c++ -std=c++17 -O2 -march=native -Wall -pthread -I../Log_reader -o log_decoder_bench log_decoder_bench.cpp candump_decoder.cpp
+ *          ./log_decoder_bench /tmp/capture.log [frames]
+ */
+
+// C++ libraries
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Programmer libraries
+#include "candump_decoder.hpp"
+
+#define RUNS 3
+#define BROKEN_LINE_EVERY 10007
+#define KERNEL_VALUES (1 << 20)
+
+static uint32_t state = 0x10C2026;
+
+
+static uint32_t next_random(void){
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state;
+}
+
+static double elapsed_s(std::chrono::steady_clock::time_point start){
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// decode_CANdata of the firmware, by position on pids_liveData
+static double firmware_decode(uint8_t posPID, double dataA, double dataB){
+
+    switch(posPID){
+    case 0: case 10:
+        return dataA*100/255;
+    case 1: case 8:
+        return dataA-40;
+    case 2: case 3:
+        return (dataA-128)*100/128;
+    case 4:
+        return ((dataA*256)+dataB)/4;
+    case 5: case 6:
+        return dataA;
+    case 7:
+        return (dataA/2)-64;
+    case 9:
+        return ((dataA*256)+dataB)/100;
+    case 11:
+        return (dataA*256)+dataB;
+    default:
+        return 0;
+    }
+}
+
+// Polls of the live data every 10 ms, the way the device does it
+static bool generate_capture(const char *path, uint64_t frames){
+
+    FILE *file = fopen(path, "w");
+    uint64_t time_us = 1697712000ULL*1000000;
+    uint64_t written = 0;
+    size_t next_pid = 0;
+
+    if (file == nullptr){
+
+        perror(path);
+        return false;
+    }
+
+    while (written < frames){
+
+        const obd::PIDFormula &formula = obd::PID_formulas[next_pid];
+        unsigned length = formula.two_bytes ? 4 : 3;
+        uint32_t noise = next_random();
+
+        fprintf(file, "(%llu.%06llu) can0 7DF#0201%02X0000000000\n", (unsigned long long)(time_us/1000000),
+                (unsigned long long)(time_us % 1000000), formula.PID);
+        time_us += 200 + noise % 300;
+
+        for (unsigned ECU = 0x7E8; ECU <= 0x7E9; ECU++){
+
+            uint8_t A = next_random() & 0xFF, B = next_random() & 0xFF;
+            const char *hex = ((noise >> 12) % 7 == 0) ? "%02x" : "%02X";
+            char data[40];
+            int used;
+
+            if ((ECU == 0x7E9) && (formula.PID == 0x1F)){
+
+                // The second ECU does not have this PID
+                used = snprintf(data, sizeof(data), "037F0112");
+            }else {
+
+                used = snprintf(data, sizeof(data), "%02X41%02X", length, formula.PID);
+                used += snprintf(data + used, sizeof(data) - used, hex, A);
+                if (formula.two_bytes){
+
+                    used += snprintf(data + used, sizeof(data) - used, hex, B);
+                }
+            }
+            // Most ECUs pad to 8 bytes, some of them do not
+            if ((noise >> 8) % 5 != 0){
+
+                while (used < 16){
+
+                    data[used++] = ((noise >> 20) & 1) ? 'A' : '0';
+                    data[used++] = ((noise >> 20) & 1) ? 'A' : '0';
+                }
+                data[used] = '\0';
+            }
+            fprintf(file, "(%llu.%06llu) can0 %03X#%s\n", (unsigned long long)(time_us/1000000),
+                    (unsigned long long)(time_us % 1000000), ECU, data);
+            time_us += 300 + next_random() % 400;
+            written++;
+        }
+        if ((noise % 50) == 0){
+
+            fprintf(file, "(%llu.%06llu) can0 3A0#%08X%08X\n", (unsigned long long)(time_us/1000000),
+                    (unsigned long long)(time_us % 1000000), next_random(), next_random());
+        }
+        if ((written % BROKEN_LINE_EVERY) < 2){
+
+            fprintf(file, "(%llu.%06llu) can0 7E8#0441\n(broken\n", (unsigned long long)(time_us/1000000),
+                    (unsigned long long)(time_us % 1000000));
+        }
+        if (++next_pid == obd::NUM_PID_FORMULAS){
+
+            next_pid = 0;
+            time_us += 10000;
+        }
+    }
+
+    return fclose(file) == 0;
+}
+
+// Line by line with sscanf: the reference of the decoder
+static int check_capture(const char *path, const decoder::Capture &capture){
+
+    FILE *file = fopen(path, "r");
+    char line[256];
+    std::vector<size_t> next(capture.columns.size(), 0);
+    uint64_t records = 0;
+    int errors = 0;
+
+    if (file == nullptr){
+
+        perror(path);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), file) != nullptr){
+
+        unsigned long long seconds, micro;
+        unsigned ID, bytes[8] = {0};
+        char data[64];
+        int count = 0;
+
+        if ((sscanf(line, "(%llu.%llu) %*s %x#%63s", &seconds, &micro, &ID, data) != 4) || (ID < 0x7E8) || (ID > 0x7EF)){
+
+            continue;
+        }
+        while ((count < 8) && (data[2*count] != '\0') && (sscanf(data + 2*count, "%2x", &bytes[count]) == 1)){
+
+            count++;
+        }
+        const obd::PIDFormula *formula = obd::find_formula((uint8_t)bytes[2]);
+        if ((count < 4) || (bytes[1] != 0x41) || (formula == nullptr) || (formula->two_bytes && (count < 5))
+                || (bytes[0] < (formula->two_bytes ? 4u : 3u))){
+
+            continue;
+        }
+
+        size_t c = 0;
+        while ((c < capture.columns.size()) && ((capture.columns[c].ECU_ID != ID) || (capture.columns[c].formula != formula))){
+
+            c++;
+        }
+        double expected = firmware_decode((uint8_t)(formula - obd::PID_formulas), bytes[3], bytes[4]);
+        if ((c == capture.columns.size()) || (next[c] >= capture.columns[c].values.size())
+                || (capture.columns[c].time_us[next[c]] != seconds*1000000 + micro)
+                || (std::fabs(capture.columns[c].values[next[c]] - expected) > 1e-9)){
+
+            if (errors++ < 5){
+
+                fprintf(stderr, "Record %llu (%s:%03X) is not the same\n", (unsigned long long)records, formula->name, ID);
+            }
+        }else {
+
+            next[c]++;
+        }
+        records++;
+    }
+    fclose(file);
+
+    if (records != capture.stats.records){
+
+        fprintf(stderr, "%llu records, %llu expected\n", (unsigned long long)capture.stats.records,
+                (unsigned long long)records);
+        errors++;
+    }
+
+    return errors;
+}
+
+static bool same_columns(const decoder::Capture &a, const decoder::Capture &b){
+
+    if (a.columns.size() != b.columns.size()){
+
+        return false;
+    }
+    for (size_t c = 0; c < a.columns.size(); c++){
+
+        if ((a.columns[c].ECU_ID != b.columns[c].ECU_ID) || (a.columns[c].formula != b.columns[c].formula)
+                || (a.columns[c].time_us != b.columns[c].time_us) || (a.columns[c].values != b.columns[c].values)){
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Best of the runs (the first one also takes the capture to the page cache)
+static double time_decode(const decoder::MappedFile &input, unsigned threads, bool simd, decoder::Capture &capture,
+                          uint64_t &steals){
+
+    decoder::WorkStealingPool pool(threads);
+    decoder::DecodeOptions options;
+    double best = 1e9;
+
+    options.simd = simd;
+    for (int run = 0; run < RUNS; run++){
+
+        auto start = std::chrono::steady_clock::now();
+        decoder::decode_capture(input.data(), input.size(), pool, options, capture);
+        best = std::min(best, elapsed_s(start));
+    }
+    steals = 0;
+    for (const decoder::PoolStats &stats : pool.last_stats()){
+
+        steals += stats.steals;
+    }
+
+    return best;
+}
+
+static void time_kernels(void){
+
+    std::vector<uint16_t> raw(KERNEL_VALUES);
+    std::vector<double> scalar(KERNEL_VALUES), vector(KERNEL_VALUES);
+    double scalar_s = 1e9, vector_s = 1e9;
+
+    for (uint16_t &value : raw){
+
+        value = next_random() & 0xFFFF;
+    }
+    for (int run = 0; run < RUNS*3; run++){
+
+        auto start = std::chrono::steady_clock::now();
+        decoder::decode_values(raw.data(), raw.size(), 1.0/4, 0, scalar.data(), false);
+        scalar_s = std::min(scalar_s, elapsed_s(start));
+        start = std::chrono::steady_clock::now();
+        decoder::decode_values(raw.data(), raw.size(), 1.0/4, 0, vector.data(), true);
+        vector_s = std::min(vector_s, elapsed_s(start));
+    }
+    printf("Kernel: scalar %.0f M values/s, %s %.0f M values/s%s\n", KERNEL_VALUES/scalar_s/1e6, decoder::simd_name(),
+           KERNEL_VALUES/vector_s/1e6, (scalar == vector) ? "" : " (NOT THE SAME)");
+}
+
+int main(int argc, char *argv[]){
+
+    uint64_t frames = (argc > 2) ? strtoull(argv[2], nullptr, 0) : 4000000;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::string columnar;
+    decoder::MappedFile input;
+    decoder::Capture capture, scalar_capture, loaded;
+    uint64_t steals;
+    double single_s = 0;
+    int errors = 0;
+
+    if (argc < 2){
+
+        fprintf(stderr, "Usage: %s capture.log [frames]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    columnar = std::string(argv[1]) + ".obdc";
+    if ((!generate_capture(argv[1], frames)) || (!input.open(argv[1]))){
+
+        return EXIT_FAILURE;
+    }
+
+    // The decode of small blocks (a lot of steals) has to be the same
+    {
+        decoder::WorkStealingPool pool(4);
+        decoder::DecodeOptions options;
+        options.block_size = 4096 + 17;
+        decoder::decode_capture(input.data(), input.size(), pool, options, capture);
+    }
+    printf("%llu lines: %llu records, %llu skipped, %llu errors in %zu blocks\n",
+           (unsigned long long)capture.stats.lines, (unsigned long long)capture.stats.records,
+           (unsigned long long)capture.stats.skipped, (unsigned long long)capture.stats.errors, capture.blocks);
+    errors += check_capture(argv[1], capture);
+    if ((!decoder::write_columnar(columnar, capture)) || (!decoder::read_columnar(columnar, loaded))
+            || (!same_columns(capture, loaded))){
+
+        fprintf(stderr, "The columnar file is not the same\n");
+        errors++;
+    }
+
+    time_decode(input, 1, false, scalar_capture, steals);
+    printf("Capture: %.1f MB, %s\n", input.size()/1048576.0, decoder::simd_name());
+    for (unsigned threads = 1; ; threads = std::min(threads*2, cores)){
+
+        double best = time_decode(input, threads, true, capture, steals);
+        double rate = capture.stats.records/best;
+        if (threads == 1){
+
+            single_s = best;
+        }
+        printf("%2u threads: %7.1f ms, %6.2f M records/s, %6.2f M records/s per core, %.2fx, %llu steals\n",
+               threads, best*1000, rate/1e6, rate/1e6/threads, single_s/best, (unsigned long long)steals);
+        if (threads == cores){
+
+            break;
+        }
+    }
+    {
+        double scalar_s = time_decode(input, 1, false, scalar_capture, steals);
+        printf("1 thread scalar: %.1f ms, %.2f M records/s\n", scalar_s*1000, scalar_capture.stats.records/scalar_s/1e6);
+    }
+    if (!same_columns(capture, scalar_capture)){
+
+        fprintf(stderr, "The scalar decode is not the same\n");
+        errors++;
+    }
+    time_kernels();
+
+    printf("%s\n", (errors == 0) ? "Decoder correct" : "Decoder with errors");
+
+    return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,190 @@
+/*
+ * work_pool.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Work-stealing pool. The tasks of a run are numbered: every worker starts with a
+ *      contiguous part of them (the blocks of the capture that are together) and takes them
+ *      from the front of its queue. A worker without tasks steals from the back of the queue
+ *      of another one, so the blocks that are slower to decode do not leave cores waiting.
+ *      The threads are kept between runs.
+ */
+
+#ifndef WORK_POOL_HPP_
+#define WORK_POOL_HPP_
+
+// C++ libraries
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace decoder {
+
+struct PoolStats{
+
+    uint64_t tasks = 0;
+    uint64_t steals = 0;
+};
+
+class WorkStealingPool{
+
+public:
+    explicit WorkStealingPool(unsigned num_threads){
+
+        num_threads = (num_threads == 0) ? 1 : num_threads;
+        for (unsigned i = 0; i < num_threads; i++){
+
+            queues.emplace_back(new WorkerQueue);
+        }
+        stats.resize(num_threads);
+        for (unsigned i = 0; i < num_threads; i++){
+
+            threads.emplace_back(&WorkStealingPool::worker, this, i);
+        }
+    }
+
+    ~WorkStealingPool(){
+
+        {
+            std::lock_guard<std::mutex> lock(run_mutex);
+            stopping = true;
+        }
+        run_start.notify_all();
+        for (std::thread &thread : threads){
+
+            thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    size_t size() const { return threads.size(); }
+
+    // Run task(0) ... task(num_tasks - 1) on the workers and wait for all of them
+    void run(size_t num_tasks, const std::function<void(size_t task, unsigned worker)> &task){
+
+        size_t per_worker = (num_tasks + queues.size() - 1)/queues.size();
+
+        if (num_tasks == 0){
+
+            return;
+        }
+        for (size_t w = 0; w < queues.size(); w++){
+
+            std::lock_guard<std::mutex> lock(queues[w]->mutex);
+            for (size_t t = w*per_worker; (t < (w + 1)*per_worker) && (t < num_tasks); t++){
+
+                queues[w]->tasks.push_back(t);
+            }
+        }
+        for (PoolStats &worker_stats : stats){
+
+            worker_stats = PoolStats();
+        }
+
+        std::unique_lock<std::mutex> lock(run_mutex);
+        current = &task;
+        working = threads.size();
+        generation++;
+        run_start.notify_all();
+        run_end.wait(lock, [this]{ return working == 0; });
+        current = nullptr;
+    }
+
+    // Tasks and steals of every worker on the last run
+    const std::vector<PoolStats> &last_stats() const { return stats; }
+
+private:
+    struct WorkerQueue{
+
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    bool next_task(unsigned worker, size_t &task){
+
+        {
+            std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+            if (!queues[worker]->tasks.empty()){
+
+                task = queues[worker]->tasks.front();
+                queues[worker]->tasks.pop_front();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); i++){
+
+            WorkerQueue &victim = *queues[(worker + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()){
+
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                stats[worker].steals++;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void worker(unsigned index){
+
+        uint64_t seen = 0;
+
+        for (;;){
+
+            const std::function<void(size_t, unsigned)> *task_function;
+            {
+                std::unique_lock<std::mutex> lock(run_mutex);
+                run_start.wait(lock, [&]{ return stopping || (generation != seen); });
+                if (stopping){
+
+                    return;
+                }
+                seen = generation;
+                task_function = current;
+            }
+
+            size_t task;
+            while (next_task(index, task)){
+
+                (*task_function)(task, index);
+                stats[index].tasks++;
+            }
+
+            std::lock_guard<std::mutex> lock(run_mutex);
+            if (--working == 0){
+
+                run_end.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+    std::vector<PoolStats> stats;
+    std::mutex run_mutex;
+    std::condition_variable run_start;
+    std::condition_variable run_end;
+    const std::function<void(size_t, unsigned)> *current = nullptr;
+    uint64_t generation = 0;
+    size_t working = 0;
+    bool stopping = false;
+};
+
+} // namespace decoder
+
+#endif /* WORK_POOL_HPP_ */
@@ -0,0 +1,437 @@
+/*
+ * live_log.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Index file (<log>.idx, little endian like the log):
+ *          magic, version (u32), size of the log (u64), modification time of the log (i64)
+ *          stats: blocks, valid, empty, bad, records, dropped, sequence gaps (u64), time sorted (u8)
+ *          number of valid blocks (u32) and for each one: block, first time (u32)
+ *          number of channels (u32) and for each one: key, number of runs (u32) and the runs
+ *          (first block, blocks, first time, last time, records: u32)
+ */
+
+// C libraries
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C++ libraries
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// Programmer libraries
+#include "live_log.hpp"
+
+namespace live_log {
+
+static_assert(sizeof(tLiveLogHeader) == 16, "Header of the firmware");
+static_assert(sizeof(tLiveLogRecord) == 12, "Record of the firmware");
+static_assert(sizeof(tLiveLogBlock) == LIVE_LOG_BLOCK_SIZE, "Block of the firmware");
+
+static const size_t RECORDS_PER_BLOCK = LIVE_LOG_RECORDS_PER_BLOCK;
+
+
+LiveLog::~LiveLog(){
+
+    close();
+}
+
+// CRC-16/CCITT of liveLog_CRC16 (Software/Live_logger.c) with a table
+uint16_t LiveLog::crc16(const uint8_t *data, size_t length){
+
+    static uint16_t table[256];
+    static bool table_ready = false;
+    uint16_t crc = 0xFFFF;
+
+    if (!table_ready){
+
+        for (int i = 0; i < 256; i++){
+
+            uint16_t value = (uint16_t)(i << 8);
+            for (int bit = 0; bit < 8; bit++){
+
+                value = (value & 0x8000) ? (uint16_t)((value << 1) ^ 0x1021) : (uint16_t)(value << 1);
+            }
+            table[i] = value;
+        }
+        table_ready = true;
+    }
+
+    for (size_t i = 0; i < length; i++){
+
+        crc = (uint16_t)((crc << 8) ^ table[((crc >> 8) ^ data[i]) & 0xFF]);
+    }
+
+    return crc;
+}
+
+bool LiveLog::is_valid_block(const tLiveLogBlock *block){
+
+    const tLiveLogHeader &header = block->log.header;
+
+    return (header.magic == LIVE_LOG_MAGIC) && (header.version == LIVE_LOG_VERSION)
+           && (header.record_size == sizeof(tLiveLogRecord)) && (header.numRecords <= RECORDS_PER_BLOCK)
+           && (crc16((const uint8_t *)block->log.records, header.numRecords*sizeof(tLiveLogRecord)) == header.checksum);
+}
+
+const tLiveLogBlock *LiveLog::block(uint32_t number) const{
+
+    return (const tLiveLogBlock *)(data + (size_t)number*LIVE_LOG_BLOCK_SIZE);
+}
+
+bool LiveLog::open(const std::string &log_path, bool save){
+
+    struct stat info;
+
+    close();
+    path = log_path;
+    idx_path = log_path + ".idx";
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if ((fd < 0) || (fstat(fd, &info) != 0)){
+
+        perror(path.c_str());
+        close();
+        return false;
+    }
+    length = (size_t)info.st_size;
+    modification = (int64_t)info.st_mtime;
+    if (length >= LIVE_LOG_BLOCK_SIZE){
+
+        data = (const uint8_t *)mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED){
+
+            perror(path.c_str());
+            data = nullptr;
+            close();
+            return false;
+        }
+    }
+
+    if (load_index()){
+
+        return true;
+    }
+    if (!build_index()){
+
+        return false;
+    }
+
+    // Without the index file (read only folder) it still works
+    if (save){
+
+        save_index();
+    }
+
+    return true;
+}
+
+void LiveLog::close(){
+
+    if (data != nullptr){
+
+        munmap((void *)data, length);
+        data = nullptr;
+    }
+    if (fd >= 0){
+
+        ::close(fd);
+        fd = -1;
+    }
+    length = 0;
+    index_from_file = false;
+    log_stats = LogStats();
+    runs.clear();
+    valid_blocks.clear();
+    valid_first_times.clear();
+}
+
+// One pass over the log: the blocks are read in order, so the speed is the one of the disk
+bool LiveLog::build_index(){
+
+    uint32_t num_blocks = (uint32_t)(length / LIVE_LOG_BLOCK_SIZE);
+    uint32_t last_time = 0, last_sequence = 0;
+    bool first_block = true, first_record = true;
+    uint32_t cached_key = 0xFFFFFFFF;
+    std::vector<BlockRun> *cached_runs = nullptr;
+
+    log_stats = LogStats();
+    runs.clear();
+    valid_blocks.clear();
+    valid_first_times.clear();
+    index_from_file = false;
+    log_stats.blocks = num_blocks;
+    if (data != nullptr){
+
+        madvise((void *)data, length, MADV_SEQUENTIAL);
+    }
+
+    for (uint32_t b = 0; b < num_blocks; b++){
+
+        const tLiveLogBlock *current = block(b);
+        const tLiveLogHeader &header = current->log.header;
+
+        if (!is_valid_block(current)){
+
+            if ((header.magic == 0) && (header.numRecords == 0)){
+
+                log_stats.empty_blocks++;
+            }else {
+
+                log_stats.bad_blocks++;
+            }
+            continue;
+        }
+        log_stats.valid_blocks++;
+        log_stats.records += header.numRecords;
+        log_stats.dropped += header.dropped;
+        if ((!first_block) && (header.sequence != last_sequence + 1)){
+
+            log_stats.sequence_gaps++;
+        }
+        last_sequence = header.sequence;
+        first_block = false;
+
+        if (header.numRecords == 0){
+
+            continue;
+        }
+        valid_blocks.push_back(b);
+        valid_first_times.push_back(current->log.records[0].time_ms);
+
+        for (uint16_t r = 0; r < header.numRecords; r++){
+
+            const tLiveLogRecord &record = current->log.records[r];
+            uint32_t key = channel_key(record.ECU_ID, record.PID);
+
+            if ((!first_record) && (record.time_ms < last_time)){
+
+                log_stats.time_sorted = false;
+            }
+            last_time = record.time_ms;
+            first_record = false;
+
+            if (key != cached_key){
+
+                cached_key = key;
+                cached_runs = &runs[key];
+            }
+            if ((!cached_runs->empty()) && (cached_runs->back().first_block + cached_runs->back().blocks - 1 == b)){
+
+                cached_runs->back().last_time = record.time_ms;
+                cached_runs->back().records++;
+            }else if ((!cached_runs->empty()) && (cached_runs->back().first_block + cached_runs->back().blocks == b)){
+
+                // The previous block had the channel: the same run
+                cached_runs->back().blocks++;
+                cached_runs->back().last_time = record.time_ms;
+                cached_runs->back().records++;
+            }else {
+
+                cached_runs->push_back(BlockRun{b, 1, record.time_ms, record.time_ms, 1});
+            }
+        }
+    }
+
+    return true;
+}
+
+template <typename T> static bool write_value(FILE *file, const T &value){
+
+    return fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T> static bool read_value(FILE *file, T &value){
+
+    return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+bool LiveLog::save_index() const{
+
+    FILE *file = fopen(idx_path.c_str(), "wb");
+    bool written;
+
+    if (file == nullptr){
+
+        return false;
+    }
+
+    written = write_value(file, INDEX_MAGIC) && write_value(file, INDEX_VERSION)
+              && write_value(file, (uint64_t)length) && write_value(file, modification)
+              && write_value(file, log_stats.blocks) && write_value(file, log_stats.valid_blocks)
+              && write_value(file, log_stats.empty_blocks) && write_value(file, log_stats.bad_blocks)
+              && write_value(file, log_stats.records) && write_value(file, log_stats.dropped)
+              && write_value(file, log_stats.sequence_gaps) && write_value(file, (uint8_t)log_stats.time_sorted)
+              && write_value(file, (uint32_t)valid_blocks.size());
+    for (size_t i = 0; (written) && (i < valid_blocks.size()); i++){
+
+        written = write_value(file, valid_blocks[i]) && write_value(file, valid_first_times[i]);
+    }
+    written = written && write_value(file, (uint32_t)runs.size());
+    for (auto it = runs.begin(); (written) && (it != runs.end()); ++it){
+
+        written = write_value(file, it->first) && write_value(file, (uint32_t)it->second.size())
+                  && (fwrite(it->second.data(), sizeof(BlockRun), it->second.size(), file) == it->second.size());
+    }
+
+    return (fclose(file) == 0) && written;
+}
+
+// The index is only taken if it is of this log (size and modification time)
+bool LiveLog::load_index(){
+
+    FILE *file = fopen(idx_path.c_str(), "rb");
+    uint32_t magic = 0, version = 0, count = 0, num_channels = 0, key, num_runs;
+    uint64_t size = 0;
+    int64_t time = 0;
+    uint8_t sorted = 0;
+    bool loaded;
+
+    if (file == nullptr){
+
+        return false;
+    }
+
+    loaded = read_value(file, magic) && (magic == INDEX_MAGIC) && read_value(file, version) && (version == INDEX_VERSION)
+             && read_value(file, size) && (size == length) && read_value(file, time) && (time == modification)
+             && read_value(file, log_stats.blocks) && read_value(file, log_stats.valid_blocks)
+             && read_value(file, log_stats.empty_blocks) && read_value(file, log_stats.bad_blocks)
+             && read_value(file, log_stats.records) && read_value(file, log_stats.dropped)
+             && read_value(file, log_stats.sequence_gaps) && read_value(file, sorted) && read_value(file, count)
+             && (count <= length/LIVE_LOG_BLOCK_SIZE);
+    if (loaded){
+
+        valid_blocks.resize(count);
+        valid_first_times.resize(count);
+    }
+    for (uint32_t i = 0; (loaded) && (i < count); i++){
+
+        loaded = read_value(file, valid_blocks[i]) && read_value(file, valid_first_times[i]);
+    }
+    loaded = loaded && read_value(file, num_channels);
+    for (uint32_t i = 0; (loaded) && (i < num_channels); i++){
+
+        loaded = read_value(file, key) && read_value(file, num_runs) && (num_runs <= count);
+        if (loaded){
+
+            std::vector<BlockRun> &channel = runs[key];
+            channel.resize(num_runs);
+            loaded = fread(channel.data(), sizeof(BlockRun), num_runs, file) == num_runs;
+        }
+    }
+    fclose(file);
+
+    if (!loaded){
+
+        log_stats = LogStats();
+        runs.clear();
+        valid_blocks.clear();
+        valid_first_times.clear();
+        return false;
+    }
+    log_stats.time_sorted = sorted != 0;
+    index_from_file = true;
+
+    return true;
+}
+
+uint64_t LiveLog::query(uint32_t key, uint32_t t0, uint32_t t1,
+                        const std::function<void(const tLiveLogRecord &)> &callback) const{
+
+    auto channel = runs.find(key);
+    uint64_t found = 0;
+
+    if ((channel == runs.end()) || (t0 > t1)){
+
+        return 0;
+    }
+    const std::vector<BlockRun> &channel_runs = channel->second;
+    auto run = channel_runs.begin();
+
+    // With the time in order the runs are in order too: the first one is looked for
+    if (log_stats.time_sorted){
+
+        run = std::lower_bound(channel_runs.begin(), channel_runs.end(), t0,
+                               [](const BlockRun &a, uint32_t t){ return a.last_time < t; });
+    }
+    for (; run != channel_runs.end(); ++run){
+
+        if (run->first_time > t1){
+
+            if (log_stats.time_sorted){
+
+                break;
+            }
+            continue;
+        }
+        if (run->last_time < t0){
+
+            continue;
+        }
+        for (uint32_t b = run->first_block; b < run->first_block + run->blocks; b++){
+
+            const tLiveLogBlock *current = block(b);
+
+            for (uint16_t r = 0; r < current->log.header.numRecords; r++){
+
+                const tLiveLogRecord &record = current->log.records[r];
+
+                if ((channel_key(record.ECU_ID, record.PID) == key) && (record.time_ms >= t0) && (record.time_ms <= t1)){
+
+                    callback(record);
+                    found++;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+uint64_t LiveLog::scan(uint32_t t0, uint32_t t1, const std::function<void(const tLiveLogRecord &)> &callback) const{
+
+    size_t first = 0;
+    uint64_t found = 0;
+
+    if (t0 > t1){
+
+        return 0;
+    }
+    if (log_stats.time_sorted){
+
+        // The block before the first one that starts at t0 or later can have records of t0
+        first = std::lower_bound(valid_first_times.begin(), valid_first_times.end(), t0) - valid_first_times.begin();
+        first = (first > 0) ? first - 1 : 0;
+    }
+    for (size_t i = first; i < valid_blocks.size(); i++){
+
+        const tLiveLogBlock *current = block(valid_blocks[i]);
+
+        if ((log_stats.time_sorted) && (valid_first_times[i] > t1)){
+
+            break;
+        }
+        for (uint16_t r = 0; r < current->log.header.numRecords; r++){
+
+            const tLiveLogRecord &record = current->log.records[r];
+
+            if ((record.time_ms >= t0) && (record.time_ms <= t1)){
+
+                callback(record);
+                found++;
+            }
+        }
+    }
+
+    return found;
+}
+
+} // namespace live_log
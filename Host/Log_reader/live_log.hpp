@@ -0,0 +1,113 @@
+/*
+ * live_log.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Reader of the live data logs of the device (LIVEnnnn.BIN, format on Software/Live_logger.h).
+ *      The file is mapped on memory and it is never copied. The index keeps, for every ECU and
+ *      PID, the runs of consecutive valid blocks that have records of it with their first and
+ *      last time, so a range query only reads the blocks of that PID in the range. The index is
+ *      saved next to the log (<log>.idx) and it is built again if the log changes.
+ */
+
+#ifndef LIVE_LOG_HPP_
+#define LIVE_LOG_HPP_
+
+// C++ libraries
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "Live_logger.h"
+
+namespace live_log {
+
+static const uint32_t INDEX_MAGIC = 0x4944424FUL;      // "OBDI"
+static const uint32_t INDEX_VERSION = 1;
+
+// Key of a channel: ECU and PID
+inline uint32_t channel_key(uint16_t ECU_ID, uint8_t PID){
+
+    return ((uint32_t)ECU_ID << 8) | PID;
+}
+
+struct BlockRun{
+
+    uint32_t first_block;
+    uint32_t blocks;
+    uint32_t first_time;        // ms
+    uint32_t last_time;
+    uint32_t records;
+};
+
+struct LogStats{
+
+    uint64_t blocks = 0;
+    uint64_t valid_blocks = 0;
+    uint64_t empty_blocks = 0;      // Preallocated and not written (zeros)
+    uint64_t bad_blocks = 0;        // Magic, version or CRC wrong
+    uint64_t records = 0;
+    uint64_t dropped = 0;           // Counted by the device
+    uint64_t sequence_gaps = 0;
+    bool time_sorted = true;
+};
+
+class LiveLog{
+
+public:
+    LiveLog() = default;
+    ~LiveLog();
+    LiveLog(const LiveLog &) = delete;
+    LiveLog &operator=(const LiveLog &) = delete;
+
+    // Map the log and load its index (or build it and save it if save_index)
+    bool open(const std::string &path, bool save_index = true);
+    void close();
+
+    bool build_index();
+    bool save_index() const;
+    bool load_index();
+    bool index_loaded() const { return index_from_file; }
+
+    // Records of the channel with t0 <= time_ms <= t1, in order
+    uint64_t query(uint32_t key, uint32_t t0, uint32_t t1,
+                   const std::function<void(const tLiveLogRecord &)> &callback) const;
+    // Records of every channel in the range, in order (scan of the blocks of the range)
+    uint64_t scan(uint32_t t0, uint32_t t1, const std::function<void(const tLiveLogRecord &)> &callback) const;
+
+    const std::map<uint32_t, std::vector<BlockRun>> &channels() const { return runs; }
+    const LogStats &stats() const { return log_stats; }
+    size_t size() const { return length; }
+    const std::string &index_path() const { return idx_path; }
+
+    static bool is_valid_block(const tLiveLogBlock *block);
+    static uint16_t crc16(const uint8_t *data, size_t length);
+
+private:
+    const tLiveLogBlock *block(uint32_t number) const;
+
+    std::string path;
+    std::string idx_path;
+    int fd = -1;
+    const uint8_t *data = nullptr;
+    size_t length = 0;
+    int64_t modification = 0;
+    bool index_from_file = false;
+    LogStats log_stats;
+    std::map<uint32_t, std::vector<BlockRun>> runs;
+    std::vector<uint32_t> valid_blocks;                 // For the scans
+    std::vector<uint32_t> valid_first_times;
+};
+
+} // namespace live_log
+
+#endif /* LIVE_LOG_HPP_ */
@@ -0,0 +1,265 @@
+/*
+ * log_reader.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Command line reader of the live data logs (LIVEnnnn.BIN) copied from the SD card.
+ *      A channel is the short name of the firmware (RPM) or the PID (0x0C), with the ECU
+ *      after a colon if there are more than one (RPM:7E8). The times are in ms from the
+ *      start of the recording.
+ *
+ *      Build and run (from this folder):
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -o log_reader log_reader.cpp live_log.cpp
+ *          ./log_reader LIVE0000.BIN info
+ *          ./log_reader LIVE0000.BIN query RPM 60000 120000
+ *          ./log_reader LIVE0000.BIN csv out.csv RPM,SPEED,MAF [t0 t1]
+ */
+
+// C libraries
+#include <strings.h>
+
+// C++ libraries
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "live_log.hpp"
+#include "obd_pids.hpp"
+
+// Part of the records (of the range) above which a scan is faster than the queries
+#define SCAN_FRACTION 4
+
+
+static void print_usage(const char *program){
+
+    fprintf(stderr, "Usage: %s log info\n"
+                    "       %s log query channel [t0 t1]\n"
+                    "       %s log csv output.csv channel[,channel...] [t0 t1]\n", program, program, program);
+}
+
+// Keys of a channel: every ECU of the log if the ECU is not given
+static bool parse_channel(const live_log::LiveLog &log, const std::string &text, std::vector<uint32_t> &keys){
+
+    std::string name = text.substr(0, text.find(':'));
+    long ECU_ID = -1;
+    long PID = -1;
+
+    if (text.find(':') != std::string::npos){
+
+        ECU_ID = strtol(text.c_str() + text.find(':') + 1, nullptr, 16);
+    }
+    for (const obd::PIDFormula &formula : obd::PID_formulas){
+
+        if (strcasecmp(formula.name, name.c_str()) == 0){
+
+            PID = formula.PID;
+        }
+    }
+    if ((PID < 0) && (name.size() > 0)){
+
+        char *end;
+        PID = strtol(name.c_str(), &end, 0);
+        if ((*end != '\0') || (PID > 0xFF)){
+
+            PID = -1;
+        }
+    }
+    if (PID < 0){
+
+        fprintf(stderr, "Unknown channel %s\n", text.c_str());
+        return false;
+    }
+
+    for (const auto &channel : log.channels()){
+
+        if (((channel.first & 0xFF) == (uint32_t)PID) && ((ECU_ID < 0) || ((long)(channel.first >> 8) == ECU_ID))){
+
+            keys.push_back(channel.first);
+        }
+    }
+
+    return true;
+}
+
+static void print_info(const live_log::LiveLog &log){
+
+    const live_log::LogStats &stats = log.stats();
+
+    printf("%zu bytes, %llu blocks: %llu valid, %llu empty, %llu bad\n", log.size(),
+           (unsigned long long)stats.blocks, (unsigned long long)stats.valid_blocks,
+           (unsigned long long)stats.empty_blocks, (unsigned long long)stats.bad_blocks);
+    printf("%llu records, %llu dropped on the device, %llu gaps of the sequence%s\n",
+           (unsigned long long)stats.records, (unsigned long long)stats.dropped,
+           (unsigned long long)stats.sequence_gaps, stats.time_sorted ? "" : ", time not in order");
+    printf("Index %s (%s)\n", log.index_path().c_str(), log.index_loaded() ? "loaded" : "built");
+
+    for (const auto &channel : log.channels()){
+
+        const obd::PIDFormula *formula = obd::find_formula(channel.first & 0xFF);
+        uint64_t records = 0;
+
+        for (const live_log::BlockRun &run : channel.second){
+
+            records += run.records;
+        }
+        printf("  %03X %-6s PID 0x%02X: %10llu records, %8zu runs, %u-%u ms\n", channel.first >> 8,
+               (formula != nullptr) ? formula->name : "-", channel.first & 0xFF, (unsigned long long)records,
+               channel.second.size(), channel.second.front().first_time, channel.second.back().last_time);
+    }
+}
+
+static void print_record(FILE *output, const tLiveLogRecord &record, bool csv){
+
+    const obd::PIDFormula *formula = obd::find_formula(record.PID);
+
+    if (csv){
+
+        if (formula != nullptr){
+
+            fprintf(output, "%u,%03X,%02X,%s,%g\n", record.time_ms, record.ECU_ID, record.PID, formula->name,
+                    obd::decode(*formula, record.data[0], record.data[1]));
+        }else {
+
+            fprintf(output, "%u,%03X,%02X,,%u\n", record.time_ms, record.ECU_ID, record.PID, record.data[0]);
+        }
+    }else if (formula != nullptr){
+
+        fprintf(output, "%10u ms %03X %-6s %10g %s\n", record.time_ms, record.ECU_ID, formula->name,
+                obd::decode(*formula, record.data[0], record.data[1]), formula->unit);
+    }else {
+
+        fprintf(output, "%10u ms %03X PID %02X %02X %02X %02X %02X\n", record.time_ms, record.ECU_ID, record.PID,
+                record.data[0], record.data[1], record.data[2], record.data[3]);
+    }
+}
+
+// Records of the keys in the range in order of time: with a scan if they are many, or
+// with the index and a merge if they are a small part of the log
+static uint64_t export_records(const live_log::LiveLog &log, const std::vector<uint32_t> &keys,
+                               uint32_t t0, uint32_t t1, FILE *output, bool csv){
+
+    uint64_t selected = 0;
+    std::vector<tLiveLogRecord> records;
+
+    for (uint32_t key : keys){
+
+        for (const live_log::BlockRun &run : log.channels().at(key)){
+
+            if ((run.last_time >= t0) && (run.first_time <= t1)){
+
+                selected += run.records;
+            }
+        }
+    }
+
+    if ((keys.size() > 1) && (selected*SCAN_FRACTION > log.stats().records)){
+
+        selected = 0;
+        log.scan(t0, t1, [&](const tLiveLogRecord &record){
+
+            if (std::find(keys.begin(), keys.end(), live_log::channel_key(record.ECU_ID, record.PID)) != keys.end()){
+
+                print_record(output, record, csv);
+                selected++;
+            }
+        });
+        return selected;
+    }
+
+    for (uint32_t key : keys){
+
+        log.query(key, t0, t1, [&](const tLiveLogRecord &record){ records.push_back(record); });
+    }
+    if (keys.size() > 1){
+
+        std::stable_sort(records.begin(), records.end(),
+                         [](const tLiveLogRecord &a, const tLiveLogRecord &b){ return a.time_ms < b.time_ms; });
+    }
+    for (const tLiveLogRecord &record : records){
+
+        print_record(output, record, csv);
+    }
+
+    return records.size();
+}
+
+int main(int argc, char *argv[]){
+
+    live_log::LiveLog log;
+    std::vector<uint32_t> keys;
+    std::string command = (argc > 2) ? argv[2] : "";
+    uint32_t t0 = 0, t1 = UINT32_MAX;
+    FILE *output = stdout;
+    uint64_t exported;
+    int first_channel = 3;
+    auto start = std::chrono::steady_clock::now();
+
+    if ((argc < 3) || ((command != "info") && (command != "query") && (command != "csv"))
+            || ((command == "query") && (argc < 4)) || ((command == "csv") && (argc < 5))){
+
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!log.open(argv[1])){
+
+        return EXIT_FAILURE;
+    }
+    if (command == "info"){
+
+        print_info(log);
+        printf("%.1f ms\n", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        return EXIT_SUCCESS;
+    }
+
+    if (command == "csv"){
+
+        first_channel = 4;
+        output = fopen(argv[3], "w");
+        if (output == nullptr){
+
+            perror(argv[3]);
+            return EXIT_FAILURE;
+        }
+        fprintf(output, "time_ms,ECU,PID,name,value\n");
+    }
+    if (argc > first_channel + 2){
+
+        t0 = strtoul(argv[first_channel+1], nullptr, 0);
+        t1 = strtoul(argv[first_channel+2], nullptr, 0);
+    }
+
+    std::string channels = argv[first_channel];
+    for (size_t position = 0; position <= channels.size();){
+
+        size_t end = channels.find(',', position);
+        if (end == std::string::npos){
+
+            end = channels.size();
+        }
+        if (!parse_channel(log, channels.substr(position, end - position), keys)){
+
+            return EXIT_FAILURE;
+        }
+        position = end + 1;
+    }
+
+    exported = export_records(log, keys, t0, t1, output, command == "csv");
+    if (output != stdout){
+
+        fclose(output);
+    }
+    fprintf(stderr, "%llu records in %.1f ms\n", (unsigned long long)exported,
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+    return EXIT_SUCCESS;
+}
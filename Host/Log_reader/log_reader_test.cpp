@@ -0,0 +1,301 @@
+/*
+ * log_reader_test.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host test of the log reader. A log like the ones of the device is generated: two ECUs,
+ *      the live data PIDs at different rates, a PID that is only polled for a while, blocks
+ *      with a bad CRC, a lost block (gap of the sequence) and the preallocated end without
+ *      data. The index is built, saved and loaded again, and random range queries and scans
+ *      are compared with a search over all the records. Then the speed of the index build
+ *      (MB/s) and of the queries is measured.
+ *
+ *      Build and run (from this folder):
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -o log_reader_test log_reader_test.cpp live_log.cpp
+ *          ./log_reader_test /tmp/LIVE0000.BIN [MB]
+ */
+
+// C libraries
+#include <unistd.h>
+
+// C++ libraries
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "live_log.hpp"
+#include "obd_pids.hpp"
+
+#define QUERIES 300
+#define BAD_BLOCK_EVERY 997
+#define LOST_BLOCK 1234
+#define EMPTY_BLOCKS 200            // Preallocated run not written
+#define RARE_PID 0x1F               // Only between 25 % and 30 % of the recording
+#define ECUS {0x7E8, 0x7E9}
+
+static uint32_t state = 0x10C2026;
+
+
+static uint32_t next_random(void){
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state;
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start){
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Records of the device: a poll of the list every 10 ms, like Live_all_data
+static bool generate_log(const char *path, uint64_t megabytes, std::vector<tLiveLogRecord> &valid){
+
+    FILE *file = fopen(path, "wb");
+    uint64_t num_blocks = megabytes*1024*1024/LIVE_LOG_BLOCK_SIZE;
+    const uint16_t ECU_IDs[] = ECUS;
+    tLiveLogBlock block;
+    uint32_t time_ms = 0, sequence = 0, poll = 0;
+    size_t next_pid = 0, next_ECU = 0;
+
+    if (file == nullptr){
+
+        perror(path);
+        return false;
+    }
+
+    for (uint64_t b = 0; b < num_blocks; b++){
+
+        std::vector<tLiveLogRecord> records;
+        bool bad = (b % BAD_BLOCK_EVERY) == BAD_BLOCK_EVERY - 1;
+        bool lost = b == LOST_BLOCK;
+
+        memset(&block, 0, sizeof(block));
+        if (b >= num_blocks - EMPTY_BLOCKS){
+
+            fwrite(&block, sizeof(block), 1, file);
+            continue;
+        }
+        for (size_t r = 0; r < LIVE_LOG_RECORDS_PER_BLOCK; r++){
+
+            const obd::PIDFormula &formula = obd::PID_formulas[next_pid];
+            tLiveLogRecord &record = block.log.records[r];
+
+            if ((formula.PID == RARE_PID) && ((b < num_blocks/4) || (b > num_blocks*3/10))){
+
+                r--;    // Not polled: the next PID takes the place
+            }else {
+
+                record.time_ms = time_ms;
+                record.ECU_ID = ECU_IDs[next_ECU];
+                record.PID = formula.PID;
+                record.numBytes = formula.two_bytes ? 2 : 1;
+                record.data[0] = next_random() & 0xFF;
+                record.data[1] = formula.two_bytes ? next_random() & 0xFF : 0;
+                records.push_back(record);
+            }
+            if (++next_ECU == sizeof(ECU_IDs)/sizeof(ECU_IDs[0])){
+
+                next_ECU = 0;
+                if (++next_pid == obd::NUM_PID_FORMULAS){
+
+                    next_pid = 0;
+                    poll++;
+                    time_ms = poll*10 + next_random() % 3;
+                }
+            }
+        }
+        block.log.header.magic = LIVE_LOG_MAGIC;
+        block.log.header.sequence = sequence++;
+        block.log.header.numRecords = LIVE_LOG_RECORDS_PER_BLOCK;
+        block.log.header.dropped = ((b % 5000) == 4999) ? 3 : 0;
+        block.log.header.version = LIVE_LOG_VERSION;
+        block.log.header.record_size = sizeof(tLiveLogRecord);
+        block.log.header.checksum = live_log::LiveLog::crc16((const uint8_t *)block.log.records,
+                                                             LIVE_LOG_RECORDS_PER_BLOCK*sizeof(tLiveLogRecord));
+        if (lost){
+
+            continue;   // Never on the card: gap of the sequence
+        }
+        if (bad){
+
+            block.log.records[7].data[0] ^= 0x10;
+        }else {
+
+            valid.insert(valid.end(), records.begin(), records.end());
+        }
+        fwrite(&block, sizeof(block), 1, file);
+    }
+
+    return fclose(file) == 0;
+}
+
+static bool same_record(const tLiveLogRecord &a, const tLiveLogRecord &b){
+
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// The CRC with the table is the one of the firmware (bit by bit)
+static bool check_crc(void){
+
+    uint8_t data[300];
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < sizeof(data); i++){
+
+        data[i] = next_random() & 0xFF;
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++){
+
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc == live_log::LiveLog::crc16(data, sizeof(data));
+}
+
+static int check_queries(const live_log::LiveLog &log, const std::vector<tLiveLogRecord> &valid, const char *name){
+
+    uint32_t last_time = valid.back().time_ms;
+    const uint16_t ECU_IDs[] = ECUS;
+    int errors = 0;
+
+    for (int q = 0; q < QUERIES; q++){
+
+        const obd::PIDFormula &formula = obd::PID_formulas[next_random() % obd::NUM_PID_FORMULAS];
+        uint32_t key = live_log::channel_key(ECU_IDs[next_random() % 2], formula.PID);
+        uint32_t t0 = next_random() % last_time;
+        uint32_t t1 = t0 + next_random() % ((q % 10 == 0) ? last_time : 5000);
+        std::vector<tLiveLogRecord> expected, found;
+
+        for (const tLiveLogRecord &record : valid){
+
+            if ((live_log::channel_key(record.ECU_ID, record.PID) == key) && (record.time_ms >= t0) && (record.time_ms <= t1)){
+
+                expected.push_back(record);
+            }
+        }
+        log.query(key, t0, t1, [&](const tLiveLogRecord &record){ found.push_back(record); });
+        if ((found.size() != expected.size()) || (!std::equal(found.begin(), found.end(), expected.begin(), same_record))){
+
+            fprintf(stderr, "%s: query %s:%03X %u-%u: %zu records, %zu expected\n", name, formula.name,
+                    key >> 8, t0, t1, found.size(), expected.size());
+            errors++;
+        }
+
+        if ((q % 20) == 0){
+
+            size_t count = 0;
+            for (const tLiveLogRecord &record : valid){
+
+                count += (record.time_ms >= t0) && (record.time_ms <= t1);
+            }
+            if (log.scan(t0, t1, [](const tLiveLogRecord &){}) != count){
+
+                fprintf(stderr, "%s: scan %u-%u is not the same\n", name, t0, t1);
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+int main(int argc, char *argv[]){
+
+    live_log::LiveLog log;
+    std::vector<tLiveLogRecord> valid;
+    uint64_t megabytes = (argc > 2) ? strtoull(argv[2], nullptr, 0) : 64;
+    uint32_t rare_key = live_log::channel_key(0x7E8, RARE_PID);
+    uint64_t rare_blocks = 0, found = 0;
+    double build_ms, query_ms;
+    int errors = 0;
+
+    if (argc < 2){
+
+        fprintf(stderr, "Usage: %s log [MB]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!check_crc()){
+
+        fprintf(stderr, "The CRC is not the one of the firmware\n");
+        errors++;
+    }
+
+    std::string index = std::string(argv[1]) + ".idx";
+    unlink(index.c_str());
+    if (!generate_log(argv[1], megabytes, valid)){
+
+        return EXIT_FAILURE;
+    }
+
+    // Index built (the log is on the page cache after the generation)
+    auto start = std::chrono::steady_clock::now();
+    if ((!log.open(argv[1])) || (log.index_loaded())){
+
+        fprintf(stderr, "The index is not built\n");
+        return EXIT_FAILURE;
+    }
+    build_ms = elapsed_ms(start);
+
+    const live_log::LogStats &stats = log.stats();
+    printf("%llu blocks: %llu valid, %llu empty, %llu bad, %llu gaps; %llu records\n",
+           (unsigned long long)stats.blocks, (unsigned long long)stats.valid_blocks,
+           (unsigned long long)stats.empty_blocks, (unsigned long long)stats.bad_blocks,
+           (unsigned long long)stats.sequence_gaps, (unsigned long long)stats.records);
+    // Every bad block is also a gap of the sequence of the valid ones
+    if ((stats.records != valid.size()) || (stats.empty_blocks != EMPTY_BLOCKS) || (stats.sequence_gaps != stats.bad_blocks + 1)
+            || (stats.bad_blocks != stats.blocks - stats.valid_blocks - EMPTY_BLOCKS) || (!stats.time_sorted)){
+
+        fprintf(stderr, "The stats of the log are not right\n");
+        errors++;
+    }
+    for (const live_log::BlockRun &run : log.channels().at(rare_key)){
+
+        rare_blocks += run.blocks;
+    }
+    printf("Index: %zu channels, %s: %zu runs of %llu blocks\n", log.channels().size(), "RUN:7E8",
+           log.channels().at(rare_key).size(), (unsigned long long)rare_blocks);
+    if (rare_blocks > stats.valid_blocks/10){
+
+        fprintf(stderr, "The index of %s has too many blocks\n", "RUN:7E8");
+        errors++;
+    }
+    errors += check_queries(log, valid, "Built");
+
+    // The index file is taken the next time
+    log.close();
+    if ((!log.open(argv[1])) || (!log.index_loaded())){
+
+        fprintf(stderr, "The index is not loaded\n");
+        errors++;
+    }
+    errors += check_queries(log, valid, "Loaded");
+
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < QUERIES; q++){
+
+        uint32_t t0 = next_random() % valid.back().time_ms;
+        found += log.query(live_log::channel_key(0x7E8, 0x0C), t0, t0 + 60000, [](const tLiveLogRecord &){});
+    }
+    query_ms = elapsed_ms(start);
+
+    printf("Index build: %.1f ms, %.0f MB/s\n", build_ms, megabytes/(build_ms/1000));
+    printf("Query of one minute of RPM: %.1f us (%llu records)\n", 1000*query_ms/QUERIES,
+           (unsigned long long)(found/QUERIES));
+    printf("%s\n", (errors == 0) ? "Reader correct" : "Reader with errors");
+
+    return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
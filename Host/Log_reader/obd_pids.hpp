@@ -0,0 +1,75 @@
+/*
+ * obd_pids.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Live data PIDs of the firmware (pids_liveData and liveData_shortStrings of
+ *      Software/CAN_device.h) with the formulas of decode_CANdata. Every formula is
+ *      scale*A + offset or scale*(256*A + B) + offset, so it is kept as a table.
+ */
+
+#ifndef OBD_PIDS_HPP_
+#define OBD_PIDS_HPP_
+
+// C++ libraries
+#include <cstdint>
+#include <cstddef>
+
+namespace obd {
+
+struct PIDFormula{
+
+    uint8_t PID;
+    const char *name;           // Short name of the firmware
+    const char *unit;
+    bool two_bytes;             // 256*A + B
+    double scale;
+    double offset;
+};
+
+// Same order as pids_liveData (posPID). One table for all the files, so a pointer to a formula
+// can be compared
+inline const PIDFormula PID_formulas[] = {
+
+    {0x04, "LOAD", "%", false, 100.0/255, 0},
+    {0x05, "ECT", "C", false, 1, -40},
+    {0x06, "STFT1", "%", false, 100.0/128, -100},
+    {0x07, "LTFT1", "%", false, 100.0/128, -100},
+    {0x0C, "RPM", "rpm", true, 1.0/4, 0},
+    {0x0D, "SPEED", "km/h", false, 1, 0},
+    {0x0B, "MAP", "kPa", false, 1, 0},
+    {0x0E, "ADV", "deg", false, 1.0/2, -64},
+    {0x0F, "IAT", "C", false, 1, -40},
+    {0x10, "MAF", "g/s", true, 1.0/100, 0},
+    {0x11, "TPS", "%", false, 100.0/255, 0},
+    {0x1F, "RUN", "s", true, 1, 0},
+};
+inline const size_t NUM_PID_FORMULAS = sizeof(PID_formulas)/sizeof(PID_formulas[0]);
+
+// Formula of a PID, nullptr if it is not a live data PID
+inline const PIDFormula *find_formula(uint8_t PID){
+
+    for (const PIDFormula &formula : PID_formulas){
+
+        if (formula.PID == PID){
+
+            return &formula;
+        }
+    }
+
+    return nullptr;
+}
+
+inline double decode(const PIDFormula &formula, uint8_t A, uint8_t B){
+
+    return formula.scale*(formula.two_bytes ? 256.0*A + B : (double)A) + formula.offset;
+}
+
+} // namespace obd
+
+#endif /* OBD_PIDS_HPP_ */
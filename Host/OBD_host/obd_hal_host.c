@@ -0,0 +1,267 @@
+/*
+ * obd_hal_host.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Programmer libraries
+#include "OBD_HAL.h"
+#include "obd_hal_host.h"
+
+// Global variables
+static uint64_t now_us;
+static tHostResponder CAN_responder;
+static void *responder_context;
+static tHostFrame CAN_queue[HOST_CAN_QUEUE_FRAMES];     // Ordered by arrival
+static uint32_t CAN_queued;
+static uint32_t reception_ID, reception_mask;
+static tHostCANStats CAN_stats;
+static char display[HOST_DISPLAY_ROWS][HOST_DISPLAY_COLUMNS+1];
+static tHostRecord records[HOST_STORAGE_RECORDS];
+static uint32_t numRecords;
+
+
+void host_resetHAL(void){
+
+    now_us = 0;
+    CAN_responder = NULL;
+    responder_context = NULL;
+    CAN_queued = 0;
+    reception_ID = 0;
+    reception_mask = 0;
+    memset(&CAN_stats, 0, sizeof(CAN_stats));
+    hal_displayClear();
+    numRecords = 0;
+}
+
+void host_setResponder(tHostResponder responder, void *context){
+
+    CAN_responder = responder;
+    responder_context = context;
+}
+
+// Standard frame: 47 bits of header, CRC and spaces and the data (without stuff bits)
+uint32_t host_frameTimeUs(uint8_t length){
+
+    return (47 + 8*(uint32_t)length)*HOST_CAN_BIT_US;
+}
+
+void host_CANinject(uint32_t ID, const uint8_t data[], uint8_t length, uint32_t delay_us){
+
+    tHostFrame frame;
+    uint32_t position;
+
+    if (CAN_queued == HOST_CAN_QUEUE_FRAMES){
+
+        CAN_stats.overflows++;
+        return;
+    }
+    if (length > 8){
+
+        length = 8;
+    }
+    frame.time_us = now_us + delay_us + host_frameTimeUs(length);
+    frame.ID = ID;
+    frame.length = length;
+    memset(frame.data, 0, sizeof(frame.data));
+    memcpy(frame.data, data, length);
+
+    // The queue is short, the frames are inserted in order
+    position = CAN_queued;
+    while ((position > 0) && (CAN_queue[position-1].time_us > frame.time_us)){
+
+        CAN_queue[position] = CAN_queue[position-1];
+        position--;
+    }
+    CAN_queue[position] = frame;
+    CAN_queued++;
+    if (CAN_queued > CAN_stats.max_queued){
+
+        CAN_stats.max_queued = CAN_queued;
+    }
+}
+
+uint64_t host_timeUs(void){
+
+    return now_us;
+}
+
+void host_advanceUs(uint64_t time_us){
+
+    now_us += time_us;
+}
+
+const tHostCANStats *host_CANstats(void){
+
+    return &CAN_stats;
+}
+
+static void pop_frame(void){
+
+    memmove(CAN_queue, CAN_queue+1, (CAN_queued-1)*sizeof(tHostFrame));
+    CAN_queued--;
+}
+
+void hal_CANsetReception(uint32_t response_ID, uint32_t mask){
+
+    reception_ID = response_ID;
+    reception_mask = mask;
+}
+
+bool hal_CANsend(uint32_t ID, const uint8_t data[], uint8_t length){
+
+    tHostFrame frame;
+
+    // Frames that arrived before this request are not taken as its answer (the Tiva
+    // clears the reception events before sending)
+    while ((CAN_queued > 0) && (CAN_queue[0].time_us <= now_us)){
+
+        pop_frame();
+        CAN_stats.late++;
+    }
+
+    now_us += host_frameTimeUs(length);
+    frame.time_us = now_us;
+    frame.ID = ID;
+    frame.length = (length > 8) ? 8 : length;
+    memset(frame.data, 0, sizeof(frame.data));
+    memcpy(frame.data, data, frame.length);
+    CAN_stats.sent++;
+
+    if (CAN_responder != NULL){
+
+        CAN_responder(&frame, responder_context);
+    }
+
+    return true;
+}
+
+bool hal_CANreceive(uint32_t *ID, uint8_t data[], uint32_t timeout_ms){
+
+    uint64_t deadline_us = now_us + (uint64_t)timeout_ms*1000;
+
+    while ((CAN_queued > 0) && (CAN_queue[0].time_us <= deadline_us)){
+
+        tHostFrame frame = CAN_queue[0];
+
+        pop_frame();
+        if (frame.time_us > now_us){
+
+            now_us = frame.time_us;
+        }
+        if ((frame.ID & reception_mask) != (reception_ID & reception_mask)){
+
+            CAN_stats.filtered++;
+            continue;
+        }
+        *ID = frame.ID;
+        memcpy(data, frame.data, 8);
+        CAN_stats.received++;
+
+        return true;
+    }
+    now_us = deadline_us;
+
+    return false;
+}
+
+uint32_t hal_timeMs(void){
+
+    return (uint32_t)(now_us/1000);
+}
+
+void hal_displayClear(void){
+
+    for (int row = 0; row < HOST_DISPLAY_ROWS; row++){
+
+        memset(display[row], ' ', HOST_DISPLAY_COLUMNS);
+        display[row][HOST_DISPLAY_COLUMNS] = '\0';
+    }
+}
+
+// Same wrap as drawString: a new line goes back to the column of x
+void hal_displayString(int16_t x, int16_t y, const char *text, uint8_t style){
+
+    int column = x/6, row = y/10;
+
+    (void)style;
+    for (; *text != '\0'; text++){
+
+        if (*text == '\n'){
+
+            row++;
+            column = 0;
+            continue;
+        }
+        if (column >= HOST_DISPLAY_COLUMNS){
+
+            row++;
+            column = x/6;
+        }
+        if ((row >= 0) && (row < HOST_DISPLAY_ROWS) && (column >= 0)){
+
+            display[row][column] = *text;
+        }
+        column++;
+    }
+}
+
+const char *host_displayRow(uint8_t row){
+
+    return (row < HOST_DISPLAY_ROWS) ? display[row] : "";
+}
+
+bool host_displayFind(const char *text, uint8_t *row, uint8_t *column){
+
+    for (int i = 0; i < HOST_DISPLAY_ROWS; i++){
+
+        const char *found = strstr(display[i], text);
+        if (found != NULL){
+
+            *row = i;
+            *column = (uint8_t)(found - display[i]);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The last HOST_STORAGE_RECORDS records are kept
+void hal_storeRecord(uint32_t ECU_ID, uint8_t PID, const uint8_t data[], uint8_t numBytes){
+
+    tHostRecord *record = &records[numRecords % HOST_STORAGE_RECORDS];
+
+    record->time_ms = hal_timeMs();
+    record->ECU_ID = ECU_ID;
+    record->PID = PID;
+    record->numBytes = (numBytes > 4) ? 4 : numBytes;
+    memcpy(record->data, data, record->numBytes);
+    numRecords++;
+}
+
+uint32_t host_storageCount(void){
+
+    return numRecords;
+}
+
+const tHostRecord *host_storageRecord(uint32_t index){
+
+    if ((index >= numRecords) || (numRecords - index > HOST_STORAGE_RECORDS)){
+
+        return NULL;
+    }
+
+    return &records[index % HOST_STORAGE_RECORDS];
+}
@@ -0,0 +1,81 @@
+/*
+ * obd_hal_host.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      In-memory implementation of Software/OBD_HAL.h, so the OBD protocol runs on a PC:
+ *      - CAN: a 500 kbit/s bus in virtual time. Every frame sent takes its time on the bus and
+ *        is given to the responder (the simulated ECUs), which answers with host_CANinject.
+ *        The frames wait on a queue ordered by arrival time and the reception filter drops the
+ *        ones of other IDs, like the message object of the Tiva.
+ *      - Timer: the virtual clock. It only moves with the bus and the timeouts, so a timeout of
+ *        200 ms costs nothing on the PC.
+ *      - Display: a grid of characters of the 160x128 screen (6x10 pixels each).
+ *      - Storage: the last records of hal_storeRecord, with their time.
+ */
+
+#ifndef OBD_HAL_HOST_H_
+#define OBD_HAL_HOST_H_
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HOST_CAN_QUEUE_FRAMES 64
+#define HOST_CAN_BIT_US 2                       // 500 kbit/s
+#define HOST_DISPLAY_COLUMNS (160/6)
+#define HOST_DISPLAY_ROWS ((128+9)/10)
+#define HOST_STORAGE_RECORDS 4096
+
+typedef struct{
+
+    uint64_t time_us;           // End of the frame on the bus
+    uint32_t ID;
+    uint8_t length;
+    uint8_t data[8];
+}tHostFrame;
+
+typedef struct{
+
+    uint64_t sent;
+    uint64_t received;          // Given to the protocol
+    uint64_t filtered;          // Dropped by the reception filter
+    uint64_t late;              // Arrived before the next request and dropped by it
+    uint64_t overflows;         // Queue full
+    uint32_t max_queued;
+}tHostCANStats;
+
+typedef struct{
+
+    uint32_t time_ms;
+    uint32_t ECU_ID;
+    uint8_t PID;
+    uint8_t numBytes;
+    uint8_t data[4];
+}tHostRecord;
+
+// Called with every frame sent by the protocol, at the end of the frame on the bus
+typedef void (*tHostResponder)(const tHostFrame *frame, void *context);
+
+void host_resetHAL(void);
+void host_setResponder(tHostResponder responder, void *context);
+// Frame of an ECU that starts delay_us after now (the end of the frame that triggered it)
+void host_CANinject(uint32_t ID, const uint8_t data[], uint8_t length, uint32_t delay_us);
+uint32_t host_frameTimeUs(uint8_t length);
+uint64_t host_timeUs(void);
+void host_advanceUs(uint64_t time_us);
+const tHostCANStats *host_CANstats(void);
+
+const char *host_displayRow(uint8_t row);
+bool host_displayFind(const char *text, uint8_t *row, uint8_t *column);
+
+uint32_t host_storageCount(void);
+// NULL if the record has been overwritten
+const tHostRecord *host_storageRecord(uint32_t index);
+
+#endif /* OBD_HAL_HOST_H_ */
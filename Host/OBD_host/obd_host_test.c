@@ -0,0 +1,554 @@
+/*
+ * obd_host_test.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host test of the OBD protocol of the firmware (Software/OBD_protocol.c) on the in-memory
+ *      HAL. Two ECUs (ECM and TCM) answer the requests like the ones of a car: live data of the
+ *      PIDs of the device, DTCs on single and multi frame responses and the VIN. It checks:
+ *      - the values decoded, against the formulas of SAE J1979 computed by hand,
+ *      - the records stored and the text on the display,
+ *      - the DTCs and the VIN, reassembled with the flow control and its separation time,
+ *      - the answers of the other ECU dropped by the reception filter,
+ *      - no answer (timeout), a wrong sequence number, a negative response and a late answer.
+ *
+ *      Then it measures the transactions per second of every service on the PC, the time on the
+ *      500 kbit/s bus of each one (virtual time) and the stack they use (painted stack).
+ *
+ *      Build and run (from this folder):
+ *          cc -std=gnu99 -O2 -Wall -DPROBES_HOST -I../../Software -o obd_host_test obd_host_test.c obd_hal_host.c ../../Software/OBD_protocol.c ../../Software/Cycle_probes.c -lm
+ *          ./obd_host_test [transactions]
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <ucontext.h>
+
+// Programmer libraries
+#include "OBD_HAL.h"
+#include "OBD_protocol.h"
+#include "obd_hal_host.h"
+
+#define DEFAULT_TRANSACTIONS 200000
+#define ECU_RESPONSE_US 500             // From the end of the request to the start of the answer
+#define ECU_FLOW_CONTROL_US 100
+#define MAX_PENDING_BYTES 64
+#define PROBE_STACK_BYTES 65536
+#define NUM_TEST_ECUS 2
+
+typedef struct{
+
+    uint32_t request_ID;
+    uint32_t response_ID;
+    uint8_t PID_data[NUM_LIVE_DATA_PIDS][2];
+    uint8_t DTCs[OBD_MAX_DTCS][2];
+    uint8_t numDTCs;
+    const char *VIN;
+    uint32_t delay_us;
+    bool silent;                        // Does not answer
+    bool wrong_sequence;                // Skips a sequence number on the consecutive frames
+    bool negative;                      // 7F to every request
+    // Multi frame response waiting for the flow control
+    uint8_t pending[MAX_PENDING_BYTES];
+    uint16_t pending_length;
+    bool waiting_flow_control;
+    uint32_t requests;
+}tTestECU;
+
+// Raw bytes of every PID of pids_liveData and its value by hand (SAE J1979)
+static const uint8_t test_PID_data[NUM_LIVE_DATA_PIDS][2] = {{0xFF, 0}, {0x7B, 0}, {0x90, 0}, {0x70, 0},
+                                                            {0x1A, 0xF8}, {0x58, 0}, {0x65, 0}, {0x94, 0},
+                                                            {0x46, 0}, {0x04, 0xE2}, {0x33, 0}, {0x0E, 0x10}};
+static const double test_PID_values[NUM_LIVE_DATA_PIDS] = {100.0, 83.0, 12.5, -12.5, 1726.0, 88.0,
+                                                           101.0, 10.0, 30.0, 12.5, 20.0, 3600.0};
+static const uint8_t test_DTCs[][2] = {{0x01, 0x33}, {0x41, 0x23}, {0x80, 0x01}, {0xC1, 0x00},
+                                       {0x02, 0x44}, {0x03, 0x00}, {0x04, 0x20}};
+static const char *test_DTC_codes[] = {"P0133", "C0123", "B0001", "U0100", "P0244", "P0300", "P0420"};
+#define NUM_TEST_DTCS (sizeof(test_DTCs)/sizeof(test_DTCs[0]))
+static const char test_VIN[] = "1M8GDM9AXKP042788";
+
+static tTestECU ECUs[NUM_TEST_ECUS];
+static uint32_t failures;
+
+// Painted stack of the measures
+static ucontext_t main_context, probe_context;
+static uint8_t probe_stack[PROBE_STACK_BYTES];
+static void (*probe_function)(void);
+
+
+static void check(bool condition, const char *what){
+
+    if (!condition){
+
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static bool is_twoBytesPID(uint8_t PID){
+
+    return (PID == 0x0C) || (PID == 0x10) || (PID == 0x1F);
+}
+
+static void send_ECUframe(tTestECU *ECU, const uint8_t data[], uint32_t delay_us){
+
+    uint8_t frame[MAX_BYTES];
+
+    memset(frame, 0xAA, sizeof(frame));
+    memcpy(frame, data, MAX_BYTES);
+    host_CANinject(ECU->response_ID, frame, MAX_BYTES, delay_us);
+}
+
+// Single frame, or first frame and the rest after the flow control
+static void send_ECUpayload(tTestECU *ECU, const uint8_t payload[], uint16_t length){
+
+    uint8_t frame[MAX_BYTES];
+
+    memset(frame, 0xAA, sizeof(frame));
+    if (length <= MAX_BYTES-1){
+
+        frame[0] = (uint8_t)length;
+        memcpy(frame+1, payload, length);
+        send_ECUframe(ECU, frame, ECU->delay_us);
+        return;
+    }
+    frame[0] = 0x10 | (uint8_t)(length >> 8);
+    frame[1] = (uint8_t)length;
+    memcpy(frame+2, payload, MAX_BYTES-2);
+    send_ECUframe(ECU, frame, ECU->delay_us);
+
+    ECU->pending_length = length - (MAX_BYTES-2);
+    memcpy(ECU->pending, payload + (MAX_BYTES-2), ECU->pending_length);
+    ECU->waiting_flow_control = true;
+}
+
+// Consecutive frames after the flow control, separation_ms between them
+static void send_consecutiveFrames(tTestECU *ECU, uint8_t separation_ms){
+
+    uint8_t frame[MAX_BYTES];
+    uint8_t sequence = 1;
+    uint32_t delay_us = ECU_FLOW_CONTROL_US;
+
+    for (uint16_t sent = 0; sent < ECU->pending_length; sent += MAX_BYTES-1){
+
+        uint16_t bytes = ECU->pending_length - sent;
+
+        memset(frame, 0xAA, sizeof(frame));
+        frame[0] = 0x20 | (sequence & 0x0F);
+        memcpy(frame+1, ECU->pending + sent, (bytes < MAX_BYTES-1) ? bytes : MAX_BYTES-1);
+        send_ECUframe(ECU, frame, delay_us);
+
+        sequence += (ECU->wrong_sequence && (sequence == 1)) ? 2 : 1;
+        delay_us += separation_ms*1000 + host_frameTimeUs(MAX_BYTES);
+    }
+    ECU->waiting_flow_control = false;
+}
+
+static void answer_request(tTestECU *ECU, uint8_t mode, uint8_t PID){
+
+    uint8_t payload[MAX_PENDING_BYTES];
+    uint16_t length = 0;
+
+    ECU->requests++;
+    if (ECU->negative){
+
+        // Conditions not correct
+        payload[length++] = 0x7F;
+        payload[length++] = mode;
+        payload[length++] = 0x22;
+        send_ECUpayload(ECU, payload, length);
+        return;
+    }
+
+    switch (mode){
+
+    case 0x01:
+        payload[length++] = 0x41;
+        payload[length++] = PID;
+        if (PID == 0x01){
+
+            // MIL on and number of DTCs, tests
+            payload[length++] = 0x80 | ECU->numDTCs;
+            payload[length++] = 0x07;
+            payload[length++] = 0xE5;
+            payload[length++] = 0x00;
+            break;
+        }
+        for (int i = 0; i <= NUM_LIVE_DATA_PIDS; i++){
+
+            if (i == NUM_LIVE_DATA_PIDS){
+
+                // PID not supported: no answer
+                return;
+            }
+            if (pids_liveData[i] == PID){
+
+                payload[length++] = ECU->PID_data[i][0];
+                if (is_twoBytesPID(PID)){
+
+                    payload[length++] = ECU->PID_data[i][1];
+                }
+                break;
+            }
+        }
+        break;
+
+    case 0x03:
+    case 0x07:
+        payload[length++] = mode + 0x40;
+        payload[length++] = (mode == 0x03) ? ECU->numDTCs : 0;
+        for (int i = 0; (mode == 0x03) && (i < ECU->numDTCs); i++){
+
+            payload[length++] = ECU->DTCs[i][0];
+            payload[length++] = ECU->DTCs[i][1];
+        }
+        break;
+
+    case 0x09:
+        if ((PID != 0x02) || (ECU->VIN == NULL)){
+
+            return;
+        }
+        payload[length++] = 0x49;
+        payload[length++] = 0x02;
+        payload[length++] = 0x01;
+        memcpy(payload+length, ECU->VIN, strlen(ECU->VIN));
+        length += strlen(ECU->VIN);
+        break;
+
+    default:
+        return;
+    }
+    send_ECUpayload(ECU, payload, length);
+}
+
+// Responder of the host HAL: the ECUs see every frame of the bus
+static void ECUs_responder(const tHostFrame *frame, void *context){
+
+    tTestECU *ECU_list = (tTestECU *)context;
+
+    for (int i = 0; i < NUM_TEST_ECUS; i++){
+
+        tTestECU *ECU = &ECU_list[i];
+        uint8_t type = frame->data[0] >> 4;
+
+        if ((ECU->silent) || ((frame->ID != REMOTE_REQUEST_ID) && (frame->ID != ECU->request_ID))){
+
+            continue;
+        }
+        if (type == 3){
+
+            // Flow control, only on the physical ID
+            if ((ECU->waiting_flow_control) && (frame->ID == ECU->request_ID)){
+
+                send_consecutiveFrames(ECU, frame->data[2]);
+            }
+        }else if ((type == 0) && (frame->data[0] >= 1)){
+
+            answer_request(ECU, frame->data[1], (frame->data[0] >= 2) ? frame->data[2] : 0);
+        }
+    }
+}
+
+static void init_testECUs(void){
+
+    memset(ECUs, 0, sizeof(ECUs));
+    ECUs[0].request_ID = ECM_REQUEST;
+    ECUs[0].response_ID = ECM_RESPONSE;
+    ECUs[0].VIN = test_VIN;
+    ECUs[0].numDTCs = NUM_TEST_DTCS;
+    memcpy(ECUs[0].DTCs, test_DTCs, sizeof(test_DTCs));
+    // The TCM answers the functional requests a bit later, with other values
+    ECUs[1].request_ID = TCM_REQUEST;
+    ECUs[1].response_ID = TCM_RESPONSE;
+    ECUs[1].numDTCs = 2;
+    memcpy(ECUs[1].DTCs, test_DTCs, 2*sizeof(test_DTCs[0]));
+    for (int i = 0; i < NUM_TEST_ECUS; i++){
+
+        memcpy(ECUs[i].PID_data, test_PID_data, sizeof(test_PID_data));
+        ECUs[i].delay_us = ECU_RESPONSE_US + 300*i;
+    }
+    ECUs[1].PID_data[4][0] = 0;
+
+    host_resetHAL();
+    host_setResponder(ECUs_responder, ECUs);
+    reset_OBDstats();
+}
+
+static void test_liveData(void){
+
+    tOBDValue value;
+    const tHostRecord *record;
+    char text[64];
+
+    init_testECUs();
+    for (int i = 0; i < NUM_LIVE_DATA_PIDS; i++){
+
+        snprintf(text, sizeof(text), "PID %02X decoded", pids_liveData[i]);
+        check(read_PIDvalue(REMOTE_REQUEST_ID, ECM_RESPONSE, i, &value), text);
+        check(fabs(value.value - test_PID_values[i]) < 1e-9, text);
+        check(value.ECU_ID == ECM_RESPONSE, "Answer of the ECM");
+        check(value.numBytes == (is_twoBytesPID(pids_liveData[i]) ? 2 : 1), "Data bytes of the response");
+
+        record = host_storageRecord(host_storageCount()-1);
+        check((record != NULL) && (record->PID == pids_liveData[i]) && (record->ECU_ID == ECM_RESPONSE) &&
+              (record->numBytes == value.numBytes) && (memcmp(record->data, test_PID_data[i], record->numBytes) == 0),
+              "Record stored");
+    }
+    check(host_storageCount() == NUM_LIVE_DATA_PIDS, "One record per response");
+
+    // The TCM alone (physical request), with its own RPM
+    host_advanceUs(10000);
+    check(read_PIDvalue(TCM_REQUEST, TCM_RESPONSE, 4, &value) && (value.ECU_ID == TCM_RESPONSE) &&
+          (fabs(value.value - 62.0) < 1e-9), "RPM of the TCM");
+    // The TCM answered every functional request too: after the ECM (filter) or before the next request
+    check(host_CANstats()->filtered + host_CANstats()->late == NUM_LIVE_DATA_PIDS, "Answers of the TCM dropped");
+
+    check(!read_PIDvalue(REMOTE_REQUEST_ID, ECM_RESPONSE, NUM_LIVE_DATA_PIDS, &value), "PID out of the table");
+}
+
+static void test_DTCsAndVIN(void){
+
+    char codes[OBD_MAX_DTCS][NUM_CHAR_DTC+1];
+    char VIN[MAX_VIN_BYTES];
+    int16_t numDTCs;
+    uint8_t row, column;
+    uint64_t start_us;
+
+    init_testECUs();
+    // 7 DTCs: first frame and 2 consecutive frames, 5 ms between them
+    start_us = host_timeUs();
+    numDTCs = read_DTCs(ECM_REQUEST, ECM_RESPONSE, 0x03, codes, OBD_MAX_DTCS);
+    check(numDTCs == (int16_t)NUM_TEST_DTCS, "Number of DTCs on a multi frame response");
+    for (int i = 0; (i < numDTCs) && (i < (int)NUM_TEST_DTCS); i++){
+
+        check(strcmp(codes[i], test_DTC_codes[i]) == 0, "DTC decoded");
+    }
+    check(host_timeUs() - start_us >= ISOTP_SEPARATION_TIME_MS*1000, "Separation time of the flow control");
+
+    check(read_DTCs(ECM_REQUEST, ECM_RESPONSE, 0x03, codes, 3) == 3, "DTCs cut to the size of the list");
+    check(read_DTCs(TCM_REQUEST, TCM_RESPONSE, 0x03, codes, OBD_MAX_DTCS) == 2, "DTCs on a single frame");
+    check(read_DTCs(ECM_REQUEST, ECM_RESPONSE, 0x07, codes, OBD_MAX_DTCS) == 0, "No pending DTCs");
+
+    check(read_VIN(ECM_REQUEST, ECM_RESPONSE, VIN) && (strcmp(VIN, test_VIN) == 0), "VIN");
+    check(!read_VIN(TCM_REQUEST, TCM_RESPONSE, VIN), "No VIN on the TCM");
+
+    // Views
+    show_VIN(VIN);
+    check(host_displayFind("VIN", &row, &column) && (row == 5) && (column == 70/6), "Title of the VIN");
+    check(host_displayFind(test_VIN, &row, &column) && (row == 7) && (column == 25/6), "VIN on the display");
+    show_liveDataValue(1726.0, 2);
+    check(strncmp(host_displayRow(2) + 120/6, " 1726", 5) == 0, "Live data value on the display");
+}
+
+static void test_format(void){
+
+    static const double values[] = {1726.0, 12.5, -40.0, 100.0, 3600.0, 0.0};
+    static const char *texts[] = {" 1726", "12.50", "-40.0", "100.0", " 3600", "0.000"};
+    char output[7];
+
+    for (int i = 0; i < (int)(sizeof(values)/sizeof(values[0])); i++){
+
+        format_liveDataValue(values[i], output);
+        check(strcmp(output, texts[i]) == 0, "Format of a live data value");
+    }
+}
+
+static void test_errors(void){
+
+    tOBDValue value;
+    tOBDStats stats;
+    char codes[OBD_MAX_DTCS][NUM_CHAR_DTC+1];
+    uint64_t start_us;
+
+    // No answer: the timeout of the protocol on the virtual clock
+    init_testECUs();
+    ECUs[0].silent = true;
+    ECUs[1].silent = true;
+    start_us = host_timeUs();
+    check(!read_PIDvalue(REMOTE_REQUEST_ID, ECM_RESPONSE, 4, &value), "No answer");
+    check(host_timeUs() - start_us >= MAX_TIME_TO_WAIT_MS*1000, "Timeout");
+    get_OBDstats(&stats);
+    check((stats.requests == 1) && (stats.timeouts == 1) && (stats.responses == 0), "Timeout counted");
+
+    // Wrong sequence number on the consecutive frames
+    init_testECUs();
+    ECUs[0].wrong_sequence = true;
+    check(read_DTCs(ECM_REQUEST, ECM_RESPONSE, 0x03, codes, OBD_MAX_DTCS) < 0, "Wrong sequence number");
+    get_OBDstats(&stats);
+    check(stats.errors == 1, "Wrong sequence counted");
+
+    // Negative response
+    init_testECUs();
+    ECUs[0].negative = true;
+    check(!read_PIDvalue(ECM_REQUEST, ECM_RESPONSE, 4, &value), "Negative response");
+    check(read_DTCs(ECM_REQUEST, ECM_RESPONSE, 0x03, codes, OBD_MAX_DTCS) < 0, "Negative response to the DTCs");
+    get_OBDstats(&stats);
+    check((stats.errors == 2) && (host_storageCount() == 0), "Negative responses counted and not stored");
+
+    // An answer just after the timeout comes during the next request, and it is skipped:
+    // that request takes its own answer
+    init_testECUs();
+    ECUs[0].delay_us = MAX_TIME_TO_WAIT_MS*1000 + 300;
+    check(!read_PIDvalue(ECM_REQUEST, ECM_RESPONSE, 4, &value), "Late answer");
+    ECUs[0].delay_us = ECU_RESPONSE_US;
+    check(read_PIDvalue(ECM_REQUEST, ECM_RESPONSE, 5, &value) && (fabs(value.value - 88.0) < 1e-9), "Late answer of another PID skipped");
+    check(read_PIDvalue(ECM_REQUEST, ECM_RESPONSE, 5, &value) && (fabs(value.value - 88.0) < 1e-9), "Answer after a late one");
+    get_OBDstats(&stats);
+    check((stats.timeouts == 1) && (stats.errors == 0) && (stats.responses == 2), "Late answer counted");
+}
+
+static double elapsed_s(const struct timespec *start){
+
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec)/1e9;
+}
+
+static void print_speed(const char *service, uint32_t transactions, double wall_s, uint64_t bus_us){
+
+    printf("%-12s %8.0f transactions/s on the PC, %7.2f ms on the bus each\n", service,
+           transactions/wall_s, bus_us/1000.0/transactions);
+}
+
+static void benchmark(uint32_t transactions){
+
+    tOBDValue value;
+    tOBDStats stats;
+    char codes[OBD_MAX_DTCS][NUM_CHAR_DTC+1];
+    char VIN[MAX_VIN_BYTES];
+    struct timespec start;
+    uint64_t start_us;
+    uint32_t answered = 0;
+
+    init_testECUs();
+    start_us = host_timeUs();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < transactions; i++){
+
+        answered += read_PIDvalue(REMOTE_REQUEST_ID, ECM_RESPONSE, i % NUM_LIVE_DATA_PIDS, &value);
+    }
+    print_speed("Live data", transactions, elapsed_s(&start), host_timeUs() - start_us);
+    check(answered == transactions, "Every live data request answered");
+    get_OBDstats(&stats);
+    printf("             latency %.2f ms average, %u ms max (hal_timeMs), %llu records stored\n",
+           (double)stats.latency_sum_ms/stats.responses, stats.latency_max_ms, (unsigned long long)host_storageCount());
+
+    transactions /= 10;
+    start_us = host_timeUs();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    answered = 0;
+    for (uint32_t i = 0; i < transactions; i++){
+
+        answered += (read_DTCs(ECM_REQUEST, ECM_RESPONSE, 0x03, codes, OBD_MAX_DTCS) == (int16_t)NUM_TEST_DTCS);
+    }
+    print_speed("DTCs (ISO-TP)", transactions, elapsed_s(&start), host_timeUs() - start_us);
+    check(answered == transactions, "Every DTC request answered");
+
+    start_us = host_timeUs();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    answered = 0;
+    for (uint32_t i = 0; i < transactions; i++){
+
+        answered += read_VIN(ECM_REQUEST, ECM_RESPONSE, VIN);
+    }
+    print_speed("VIN (ISO-TP)", transactions, elapsed_s(&start), host_timeUs() - start_us);
+    check(answered == transactions, "Every VIN request answered");
+    printf("Bus: %llu frames sent, %llu received, %llu dropped by the filter, %u queued at most\n",
+           (unsigned long long)host_CANstats()->sent, (unsigned long long)host_CANstats()->received,
+           (unsigned long long)host_CANstats()->filtered, host_CANstats()->max_queued);
+}
+
+static void probe_entry(void){
+
+    probe_function();
+}
+
+// Bytes of the painted stack used by function (with the host HAL and the ECUs)
+static size_t measure_stack(void (*function)(void)){
+
+    size_t untouched = 0;
+
+    memset(probe_stack, 0xA5, sizeof(probe_stack));
+    probe_function = function;
+    getcontext(&probe_context);
+    probe_context.uc_stack.ss_sp = probe_stack;
+    probe_context.uc_stack.ss_size = sizeof(probe_stack);
+    probe_context.uc_link = &main_context;
+    makecontext(&probe_context, probe_entry, 0);
+    swapcontext(&main_context, &probe_context);
+
+    while ((untouched < sizeof(probe_stack)) && (probe_stack[untouched] == 0xA5)){
+
+        untouched++;
+    }
+
+    return sizeof(probe_stack) - untouched;
+}
+
+static void probe_PIDvalue(void){
+
+    tOBDValue value;
+
+    read_PIDvalue(REMOTE_REQUEST_ID, ECM_RESPONSE, 4, &value);
+}
+
+static void probe_DTCs(void){
+
+    char codes[OBD_MAX_DTCS][NUM_CHAR_DTC+1];
+
+    read_DTCs(ECM_REQUEST, ECM_RESPONSE, 0x03, codes, OBD_MAX_DTCS);
+}
+
+static void probe_VIN(void){
+
+    char VIN[MAX_VIN_BYTES];
+
+    read_VIN(ECM_REQUEST, ECM_RESPONSE, VIN);
+}
+
+static void print_memory(void){
+
+    init_testECUs();
+    printf("Memory: %zu bytes of static state of the protocol (tOBDStats)\n", sizeof(tOBDStats));
+    printf("Stack on the PC with the HAL and the ECUs: read_PIDvalue %zu, read_DTCs %zu, read_VIN %zu bytes\n",
+           measure_stack(probe_PIDvalue), measure_stack(probe_DTCs), measure_stack(probe_VIN));
+}
+
+int main(int argc, char *argv[]){
+
+    uint32_t transactions = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_TRANSACTIONS;
+
+    if (transactions < 10){
+
+        transactions = 10;
+    }
+    test_liveData();
+    test_DTCsAndVIN();
+    test_format();
+    test_errors();
+    benchmark(transactions);
+    print_memory();
+
+    if (failures > 0){
+
+        printf("%u checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("OBD protocol correct\n");
+
+    return EXIT_SUCCESS;
+}
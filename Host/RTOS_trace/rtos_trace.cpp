@@ -0,0 +1,542 @@
+/*
+ * rtos_trace.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C++ libraries
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iterator>
+
+// Programmer libraries
+#include "rtos_trace.hpp"
+
+#define TID_ISR 100                         // Tracks: task number, 100 + ISR, 200 + probe
+#define TID_PROBE 200
+#define MAX_PENDING_SENDS 64                // Per queue, the ones nobody received are dropped
+
+namespace rtos_trace {
+
+static void decode_packet(const std::vector<uint8_t> &packet, Trace &trace, ReadStats &stats, uint64_t &last,
+                          bool &has_time){
+
+    const uint8_t *payload = packet.data() + 3;
+    uint8_t length = packet[2];
+
+    switch (packet[1]){
+
+    case TRACE_PACKET_INFO:
+        if (length >= 4){
+
+            trace.counter_hz = payload[0] | (payload[1] << 8) | (payload[2] << 16) | ((uint32_t)payload[3] << 24);
+        }
+        break;
+
+    case TRACE_PACKET_NAME:
+        if (length >= 2){
+
+            std::string name(payload + 2, payload + length);
+
+            if (payload[0] == TRACE_NAME_TASK){
+
+                trace.tasks[payload[1]] = name;
+            }else if (payload[0] == TRACE_NAME_ISR){
+
+                trace.ISRs[payload[1]] = name;
+            }else if (payload[0] == TRACE_NAME_PROBE){
+
+                trace.probes[payload[1]] = name;
+            }
+        }
+        break;
+
+    case TRACE_PACKET_EVENTS:
+        for (size_t i = 0; i + TRACE_EVENT_BYTES <= length; i += TRACE_EVENT_BYTES){
+
+            const uint8_t *bytes = payload + i;
+            uint32_t time = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+            Event event;
+
+            // The counter wraps: the nearest time to the last one (the probes begin in the past)
+            event.time = has_time ? (last + (int64_t)(int32_t)(time - (uint32_t)last)) : time;
+            event.type = bytes[4];
+            event.object = bytes[5];
+            event.data = bytes[6] | (bytes[7] << 8);
+            last = event.time;
+            has_time = true;
+            if (event.type == TRACE_LOST){
+
+                stats.lost += event.data;
+            }
+            trace.events.push_back(event);
+            stats.events++;
+        }
+        break;
+
+    default:
+        stats.bad_packets++;
+        return;
+    }
+    stats.packets++;
+}
+
+void decode_stream(const std::vector<uint8_t> &bytes, Trace &trace, ReadStats &stats){
+
+    std::vector<uint8_t> chunk;
+    bool escaped = false, broken = false;
+    uint64_t last = 0;
+    bool has_time = false;
+
+    // What is between two END is a packet or text of the console
+    auto end_chunk = [&](){
+
+        if (!chunk.empty()){
+
+            if ((chunk[0] == TRACE_PACKET_MAGIC) && (chunk.size() >= 4) && (chunk.size() == 4u + chunk[2])){
+
+                uint8_t sum = 0;
+
+                for (size_t i = 1; i + 1 < chunk.size(); i++){
+
+                    sum += chunk[i];
+                }
+                if (broken || (sum != chunk.back())){
+
+                    stats.bad_packets++;
+                }else {
+
+                    decode_packet(chunk, trace, stats, last, has_time);
+                }
+            }else {
+
+                stats.text_bytes += chunk.size();
+            }
+        }
+        chunk.clear();
+        escaped = false;
+        broken = false;
+    };
+
+    stats.bytes += bytes.size();
+    for (uint8_t byte : bytes){
+
+        if (byte == TRACE_SLIP_END){
+
+            end_chunk();
+        }else if (escaped){
+
+            escaped = false;
+            if (byte == TRACE_SLIP_ESC_END){
+
+                chunk.push_back(TRACE_SLIP_END);
+            }else if (byte == TRACE_SLIP_ESC_ESC){
+
+                chunk.push_back(TRACE_SLIP_ESC);
+            }else if (byte == TRACE_SLIP_ESC_LF){
+
+                chunk.push_back('\n');
+            }else {
+
+                broken = true;
+                chunk.push_back(byte);
+            }
+        }else if (byte == TRACE_SLIP_ESC){
+
+            escaped = true;
+        }else {
+
+            chunk.push_back(byte);
+        }
+    }
+    // A packet cut at the end of the capture is left out
+    chunk.clear();
+}
+
+bool read_stream(const std::string &path, Trace &trace, ReadStats &stats){
+
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file){
+
+        fprintf(stderr, "Can not open %s\n", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    decode_stream(bytes, trace, stats);
+
+    return true;
+}
+
+std::vector<uint8_t> encode_packet(tTracePacket kind, const std::vector<uint8_t> &payload){
+
+    std::vector<uint8_t> packet = {TRACE_PACKET_MAGIC, (uint8_t)kind, (uint8_t)payload.size()};
+    std::vector<uint8_t> frame = {TRACE_SLIP_END};
+    uint8_t sum = 0;
+
+    packet.insert(packet.end(), payload.begin(), payload.end());
+    for (size_t i = 1; i < packet.size(); i++){
+
+        sum += packet[i];
+    }
+    packet.push_back(sum);
+    for (uint8_t byte : packet){
+
+        if (byte == TRACE_SLIP_END){
+
+            frame.insert(frame.end(), {TRACE_SLIP_ESC, TRACE_SLIP_ESC_END});
+        }else if (byte == TRACE_SLIP_ESC){
+
+            frame.insert(frame.end(), {TRACE_SLIP_ESC, TRACE_SLIP_ESC_ESC});
+        }else if (byte == '\n'){
+
+            frame.insert(frame.end(), {TRACE_SLIP_ESC, TRACE_SLIP_ESC_LF});
+        }else {
+
+            frame.push_back(byte);
+        }
+    }
+    frame.push_back(TRACE_SLIP_END);
+
+    return frame;
+}
+
+
+// Walk of the events in time order, writing the JSON
+namespace {
+
+struct Send{
+
+    double us;
+    std::string context;
+    uint64_t flow;
+};
+
+class Walk{
+
+public:
+    Walk(const Trace &trace, Summary &summary) : trace_(trace), summary_(summary){}
+
+    std::string run(void){
+
+        std::vector<Event> events = trace_.events;
+
+        std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b){ return a.time < b.time; });
+        json_ = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        metadata();
+        if (!events.empty()){
+
+            first_ = events.front().time;
+            for (const Event &event : events){
+
+                step(event);
+            }
+            double end = us(events.back().time);
+
+            close_task(end);
+            summary_.length_us = end;
+        }
+        for (const auto &hop : hops_){
+
+            summary_.hops.push_back(hop.second);
+        }
+        json_ += "]}\n";
+
+        return json_;
+    }
+
+private:
+    const Trace &trace_;
+    Summary &summary_;
+    std::string json_;
+    bool first_record_ = true;
+    uint64_t first_ = 0;
+    int task_ = -1;                                     // Running task
+    double task_since_ = 0;
+    std::vector<std::pair<uint8_t, double>> ISRs_;      // Nested interrupts
+    std::map<uint8_t, std::vector<double>> probes_;
+    std::map<uint8_t, std::deque<Send>> queue_sends_;
+    std::map<uint8_t, Send> bits_set_;
+    std::map<std::string, Hop> hops_;
+    uint64_t flows_ = 0;
+
+    double us(uint64_t time) const{
+
+        return (trace_.counter_hz == 0) ? (double)(time - first_) : (time - first_)*1e6/trace_.counter_hz;
+    }
+
+    static std::string name_of(const std::map<uint8_t, std::string> &names, const char *kind, uint8_t number){
+
+        auto found = names.find(number);
+
+        return (found != names.end()) ? found->second : (std::string(kind) + " " + std::to_string(number));
+    }
+
+    static std::string quoted(const std::string &text){
+
+        std::string out = "\"";
+
+        for (char c : text){
+
+            if ((c == '"') || (c == '\\')){
+
+                out += '\\';
+            }
+            out += ((unsigned char)c < 0x20) ? ' ' : c;
+        }
+
+        return out + "\"";
+    }
+
+    void record(const std::string &fields){
+
+        json_ += first_record_ ? "{" : ",\n{";
+        json_ += fields + "}";
+        first_record_ = false;
+    }
+
+    static std::string number(double value){
+
+        char text[32];
+
+        snprintf(text, sizeof(text), "%.3f", value);
+        return text;
+    }
+
+    void thread(int tid, const std::string &name, int sort){
+
+        record("\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid) + ",\"name\":\"thread_name\",\"args\":{\"name\":" +
+               quoted(name) + "}");
+        record("\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid) +
+               ",\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":" + std::to_string(sort) + "}");
+    }
+
+    void metadata(void){
+
+        record("\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"Tiva\"}");
+        for (const auto &ISR : trace_.ISRs){
+
+            thread(TID_ISR + ISR.first, "ISR " + ISR.second, ISR.first);
+        }
+        for (const auto &task : trace_.tasks){
+
+            thread(task.first, task.second, 100 + task.first);
+        }
+        for (const auto &probe : trace_.probes){
+
+            thread(TID_PROBE + probe.first, "Probe " + probe.second, 200 + probe.first);
+        }
+    }
+
+    void slice(int tid, const std::string &name, double start, double end){
+
+        record("\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(tid) + ",\"name\":" + quoted(name) + ",\"ts\":" +
+               number(start) + ",\"dur\":" + number(end - start));
+    }
+
+    void instant(int tid, const std::string &name, double at, const std::string &args){
+
+        record("\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":" + std::to_string(tid) + ",\"name\":" + quoted(name) +
+               ",\"ts\":" + number(at) + ",\"args\":{" + args + "}");
+    }
+
+    void flow(char phase, uint64_t id, int tid, const std::string &name, double at){
+
+        record(std::string("\"ph\":\"") + phase + "\",\"cat\":\"flow\",\"id\":" + std::to_string(id) + ",\"pid\":1,\"tid\":" +
+               std::to_string(tid) + ",\"name\":" + quoted(name) + ",\"ts\":" + number(at) + ((phase == 'f') ? ",\"bp\":\"e\"" : ""));
+    }
+
+    static void add(Slices &slices, double us){
+
+        slices.count++;
+        slices.sum_us += us;
+        slices.max_us = std::max(slices.max_us, us);
+    }
+
+    // Interrupt or task the event comes from (track 0 before the first switch)
+    int context_tid(void) const{
+
+        return ISRs_.empty() ? std::max(task_, 0) : (TID_ISR + ISRs_.back().first);
+    }
+
+    std::string context_name(void) const{
+
+        if (!ISRs_.empty()){
+
+            return name_of(trace_.ISRs, "ISR", ISRs_.back().first);
+        }
+
+        return (task_ < 0) ? "Start" : name_of(trace_.tasks, "Task", (uint8_t)task_);
+    }
+
+    void close_task(double at){
+
+        if (task_ >= 0){
+
+            std::string name = name_of(trace_.tasks, "Task", (uint8_t)task_);
+
+            slice(task_, name, task_since_, at);
+            add(summary_.tasks[name], at - task_since_);
+        }
+    }
+
+    void hop(const Send &send, const std::string &object, double at){
+
+        Hop &hop = hops_[send.context + "|" + context_name() + "|" + object];
+
+        hop.from = send.context;
+        hop.to = context_name();
+        hop.object = object;
+        hop.count++;
+        hop.sum_us += at - send.us;
+        hop.max_us = std::max(hop.max_us, at - send.us);
+        flow('f', send.flow, context_tid(), object, at);
+    }
+
+    void step(const Event &event){
+
+        double at = us(event.time);
+        std::string queue = "Queue " + std::to_string(event.object);
+        std::string group = "Event group " + std::to_string(event.object);
+
+        switch (event.type){
+
+        case TRACE_TASK_IN:
+            close_task(at);
+            task_ = event.object;
+            task_since_ = at;
+            break;
+
+        case TRACE_ISR_ENTER:
+            ISRs_.push_back({event.object, at});
+            break;
+
+        case TRACE_ISR_EXIT:
+            for (size_t i = ISRs_.size(); i-- > 0;){
+
+                if (ISRs_[i].first == event.object){
+
+                    std::string name = name_of(trace_.ISRs, "ISR", event.object);
+
+                    slice(TID_ISR + event.object, name, ISRs_[i].second, at);
+                    add(summary_.ISRs[name], at - ISRs_[i].second);
+                    ISRs_.erase(ISRs_.begin() + i);
+                    break;
+                }
+            }
+            break;
+
+        case TRACE_PROBE_BEGIN:
+            probes_[event.object].push_back(at);
+            break;
+
+        case TRACE_PROBE_END:
+            if (!probes_[event.object].empty()){
+
+                std::string name = name_of(trace_.probes, "Probe", event.object);
+                double start = probes_[event.object].back();
+
+                probes_[event.object].pop_back();
+                slice(TID_PROBE + event.object, name, start, at);
+                add(summary_.probes[name], at - start);
+            }
+            break;
+
+        case TRACE_QUEUE_SEND:{
+
+            std::deque<Send> &sends = queue_sends_[event.object];
+
+            instant(context_tid(), queue + " send", at, "");
+            sends.push_back({at, context_name(), ++flows_});
+            flow('s', flows_, context_tid(), queue, at);
+            if (sends.size() > MAX_PENDING_SENDS){
+
+                sends.pop_front();
+            }
+            break;
+        }
+
+        case TRACE_QUEUE_RECEIVE:{
+
+            std::deque<Send> &sends = queue_sends_[event.object];
+
+            instant(context_tid(), queue + " receive", at, "");
+            if (!sends.empty()){
+
+                hop(sends.front(), queue, at);
+                sends.pop_front();
+            }
+            break;
+        }
+
+        case TRACE_QUEUE_BLOCK:
+            instant(context_tid(), queue + (event.data ? " blocked sending" : " blocked receiving"), at, "");
+            break;
+
+        case TRACE_EVENT_SET:
+            instant(context_tid(), group + " set", at, "\"bits\":" + std::to_string(event.data));
+            bits_set_[event.object] = {at, context_name(), ++flows_};
+            flow('s', flows_, context_tid(), group, at);
+            break;
+
+        case TRACE_EVENT_WAIT:
+            instant(context_tid(), group + " wait", at, "\"bits\":" + std::to_string(event.data));
+            break;
+
+        case TRACE_EVENT_WAIT_END:{
+
+            auto set = bits_set_.find(event.object);
+
+            instant(context_tid(), group + (event.data ? " timeout" : " wait end"), at, "");
+            if ((!event.data) && (set != bits_set_.end())){
+
+                hop(set->second, group, at);
+                bits_set_.erase(set);
+            }
+            break;
+        }
+
+        case TRACE_LOST:
+            record("\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"name\":\"Lost " + std::to_string(event.data) +
+                   " events\",\"ts\":" + number(at));
+            break;
+
+        default:
+            break;
+        }
+    }
+};
+
+} // namespace
+
+std::string chrome_json(const Trace &trace, Summary &summary){
+
+    return Walk(trace, summary).run();
+}
+
+bool write_chrome(const std::string &path, const Trace &trace, Summary &summary){
+
+    std::string json = chrome_json(trace, summary);
+    FILE *file = fopen(path.c_str(), "w");
+
+    if (file == nullptr){
+
+        fprintf(stderr, "Can not write %s\n", path.c_str());
+        return false;
+    }
+    bool ok = (fwrite(json.data(), 1, json.size(), file) == json.size());
+
+    ok = (fclose(file) == 0) && ok;
+
+    return ok;
+}
+
+} // namespace rtos_trace
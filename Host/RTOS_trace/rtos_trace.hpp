@@ -0,0 +1,90 @@
+/*
+ * rtos_trace.hpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      The stream of the trace of the scheduler that the firmware sends on UART0
+ *      (Software/Trace_recorder.h): packets framed like SLIP among the texts of the console.
+ *      The events are turned into the trace format of Chrome (JSON, opened by Perfetto and
+ *      chrome://tracing): a track for every task, interrupt and probe, the queues and event
+ *      groups as instants, and an arrow from every send (or set bits) to the receive that takes
+ *      it. The same walk gives the latencies of every hop.
+ *      The times of the events are counts of the counter of the INFO packet (the CPU clock on
+ *      the Tiva, ns on the firmware simulator), unwrapped to 64 bits.
+ */
+
+#ifndef RTOS_TRACE_HPP_
+#define RTOS_TRACE_HPP_
+
+// C++ libraries
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "Trace_recorder.h"
+
+namespace rtos_trace {
+
+struct Event{
+
+    uint64_t time;              // Counts, unwrapped
+    uint8_t type;               // tTraceEvent
+    uint8_t object;
+    uint16_t data;
+};
+
+struct Trace{
+
+    uint32_t counter_hz = 0;
+    std::map<uint8_t, std::string> tasks, ISRs, probes;
+    std::vector<Event> events;  // In the order of the stream
+};
+
+struct ReadStats{
+
+    uint64_t bytes = 0;
+    uint64_t packets = 0;
+    uint64_t events = 0;
+    uint64_t text_bytes = 0;    // Texts of the console between the packets
+    uint64_t bad_packets = 0;   // Wrong escape, length or sum
+    uint64_t lost = 0;          // Events the firmware could not keep (TRACE_LOST)
+};
+
+// Latency of a hop: from a send (or set bits) to the receive (or end of the wait) that takes it
+struct Hop{
+
+    std::string from, to, object;
+    uint64_t count = 0;
+    double sum_us = 0, max_us = 0;
+};
+
+struct Slices{
+
+    uint64_t count = 0;
+    double sum_us = 0, max_us = 0;
+};
+
+struct Summary{
+
+    double length_us = 0;
+    std::map<std::string, Slices> tasks, ISRs, probes;
+    std::vector<Hop> hops;
+};
+
+// Bytes of UART0 as they come (uartstdio adds '\r' before every '\n' of the texts)
+void decode_stream(const std::vector<uint8_t> &bytes, Trace &trace, ReadStats &stats);
+bool read_stream(const std::string &path, Trace &trace, ReadStats &stats);
+
+// Packet of the firmware as it goes on UART0 (for the tests)
+std::vector<uint8_t> encode_packet(tTracePacket kind, const std::vector<uint8_t> &payload);
+
+std::string chrome_json(const Trace &trace, Summary &summary);
+bool write_chrome(const std::string &path, const Trace &trace, Summary &summary);
+
+} // namespace rtos_trace
+
+#endif /* RTOS_TRACE_HPP_ */
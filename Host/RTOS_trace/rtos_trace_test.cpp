@@ -0,0 +1,295 @@
+/*
+ * rtos_trace_test.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host test of the trace converter. A stream like the one of the firmware is generated:
+ *      a CAN interrupt that asks the timer task to set the bits of the event group, the timer
+ *      task that sets them, the protocol task that wakes up and draws a text, and the Idle task.
+ *      The counter (50 MHz) wraps in the middle, the texts of the console (with the '\r' of
+ *      uartstdio) go between the packets, the bytes that need an escape are in the events, a
+ *      packet has a wrong sum and the firmware reports lost events. The latencies of the
+ *      summary must be the ones of the generation, and the JSON must have every slice and
+ *      arrow. Then the conversion speed is measured.
+ *
+ *      Build and run (from this folder):
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -o rtos_trace_test rtos_trace_test.cpp rtos_trace.cpp
+ *          ./rtos_trace_test [cycles]
+ */
+
+// C++ libraries
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Programmer libraries
+#include "rtos_trace.hpp"
+
+#define COUNTER_HZ 50000000
+#define CYCLE_COUNTS 500000                 // 10 ms between two CAN frames
+#define TASK_IDLE 1
+#define TASK_TIMER 2
+#define TASK_PROTOCOL 3
+#define QUEUE_TIMER 1
+#define GROUP_CAN 0xC0                      // An object number that needs an escape
+#define PROBE_TEXT 3
+#define LOST_EVENTS 7
+
+// Counts from the CAN interrupt (the expected latencies)
+#define ISR_LENGTH 500                      // 10 us
+#define TIMER_IN 800
+#define TIMER_RECEIVE 900                   // Queue: 18 us from the send in the ISR
+#define TIMER_SET 1000
+#define PROTOCOL_IN 1200
+#define PROTOCOL_WAIT_END 1300              // Event group: 6 us from the set of the timer task
+#define TEXT_BEGIN 1400
+#define TEXT_LENGTH 10000                   // 200 us
+#define PROTOCOL_WAIT 12000
+#define IDLE_IN 12100
+
+static std::vector<uint8_t> stream;
+static std::vector<uint8_t> pending;
+
+static void add_event(uint32_t time, tTraceEvent type, uint8_t object, uint16_t data = 0){
+
+    std::vector<uint8_t> event = {(uint8_t)time, (uint8_t)(time >> 8), (uint8_t)(time >> 16), (uint8_t)(time >> 24),
+                                  (uint8_t)type, object, (uint8_t)data, (uint8_t)(data >> 8)};
+
+    pending.insert(pending.end(), event.begin(), event.end());
+    if (pending.size() == 24*TRACE_EVENT_BYTES){
+
+        std::vector<uint8_t> packet = rtos_trace::encode_packet(TRACE_PACKET_EVENTS, pending);
+
+        stream.insert(stream.end(), packet.begin(), packet.end());
+        pending.clear();
+    }
+}
+
+static void add_name(tTraceName kind, uint8_t number, const std::string &name){
+
+    std::vector<uint8_t> payload = {(uint8_t)kind, number};
+    std::vector<uint8_t> packet;
+
+    payload.insert(payload.end(), name.begin(), name.end());
+    packet = rtos_trace::encode_packet(TRACE_PACKET_NAME, payload);
+    stream.insert(stream.end(), packet.begin(), packet.end());
+}
+
+// Console text, as uartstdio sends it
+static void add_text(const std::string &text){
+
+    for (char c : text){
+
+        if (c == '\n'){
+
+            stream.push_back('\r');
+        }
+        stream.push_back((uint8_t)c);
+    }
+}
+
+static void generate(uint32_t cycles){
+
+    std::vector<uint8_t> info = {(uint8_t)COUNTER_HZ, (uint8_t)(COUNTER_HZ >> 8), (uint8_t)(COUNTER_HZ >> 16),
+                                 (uint8_t)(COUNTER_HZ >> 24)};
+    std::vector<uint8_t> packet = rtos_trace::encode_packet(TRACE_PACKET_INFO, info);
+    // Half of the cycles before the wrap of the counter
+    uint32_t start = 0u - (cycles/2)*CYCLE_COUNTS;
+
+    stream.clear();
+    add_text("Probes reset\n");
+    stream.insert(stream.end(), packet.begin(), packet.end());
+    add_name(TRACE_NAME_TASK, TASK_IDLE, "IDLE");
+    add_name(TRACE_NAME_TASK, TASK_TIMER, "Tmr Svc");
+    add_name(TRACE_NAME_TASK, TASK_PROTOCOL, "LIVE_DATA");
+    add_name(TRACE_NAME_ISR, TRACE_ISR_CAN, "CAN");
+    add_name(TRACE_NAME_PROBE, PROBE_TEXT, "LCD text");
+    add_event(start, TRACE_TASK_IN, TASK_IDLE);
+    for (uint32_t i = 0; i < cycles; i++){
+
+        uint32_t t = start + 1000 + i*CYCLE_COUNTS;
+
+        add_event(t, TRACE_ISR_ENTER, TRACE_ISR_CAN);
+        add_event(t + 100, TRACE_QUEUE_SEND, QUEUE_TIMER);
+        add_event(t + 100, TRACE_EVENT_SET, GROUP_CAN, 0x0A0D);
+        add_event(t + ISR_LENGTH, TRACE_ISR_EXIT, TRACE_ISR_CAN);
+        add_event(t + TIMER_IN, TRACE_TASK_IN, TASK_TIMER);
+        add_event(t + TIMER_RECEIVE, TRACE_QUEUE_RECEIVE, QUEUE_TIMER);
+        add_event(t + TIMER_SET, TRACE_EVENT_SET, GROUP_CAN, 0x0A0D);
+        add_event(t + PROTOCOL_IN, TRACE_TASK_IN, TASK_PROTOCOL);
+        add_event(t + PROTOCOL_WAIT_END, TRACE_EVENT_WAIT_END, GROUP_CAN, 0);
+        // The probe comes at its end, with the time of its beginning
+        add_event(t + TEXT_BEGIN, TRACE_PROBE_BEGIN, PROBE_TEXT);
+        add_event(t + TEXT_BEGIN + TEXT_LENGTH, TRACE_PROBE_END, PROBE_TEXT);
+        add_event(t + PROTOCOL_WAIT, TRACE_EVENT_WAIT, GROUP_CAN, 0x0A0D);
+        add_event(t + IDLE_IN, TRACE_TASK_IN, TASK_IDLE);
+        if (i == cycles/3){
+
+            add_event(t + IDLE_IN + 1, TRACE_LOST, 0, LOST_EVENTS);
+        }
+        if (i % 1000 == 0){
+
+            add_text("     Count        Min       Mean        Max    Mean ns  Probe\n");
+        }
+    }
+    add_event(start + cycles*CYCLE_COUNTS, TRACE_TASK_IN, TASK_TIMER);
+    // Whatever is left (the last packet of events)
+    if (!pending.empty()){
+
+        packet = rtos_trace::encode_packet(TRACE_PACKET_EVENTS, pending);
+        stream.insert(stream.end(), packet.begin(), packet.end());
+        pending.clear();
+    }
+}
+
+static int check(bool condition, const char *what){
+
+    if (!condition){
+
+        fprintf(stderr, "Wrong: %s\n", what);
+        return 1;
+    }
+
+    return 0;
+}
+
+static bool near(double value, double expected){
+
+    return std::fabs(value - expected) < 0.01;
+}
+
+static const rtos_trace::Hop *find_hop(const rtos_trace::Summary &summary, const std::string &from, const std::string &to){
+
+    for (const rtos_trace::Hop &hop : summary.hops){
+
+        if ((hop.from == from) && (hop.to == to)){
+
+            return &hop;
+        }
+    }
+
+    return nullptr;
+}
+
+static size_t count_of(const std::string &text, const std::string &part){
+
+    size_t count = 0;
+
+    for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1)){
+
+        count++;
+    }
+
+    return count;
+}
+
+int main(int argc, char *argv[]){
+
+    uint32_t cycles = (argc > 1) ? strtoul(argv[1], nullptr, 0) : 20000;
+    int errors = 0;
+
+    if (cycles < 10){
+
+        fprintf(stderr, "Usage: %s [cycles], at least 10\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    generate(cycles);
+
+    // Clean stream
+    {
+        rtos_trace::Trace trace;
+        rtos_trace::ReadStats stats;
+        rtos_trace::Summary summary;
+        uint64_t events = 1 + 13ull*cycles + 1 + 1;
+
+        rtos_trace::decode_stream(stream, trace, stats);
+        std::string json = rtos_trace::chrome_json(trace, summary);
+
+        errors += check(stats.events == events, "number of events");
+        errors += check(stats.bad_packets == 0, "no bad packets");
+        errors += check(stats.lost == LOST_EVENTS, "lost events");
+        errors += check(stats.text_bytes > 0, "texts of the console");
+        errors += check(trace.counter_hz == COUNTER_HZ, "counter");
+        errors += check((trace.tasks.size() == 3) && (trace.tasks[TASK_PROTOCOL] == "LIVE_DATA"), "names of the tasks");
+        errors += check(trace.events.back().time > UINT32_MAX, "unwrapped times");
+        errors += check(near(summary.length_us, (double)cycles*CYCLE_COUNTS*1e6/COUNTER_HZ), "length of the trace");
+
+        const rtos_trace::Slices &ISR = summary.ISRs["CAN"];
+        errors += check((ISR.count == cycles) && near(ISR.max_us, 10.0) && near(ISR.sum_us/ISR.count, 10.0), "CAN interrupt");
+        const rtos_trace::Slices &text = summary.probes["LCD text"];
+        errors += check((text.count == cycles) && near(text.sum_us/text.count, 200.0), "probe");
+        const rtos_trace::Slices &protocol = summary.tasks["LIVE_DATA"];
+        errors += check((protocol.count == cycles) && near(protocol.max_us, (IDLE_IN - PROTOCOL_IN)*1e6/COUNTER_HZ),
+                        "protocol task");
+
+        const rtos_trace::Hop *queue = find_hop(summary, "CAN", "Tmr Svc");
+        errors += check((queue != nullptr) && (queue->count == cycles) && (queue->object == "Queue 1") &&
+                        near(queue->max_us, (TIMER_RECEIVE - 100)*1e6/COUNTER_HZ), "hop of the timer queue");
+        const rtos_trace::Hop *group = find_hop(summary, "Tmr Svc", "LIVE_DATA");
+        errors += check((group != nullptr) && (group->count == cycles) && (group->object == "Event group 192") &&
+                        near(group->max_us, (PROTOCOL_WAIT_END - TIMER_SET)*1e6/COUNTER_HZ), "hop of the event group");
+        // The set of the ISR is taken over by the one of the timer task
+        errors += check(find_hop(summary, "CAN", "LIVE_DATA") == nullptr, "no hop from the set of the ISR");
+
+        errors += check((json.front() == '{') && (json.find("]}") != std::string::npos), "JSON");
+        // Tasks (every switch and the last one), interrupts and probes
+        errors += check(count_of(json, "\"ph\":\"X\"") == (3ull*cycles + 2) + 2ull*cycles, "slices");
+        errors += check(count_of(json, "\"ph\":\"f\"") == 2ull*cycles, "arrows");
+        errors += check(count_of(json, "{") == count_of(json, "}"), "braces");
+        errors += check(json.find("\"name\":\"ISR CAN\"") != std::string::npos, "track of the interrupt");
+        errors += check(json.find("Lost 7 events") != std::string::npos, "lost events on the trace");
+    }
+
+    // A packet with a wrong sum: its events are left out
+    {
+        std::vector<uint8_t> broken = stream;
+        rtos_trace::Trace trace;
+        rtos_trace::ReadStats stats;
+        size_t at = broken.size()/2;
+
+        // A packet of events
+        while ((broken[at] != TRACE_SLIP_END) || (broken[at + 1] != TRACE_PACKET_MAGIC) ||
+               (broken[at + 2] != TRACE_PACKET_EVENTS)){
+
+            at++;
+        }
+        // A byte of its events that is not part of an escape (its length and sum are right)
+        at += 5;
+        while ((broken[at] == TRACE_SLIP_ESC) || (broken[at - 1] == TRACE_SLIP_ESC) ||
+               ((broken[at] ^ 0x01) == TRACE_SLIP_END) || ((broken[at] ^ 0x01) == TRACE_SLIP_ESC)){
+
+            at++;
+        }
+        broken[at] ^= 0x01;
+        rtos_trace::decode_stream(broken, trace, stats);
+        errors += check((stats.bad_packets == 1) && (stats.events == 1 + 13ull*cycles + 2 - 24), "wrong sum");
+    }
+
+    // Speed
+    {
+        rtos_trace::Trace trace;
+        rtos_trace::ReadStats stats;
+        rtos_trace::Summary summary;
+        auto start = std::chrono::steady_clock::now();
+
+        rtos_trace::decode_stream(stream, trace, stats);
+        std::string json = rtos_trace::chrome_json(trace, summary);
+        double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("%llu events (%.0f s of trace, %zu bytes of stream) to %zu bytes of JSON in %.1f ms: %.2f M events/s\n",
+               (unsigned long long)stats.events, summary.length_us/1e6, stream.size(), json.size(), wall_s*1000,
+               stats.events/wall_s/1e6);
+    }
+
+    printf("%s\n", (errors == 0) ? "Trace converter correct" : "Trace converter with errors");
+
+    return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,83 @@
+/*
+ * rtos_trace_tool.cpp
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      Converts a capture of UART0 with the stream of the trace (Software/Trace_recorder.h) into
+ *      a trace of Chrome (open it on https://ui.perfetto.dev or chrome://tracing) and prints
+ *      where the time goes: the tasks, the interrupts, the probes and every hop from a send
+ *      (or set bits) to the receive that takes it.
+ *
+ *      Capture: 115200 8N1 raw, then 'trace on' and 'trace off' on the shell of the console. The
+ *      firmware simulator writes the same stream with -r.
+ *
+ *      Build and run (from this folder):
+ *          c++ -std=c++17 -O2 -Wall -I../../Software -o rtos_trace rtos_trace_tool.cpp rtos_trace.cpp
+ *          stty -F /dev/ttyACM0 115200 raw && cat /dev/ttyACM0 > capture.bin
+ *          ./rtos_trace capture.bin trace.json
+ */
+
+// C++ libraries
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Programmer libraries
+#include "rtos_trace.hpp"
+
+static void print_slices(const char *title, const std::map<std::string, rtos_trace::Slices> &slices, double length_us){
+
+    printf("%s\n", title);
+    for (const auto &entry : slices){
+
+        const rtos_trace::Slices &item = entry.second;
+
+        printf("  %-14s %8llu  mean %10.1f us  max %10.1f us  %5.1f %%\n", entry.first.c_str(),
+               (unsigned long long)item.count, item.sum_us/item.count, item.max_us,
+               (length_us > 0) ? 100.0*item.sum_us/length_us : 0.0);
+    }
+}
+
+int main(int argc, char *argv[]){
+
+    rtos_trace::Trace trace;
+    rtos_trace::ReadStats stats;
+    rtos_trace::Summary summary;
+
+    if (argc < 3){
+
+        fprintf(stderr, "Usage: %s capture trace.json\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!rtos_trace::read_stream(argv[1], trace, stats) || !rtos_trace::write_chrome(argv[2], trace, summary)){
+
+        return EXIT_FAILURE;
+    }
+
+    printf("%llu bytes: %llu packets, %llu events, %llu bytes of text, %llu bad packets, %llu events lost\n",
+           (unsigned long long)stats.bytes, (unsigned long long)stats.packets, (unsigned long long)stats.events,
+           (unsigned long long)stats.text_bytes, (unsigned long long)stats.bad_packets, (unsigned long long)stats.lost);
+    if (trace.counter_hz == 0){
+
+        fprintf(stderr, "No INFO packet: the times are in counts, not in us\n");
+    }
+    printf("%.3f ms of trace, counter of %u Hz\n", summary.length_us/1000, trace.counter_hz);
+    print_slices("Tasks (running):", summary.tasks, summary.length_us);
+    print_slices("Interrupts:", summary.ISRs, summary.length_us);
+    print_slices("Probes:", summary.probes, summary.length_us);
+
+    // The slowest hops first
+    std::sort(summary.hops.begin(), summary.hops.end(), [](const rtos_trace::Hop &a, const rtos_trace::Hop &b){
+        return a.sum_us/a.count > b.sum_us/b.count;
+    });
+    printf("Hops (send or set bits -> receive or end of the wait):\n");
+    for (const rtos_trace::Hop &hop : summary.hops){
+
+        printf("  %-14s -> %-14s %-15s %8llu  mean %10.1f us  max %10.1f us\n", hop.from.c_str(), hop.to.c_str(),
+               hop.object.c_str(), (unsigned long long)hop.count, hop.sum_us/hop.count, hop.max_us);
+    }
+
+    return EXIT_SUCCESS;
+}
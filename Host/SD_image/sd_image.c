@@ -0,0 +1,519 @@
+/*
+ * sd_image.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Block device on a disk image for the host tests of Software/SD_fat.c, a FAT32 formatter
+ *      (mkfs.fat is not needed) and a checker of the image. The checker reads the FAT on its
+ *      own, without the firmware code, so it does not share its mistakes.
+ */
+
+// C libraries
+#define _XOPEN_SOURCE 700
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Programmer libraries
+#include "SD_fat.h"
+#include "sd_image.h"
+
+#define SECTOR 512
+
+typedef struct{
+
+    uint32_t fat_lba;
+    uint32_t sectors_per_fat;
+    uint8_t num_fats;
+    uint8_t sectors_per_cluster;
+    uint32_t cluster_lba;
+    uint32_t root_cluster;
+    uint32_t num_clusters;
+    uint32_t fsinfo_lba;
+}tGeometry;
+
+// Global variables
+static int image = -1;
+static uint32_t stream_lba = 0;
+static bool streaming = false;       // Like the card: no other access until the stop
+tSDImageStats SD_imageStats;
+
+
+static uint32_t le32(const uint8_t *data){
+
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static uint16_t le16(const uint8_t *data){
+
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static void put32(uint8_t *data, uint32_t value){
+
+    for (int i = 0; i < 4; i++){
+
+        data[i] = (value >> (8*i)) & 0xFF;
+    }
+}
+
+static void put16(uint8_t *data, uint16_t value){
+
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+}
+
+static bool read_image(uint32_t lba, uint8_t *buffer, uint32_t count){
+
+    if (streaming){
+
+        SD_imageStats.stream_errors++;
+        return false;
+    }
+    SD_imageStats.reads++;
+    SD_imageStats.read_sectors += count;
+
+    return pread(image, buffer, (size_t)count*SECTOR, (off_t)lba*SECTOR) == (ssize_t)count*SECTOR;
+}
+
+static bool write_image(uint32_t lba, const uint8_t *buffer, uint32_t count){
+
+    if (streaming){
+
+        SD_imageStats.stream_errors++;
+        return false;
+    }
+    SD_imageStats.writes++;
+    SD_imageStats.write_sectors += count;
+    if (count > 1){
+
+        SD_imageStats.multi_writes++;
+    }
+
+    return pwrite(image, buffer, (size_t)count*SECTOR, (off_t)lba*SECTOR) == (ssize_t)count*SECTOR;
+}
+
+static bool start_stream(uint32_t lba){
+
+    if (streaming){
+
+        SD_imageStats.stream_errors++;
+        return false;
+    }
+    SD_imageStats.streams++;
+    stream_lba = lba;
+    streaming = true;
+
+    return true;
+}
+
+static bool write_stream(const uint8_t *buffer){
+
+    if (!streaming){
+
+        SD_imageStats.stream_errors++;
+        return false;
+    }
+    SD_imageStats.stream_sectors++;
+
+    return pwrite(image, buffer, SECTOR, (off_t)(stream_lba++)*SECTOR) == SECTOR;
+}
+
+static bool stop_stream(void){
+
+    if (!streaming){
+
+        SD_imageStats.stream_errors++;
+        return false;
+    }
+    streaming = false;
+
+    return true;
+}
+
+const tSDBlockDevice SD_image = {read_image, write_image, start_stream, write_stream, stop_stream};
+
+// Open an image, or create it with total_sectors (not 0)
+bool open_SDimage(const char path[], uint32_t total_sectors){
+
+    image = open(path, (total_sectors > 0) ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0644);
+    if (image < 0){
+
+        perror(path);
+        return false;
+    }
+    if ((total_sectors > 0) && (ftruncate(image, (off_t)total_sectors*SECTOR) != 0)){
+
+        perror(path);
+        return false;
+    }
+    memset(&SD_imageStats, 0, sizeof(SD_imageStats));
+    streaming = false;
+
+    return true;
+}
+
+void close_SDimage(void){
+
+    if (image >= 0){
+
+        close(image);
+        image = -1;
+    }
+}
+
+// MBR with one FAT32 (LBA) partition from SD_IMAGE_PARTITION_LBA to the end.
+// The image is new, so the sectors that are not written are already 0.
+bool format_SDimage(uint32_t total_sectors, uint8_t sectors_per_cluster){
+
+    uint8_t sector[SECTOR];
+    uint32_t partition_sectors = total_sectors - SD_IMAGE_PARTITION_LBA;
+    uint32_t sectors_per_fat = 1, previous = 0;
+    uint32_t clusters = 0;
+    uint32_t fat_lba = SD_IMAGE_PARTITION_LBA + SD_IMAGE_RESERVED_SECTORS;
+    uint32_t cluster_lba;
+
+    // The FAT has to cover the clusters that are left after the FATs
+    while (sectors_per_fat != previous){
+
+        previous = sectors_per_fat;
+        clusters = (partition_sectors - SD_IMAGE_RESERVED_SECTORS - SD_IMAGE_NUM_FATS*sectors_per_fat) / sectors_per_cluster;
+        sectors_per_fat = ((clusters + 2)*4 + SECTOR - 1) / SECTOR;
+    }
+    cluster_lba = fat_lba + SD_IMAGE_NUM_FATS*sectors_per_fat;
+    if (clusters < 65525){
+
+        fprintf(stderr, "Warning: %u clusters is FAT16 size for the PC\n", clusters);
+    }
+
+    // MBR
+    memset(sector, 0, SECTOR);
+    sector[446 + 4] = 0x0C;
+    put32(&sector[446 + 8], SD_IMAGE_PARTITION_LBA);
+    put32(&sector[446 + 12], partition_sectors);
+    put16(&sector[510], 0xAA55);
+    if (!write_image(0, sector, 1)){
+
+        return false;
+    }
+
+    // Boot sector and its copy
+    memset(sector, 0, SECTOR);
+    memcpy(sector, "\xEB\x58\x90" "MSWIN4.1", 11);
+    put16(&sector[11], SECTOR);
+    sector[13] = sectors_per_cluster;
+    put16(&sector[14], SD_IMAGE_RESERVED_SECTORS);
+    sector[16] = SD_IMAGE_NUM_FATS;
+    sector[21] = 0xF8;
+    put16(&sector[24], 63);
+    put16(&sector[26], 255);
+    put32(&sector[28], SD_IMAGE_PARTITION_LBA);
+    put32(&sector[32], partition_sectors);
+    put32(&sector[36], sectors_per_fat);
+    put32(&sector[44], 2);                      // Root directory
+    put16(&sector[48], 1);                      // FSInfo
+    put16(&sector[50], 6);                      // Copy of the boot sector
+    sector[64] = 0x80;
+    sector[66] = 0x29;
+    put32(&sector[67], 0x0BD2026);
+    memcpy(&sector[71], "OBD LOGGER FAT32   ", 19);
+    put16(&sector[510], 0xAA55);
+    if ((!write_image(SD_IMAGE_PARTITION_LBA, sector, 1)) || (!write_image(SD_IMAGE_PARTITION_LBA + 6, sector, 1))){
+
+        return false;
+    }
+
+    // FSInfo: the root directory uses cluster 2
+    memset(sector, 0, SECTOR);
+    put32(&sector[0], 0x41615252);
+    put32(&sector[484], 0x61417272);
+    put32(&sector[488], clusters - 1);
+    put32(&sector[492], 3);
+    put32(&sector[508], 0xAA550000);
+    if ((!write_image(SD_IMAGE_PARTITION_LBA + 1, sector, 1)) || (!write_image(SD_IMAGE_PARTITION_LBA + 7, sector, 1))){
+
+        return false;
+    }
+
+    // First sector of every FAT
+    memset(sector, 0, SECTOR);
+    put32(&sector[0], 0x0FFFFFF8);
+    put32(&sector[4], 0x0FFFFFFF);
+    put32(&sector[8], 0x0FFFFFFF);
+    for (int i = 0; i < SD_IMAGE_NUM_FATS; i++){
+
+        if (!write_image(fat_lba + i*sectors_per_fat, sector, 1)){
+
+            return false;
+        }
+    }
+
+    // Root directory with the volume label
+    memset(sector, 0, SECTOR);
+    memcpy(sector, "OBD LOGGER ", 11);
+    sector[11] = 0x08;
+    if (!write_image(cluster_lba, sector, 1)){
+
+        return false;
+    }
+
+    memset(&SD_imageStats, 0, sizeof(SD_imageStats));
+
+    return true;
+}
+
+// Geometry of the first partition, read again from the image
+static bool read_geometry(tGeometry *geometry){
+
+    uint8_t sector[SECTOR];
+    uint32_t partition_lba = 0;
+
+    if (!read_image(0, sector, 1)){
+
+        return false;
+    }
+    if (memcmp(&sector[82], "FAT32   ", 8) != 0){
+
+        partition_lba = le32(&sector[446 + 8]);
+        if (!read_image(partition_lba, sector, 1)){
+
+            return false;
+        }
+    }
+
+    geometry->sectors_per_cluster = sector[13];
+    geometry->num_fats = sector[16];
+    geometry->sectors_per_fat = le32(&sector[36]);
+    geometry->fat_lba = partition_lba + le16(&sector[14]);
+    geometry->cluster_lba = geometry->fat_lba + geometry->num_fats*geometry->sectors_per_fat;
+    geometry->root_cluster = le32(&sector[44]);
+    geometry->fsinfo_lba = partition_lba + le16(&sector[48]);
+    geometry->num_clusters = (le32(&sector[32]) - (geometry->cluster_lba - partition_lba)) / geometry->sectors_per_cluster;
+
+    return true;
+}
+
+static uint32_t *read_FAT(const tGeometry *geometry, uint8_t copy){
+
+    uint8_t *bytes = malloc((size_t)geometry->sectors_per_fat*SECTOR);
+    uint32_t *FAT = malloc((size_t)geometry->sectors_per_fat*SECTOR);
+
+    if ((bytes == NULL) || (FAT == NULL)
+            || (!read_image(geometry->fat_lba + copy*geometry->sectors_per_fat, bytes, geometry->sectors_per_fat))){
+
+        free(bytes);
+        free(FAT);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < geometry->sectors_per_fat*SECTOR/4; i++){
+
+        FAT[i] = le32(&bytes[4*i]) & 0x0FFFFFFF;
+    }
+    free(bytes);
+
+    return FAT;
+}
+
+static bool is_cluster(const tGeometry *geometry, uint32_t cluster){
+
+    return (cluster >= 2) && (cluster < geometry->num_clusters + 2);
+}
+
+// Read the chain of clusters from first. Return the number of clusters or -1 if the chain is broken.
+static long read_chain(const tGeometry *geometry, const uint32_t *FAT, uint32_t first, uint8_t *data, uint32_t size){
+
+    uint32_t cluster_bytes = geometry->sectors_per_cluster*SECTOR;
+    uint8_t *cluster_data = malloc(cluster_bytes);
+    uint32_t cluster = first;
+    uint32_t done = 0;
+    long length = 0;
+
+    while (is_cluster(geometry, cluster)){
+
+        if ((length > (long)geometry->num_clusters) || (cluster_data == NULL)){
+
+            length = -1;    // Loop
+            break;
+        }
+        if ((data != NULL) && (done < size)){
+
+            if (!read_image(geometry->cluster_lba + (cluster - 2)*geometry->sectors_per_cluster, cluster_data, geometry->sectors_per_cluster)){
+
+                length = -1;
+                break;
+            }
+            memcpy(data + done, cluster_data, (size - done < cluster_bytes) ? (size - done) : cluster_bytes);
+            done += (size - done < cluster_bytes) ? (size - done) : cluster_bytes;
+        }
+        length++;
+        cluster = FAT[cluster];
+    }
+    if ((length >= 0) && (cluster < 0x0FFFFFF8)){
+
+        length = -1;    // It does not end with end of chain
+    }
+    free(cluster_data);
+
+    return length;
+}
+
+// Read a file of the root directory ("BODY    TXT"). Return NULL if it is not there.
+uint8_t *read_SDimageFile(const char name[], uint32_t *size){
+
+    tGeometry geometry;
+    uint32_t *FAT;
+    uint8_t *root, *data = NULL;
+    long root_clusters;
+    uint32_t root_bytes;
+    uint32_t first;
+
+    if ((!read_geometry(&geometry)) || ((FAT = read_FAT(&geometry, 0)) == NULL)){
+
+        return NULL;
+    }
+
+    root_clusters = read_chain(&geometry, FAT, geometry.root_cluster, NULL, 0);
+    root_bytes = (root_clusters > 0) ? root_clusters*geometry.sectors_per_cluster*SECTOR : 0;
+    root = calloc(1, root_bytes + 1);
+    if ((root != NULL) && (root_bytes > 0)){
+
+        read_chain(&geometry, FAT, geometry.root_cluster, root, root_bytes);
+        for (uint32_t offset = 0; (offset < root_bytes) && (root[offset] != 0x00); offset += 32){
+
+            if ((root[offset] == 0xE5) || (root[offset + 11] & 0x08) || (memcmp(&root[offset], name, 11) != 0)){
+
+                continue;
+            }
+            *size = le32(&root[offset + 28]);
+            first = ((uint32_t)le16(&root[offset + 20]) << 16) | le16(&root[offset + 26]);
+            data = malloc(*size + 1);
+            if ((data != NULL) && (*size > 0)
+                    && (read_chain(&geometry, FAT, first, data, *size)
+                        != (long)((*size + geometry.sectors_per_cluster*SECTOR - 1) / (geometry.sectors_per_cluster*SECTOR)))){
+
+                fprintf(stderr, "%.11s: chain does not match the size\n", name);
+                free(data);
+                data = NULL;
+            }
+            break;
+        }
+    }
+    free(root);
+    free(FAT);
+
+    return data;
+}
+
+// The FAT copies are the same, every used cluster belongs to one chain of the root
+// directory and the free clusters of FSInfo are right
+bool check_SDimage(bool verbose){
+
+    tGeometry geometry;
+    uint32_t *FAT, *copy;
+    uint8_t *owner, *root;
+    uint8_t entry[32];
+    uint32_t used = 0, owned = 0, free_clusters;
+    uint8_t fsinfo[SECTOR];
+    long root_clusters;
+    bool correct = true;
+
+    if ((!read_geometry(&geometry)) || ((FAT = read_FAT(&geometry, 0)) == NULL)){
+
+        return false;
+    }
+    for (uint8_t i = 1; i < geometry.num_fats; i++){
+
+        copy = read_FAT(&geometry, i);
+        if ((copy == NULL) || (memcmp(FAT, copy, (size_t)geometry.sectors_per_fat*SECTOR) != 0)){
+
+            fprintf(stderr, "FAT %u is not the same as FAT 0\n", i);
+            correct = false;
+        }
+        free(copy);
+    }
+
+    owner = calloc(geometry.num_clusters + 2, 1);
+    root_clusters = read_chain(&geometry, FAT, geometry.root_cluster, NULL, 0);
+    root = calloc(1, root_clusters*geometry.sectors_per_cluster*SECTOR);
+    read_chain(&geometry, FAT, geometry.root_cluster, root, root_clusters*geometry.sectors_per_cluster*SECTOR);
+
+    // Mark the clusters of the root directory and of every file
+    for (long offset = -32; offset < root_clusters*geometry.sectors_per_cluster*SECTOR; offset += 32){
+
+        uint32_t cluster;
+
+        if (offset < 0){
+
+            cluster = geometry.root_cluster;
+        }else {
+
+            memcpy(entry, &root[offset], 32);
+            if (entry[0] == 0x00){
+
+                break;
+            }
+            if ((entry[0] == 0xE5) || (entry[11] == 0x0F) || (entry[11] & 0x08)){
+
+                continue;
+            }
+            cluster = ((uint32_t)le16(&entry[20]) << 16) | le16(&entry[26]);
+            if (verbose){
+
+                printf("  %.11s %8u bytes\n", entry, le32(&entry[28]));
+            }
+        }
+
+        while (is_cluster(&geometry, cluster)){
+
+            if (owner[cluster]){
+
+                fprintf(stderr, "Cluster %u is on two chains\n", cluster);
+                correct = false;
+                break;
+            }
+            owner[cluster] = 1;
+            owned++;
+            cluster = FAT[cluster];
+        }
+    }
+
+    for (uint32_t cluster = 2; cluster < geometry.num_clusters + 2; cluster++){
+
+        if (FAT[cluster] != 0){
+
+            used++;
+        }
+    }
+    if (used != owned){
+
+        fprintf(stderr, "%u clusters are used and %u belong to a file (lost clusters)\n", used, owned);
+        correct = false;
+    }
+
+    free_clusters = geometry.num_clusters - used;
+    if ((read_image(geometry.fsinfo_lba, fsinfo, 1)) && (le32(&fsinfo[488]) != 0xFFFFFFFF)
+            && (le32(&fsinfo[488]) != free_clusters)){
+
+        fprintf(stderr, "FSInfo: %u free clusters, FAT: %u\n", le32(&fsinfo[488]), free_clusters);
+        correct = false;
+    }
+    if (verbose){
+
+        printf("  %u of %u clusters used\n", used, geometry.num_clusters);
+    }
+
+    free(root);
+    free(owner);
+    free(FAT);
+
+    return correct;
+}
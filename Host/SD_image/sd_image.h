@@ -0,0 +1,47 @@
+/*
+ * sd_image.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef SD_IMAGE_H_
+#define SD_IMAGE_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Disk image on a file instead of the card. The image has an MBR and a FAT32 partition
+// like the cards formatted on the PC.
+#define SD_IMAGE_PARTITION_LBA 2048
+#define SD_IMAGE_RESERVED_SECTORS 32
+#define SD_IMAGE_NUM_FATS 2
+
+typedef struct{
+
+    uint32_t reads;             // Calls of the block device
+    uint32_t read_sectors;
+    uint32_t writes;
+    uint32_t write_sectors;
+    uint32_t multi_writes;      // Writes of more than one sector (CMD25)
+    uint32_t streams;           // Multiple block writes of the records
+    uint32_t stream_sectors;
+    uint32_t stream_errors;     // Other access with the stream open (or stream functions out of order)
+}tSDImageStats;
+
+extern const tSDBlockDevice SD_image;
+extern tSDImageStats SD_imageStats;
+
+bool open_SDimage(const char path[], uint32_t total_sectors);
+void close_SDimage(void);
+bool format_SDimage(uint32_t total_sectors, uint8_t sectors_per_cluster);
+uint8_t *read_SDimageFile(const char name[], uint32_t *size);
+bool check_SDimage(bool verbose);
+
+#endif /* SD_IMAGE_H_ */
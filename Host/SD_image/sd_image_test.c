@@ -0,0 +1,318 @@
+/*
+ * sd_image_test.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      Host test of the FAT32 append writer of the firmware (Software/SD_fat.c) on a disk image.
+ *      The image is formatted, then the DTC files and the session log are appended like the
+ *      SD writer task does (one open/close per report, files interleaved, some long records
+ *      across clusters), with a new mount from time to time, and a live data log of whole
+ *      sectors is written with checkpoints. Then the record files: a preallocated run written
+ *      on the stream with checkpoints and lines of the session log between them, a record
+ *      that fills its run and an empty one. At the end every file is read back by the
+ *      checker and compared with what was written, and the FAT is checked (the clusters
+ *      that the records did not use have to be free again).
+ *
+ *      Build and run (from this folder):
+ *          cc -O2 -Wall -I../../Software -o sd_image_test sd_image_test.c sd_image.c ../../Software/SD_fat.c
+ *          ./sd_image_test /tmp/sd.img [MB] [sectors per cluster]
+ *
+ *      The image can be copied on a card (dd) or opened on the PC to look at the files.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Programmer libraries
+#include "SD_fat.h"
+#include "sd_image.h"
+
+#define NUM_FILES 5
+#define ROUNDS 600
+#define REMOUNT_ROUNDS 50
+#define MAX_FILE_SIZE (1024*1024)
+#define LOG_NAME "LIVE0000BIN"
+#define LOG_BLOCKS 300
+#define LOG_SYNC_BLOCKS 16
+#define RECORD_NAME "LIVE0001BIN"
+#define RECORD_SECTORS 512
+#define RECORD_BLOCKS 300
+#define FULL_RECORD_NAME "LIVE0002BIN"
+#define EMPTY_RECORD_NAME "LIVE0003BIN"
+#define SESSION_FILE 4
+
+static const char file_names[NUM_FILES][SD_FAT_NAME_SIZE+1] = {"POWERTR TXT", "CHASSIS TXT", "BODY    TXT",
+                                                               "NETWORK TXT", "SESSION LOG"};
+
+
+// Same sequence on every run
+static uint32_t next_random(void){
+
+    static uint32_t state = 0x0BD2026;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state;
+}
+
+int main(int argc, char *argv[]){
+
+    static tSDVolume volume;
+    static tSDFile file;
+    static uint8_t expected[NUM_FILES][MAX_FILE_SIZE];
+    static char record[8192];
+    static uint8_t log_data[LOG_BLOCKS*SD_SECTOR_SIZE];
+    static tSDRecord record_file;
+    static uint8_t record_data[RECORD_BLOCKS*SD_SECTOR_SIZE];
+    static uint8_t full_data[SD_RECORD_MIN_CLUSTERS*128*SD_SECTOR_SIZE];
+    uint32_t full_sectors = 0, record_clusters;
+    uint32_t expected_size[NUM_FILES] = {0};
+    uint32_t megabytes = (argc > 2) ? atoi(argv[2]) : 64;
+    uint8_t sectors_per_cluster = (argc > 3) ? atoi(argv[3]) : 1;
+    uint32_t total_sectors = megabytes*2048;
+    uint32_t data_bytes = 0, opens = 0, size, length;
+    uint8_t *data;
+    int errors = 0;
+
+    if (argc < 2){
+
+        fprintf(stderr, "Usage: %s image [MB] [sectors per cluster]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ((!open_SDimage(argv[1], total_sectors)) || (!format_SDimage(total_sectors, sectors_per_cluster))){
+
+        fprintf(stderr, "Cannot create the image\n");
+        return EXIT_FAILURE;
+    }
+    if (!mount_SDvolume(&volume, &SD_image)){
+
+        fprintf(stderr, "Cannot mount the image\n");
+        return EXIT_FAILURE;
+    }
+
+    for (int round = 0; round < ROUNDS; round++){
+
+        int f = next_random() % NUM_FILES;
+        int lines = 1 + next_random() % 12;
+
+        if ((round % REMOUNT_ROUNDS) == 0){
+
+            // Like a reset of the board: the hint of FSInfo and the directory are read again
+            if (!mount_SDvolume(&volume, &SD_image)){
+
+                fprintf(stderr, "Cannot mount the image again\n");
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (!open_SDfile(&volume, &file, file_names[f])){
+
+            fprintf(stderr, "Cannot open %s\n", file_names[f]);
+            return EXIT_FAILURE;
+        }
+        opens++;
+
+        for (int i = 0; i < lines; i++){
+
+            if ((next_random() % 16) == 0){
+
+                // Long record: crosses sectors, the buffer and clusters on one write
+                length = 600 + next_random() % (sizeof(record) - 600);
+                for (uint32_t j = 0; j < length; j++){
+
+                    record[j] = 'A' + (round + j) % 26;
+                }
+            }else {
+
+                length = snprintf(record, sizeof(record), "%u ECM P%04X stored round %d line %d\r\n",
+                                  round*100, next_random() & 0x3FFF, round, i);
+            }
+
+            if (expected_size[f] + length > MAX_FILE_SIZE){
+
+                break;
+            }
+            if (!write_SDfile(&volume, &file, record, length)){
+
+                fprintf(stderr, "Cannot write %s\n", file_names[f]);
+                return EXIT_FAILURE;
+            }
+            memcpy(&expected[f][expected_size[f]], record, length);
+            expected_size[f] += length;
+            data_bytes += length;
+        }
+
+        if (!close_SDfile(&volume, &file)){
+
+            fprintf(stderr, "Cannot close %s\n", file_names[f]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Live data log: a new file of whole sectors, with checkpoints (sync) like the SD writer task
+    if (find_SDfile(&volume, LOG_NAME) || (!open_SDfile(&volume, &file, LOG_NAME)) || (!find_SDfile(&volume, LOG_NAME))){
+
+        fprintf(stderr, "Cannot create %s\n", LOG_NAME);
+        return EXIT_FAILURE;
+    }
+    for (uint32_t block = 0; block < LOG_BLOCKS; block++){
+
+        for (uint32_t j = 0; j < SD_SECTOR_SIZE; j++){
+
+            log_data[block*SD_SECTOR_SIZE + j] = next_random() & 0xFF;
+        }
+        if ((!write_SDfile(&volume, &file, &log_data[block*SD_SECTOR_SIZE], SD_SECTOR_SIZE))
+                || (((block % LOG_SYNC_BLOCKS) == 0) && (!sync_SDfile(&volume, &file)))){
+
+            fprintf(stderr, "Cannot write %s\n", LOG_NAME);
+            return EXIT_FAILURE;
+        }
+        data_bytes += SD_SECTOR_SIZE;
+    }
+    if (!close_SDfile(&volume, &file)){
+
+        fprintf(stderr, "Cannot close %s\n", LOG_NAME);
+        return EXIT_FAILURE;
+    }
+
+    // Record: the run is bigger than the data, so the end is freed on the close
+    record_clusters = RECORD_SECTORS/sectors_per_cluster;
+    if (record_clusters < SD_RECORD_MIN_CLUSTERS){
+
+        record_clusters = SD_RECORD_MIN_CLUSTERS;
+    }
+    if (!open_SDrecord(&volume, &record_file, RECORD_NAME, record_clusters)){
+
+        fprintf(stderr, "Cannot create %s\n", RECORD_NAME);
+        return EXIT_FAILURE;
+    }
+    for (uint32_t block = 0; block < RECORD_BLOCKS; block++){
+
+        for (uint32_t j = 0; j < SD_SECTOR_SIZE; j++){
+
+            record_data[block*SD_SECTOR_SIZE + j] = next_random() & 0xFF;
+        }
+        if ((!write_SDrecord(&volume, &record_file, &record_data[block*SD_SECTOR_SIZE], 1))
+                || ((((block+1) % LOG_SYNC_BLOCKS) == 0) && (!checkpoint_SDrecord(&volume, &record_file)))){
+
+            fprintf(stderr, "Cannot write %s\n", RECORD_NAME);
+            return EXIT_FAILURE;
+        }
+        data_bytes += SD_SECTOR_SIZE;
+
+        // A line of the session log with the record open: the stream is closed before
+        if ((block % 50) == 25){
+
+            length = snprintf(record, sizeof(record), "%u record block %u\r\n", block*10, block);
+            if ((expected_size[SESSION_FILE] + length > MAX_FILE_SIZE) || (!checkpoint_SDrecord(&volume, &record_file))
+                    || (!open_SDfile(&volume, &file, file_names[SESSION_FILE]))
+                    || (!write_SDfile(&volume, &file, record, length)) || (!close_SDfile(&volume, &file))){
+
+                fprintf(stderr, "Cannot write %s with %s open\n", file_names[SESSION_FILE], RECORD_NAME);
+                return EXIT_FAILURE;
+            }
+            memcpy(&expected[SESSION_FILE][expected_size[SESSION_FILE]], record, length);
+            expected_size[SESSION_FILE] += length;
+            data_bytes += length;
+        }
+    }
+    if (!close_SDrecord(&volume, &record_file)){
+
+        fprintf(stderr, "Cannot close %s\n", RECORD_NAME);
+        return EXIT_FAILURE;
+    }
+
+    // Record that fills its run: the next write fails
+    if (!open_SDrecord(&volume, &record_file, FULL_RECORD_NAME, SD_RECORD_MIN_CLUSTERS)){
+
+        fprintf(stderr, "Cannot create %s\n", FULL_RECORD_NAME);
+        return EXIT_FAILURE;
+    }
+    full_sectors = record_file.capacity;
+    for (uint32_t j = 0; j < full_sectors*SD_SECTOR_SIZE; j++){
+
+        full_data[j] = next_random() & 0xFF;
+    }
+    if ((!write_SDrecord(&volume, &record_file, full_data, full_sectors))
+            || (write_SDrecord(&volume, &record_file, full_data, 1)) || (!close_SDrecord(&volume, &record_file))){
+
+        fprintf(stderr, "Cannot fill %s\n", FULL_RECORD_NAME);
+        return EXIT_FAILURE;
+    }
+    data_bytes += full_sectors*SD_SECTOR_SIZE;
+
+    // Record without data: every cluster is freed
+    if ((!open_SDrecord(&volume, &record_file, EMPTY_RECORD_NAME, record_clusters))
+            || (!close_SDrecord(&volume, &record_file))){
+
+        fprintf(stderr, "Cannot create %s\n", EMPTY_RECORD_NAME);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u opens, %u bytes of data (%u sectors)\n", opens, data_bytes, data_bytes/SD_SECTOR_SIZE);
+    printf("Device: %u reads (%u sectors), %u writes (%u sectors, %u multiple block writes)\n",
+           SD_imageStats.reads, SD_imageStats.read_sectors, SD_imageStats.writes,
+           SD_imageStats.write_sectors, SD_imageStats.multi_writes);
+    printf("Records: %u streams (%u sectors), %u errors of the stream\n", SD_imageStats.streams,
+           SD_imageStats.stream_sectors, SD_imageStats.stream_errors);
+    if (SD_imageStats.stream_errors != 0){
+
+        errors++;
+    }
+
+    for (int f = 0; f < NUM_FILES; f++){
+
+        data = read_SDimageFile(file_names[f], &size);
+        if ((data == NULL) || (size != expected_size[f]) || (memcmp(data, expected[f], size) != 0)){
+
+            fprintf(stderr, "%s: the content is not the same\n", file_names[f]);
+            errors++;
+        }
+        free(data);
+    }
+    data = read_SDimageFile(LOG_NAME, &size);
+    if ((data == NULL) || (size != sizeof(log_data)) || (memcmp(data, log_data, size) != 0)){
+
+        fprintf(stderr, "%s: the content is not the same\n", LOG_NAME);
+        errors++;
+    }
+    free(data);
+    data = read_SDimageFile(RECORD_NAME, &size);
+    if ((data == NULL) || (size != sizeof(record_data)) || (memcmp(data, record_data, size) != 0)){
+
+        fprintf(stderr, "%s: the content is not the same\n", RECORD_NAME);
+        errors++;
+    }
+    free(data);
+    data = read_SDimageFile(FULL_RECORD_NAME, &size);
+    if ((data == NULL) || (size != full_sectors*SD_SECTOR_SIZE) || (memcmp(data, full_data, size) != 0)){
+
+        fprintf(stderr, "%s: the content is not the same\n", FULL_RECORD_NAME);
+        errors++;
+    }
+    free(data);
+    data = read_SDimageFile(EMPTY_RECORD_NAME, &size);
+    if ((data == NULL) || (size != 0)){
+
+        fprintf(stderr, "%s: it is not empty\n", EMPTY_RECORD_NAME);
+        errors++;
+    }
+    free(data);
+    if (!check_SDimage(true)){
+
+        errors++;
+    }
+    close_SDimage();
+
+    printf("%s\n", (errors == 0) ? "Image correct" : "Image with errors");
+
+    return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
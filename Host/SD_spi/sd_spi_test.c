@@ -0,0 +1,273 @@
+/*
+ * sd_spi_test.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      Host test of the block transfers of the SD card (Software/SD_spi.c) against a simulated
+ *      SSI and card. The SSI has the 8 byte FIFOs of the TM4C123: every register access is a
+ *      step of time and the line moves one byte every BYTE_STEPS steps (plus a random delay
+ *      and interrupts that stop the CPU while the line goes on, in the robustness rounds).
+ *      The card sends the sector on the reads and keeps what it
+ *      receives on the writes. A byte sent with the transmit FIFO full, a read with the
+ *      receive FIFO empty or a receive overrun is an error.
+ *
+ *      The use of the line (steps with a byte on the way) is compared with the byte by
+ *      byte transfer of the old driver (exchange_SPIbyte).
+ *
+ *      Build and run (from this folder):
+ *          cc -O2 -Wall -DSD_SPI_HOST -I../../Software -o sd_spi_test sd_spi_test.c ../../Software/SD_spi.c
+ *          ./sd_spi_test
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Programmer libraries
+#include "SD_spi.h"
+
+#define SECTOR 512
+#define ROUNDS 2000
+#define INTERRUPT_STEPS 200
+#define MAX_TRANSFER_STEPS 1000000 // A lost byte leaves the transfer waiting for ever
+#define BYTE_STEPS 4            // 25 MHz SPI and 50 MHz core: 16 cycles per byte, about 4 register accesses
+
+typedef struct{
+
+    uint8_t data[SD_SPI_FIFO_DEPTH];
+    uint8_t first;
+    uint8_t count;
+}tFIFO;
+
+// Simulated SSI and card
+static tFIFO tx_fifo, rx_fifo;
+static uint32_t steps, busy_steps, shift_steps, transfer_steps;
+static uint32_t jitter;                 // Random steps added to a byte on the line (0: fixed rate)
+static uint32_t errors;
+static bool card_reading;               // The card sends card_sector, or it receives on card_sector
+static uint8_t card_sector[SECTOR+16];
+static uint16_t card_position;
+
+
+static uint32_t next_random(void){
+
+    static uint32_t state = 0x5D2026;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state;
+}
+
+static void push(tFIFO *fifo, uint8_t value){
+
+    fifo->data[(fifo->first + fifo->count) % SD_SPI_FIFO_DEPTH] = value;
+    fifo->count++;
+}
+
+static uint8_t pop(tFIFO *fifo){
+
+    uint8_t value = fifo->data[fifo->first];
+
+    fifo->first = (fifo->first + 1) % SD_SPI_FIFO_DEPTH;
+    fifo->count--;
+
+    return value;
+}
+
+static uint8_t card_exchange(uint8_t mosi){
+
+    if (card_reading){
+
+        if (mosi != 0xFF){
+
+            errors++;       // The card needs 0xFF while it sends
+        }
+        return card_sector[card_position++];
+    }
+    card_sector[card_position++] = mosi;
+
+    return 0xFF;
+}
+
+// A step of time: the byte on the line goes to the card and its answer to the receive FIFO
+static void step(void){
+
+    steps++;
+    if (++transfer_steps > MAX_TRANSFER_STEPS){
+
+        fprintf(stderr, "The transfer does not end (%u errors)\n", errors);
+        exit(EXIT_FAILURE);
+    }
+    if (tx_fifo.count == 0){
+
+        return;
+    }
+    busy_steps++;
+    if (++shift_steps < BYTE_STEPS + ((jitter != 0) ? next_random() % jitter : 0)){
+
+        return;
+    }
+    shift_steps = 0;
+    if (rx_fifo.count == SD_SPI_FIFO_DEPTH){
+
+        errors++;   // Receive overrun: the byte is lost
+        pop(&tx_fifo);
+        return;
+    }
+    push(&rx_fifo, card_exchange(pop(&tx_fifo)));
+}
+
+uint32_t sim_SPIstatus(tSPIRegisters *port){
+
+    (void)port;
+    step();
+    if ((jitter != 0) && ((next_random() % 64) == 0)){
+
+        // Interrupt: the FIFOs are not served for a while
+        for (int i = 0; i < INTERRUPT_STEPS; i++){
+
+            step();
+        }
+    }
+
+    return ((tx_fifo.count < SD_SPI_FIFO_DEPTH) ? SD_SPI_SR_TNF : 0) | ((rx_fifo.count > 0) ? SD_SPI_SR_RNE : 0);
+}
+
+void sim_SPIsend(tSPIRegisters *port, uint8_t value){
+
+    (void)port;
+    step();
+    if (tx_fifo.count == SD_SPI_FIFO_DEPTH){
+
+        errors++;
+        return;
+    }
+    push(&tx_fifo, value);
+}
+
+uint8_t sim_SPIreceive(tSPIRegisters *port){
+
+    (void)port;
+    step();
+    if (rx_fifo.count == 0){
+
+        errors++;
+        return 0;
+    }
+
+    return pop(&rx_fifo);
+}
+
+static void start_transfer(bool reading){
+
+    memset(&tx_fifo, 0, sizeof(tx_fifo));
+    memset(&rx_fifo, 0, sizeof(rx_fifo));
+    card_reading = reading;
+    card_position = 0;
+    shift_steps = 0;
+    transfer_steps = 0;
+}
+
+// The FIFOs have to be empty at the end: the next command starts clean
+static void end_transfer(uint16_t length){
+
+    if ((tx_fifo.count != 0) || (rx_fifo.count != 0) || (card_position != length)){
+
+        errors++;
+    }
+}
+
+// Use of the line with the block functions or byte by byte
+static double line_use(bool block, bool reading){
+
+    static tSPIRegisters port;
+    static uint8_t buffer[SECTOR];
+
+    steps = busy_steps = 0;
+    jitter = 0;
+    start_transfer(reading);
+    if (reading){
+
+        if (block){
+
+            receive_SPIblock(&port, buffer, SECTOR);
+        }else {
+
+            for (int i = 0; i < SECTOR; i++){
+
+                buffer[i] = exchange_SPIbyte(&port, 0xFF);
+            }
+        }
+    }else if (block){
+
+        send_SPIblock(&port, buffer, SECTOR);
+    }else {
+
+        for (int i = 0; i < SECTOR; i++){
+
+            exchange_SPIbyte(&port, buffer[i]);
+        }
+    }
+    end_transfer(SECTOR);
+
+    return 100.0*busy_steps/steps;
+}
+
+int main(void){
+
+    static tSPIRegisters port;
+    static uint8_t expected[SECTOR], buffer[SECTOR+16];
+    uint16_t length;
+    uint32_t transferred = 0;
+
+    // Robustness: random data, lengths (the CSD is 16 bytes) and line delays
+    for (int round = 0; round < ROUNDS; round++){
+
+        bool reading = (round % 2) == 0;
+
+        length = ((round % 5) == 0) ? 1 + next_random() % SECTOR : SECTOR;
+        if ((round % 7) == 0){
+
+            length = 16;
+        }
+        jitter = (round % 3 == 0) ? 0 : 1 + next_random() % 40;
+        for (int i = 0; i < length; i++){
+
+            expected[i] = next_random() & 0xFF;
+        }
+
+        start_transfer(reading);
+        memset(buffer, 0, sizeof(buffer));
+        if (reading){
+
+            memcpy(card_sector, expected, length);
+            receive_SPIblock(&port, buffer, length);
+        }else {
+
+            send_SPIblock(&port, expected, length);
+            memcpy(buffer, card_sector, length);
+        }
+        end_transfer(length);
+        if (memcmp(buffer, expected, length) != 0){
+
+            fprintf(stderr, "Round %d: the %s of %u bytes is not the same\n", round, reading ? "read" : "write", length);
+            errors++;
+        }
+        transferred += length;
+    }
+    printf("%d transfers, %u bytes\n", ROUNDS, transferred);
+
+    printf("Use of the line (sector of 512 bytes):\n");
+    printf("  read:  %5.1f %% byte by byte, %5.1f %% block\n", line_use(false, true), line_use(true, true));
+    printf("  write: %5.1f %% byte by byte, %5.1f %% block\n", line_use(false, false), line_use(true, false));
+
+    printf("%s (%u errors)\n", (errors == 0) ? "Transfers correct" : "Transfers with errors", errors);
+
+    return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,494 @@
+/*
+ * dbc_gen.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host compiler of a DBC file on the signal database of the firmware (Software/Signal_database_data.c).
+ *      It reads the messages (BO_) and their signals (SG_) with the start bit, the length, the byte
+ *      order, the sign, the scale, the offset and the multiplexing (M and mN), checks that every
+ *      signal fits on 8 bytes and builds the hash table of the IDs. The rest of the file (comments,
+ *      attributes, value tables) is skipped. With -s only the signals named are taken (and the
+ *      multiplexor of their message), the firmware has room for SIGNAL_MAX_SIGNALS.
+ *      The format is described on Software/Signal_decoder.h.
+ *
+ *      Build and run (from this folder):
+ *          cc -O2 -Wall -I../../Software -o dbc_gen dbc_gen.c
+ *          ./dbc_gen example.dbc ../../Software/Signal_database_data.c
+ *          ./dbc_gen -s WheelSpeedFL,SteeringAngle example.dbc signals.c
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+// Programmer libraries
+#include "Signal_decoder.h"
+
+// Generator configuration
+#define MAX_LINE 1024
+#define MAX_NAME 64
+#define MAX_DBC_MESSAGES 4096
+#define MAX_DBC_SIGNALS 16384
+#define MAX_SELECTED 256
+#define MIN_HASH_BITS 2
+#define INDEPENDENT_SIGNALS_ID 0xC0000000UL     // VECTOR__INDEPENDENT_SIG_MSG, not on the bus
+#define DBC_EXTENDED_ID 0x80000000UL
+
+typedef struct{
+
+    uint32_t key;
+    char name[MAX_NAME];
+    uint16_t first_signal;                      // On signals[]
+    uint16_t num_signals;
+    int16_t multiplexor;                        // Position on the message, -1 without it
+}tDBCMessage;
+
+typedef struct{
+
+    char name[MAX_NAME];
+    char unit[MAX_NAME];
+    tSignalDef def;
+    bool selected;
+}tDBCSignal;
+
+// Global variables
+static tDBCMessage messages[MAX_DBC_MESSAGES];
+static uint16_t numMessages = 0;
+static tDBCSignal signals[MAX_DBC_SIGNALS];
+static uint16_t numSignals = 0;
+static char *selected[MAX_SELECTED];
+static uint16_t numSelected = 0;
+
+
+static const char *skip_spaces(const char *text){
+
+    while (isspace((unsigned char)*text)){
+
+        text++;
+    }
+
+    return text;
+}
+
+// An identifier of the DBC file. Return the text after it or NULL.
+static const char *read_name(const char *text, char name[]){
+
+    size_t length = 0;
+
+    text = skip_spaces(text);
+    while ((isalnum((unsigned char)text[length]) || (text[length] == '_')) && (length < MAX_NAME - 1)){
+
+        name[length] = text[length];
+        length++;
+    }
+    name[length] = '\0';
+
+    return (length > 0) ? text + length : NULL;
+}
+
+// Position of the last bit of the signal counted from the first bit of the frame, the bit 7 of
+// the byte 0 for Motorola and the bit 0 of the byte 0 for Intel. -1 if it does not fit on 8 bytes.
+static int16_t last_bit(const tSignalDef *def){
+
+    int16_t bit;
+
+    if (def->flags & SIGNAL_BIG_ENDIAN){
+
+        bit = (def->start_bit & ~0x07) + (7 - (def->start_bit & 0x07)) + def->length - 1;
+    }else {
+
+        bit = def->start_bit + def->length - 1;
+    }
+
+    return (bit <= 63) ? bit : -1;
+}
+
+// BO_ ID Name: DLC Transmitter
+static bool parse_message(const char *text, int line){
+
+    tDBCMessage *message = &messages[numMessages];
+    char *end;
+    unsigned long ID = strtoul(text, &end, 10);
+
+    if (end == text){
+
+        fprintf(stderr, "Line %d: bad message ID\n", line);
+        return false;
+    }
+    if (numMessages == MAX_DBC_MESSAGES){
+
+        fprintf(stderr, "Line %d: more than %d messages\n", line, MAX_DBC_MESSAGES);
+        return false;
+    }
+    if (read_name(end, message->name) == NULL){
+
+        fprintf(stderr, "Line %d: bad message name\n", line);
+        return false;
+    }
+    message->key = (ID & DBC_EXTENDED_ID) ? ((ID & 0x1FFFFFFF) | SIGNAL_ID_EXTENDED) : (ID & 0x7FF);
+    message->first_signal = numSignals;
+    message->num_signals = 0;
+    message->multiplexor = -1;
+    // The signals without a message go to a message that is never received
+    if (ID == INDEPENDENT_SIGNALS_ID){
+
+        message->key = 0xFFFFFFFF;
+    }
+    numMessages++;
+
+    return true;
+}
+
+// SG_ Name [M|mN] : start|length@order sign (scale,offset) [min|max] "unit" receivers
+static bool parse_signal(const char *text, int line){
+
+    tDBCMessage *message = &messages[numMessages - 1];
+    tDBCSignal *signal = &signals[numSignals];
+    unsigned start, length, mux_value;
+    char order, sign;
+    double scale, offset;
+    int used;
+
+    if ((numMessages == 0) || (numSignals == MAX_DBC_SIGNALS)){
+
+        fprintf(stderr, "Line %d: signal out of a message or more than %d signals\n", line, MAX_DBC_SIGNALS);
+        return false;
+    }
+    memset(signal, 0, sizeof(*signal));
+    if ((text = read_name(text, signal->name)) == NULL){
+
+        fprintf(stderr, "Line %d: bad signal name\n", line);
+        return false;
+    }
+    text = skip_spaces(text);
+    if ((text[0] == 'M') && isspace((unsigned char)text[1])){
+
+        if (message->multiplexor >= 0){
+
+            fprintf(stderr, "Line %d: second multiplexor of %s\n", line, message->name);
+            return false;
+        }
+        signal->def.flags |= SIGNAL_MULTIPLEXOR;
+        message->multiplexor = message->num_signals;
+        text++;
+    }else if ((text[0] == 'm') && (sscanf(text, "m%u%n", &mux_value, &used) == 1)){
+
+        if ((mux_value > 0xFFFF) || (text[used] == 'M')){
+
+            fprintf(stderr, "Line %d: multiplexing of more than one level is not supported\n", line);
+            return false;
+        }
+        signal->def.flags |= SIGNAL_MULTIPLEXED;
+        signal->def.mux_value = (uint16_t)mux_value;
+        text += used;
+    }
+    if (sscanf(text, " : %u|%u@%c%c (%lf,%lf)%n", &start, &length, &order, &sign, &scale, &offset, &used) != 6){
+
+        fprintf(stderr, "Line %d: bad signal %s\n", line, signal->name);
+        return false;
+    }
+    text = strchr(text + used, '"');
+    if (text != NULL){
+
+        sscanf(text, "\"%63[^\"]\"", signal->unit);
+    }
+    if ((start > 63) || (length < 1) || (length > 64) || ((order != '0') && (order != '1')) || ((sign != '+') && (sign != '-'))){
+
+        fprintf(stderr, "Line %d: bad layout of %s\n", line, signal->name);
+        return false;
+    }
+    signal->def.start_bit = (uint8_t)start;
+    signal->def.length = (uint8_t)length;
+    signal->def.flags |= ((order == '0') ? SIGNAL_BIG_ENDIAN : 0) | ((sign == '-') ? SIGNAL_SIGNED : 0);
+    signal->def.scale = (float)scale;
+    signal->def.offset = (float)offset;
+    if (last_bit(&signal->def) < 0){
+
+        fprintf(stderr, "Line %d: %s does not fit on 8 bytes\n", line, signal->name);
+        return false;
+    }
+    signal->def.min_length = (uint8_t)(last_bit(&signal->def)/8 + 1);
+    message->num_signals++;
+    numSignals++;
+
+    return true;
+}
+
+static bool read_dbc(const char *path){
+
+    FILE *file = fopen(path, "r");
+    char buffer[MAX_LINE];
+    const char *text;
+    int line = 0;
+    bool ok = true;
+
+    if (file == NULL){
+
+        perror(path);
+        return false;
+    }
+    while (ok && (fgets(buffer, sizeof(buffer), file) != NULL)){
+
+        line++;
+        text = skip_spaces(buffer);
+        if (strncmp(text, "BO_ ", 4) == 0){
+
+            ok = parse_message(text + 4, line);
+        }else if (strncmp(text, "SG_ ", 4) == 0){
+
+            ok = parse_signal(text + 4, line);
+        }
+    }
+    fclose(file);
+
+    for (uint16_t m = 0; ok && (m < numMessages); m++){
+
+        for (uint16_t i = messages[m].first_signal; i < messages[m].first_signal + messages[m].num_signals; i++){
+
+            if ((signals[i].def.flags & SIGNAL_MULTIPLEXED) && (messages[m].multiplexor < 0)){
+
+                fprintf(stderr, "%s of %s is multiplexed without a multiplexor\n", signals[i].name, messages[m].name);
+                ok = false;
+            }
+        }
+    }
+
+    return ok;
+}
+
+static bool is_selected(const char *name){
+
+    if (numSelected == 0){
+
+        return true;
+    }
+    for (uint16_t i = 0; i < numSelected; i++){
+
+        if (strcmp(selected[i], name) == 0){
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Marks the signals taken: the ones selected and the multiplexor of the multiplexed ones
+static uint16_t select_signals(void){
+
+    uint16_t count = 0;
+
+    for (uint16_t m = 0; m < numMessages; m++){
+
+        tDBCMessage *message = &messages[m];
+        bool multiplexed = false;
+
+        for (uint16_t i = message->first_signal; i < message->first_signal + message->num_signals; i++){
+
+            signals[i].selected = (message->key != 0xFFFFFFFF) && is_selected(signals[i].name);
+            multiplexed |= signals[i].selected && (signals[i].def.flags & SIGNAL_MULTIPLEXED);
+        }
+        if (multiplexed){
+
+            signals[message->first_signal + message->multiplexor].selected = true;
+        }
+        for (uint16_t i = message->first_signal; i < message->first_signal + message->num_signals; i++){
+
+            count += signals[i].selected ? 1 : 0;
+        }
+    }
+
+    return count;
+}
+
+static void print_float(FILE *file, float value){
+
+    char text[32];
+
+    snprintf(text, sizeof(text), "%.9g", value);
+    fprintf(file, "%s%sf", text, (strpbrk(text, ".en") == NULL) ? ".0" : "");
+}
+
+int main(int argc, char *argv[]){
+
+    int arg = 1;
+    char *list = NULL;
+    tSignalMessage out_messages[SIGNAL_MAX_SIGNALS];   // Every one has a signal at least
+    uint16_t out_numMessages = 0, out_numSignals = 0;
+    uint16_t out_signals[SIGNAL_MAX_SIGNALS];          // Positions on signals[]
+    uint8_t hash[4*SIGNAL_MAX_SIGNALS] = {0};
+    uint8_t bits = MIN_HASH_BITS;
+    uint32_t mask, entry, probes, max_probes = 0;
+    uint32_t flash;
+    uint16_t count;
+    FILE *out;
+
+    if ((argc > 2) && (strcmp(argv[1], "-s") == 0)){
+
+        list = argv[2];
+        arg = 3;
+    }
+    if (argc - arg != 2){
+
+        fprintf(stderr, "Usage: %s [-s signal,signal...] input.dbc output.c\n", argv[0]);
+        return 1;
+    }
+    for (char *name = (list != NULL) ? strtok(list, ",") : NULL; name != NULL; name = strtok(NULL, ",")){
+
+        if (numSelected < MAX_SELECTED){
+
+            selected[numSelected++] = name;
+        }
+    }
+    if (!read_dbc(argv[arg])){
+
+        return 1;
+    }
+    count = select_signals();
+    if ((count == 0) || (count > SIGNAL_MAX_SIGNALS)){
+
+        fprintf(stderr, "%u signals taken, 1 to %d are allowed (-s)\n", count, SIGNAL_MAX_SIGNALS);
+        return 1;
+    }
+    for (uint16_t i = 0; i < numSelected; i++){
+
+        bool found = false;
+
+        for (uint16_t s = 0; s < numSignals; s++){
+
+            found |= (strcmp(signals[s].name, selected[i]) == 0);
+        }
+        if (!found){
+
+            fprintf(stderr, "Warning: %s is not on %s\n", selected[i], argv[arg]);
+        }
+    }
+
+    // Messages with signals taken, the multiplexor as a position among the signals taken
+    for (uint16_t m = 0; m < numMessages; m++){
+
+        tDBCMessage *message = &messages[m];
+        tSignalMessage *out_message = &out_messages[out_numMessages];
+
+        out_message->first_signal = out_numSignals;
+        out_message->num_signals = 0;
+        out_message->multiplexor = SIGNAL_NO_MULTIPLEXOR;
+        out_message->key = message->key;
+        for (uint16_t i = message->first_signal; i < message->first_signal + message->num_signals; i++){
+
+            if (signals[i].selected){
+
+                if (signals[i].def.flags & SIGNAL_MULTIPLEXOR){
+
+                    out_message->multiplexor = out_message->num_signals;
+                }
+                out_signals[out_numSignals++] = i;
+                out_message->num_signals++;
+            }
+        }
+        if (out_message->num_signals == 0){
+
+            continue;
+        }
+        for (uint16_t i = 0; i < out_numMessages; i++){
+
+            if (out_messages[i].key == message->key){
+
+                fprintf(stderr, "Two messages with the ID of %s\n", message->name);
+                return 1;
+            }
+        }
+        out_numMessages++;
+    }
+
+    // Hash table at most half full, so the probes stay short
+    while ((1U << bits) < 2U*out_numMessages){
+
+        bits++;
+    }
+    mask = (1U << bits) - 1;
+    for (uint16_t m = 0; m < out_numMessages; m++){
+
+        entry = SIGNAL_HASH(out_messages[m].key, bits);
+        for (probes = 1; hash[entry] != 0; probes++){
+
+            entry = (entry + 1) & mask;
+        }
+        hash[entry] = (uint8_t)(m + 1);
+        max_probes = (probes > max_probes) ? probes : max_probes;
+    }
+    flash = out_numMessages*sizeof(tSignalMessage) + out_numSignals*sizeof(tSignalDef) + (1U << bits);
+    for (uint16_t s = 0; s < out_numSignals; s++){
+
+        flash += sizeof(char *) + strlen(signals[out_signals[s]].name) + 2;
+    }
+
+    out = fopen(argv[arg + 1], "w");
+    if (out == NULL){
+
+        perror(argv[arg + 1]);
+        return 1;
+    }
+    fprintf(out, "/*\n * Signal_database_data.c\n *\n");
+    fprintf(out, " *      Generated by Host/Signal_database/dbc_gen.c from %s, do not edit it.\n", argv[arg]);
+    fprintf(out, " *      %u messages, %u signals.\n", out_numMessages, out_numSignals);
+    fprintf(out, " *      Flash image: %u bytes.\n", flash);
+    fprintf(out, " *      Lookup: hash of %u entries, %u probes at most.\n */\n\n", 1U << bits, max_probes);
+    fprintf(out, "#include <stdint.h>\n\n#include \"Signal_decoder.h\"\n\n");
+    fprintf(out, "const uint16_t Signal_database_numMessages = %u;\n", out_numMessages);
+    fprintf(out, "const uint16_t Signal_database_numSignals = %u;\n", out_numSignals);
+    fprintf(out, "const uint8_t Signal_database_hashBits = %u;\n\n", bits);
+
+    fprintf(out, "const uint8_t Signal_database_hash[%u] = {", 1U << bits);
+    for (uint32_t i = 0; i < (1U << bits); i++){
+
+        fprintf(out, "%s%u%s", (i % 16 == 0) ? "\n    " : "", hash[i], (i < mask) ? ", " : "\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const tSignalMessage Signal_database_messages[%u] = {\n", out_numMessages);
+    for (uint16_t m = 0; m < out_numMessages; m++){
+
+        fprintf(out, "    {0x%08X, %u, %u, %u}%s\n", out_messages[m].key, out_messages[m].first_signal, out_messages[m].num_signals,
+                out_messages[m].multiplexor, (m < out_numMessages - 1) ? "," : "");
+    }
+    fprintf(out, "};\n\n");
+
+    // scale, offset, mux_value, start_bit, length, flags, min_length
+    fprintf(out, "const tSignalDef Signal_database_signals[%u] = {\n", out_numSignals);
+    for (uint16_t s = 0; s < out_numSignals; s++){
+
+        const tDBCSignal *signal = &signals[out_signals[s]];
+
+        fprintf(out, "    {");
+        print_float(out, signal->def.scale);
+        fprintf(out, ", ");
+        print_float(out, signal->def.offset);
+        fprintf(out, ", %u, %u, %u, 0x%02X, %u}%s      // %s%s%s%s\n", signal->def.mux_value, signal->def.start_bit, signal->def.length,
+                signal->def.flags, signal->def.min_length, (s < out_numSignals - 1) ? "," : "", signal->name,
+                (signal->unit[0] != '\0') ? " (" : "", signal->unit, (signal->unit[0] != '\0') ? ")" : "");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const char * const Signal_database_labels[%u] = {\n", out_numSignals);
+    for (uint16_t s = 0; s < out_numSignals; s++){
+
+        fprintf(out, "    \"%.*s:\"%s\n", SIGNAL_LABEL_CHARS - 1, signals[out_signals[s]].name, (s < out_numSignals - 1) ? "," : "");
+    }
+    fprintf(out, "};\n");
+    fclose(out);
+
+    printf("%u messages, %u signals, hash of %u entries (%u probes at most), %u bytes of flash\n",
+           out_numMessages, out_numSignals, 1U << bits, max_probes, flash);
+
+    return 0;
+}
@@ -0,0 +1,439 @@
+/*
+ * signal_bench.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Host check of the signal decoder of the firmware (Software/Signal_decoder.c) against a
+ *      reference that reads the signals bit by bit, as the DBC format defines them:
+ *          every layout (start bit, length, byte order and sign) that fits on 8 bytes,
+ *          random frames of the messages of the generated database (Signal_database_data.c),
+ *          with short frames and the pages of the multiplexed messages,
+ *          and IDs that are not on the database.
+ *      Then the mean decode time of a frame is measured. With -w it writes a candump log of
+ *      the messages of the database (every one each 20 ms for 2 s) for the "Broadcast signals"
+ *      screen of Host/Firmware_sim, and prints the values the screen shows.
+ *
+ *      Build and run (from this folder, after dbc_gen):
+ *          cc -O2 -Wall -I../../Software -o signal_bench signal_bench.c ../../Software/Signal_decoder.c ../../Software/Signal_database_data.c -lm
+ *          ./signal_bench
+ *          ./signal_bench -w ../Firmware_sim/scripts/broadcast.log
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Programmer libraries
+#include "Signal_decoder.h"
+
+#define LAYOUT_ROUNDS 20
+#define FRAME_ROUNDS 200000
+#define TIMED_FRAMES 2000000
+#define LOG_PERIOD_US 20000
+#define LOG_TIME_US 2000000
+
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *end){
+
+    return (end->tv_sec - start->tv_sec)*1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+static uint64_t random64(void){
+
+    static uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+    // xorshift64
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    return state;
+}
+
+// Next bit of a signal from its least significant bit (Intel) or from its most significant bit (Motorola)
+static uint8_t next_bit(uint8_t bit, bool big_endian){
+
+    if (!big_endian){
+
+        return bit + 1;
+    }
+
+    return ((bit % 8) == 0) ? bit + 15 : bit - 1;
+}
+
+// Bits of the signal inside the length of the frame
+static bool reference_fits(const tSignalDef *signal, uint8_t length){
+
+    uint8_t bit = signal->start_bit;
+
+    for (uint8_t i = 0; i < signal->length; i++, bit = next_bit(bit, signal->flags & SIGNAL_BIG_ENDIAN)){
+
+        if (bit >= 8*length){
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int64_t reference_raw(const tSignalDef *signal, const uint8_t data[8]){
+
+    uint64_t raw = 0;
+    uint8_t bit = signal->start_bit;
+    bool big_endian = (signal->flags & SIGNAL_BIG_ENDIAN) != 0;
+
+    for (uint8_t i = 0; i < signal->length; i++, bit = next_bit(bit, big_endian)){
+
+        uint64_t value = (data[bit/8] >> (bit % 8)) & 1;
+
+        raw |= big_endian ? value << (signal->length - 1 - i) : value << i;
+    }
+    if ((signal->flags & SIGNAL_SIGNED) && (signal->length < 64) && (raw >> (signal->length - 1))){
+
+        raw -= 1ULL << signal->length;
+    }
+
+    return (int64_t)raw;
+}
+
+static void insert_raw(const tSignalDef *signal, uint64_t raw, uint8_t data[8]){
+
+    uint8_t bit = signal->start_bit;
+    bool big_endian = (signal->flags & SIGNAL_BIG_ENDIAN) != 0;
+
+    for (uint8_t i = 0; i < signal->length; i++, bit = next_bit(bit, big_endian)){
+
+        uint8_t value = (raw >> (big_endian ? signal->length - 1 - i : i)) & 1;
+
+        data[bit/8] = (data[bit/8] & ~(1 << (bit % 8))) | (value << (bit % 8));
+    }
+}
+
+// The float of the firmware against the double of the reference
+static bool same_value(float value, int64_t raw, const tSignalDef *signal){
+
+    double reference = (double)raw*signal->scale + signal->offset;
+
+    return fabs(value - reference) <= 1e-6*(fabs((double)raw*signal->scale) + fabs(signal->offset)) + 1e-9;
+}
+
+// Every layout of 8 bytes, with random data
+static uint32_t check_layouts(uint32_t *checked){
+
+    tSignalDef signal = {1.0f, 0.0f, 0, 0, 0, 0, 8};
+    uint8_t data[8];
+    uint32_t errors = 0;
+
+    for (uint8_t flags = 0; flags < 4; flags++){
+
+        for (uint16_t start = 0; start < 64; start++){
+
+            for (uint16_t length = 1; length <= 64; length++){
+
+                signal.start_bit = start;
+                signal.length = length;
+                signal.flags = flags;
+                if (!reference_fits(&signal, 8)){
+
+                    continue;
+                }
+                for (uint16_t round = 0; round < LAYOUT_ROUNDS; round++){
+
+                    uint64_t word = random64();
+
+                    memcpy(data, &word, 8);
+                    (*checked)++;
+                    if (extract_signalRaw(&signal, data) != reference_raw(&signal, data)){
+
+                        if (errors++ < 10){
+
+                            fprintf(stderr, "Layout %u|%u@%c%c: 0x%llX instead of 0x%llX\n", start, length,
+                                    (flags & SIGNAL_BIG_ENDIAN) ? '0' : '1', (flags & SIGNAL_SIGNED) ? '-' : '+',
+                                    (unsigned long long)extract_signalRaw(&signal, data), (unsigned long long)reference_raw(&signal, data));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+static uint8_t message_length(const tSignalMessage *message){
+
+    uint8_t length = 0;
+
+    for (uint16_t i = message->first_signal; i < message->first_signal + message->num_signals; i++){
+
+        if (Signal_database_signals[i].min_length > length){
+
+            length = Signal_database_signals[i].min_length;
+        }
+    }
+
+    return length;
+}
+
+// Random frames of the database, some of them shorter than the message
+static uint32_t check_frames(uint32_t *checked){
+
+    float values[SIGNAL_MAX_SIGNALS];
+    uint8_t data[8];
+    uint32_t errors = 0;
+
+    for (uint32_t round = 0; round < FRAME_ROUNDS; round++){
+
+        const tSignalMessage *message = &Signal_database_messages[random64() % Signal_database_numMessages];
+        uint8_t length = ((round % 4) == 0) ? random64() % 9 : 8;
+        uint64_t word = random64(), updated = 0;
+        int64_t mux = -1;
+        uint8_t decoded, expected = 0;
+
+        memcpy(data, &word, 8);
+        if (message->multiplexor != SIGNAL_NO_MULTIPLEXOR){
+
+            const tSignalDef *multiplexor = &Signal_database_signals[message->first_signal + message->multiplexor];
+
+            // Mostly the pages of the database
+            if ((round % 8) != 0){
+
+                insert_raw(multiplexor, Signal_database_signals[message->first_signal + random64() % message->num_signals].mux_value, data);
+            }
+            if (reference_fits(multiplexor, length)){
+
+                mux = reference_raw(multiplexor, data);
+            }
+        }
+        memset(values, 0, sizeof(values));
+        decoded = decode_signalFrame(message->key & ~SIGNAL_ID_EXTENDED, (message->key & SIGNAL_ID_EXTENDED) != 0, data, length, values, &updated);
+
+        for (uint16_t i = message->first_signal; i < message->first_signal + message->num_signals; i++){
+
+            const tSignalDef *signal = &Signal_database_signals[i];
+            bool taken = reference_fits(signal, length) && (!(signal->flags & SIGNAL_MULTIPLEXED) || (mux == signal->mux_value));
+
+            (*checked)++;
+            expected += taken ? 1 : 0;
+            if ((taken != ((updated >> i) & 1)) || (taken && !same_value(values[i], reference_raw(signal, data), signal))){
+
+                if (errors++ < 10){
+
+                    fprintf(stderr, "%s of 0x%X (%u bytes): %s %g\n", Signal_database_labels[i], message->key, length,
+                            ((updated >> i) & 1) ? "decoded" : "not decoded", values[i]);
+                }
+            }
+        }
+        if (decoded != expected){
+
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+// IDs out of the database are not found, and the ones of the database are
+static uint32_t check_lookup(void){
+
+    uint32_t errors = 0;
+
+    for (uint16_t m = 0; m < Signal_database_numMessages; m++){
+
+        uint32_t key = Signal_database_messages[m].key;
+
+        if (find_signalMessage(key & ~SIGNAL_ID_EXTENDED, (key & SIGNAL_ID_EXTENDED) != 0) != m){
+
+            errors++;
+        }
+    }
+    for (uint32_t round = 0; round < FRAME_ROUNDS; round++){
+
+        bool extended = random64() & 1;
+        uint32_t ID = random64() & (extended ? 0x1FFFFFFF : 0x7FF);
+        uint32_t key = ID | (extended ? SIGNAL_ID_EXTENDED : 0);
+        int16_t expected = -1;
+
+        for (uint16_t m = 0; m < Signal_database_numMessages; m++){
+
+            if (Signal_database_messages[m].key == key){
+
+                expected = m;
+            }
+        }
+        if (find_signalMessage(ID, extended) != expected){
+
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+static void time_decoder(void){
+
+    static uint8_t frames[256][8];
+    static float values[SIGNAL_MAX_SIGNALS];
+    uint64_t updated = 0;
+    uint32_t signals = 0;
+    volatile uint32_t sink = 0;
+    struct timespec start, end;
+
+    for (uint16_t i = 0; i < 256; i++){
+
+        uint64_t word = random64();
+
+        memcpy(frames[i], &word, 8);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < TIMED_FRAMES; i++){
+
+        uint32_t key = Signal_database_messages[i % Signal_database_numMessages].key;
+
+        signals += decode_signalFrame(key & ~SIGNAL_ID_EXTENDED, (key & SIGNAL_ID_EXTENDED) != 0, frames[i & 0xFF], 8, values, &updated);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Decode: %.1f ns per frame, %.1f ns per signal (%.2f signals per frame)\n", elapsed_ns(&start, &end)/TIMED_FRAMES,
+           elapsed_ns(&start, &end)/signals, (double)signals/TIMED_FRAMES);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < TIMED_FRAMES; i++){
+
+        sink += (uint32_t)find_signalMessage(0x600 + (i & 0xFF), false);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Frame of another ID: %.1f ns\n", elapsed_ns(&start, &end)/TIMED_FRAMES);
+}
+
+// Raw value of every signal on the log: a pattern of its position, a page of the multiplexed
+// messages on every frame
+static uint64_t log_raw(uint16_t signal){
+
+    uint8_t length = Signal_database_signals[signal].length;
+    uint64_t raw = (uint64_t)(signal + 1)*1237;
+
+    return (length >= 64) ? raw : raw & ((1ULL << length) - 1);
+}
+
+static bool write_log(const char *path){
+
+    FILE *file = fopen(path, "w");
+    uint32_t frames = 0;
+    uint16_t page = 0;
+
+    if (file == NULL){
+
+        perror(path);
+        return false;
+    }
+    for (uint64_t time_us = 0; time_us < LOG_TIME_US; time_us += LOG_PERIOD_US, page++){
+
+        for (uint16_t m = 0; m < Signal_database_numMessages; m++){
+
+            const tSignalMessage *message = &Signal_database_messages[m];
+            uint8_t data[8] = {0};
+            uint8_t length = message_length(message);
+            int64_t mux = -1;
+
+            if (message->multiplexor != SIGNAL_NO_MULTIPLEXOR){
+
+                // The pages of the signals in turns
+                const tSignalDef *signal = &Signal_database_signals[message->first_signal + (page % message->num_signals)];
+
+                mux = (signal->flags & SIGNAL_MULTIPLEXED) ? signal->mux_value : 0;
+                insert_raw(&Signal_database_signals[message->first_signal + message->multiplexor], mux, data);
+            }
+            for (uint16_t i = message->first_signal; i < message->first_signal + message->num_signals; i++){
+
+                const tSignalDef *signal = &Signal_database_signals[i];
+
+                if (!(signal->flags & SIGNAL_MULTIPLEXOR) && (!(signal->flags & SIGNAL_MULTIPLEXED) || (mux == signal->mux_value))){
+
+                    insert_raw(signal, log_raw(i), data);
+                }
+            }
+            fprintf(file, "(%llu.%06llu) can0 ", (unsigned long long)(time_us/1000000), (unsigned long long)(time_us % 1000000));
+            if (message->key & SIGNAL_ID_EXTENDED){
+
+                fprintf(file, "%08X#", (unsigned)(message->key & ~SIGNAL_ID_EXTENDED));
+            }else {
+
+                fprintf(file, "%03X#", (unsigned)message->key);
+            }
+            for (uint8_t i = 0; i < length; i++){
+
+                fprintf(file, "%02X", data[i]);
+            }
+            fprintf(file, "\n");
+            frames++;
+        }
+    }
+    fclose(file);
+
+    // The first 5 characters, like format_liveDataValue (Software/OBD_protocol.c)
+    printf("%u frames on %s, values on the screen:\n", frames, path);
+    for (uint16_t i = 0; i < Signal_database_numSignals; i++){
+
+        const tSignalDef *signal = &Signal_database_signals[i];
+        char text[16];
+        int64_t raw = (int64_t)log_raw(i);
+
+        if ((signal->flags & SIGNAL_SIGNED) && (signal->length < 64) && (raw >> (signal->length - 1))){
+
+            raw -= 1LL << signal->length;
+        }
+        if (snprintf(text, 6, "%f", (float)raw*signal->scale + signal->offset) < 0){
+
+            text[0] = '\0';
+        }
+        if (text[4] == '.'){
+
+            memmove(text + 1, text, 4);
+            text[0] = ' ';
+        }
+        printf("    %-18s %s\n", Signal_database_labels[i], (signal->flags & SIGNAL_MULTIPLEXOR) ? "(page)" : text);
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[]){
+
+    uint32_t checked = 0, errors, total;
+
+    if ((argc == 3) && (strcmp(argv[1], "-w") == 0)){
+
+        return write_log(argv[2]) ? 0 : 1;
+    }
+    if (argc != 1){
+
+        fprintf(stderr, "Usage: %s [-w file.log]\n", argv[0]);
+        return 1;
+    }
+
+    errors = check_layouts(&checked);
+    printf("Layouts: %u checked, %u errors\n", checked, errors);
+    total = errors;
+    checked = 0;
+    errors = check_frames(&checked);
+    printf("Database (%u messages, %u signals): %u signals checked, %u errors\n", Signal_database_numMessages,
+           Signal_database_numSignals, checked, errors);
+    total += errors;
+    errors = check_lookup();
+    printf("Lookup: %u errors\n", errors);
+    total += errors;
+    time_decoder();
+
+    return (total == 0) ? 0 : 1;
+}
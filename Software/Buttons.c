@@ -46,14 +46,18 @@
 #include "CAN_device.h"
 #include "ST7735.h"
 #include "Buttons.h"
+#include "Trace_recorder.h"
 
 // Global variables
 extern uint16_t menu_cursor, menu_ECU_cursor, menu_showed;
 extern EventGroupHandle_t flagEvents;
 static TaskHandle_t Button_taskHandler = NULL;
 QueueHandle_t buttons_queue;
-bool left_button_state, menu_button_state;
+// Set by the button task and polled by the screens of CAN_device.c
+volatile bool left_button_state, menu_button_state;
 extern bool live_all_data_mode, OnMenu;
+extern bool live_chart_view, live_view_changed;
+extern uint8_t chart_row, live_numRows, live_first_row;
 
 static portTASK_FUNCTION(Button_pressed, pvParameters){
 
@@ -84,7 +88,16 @@ static portTASK_FUNCTION(Button_pressed, pvParameters){
             }else if(!(buttons_status & RIGHT_BUTTON)) { // Right button pressed
 
                 //drawString(MENU_ITEM_POS_X0, MENU_ITEM_POS_Y0 + (MENU_ITEM_POS_OFFSET),"Derecho pulsado", MENU_ITEM_UNSELECTED_TEXT_COLOUR, MENU_ITEM_UNSELECTED_BG_COLOUR, MENU_ITEM_TEXT_SIZE, 0);
-                if (menu_showed == MENU_MODE){
+                if (live_all_data_mode){
+                    // Next PID on the strip chart
+                    if (live_chart_view){
+                        chart_row++;
+                        if (chart_row >= live_numRows){
+                            chart_row = 0;
+                        }
+                        live_view_changed = true;
+                    }
+                }else if (menu_showed == MENU_MODE){
                     drawMenu();
                 }else {
                     drawECUMenu();
@@ -92,7 +105,13 @@ static portTASK_FUNCTION(Button_pressed, pvParameters){
 
             }else if(!(buttons_status & DOWN_BUTTON)) { // Down button pressed
 
-                if (menu_showed == MENU_MODE){
+                if (live_all_data_mode){
+                    // Scroll the live data view
+                    if ((!live_chart_view) && (live_first_row+LIVE_DATA_VISIBLE_ROWS < live_numRows)){
+                        live_first_row++;
+                        live_view_changed = true;
+                    }
+                }else if (menu_showed == MENU_MODE){
                     if(menu_cursor < MENU_ITEMS-1){
                         menu_cursor++;
                         drawMenu();
@@ -106,7 +125,12 @@ static portTASK_FUNCTION(Button_pressed, pvParameters){
 
             }else if(!(buttons_status & UP_BUTTON)) { // Up button pressed
 
-                if (menu_showed == MENU_MODE){
+                if (live_all_data_mode){
+                    if ((!live_chart_view) && (live_first_row > 0)){
+                        live_first_row--;
+                        live_view_changed = true;
+                    }
+                }else if (menu_showed == MENU_MODE){
                     if(menu_cursor > 0){
                         menu_cursor--;
                         drawMenu();
@@ -120,7 +144,11 @@ static portTASK_FUNCTION(Button_pressed, pvParameters){
 
             }else if(!(buttons_status & OK_BUTTON)) { // Ok button pressed
 
-                if (menu_showed == MENU_MODE){
+                if (live_all_data_mode){
+                    // Change between list and strip chart
+                    live_chart_view = !live_chart_view;
+                    live_view_changed = true;
+                }else if (menu_showed == MENU_MODE){
 
                     xEventGroupSetBits(flagEvents, SELECT_CAN_COMMAND);
                 } else{
@@ -201,7 +229,7 @@ void init_AntiBounce(void){
 
 void init_buttonTasks(void){
 
-    if ((xTaskCreate(Button_pressed, (portCHAR *)"Buttons", 512, NULL,tskIDLE_PRIORITY + 1, &Button_taskHandler) != pdTRUE)){
+    if ((xTaskCreate(Button_pressed, (portCHAR *)"Buttons", 240, NULL,tskIDLE_PRIORITY + 1, &Button_taskHandler) != pdTRUE)){
 
         while(1);
     }
@@ -211,9 +239,11 @@ void AntiBounceIntHandler(void){
 
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+    trace_isrEnter(TRACE_ISR_BUTTONS_EDGE);
     GPIOIntClear(BUTTONS_PORT_BASE, BUTTONS_PIN);
 
     ROM_TimerEnable(TIMER3_BASE, TIMER_A);
+    trace_isrExit(TRACE_ISR_BUTTONS_EDGE);
 
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
@@ -225,6 +255,7 @@ void ButtonsIntHandler(void){
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     uint32_t pin_status;
 
+    trace_isrEnter(TRACE_ISR_BUTTONS_READ);
     ROM_TimerIntClear(TIMER3_BASE, TIMER_TIMA_TIMEOUT);
     ROM_TimerDisable(TIMER3_BASE, TIMER_A);
 
@@ -232,6 +263,7 @@ void ButtonsIntHandler(void){
     ROM_IntDisable(INT_GPIOE);
 
     xQueueSendFromISR(buttons_queue, &pin_status, &xHigherPriorityTaskWoken);
+    trace_isrExit(TRACE_ISR_BUTTONS_READ);
 
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
@@ -20,7 +20,7 @@
 //#include "inc/tm4c123gh6pm.h"
 //#include "inc/hw_memmap.h"
 //#include "inc/hw_gpio.h"
-//#include "inc/hw_types.h"
+#include "inc/hw_types.h"
 //#include "inc/hw_ints.h"
 #include "inc/hw_can.h"
 //#include "inc/hw_uart.h"
@@ -39,12 +39,26 @@
 #include "queue.h"
 #include "utils/cpu_usage.h"
 #include "event_groups.h"
+#include "semphr.h"
 
 // Programmer libraries
 #include "CAN_device.h"
+#include "OBD_HAL.h"
 #include "Graphic_interface.h"
 #include "ST7735.h"
 #include "Buttons.h"
+#include "PID_history.h"
+#include "PID_cache.h"
+#include "DTC_monitor.h"
+#include "DTC_dictionary.h"
+#include "SD_writer.h"
+#include "Cycle_probes.h"
+#include "Trace_recorder.h"
+#include "Live_logger.h"
+#include "Live_stream.h"
+#include "SLCAN_gateway.h"
+#include "CAN_sniffer.h"
+#include "Signal_decoder.h"
 //#include "sdcard.h"
 
 
@@ -56,13 +70,32 @@ static TaskHandle_t Erase_DTCs_taskHandler = NULL;
 static TaskHandle_t Get_VIN_taskHandler = NULL;
 static TaskHandle_t Freeze_frame_taskHandler = NULL;
 EventGroupHandle_t flagEvents;
+// CANTxMessage, CANRxMessage and CANLiveData (message objects) are shared by all the tasks
+static SemaphoreHandle_t CAN_busMutex;
 static tCANMsgObject CANTxMessage, CANRxMessage, CANLiveData;
 
 
 extern uint16_t menu_cursor, menu_ECU_cursor, menu_showed;
-static bool time_expired;
+// Set by the timeout ISR while the screens poll it
+static volatile bool time_expired;
 bool live_all_data_mode = false;
-extern bool left_button_state, menu_button_state, OnMenu;
+// Live data view: list of PIDs or strip chart of live_rows[chart_row] (changed with the buttons)
+bool live_chart_view = false, live_view_changed = false;
+uint8_t chart_row = 0;
+// Rows of the live data view (positions on pids_liveData supported by the ECU)
+uint8_t live_rows[NUM_LIVE_DATA_PIDS];
+uint8_t live_row_of[NUM_LIVE_DATA_PIDS];
+uint8_t live_numRows = 0, live_first_row = 0;
+// Broadcast signals view: the rows are the signals of Signal_database_signals. CANIntHandler
+// decodes the frames on broadcast_values and sets the bits of the signals not drawn yet.
+static bool broadcast_mode = false;
+static volatile bool broadcast_running = false;
+static float broadcast_values[SIGNAL_MAX_SIGNALS];
+static volatile uint64_t broadcast_updated = 0;
+static float broadcast_shown[SIGNAL_MAX_SIGNALS];      // Only the values that change are drawn again
+static uint32_t live_supported_mask = 0;
+extern volatile bool left_button_state, menu_button_state;
+extern bool OnMenu;
 uint32_t ECU_ID_Response, ECU_ID_Request;
 
 //*****************************************************************************
@@ -87,6 +120,12 @@ volatile bool g_bRXFlag = 0;
 //*****************************************************************************
 volatile bool g_ui32ErrFlag = 0;
 
+// Traffic and errors for the shell (get_CANstats): bits of the frames sent and received,
+// status interrupts with an error code and the last status
+static volatile uint32_t CAN_bits = 0;
+static volatile uint32_t CAN_errorCodes = 0;
+static volatile uint32_t CAN_lastStatus = 0;
+
 //*****************************************************************************
 
 //*****************************************************************************
@@ -98,6 +137,8 @@ volatile bool g_ui32ErrFlag = 0;
 //*****************************************************************************
 void CANIntHandler(void){
 
+    trace_isrEnter(TRACE_ISR_CAN);
+    uint32_t probe = PROBE_START();
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     uint32_t ui32Status;
 
@@ -119,11 +160,31 @@ void CANIntHandler(void){
            // API documentation for details about the error status bits.
            // The act of reading this status will clear the interrupt.
            ui32Status = CANStatusGet(CAN0_BASE, CAN_STS_CONTROL);
+           CAN_lastStatus = ui32Status;
+           if (((ui32Status & CAN_STATUS_LEC_MSK) != CAN_STATUS_LEC_NONE) &&
+               ((ui32Status & CAN_STATUS_LEC_MSK) != CAN_STATUS_LEC_MASK)){
+
+               CAN_errorCodes++;
+           }
 
            // Add ERROR flags to list of current errors. To be handled
           // later, because it would take too much time here in the interrupt.
            g_ui32ErrFlag |= ui32Status;
 
+       } else if(is_snifferRunning() && (ui32Status >= SNIFF_FIRST_OBJECT) && (ui32Status <= SNIFF_LAST_OBJECT)){
+           // Message objects of the sniffer (CAN_sniffer.h), which takes the ones of the
+           // gateway too
+           CAN_bits += sniffer_CANinterrupt(ui32Status);
+
+       } else if(broadcast_running && (ui32Status >= BROADCAST_FIRST_OBJECT) && (ui32Status <= BROADCAST_LAST_OBJECT)){
+           // FIFO of the broadcast signals view, on the objects of the gateway
+           CAN_bits += broadcast_CANinterrupt(ui32Status);
+
+       } else if((ui32Status >= SLCAN_FIRST_OBJECT) && (ui32Status <= SLCAN_LAST_OBJECT)){
+           // Message objects of the SLCAN gateway (SLCAN_gateway.h). Before the tests of
+           // RXOBJECT and TXOBJECT, which are bit masks and would take some of them.
+           CAN_bits += SLCAN_CANinterrupt(ui32Status);
+
        } else if(ui32Status & RXOBJECT){
            // Getting to this point means that the RX interrupt occurred on
            // message object RXOBJECT, and the message reception is complete.
@@ -167,6 +228,8 @@ void CANIntHandler(void){
 
        //xEventGroupSetBitsFromISR(flagEvents, CAN_STATUS, &xHigherPriorityTaskWoken);
 
+       probe_end(PROBE_CAN_ISR, probe);
+       trace_isrExit(TRACE_ISR_CAN);
        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 
 }
@@ -207,6 +270,10 @@ static portTASK_FUNCTION(Main_task, pvParameters){
                 case 5:
                     xEventGroupSetBits(flagEvents, READ_DTC_DRIVING_CYCLE);
                     break;
+
+                case 6:
+                    xEventGroupSetBits(flagEvents, BROADCAST_SIGNALS);
+                    break;
             }
         }else if (bitsReaded & SELECT_ECU_ADDRESS){
 
@@ -226,6 +293,13 @@ static portTASK_FUNCTION(Main_task, pvParameters){
                     ECU_ID_Request = ABS_REQUEST;
                     break;
                 }
+                // The history and the cached values belong to the previous ECU
+                for (int i = 0; i < NUM_LIVE_DATA_PIDS; i++){
+
+                    clear_PIDhistory(i);
+                }
+                invalidate_PIDcache();
+                post_SDsession("ECU selected", ECU_ID_Response);
                 menu_showed = MENU_MODE;
                 OnMenu = true;
                 menu_cursor = 0;
@@ -241,361 +315,211 @@ static portTASK_FUNCTION(Main_task, pvParameters){
 
 static portTASK_FUNCTION(Read_DTC, pvParameters){
 
-    uint8_t request_data_frame[MAX_BYTES];
-    uint8_t response_data_frame[MAX_BYTES];
     EventBits_t bitsReaded;
+    tDTCList DTCs;
+    bool pending, read, MIL;
+    char description[DTC_DESCRIPTION_LINE_CHARS+1];
+    uint16_t key;
+    uint8_t numMIL_DTCs;
 
     while(1){
 
         bitsReaded = xEventGroupWaitBits(flagEvents, READ_DTC_DRIVING_CYCLE | READ_DTC, pdTRUE, pdFALSE, portMAX_DELAY);
+        pending = (bitsReaded & READ_DTC_DRIVING_CYCLE) != 0;
 
+        menu_button_state = false;
+        left_button_state = false;
+        cleanScreen();
 
-        request_data_frame[0] = 0x01;
-        if (bitsReaded & READ_DTC_DRIVING_CYCLE){
-
-            request_data_frame[1] = 0x07;
-        }else {
-
-            request_data_frame[1] = 0x03;
-        }
-        for (int i = 2; i < MAX_BYTES; i++){
-
-            request_data_frame[i] = 0x55;
-        }
-
-        // Reception message object
-        // Initialize a message object to be used for receiving CAN messages with
-        // any CAN ID.  In order to receive any CAN ID, the ID and mask must both
-        // be set to 0, and the ID filter enabled.
-        CANRxMessage.pui8MsgData = (uint8_t *) &response_data_frame;
-        CANRxMessage.ui32MsgID = ECU_ID_Response;
-        CANRxMessage.ui32MsgIDMask = MASK_RESPONSE_ID;
-        CANRxMessage.ui32Flags = MSG_OBJ_RX_INT_ENABLE | MSG_OBJ_USE_ID_FILTER;
-        CANRxMessage.ui32MsgLen = 8; // 8 bytes
-
-        // Now load the message object into the CAN peripheral.  Once loaded the
-        // CAN will receive any message on the bus, and an interrupt will occur.
-        // Use message object RXOBJECT for receiving messages (this is not the
-        // same as the CAN ID which can be any value in this example).
-        CANMessageSet(CAN0_BASE, RXOBJECT, &CANRxMessage, MSG_OBJ_TYPE_RX);
-
-
-        // Transmission message object
-        CANTxMessage.pui8MsgData = request_data_frame;
-        CANTxMessage.ui32MsgLen = 8;
-        CANTxMessage.ui32Flags = MSG_OBJ_TX_INT_ENABLE;
-        CANTxMessage.ui32MsgIDMask = MASK_RESPONSE_ID;
-        CANTxMessage.ui32MsgID = REMOTE_REQUEST_ID;
-
-        CANMessageSet(CAN0_BASE, TXOBJECT, &CANTxMessage, MSG_OBJ_TYPE_TX);
-
-
-        bitsReaded = xEventGroupWaitBits(flagEvents, CAN_RX_INTERRUPT, pdTRUE, pdFALSE, portMAX_DELAY);
-
-        //if (bitsReaded & (CAN_RX_INTERRUPT|CAN_TX_INTERRUPT)){
-        if (bitsReaded & CAN_RX_INTERRUPT){
-
-            char *CAN_frame = NULL;
-            char *CAN_FirstFrame = NULL;
-            char *num_DTCs_Hex = NULL;
-            char decoded_DTC_buffer[NUM_CHAR_DTC+1];
-            char input_DTC_buffer[5];
-            uint16_t numDTCs;
-
-            menu_button_state = false;
-            left_button_state = false;
+        // The DTC monitor keeps the codes of every ECU, they are only read
+        // here if the monitor has not read them yet
+        read = get_DTCcache(ECU_ID_Response, pending, &DTCs);
+        if (!read){
 
-            // Read the message from the CAN.  Message object RXOBJECT is used
-            // (which is not the same thing as CAN ID).  The interrupt clearing
-            // flag is not set because this interrupt was already cleared in
-            // the interrupt handler.
-            time_expired = false;
-            config_systemPauseTimer(1/100);
-            system_pause();
-            while(!time_expired);
-            CANMessageGet(CAN0_BASE, RXOBJECT, &CANRxMessage, 0);
-
-            // Clear the pending message flag so that the interrupt handler can
-            // set it again when the next message arrives.
+            drawString(20, 55, "Reading DTCs", MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 20);
+            read = refresh_DTCcache(ECU_ID_Response) && get_DTCcache(ECU_ID_Response, pending, &DTCs);
             cleanScreen();
-            get_CANframe(&CAN_frame, (char*)&response_data_frame, true, false);
-
-            num_DTCs_Hex = (char*)pvPortMalloc(3*sizeof(char));
-            memcpy(num_DTCs_Hex, CAN_frame, 3);
-            num_DTCs_Hex[2] = '\0';
-            numDTCs = hex2Decimal(num_DTCs_Hex);
-
-            vPortFree(CAN_frame);
-            CAN_frame = NULL;
-
-            if (numDTCs > 0){
-
-                cleanScreen();
-                int offset_DTC = 2;
-                get_CANframe(&CAN_FirstFrame, (char*)&response_data_frame, false, false);
-                if (is_Multiframe(CAN_FirstFrame)){
-
-                    offset_DTC = 2;
-                    for (int i = 0; i < 2; i++){
-
-                        memcpy(input_DTC_buffer, CAN_FirstFrame+offset_DTC, 4);
-                        input_DTC_buffer[4] = '\0';
-                        get_DTC_decoded(input_DTC_buffer, decoded_DTC_buffer);
-                        showDTC(decoded_DTC_buffer, i*20);
-                        offset_DTC = offset_DTC + 4;
-                    }
-
-                    uint16_t contFrames = 0;
-                    int16_t numOfFrames = get_numberOfConsecutiveFrameToReceive(CAN_FirstFrame);
-
-                    CANMessageSet(CAN0_BASE, RXOBJECT, &CANRxMessage, MSG_OBJ_TYPE_RX);
-
-                    request_data_frame[0] = 0x30;
-                    for (int i = 1; i < MAX_BYTES; i++){
+        }
 
-                         request_data_frame[i] = 0x00;
-                    }
-                    CANTxMessage.pui8MsgData = request_data_frame;
-                    CANTxMessage.ui32MsgLen = 8;
-                    CANTxMessage.ui32MsgIDMask = MASK_RESPONSE_ID;
-                    CANTxMessage.ui32MsgID = ECU_ID_Request;
-
-                    // Wait 100ms to send the Flow Control Frame to ECU. TODO: Test it with least time
-                    time_expired = false;
-                    config_systemPauseTimer(1/100);
-                    system_pause();
-                    while(!time_expired);
-
-                    CANMessageSet(CAN0_BASE, TXOBJECT, &CANTxMessage, MSG_OBJ_TYPE_TX);
-
-                    int numDTCs_restantes = numDTCs;
-                    while(contFrames < numOfFrames){
-
-                        bitsReaded = xEventGroupWaitBits(flagEvents, CAN_RX_INTERRUPT, pdTRUE, pdFALSE, portMAX_DELAY);
-                        if (bitsReaded & CAN_RX_INTERRUPT){
-                            // Read the message from the CAN.  Message object RXOBJECT is used
-                            // (which is not the same thing as CAN ID).  The interrupt clearing
-                            // flag is not set because this interrupt was already cleared in
-                            // the interrupt handler.
-                            CANMessageGet(CAN0_BASE, RXOBJECT, &CANRxMessage, 0);
-
-                            get_CANframe(&CAN_frame, (char*)&response_data_frame, true, false);
-                            if (offset_DTC != 14){
-                                offset_DTC = 2;
-                                numDTCs_restantes = numDTCs - 2;
-                                for (int i = 0; i < numDTCs_restantes; i++){
-
-                                    if (offset_DTC != 14){
-                                        memcpy(input_DTC_buffer, CAN_frame+offset_DTC, 4);
-                                        input_DTC_buffer[4] = '\0';
-                                        get_DTC_decoded(input_DTC_buffer, decoded_DTC_buffer);
-                                        showDTC(decoded_DTC_buffer, 40+20*i);
-                                        offset_DTC = offset_DTC + 4;
-                                    }else {
-
-                                        i = numDTCs_restantes;
-                                        memcpy(input_DTC_buffer, CAN_frame+offset_DTC, 2);
-                                    }
-                                }
-                            }else {
-                                // save the last byte from the last DTC
-                                offset_DTC = 2;
-                                memcpy(input_DTC_buffer+offset_DTC, CAN_frame+offset_DTC, 4);
-                                input_DTC_buffer[4] = '\0';
-                                get_DTC_decoded(input_DTC_buffer, decoded_DTC_buffer);
-                                showDTC(decoded_DTC_buffer, 105);
-                            }
-                            contFrames++;
-                        }
-                        vPortFree(CAN_frame);
-                        CAN_frame = NULL;
-                    }
+        if (!read){
 
-                }else {
+            drawString(10, 50, "Error decoding DTCs due to reception error",  MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 10);
+        }else if (DTCs.numDTCs > 0){
 
+            for (int i = 0; (i < DTCs.numDTCs) && (i < DTC_VISIBLE_ROWS); i++){
 
-                    for (int i = 0; i < numDTCs; i++){
-
-                         memcpy(input_DTC_buffer, CAN_FirstFrame+offset_DTC, 4);
-                         input_DTC_buffer[4] = '\0';
-                         get_DTC_decoded(input_DTC_buffer, decoded_DTC_buffer);
-                         showDTC(decoded_DTC_buffer, i*20);
-                         get_CANframe(&CAN_FirstFrame, (char*)&response_data_frame, true, false);
-                         offset_DTC = offset_DTC + 4;
-                     }
+                showDTC(DTCs.codes[i], i*20);
+                // Description under the code, cut to one line
+                if (DTC_code2key(DTCs.codes[i], &key) && get_DTCdescription(key, description, sizeof(description))){
 
+                    drawString(10, 20+i*20, description, MENU_ITEM_UNSELECTED_TEXT_COLOUR, ST7735_BLACK, 1, 10);
                 }
-
-            }else {
-
-                drawString(20, 55, "0 DTCs stored", MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 20);
             }
+        }else {
 
-            vPortFree(CAN_frame);
-            vPortFree(num_DTCs_Hex);
-            vPortFree(CAN_FirstFrame);
-            while((!menu_button_state) && (!left_button_state));
-            cleanScreen();
-            menu_cursor = 0;
-            OnMenu = true;
-            menu_showed = MENU_MODE;
-            drawMenu();
+            drawString(20, 55, "0 DTCs stored", MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 20);
         }
+        // Lamp of the ECU (01 01 of the monitor), right of the first code
+        if (read && get_MILstatus(ECU_ID_Response, &MIL, &numMIL_DTCs)){
 
+            drawString(115, 10, MIL ? "MIL ON" : "MIL OFF", MIL ? MENU_DATA_TEXT_COLOUR : MENU_ITEM_UNSELECTED_TEXT_COLOUR,
+                       ST7735_BLACK, 1, 115);
+        }
+
+        while((!menu_button_state) && (!left_button_state));
+        cleanScreen();
+        menu_cursor = 0;
+        OnMenu = true;
+        menu_showed = MENU_MODE;
+        drawMenu();
     }
 
 }
 
 static portTASK_FUNCTION(Live_all_data, pvParameters){
 
-    double realTime_values[NUM_LIVE_DATA_PIDS];
-    char *CAN_data = NULL;
-    uint8_t requestFrame_liveData[MAX_BYTES];
-    uint8_t response_data_frame[MAX_BYTES];
-    EventBits_t bitsReaded;
     uint8_t cont = 0;
     uint8_t posPID;
-    char *pids_freezeData = NULL;
-    uint16_t numPIDs_supported = 0;
-
-
-    // The same for all tx frames
-    requestFrame_liveData[0] = 0x02;
-    requestFrame_liveData[1] = 0x01;
-    for (int i = 3; i < MAX_BYTES; i++){
-
-        requestFrame_liveData[i] = 0xA5;
-    }
+    uint8_t poll_list[NUM_LIVE_DATA_PIDS];
+    uint8_t numPIDs_polled = 0;
+    bool chart_shown = false;
+    tPIDHistoryColumn column;
+    tPIDCacheEntry entry;
+    // Last response shown of every PID and columns of the chart already drawn
+    uint32_t shown_sequence[NUM_LIVE_DATA_PIDS] = {0};
+    uint32_t chart_columns = 0, columns;
+    bool new_values = false;
+    EventBits_t bitsReaded;
 
-    // Transmission message object
-    CANLiveData.pui8MsgData = (uint8_t *) &requestFrame_liveData;
-    // Same for all frames
-    CANLiveData.ui32MsgLen = 3;
-    CANLiveData.ui32Flags = MSG_OBJ_TX_INT_ENABLE;
-    CANLiveData.ui32MsgIDMask = 0;
-    CANLiveData.ui32MsgID = REMOTE_REQUEST_ID;
 
     while(1){
 
-        xEventGroupWaitBits(flagEvents, LIVE_ALL_DATA, pdTRUE, pdFALSE, portMAX_DELAY);
+        bitsReaded = xEventGroupWaitBits(flagEvents, LIVE_ALL_DATA|BROADCAST_SIGNALS, pdTRUE, pdFALSE, portMAX_DELAY);
+        // Same rows and buttons, without requests to the ECU
+        if (bitsReaded & BROADCAST_SIGNALS){
 
-        live_all_data_mode = true;
-        // Reception message object
-        // Initialize a message object to be used for receiving CAN messages with
-        // any CAN ID.  In order to receive any CAN ID, the ID and mask must both
-        // be set to 0, and the ID filter enabled.
-        /*CANRxMessage.pui8MsgData = (uint8_t *) &response_data_frame;
-        CANRxMessage.ui32MsgID = ECU_ID_Response;
-        CANRxMessage.ui32MsgIDMask = MASK_RESPONSE_ID;
-        CANRxMessage.ui32Flags = MSG_OBJ_RX_INT_ENABLE | MSG_OBJ_USE_ID_FILTER;
-        CANRxMessage.ui32MsgLen = 8; // 8 bytes
+            show_broadcastSignals();
+            continue;
+        }
 
-        // Now load the message object into the CAN peripheral.  Once loaded the
-        // CAN will receive any message on the bus, and an interrupt will occur.
-        // Use message object RXOBJECT for receiving messages (this is not the
-        // same as the CAN ID which can be any value in this example).
-        CANMessageSet(CAN0_BASE, RXOBJECT, &CANRxMessage, MSG_OBJ_TYPE_RX);*/
+        live_all_data_mode = true;
 
         cleanScreen();
+        drawString(20, 55, "Reading supported PIDs", MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 20);
         cont = 0;
         left_button_state = false;
         menu_button_state = false;
-        GPIOIntDisable(BUTTONS_PORT_BASE, RIGHT_BUTTON | DOWN_BUTTON | UP_BUTTON | OK_BUTTON);
+        live_chart_view = false;
+        live_first_row = 0;
+        chart_row = 0;
+        chart_shown = false;
 
-        if (ECU_ID_Response != ECM_RESPONSE){
+        // Rows of the view: PIDs of pids_liveData supported by the ECU
+        get_liveDataRows();
+        // Every response of the view is recorded on the SD card
+        start_liveLogger();
 
-            request_PIDs_supportedOnMode01(&pids_freezeData);
-            // Substract 0x1C PID because its decoding does not implemented
-            numPIDs_supported = sizeOfFrame(pids_freezeData)-1;
-
-        }else {
-            // Not all PIDs decoding are implemented for ECM
-            numPIDs_supported = NUM_LIVE_DATA_PIDS;
-        }
-
-        CANRxMessage.pui8MsgData = (uint8_t *) &response_data_frame;
-        CANRxMessage.ui32MsgID = ECU_ID_Response;
-        CANRxMessage.ui32MsgIDMask = MASK_RESPONSE_ID;
-        CANRxMessage.ui32Flags = MSG_OBJ_RX_INT_ENABLE | MSG_OBJ_USE_ID_FILTER;
-        CANRxMessage.ui32MsgLen = 8; // 8 bytes
-
-        CANMessageSet(CAN0_BASE, RXOBJECT, &CANRxMessage, MSG_OBJ_TYPE_RX);
+        // Draw the first view
+        live_view_changed = true;
 
         // Left button to skip
         while ((!left_button_state) && (!menu_button_state)){
 
-            if  (ECU_ID_Response != ECM_RESPONSE){
+            if (live_view_changed){
 
-                requestFrame_liveData[2] = pids_freezeData[cont];
+                live_view_changed = false;
+                if (chart_row >= live_numRows){
 
-            }else {
+                    chart_row = 0;
+                }
 
-                requestFrame_liveData[2] = pids_liveData[cont];
-            }
-            CANMessageSet(CAN0_BASE, TXOBJECT, &CANLiveData, MSG_OBJ_TYPE_TX);
+                if (live_chart_view && (live_numRows > 0)){
 
-            bitsReaded = xEventGroupWaitBits(flagEvents, CAN_ERROR_INTERRUPT|CAN_TX_INTERRUPT, pdTRUE, pdFALSE, portMAX_DELAY);
-            if(bitsReaded & CAN_ERROR_INTERRUPT){
+                    drawStripChart(live_rows[chart_row]);
+                    chart_columns = get_PIDhistoryTotalSamples(live_rows[chart_row])/PID_HISTORY_DECIMATION;
+                    chart_shown = true;
+                }else {
 
-                cleanScreen();
-                check_CANerrors();
+                    if (chart_shown){
+
+                        exit_stripChart();
+                        chart_shown = false;
+                    }
+                    show_liveDataRows();
+                    // Cached values are drawn again on the new rows
+                    memset(shown_sequence, 0, sizeof(shown_sequence));
+                }
+                // The polled PIDs follow the view, so scrolling changes them immediately
+                numPIDs_polled = get_livePollList(poll_list);
+                cont = 0;
             }
 
-            bitsReaded = xEventGroupWaitBits(flagEvents, CAN_RX_INTERRUPT, pdTRUE, pdFALSE, MAX_TIME_TO_WAIT_MS);
-            if (bitsReaded & CAN_RX_INTERRUPT){
+            if (numPIDs_polled == 0){
+                // Nothing on screen
+                vTaskDelay(MAX_TIME_TO_WAIT_MS/portTICK_PERIOD_MS);
+                continue;
+            }
 
-                uint16_t dataA = 0;
-                uint16_t dataB = 0;
+            // The cache only goes to the bus if the value is older than the TTL
+            // or nobody else is already requesting it
+            posPID = poll_list[cont];
+            if (get_PIDvalue(posPID, PID_CACHE_TTL_MS/portTICK_PERIOD_MS, &entry) && (entry.sequence != shown_sequence[posPID])){
 
-                // Read the message from the CAN.  Message object RXOBJECT is used
-                // (which is not the same thing as CAN ID).  The interrupt clearing
-                // flag is not set because this interrupt was already cleared in
-                // the interrupt handler.
-                CANMessageGet(CAN0_BASE, RXOBJECT, &CANRxMessage, 0);
+                shown_sequence[posPID] = entry.sequence;
+                new_values = true;
 
-                get_CANframe(&CAN_data, (char*)response_data_frame, true, false);
-                // Return the size of the frame in hex format (1 byte, 2 positions)
-                // if there are 2 data bytes(>= 4 positions)...
-                if (sizeOfFrame(CAN_data) >= 4){
-                    char CAN_frame_1[3];
-                    CAN_frame_1[0] = CAN_data[0];
-                    CAN_frame_1[1] = CAN_data[1];
-                    CAN_frame_1[2] ='\0';
+                if (live_chart_view){
 
-                    char CAN_frame_2[3];
-                    CAN_frame_2[0] = CAN_data[2];
-                    CAN_frame_2[1] = CAN_data[3];
-                    CAN_frame_2[2] ='\0';
+                    if (posPID == live_rows[chart_row]){
+                        // Only the new columns are drawn, the rest of the chart is scrolled
+                        columns = get_PIDhistoryTotalSamples(posPID)/PID_HISTORY_DECIMATION;
+                        while (chart_columns < columns){
 
-                    dataA = hex2Decimal(CAN_frame_1);
-                    dataB = hex2Decimal(CAN_frame_2);
+                            if (get_PIDhistoryColumn(posPID, columns-1-chart_columns, &column)){
 
+                                drawStripChartColumn(column.min, column.max, posPID);
+                            }
+                            chart_columns++;
+                        }
+                        drawStripChartValue(entry.value);
+                    }
+                }else {
+                    // The poll list of a scrolled view can still have a PID of the old rows
+                    uint8_t row = live_row_of[posPID];
 
-                } else{
+                    if ((row >= live_first_row) && (row < live_first_row+LIVE_DATA_VISIBLE_ROWS)){
 
-                    dataA = hex2Decimal(CAN_data);
+                        cleanData(row-live_first_row);
+                        show_liveDataValue(entry.value, row-live_first_row);
+                    }
                 }
-                vPortFree(CAN_data);
-                CAN_data = NULL;
-                posPID = get_posPID((char*)response_data_frame);
-                realTime_values[posPID] = decode_CANdata(posPID, (double)dataA, (double)dataB);
             }
-            cleanData(cont);
-            show_liveData(realTime_values[posPID], posPID);
             cont++;
-            if (cont == numPIDs_supported){
+            if (cont >= numPIDs_polled){
 
                 cont = 0;
+                // Nothing new on a whole round (values refreshed by other consumers
+                // or no answer), wait instead of spinning over the cache
+                if (!new_values){
+
+                    vTaskDelay(PID_CACHE_TTL_MS/portTICK_PERIOD_MS);
+                }
+                new_values = false;
             }
 
         }
         // Back to menu
+        stop_liveLogger();
         live_all_data_mode = false;
+        if (chart_shown){
+
+            exit_stripChart();
+        }
+        live_chart_view = false;
         cleanScreen();
         OnMenu = true;
         menu_showed = MENU_MODE;
         drawMenu();
-        GPIOIntEnable(BUTTONS_PORT_BASE, RIGHT_BUTTON | DOWN_BUTTON | UP_BUTTON | OK_BUTTON);
 
     }
 
@@ -611,6 +535,7 @@ static portTASK_FUNCTION(Erase_DTCs, pvParameters){
     while(1){
 
         xEventGroupWaitBits(flagEvents, ERASE_DTC, pdTRUE, pdFALSE, portMAX_DELAY);
+        take_CANbus(portMAX_DELAY);
 
         time_expired = false;
 
@@ -673,6 +598,8 @@ static portTASK_FUNCTION(Erase_DTCs, pvParameters){
             if ((CAN_frame[2] == '4') && (CAN_frame[3] == '4')){
 
                 drawString(10, 50, "DTCs correctly cleared\n\n     MIL Status: OFF\n", MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 0);
+                // The monitor reads again the DTCs of all the ECUs
+                invalidate_DTCcache();
             } else{
 
                 drawString(20, 50, "Error clearing DTCs\n\n        MIL Status: ON\n", MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 0);
@@ -686,6 +613,7 @@ static portTASK_FUNCTION(Erase_DTCs, pvParameters){
             cleanScreen();
             drawString(20, 50, "There is not DTCs\n\n    MIL Status: OFF", MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 0);
         }
+        give_CANbus();
         config_systemPauseTimer(4);
         system_pause();
         while(!time_expired);
@@ -700,9 +628,8 @@ static portTASK_FUNCTION(Erase_DTCs, pvParameters){
 
 static portTASK_FUNCTION(Get_VIN, pvParameters){
 
-    uint8_t request_data_frame[MAX_BYTES];
-    uint8_t response_data_frame[MAX_BYTES];
-    EventBits_t bitsReaded;
+    char VIN[MAX_VIN_BYTES];
+    bool read;
 
 
     while(1){
@@ -711,128 +638,19 @@ static portTASK_FUNCTION(Get_VIN, pvParameters){
 
         if (ECU_ID_Response == ECM_RESPONSE){
 
+            cleanScreen();
+            take_CANbus(portMAX_DELAY);
             time_expired = false;
 
-            // Reception message object
-            // Initialize a message object to be used for receiving CAN messages with
-            // any CAN ID.  In order to receive any CAN ID, the ID and mask must both
-            // be set to 0, and the ID filter enabled.
-            CANRxMessage.pui8MsgData = response_data_frame;
-            CANRxMessage.ui32MsgID = ECU_ID_Response;
-            CANRxMessage.ui32MsgIDMask = MASK_RESPONSE_ID;
-            CANRxMessage.ui32Flags = MSG_OBJ_RX_INT_ENABLE | MSG_OBJ_USE_ID_FILTER;
-            CANRxMessage.ui32MsgLen = 8; // 8 bytes
-
-            // Now load the message object into the CAN peripheral.  Once loaded the
-            // CAN will receive any message on the bus, and an interrupt will occur.
-            // Use message object RXOBJECT for receiving messages (this is not the
-            // same as the CAN ID which can be any value in this example).
-            CANMessageSet(CAN0_BASE, RXOBJECT, &CANRxMessage, MSG_OBJ_TYPE_RX);
-
-            request_data_frame[0] = 0x02;
-            request_data_frame[1] = 0x09;
-            request_data_frame[2] = 0x02;
-            for (int i = 3; i < MAX_BYTES; i++){
+            // Mode 09 PID 02, the 17 characters come on a multi frame response
+            read = read_VIN(ECU_ID_Request, ECU_ID_Response, VIN);
+            give_CANbus();
+            if (read){
 
-                request_data_frame[i] = 0x55;
-            }
-
-
-            // Transmission message object
-            CANTxMessage.pui8MsgData = request_data_frame;
-            CANTxMessage.ui32MsgLen = 3;
-            CANTxMessage.ui32Flags = MSG_OBJ_TX_INT_ENABLE;
-            CANTxMessage.ui32MsgIDMask = MASK_RESPONSE_ID;
-            CANTxMessage.ui32MsgID = REMOTE_REQUEST_ID;
-
-            CANMessageSet(CAN0_BASE, TXOBJECT, &CANTxMessage, MSG_OBJ_TYPE_TX);
-
-            bitsReaded = xEventGroupWaitBits(flagEvents, CAN_ERROR_INTERRUPT|CAN_TX_INTERRUPT, pdTRUE, pdFALSE, portMAX_DELAY);
-            if(bitsReaded & CAN_TX_INTERRUPT){
-
-               cleanScreen();
-               //drawString(35, 50, "\nCAN message sent\n", ST7735_WHITE, ST7735_BLACK, 1, 0);
-           } else if (bitsReaded & CAN_ERROR_INTERRUPT){
-
-               cleanScreen();
-               check_CANerrors();
-           }
-
-            bitsReaded = xEventGroupWaitBits(flagEvents, CAN_RX_INTERRUPT, pdTRUE, pdFALSE, MAX_TIME_TO_WAIT_MS);
-            if (bitsReaded & CAN_RX_INTERRUPT){
-
-                char *CAN_frame = NULL;
-                char *CAN_FirstFrame = NULL;
-                char VIN[MAX_VIN_BYTES];
-                int numBytes_data;
-
-                CANMessageGet(CAN0_BASE, RXOBJECT, &CANRxMessage, 0);
-
-                cleanScreen();
-
-                drawString(70, 50, "VIN", ST7735_WHITE, ST7735_BLACK, 1, 0);
-
-                get_CANframe(&CAN_FirstFrame, (char*)&response_data_frame, false, false);
-                if (is_Multiframe(CAN_FirstFrame)){
-
-                    get_CANframe(&CAN_frame, (char*)&response_data_frame, true, true);
-                    numBytes_data = sizeOfFrame(CAN_frame);
-
-                    memcpy(VIN, CAN_frame, numBytes_data);
-                    VIN[numBytes_data] = '\0';
-
-                    uint16_t contFrames = 0;
-                    int16_t numOfFrames = get_numberOfConsecutiveFrameToReceive(CAN_FirstFrame);
-
-                    request_data_frame[0] = 0x30;
-                    for (int i = 1; i < MAX_BYTES; i++){
-
-                         request_data_frame[i] = 0x00;
-                    }
-                    CANTxMessage.pui8MsgData = request_data_frame;
-                    CANTxMessage.ui32Flags = MSG_OBJ_NO_FLAGS;
-                    CANTxMessage.ui32MsgLen = 8;
-                    CANTxMessage.ui32MsgIDMask = MASK_RESPONSE_ID;
-                    CANTxMessage.ui32MsgID = ECU_ID_Request;
-
-                    CANMessageSet(CAN0_BASE, TXOBJECT, &CANTxMessage, MSG_OBJ_TYPE_TX);
-
-                    int numBytes_readed = numBytes_data;
-
-                    while(contFrames < numOfFrames){
-                        vPortFree(CAN_frame);
-                        CAN_frame = NULL;
-
-                        bitsReaded = xEventGroupWaitBits(flagEvents, CAN_RX_INTERRUPT, pdTRUE, pdFALSE, MAX_TIME_TO_WAIT_MS);
-                        if (bitsReaded & CAN_RX_INTERRUPT){
-                            // Read the message from the CAN.  Message object RXOBJECT is used
-                            // (which is not the same thing as CAN ID).  The interrupt clearing
-                            // flag is not set because this interrupt was already cleared in
-                            // the interrupt handler.
-                            CANMessageGet(CAN0_BASE, RXOBJECT, &CANRxMessage, 0);
-
-                            get_CANframe(&CAN_frame, (char*)&response_data_frame, true, true);
-                            numBytes_data = sizeOfFrame(CAN_frame);
-
-                            memcpy(VIN+numBytes_readed, CAN_frame, numBytes_data);
-                            numBytes_readed += numBytes_data;
-                            VIN[numBytes_readed] = '\0';
-                        }
-                        contFrames++;
-                    }
-
-                }else {
-
-                    get_CANframe(&CAN_frame, (char*)&response_data_frame, true, true);
-                    numBytes_data = sizeOfFrame(CAN_frame);
-
-                    memcpy(VIN, CAN_frame, numBytes_data);
-                    VIN[numBytes_data] = '\0';
-                }
+                show_VIN(VIN);
+            }else {
 
-                drawString(25, 70, VIN,  ST7735_WHITE, ST7735_BLACK, 1, 0);
-                vPortFree(CAN_frame);
-                vPortFree(CAN_FirstFrame);
+                drawString(20, 50, "Error reading the VIN", MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 0);
             }
             config_systemPauseTimer(4);
             system_pause();
@@ -881,6 +699,8 @@ static portTASK_FUNCTION(Freeze_frame, pvParameters){
 
             uint8_t cont = 0;
 
+            take_CANbus(portMAX_DELAY);
+
             // Reception message object
             // Initialize a message object to be used for receiving CAN messages with
             // any CAN ID.  In order to receive any CAN ID, the ID and mask must both
@@ -1038,6 +858,7 @@ static portTASK_FUNCTION(Freeze_frame, pvParameters){
                     cleanScreen();
                     drawString(10, 50, "Error decoding DTCs due to transmission error",  MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 10);
                 }
+                give_CANbus();
                 config_systemPauseTimer(4);
                 system_pause();
                 time_expired = false;
@@ -1052,6 +873,7 @@ static portTASK_FUNCTION(Freeze_frame, pvParameters){
 
                 cleanScreen();
                 drawString(10, 50, "Error decoding DTCs due to reception error",  MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 10);
+                give_CANbus();
             }
 
         }else {
@@ -1077,37 +899,172 @@ void init_flagEvents(void){
 
     // Create events group
     flagEvents = xEventGroupCreate();
+
+    // Create the mutex of the CAN bus
+    CAN_busMutex = xSemaphoreCreateMutex();
+    configASSERT(CAN_busMutex != NULL);
+}
+
+// A whole request/response transaction has to be done with the bus taken
+bool take_CANbus(TickType_t timeout){
+
+    return (xSemaphoreTake(CAN_busMutex, timeout) == pdTRUE);
+}
+
+void give_CANbus(void){
+
+    xSemaphoreGive(CAN_busMutex);
+}
+
+// Bits of a frame on the bus without the stuff bits: 47 with an ID of 11 bits, 67 with 29 bits
+static uint32_t CAN_frameBits(uint32_t length, bool extended){
+
+    return (extended ? 67 : 47) + 8*length;
+}
+
+void get_CANstats(tCANStats *stats){
+
+    stats->tx_frames = g_ui32TXMsgCount;
+    stats->rx_frames = g_ui32RXMsgCount;
+    stats->bits = CAN_bits;
+    stats->error_codes = CAN_errorCodes;
+    stats->status = CAN_lastStatus;
+    stats->passive = CANErrCntrGet(CAN0_BASE, &stats->rx_errors, &stats->tx_errors);
+}
+
+// Internal loopback of the test mode: the frames sent are received by the device itself, nothing
+// goes to the bus and the frames of the bus are not received. The bus has to be taken.
+void set_CANloopback(bool on){
+
+    if (on){
+
+        HWREG(CAN0_BASE + CAN_O_CTL) |= CAN_CTL_TEST;
+        HWREG(CAN0_BASE + CAN_O_TST) |= CAN_TST_LBACK | CAN_TST_SILENT;
+    }else {
+
+        HWREG(CAN0_BASE + CAN_O_TST) &= ~(CAN_TST_LBACK | CAN_TST_SILENT);
+        HWREG(CAN0_BASE + CAN_O_CTL) &= ~CAN_CTL_TEST;
+    }
+}
+
+// Silent mode of the test mode: the frames of the bus are received but the device sends nothing,
+// not even the ACK or an error frame, so it can listen to a bus without changing it
+void set_CANsilent(bool on){
+
+    if (on){
+
+        HWREG(CAN0_BASE + CAN_O_CTL) |= CAN_CTL_TEST;
+        HWREG(CAN0_BASE + CAN_O_TST) |= CAN_TST_SILENT;
+    }else {
+
+        HWREG(CAN0_BASE + CAN_O_TST) &= ~CAN_TST_SILENT;
+        HWREG(CAN0_BASE + CAN_O_CTL) &= ~CAN_CTL_TEST;
+    }
+}
+
+// Reception filter of the OBD protocol (OBD_HAL.h). The data of the frame is copied by
+// hal_CANreceive, CAN_receptionData is only there for the message object.
+void hal_CANsetReception(uint32_t response_ID, uint32_t mask){
+
+    static uint8_t CAN_receptionData[MAX_BYTES];
+
+    CANRxMessage.pui8MsgData = CAN_receptionData;
+    CANRxMessage.ui32MsgID = response_ID;
+    CANRxMessage.ui32MsgIDMask = mask;
+    CANRxMessage.ui32Flags = MSG_OBJ_RX_INT_ENABLE | MSG_OBJ_USE_ID_FILTER;
+    CANRxMessage.ui32MsgLen = 8; // 8 bytes
+    CANMessageSet(CAN0_BASE, RXOBJECT, &CANRxMessage, MSG_OBJ_TYPE_RX);
+}
+
+// Send a frame and wait until it is transmitted. Return false on timeout.
+bool hal_CANsend(uint32_t ID, const uint8_t data[], uint8_t length){
+
+    EventBits_t bitsReaded;
+
+    CANLiveData.pui8MsgData = (uint8_t *)data;
+    CANLiveData.ui32MsgLen = length;
+    CANLiveData.ui32Flags = MSG_OBJ_TX_INT_ENABLE;
+    CANLiveData.ui32MsgIDMask = 0;
+    CANLiveData.ui32MsgID = ID;
+
+    // Events of a previous transaction (late answers) must not be taken as this one
+    xEventGroupClearBits(flagEvents, CAN_RX_INTERRUPT|CAN_TX_INTERRUPT|CAN_ERROR_INTERRUPT);
+    CANMessageSet(CAN0_BASE, TXOBJECT, &CANLiveData, MSG_OBJ_TYPE_TX);
+
+    bitsReaded = xEventGroupWaitBits(flagEvents, CAN_ERROR_INTERRUPT|CAN_TX_INTERRUPT, pdTRUE, pdFALSE, MAX_TIME_TO_WAIT_MS);
+    if (!(bitsReaded & CAN_TX_INTERRUPT)){
+
+        return false;
+    }
+    log_CANframe(ID, data, length, CAN_CAPTURE_TX);
+    stream_CANframe(ID, data, length, CAN_CAPTURE_TX);
+    CAN_bits += CAN_frameBits(length, ID > MASK_RESPONSE_ID);
+
+    return true;
+}
+
+// Wait for the next frame on the reception message object. Return false on timeout.
+bool hal_CANreceive(uint32_t *ID, uint8_t data[], uint32_t timeout_ms){
+
+    EventBits_t bitsReaded;
+
+    bitsReaded = xEventGroupWaitBits(flagEvents, CAN_RX_INTERRUPT, pdTRUE, pdFALSE, timeout_ms/portTICK_PERIOD_MS);
+    if (!(bitsReaded & CAN_RX_INTERRUPT)){
+
+        return false;
+    }
+
+    // Read the message from the CAN.  Message object RXOBJECT is used
+    // (which is not the same thing as CAN ID).  The interrupt clearing
+    // flag is not set because this interrupt was already cleared in
+    // the interrupt handler.
+    CANRxMessage.pui8MsgData = data;
+    CANMessageGet(CAN0_BASE, RXOBJECT, &CANRxMessage, 0);
+    log_CANframe(CANRxMessage.ui32MsgID, data, CANRxMessage.ui32MsgLen,
+                 (CANRxMessage.ui32Flags & MSG_OBJ_EXTENDED_ID) ? CAN_CAPTURE_EXTENDED : 0);
+    stream_CANframe(CANRxMessage.ui32MsgID, data, CANRxMessage.ui32MsgLen,
+                    (CANRxMessage.ui32Flags & MSG_OBJ_EXTENDED_ID) ? CAN_CAPTURE_EXTENDED : 0);
+    *ID = CANRxMessage.ui32MsgID;
+    CAN_bits += CAN_frameBits(CANRxMessage.ui32MsgLen, (CANRxMessage.ui32Flags & MSG_OBJ_EXTENDED_ID) != 0);
+
+    return true;
+}
+
+// Same as request_ECUdata with the ECU selected on the menu (functional request)
+bool request_OBDdata(uint8_t mode, uint8_t PID, uint8_t response_data_frame[], uint32_t *ECU_ID){
+
+    return request_ECUdata(REMOTE_REQUEST_ID, ECU_ID_Response, mode, PID, response_data_frame, ECU_ID);
 }
 
 void init_deviceTasks(void){
 
 
-    if ((xTaskCreate(Read_DTC, (portCHAR *)"Read_DTC", 512, NULL,tskIDLE_PRIORITY + 0, &DTC_taskHandler) != pdTRUE)){
+    if ((xTaskCreate(Read_DTC, (portCHAR *)"Read_DTC", 288, NULL,tskIDLE_PRIORITY + 0, &DTC_taskHandler) != pdTRUE)){
 
             while(1);
     }
 
-    if ((xTaskCreate(Main_task, (portCHAR *)"MAIN_TASK", 512, NULL,tskIDLE_PRIORITY + 0, &Main_taskHandler) != pdTRUE)){
+    if ((xTaskCreate(Main_task, (portCHAR *)"MAIN_TASK", 256, NULL,tskIDLE_PRIORITY + 0, &Main_taskHandler) != pdTRUE)){
 
             while(1);
     }
 
-    if ((xTaskCreate(Live_all_data, (portCHAR *)"LIVE_DATA", 512, NULL,tskIDLE_PRIORITY + 0, &Live_data_taskHandler) != pdTRUE)){
+    if ((xTaskCreate(Live_all_data, (portCHAR *)"LIVE_DATA", 400, NULL,tskIDLE_PRIORITY + 0, &Live_data_taskHandler) != pdTRUE)){
 
             while(1);
     }
 
-    if ((xTaskCreate(Erase_DTCs, (portCHAR *)"ERASE_DTCS", 512, NULL,tskIDLE_PRIORITY + 0, &Erase_DTCs_taskHandler) != pdTRUE)){
+    if ((xTaskCreate(Erase_DTCs, (portCHAR *)"ERASE_DTCS", 272, NULL,tskIDLE_PRIORITY + 0, &Erase_DTCs_taskHandler) != pdTRUE)){
 
             while(1);
     }
 
-    if ((xTaskCreate(Get_VIN, (portCHAR *)"GET_VIN", 512, NULL,tskIDLE_PRIORITY + 0, &Get_VIN_taskHandler) != pdTRUE)){
+    if ((xTaskCreate(Get_VIN, (portCHAR *)"GET_VIN", 272, NULL,tskIDLE_PRIORITY + 0, &Get_VIN_taskHandler) != pdTRUE)){
 
             while(1);
     }
 
-    if ((xTaskCreate(Freeze_frame, (portCHAR *)"FREEZE_FRAME", 512, NULL,tskIDLE_PRIORITY + 0, &Freeze_frame_taskHandler) != pdTRUE)){
+    if ((xTaskCreate(Freeze_frame, (portCHAR *)"FREEZE_FRAME", 304, NULL,tskIDLE_PRIORITY + 0, &Freeze_frame_taskHandler) != pdTRUE)){
 
             while(1);
     }
@@ -1352,52 +1309,233 @@ int16_t get_posPID(char *CAN_frame){
     return -1;
 }
 
-double decode_CANdata(uint8_t posPID, double dataA, double dataB){
+void show_liveData(double value, uint8_t dataPos){
 
-    double data_decoded;
+    show_liveDataValue(value, dataPos);
+    drawString(5, 5+(dataPos*10), liveData_strings[dataPos], MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 20);
+}
 
-    switch(posPID){
-    case 0:
-        data_decoded = (double)dataA*100/255;
-        break;
+void show_liveDataRows(void){
 
-    case 1:
-        data_decoded = dataA-40;
-        break;
+    char footer[12];
+    const char *label;
+    uint8_t last_row = live_first_row + LIVE_DATA_VISIBLE_ROWS;
 
-    case 2:
-        data_decoded = (dataA-128)*100/128;
-        break;
+    if (last_row > live_numRows){
 
-    case 3:
-        data_decoded = (dataA-128)*100/128;
-        break;
+        last_row = live_numRows;
+    }
+
+    cleanScreen();
+    if (live_numRows == 0){
 
-    case 4:
-        data_decoded = ((dataA*256)+dataB)/4;
-        break;
+        drawString(20, 55, "No live data supported", MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 20);
+        return;
+    }
 
-    case 5:
-        data_decoded = dataA;
-        break;
+    for (uint8_t row = live_first_row; row < last_row; row++){
 
+        label = broadcast_mode ? Signal_database_labels[row] : liveData_strings[live_rows[row]];
+        drawString(5, 5+((row-live_first_row)*10), label, MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 20);
     }
 
-    return data_decoded;
+    if (live_numRows > LIVE_DATA_VISIBLE_ROWS){
+
+        snprintf(footer, sizeof(footer), "%d-%d/%d", live_first_row+1, last_row, live_numRows);
+        drawString(5, 5+(LIVE_DATA_VISIBLE_ROWS*10)+5, footer, MENU_ITEM_UNSELECTED_TEXT_COLOUR, ST7735_BLACK, 1, 20);
+    }
 }
 
-void show_liveData(double value, uint8_t dataPos){
+// Fill the rows of the live data view with the PIDs of pids_liveData supported by the ECU
+void get_liveDataRows(void){
 
-    char output[7];
+    uint8_t bitmap[4];
+    bool answered;
 
-    snprintf(output, 6, "%f", value);
+    take_CANbus(portMAX_DELAY);
+    answered = request_PIDs_supportedOnMode01(bitmap);
+    give_CANbus();
 
-    if (output[4] == '.'){
+    live_numRows = 0;
+    live_supported_mask = 0;
+    for (uint8_t i = 0; i < NUM_LIVE_DATA_PIDS; i++){
 
-        tabular(output);
+        uint8_t PID = pids_liveData[i];
+
+        live_row_of[i] = NUM_LIVE_DATA_PIDS;
+        // Without answer all the PIDs are tried
+        if ((!answered) || (bitmap[(PID - 1)/8] & (0x80 >> ((PID - 1) % 8)))){
+
+            live_rows[live_numRows] = i;
+            live_row_of[i] = live_numRows;
+            live_supported_mask |= (1UL << i);
+            live_numRows++;
+        }
     }
-    drawString(120, 5+(dataPos*10), output, MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 20);
-    drawString(5, 5+(dataPos*10), liveData_strings[dataPos], MENU_DATA_TEXT_COLOUR, ST7735_BLACK, 1, 20);
+}
+
+// Fill poll_list with the PIDs to be requested: the ones on the view (the logger records the
+// same responses). Return the number of PIDs.
+uint8_t get_livePollList(uint8_t poll_list[]){
+
+    uint32_t mask = 0;
+    uint8_t numPIDs = 0;
+
+    if (live_chart_view){
+
+        if (chart_row < live_numRows){
+
+            mask |= (1UL << live_rows[chart_row]);
+        }
+    }else {
+
+        for (uint8_t row = live_first_row; (row < live_numRows) && (row < live_first_row+LIVE_DATA_VISIBLE_ROWS); row++){
+
+            mask |= (1UL << live_rows[row]);
+        }
+    }
+    mask &= live_supported_mask;
+
+    for (uint8_t i = 0; i < NUM_LIVE_DATA_PIDS; i++){
+
+        if (mask & (1UL << i)){
+
+            poll_list[numPIDs] = i;
+            numPIDs++;
+        }
+    }
+
+    return numPIDs;
+}
+
+// FIFO of every ID on the objects of the view. The controller is silent (no ACK nor error
+// frames), it only watches the bus of the car.
+static void start_broadcastReception(void){
+
+    tCANMsgObject message;
+    static uint8_t data[8];
+
+    memset(broadcast_values, 0, sizeof(broadcast_values));
+    broadcast_updated = 0;
+    // The reception of the OBD protocol would take the frames of its ID
+    CANMessageClear(CAN0_BASE, RXOBJECT);
+    set_CANsilent(true);
+    broadcast_running = true;
+    for (uint32_t object = BROADCAST_FIRST_OBJECT; object <= BROADCAST_LAST_OBJECT; object++){
+
+        message.ui32MsgID = 0;
+        message.ui32MsgIDMask = 0;
+        message.ui32Flags = MSG_OBJ_USE_ID_FILTER | MSG_OBJ_RX_INT_ENABLE | ((object < BROADCAST_LAST_OBJECT) ? MSG_OBJ_FIFO : 0);
+        message.ui32MsgLen = 8;
+        message.pui8MsgData = data;
+        CANMessageSet(CAN0_BASE, object, &message, MSG_OBJ_TYPE_RX);
+    }
+}
+
+// The interrupts still pending are cleared too, they would go to the gateway
+static void stop_broadcastReception(void){
+
+    for (uint32_t object = BROADCAST_FIRST_OBJECT; object <= BROADCAST_LAST_OBJECT; object++){
+
+        CANMessageClear(CAN0_BASE, object);
+        CANIntClear(CAN0_BASE, object);
+    }
+    taskENTER_CRITICAL();
+    broadcast_running = false;
+    taskEXIT_CRITICAL();
+    set_CANsilent(false);
+}
+
+// Interrupt of the FIFO (CANIntHandler): the frames are read in order and only the signals of
+// their message are decoded. Return the bits of the frames.
+uint32_t broadcast_CANinterrupt(uint32_t object){
+
+    static const uint32_t fifo = (1UL << BROADCAST_LAST_OBJECT) - (1UL << (BROADCAST_FIRST_OBJECT - 1));
+    tCANMsgObject message;
+    uint8_t data[16];                   // CANMessageGet copies up to 15 bytes with a DLC over 8
+    uint32_t pending, bits = 0;
+    uint64_t updated = broadcast_updated;
+
+    (void)object;
+    while ((pending = CANStatusGet(CAN0_BASE, CAN_STS_NEWDAT) & fifo) != 0){
+
+        for (uint32_t i = BROADCAST_FIRST_OBJECT; i <= BROADCAST_LAST_OBJECT; i++){
+
+            if (pending & (1UL << (i - 1))){
+
+                message.pui8MsgData = data;
+                CANMessageGet(CAN0_BASE, i, &message, true);
+                decode_signalFrame(message.ui32MsgID, (message.ui32Flags & MSG_OBJ_EXTENDED_ID) != 0, data,
+                                   (message.ui32MsgLen > 8) ? 8 : message.ui32MsgLen, broadcast_values, &updated);
+                bits += CAN_frameBits(message.ui32MsgLen, (message.ui32Flags & MSG_OBJ_EXTENDED_ID) != 0);
+            }
+        }
+    }
+    broadcast_updated = updated;
+
+    return bits;
+}
+
+// View of the broadcast signals with the rows of the live data view (the buttons scroll it the
+// same way, there is no strip chart). The bus is taken until the exit, no request can be sent.
+void show_broadcastSignals(void){
+
+    uint64_t updated, received = 0;
+    bool redraw;
+    float value;
+
+    left_button_state = false;
+    menu_button_state = false;
+    live_chart_view = false;
+    live_first_row = 0;
+    live_numRows = Signal_database_numSignals;
+    broadcast_mode = true;
+    live_all_data_mode = true;
+
+    take_CANbus(portMAX_DELAY);
+    start_broadcastReception();
+    live_view_changed = true;
+
+    while ((!left_button_state) && (!menu_button_state)){
+
+        taskENTER_CRITICAL();
+        updated = broadcast_updated;
+        broadcast_updated = 0;
+        taskEXIT_CRITICAL();
+        received |= updated;
+        redraw = live_view_changed;
+
+        if (redraw){
+            // The values already received are drawn on the new rows
+            live_view_changed = false;
+            live_chart_view = false;
+            show_liveDataRows();
+            updated = received;
+        }
+
+        for (uint8_t row = live_first_row; (row < live_numRows) && (row < live_first_row+LIVE_DATA_VISIBLE_ROWS); row++){
+
+            value = broadcast_values[row];
+            if ((updated & (1ULL << row)) && (redraw || (value != broadcast_shown[row]))){
+
+                broadcast_shown[row] = value;
+                cleanData(row-live_first_row);
+                show_liveDataValue(value, row-live_first_row);
+            }
+        }
+        vTaskDelay(BROADCAST_REFRESH_MS/portTICK_PERIOD_MS);
+    }
+
+    // Back to menu
+    stop_broadcastReception();
+    give_CANbus();
+    broadcast_mode = false;
+    live_all_data_mode = false;
+    live_chart_view = false;
+    cleanScreen();
+    OnMenu = true;
+    menu_showed = MENU_MODE;
+    drawMenu();
 }
 
 void config_systemPauseTimer(uint16_t time){
@@ -1430,9 +1568,11 @@ void systemPause_TimerISR(void){
 
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+    trace_isrEnter(TRACE_ISR_PAUSE);
     TimerIntClear(TIMER2_BASE, TIMER_TIMA_TIMEOUT);
     TimerDisable(TIMER2_BASE, TIMER_A);
     time_expired = true;
+    trace_isrExit(TRACE_ISR_PAUSE);
 
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 
@@ -1505,6 +1645,7 @@ int16_t get_numBytes(char *CAN_frame_Hex){
 // Return an only data frame or complete frame with Hex format on CAN_frame variable.
 void get_CANframe(char **CAN_frame, char *cadena, bool only_data, bool ascii){
 
+    uint32_t probe = PROBE_START();
     char cadenaHex[HEX_ARRAY+1];
     uint16_t size;
 
@@ -1601,6 +1742,7 @@ void get_CANframe(char **CAN_frame, char *cadena, bool only_data, bool ascii){
             *(*CAN_frame+size-1) = '\0';
         }
     }
+    probe_end(PROBE_FRAME_DECODE, probe);
 }
 
 bool decode_DTC(char *cadena_DTC_bin, char cadena_DTC_hex[], char DTC_decoded[]){
@@ -1666,13 +1808,9 @@ bool decode_DTC(char *cadena_DTC_bin, char cadena_DTC_hex[], char DTC_decoded[])
 
 bool get_DTC_decoded(char input_buffer_DTC[], char decoded_DTC_buffer[]){
 
-    int size_input_buffer_DTC = sizeOfFrame(input_buffer_DTC);
     bool decoded;
-
-    // Each hex char represent by 4 bits
-    uint16_t num_Bytes_cadenaBin = size_input_buffer_DTC*4;
-
-    char *cadena_bin = (char*)pvPortMalloc(num_Bytes_cadenaBin*sizeof(char));
+    // Each hex char represent by 4 bits (hex2Binary allocates them)
+    char *cadena_bin = NULL;
 
     hex2Binary(input_buffer_DTC, &cadena_bin);
 
@@ -1767,24 +1905,23 @@ void request_PIDs_supportedOnMode02(char **pids_supported){
         *pids_supported = (char*)pvPortMalloc(size*sizeof(char));
         // Substract the PID 02
         memcpy(*pids_supported, cadena_decimal+1, size-1);
-        pids_supported[size-1] = '\0';
+        (*pids_supported)[size-1] = '\0';
 
         vPortFree(CAN_frame_binary);
         CAN_frame_binary = NULL;
+        vPortFree(CAN_frame);
     }
     xEventGroupClearBits(flagEvents, CAN_RX_INTERRUPT);
 }
 
-void request_PIDs_supportedOnMode01(char **pids_supported){
+// Bitmap of the PIDs 01-20 the ECU has (answer of 01 00): bit 7 of the first byte is the PID 01.
+// False if the ECU does not answer.
+bool request_PIDs_supportedOnMode01(uint8_t bitmap[4]){
 
     uint8_t request_data_frame_aux[MAX_BYTES];
     uint8_t response_data_frame_aux[MAX_BYTES];
-    char *CAN_frame = NULL;
-    char *CAN_frame_binary = NULL;
-    char CAN_frame_Hex[9];
-    char cadena_decimal[30];
-
     EventBits_t bitsReaded;
+    bool answered = false;
 
 
     CANRxMessage.ui32MsgID = ECU_ID_Response;
@@ -1809,36 +1946,20 @@ void request_PIDs_supportedOnMode01(char **pids_supported){
 
     CANMessageSet(CAN0_BASE, TXOBJECT, &CANTxMessage, MSG_OBJ_TYPE_TX);
 
-    bitsReaded = xEventGroupWaitBits(flagEvents, CAN_RX_INTERRUPT, pdTRUE, pdFALSE, portMAX_DELAY);
+    bitsReaded = xEventGroupWaitBits(flagEvents, CAN_RX_INTERRUPT, pdTRUE, pdFALSE, MAX_TIME_TO_WAIT_MS);
     if (bitsReaded & CAN_RX_INTERRUPT){
 
         CANMessageGet(CAN0_BASE, RXOBJECT, &CANRxMessage, 0);
-        get_CANframe(&CAN_frame, (char*)response_data_frame_aux, false, false);
-
-        CAN_frame_Hex[0] = CAN_frame[6];
-        CAN_frame_Hex[1] = CAN_frame[7];
-        CAN_frame_Hex[2] = CAN_frame[8];
-        CAN_frame_Hex[3] = CAN_frame[9];
-        CAN_frame_Hex[4] = CAN_frame[10];
-        CAN_frame_Hex[5] = CAN_frame[11];
-        CAN_frame_Hex[6] = CAN_frame[12];
-        CAN_frame_Hex[7] = CAN_frame[13];
-        CAN_frame_Hex[8] = '\0';
-        hex2Binary(CAN_frame_Hex, &CAN_frame_binary);
-
-        find_PIDsupported(CAN_frame_binary, cadena_decimal);
-
-        int size = sizeOfFrame(cadena_decimal);
+        // Single frame: length, 0x41, 0x00 and the 4 bytes of the bitmap
+        if ((response_data_frame_aux[0] >= 6) && (response_data_frame_aux[1] == 0x41) && (response_data_frame_aux[2] == 0x00)){
 
-        *pids_supported = (char*)pvPortMalloc(size*sizeof(char));
-        // Substract the PID 02
-        memcpy(*pids_supported, cadena_decimal+1, size-1);
-        pids_supported[size-1] = '\0';
-
-        vPortFree(CAN_frame_binary);
-        CAN_frame_binary = NULL;
+            memcpy(bitmap, &response_data_frame_aux[3], 4);
+            answered = true;
+        }
     }
     xEventGroupClearBits(flagEvents, CAN_RX_INTERRUPT);
+
+    return answered;
 }
 
 bool valid_DTC(char DTC[]){
@@ -17,36 +17,27 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
-// Defines of the program
-// ECU address
-#define ECM_REQUEST 0x7E0
-#define ECM_RESPONSE 0x7E8
-
-#define TCM_REQUEST 0x7E1
-#define TCM_RESPONSE 0x7E9
-
-#define ABS_REQUEST 0x7E2
-#define ABS_RESPONSE 0x7EA
-
-#define REMOTE_REQUEST_ID 0x7DF
-#define MASK_RESPONSE_ID 0x7FFU
+// Programmer libraries
+#include "OBD_protocol.h"
 
+// Defines of the program
 //#define CAN0RXID ECM // default value
 //#define CAN0TXID REMOTE_REQUEST_ID
 // Message Objects
 #define TXOBJECT 2
 #define RXOBJECT 1
+// FIFO of the broadcast signals view, every ID (the frames are dispatched by Signal_decoder.h)
+#define BROADCAST_FIRST_OBJECT 3
+#define BROADCAST_LAST_OBJECT 18
 
 // CAN configuration
 #define HEX_ARRAY 16
-#define MAX_BYTES 8
-#define NUM_CHAR_DTC 5
 #define BIT_RATE 500000
-#define NUM_LIVE_DATA_PIDS 6
+#define LIVE_DATA_VISIBLE_ROWS 8
+#define DTC_VISIBLE_ROWS 6
+#define DTC_DESCRIPTION_LINE_CHARS 24
 #define FREEZE_SCREEN_TIME 2 // in seconds
-#define MAX_VIN_BYTES 20
-
-#define MAX_TIME_TO_WAIT_MS 200
+#define BROADCAST_REFRESH_MS 100
 
 // Mode defines
 #define SELECT_CAN_COMMAND (1 << 0)
@@ -60,23 +51,21 @@
 #define FREEZE_FRAME (1 << 8)
 #define ERASE_DTC (1 << 9)
 #define SELECT_ECU_ADDRESS (1 << 10)
-
-static uint8_t pids_liveData[] = {0x04, 0x05, 0x06, 0x07, 0x0C, 0x0D};
-static const char *liveData_strings[]= {"Charge motor:",
-                                     "Motor temperature:",
-                                     "S.F.C.(Bank 1):",
-                                     "L.F.C.(Bank 1):",
-                                     "RPM:",
-                                     "Speed:"
-};
-
-static const char *DTC_encoded[] = {"P0107",
-                                    "P0207",
-                                    "P0307",
-                                    "B2245",
-                                    "U1600"
-};
-
+#define DTC_MONITOR_REFRESH (1 << 11)
+#define BROADCAST_SIGNALS (1 << 12)
+
+// Frames of the device since the power up and the error state of the controller (shell)
+typedef struct{
+
+    uint32_t tx_frames;
+    uint32_t rx_frames;
+    uint32_t bits;                  // Of the frames sent and read, without stuff bits
+    uint32_t error_codes;           // Status interrupts with a last error code (stuff, form, ACK...)
+    uint32_t status;                // Last value of the status register (CAN_STATUS_xxx)
+    uint32_t rx_errors;             // Error counters of the controller (REC and TEC)
+    uint32_t tx_errors;
+    bool passive;
+}tCANStats;
 
 // CAN Bus Peripheral Functions
 uint32_t CAN_macro(uint32_t GPIO_peripheral, uint32_t GPIO_pin);
@@ -85,11 +74,17 @@ uint32_t CAN_periph_macro(uint32_t CAN_peripheral);
 void init_CanDevice(uint32_t GPIO_peripheral, uint32_t CAN_peripheral, uint32_t GPIO_pinTX, uint32_t GPIO_pinRX, uint32_t bitRate, bool interruption);
 void CANIntHandler(void);
 void check_CANerrors(void);
+void get_CANstats(tCANStats *stats);
+void set_CANloopback(bool on);
+void set_CANsilent(bool on);
 
 // Tasks Functions
 void init_deviceTasks(void);
 //void init_SSIperiph(void);
 void init_flagEvents(void);
+bool take_CANbus(TickType_t timeout);
+void give_CANbus(void);
+bool request_OBDdata(uint8_t mode, uint8_t PID, uint8_t response_data_frame[], uint32_t *ECU_ID);
 static portTASK_FUNCTION(Read_DTC, pvParameters);
 static portTASK_FUNCTION(Live_all_data, pvParameters);
 static portTASK_FUNCTION(Erase_DTCs, pvParameters);
@@ -101,12 +96,16 @@ void get_CANframe(char **CAN_frame, char *cadena, bool only_data, bool ascii);
 void config_systemPauseTimer(uint16_t time);
 void system_pause(void);
 void show_liveData(double value, uint8_t dataPos);
+void show_liveDataRows(void);
+void get_liveDataRows(void);
+void show_broadcastSignals(void);
+uint32_t broadcast_CANinterrupt(uint32_t object);
+uint8_t get_livePollList(uint8_t poll_list[]);
 void find_PIDsupported(char *CAN_frame_binary, char *decimal);
 void showDTC(char decoded_DTC_buffer[], uint8_t space);
 void request_PIDs_supportedOnMode02(char **pids_supported);
-void request_PIDs_supportedOnMode01(char **pids_supported);
+bool request_PIDs_supportedOnMode01(uint8_t bitmap[4]);
 
-double decode_CANdata(uint8_t posPID, double dataA, double dataB);
 uint16_t sizeOfFrame(const char* frame_Hex);
 int16_t get_posPID(char *CAN_frame);
 int16_t get_consecutiveFrame_SequenceNumber(char *CAN_frame_Hex);
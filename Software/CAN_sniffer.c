@@ -0,0 +1,279 @@
+/*
+ * CAN_sniffer.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// TIVA libraries
+#include "inc/hw_memmap.h"
+#include "driverlib/can.h"
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Programmer libraries
+#include "CAN_device.h"
+#include "CAN_sniffer.h"
+#include "Live_logger.h"
+
+#define OBJECT_BIT(object) (1UL << ((object) - 1))     // Of CAN_STS_NEWDAT
+
+// Global variables
+static tCANCaptureRecord *records = NULL;
+static uint32_t ring_first = 0, ring_count = 0;     // Oldest record and records on the ring
+static tSniffStats sniff_stats;
+static volatile bool running = false;
+static TickType_t start_ticks, end_ticks;
+static bool ended = false;                          // end_ticks is taken
+static bool logging = false;                        // A CAPTnnnn.BIN is open
+// FIFO of every message object and the message objects of every FIFO (CAN_STS_NEWDAT bits)
+static uint8_t object_fifo[SNIFF_OBJECTS];
+static uint32_t fifo_objects[SNIFF_MAX_FILTERS];
+
+
+// Bits of a frame on the bus without the stuff bits, like CAN_frameBits of CAN_device.c
+static uint32_t frame_bits(uint32_t length, bool extended){
+
+    return (extended ? 67 : 47) + 8*length;
+}
+
+// The objects are split among the filters, the first ones take the rest. The last object of
+// every FIFO ends it (no MSG_OBJ_FIFO).
+static void set_objects(const tSniffFilter filters[], uint8_t numFilters){
+
+    tCANMsgObject message;
+    static uint8_t data[8];
+    uint8_t fifos = (numFilters > 0) ? numFilters : 1;
+    uint32_t object = SNIFF_FIRST_OBJECT;
+
+    for (uint8_t fifo = 0; fifo < fifos; fifo++){
+
+        uint32_t size = SNIFF_OBJECTS/fifos + ((fifo < SNIFF_OBJECTS % fifos) ? 1 : 0);
+
+        fifo_objects[fifo] = 0;
+        for (uint32_t i = 0; i < size; i++, object++){
+
+            if (numFilters > 0){
+
+                // The IDE bit is filtered too, so a filter of 11 bits does not take the
+                // 29 bit IDs that end the same way
+                message.ui32MsgID = filters[fifo].ID;
+                message.ui32MsgIDMask = filters[fifo].mask;
+                message.ui32Flags = MSG_OBJ_USE_EXT_FILTER | (filters[fifo].extended ? MSG_OBJ_EXTENDED_ID : 0);
+            }else {
+
+                // Every ID of 11 and 29 bits
+                message.ui32MsgID = 0;
+                message.ui32MsgIDMask = 0;
+                message.ui32Flags = MSG_OBJ_USE_ID_FILTER;
+            }
+            message.ui32Flags |= MSG_OBJ_RX_INT_ENABLE | ((i < size - 1) ? MSG_OBJ_FIFO : 0);
+            message.ui32MsgLen = 8;
+            message.pui8MsgData = data;
+            object_fifo[object - SNIFF_FIRST_OBJECT] = fifo;
+            fifo_objects[fifo] |= OBJECT_BIT(object);
+            CANMessageSet(CAN0_BASE, object, &message, MSG_OBJ_TYPE_RX);
+        }
+    }
+}
+
+// The interrupts still pending are cleared too, the objects over SLCAN_LAST_OBJECT would go to
+// the tests of RXOBJECT and TXOBJECT of CANIntHandler
+static void clear_objects(void){
+
+    for (uint32_t object = SNIFF_FIRST_OBJECT; object <= SNIFF_LAST_OBJECT; object++){
+
+        CANMessageClear(CAN0_BASE, object);
+        CANIntClear(CAN0_BASE, object);
+    }
+}
+
+// A frame of a message object to the next record of the ring, over the oldest one when it is
+// full (called from the interrupt). The data go through a buffer: with a DLC over 8
+// CANMessageGet copies up to 15 bytes.
+static uint32_t read_object(uint32_t object){
+
+    tCANMsgObject message;
+    tCANCaptureRecord *record;
+    uint8_t data[16];
+    bool extended;
+
+    message.pui8MsgData = data;
+    CANMessageGet(CAN0_BASE, object, &message, true);
+    if (message.ui32Flags & MSG_OBJ_DATA_LOST){
+
+        sniff_stats.overruns++;
+    }
+    extended = (message.ui32Flags & MSG_OBJ_EXTENDED_ID) != 0;
+
+    if ((running) && (records != NULL)){
+
+        record = &records[(ring_first + ring_count) % SNIFF_RING_RECORDS];
+        if (ring_count == SNIFF_RING_RECORDS){
+
+            ring_first = (ring_first + 1) % SNIFF_RING_RECORDS;
+            sniff_stats.overwritten++;
+        }else {
+
+            ring_count++;
+        }
+        get_captureTime(&record->time_ms, &record->time_us);
+        record->flags = extended ? CAN_CAPTURE_EXTENDED : 0;
+        record->length = (message.ui32MsgLen > 8) ? 8 : message.ui32MsgLen;
+        record->ID = message.ui32MsgID;
+        memset(record->data, 0, sizeof(record->data));
+        memcpy(record->data, data, record->length);
+        sniff_stats.frames++;
+    }
+
+    return frame_bits(message.ui32MsgLen, extended);
+}
+
+bool start_sniffer(const tSniffFilter filters[], uint8_t numFilters){
+
+    if ((records != NULL) || (numFilters > SNIFF_MAX_FILTERS)){
+
+        return false;
+    }
+    records = (tCANCaptureRecord *)pvPortMalloc(SNIFF_RING_RECORDS*sizeof(tCANCaptureRecord));
+    if (records == NULL){
+
+        return false;
+    }
+    memset(&sniff_stats, 0, sizeof(sniff_stats));
+    sniff_stats.capacity = SNIFF_RING_RECORDS;
+    ring_first = 0;
+    ring_count = 0;
+    ended = false;
+
+    // The reception of the OBD protocol would take the frames of its ID
+    CANMessageClear(CAN0_BASE, RXOBJECT);
+    set_CANsilent(true);
+    start_ticks = xTaskGetTickCount();
+    running = true;
+    set_objects(filters, numFilters);
+
+    return true;
+}
+
+void stop_sniffer(void){
+
+    if (!running){
+
+        return;
+    }
+    clear_objects();
+    taskENTER_CRITICAL();
+    running = false;
+    end_ticks = xTaskGetTickCount();
+    ended = true;
+    taskEXIT_CRITICAL();
+    set_CANsilent(false);
+}
+
+void end_sniffer(void){
+
+    tCANCaptureRecord *buffer = records;
+
+    stop_sniffer();
+    if (logging){
+
+        stop_liveLogger();
+        logging = false;
+    }
+    taskENTER_CRITICAL();
+    records = NULL;
+    taskEXIT_CRITICAL();
+    vPortFree(buffer);
+}
+
+bool is_snifferRunning(void){
+
+    return running;
+}
+
+bool take_snifferRecord(tCANCaptureRecord *record){
+
+    bool taken = false;
+
+    taskENTER_CRITICAL();
+    if ((records != NULL) && (ring_count > 0)){
+
+        *record = records[ring_first];
+        ring_first = (ring_first + 1) % SNIFF_RING_RECORDS;
+        ring_count--;
+        taken = true;
+    }
+    taskEXIT_CRITICAL();
+
+    return taken;
+}
+
+uint32_t save_snifferRecords(void){
+
+    tCANCaptureRecord record;
+    bool capture;
+    uint32_t written = 0;
+
+    if (!logging){
+
+        // The live data view has its own recording
+        if ((records == NULL) || is_liveLoggerRecording()){
+
+            return 0;
+        }
+        capture = is_liveLoggerCapture();
+        set_liveLoggerCapture(true);
+        start_liveLogger();
+        set_liveLoggerCapture(capture);
+        logging = true;
+    }
+    // At full load the ring is filled again while the records are written
+    while ((written < SNIFF_RING_RECORDS) && take_snifferRecord(&record) && log_CANrecord(&record, SNIFF_SD_TIMEOUT_MS)){
+
+        written++;
+    }
+
+    return written;
+}
+
+// The FIFO of the object is emptied from its lowest object up, the order in which the controller
+// fills it. The objects filled meanwhile are read on the next turn, after the ones already taken.
+uint32_t sniffer_CANinterrupt(uint32_t object){
+
+    uint32_t fifo = fifo_objects[object_fifo[object - SNIFF_FIRST_OBJECT]];
+    uint32_t pending, bits = 0;
+
+    while ((pending = CANStatusGet(CAN0_BASE, CAN_STS_NEWDAT) & fifo) != 0){
+
+        for (uint32_t i = SNIFF_FIRST_OBJECT; i <= SNIFF_LAST_OBJECT; i++){
+
+            if (pending & OBJECT_BIT(i)){
+
+                bits += read_object(i);
+            }
+        }
+    }
+
+    return bits;
+}
+
+void get_snifferStats(tSniffStats *stats){
+
+    taskENTER_CRITICAL();
+    *stats = sniff_stats;
+    stats->time_ms = ((ended ? end_ticks : xTaskGetTickCount()) - start_ticks)*portTICK_PERIOD_MS;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,80 @@
+/*
+ * CAN_sniffer.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Passive capture of the bus ('sniff' on the shell, Diag_shell.h). The controller is silent
+ *      (set_CANsilent): it receives every frame but sends nothing, not even the ACK or an error
+ *      frame, so the device can watch the traffic of a car without being a node of it.
+ *      The filters (ID and mask) go to the acceptance masks of the message objects, so the frames
+ *      of the other IDs never reach the CPU. Every filter has a FIFO of message objects (the
+ *      SNIFF_OBJECTS objects are shared among the filters, so one filter has the deepest FIFO).
+ *      CANIntHandler empties the FIFO in order and only copies the frames with their time on a
+ *      ring of SNIFF_RING_RECORDS records of the heap (a fixed size, reserved in the heap budget
+ *      of FreeRTOSConfig.h). The shell takes them while the capture goes on and writes them on
+ *      the SD card (a CAPTnnnn.BIN of Live_logger.h) or on the console (candump -l lines), both
+ *      read by Host/CAN_trace. When the output is slower than the bus (the console at full load)
+ *      the ring keeps the newest frames and the oldest ones are overwritten, and counted.
+ */
+
+#ifndef CAN_SNIFFER_H_
+#define CAN_SNIFFER_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "Live_logger.h"
+
+// Message objects of the sniffer (all but RXOBJECT and TXOBJECT, unused while it has the bus)
+#define SNIFF_FIRST_OBJECT 3
+#define SNIFF_LAST_OBJECT 32
+#define SNIFF_OBJECTS (SNIFF_LAST_OBJECT - SNIFF_FIRST_OBJECT + 1)
+
+#define SNIFF_MAX_FILTERS 6                 // 5 message objects each
+#define SNIFF_RING_RECORDS 50               // 1000 bytes of the heap
+#define SNIFF_SD_TIMEOUT_MS 2000            // Wait for a free block of the logger
+#define SNIFF_STANDARD_MASK 0x7FF
+#define SNIFF_EXTENDED_MASK 0x1FFFFFFF
+
+// Frames of ID & mask == filter ID & mask, with the same kind of ID (11 or 29 bits)
+typedef struct{
+
+    uint32_t ID;
+    uint32_t mask;
+    bool extended;
+}tSniffFilter;
+
+// Since start_sniffer
+typedef struct{
+
+    uint32_t frames;                        // Received on the ring
+    uint32_t overruns;                      // Lost by the FIFOs of the message objects
+    uint32_t overwritten;                   // Oldest ones, with the ring full before they were taken
+    uint32_t capacity;                      // Records of the ring
+    uint32_t time_ms;                       // From the start to the stop
+}tSniffStats;
+
+// Allocates the ring and starts the capture (no filters: every frame). The CAN bus has to be
+// taken by the caller. False if there is no memory for the ring.
+bool start_sniffer(const tSniffFilter filters[], uint8_t numFilters);
+// Ends the capture: the message objects are cleared and the controller is a node again.
+// The records not taken stay until end_sniffer, that closes the CAPTnnnn.BIN too.
+void stop_sniffer(void);
+void end_sniffer(void);
+bool is_snifferRunning(void);
+// Copies the oldest record and takes it off the ring. False if the ring is empty.
+bool take_snifferRecord(tCANCaptureRecord *record);
+// Takes up to SNIFF_RING_RECORDS records to a CAPTnnnn.BIN, opened on the first call. Return
+// the records written.
+uint32_t save_snifferRecords(void);
+// Interrupt of a message object of the sniffer (CANIntHandler). Return the bits of the frames.
+uint32_t sniffer_CANinterrupt(uint32_t object);
+void get_snifferStats(tSniffStats *stats);
+
+#endif /* CAN_SNIFFER_H_ */
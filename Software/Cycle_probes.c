@@ -0,0 +1,182 @@
+/*
+ * Cycle_probes.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PROBES_HOST
+#include <stdio.h>
+#include <time.h>
+#define PROBES_PRINTF printf
+#else
+// TIVA libraries
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "utils/uartstdio.h"
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+#define PROBES_PRINTF UARTprintf
+
+// DWT and the debug registers (the cycle counter needs the trace enabled)
+#define DEMCR 0xE000EDFC
+#define DEMCR_TRCENA 0x01000000
+#define DWT_CTRL 0xE0001000
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#endif
+
+// Programmer libraries
+#include "Cycle_probes.h"
+#ifndef PROBES_HOST
+#include "Trace_recorder.h"
+#endif
+
+// Global variables
+static tProbeStats probes[NUM_PROBES];
+static const char * const probe_names[NUM_PROBES] = {"CAN ISR", "Frame decode", "ISO-TP frame", "LCD text", "LCD fill",
+                                                     "SD write"};
+#ifndef PROBES_HOST
+extern uint32_t g_ulSystemClock;
+#endif
+
+
+#ifdef PROBES_HOST
+uint32_t host_probeCounter(void){
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)((uint64_t)now.tv_sec*1000000000ULL + now.tv_nsec);
+}
+#endif
+
+void init_probes(void){
+
+    reset_probes();
+#ifndef PROBES_HOST
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+#endif
+}
+
+void probe_end(tProbe probe, uint32_t start){
+
+    // The counter wraps around (86 s at 50 MHz, 4 s in ns)
+    uint32_t elapsed = PROBE_START() - start;
+    tProbeStats *stats = &probes[probe];
+#ifndef PROBES_HOST
+    // The probe is also a slice of the trace
+    if (trace_streaming()){
+
+        trace_eventAt(start, TRACE_PROBE_BEGIN, probe, 0);
+        trace_eventAt(start + elapsed, TRACE_PROBE_END, probe, 0);
+    }
+
+    // The same probe can be on a task and on an interrupt
+    bool masked = IntMasterDisable();
+#endif
+
+    stats->count++;
+    stats->total += elapsed;
+    if (elapsed < stats->min){
+
+        stats->min = elapsed;
+    }
+    if (elapsed > stats->max){
+
+        stats->max = elapsed;
+    }
+#ifndef PROBES_HOST
+    if (!masked){
+
+        IntMasterEnable();
+    }
+#endif
+}
+
+void get_probeStats(tProbe probe, tProbeStats *stats){
+
+#ifndef PROBES_HOST
+    bool masked = IntMasterDisable();
+#endif
+
+    *stats = probes[probe];
+#ifndef PROBES_HOST
+    if (!masked){
+
+        IntMasterEnable();
+    }
+#endif
+}
+
+const char *get_probeName(tProbe probe){
+
+    return probe_names[probe];
+}
+
+uint32_t get_probeCounterHz(void){
+
+#ifdef PROBES_HOST
+    return 1000000000UL;
+#else
+    return g_ulSystemClock;
+#endif
+}
+
+void reset_probes(void){
+
+#ifndef PROBES_HOST
+    bool masked = IntMasterDisable();
+#endif
+
+    memset(probes, 0, sizeof(probes));
+    for (int i = 0; i < NUM_PROBES; i++){
+
+        probes[i].min = UINT32_MAX;
+    }
+#ifndef PROBES_HOST
+    if (!masked){
+
+        IntMasterEnable();
+    }
+#endif
+}
+
+// Counts of the counter and the mean in ns. The name goes last: uartstdio only pads the numbers
+// the way printf does, and only prints 32 bit integers.
+void dump_probes(void){
+
+    uint32_t Hz = get_probeCounterHz();
+
+    PROBES_PRINTF("Probes (counter of %u Hz)\n", Hz);
+    PROBES_PRINTF("     Count        Min       Mean        Max    Mean ns  Probe\n");
+    for (int i = 0; i < NUM_PROBES; i++){
+
+        tProbeStats stats;
+        uint32_t mean;
+
+        get_probeStats((tProbe)i, &stats);
+        if (stats.count == 0){
+
+            PROBES_PRINTF("         0          -          -          -          -  %s\n", probe_names[i]);
+            continue;
+        }
+        mean = (uint32_t)(stats.total/stats.count);
+        PROBES_PRINTF("%10u %10u %10u %10u %10u  %s\n", stats.count, stats.min, mean, stats.max,
+                      (uint32_t)((uint64_t)mean*1000000000ULL/Hz), probe_names[i]);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Cycle_probes.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Named probes of the execution time of the code. PROBE_START() takes the counter and
+ *      probe_end() adds the time since then to the table of the probe: count, minimum, maximum
+ *      and total (for the mean). On the Tiva the counter is the cycle counter of the DWT (CYCCNT,
+ *      CPU clock), so a probe costs a few cycles. The interrupts and the tasks that preempt the
+ *      code between the start and the end are counted too.
+ *      The table is printed on the console of UART0 with the probes command of the shell
+ *      (Diag_shell.h), 'probes reset' resets it. On the stream of the trace (Trace_recorder.h)
+ *      every probe is a slice.
+ */
+
+#ifndef CYCLE_PROBES_H_
+#define CYCLE_PROBES_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+typedef enum{
+
+    PROBE_CAN_ISR = 0,              // CANIntHandler
+    PROBE_FRAME_DECODE,             // get_CANframe and the value of read_PIDvalue
+    PROBE_ISOTP_FRAME,              // Every frame of an ISO-TP response (request_ISOTPmessage)
+    PROBE_LCD_TEXT,                 // drawString
+    PROBE_LCD_FILL,                 // fillRect (also inside the texts of size 2)
+    PROBE_SD_WRITE,                 // Blocks sent to the card (SD_device.c)
+    NUM_PROBES
+}tProbe;
+
+typedef struct{
+
+    uint32_t count;
+    uint32_t min;                   // Counts of the counter
+    uint32_t max;
+    uint64_t total;
+}tProbeStats;
+
+// The host builds (Host/) use PROBES_HOST: the counter is the monotonic clock in ns and the
+// table is printed on stdout
+#ifdef PROBES_HOST
+uint32_t host_probeCounter(void);
+#define PROBE_START() host_probeCounter()
+#else
+#include "inc/hw_types.h"
+#define DWT_CYCCNT 0xE0001004
+#define PROBE_START() HWREG(DWT_CYCCNT)
+#endif
+
+void init_probes(void);
+void probe_end(tProbe probe, uint32_t start);
+void get_probeStats(tProbe probe, tProbeStats *stats);
+const char *get_probeName(tProbe probe);
+uint32_t get_probeCounterHz(void);
+void reset_probes(void);
+void dump_probes(void);
+
+#endif /* CYCLE_PROBES_H_ */
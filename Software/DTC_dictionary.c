@@ -0,0 +1,131 @@
+/*
+ * DTC_dictionary.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Programmer libraries
+#include "DTC_dictionary.h"
+
+
+// Convert a decoded DTC ("P0107") on the 2 bytes sent by the ECU
+bool DTC_code2key(const char DTC[], uint16_t *key){
+
+    static const char DTC_system[] = {'P', 'C', 'B', 'U'};
+    uint16_t value = 0xFFFF;
+    uint8_t digit;
+
+    for (uint8_t i = 0; i < 4; i++){
+
+        if (DTC[0] == DTC_system[i]){
+
+            value = (uint16_t)i << 14;
+        }
+    }
+    if ((value == 0xFFFF) || (DTC[1] < '0') || (DTC[1] > '3')){
+
+        return false;
+    }
+    value |= (uint16_t)(DTC[1] - '0') << 12;
+
+    for (uint8_t i = 2; i < 5; i++){
+
+        if ((DTC[i] >= '0') && (DTC[i] <= '9')){
+            digit = DTC[i] - '0';
+        }else if ((DTC[i] >= 'A') && (DTC[i] <= 'F')){
+            digit = DTC[i] - 'A' + 10;
+        }else {
+            return false;
+        }
+        value |= (uint16_t)digit << (4*(4-i));
+    }
+
+    *key = value;
+
+    return true;
+}
+
+// Return the position of the key on the dictionary or -1 if it is not there
+int16_t find_DTCkey(uint16_t key){
+
+    int16_t first = 0;
+    int16_t last = DTC_dictionary_numDTCs - 1;
+    int16_t middle;
+
+    while (first <= last){
+
+        middle = (first + last) / 2;
+        if (DTC_dictionary_keys[middle] == key){
+
+            return middle;
+        }else if (DTC_dictionary_keys[middle] < key){
+
+            first = middle + 1;
+        }else {
+
+            last = middle - 1;
+        }
+    }
+
+    return -1;
+}
+
+// Decompress the description of the DTC on description (size bytes with the '\0').
+// Longer descriptions are cut. Return false if the DTC is not on the dictionary.
+bool get_DTCdescription(uint16_t key, char description[], uint16_t size){
+
+    int16_t pos = find_DTCkey(key);
+    uint16_t out = 0;
+    uint16_t word, length;
+    uint32_t first, last;
+    uint8_t code;
+
+    if ((pos < 0) || (size == 0)){
+
+        return false;
+    }
+    // The next DTC can be on the next block
+    first = DTC_dictionary_blockOffsets[pos >> DTC_DICTIONARY_BLOCK_BITS] + DTC_dictionary_offsets[pos];
+    last = DTC_dictionary_blockOffsets[(pos+1) >> DTC_DICTIONARY_BLOCK_BITS] + DTC_dictionary_offsets[pos+1];
+
+    for (uint32_t i = first; (i < last) && (out < size-1); i++){
+
+        code = DTC_dictionary_text[i];
+        if (code < DTC_DICTIONARY_WORD_CODE){
+
+            description[out++] = (char)code;
+            continue;
+        }
+
+        if (code == DTC_DICTIONARY_WORD_ESCAPE){
+
+            i++;
+            word = (DTC_DICTIONARY_WORD_ESCAPE - DTC_DICTIONARY_WORD_CODE) + DTC_dictionary_text[i];
+        }else {
+
+            word = code - DTC_DICTIONARY_WORD_CODE;
+        }
+
+        length = DTC_dictionary_wordOffsets[word+1] - DTC_dictionary_wordOffsets[word];
+        if (length > (size-1-out)){
+
+            length = size-1-out;
+        }
+        memcpy(description+out, DTC_dictionary_words+DTC_dictionary_wordOffsets[word], length);
+        out += length;
+    }
+    description[out] = '\0';
+
+    return true;
+}
@@ -0,0 +1,47 @@
+/*
+ * DTC_dictionary.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef DTC_DICTIONARY_H_
+#define DTC_DICTIONARY_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Dictionary format
+// The tables are generated by Host/DTC_dictionary/dtc_gen.c on DTC_dictionary_data.c (flash).
+// Keys are the 2 bytes of the DTC as they are sent by the ECU (P0107 = 0x0107, U0100 = 0xC100),
+// sorted to search them by bisection. Every description is a sequence of bytes where
+// 0x01-0x7F are characters, 0x80-0xFE the word (code - 0x80) of the shared dictionary
+// and 0xFF followed by a byte n the word (0x7F + n).
+// The text of the DTC n starts on DTC_dictionary_blockOffsets[n >> DTC_DICTIONARY_BLOCK_BITS]
+// + DTC_dictionary_offsets[n]: the offsets are counted from the start of the block of 64 DTCs,
+// so they fit on 16 bits while the whole text can be bigger than 64 KB.
+#define DTC_DICTIONARY_WORD_CODE 0x80
+#define DTC_DICTIONARY_WORD_ESCAPE 0xFF
+#define DTC_DESCRIPTION_MAX_CHARS 96
+#define DTC_DICTIONARY_BLOCK_BITS 6
+
+extern const uint16_t DTC_dictionary_numDTCs;
+extern const uint16_t DTC_dictionary_keys[];
+extern const uint32_t DTC_dictionary_blockOffsets[];
+extern const uint16_t DTC_dictionary_offsets[];
+extern const uint8_t DTC_dictionary_text[];
+extern const uint16_t DTC_dictionary_numWords;
+extern const uint16_t DTC_dictionary_wordOffsets[];
+extern const char DTC_dictionary_words[];
+
+bool DTC_code2key(const char DTC[], uint16_t *key);
+int16_t find_DTCkey(uint16_t key);
+bool get_DTCdescription(uint16_t key, char description[], uint16_t size);
+
+#endif /* DTC_DICTIONARY_H_ */
@@ -0,0 +1,187 @@
+/*
+ * DTC_dictionary_data.c
+ *
+ *      Generated by Host/DTC_dictionary/dtc_gen.c from dtc_descriptions.tsv, do not edit it.
+ *      122 DTCs, 79 words on the dictionary.
+ *      Flash image: 2530 bytes (plain strings with pointers: 6323 bytes).
+ *      Lookup: 7 comparisons at most.
+ */
+
+#include <stdint.h>
+
+#include "DTC_dictionary.h"
+
+const uint16_t DTC_dictionary_numDTCs = 122;
+
+const uint32_t DTC_dictionary_blockOffsets[2] = {
+    0x00, 0x240
+};
+
+const uint16_t DTC_dictionary_offsets[123] = {
+    0x00, 0x07, 0x0F, 0x17, 0x1F, 0x26, 0x2C, 0x33, 0x3A, 0x41, 0x47, 0x4C,
+    0x52, 0x58, 0x5E, 0x63, 0x68, 0x6E, 0x74, 0x7A, 0x7F, 0x86, 0x8E, 0x96,
+    0x9E, 0xA5, 0xC0, 0xE5, 0xEF, 0xFA, 0x105, 0x110, 0x11C, 0x127, 0x131, 0x13C,
+    0x147, 0x152, 0x15E, 0x169, 0x173, 0x17E, 0x189, 0x194, 0x1A0, 0x1AB, 0x1B5, 0x1C0,
+    0x1CB, 0x1D6, 0x1E2, 0x1ED, 0x1F3, 0x1F9, 0x1FF, 0x205, 0x208, 0x20F, 0x216, 0x21D,
+    0x224, 0x22B, 0x232, 0x239, 0x00, 0x12, 0x1E, 0x2E, 0x41, 0x46, 0x4B, 0x50,
+    0x55, 0x5A, 0x5F, 0x64, 0x69, 0x86, 0x8D, 0xA4, 0xB1, 0xB6, 0xBC, 0xCB,
+    0xD3, 0xDB, 0xE0, 0xEA, 0xF8, 0x106, 0x112, 0x120, 0x133, 0x13E, 0x142, 0x151,
+    0x161, 0x164, 0x169, 0x16F, 0x17D, 0x18C, 0x1A2, 0x1B7, 0x1BB, 0x1D2, 0x1E4, 0x1EF,
+    0x1F2, 0x1F7, 0x1FC, 0x201, 0x206, 0x220, 0x225, 0x22A, 0x22F, 0x239, 0x247, 0x24D,
+    0x269, 0x273, 0x297
+};
+
+const uint16_t DTC_dictionary_keys[122] = {
+    0x100, 0x101, 0x102, 0x103, 0x104, 0x105, 0x106, 0x107, 0x108, 0x109, 0x110, 0x111,
+    0x112, 0x113, 0x114, 0x115, 0x116, 0x117, 0x118, 0x119, 0x120, 0x121, 0x122, 0x123,
+    0x124, 0x125, 0x128, 0x130, 0x131, 0x132, 0x133, 0x134, 0x135, 0x136, 0x137, 0x138,
+    0x139, 0x13A, 0x13B, 0x150, 0x151, 0x152, 0x153, 0x154, 0x155, 0x156, 0x157, 0x158,
+    0x159, 0x15A, 0x15B, 0x171, 0x172, 0x174, 0x175, 0x200, 0x201, 0x202, 0x203, 0x204,
+    0x205, 0x206, 0x207, 0x208, 0x217, 0x219, 0x230, 0x300, 0x301, 0x302, 0x303, 0x304,
+    0x305, 0x306, 0x307, 0x308, 0x325, 0x335, 0x336, 0x340, 0x400, 0x401, 0x402, 0x420,
+    0x430, 0x440, 0x441, 0x442, 0x443, 0x446, 0x455, 0x456, 0x500, 0x505, 0x506, 0x507,
+    0x560, 0x562, 0x563, 0x600, 0x601, 0x603, 0x605, 0x700, 0x705, 0x715, 0x720, 0x730,
+    0x731, 0x732, 0x733, 0x734, 0x740, 0x750, 0x755, 0x760, 0xC001, 0xC100, 0xC101, 0xC121,
+    0xC140, 0xC155
+};
+
+const uint8_t DTC_dictionary_text[1239] = {
+    0xAD, 0xBE, 0xA8, 0xA1, 0xA0, 0x80, 0x82, 0xAD, 0xBE, 0xA8, 0xA1, 0xA0,
+    0x80, 0x8D, 0xA6, 0xAD, 0xBE, 0xA8, 0xA1, 0xA0, 0x80, 0xA5, 0x9C, 0xAD,
+    0xBE, 0xA8, 0xA1, 0xA0, 0x80, 0x9B, 0x9C, 0xAD, 0xBE, 0xA8, 0xA1, 0xA0,
+    0x80, 0x98, 0x9E, 0x9D, 0x8A, 0x9F, 0x80, 0x82, 0x9E, 0x9D, 0x8A, 0x9F,
+    0x80, 0x8D, 0xA6, 0x9E, 0x9D, 0x8A, 0x9F, 0x80, 0xA5, 0x9C, 0x9E, 0x9D,
+    0x8A, 0x9F, 0x80, 0x9B, 0x9C, 0x9E, 0x9D, 0x8A, 0x9F, 0x80, 0x98, 0xA4,
+    0xA1, 0x87, 0x80, 0x82, 0xA4, 0xA1, 0x87, 0x80, 0x8D, 0xA6, 0xA4, 0xA1,
+    0x87, 0x80, 0xA5, 0x9C, 0xA4, 0xA1, 0x87, 0x80, 0x9B, 0x9C, 0xA4, 0xA1,
+    0x87, 0x80, 0x98, 0x9A, 0x99, 0x87, 0x80, 0x82, 0x9A, 0x99, 0x87, 0x80,
+    0x8D, 0xA6, 0x9A, 0x99, 0x87, 0x80, 0xA5, 0x9C, 0x9A, 0x99, 0x87, 0x80,
+    0x9B, 0x9C, 0x9A, 0x99, 0x87, 0x80, 0x98, 0x92, 0x91, 0x93, 0x41, 0x20,
+    0x80, 0x82, 0x92, 0x91, 0x93, 0x41, 0x20, 0x80, 0x8D, 0xA6, 0x92, 0x91,
+    0x93, 0x41, 0x20, 0x80, 0xA5, 0x9C, 0x92, 0x91, 0x93, 0x41, 0x20, 0x80,
+    0x9B, 0x9C, 0x92, 0x91, 0x93, 0x41, 0x20, 0x80, 0x98, 0xB3, 0x99, 0x87,
+    0x66, 0x6F, 0x72, 0x20, 0x43, 0x6C, 0x6F, 0x73, 0x65, 0x64, 0x20, 0x4C,
+    0x6F, 0x6F, 0x70, 0x20, 0xCB, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C,
+    0x99, 0xBD, 0x28, 0x43, 0x6F, 0x6F, 0x6C, 0x61, 0x6E, 0x74, 0x20, 0x87,
+    0xB8, 0xBD, 0x52, 0x65, 0x67, 0x75, 0x6C, 0x61, 0x74, 0x69, 0x6E, 0x67,
+    0x20, 0x54, 0x65, 0x6D, 0x70, 0x65, 0x72, 0x61, 0x74, 0x75, 0x72, 0x65,
+    0x29, 0x96, 0x81, 0x80, 0x83, 0x84, 0x31, 0x20, 0x81, 0x31, 0x29, 0x96,
+    0x81, 0x80, 0xA5, 0x8C, 0x84, 0x31, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81,
+    0x80, 0x9B, 0x8C, 0x84, 0x31, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81, 0x80,
+    0xB6, 0xA7, 0x84, 0x31, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81, 0x80, 0xC9,
+    0xA3, 0x94, 0x84, 0x31, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81, 0xA9, 0x80,
+    0x83, 0x84, 0x31, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81, 0x80, 0x83, 0x84,
+    0x31, 0x20, 0x81, 0x32, 0x29, 0x96, 0x81, 0x80, 0xA5, 0x8C, 0x84, 0x31,
+    0x20, 0x81, 0x32, 0x29, 0x96, 0x81, 0x80, 0x9B, 0x8C, 0x84, 0x31, 0x20,
+    0x81, 0x32, 0x29, 0x96, 0x81, 0x80, 0xB6, 0xA7, 0x84, 0x31, 0x20, 0x81,
+    0x32, 0x29, 0x96, 0x81, 0x80, 0xC9, 0xA3, 0x94, 0x84, 0x31, 0x20, 0x81,
+    0x32, 0x29, 0x96, 0x81, 0xA9, 0x80, 0x83, 0x84, 0x31, 0x20, 0x81, 0x32,
+    0x29, 0x96, 0x81, 0x80, 0x83, 0x84, 0x32, 0x20, 0x81, 0x31, 0x29, 0x96,
+    0x81, 0x80, 0xA5, 0x8C, 0x84, 0x32, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81,
+    0x80, 0x9B, 0x8C, 0x84, 0x32, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81, 0x80,
+    0xB6, 0xA7, 0x84, 0x32, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81, 0x80, 0xC9,
+    0xA3, 0x94, 0x84, 0x32, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81, 0xA9, 0x80,
+    0x83, 0x84, 0x32, 0x20, 0x81, 0x31, 0x29, 0x96, 0x81, 0x80, 0x83, 0x84,
+    0x32, 0x20, 0x81, 0x32, 0x29, 0x96, 0x81, 0x80, 0xA5, 0x8C, 0x84, 0x32,
+    0x20, 0x81, 0x32, 0x29, 0x96, 0x81, 0x80, 0x9B, 0x8C, 0x84, 0x32, 0x20,
+    0x81, 0x32, 0x29, 0x96, 0x81, 0x80, 0xB6, 0xA7, 0x84, 0x32, 0x20, 0x81,
+    0x32, 0x29, 0x96, 0x81, 0x80, 0xC9, 0xA3, 0x94, 0x84, 0x32, 0x20, 0x81,
+    0x32, 0x29, 0x96, 0x81, 0xA9, 0x80, 0x83, 0x84, 0x32, 0x20, 0x81, 0x32,
+    0x29, 0x88, 0xC0, 0xCC, 0x84, 0x31, 0x29, 0x88, 0xC0, 0xCD, 0x84, 0x31,
+    0x29, 0x88, 0xC0, 0xCC, 0x84, 0x32, 0x29, 0x88, 0xC0, 0xCD, 0x84, 0x32,
+    0x29, 0x8F, 0x80, 0x82, 0x8F, 0x80, 0x83, 0x2D, 0x20, 0x85, 0x31, 0x8F,
+    0x80, 0x83, 0x2D, 0x20, 0x85, 0x32, 0x8F, 0x80, 0x83, 0x2D, 0x20, 0x85,
+    0x33, 0x8F, 0x80, 0x83, 0x2D, 0x20, 0x85, 0x34, 0x8F, 0x80, 0x83, 0x2D,
+    0x20, 0x85, 0x35, 0x8F, 0x80, 0x83, 0x2D, 0x20, 0x85, 0x36, 0x8F, 0x80,
+    0x83, 0x2D, 0x20, 0x85, 0x37, 0x8F, 0x80, 0x83, 0x2D, 0x20, 0x85, 0x38,
+    0x9A, 0x4F, 0x76, 0x65, 0x72, 0x74, 0x65, 0x6D, 0x70, 0x65, 0x72, 0x61,
+    0x74, 0x75, 0x72, 0x65, 0x20, 0xC2, 0x9A, 0x4F, 0x76, 0x65, 0x72, 0x73,
+    0x70, 0x65, 0x65, 0x64, 0x20, 0xC2, 0xCB, 0x50, 0x75, 0x6D, 0x70, 0x20,
+    0x50, 0x72, 0x69, 0x6D, 0x61, 0x72, 0x79, 0x20, 0x80, 0x82, 0x52, 0x61,
+    0x6E, 0x64, 0x6F, 0x6D, 0x2F, 0x4D, 0x75, 0x6C, 0x74, 0x69, 0x70, 0x6C,
+    0x65, 0x20, 0x85, 0x90, 0x8B, 0x85, 0x31, 0x20, 0x90, 0x8B, 0x85, 0x32,
+    0x20, 0x90, 0x8B, 0x85, 0x33, 0x20, 0x90, 0x8B, 0x85, 0x34, 0x20, 0x90,
+    0x8B, 0x85, 0x35, 0x20, 0x90, 0x8B, 0x85, 0x36, 0x20, 0x90, 0x8B, 0x85,
+    0x37, 0x20, 0x90, 0x8B, 0x85, 0x38, 0x20, 0x90, 0x8B, 0x4B, 0x6E, 0x6F,
+    0x63, 0x6B, 0x20, 0x81, 0x31, 0x20, 0x80, 0x83, 0x84, 0x31, 0x20, 0xBE,
+    0x53, 0x69, 0x6E, 0x67, 0x6C, 0x65, 0x20, 0x53, 0x65, 0x6E, 0x73, 0x6F,
+    0x72, 0x29, 0xB9, 0x91, 0x81, 0x41, 0x20, 0x80, 0x82, 0xB9, 0x91, 0x81,
+    0x41, 0x20, 0x80, 0x52, 0x61, 0x6E, 0x67, 0x65, 0x2F, 0x50, 0x65, 0x72,
+    0x66, 0x6F, 0x72, 0x6D, 0x61, 0x6E, 0x63, 0x65, 0x43, 0x61, 0x6D, 0x73,
+    0x68, 0x61, 0x66, 0x74, 0x20, 0x91, 0x81, 0x80, 0x82, 0xB2, 0xC8, 0xA2,
+    0xA0, 0x82, 0xB2, 0xC8, 0xA2, 0xA0, 0xB3, 0x8B, 0xB2, 0xC8, 0xA2, 0xA0,
+    0x45, 0x78, 0x63, 0x65, 0x73, 0x73, 0x69, 0x76, 0x65, 0x20, 0x8B, 0xC1,
+    0x88, 0xBA, 0xB8, 0xBF, 0x84, 0x31, 0x29, 0xC1, 0x88, 0xBA, 0xB8, 0xBF,
+    0x84, 0x32, 0x29, 0x8E, 0x95, 0x86, 0x88, 0x82, 0x8E, 0x95, 0x86, 0x88,
+    0x97, 0xCA, 0x46, 0x6C, 0x6F, 0x77, 0x8E, 0x95, 0x86, 0x88, 0xC5, 0x94,
+    0x28, 0x73, 0x6D, 0x61, 0x6C, 0x6C, 0x20, 0xC6, 0x8E, 0x95, 0x86, 0x88,
+    0xCA, 0x86, 0x56, 0x61, 0x6C, 0x76, 0x65, 0x20, 0x80, 0x82, 0x8E, 0x95,
+    0x86, 0x88, 0x56, 0x65, 0x6E, 0x74, 0x20, 0x86, 0x80, 0x82, 0x8E, 0x95,
+    0x86, 0x88, 0xC5, 0x94, 0x28, 0x67, 0x72, 0x6F, 0x73, 0x73, 0x20, 0xC6,
+    0x8E, 0x95, 0x86, 0x88, 0xC5, 0x94, 0x28, 0x76, 0x65, 0x72, 0x79, 0x20,
+    0x73, 0x6D, 0x61, 0x6C, 0x6C, 0x20, 0xC6, 0x56, 0x65, 0x68, 0x69, 0x63,
+    0x6C, 0x65, 0x20, 0xB1, 0x81, 0x82, 0xC4, 0x86, 0x88, 0x82, 0xC4, 0x86,
+    0x88, 0x52, 0x50, 0x4D, 0x20, 0x4C, 0x6F, 0x77, 0x65, 0x72, 0x20, 0xCE,
+    0xC7, 0xC4, 0x86, 0x88, 0x52, 0x50, 0x4D, 0x20, 0x48, 0x69, 0x67, 0x68,
+    0x65, 0x72, 0x20, 0xCE, 0xC7, 0x88, 0x8C, 0x82, 0x88, 0x8C, 0x4C, 0x6F,
+    0x77, 0x88, 0x8C, 0x48, 0x69, 0x67, 0x68, 0x53, 0x65, 0x72, 0x69, 0x61,
+    0x6C, 0x20, 0x89, 0x4C, 0x69, 0x6E, 0x6B, 0x20, 0x82, 0xAB, 0x86, 0xB5,
+    0xB4, 0x43, 0x68, 0x65, 0x63, 0x6B, 0x20, 0x53, 0x75, 0x6D, 0x20, 0xC3,
+    0xAB, 0x86, 0xB5, 0x4B, 0x65, 0x65, 0x70, 0x20, 0x41, 0x6C, 0x69, 0x76,
+    0x65, 0x20, 0xB4, 0x28, 0x4B, 0x41, 0x4D, 0x29, 0x20, 0xC3, 0xAB, 0x86,
+    0xB5, 0x52, 0x65, 0x61, 0x64, 0x20, 0x4F, 0x6E, 0x6C, 0x79, 0x20, 0xB4,
+    0x28, 0x52, 0x4F, 0x4D, 0x29, 0x20, 0xC3, 0xB7, 0x86, 0x88, 0x82, 0xB7,
+    0x52, 0x61, 0x6E, 0x67, 0x65, 0x20, 0x81, 0x80, 0x83, 0x28, 0x50, 0x52,
+    0x4E, 0x44, 0x4C, 0x20, 0x49, 0x6E, 0x70, 0x75, 0x74, 0x29, 0x49, 0x6E,
+    0x70, 0x75, 0x74, 0x2F, 0x54, 0x75, 0x72, 0x62, 0x69, 0x6E, 0x65, 0x20,
+    0xB1, 0x81, 0x80, 0x82, 0x4F, 0x75, 0x74, 0x70, 0x75, 0x74, 0x20, 0xB1,
+    0x81, 0x80, 0x82, 0x97, 0xAA, 0xAE, 0xAA, 0x31, 0x20, 0x97, 0xAE, 0xAA,
+    0x32, 0x20, 0x97, 0xAE, 0xAA, 0x33, 0x20, 0x97, 0xAE, 0xAA, 0x34, 0x20,
+    0x97, 0xAE, 0x54, 0x6F, 0x72, 0x71, 0x75, 0x65, 0x20, 0x43, 0x6F, 0x6E,
+    0x76, 0x65, 0x72, 0x74, 0x65, 0x72, 0x20, 0x43, 0x6C, 0x75, 0x74, 0x63,
+    0x68, 0x20, 0x80, 0x82, 0xBC, 0xAF, 0x41, 0x20, 0x82, 0xBC, 0xAF, 0x42,
+    0x20, 0x82, 0xBC, 0xAF, 0x43, 0x20, 0x82, 0x9B, 0xB1, 0x43, 0x41, 0x4E,
+    0x20, 0x89, 0x42, 0x75, 0x73, 0xAC, 0x89, 0xB0, 0x45, 0x43, 0x4D, 0x2F,
+    0x50, 0x43, 0x4D, 0x20, 0x22, 0x41, 0x22, 0xAC, 0x89, 0xB0, 0x54, 0x43,
+    0x4D, 0xAC, 0x89, 0xB0, 0x41, 0x6E, 0x74, 0x69, 0x2D, 0x4C, 0x6F, 0x63,
+    0x6B, 0x20, 0x42, 0x72, 0x61, 0x6B, 0x65, 0x20, 0x88, 0x28, 0x41, 0x42,
+    0x53, 0x29, 0x20, 0x86, 0xBB, 0xAC, 0x89, 0xB0, 0x42, 0x6F, 0x64, 0x79,
+    0x20, 0x86, 0xBB, 0xAC, 0x89, 0xB0, 0x49, 0x6E, 0x73, 0x74, 0x72, 0x75,
+    0x6D, 0x65, 0x6E, 0x74, 0x20, 0x50, 0x61, 0x6E, 0x65, 0x6C, 0x20, 0x43,
+    0x6C, 0x75, 0x73, 0x74, 0x65, 0x72, 0x20, 0x28, 0x49, 0x50, 0x43, 0x29,
+    0x20, 0x86, 0xBB
+};
+
+const uint16_t DTC_dictionary_numWords = 79;
+
+const uint16_t DTC_dictionary_wordOffsets[80] = {
+    0x00, 0x08, 0x0F, 0x1A, 0x26, 0x2C, 0x35, 0x3D, 0x49, 0x50, 0x5E, 0x72,
+    0x7A, 0x82, 0x94, 0xA0, 0xA9, 0xB1, 0xBA, 0xC9, 0xD7, 0xE0, 0xE9, 0xEC,
+    0xF6, 0x102, 0x10A, 0x111, 0x116, 0x11B, 0x124, 0x12D, 0x136, 0x13B, 0x13F, 0x14D,
+    0x156, 0x15D, 0x161, 0x168, 0x171, 0x178, 0x17F, 0x184, 0x18D, 0x192, 0x197, 0x19C,
+    0x1A5, 0x1AA, 0x1B0, 0x1B8, 0x1C5, 0x1CC, 0x1D3, 0x1D8, 0x1E5, 0x1EB, 0x1F6, 0x201,
+    0x207, 0x20D, 0x218, 0x21B, 0x225, 0x229, 0x232, 0x23B, 0x240, 0x245, 0x24A, 0x24F,
+    0x257, 0x25B, 0x25E, 0x264, 0x269, 0x26E, 0x273, 0x278
+};
+
+const char DTC_dictionary_words[] =
+    "Circuit ""Sensor ""Malfunction""Malfunction "
+    "(Bank ""Cylinder ""Control ""Temperature "
+    "System ""Communication ""Pressure/Barometric ""Detected"
+    "Voltage ""Range/Performance ""Evaporative ""Injector "
+    "Misfire ""Position ""Throttle/Pedal ""Sensor/Switch "
+    "Detected ""Emission ""O2 ""Incorrect "
+    "Intermittent""Coolant ""Engine ""High "
+    "Input""Absolute ""Manifold ""Pressure "
+    "Flow ""Air ""Recirculation ""Activity "
+    "Intake ""Low ""Problem""Response "
+    "Volume ""Heater ""Gear ""Internal "
+    "Lost ""Mass ""Ratio""Solenoid "
+    "With ""Speed ""Exhaust ""Insufficient "
+    "Memory ""Module ""Slow ""Transmission "
+    "Below ""Crankshaft ""Efficiency ""Module"
+    "Shift ""Thermostat ""or ""Threshold "
+    "Too ""Catalyst ""Condition""Error"
+    "Idle ""Leak ""leak)""Expected"
+    "Gas ""No ""Purge ""Fuel "
+    "Lean ""Rich ""Than ";
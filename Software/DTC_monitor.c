@@ -0,0 +1,256 @@
+/*
+ * DTC_monitor.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+// Programmer libraries
+#include "CAN_device.h"
+#include "DTC_monitor.h"
+#include "SD_writer.h"
+
+// Global variables
+static tDTCCache DTC_cache[DTC_MONITOR_NUM_ECUS] = {{ECM_REQUEST, ECM_RESPONSE},
+                                                    {TCM_REQUEST, TCM_RESPONSE},
+                                                    {ABS_REQUEST, ABS_RESPONSE}
+};
+static const char *ECU_names[DTC_MONITOR_NUM_ECUS] = {"ECM", "TCM", "ABS"};
+static TaskHandle_t DTC_monitor_taskHandler = NULL;
+extern EventGroupHandle_t flagEvents;
+
+
+static tDTCCache *get_ECUcache(uint32_t response_ID){
+
+    for (int i = 0; i < DTC_MONITOR_NUM_ECUS; i++){
+
+        if (DTC_cache[i].response_ID == response_ID){
+
+            return &DTC_cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Ask the ECU for Mode 01 PID 01 and return on status its byte A
+static bool request_DTCstatus(tDTCCache *ECU, uint8_t *status){
+
+    uint8_t response_data_frame[MAX_BYTES];
+    uint32_t ECU_ID;
+    bool answered;
+
+    take_CANbus(portMAX_DELAY);
+    answered = request_ECUdata(ECU->request_ID, ECU->response_ID, 0x01, 0x01, response_data_frame, &ECU_ID);
+    give_CANbus();
+
+    if (answered){
+
+        *status = response_data_frame[3];
+    }
+
+    return answered;
+}
+
+// Read the DTCs of a mode (03 or 07). The CAN bus has to be taken by the caller.
+static bool fetch_DTClist(tDTCCache *ECU, uint8_t mode, tDTCList *DTCs){
+
+    int16_t numDTCs;
+
+    numDTCs = read_DTCs(ECU->request_ID, ECU->response_ID, mode, DTCs->codes, DTC_MONITOR_MAX_DTCS);
+    if (numDTCs < 0){
+
+        return false;
+    }
+    DTCs->numDTCs = numDTCs;
+
+    return true;
+}
+
+static bool same_DTClist(const tDTCList *first, const tDTCList *second){
+
+    if (first->numDTCs != second->numDTCs){
+
+        return false;
+    }
+    for (int i = 0; i < first->numDTCs; i++){
+
+        if (strcmp(first->codes[i], second->codes[i]) != 0){
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Read the stored and pending DTCs of the ECU (only the pending ones with only_pending) and
+// keep them with the status they belong to. The lists that have changed are written on the SD card.
+static bool fetch_DTCs(tDTCCache *ECU, uint8_t status, bool only_pending){
+
+    tDTCList stored, pending;
+    bool read, new_stored, new_pending;
+
+    take_CANbus(portMAX_DELAY);
+    read = (only_pending || fetch_DTClist(ECU, 0x03, &stored)) && fetch_DTClist(ECU, 0x07, &pending);
+    give_CANbus();
+
+    if (read){
+
+        taskENTER_CRITICAL();
+        new_stored = (!only_pending) && ((!ECU->valid) || (!same_DTClist(&ECU->stored, &stored)));
+        new_pending = (!ECU->valid) || (!same_DTClist(&ECU->pending, &pending));
+        if (!only_pending){
+
+            ECU->stored = stored;
+        }
+        ECU->pending = pending;
+        ECU->status = status;
+        ECU->timestamp = xTaskGetTickCount();
+        ECU->valid = true;
+        taskEXIT_CRITICAL();
+
+        if (new_stored){
+
+            post_DTCreport(ECU_names[ECU - DTC_cache], &stored, false);
+        }
+        if (new_pending){
+
+            post_DTCreport(ECU_names[ECU - DTC_cache], &pending, true);
+        }
+    }
+
+    return read;
+}
+
+static portTASK_FUNCTION(DTC_monitor, pvParameters){
+
+    tDTCCache *ECU;
+    uint8_t status;
+
+    while(1){
+
+        for (int i = 0; i < DTC_MONITOR_NUM_ECUS; i++){
+
+            ECU = &DTC_cache[i];
+            // ECUs that are not on the bus are not asked every cycle
+            if (ECU->absent_cycles > 0){
+
+                ECU->absent_cycles--;
+                continue;
+            }
+
+            if (!request_DTCstatus(ECU, &status)){
+
+                ECU->absent_cycles = DTC_MONITOR_ABSENT_CYCLES;
+                continue;
+            }
+
+            // Only a change of the MIL or the number of DTCs needs the whole lists
+            if ((!ECU->valid) || (status != ECU->status)){
+
+                fetch_DTCs(ECU, status, false);
+            }else if ((xTaskGetTickCount() - ECU->timestamp) >= DTC_MONITOR_PENDING_PERIOD_MS/portTICK_PERIOD_MS){
+
+                fetch_DTCs(ECU, status, true);
+            }
+        }
+
+        // Next cycle, or before if the DTCs have been erased
+        xEventGroupWaitBits(flagEvents, DTC_MONITOR_REFRESH, pdTRUE, pdFALSE, DTC_MONITOR_PERIOD_MS/portTICK_PERIOD_MS);
+    }
+}
+
+void init_DTCmonitor(void){
+
+    if ((xTaskCreate(DTC_monitor, (portCHAR *)"DTC_MONITOR", 352, NULL,tskIDLE_PRIORITY + 0, &DTC_monitor_taskHandler) != pdTRUE)){
+
+            while(1);
+    }
+}
+
+// Copy the stored (Mode 03) or pending (Mode 07) DTCs of the ECU.
+// Return false if they have not been read yet.
+bool get_DTCcache(uint32_t response_ID, bool pending, tDTCList *DTCs){
+
+    tDTCCache *ECU = get_ECUcache(response_ID);
+    bool valid;
+
+    if (ECU == NULL){
+
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    valid = ECU->valid;
+    if (valid){
+
+        *DTCs = pending ? ECU->pending : ECU->stored;
+    }
+    taskEXIT_CRITICAL();
+
+    return valid;
+}
+
+bool get_MILstatus(uint32_t response_ID, bool *MIL, uint8_t *numDTCs){
+
+    tDTCCache *ECU = get_ECUcache(response_ID);
+    bool valid;
+
+    if (ECU == NULL){
+
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    valid = ECU->valid;
+    *MIL = (ECU->status & 0x80) != 0;
+    *numDTCs = ECU->status & 0x7F;
+    taskEXIT_CRITICAL();
+
+    return valid;
+}
+
+// Read the DTCs of the ECU now, without waiting for the monitor
+bool refresh_DTCcache(uint32_t response_ID){
+
+    tDTCCache *ECU = get_ECUcache(response_ID);
+    uint8_t status;
+
+    if ((ECU == NULL) || (!request_DTCstatus(ECU, &status))){
+
+        return false;
+    }
+    ECU->absent_cycles = 0;
+
+    return fetch_DTCs(ECU, status, false);
+}
+
+// The DTCs have changed (erased), all the ECUs are read again
+void invalidate_DTCcache(void){
+
+    taskENTER_CRITICAL();
+    for (int i = 0; i < DTC_MONITOR_NUM_ECUS; i++){
+
+        DTC_cache[i].valid = false;
+        DTC_cache[i].absent_cycles = 0;
+    }
+    taskEXIT_CRITICAL();
+
+    xEventGroupSetBits(flagEvents, DTC_MONITOR_REFRESH);
+}
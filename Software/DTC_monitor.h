@@ -0,0 +1,54 @@
+/*
+ * DTC_monitor.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef DTC_MONITOR_H_
+#define DTC_MONITOR_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Monitor configuration
+// Every DTC_MONITOR_PERIOD_MS the monitor asks each ECU for Mode 01 PID 01 (MIL and number
+// of DTCs). Mode 03 and 07 are only requested when that status changes. The status does not
+// count the pending DTCs, so Mode 07 is also requested every DTC_MONITOR_PENDING_PERIOD_MS.
+#define DTC_MONITOR_PERIOD_MS 5000
+#define DTC_MONITOR_PENDING_PERIOD_MS 30000
+#define DTC_MONITOR_ABSENT_CYCLES 6     // Cycles skipped after an ECU does not answer
+#define DTC_MONITOR_NUM_ECUS 3
+#define DTC_MONITOR_MAX_DTCS OBD_MAX_DTCS
+
+typedef struct{
+
+    char codes[DTC_MONITOR_MAX_DTCS][NUM_CHAR_DTC+1];
+    uint8_t numDTCs;
+}tDTCList;
+
+typedef struct{
+
+    uint32_t request_ID;
+    uint32_t response_ID;
+    tDTCList stored;            // Mode 03
+    tDTCList pending;           // Mode 07
+    uint8_t status;             // Byte A of Mode 01 PID 01: MIL (bit 7) and number of DTCs
+    uint8_t absent_cycles;
+    bool valid;                 // The lists have been read
+    TickType_t timestamp;       // Of the last read of the lists
+}tDTCCache;
+
+void init_DTCmonitor(void);
+bool get_DTCcache(uint32_t response_ID, bool pending, tDTCList *DTCs);
+bool get_MILstatus(uint32_t response_ID, bool *MIL, uint8_t *numDTCs);
+bool refresh_DTCcache(uint32_t response_ID);
+void invalidate_DTCcache(void);
+
+#endif /* DTC_MONITOR_H_ */
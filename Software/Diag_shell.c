@@ -0,0 +1,681 @@
+/*
+ * Diag_shell.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// TIVA libraries
+#include "driverlib/can.h"
+#include "utils/cmdline.h"
+#include "utils/uartstdio.h"
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Programmer libraries
+#include "Diag_shell.h"
+#include "CAN_device.h"
+#include "OBD_HAL.h"
+#include "Cycle_probes.h"
+#include "Trace_recorder.h"
+#include "ELM327_interface.h"
+#include "Live_stream.h"
+#include "SLCAN_gateway.h"
+#include "CAN_sniffer.h"
+#include "DTC_monitor.h"
+#include "PID_cache.h"
+#include "SD_writer.h"
+
+// Global variables
+static TaskHandle_t Shell_taskHandler = NULL;
+extern uint32_t g_ui32CPUUsage;
+extern uint32_t g_ulSystemClock;
+extern uint32_t ECU_ID_Response, ECU_ID_Request;
+
+// Prototypes of the commands (g_psCmdTable)
+static int command_help(int argc, char *argv[]);
+static int command_can(int argc, char *argv[]);
+static int command_tasks(int argc, char *argv[]);
+static int command_heap(int argc, char *argv[]);
+static int command_probes(int argc, char *argv[]);
+static int command_trace(int argc, char *argv[]);
+static int command_bench(int argc, char *argv[]);
+static int command_obd(int argc, char *argv[]);
+static int command_elm(int argc, char *argv[]);
+static int command_stream(int argc, char *argv[]);
+static int command_slcan(int argc, char *argv[]);
+static int command_sniff(int argc, char *argv[]);
+
+tCmdLineEntry g_psCmdTable[] = {
+    {"help",    command_help,   "- This list"},
+    {"can",     command_can,    "[ms] - Frames, bus load and errors of the CAN controller"},
+    {"tasks",   command_tasks,  "- CPU use and free stack of every task"},
+    {"heap",    command_heap,   "- Free memory of the FreeRTOS heap"},
+    {"probes",  command_probes, "[reset] - Execution time probes"},
+    {"trace",   command_trace,  "on|off - Stream of the trace of the scheduler"},
+    {"bench",   command_bench,  "[frames] - Round trip of the CAN driver in loopback"},
+    {"obd",     command_obd,    "MODE [PID...] - OBD request (hex bytes) to the ECU of the menu"},
+    {"elm",     command_elm,    "- ELM327 interface for the scan tools, 'exit' to come back"},
+    {"stream",  command_stream, "[baud] - Binary stream of the live data, until the PC stops it"},
+    {"slcan",   command_slcan,  "[baud] - SLCAN interface of the bus for the PC, 'exit' to come back"},
+    {"sniff",   command_sniff,  "uart|sd [ms [ID[/MASK]...]] - Silent capture of the bus to the console or the SD"},
+    {NULL, NULL, NULL}
+};
+
+
+// Number of an argument in the base (16 for the bytes of obd), false if it has other characters
+static bool get_number(const char *text, int base, uint32_t *number){
+
+    char *end;
+
+    *number = strtoul(text, &end, base);
+
+    return (*text != '\0') && (*end == '\0');
+}
+
+// Counts of the probe counter to us
+static uint32_t counts2us(uint32_t counts){
+
+    return (uint32_t)((uint64_t)counts*1000000ULL/get_probeCounterHz());
+}
+
+static int command_help(int argc, char *argv[]){
+
+    for (tCmdLineEntry *entry = g_psCmdTable; entry->pcCmd != NULL; entry++){
+
+        UARTprintf("%s %s\n", entry->pcCmd, entry->pcHelp);
+    }
+
+    return 0;
+}
+
+// The load counts the frames the device sends and reads (the filter hides the rest of the bus)
+static int command_can(int argc, char *argv[]){
+
+    tCANStats before, after;
+    tOBDStats OBD;
+    uint32_t window_ms = SHELL_LOAD_WINDOW_MS;
+    uint32_t per_mille;
+
+    if ((argc > 1) && ((!get_number(argv[1], 10, &window_ms)) || (window_ms == 0) || (window_ms > 60000))){
+
+        return CMDLINE_INVALID_ARG;
+    }
+    get_CANstats(&before);
+    vTaskDelay(window_ms/portTICK_PERIOD_MS);
+    get_CANstats(&after);
+    per_mille = (uint32_t)((uint64_t)(after.bits - before.bits)*1000*1000/((uint64_t)BIT_RATE*window_ms));
+
+    UARTprintf("Frames: %u sent, %u received (%u and %u in %u ms)\n", after.tx_frames, after.rx_frames,
+               after.tx_frames - before.tx_frames, after.rx_frames - before.rx_frames, window_ms);
+    UARTprintf("Bus load of the device: %u.%u %% of %u bit/s\n", per_mille/10, per_mille%10, BIT_RATE);
+    UARTprintf("Errors: REC %u, TEC %u, %u error codes, last code %u%s%s%s\n", after.rx_errors, after.tx_errors,
+               after.error_codes, after.status & CAN_STATUS_LEC_MSK, after.passive ? ", error passive" : "",
+               (after.status & CAN_STATUS_EWARN) ? ", warning level" : "",
+               (after.status & CAN_STATUS_BUS_OFF) ? ", bus off" : "");
+
+    get_OBDstats(&OBD);
+    UARTprintf("OBD: %u requests, %u responses, %u timeouts, %u errors, latency mean %u ms max %u ms\n",
+               OBD.requests, OBD.responses, OBD.timeouts, OBD.errors,
+               (OBD.responses != 0) ? OBD.latency_sum_ms/OBD.responses : 0, OBD.latency_max_ms);
+    UARTprintf("PID cache: %u hits, %u requests on the bus\n", get_PIDcacheHits(), get_PIDcacheBusRequests());
+
+    return 0;
+}
+
+// CPU since the power up (run time counters) and the stack that was never used
+static int command_tasks(int argc, char *argv[]){
+
+    static TaskStatus_t tasks[SHELL_MAX_TASKS];
+    uint32_t total;
+    UBaseType_t numTasks;
+
+    numTasks = uxTaskGetSystemState(tasks, SHELL_MAX_TASKS, &total);
+    // In the order they were created
+    for (UBaseType_t i = 1; i < numTasks; i++){
+
+        for (UBaseType_t j = i; (j > 0) && (tasks[j-1].xTaskNumber > tasks[j].xTaskNumber); j--){
+
+            TaskStatus_t task = tasks[j];
+
+            tasks[j] = tasks[j-1];
+            tasks[j-1] = task;
+        }
+    }
+
+    UARTprintf("CPU %u %% (last 100 ms)\n", g_ui32CPUUsage >> 16);
+    UARTprintf(" CPU %%  Free stack  Prio  State  Task\n");
+    for (UBaseType_t i = 0; i < numTasks; i++){
+
+        uint32_t per_mille = (total != 0) ? (uint32_t)((uint64_t)tasks[i].ulRunTimeCounter*1000/total) : 0;
+
+        UARTprintf("%3u.%u  %10u  %4u      %c  %s\n", per_mille/10, per_mille%10,
+                   (uint32_t)(tasks[i].usStackHighWaterMark*sizeof(StackType_t)), (uint32_t)tasks[i].uxCurrentPriority,
+                   "RBSDI?"[tasks[i].eCurrentState], tasks[i].pcTaskName);
+    }
+
+    return 0;
+}
+
+static int command_heap(int argc, char *argv[]){
+
+    UARTprintf("Heap: %u bytes, %u free, %u free at least since the power up\n", (uint32_t)configTOTAL_HEAP_SIZE,
+               (uint32_t)xPortGetFreeHeapSize(), (uint32_t)xPortGetMinimumEverFreeHeapSize());
+
+    return 0;
+}
+
+static int command_probes(int argc, char *argv[]){
+
+    if ((argc > 1) && (strcmp(argv[1], "reset") == 0)){
+
+        reset_probes();
+        UARTprintf("Probes reset\n");
+    }else {
+
+        dump_probes();
+    }
+
+    return 0;
+}
+
+static int command_trace(int argc, char *argv[]){
+
+    if (argc < 2){
+
+        return CMDLINE_TOO_FEW_ARGS;
+    }
+    if (strcmp(argv[1], "on") == 0){
+
+        trace_stream(true);
+    }else if (strcmp(argv[1], "off") == 0){
+
+        trace_stream(false);
+    }else {
+
+        return CMDLINE_INVALID_ARG;
+    }
+
+    return 0;
+}
+
+// Frames sent and received by the device itself: interrupts, event group, task switches and
+// message objects of the driver, without an ECU. The bus is taken for the whole test.
+static int command_bench(int argc, char *argv[]){
+
+    uint32_t frames = SHELL_BENCH_FRAMES;
+    uint32_t min = UINT32_MAX, max = 0, errors = 0;
+    uint64_t total = 0;
+    uint32_t start_ms, elapsed_ms;
+    uint8_t sent[MAX_BYTES], received[MAX_BYTES];
+    uint32_t ID;
+
+    if ((argc > 1) && ((!get_number(argv[1], 10, &frames)) || (frames == 0) || (frames > 100000))){
+
+        return CMDLINE_INVALID_ARG;
+    }
+    if (!take_CANbus(MAX_TIME_TO_WAIT_MS*5/portTICK_PERIOD_MS)){
+
+        UARTprintf("The CAN bus is busy\n");
+        return 0;
+    }
+    set_CANloopback(true);
+    hal_CANsetReception(SHELL_BENCH_ID, MASK_RESPONSE_ID);
+    start_ms = hal_timeMs();
+    for (uint32_t i = 0; i < frames; i++){
+
+        uint32_t probe, elapsed;
+
+        for (int j = 0; j < MAX_BYTES; j++){
+
+            sent[j] = (uint8_t)(i + j);
+        }
+        probe = PROBE_START();
+        if ((!hal_CANsend(SHELL_BENCH_ID, sent, MAX_BYTES)) || (!hal_CANreceive(&ID, received, MAX_TIME_TO_WAIT_MS)) ||
+            (ID != SHELL_BENCH_ID) || (memcmp(sent, received, MAX_BYTES) != 0)){
+
+            errors++;
+            continue;
+        }
+        elapsed = PROBE_START() - probe;
+        total += elapsed;
+        min = (elapsed < min) ? elapsed : min;
+        max = (elapsed > max) ? elapsed : max;
+    }
+    elapsed_ms = hal_timeMs() - start_ms;
+    set_CANloopback(false);
+    give_CANbus();
+
+    UARTprintf("%u frames in %u ms, %u errors\n", frames, elapsed_ms, errors);
+    if (frames > errors){
+
+        UARTprintf("Round trip: min %u us, mean %u us, max %u us (frame on the bus: %u us)\n", counts2us(min),
+                   counts2us((uint32_t)(total/(frames - errors))), counts2us(max),
+                   (47 + 8*MAX_BYTES)*1000000/BIT_RATE);
+    }
+
+    return 0;
+}
+
+// Request of the mode and the PIDs, the response as it comes (also negative ones, 7F)
+static int command_obd(int argc, char *argv[]){
+
+    static uint8_t payload[256];
+    uint8_t request[MAX_BYTES-1];
+    uint32_t number, request_ID, response_ID;
+    int16_t numBytes;
+
+    if (argc < 2){
+
+        return CMDLINE_TOO_FEW_ARGS;
+    }
+    if (argc > MAX_BYTES){
+
+        return CMDLINE_TOO_MANY_ARGS;
+    }
+    for (int i = 1; i < argc; i++){
+
+        if ((!get_number(argv[i], 16, &number)) || (number > 0xFF)){
+
+            return CMDLINE_INVALID_ARG;
+        }
+        request[i-1] = (uint8_t)number;
+    }
+    // The ECM until one is selected on the menu
+    request_ID = (ECU_ID_Request != 0) ? ECU_ID_Request : ECM_REQUEST;
+    response_ID = (ECU_ID_Response != 0) ? ECU_ID_Response : ECM_RESPONSE;
+
+    if (!take_CANbus(MAX_TIME_TO_WAIT_MS*5/portTICK_PERIOD_MS)){
+
+        UARTprintf("The CAN bus is busy\n");
+        return 0;
+    }
+    numBytes = request_ISOTPmessage(request_ID, response_ID, request, argc - 1, payload, sizeof(payload));
+    give_CANbus();
+
+    if (numBytes < 0){
+
+        UARTprintf("No response of 0x%03X\n", response_ID);
+        return 0;
+    }
+    UARTprintf("0x%03X: %u bytes", response_ID, numBytes);
+    for (int i = 0; (i < numBytes) && (i < (int)sizeof(payload)); i++){
+
+        UARTprintf(((i % 16) == 0) ? "\n %02X" : " %02X", payload[i]);
+    }
+    UARTprintf("\n");
+
+    return 0;
+}
+
+// Output of the ELM327 interface: uartstdio sends '\n' as "\r\n", so the CR of a "\r\n" is left out
+static void write_ELM(const char *text, uint32_t length){
+
+    uint32_t start = 0;
+
+    for (uint32_t i = 0; i + 1 < length; i++){
+
+        if ((text[i] == '\r') && (text[i+1] == '\n')){
+
+            UARTwrite(text + start, i - start);
+            start = i + 1;
+        }
+    }
+    UARTwrite(text + start, length - start);
+}
+
+// The console is the port of an ELM327 (ELM327_interface.h) until a line "exit". The echo
+// is the one of the interface (AT E) and the bus is taken for every command.
+static int command_elm(int argc, char *argv[]){
+
+    static char line[ELM_LINE_CHARS+1];
+    uint32_t length = 0;
+    tELMStats stats;
+    char c;
+
+    // The packets of the trace would go among the answers
+    trace_stream(false);
+    init_ELM327(write_ELM);
+    while(1){
+
+        c = UARTgetc();
+        if (c == '\r'){
+
+            line[length] = '\0';
+            length = 0;
+            if ((strcmp(line, "exit") == 0) || (strcmp(line, "EXIT") == 0)){
+
+                break;
+            }
+            take_CANbus(portMAX_DELAY);
+            process_ELMcommand(line);
+            give_CANbus();
+        }else if ((c != '\n') && (length < ELM_LINE_CHARS)){
+
+            line[length++] = c;
+        }
+    }
+
+    get_ELMstats(&stats);
+    UARTprintf("\nELM327: %u commands, %u requests, %u responses, %u without data, %u errors, response time %u ms\n",
+               stats.commands, stats.requests, stats.responses, stats.no_data, stats.errors, stats.response_ms);
+
+    return 0;
+}
+
+// Frames of the stream, to the ring of the binary output of uartstdio
+static uint32_t write_stream(const uint8_t data[], uint32_t length){
+
+    return (uint32_t)UARTwriteRaw(data, length);
+}
+
+// The console carries the stream of Live_stream.h (at the baud rate asked) until the PC sends
+// STREAM_STOP. The stream takes the bus for every request, so the tasks of the menu still get it
+// between them.
+static int command_stream(int argc, char *argv[]){
+
+    uint32_t baud = SHELL_BAUD;
+    uint32_t request_ID, response_ID, wait_ms;
+    tStreamStats stats;
+
+    if (argc > 2){
+
+        return CMDLINE_TOO_MANY_ARGS;
+    }
+    if ((argc > 1) && ((!get_number(argv[1], 10, &baud)) || (baud < 9600) || (baud > g_ulSystemClock/16))){
+
+        return CMDLINE_INVALID_ARG;
+    }
+    // The ECU of the menu, or the ECM
+    request_ID = (ECU_ID_Request != 0) ? ECU_ID_Request : ECM_REQUEST;
+    response_ID = (ECU_ID_Response != 0) ? ECU_ID_Response : ECM_RESPONSE;
+
+    trace_stream(false);
+    UARTprintf("Stream at %u bauds\n", baud);
+    if (baud != SHELL_BAUD){
+
+        UARTBaudSet(baud);
+    }
+    init_stream(write_stream, request_ID, response_ID);
+    while (stream_active()){
+
+        while (UARTRxBytesAvail() > 0){
+
+            stream_input(UARTgetc());
+        }
+        wait_ms = stream_service();
+        vTaskDelay(wait_ms/portTICK_PERIOD_MS);
+    }
+    if (baud != SHELL_BAUD){
+
+        UARTBaudSet(SHELL_BAUD);
+    }
+
+    get_streamStats(&stats);
+    UARTprintf("\nStream: %u packets, %u dropped, %u samples, %u CAN frames (%u lost), %u requests, %u timeouts\n",
+               stats.packets, stats.dropped, stats.samples, stats.CAN_frames, stats.CAN_lost, stats.requests,
+               stats.timeouts);
+
+    return 0;
+}
+
+// Text of the gateway, to the ring of the binary output of uartstdio
+static uint32_t write_SLCAN(const uint8_t data[], uint32_t length){
+
+    return (uint32_t)UARTwriteRaw(data, length);
+}
+
+// The console is the port of an SLCAN interface (at the baud rate asked) until a line "exit".
+// The bus is taken the whole time, the frames of the bus come from the interrupt and the shell
+// gives their text to the UART every tick.
+static int command_slcan(int argc, char *argv[]){
+
+    static char line[SLCAN_LINE_CHARS+1];
+    uint32_t baud = SHELL_BAUD;
+    uint32_t length = 0;
+    bool done = false;
+    tSLCANStats stats;
+    char c;
+
+    if (argc > 2){
+
+        return CMDLINE_TOO_MANY_ARGS;
+    }
+    if ((argc > 1) && ((!get_number(argv[1], 10, &baud)) || (baud < 9600) || (baud > g_ulSystemClock/16))){
+
+        return CMDLINE_INVALID_ARG;
+    }
+    if (!init_SLCAN(write_SLCAN)){
+
+        UARTprintf("No memory for the gateway\n");
+        return 0;
+    }
+
+    trace_stream(false);
+    UARTprintf("SLCAN at %u bauds, 'exit' to come back\n", baud);
+    if (baud != SHELL_BAUD){
+
+        UARTBaudSet(baud);
+    }
+    take_CANbus(portMAX_DELAY);
+    while (!done){
+
+        while ((!done) && (UARTRxBytesAvail() > 0)){
+
+            c = UARTgetc();
+            if (c == '\r'){
+
+                line[length] = '\0';
+                length = 0;
+                done = (strcmp(line, "exit") == 0) || (strcmp(line, "EXIT") == 0);
+                if ((!done) && (line[0] != '\0')){
+
+                    SLCAN_command(line);
+                }
+            }else if ((c != '\n') && (length < SLCAN_LINE_CHARS)){
+
+                line[length++] = c;
+            }
+        }
+        SLCAN_service();
+        vTaskDelay(1);
+    }
+    end_SLCAN();
+    give_CANbus();
+    if (baud != SHELL_BAUD){
+
+        UARTBaudSet(SHELL_BAUD);
+    }
+
+    get_SLCANstats(&stats);
+    UARTprintf("\nSLCAN: %u frames received (%u dropped, %u overruns), %u sent (%u dropped), %u commands, %u errors\n",
+               stats.rx_frames, stats.rx_dropped, stats.rx_overruns, stats.tx_frames, stats.tx_dropped,
+               stats.commands, stats.errors);
+
+    return 0;
+}
+
+// ID in hex (up to 3 digits for 11 bits, more for 29 bits) and a mask, "7E8/7F8". Without the
+// mask only that ID is taken.
+static bool get_filter(char *text, tSniffFilter *filter){
+
+    char *slash = strchr(text, '/');
+    uint32_t digits;
+
+    if (slash != NULL){
+
+        *slash = '\0';
+    }
+    digits = strlen(text);
+    filter->extended = (digits > 3);
+    filter->mask = filter->extended ? SNIFF_EXTENDED_MASK : SNIFF_STANDARD_MASK;
+    if ((digits > 8) || (!get_number(text, 16, &filter->ID)) || (filter->ID > filter->mask)){
+
+        return false;
+    }
+
+    return (slash == NULL) || (get_number(slash + 1, 16, &filter->mask) && (filter->mask <= SNIFF_EXTENDED_MASK));
+}
+
+// A frame of the capture as a line of candump -l, with the time since the power up
+static void print_sniffedFrame(const tCANCaptureRecord *record){
+
+    UARTprintf((record->flags & CAN_CAPTURE_EXTENDED) ? "(%u.%06u) can0 %08X#" : "(%u.%06u) can0 %03X#",
+               record->time_ms/1000, (record->time_ms % 1000)*1000 + record->time_us, record->ID);
+    for (uint8_t i = 0; i < record->length; i++){
+
+        UARTprintf("%02X", record->data[i]);
+    }
+    UARTprintf("\n");
+}
+
+// The records on the ring of the sniffer to the SD card or the console. At most a ring each
+// time: at full load the console is slower than the bus and would never empty it.
+static uint32_t drain_sniffer(bool SD){
+
+    tCANCaptureRecord record;
+    uint32_t printed = 0;
+
+    if (SD){
+
+        return save_snifferRecords();
+    }
+    while ((printed < SNIFF_RING_RECORDS) && take_snifferRecord(&record)){
+
+        print_sniffedFrame(&record);
+        printed++;
+    }
+
+    return printed;
+}
+
+// The controller only listens (silent mode) and the frames of the filters go to the ring of the
+// sniffer, written on the console or on the SD card while the capture goes on, until the ms
+// given (0, no limit) or a key.
+static int command_sniff(int argc, char *argv[]){
+
+    static tSniffFilter filters[SNIFF_MAX_FILTERS];
+    uint8_t numFilters = 0;
+    uint32_t time_ms = 0, start_ms, written = 0;
+    tSniffStats stats;
+    bool SD;
+
+    if (argc < 2){
+
+        return CMDLINE_TOO_FEW_ARGS;
+    }
+    if (argc > 3 + SNIFF_MAX_FILTERS){
+
+        return CMDLINE_TOO_MANY_ARGS;
+    }
+    SD = (strcmp(argv[1], "sd") == 0);
+    if (((!SD) && (strcmp(argv[1], "uart") != 0)) || ((argc > 2) && (!get_number(argv[2], 10, &time_ms)))){
+
+        return CMDLINE_INVALID_ARG;
+    }
+    for (int i = 3; i < argc; i++){
+
+        if (!get_filter(argv[i], &filters[numFilters++])){
+
+            return CMDLINE_INVALID_ARG;
+        }
+    }
+    if ((SD) && ((!is_SDmounted()) || is_liveLoggerRecording())){
+
+        UARTprintf("No SD card, or the live data is being recorded\n");
+        return 0;
+    }
+    if (!take_CANbus(MAX_TIME_TO_WAIT_MS*5/portTICK_PERIOD_MS)){
+
+        UARTprintf("The CAN bus is busy\n");
+        return 0;
+    }
+    if (!start_sniffer(filters, numFilters)){
+
+        give_CANbus();
+        UARTprintf("No memory for the capture\n");
+        return 0;
+    }
+
+    UARTprintf("Sniffing on a ring of %u frames, a key to stop\n", SNIFF_RING_RECORDS);
+    start_ms = hal_timeMs();
+    while ((UARTRxBytesAvail() == 0) && ((time_ms == 0) || (hal_timeMs() - start_ms < time_ms))){
+
+        written += drain_sniffer(SD);
+        vTaskDelay(SHELL_SNIFF_POLL_MS/portTICK_PERIOD_MS);
+    }
+    stop_sniffer();
+    give_CANbus();
+    while (UARTRxBytesAvail() > 0){
+
+        UARTgetc();
+    }
+
+    written += drain_sniffer(SD);
+    get_snifferStats(&stats);
+    end_sniffer();
+
+    UARTprintf("Sniffer: %u frames in %u ms (%u lost by the message objects, %u overwritten on the ring), %u written\n",
+               stats.frames, stats.time_ms, stats.overruns, stats.overwritten, written);
+
+    return 0;
+}
+
+static portTASK_FUNCTION(Shell_task, pvParameters){
+
+    static char line[SHELL_LINE_CHARS];
+
+    UARTprintf("\nOBD diagnostic shell, 'help' for the commands\n");
+    while(1){
+
+        UARTprintf("> ");
+        // The stream of the trace goes out while the shell waits for a line
+        while (trace_streaming() && (UARTRxBytesAvail() == 0)){
+
+            trace_service();
+            vTaskDelay(TRACE_PERIOD_MS/portTICK_PERIOD_MS);
+        }
+        UARTgets(line, sizeof(line));
+        if (line[0] == '\0'){
+
+            continue;
+        }
+        switch (CmdLineProcess(line)){
+
+        case CMDLINE_BAD_CMD:
+            UARTprintf("Unknown command, 'help' for the list\n");
+            break;
+        case CMDLINE_TOO_MANY_ARGS:
+            UARTprintf("Too many arguments\n");
+            break;
+        case CMDLINE_TOO_FEW_ARGS:
+            UARTprintf("Too few arguments\n");
+            break;
+        case CMDLINE_INVALID_ARG:
+            UARTprintf("Invalid argument\n");
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void init_shell(void){
+
+    if ((xTaskCreate(Shell_task, (portCHAR *)"SHELL", 400, NULL,tskIDLE_PRIORITY + 0, &Shell_taskHandler) != pdTRUE)){
+
+            while(1);
+    }
+}
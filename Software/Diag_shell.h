@@ -0,0 +1,43 @@
+/*
+ * Diag_shell.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Diagnostic shell on the console of UART0 (utils/cmdline.c, 115200 8N1): 'help' lists the
+ *      commands. It shows the CAN traffic and errors, the tasks, the heap and the probes
+ *      (Cycle_probes.h), sends the stream of the trace (Trace_recorder.h), measures the CAN
+ *      driver in loopback and sends any OBD request to the ECU selected on the menu. 'elm' turns
+ *      the console into the port of an ELM327 for the scan tools (ELM327_interface.h), 'stream'
+ *      into the binary stream of the live data (Live_stream.h) and 'slcan' into a CAN interface
+ *      for slcand (SLCAN_gateway.h). 'sniff' captures the bus without being a node of it
+ *      (CAN_sniffer.h).
+ *      The task has the lowest priority and waits on the reception queue of uartstdio, and the
+ *      texts go to its transmission queue, so it only takes the CPU between the frames of the
+ *      protocol tasks. The CAN commands take the bus like the other tasks.
+ */
+
+#ifndef DIAG_SHELL_H_
+#define DIAG_SHELL_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define SHELL_LINE_CHARS 64
+#define SHELL_BAUD 115200                   // Of UARTStdioConfig on main.c
+#define SHELL_MAX_TASKS 12                  // Of the tasks command
+#define SHELL_BENCH_ID 0x7F0                // Frames of the loopback benchmark (never on the bus)
+#define SHELL_BENCH_FRAMES 1000
+#define SHELL_LOAD_WINDOW_MS 1000           // Bus load of the can command
+#define SHELL_SNIFF_POLL_MS 10              // Output of the ring of the sniff command and end of the capture
+
+// After UARTStdioConfig and init_probes
+void init_shell(void);
+
+#endif /* DIAG_SHELL_H_ */
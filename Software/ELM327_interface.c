@@ -0,0 +1,700 @@
+/*
+ * ELM327_interface.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Programmer libraries
+#include "OBD_HAL.h"
+#include "OBD_protocol.h"
+#include "ELM327_interface.h"
+
+// Settings of the AT commands
+typedef struct{
+
+    bool echo;                              // E
+    bool linefeeds;                         // L
+    bool spaces;                            // S
+    bool headers;                           // H
+    bool auto_format;                       // CAF
+    bool flow_control;                      // CFC
+    bool automatic;                         // SP 0, SP Ax
+    bool searching;                         // Automatic and no answer yet
+    uint8_t protocol;                       // 6 or 7
+    uint32_t header;                        // SH of 11 bits
+    uint32_t extended_header;               // SH of 29 bits
+    uint32_t receive_ID;                    // CRA, 0 for all the OBD responses
+    uint8_t timeout;                        // ST
+    uint8_t adaptive;                       // AT 0, 1 or 2
+}tELMSettings;
+
+// Multi frame response of an ECU
+typedef struct{
+
+    bool active;
+    uint32_t ID;
+    uint16_t remaining;                     // Bytes of the consecutive frames
+    uint8_t sequence;                       // Next one
+}tELMSender;
+
+// Global variables
+static tELMWrite ELM_write;
+static tELMSettings settings;
+static tELMStats ELM_stats;
+static tELMSender senders[ELM_MAX_SENDERS];
+static char last_command[ELM_LINE_CHARS+1];
+static const char hex_digits[] = "0123456789ABCDEF";
+
+
+static void set_defaults(void){
+
+    settings.echo = true;
+    settings.linefeeds = false;
+    settings.spaces = true;
+    settings.headers = false;
+    settings.auto_format = true;
+    settings.flow_control = true;
+    settings.automatic = true;
+    settings.searching = true;
+    settings.protocol = 6;
+    settings.header = ELM_FUNCTIONAL_ID;
+    settings.extended_header = ELM_FUNCTIONAL_EXTENDED_ID;
+    settings.receive_ID = 0;
+    settings.timeout = ELM_DEFAULT_TIMEOUT;
+    settings.adaptive = 1;
+
+    // The adaptive timing starts from half of the timeout and learns the ECUs
+    ELM_stats.response_ms = ELM_DEFAULT_TIMEOUT*ELM_TIMEOUT_UNIT_MS/2;
+}
+
+static void write_lineEnd(void){
+
+    ELM_write(settings.linefeeds ? "\r\n" : "\r", settings.linefeeds ? 2 : 1);
+}
+
+static void write_line(const char *text, uint32_t length){
+
+    ELM_write(text, length);
+    write_lineEnd();
+}
+
+static void write_textLine(const char *text){
+
+    write_line(text, strlen(text));
+}
+
+// Blank line and prompt at the end of every command
+static void write_prompt(void){
+
+    write_lineEnd();
+    ELM_write(">", 1);
+}
+
+// Value with digits hex digits at position of text, return the next position
+static uint8_t put_hex(char text[], uint8_t position, uint32_t value, uint8_t digits){
+
+    for (int i = digits - 1; i >= 0; i--){
+
+        text[position++] = hex_digits[(value >> (4*i)) & 0x0F];
+    }
+
+    return position;
+}
+
+// Bytes separated with spaces (AT S1)
+static uint8_t put_bytes(char text[], uint8_t position, const uint8_t data[], uint8_t numBytes){
+
+    for (uint8_t i = 0; i < numBytes; i++){
+
+        if ((settings.spaces) && (position > 0) && (text[position-1] != ' ')){
+
+            text[position++] = ' ';
+        }
+        position = put_hex(text, position, data[i], 2);
+    }
+
+    return position;
+}
+
+// "7E8" or "18 DA F1 10" (AT H1)
+static uint8_t put_header(char text[], uint8_t position, uint32_t ID){
+
+    uint8_t bytes[4];
+
+    if (ID <= 0x7FF){
+
+        return put_hex(text, position, ID, 3);
+    }
+    for (int i = 0; i < 4; i++){
+
+        bytes[i] = (uint8_t)(ID >> (24 - 8*i));
+    }
+
+    return put_bytes(text, position, bytes, 4);
+}
+
+static int8_t hex_value(char c){
+
+    if ((c >= '0') && (c <= '9')){
+
+        return c - '0';
+    }
+    if ((c >= 'A') && (c <= 'F')){
+
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+// Up to 8 hex digits, false if there are other characters
+static bool get_hex(const char *text, uint32_t *value, uint8_t *digits){
+
+    *value = 0;
+    for (*digits = 0; text[*digits] != '\0'; (*digits)++){
+
+        if ((*digits == 8) || (hex_value(text[*digits]) < 0)){
+
+            return false;
+        }
+        *value = (*value << 4) | hex_value(text[*digits]);
+    }
+
+    return true;
+}
+
+static uint32_t timeout_ms(void){
+
+    return (uint32_t)settings.timeout*ELM_TIMEOUT_UNIT_MS;
+}
+
+// Wait for more responses after one: the response time of the ECUs instead of the timeout
+static uint32_t window_ms(void){
+
+    uint32_t window;
+
+    switch (settings.adaptive){
+
+    case 1:
+        window = 2*ELM_stats.response_ms + ELM_ADAPTIVE_MARGIN_MS;
+        break;
+    case 2:
+        window = ELM_stats.response_ms + ELM_ADAPTIVE_MARGIN_MS;
+        break;
+    default:
+        return timeout_ms();
+    }
+
+    return (window < timeout_ms()) ? window : timeout_ms();
+}
+
+// The physical request ID of the ECU that answers with ID
+static uint32_t flowControl_ID(uint32_t ID){
+
+    if (ID <= 0x7FF){
+
+        return ID - 8;
+    }
+
+    // 18 DA F1 xx -> 18 DA xx F1
+    return (ID & 0xFFFF0000) | ((ID & 0xFF) << 8) | ((ID >> 8) & 0xFF);
+}
+
+static tELMSender *find_sender(uint32_t ID){
+
+    for (int i = 0; i < ELM_MAX_SENDERS; i++){
+
+        if ((senders[i].active) && (senders[i].ID == ID)){
+
+            return &senders[i];
+        }
+    }
+
+    return NULL;
+}
+
+static bool senders_active(void){
+
+    for (int i = 0; i < ELM_MAX_SENDERS; i++){
+
+        if (senders[i].active){
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// First frame: the sender waits for its consecutive frames and gets the flow control
+// (continue to send, without block size nor separation time)
+static void start_sender(uint32_t ID, uint16_t length){
+
+    tELMSender *sender = find_sender(ID);
+    uint8_t frame[MAX_BYTES] = {0x30, 0x00, 0x00, ELM_PADDING, ELM_PADDING, ELM_PADDING, ELM_PADDING, ELM_PADDING};
+
+    for (int i = 0; (sender == NULL) && (i < ELM_MAX_SENDERS); i++){
+
+        if (!senders[i].active){
+
+            sender = &senders[i];
+        }
+    }
+    if (sender == NULL){
+
+        ELM_stats.errors++;
+        return;
+    }
+    sender->active = true;
+    sender->ID = ID;
+    sender->remaining = (length > 6) ? length - 6 : 0;
+    sender->sequence = 1;
+
+    if ((settings.flow_control) && (!hal_CANsend(flowControl_ID(ID), frame, MAX_BYTES))){
+
+        ELM_stats.errors++;
+    }
+}
+
+// Print a frame of a response. started is set by the first frame of a message, pending by a
+// response pending (7F xx 78). Return true if the frame ends a message.
+static bool print_frame(uint32_t ID, const uint8_t frame[], bool *started, bool *pending){
+
+    char line[ELM_OUTPUT_CHARS];
+    uint8_t position = 0;
+    uint8_t length, numBytes;
+    tELMSender *sender;
+
+    *started = false;
+    *pending = false;
+    if (settings.headers){
+
+        position = put_header(line, 0, ID);
+    }
+    // Without auto format the frames go as they are
+    if (!settings.auto_format){
+
+        *started = true;
+        write_line(line, put_bytes(line, position, frame, MAX_BYTES));
+        return true;
+    }
+
+    switch (frame[0] >> 4){
+
+    case 0:
+        // Single frame: length + 7 bytes
+        length = frame[0] & 0x0F;
+        if ((length == 0) || (length > (MAX_BYTES-1))){
+
+            ELM_stats.errors++;
+            write_line(line, put_bytes(line, position, frame, MAX_BYTES));
+            return false;
+        }
+        *started = true;
+        *pending = (length >= 3) && (frame[1] == 0x7F) && (frame[3] == 0x78);
+        if (settings.headers){
+
+            position = put_bytes(line, position, frame, length + 1);
+        }else {
+
+            position = put_bytes(line, position, &frame[1], length);
+        }
+        write_line(line, position);
+        return !(*pending);
+
+    case 1:
+        // First frame: 12 bits length + 6 bytes, "014" and "0: 49 02 01 31 44 34" without headers
+        *started = true;
+        start_sender(ID, ((uint16_t)(frame[0] & 0x0F) << 8) | frame[1]);
+        if (settings.headers){
+
+            write_line(line, put_bytes(line, position, frame, MAX_BYTES));
+        }else {
+
+            write_line(line, put_hex(line, 0, ((uint16_t)(frame[0] & 0x0F) << 8) | frame[1], 3));
+            position = put_hex(line, 0, 0, 1);
+            line[position++] = ':';
+            write_line(line, put_bytes(line, position, &frame[2], MAX_BYTES-2));
+        }
+        return false;
+
+    case 2:
+        // Consecutive frame: sequence number + 7 bytes, "1: 47 50..." without headers
+        sender = find_sender(ID);
+        numBytes = MAX_BYTES-1;
+        if ((sender != NULL) && (sender->remaining < numBytes)){
+
+            numBytes = sender->remaining;
+        }
+        if (settings.headers){
+
+            position = put_bytes(line, position, frame, MAX_BYTES);
+        }else {
+
+            position = put_hex(line, 0, frame[0] & 0x0F, 1);
+            line[position++] = ':';
+            position = put_bytes(line, position, &frame[1], numBytes);
+        }
+        write_line(line, position);
+        if (sender == NULL){
+
+            return false;
+        }
+        if ((frame[0] & 0x0F) != (sender->sequence & 0x0F)){
+
+            // The rest of the message is lost
+            ELM_stats.errors++;
+            sender->active = false;
+            return false;
+        }
+        sender->sequence++;
+        sender->remaining -= numBytes;
+        if (sender->remaining == 0){
+
+            sender->active = false;
+            return true;
+        }
+        return false;
+
+    default:
+        write_line(line, put_bytes(line, position, frame, MAX_BYTES));
+        return false;
+    }
+}
+
+// Send the request on the protocol and print the responses until the wanted number (0 for
+// all) or the end of the wait. Return the number of responses or -1 if it was not sent.
+static int16_t send_request(const uint8_t request[], uint8_t numBytes, uint8_t wanted){
+
+    uint8_t frame[MAX_BYTES];
+    uint32_t ID, request_ID, sent_ms, latency_ms = 0, wait_ms = timeout_ms();
+    int16_t responses = 0;
+    bool started, pending, waiting_pending = false;
+
+    if (settings.protocol == 6){
+
+        request_ID = settings.header;
+        hal_CANsetReception((settings.receive_ID != 0) ? settings.receive_ID : ELM_RESPONSES_ID,
+                            (settings.receive_ID != 0) ? MASK_RESPONSE_ID : ELM_RESPONSES_MASK);
+    }else {
+
+        request_ID = settings.extended_header;
+        hal_CANsetReception((settings.receive_ID != 0) ? settings.receive_ID : ELM_RESPONSES_EXTENDED_ID,
+                            (settings.receive_ID != 0) ? 0x1FFFFFFF : ELM_RESPONSES_EXTENDED_MASK);
+    }
+
+    // With auto format the single frame is built, without it the bytes go as they are
+    for (int i = 0; i < MAX_BYTES; i++){
+
+        frame[i] = ELM_PADDING;
+    }
+    if (settings.auto_format){
+
+        frame[0] = numBytes;
+        memcpy(&frame[1], request, numBytes);
+    }else {
+
+        memcpy(frame, request, numBytes);
+    }
+    memset(senders, 0, sizeof(senders));
+
+    if (!hal_CANsend(request_ID, frame, settings.auto_format ? MAX_BYTES : numBytes)){
+
+        ELM_stats.errors++;
+        return -1;
+    }
+    ELM_stats.requests++;
+    sent_ms = hal_timeMs();
+
+    while (hal_CANreceive(&ID, frame, wait_ms)){
+
+        if (print_frame(ID, frame, &started, &pending)){
+
+            responses++;
+            ELM_stats.responses++;
+        }
+        if ((started) && (!pending) && (hal_timeMs() - sent_ms > latency_ms)){
+
+            latency_ms = hal_timeMs() - sent_ms;
+        }
+        if ((wanted != 0) && (responses >= wanted)){
+
+            break;
+        }
+        // The timeout while a message is not complete or an ECU asked for more time
+        waiting_pending = pending || (waiting_pending && !started);
+        wait_ms = ((responses == 0) || (waiting_pending) || (senders_active())) ? timeout_ms() : window_ms();
+    }
+    ELM_stats.wait_ms += hal_timeMs() - sent_ms;
+
+    // The response time follows the slowest ECU at once and comes down slowly, as the P2 of
+    // an ECU changes from one answer to the next
+    if (responses > 0){
+
+        ELM_stats.response_ms = (latency_ms > ELM_stats.response_ms) ? latency_ms : ELM_stats.response_ms - (ELM_stats.response_ms - latency_ms)/8;
+    }
+
+    return responses;
+}
+
+// Request in hex digits, a last single digit is the number of responses
+static void process_request(const char *command){
+
+    uint8_t request[MAX_BYTES];
+    uint8_t numDigits = strlen(command), numBytes, wanted = 0;
+    int16_t responses;
+
+    for (uint8_t i = 0; i < numDigits; i++){
+
+        if (hex_value(command[i]) < 0){
+
+            ELM_stats.errors++;
+            write_textLine("?");
+            return;
+        }
+    }
+    if ((numDigits % 2) == 1){
+
+        wanted = hex_value(command[--numDigits]);
+    }
+    numBytes = numDigits/2;
+    if ((numBytes == 0) || (numBytes > (settings.auto_format ? MAX_BYTES-1 : MAX_BYTES))){
+
+        ELM_stats.errors++;
+        write_textLine("?");
+        return;
+    }
+    for (uint8_t i = 0; i < numBytes; i++){
+
+        request[i] = (hex_value(command[2*i]) << 4) | hex_value(command[2*i+1]);
+    }
+
+    // The automatic protocol tries the other one when there is no answer
+    if (settings.searching){
+
+        write_textLine("SEARCHING...");
+    }
+    responses = send_request(request, numBytes, wanted);
+    if ((responses == 0) && (settings.searching)){
+
+        settings.protocol = (settings.protocol == 6) ? 7 : 6;
+        responses = send_request(request, numBytes, wanted);
+        if (responses == 0){
+
+            settings.protocol = (settings.protocol == 6) ? 7 : 6;
+        }
+    }
+    if (responses > 0){
+
+        settings.searching = false;
+    }else if (responses < 0){
+
+        write_textLine("CAN ERROR");
+    }else {
+
+        ELM_stats.no_data++;
+        write_textLine(settings.searching ? "UNABLE TO CONNECT" : "NO DATA");
+    }
+}
+
+// "E0", "E1"... of a setting of name. False if the command is another one.
+static bool set_flag(const char *command, const char *name, bool *flag){
+
+    uint8_t length = strlen(name);
+
+    if ((strncmp(command, name, length) != 0) || ((command[length] != '0') && (command[length] != '1')) ||
+        (command[length+1] != '\0')){
+
+        return false;
+    }
+    *flag = (command[length] == '1');
+
+    return true;
+}
+
+// SP and TP: "6", "7", "0" (automatic) or "A6", "A7" (automatic from that one)
+static bool set_protocol(const char *text){
+
+    bool automatic = (*text == 'A');
+
+    if (automatic){
+
+        text++;
+    }
+    if ((text[1] != '\0') || ((text[0] != '0') && (text[0] != '6') && (text[0] != '7'))){
+
+        return false;
+    }
+    settings.automatic = automatic || (text[0] == '0');
+    settings.searching = settings.automatic;
+    settings.protocol = (text[0] == '7') ? 7 : 6;
+
+    return true;
+}
+
+static void write_protocol(bool number){
+
+    char text[32] = "";
+
+    if (settings.automatic){
+
+        strcat(text, number ? "A" : "AUTO, ");
+    }
+    if (number){
+
+        strcat(text, (settings.protocol == 6) ? "6" : "7");
+    }else {
+
+        strcat(text, (settings.protocol == 6) ? "ISO 15765-4 (CAN 11/500)" : "ISO 15765-4 (CAN 29/500)");
+    }
+    write_textLine(text);
+}
+
+// Command after "AT", false if it is unknown
+static bool process_AT(const char *command){
+
+    bool ignored;
+    uint32_t value;
+    uint8_t digits;
+
+    if ((strcmp(command, "Z") == 0) || (strcmp(command, "WS") == 0)){
+
+        set_defaults();
+        write_textLine(ELM_ID_TEXT);
+        return true;
+    }
+    if (strcmp(command, "I") == 0){
+
+        write_textLine(ELM_ID_TEXT);
+        return true;
+    }
+    if (strcmp(command, "@1") == 0){
+
+        write_textLine(ELM_DESCRIPTION_TEXT);
+        return true;
+    }
+    if ((strcmp(command, "DP") == 0) || (strcmp(command, "DPN") == 0)){
+
+        write_protocol(command[2] == 'N');
+        return true;
+    }
+
+    if (strcmp(command, "D") == 0){
+
+        set_defaults();
+    }else if ((set_flag(command, "E", &settings.echo)) || (set_flag(command, "L", &settings.linefeeds)) ||
+              (set_flag(command, "S", &settings.spaces)) || (set_flag(command, "H", &settings.headers)) ||
+              (set_flag(command, "CAF", &settings.auto_format)) || (set_flag(command, "CFC", &settings.flow_control)) ||
+              (set_flag(command, "M", &ignored))){
+
+    }else if ((strcmp(command, "AL") == 0) || (strcmp(command, "NL") == 0) || (strcmp(command, "PC") == 0)){
+
+        // Long messages and protocol close: nothing to do on CAN
+    }else if ((strncmp(command, "AT", 2) == 0) && (command[2] >= '0') && (command[2] <= '2') && (command[3] == '\0')){
+
+        settings.adaptive = command[2] - '0';
+    }else if ((strncmp(command, "ST", 2) == 0) && (get_hex(command + 2, &value, &digits)) && (digits >= 1) && (digits <= 2)){
+
+        settings.timeout = (value != 0) ? value : ELM_DEFAULT_TIMEOUT;
+    }else if ((strncmp(command, "SP", 2) == 0) || (strncmp(command, "TP", 2) == 0)){
+
+        if (!set_protocol(command + 2)){
+
+            return false;
+        }
+    }else if ((strncmp(command, "SH", 2) == 0) && (get_hex(command + 2, &value, &digits))){
+
+        if ((digits == 3) && (value <= 0x7FF)){
+
+            settings.header = value;
+        }else if (digits == 6){
+
+            settings.extended_header = ((uint32_t)ELM_HEADER_PRIORITY << 24) | value;
+        }else if ((digits == 8) && (value <= 0x1FFFFFFF)){
+
+            settings.extended_header = value;
+        }else {
+
+            return false;
+        }
+    }else if ((strncmp(command, "CRA", 3) == 0) && (get_hex(command + 3, &value, &digits)) &&
+              ((digits == 0) || ((digits == 3) && (value <= 0x7FF)) || ((digits == 8) && (value <= 0x1FFFFFFF)))){
+
+        settings.receive_ID = value;
+    }else {
+
+        return false;
+    }
+    write_textLine("OK");
+
+    return true;
+}
+
+void init_ELM327(tELMWrite write){
+
+    ELM_write = write;
+    memset(&ELM_stats, 0, sizeof(ELM_stats));
+    set_defaults();
+    last_command[0] = '\0';
+
+    write_textLine(ELM_ID_TEXT);
+    write_prompt();
+}
+
+void process_ELMcommand(const char *line){
+
+    char command[ELM_LINE_CHARS+1];
+    uint8_t length = 0;
+
+    ELM_stats.commands++;
+    if (settings.echo){
+
+        write_line(line, strlen(line));
+    }
+
+    // Upper case without spaces nor control characters
+    for (; (*line != '\0') && (length < ELM_LINE_CHARS); line++){
+
+        if ((*line > ' ') && (*line <= '~')){
+
+            command[length++] = ((*line >= 'a') && (*line <= 'z')) ? *line - 'a' + 'A' : *line;
+        }
+    }
+    command[length] = '\0';
+    if (length == 0){
+
+        strcpy(command, last_command);
+    }else {
+
+        strcpy(last_command, command);
+    }
+
+    if (strncmp(command, "AT", 2) == 0){
+
+        if (!process_AT(command + 2)){
+
+            ELM_stats.errors++;
+            write_textLine("?");
+        }
+    }else if (command[0] != '\0'){
+
+        process_request(command);
+    }
+    write_prompt();
+}
+
+void get_ELMstats(tELMStats *stats){
+
+    *stats = ELM_stats;
+}
@@ -0,0 +1,73 @@
+/*
+ * ELM327_interface.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Command processor compatible with the ELM327, so the scan tools of the PC and the phones
+ *      use the device as their adapter ('elm' on the shell of UART0, Diag_shell.h):
+ *      - AT commands: Z, WS, D, I, @1, E, L, S, H, CAF, CFC, SP, TP, DP, DPN, SH, CRA, ST, AT,
+ *        M, AL, NL, PC ('?' for the rest). Only ISO 15765-4 at 500 kbit/s (protocols 6 and 7).
+ *      - Requests in hex ("010C", "01 0C 0D 05" with up to 6 PIDs): the single frame is built,
+ *        the flow control of the multi frame responses is sent and the frames are printed as
+ *        the ELM327 does (CAF1: "014" and "0: 49 02 01 31..." lines, H1: with the header).
+ *        A last single digit is the number of responses to wait for ("010C1").
+ *      - Adaptive timing: after a response the wait for more ECUs is the time the ECUs take to
+ *        answer (twice with AT1, once with AT2, plus a margin), not the whole ST timeout.
+ *      It only uses OBD_HAL.h, like OBD_protocol.c, so it builds and runs on a PC
+ *      (Host/ELM327_host). The caller takes the CAN bus and gives the lines without the CR.
+ */
+
+#ifndef ELM327_INTERFACE_H_
+#define ELM327_INTERFACE_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define ELM_LINE_CHARS 64                   // Command line without the CR
+#define ELM_OUTPUT_CHARS 48                 // A line of a response
+#define ELM_ID_TEXT "ELM327 v1.5"
+#define ELM_DESCRIPTION_TEXT "TM4C123 OBD scanner"
+#define ELM_TIMEOUT_UNIT_MS 4               // AT ST hh: hh*4 ms
+#define ELM_DEFAULT_TIMEOUT 0x32            // 200 ms
+#define ELM_ADAPTIVE_MARGIN_MS 4
+#define ELM_MAX_SENDERS 8                   // ECUs with a multi frame response at a time
+#define ELM_PADDING 0x55                    // Of the requests and flow controls (8 bytes, ISO 15765-4)
+
+// IDs of the protocols 6 (11 bit) and 7 (29 bit)
+#define ELM_FUNCTIONAL_ID 0x7DF
+#define ELM_RESPONSES_ID 0x7E8              // 7E8 to 7EF
+#define ELM_RESPONSES_MASK 0x7F8
+#define ELM_FUNCTIONAL_EXTENDED_ID 0x18DB33F1
+#define ELM_RESPONSES_EXTENDED_ID 0x18DAF100  // 18 DA F1 xx: answers to the tester F1
+#define ELM_RESPONSES_EXTENDED_MASK 0x1FFFFF00
+#define ELM_HEADER_PRIORITY 0x18            // Of a 29 bit header of 6 digits (AT SH xxyyzz)
+
+// Output of the interface: responses, echo and prompt, with the line ends of AT L
+typedef void (*tELMWrite)(const char *text, uint32_t length);
+
+// Since init_ELM327
+typedef struct{
+
+    uint32_t commands;                      // Lines processed
+    uint32_t requests;                      // OBD requests sent
+    uint32_t responses;                     // Messages received (single frame or whole multi frame)
+    uint32_t no_data;                       // Requests without any response
+    uint32_t errors;                        // Not sent, wrong sequence or '?'
+    uint32_t wait_ms;                       // Time waiting for responses
+    uint32_t response_ms;                   // Response time of the adaptive timing
+}tELMStats;
+
+// Default settings, statistics to zero and the identification with the prompt
+void init_ELM327(tELMWrite write);
+// A command line. An empty one repeats the last command.
+void process_ELMcommand(const char *line);
+void get_ELMstats(tELMStats *stats);
+
+#endif /* ELM327_INTERFACE_H_ */
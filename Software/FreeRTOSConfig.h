@@ -79,8 +79,22 @@
 #define configMAX_PRIORITIES                ( 16 )  // Número de prioridades para las tareas
 #define configCPU_CLOCK_HZ                  ( ( unsigned long ) MAP_SysCtlClockGet() ) // Frecuencia de reloj del sistema (debe coincidir con SyCtlClockSet)
 #define configTICK_RATE_HZ                  ( ( portTickType ) 1000 ) // Número de TICKS por segundo --> precision del SO
+// RAM of the TM4C123GH6PM (32 KB): the main stack of tm4c123gh6pm.cmd (512 bytes, used by the
+// interrupts once the scheduler runs), the static data (.data and .bss, about 12.3 KB on the .map
+// file) and the heap of FreeRTOS (19 KB). The heap keeps:
+//     Stacks of the 12 tasks (3488 words)             13952
+//     TCBs and headers of heap_4 (112 each task)       1344
+//     Queues, mutexes and event groups                 1808   timer 16, SD writer 4, uartstdio
+//     Ring of slcan or sniff (one at a time)          1032   SLCAN_gateway.h, CAN_sniffer.h
+//     Answers of the ECUs and texts                     512   CAN_device.c, Graphic_interface.c
+//     Free                                              808
+// Every stack is the use measured on the firmware simulator (Host/Firmware_sim, built to measure
+// them) with every script and menu, plus 328 bytes for the context saved with the FPU (51 words)
+// and the libraries it does not count, rounded up to 16 words. snprintf of the C library counts
+// as 512 bytes. A new task, object or bigger buffer takes its bytes from the free ones or from
+// another line.
 #define configMINIMAL_STACK_SIZE            ( ( unsigned short ) 128 )   // Tamaño de la pila de la tarea IDLE en objetos (ARM:1objeto->32bits)
-#define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 20 * 1024 ) ) // Memoria dinámica reservada a FreeRTOS (en bytes)
+#define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 19 * 1024 ) ) // Memoria dinámica reservada a FreeRTOS (en bytes)
 #define configMAX_TASK_NAME_LEN             ( 12 ) // Longitud máxima de los nombres dados a las tareas
 #define configUSE_TRACE_FACILITY            1 // 1/0: Activación del modo traza
 #define configUSE_16_BIT_TICKS              0 // 1/0: Tamaño de la variable de cuenta de ticks (1:16bits, 0:32bits)
@@ -107,8 +121,8 @@
 /* Software timer definitions. */
 #define configUSE_TIMERS				1 // 1/0: Activa el uso de timers SW (basados en ticks)
 #define configTIMER_TASK_PRIORITY		( 2 ) // Fija la prioridad de la tareas interna que actualiza los timer SW
-#define configTIMER_QUEUE_LENGTH		32 // Tamaño de la cola de comandos de control de Timers SW
-#define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 ) // Tamaño de la pila de la tarea interna que gestiona los timer SW
+#define configTIMER_QUEUE_LENGTH		16 // Tamaño de la cola de comandos de control de Timers SW
+#define configTIMER_TASK_STACK_DEPTH	( 176 ) // Tamaño de la pila de la tarea interna que gestiona los timer SW
 
 
 #define configUSE_STATS_FORMATTING_FUNCTIONS 1 // 1/0: Formateo de parámetros estadísticos recogidos en depuración
@@ -122,6 +136,13 @@
 #endif
 #endif
 
+// Trace of the scheduler (Trace_recorder.c)
+#if configUSE_TRACE_FACILITY
+#ifndef __ASM_HEADER__
+#include "Trace_recorder.h"
+#endif
+#endif
+
 
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
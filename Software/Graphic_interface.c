@@ -42,10 +42,12 @@
 #include "Graphic_interface.h"
 #include "CAN_device.h"
 #include "ST7735.h"
+#include "PID_history.h"
 
 // Global variables
 uint16_t menu_cursor, menu_ECU_cursor, menu_showed;
 bool OnMenu;
+static uint8_t chart_scroll;
 
 void cleanScreen(void){
 
@@ -151,8 +153,9 @@ void decimal2Hex(const char cadena[], char *cadenaHex) {
 void hex2Binary(char *cadena_hex, char **cadena_bin_output){
 
     int numBytes = sizeOfFrame(cadena_hex);
-    char cadena_bin[32];
-    *cadena_bin_output = (char*)pvPortMalloc(4*numBytes*sizeof(char));
+    // The bits go straight to the output, with room for the end of the string
+    char *cadena_bin = (char*)pvPortMalloc((4*numBytes+1)*sizeof(char));
+    *cadena_bin_output = cadena_bin;
 
     int j = 0;
 
@@ -308,8 +311,7 @@ void hex2Binary(char *cadena_hex, char **cadena_bin_output){
         j++;
     }
 
-    memcpy(*cadena_bin_output, cadena_bin, (numBytes*4)+1);
-    *(*cadena_bin_output+(numBytes*4)) = '\0';
+    cadena_bin[numBytes*4] = '\0';
 }
 
 uint16_t hex2Decimal(const char cadenaHex[]) {
@@ -419,3 +421,95 @@ void drawECUMenu(void){
      }
 }
 
+// Convert a PID value into the row of the chart according to the range of the PID
+static int16_t chart_value2Y(int16_t value, uint8_t posPID){
+
+    int32_t min = liveData_ranges[posPID][0];
+    int32_t max = liveData_ranges[posPID][1];
+
+    if (value <= min){
+        return CHART_POS_Y1;
+    }
+    if (value >= max){
+        return CHART_POS_Y0;
+    }
+
+    return CHART_POS_Y1 - (int16_t)(((value - min)*(CHART_POS_Y1 - CHART_POS_Y0))/(max - min));
+}
+
+void init_stripChart(uint8_t posPID){
+
+    char range[7];
+
+    cleanScreen();
+    setScrollArea(CHART_LABEL_LINES, 0);
+    chart_scroll = 0;
+    scrollTo(CHART_LABEL_LINES);
+
+    // Labels on the fixed area
+    drawString(CHART_LINE2X(CHART_LABEL_LINES-1), CHART_POS_Y0, liveData_shortStrings[posPID], CHART_LABEL_COLOUR, MENU_BG_COLOUR, 1, 0);
+    snprintf(range, sizeof(range), "%d", liveData_ranges[posPID][1]);
+    drawString(CHART_LINE2X(CHART_LABEL_LINES-1), CHART_POS_Y0+15, range, CHART_LABEL_COLOUR, MENU_BG_COLOUR, 1, 0);
+    snprintf(range, sizeof(range), "%d", liveData_ranges[posPID][0]);
+    drawString(CHART_LINE2X(CHART_LABEL_LINES-1), CHART_POS_Y1-8, range, CHART_LABEL_COLOUR, MENU_BG_COLOUR, 1, 0);
+}
+
+// Draw the whole history of the PID. Only used when the chart is shown, after that
+// the chart is updated with drawStripChartColumn.
+void drawStripChart(uint8_t posPID){
+
+    tPIDHistoryColumn column;
+    uint16_t count;
+
+    init_stripChart(posPID);
+
+    count = get_PIDhistoryCount(posPID);
+    if (count > CHART_COLUMNS){
+
+        count = CHART_COLUMNS;
+    }
+    for (int age = count-1; age >= 0; age--){
+
+        get_PIDhistoryColumn(posPID, age, &column);
+        drawStripChartColumn(column.min, column.max, posPID);
+    }
+}
+
+// Draw the newest column on the frame memory line that leaves the screen and move the
+// scroll one line, so the rest of the chart is not redrawn.
+void drawStripChartColumn(int16_t min_value, int16_t max_value, uint8_t posPID){
+
+    int16_t x = CHART_LINE2X(CHART_LABEL_LINES + chart_scroll);
+    int16_t y_max = chart_value2Y(max_value, posPID);
+    int16_t y_min = chart_value2Y(min_value, posPID);
+
+    if (y_max > CHART_POS_Y0){
+        drawFastVLine(x, CHART_POS_Y0, y_max - CHART_POS_Y0, MENU_BG_COLOUR);
+    }
+    drawFastVLine(x, y_max, y_min - y_max + 1, CHART_COLOUR);
+    if (y_min < CHART_POS_Y1){
+        drawFastVLine(x, y_min + 1, CHART_POS_Y1 - y_min, MENU_BG_COLOUR);
+    }
+
+    chart_scroll++;
+    if (chart_scroll == CHART_COLUMNS){
+
+        chart_scroll = 0;
+    }
+    scrollTo(CHART_LABEL_LINES + chart_scroll);
+}
+
+void drawStripChartValue(double value){
+
+    char output[7];
+
+    snprintf(output, sizeof(output), "%-5d", (int)value);
+    drawString(CHART_LINE2X(CHART_LABEL_LINES-1), (CHART_POS_Y0+CHART_POS_Y1)/2, output, MENU_DATA_TEXT_COLOUR, MENU_BG_COLOUR, 1, 0);
+}
+
+void exit_stripChart(void){
+
+    setScrollArea(0, 0);
+    scrollTo(0);
+    cleanScreen();
+}
@@ -31,13 +31,25 @@
 #define MENU_ITEM_POS_X0 2
 #define MENU_ITEM_POS_Y0 2
 #define MENU_ITEM_POS_OFFSET 10
-#define MENU_ITEMS 6
+#define MENU_ITEMS 7
 #define MENU_ECU_ITEMS 3
 
 // Menu showed values
 #define MENU_ECU 0
 #define MENU_MODE 1
 
+// Strip chart defines
+// The chart uses the hardware scroll of the screen: the first CHART_LABEL_LINES lines
+// of the frame memory are fixed (labels) and the rest scroll one column per sample.
+#define CHART_LABEL_LINES 34
+#define CHART_COLUMNS (SCREEN_HEIGHT-CHART_LABEL_LINES)
+#define CHART_POS_Y0 5
+#define CHART_POS_Y1 (SCREEN_WIDTH-6)
+#define CHART_COLOUR Colour565(0,255,0)
+#define CHART_LABEL_COLOUR MENU_ITEM_UNSELECTED_TEXT_COLOUR
+// Rotation 1 mirrors the rows of the frame memory (MADCTL_MY), so the line 0 is the right-most column
+#define CHART_LINE2X(line) (SCREEN_HEIGHT-1-(line))
+
 void init_graphicInterface(void);
 char convert2Hex(uint16_t decimal);
 void decimal2Hex(const char cadena[], char *cadenaHex);
@@ -49,6 +61,11 @@ void drawECUMenu(void);
 void cleanScreen(void);
 void cleanData(uint8_t posData);
 void tabular(char cadena[]);
+void init_stripChart(uint8_t posPID);
+void drawStripChart(uint8_t posPID);
+void drawStripChartColumn(int16_t min_value, int16_t max_value, uint8_t posPID);
+void drawStripChartValue(double value);
+void exit_stripChart(void);
 
 static const char *menu_ECU_items[] = {
 
@@ -64,7 +81,8 @@ static const char *menu_items[] = {
           "Erase codes",
           "View freeze frame",
           "Live all data",
-          "DTCs during driving cycle"
+          "DTCs during driving cycle",
+          "Broadcast signals"
 };
 
 
@@ -0,0 +1,339 @@
+/*
+ * Live_logger.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// TIVA libraries
+#include "inc/hw_types.h"
+#include "inc/hw_nvic.h"
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Programmer libraries
+#include "CAN_device.h"
+#include "DTC_monitor.h"
+#include "Live_logger.h"
+#include "SD_writer.h"
+
+// Global variables
+static tLiveLogBlock log_blocks[LIVE_LOGGER_NUM_BLOCKS];
+static bool block_full[LIVE_LOGGER_NUM_BLOCKS];     // Waiting for the SD writer task
+static uint8_t active_block = 0;
+static uint16_t active_records = 0;
+static uint32_t block_sequence = 0;
+static uint16_t dropped_since_block = 0;
+static uint32_t logged_records = 0;
+static uint32_t dropped_records = 0;
+static bool recording = false;
+static bool capture_mode = LIVE_LOGGER_CAPTURE;      // For the next recording
+static bool capturing = false;                       // Mode of the current recording
+static bool block_capture[LIVE_LOGGER_NUM_BLOCKS];  // Format of every block
+
+
+// Close the active block (called inside a critical section). The header is completed
+// by the SD writer task (seal_liveLogBlock), out of the CAN tasks.
+static uint8_t close_activeBlock(void){
+
+    uint8_t full = active_block;
+    tLiveLogHeader *header = &log_blocks[full].log.header;
+
+    header->sequence = block_sequence++;
+    header->numRecords = active_records;
+    header->dropped = dropped_since_block;
+    block_capture[full] = capturing;
+    block_full[full] = true;
+
+    dropped_since_block = 0;
+    active_records = 0;
+    active_block = (active_block + 1) % LIVE_LOGGER_NUM_BLOCKS;
+
+    return full;
+}
+
+// The block could not be queued: its records are lost
+static void drop_block(uint8_t block){
+
+    taskENTER_CRITICAL();
+    dropped_records += log_blocks[block].log.header.numRecords;
+    dropped_since_block += log_blocks[block].log.header.numRecords;
+    block_full[block] = false;
+    taskEXIT_CRITICAL();
+}
+
+// The record has been copied on the active block (called inside a critical section).
+// Return true if the block is full and it has to be queued.
+static bool end_record(uint16_t records_per_block, uint8_t *block){
+
+    logged_records++;
+    if (active_records == records_per_block){
+
+        *block = close_activeBlock();
+        return true;
+    }
+
+    return false;
+}
+
+// Time of the SysTick counter (called inside a critical section or an interrupt): the tick count
+// and the cycles since the last tick. If the tick interrupt is pending the counter has restarted.
+void get_captureTime(uint32_t *time_ms, uint16_t *time_us){
+
+    uint32_t reload = HWREG(NVIC_ST_RELOAD);
+    uint32_t current = HWREG(NVIC_ST_CURRENT);
+    uint32_t ticks = xTaskGetTickCount();
+    uint32_t us;
+
+    if (HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_PENDSTSET){
+
+        current = HWREG(NVIC_ST_CURRENT);
+        ticks++;
+    }
+    us = (uint32_t)(((uint64_t)(reload - current)*portTICK_PERIOD_MS*1000) / (reload + 1));
+
+    *time_ms = ticks*portTICK_PERIOD_MS + us/1000;
+    *time_us = us % 1000;
+}
+
+// Start a new log file (a capture if the capture mode is set). Without SD card the
+// records are dropped.
+void start_liveLogger(void){
+
+    // The blocks of the previous recording that are still full go to its file
+    // (the jobs are written in order), so they are not taken here
+    taskENTER_CRITICAL();
+    active_records = 0;
+    block_sequence = 0;
+    dropped_since_block = 0;
+    capturing = capture_mode;
+    recording = true;
+    taskEXIT_CRITICAL();
+
+    post_SDlog(SD_JOB_LOG_START, capturing ? 1 : 0);
+}
+
+// Write the records of the block being filled and close the file
+void stop_liveLogger(void){
+
+    bool pending_block = false;
+    uint8_t block = 0;
+
+    taskENTER_CRITICAL();
+    if ((recording) && (active_records > 0) && (!block_full[active_block])){
+
+        block = close_activeBlock();
+        pending_block = true;
+    }
+    recording = false;
+    taskEXIT_CRITICAL();
+
+    if ((pending_block) && (!post_SDlog(SD_JOB_LOG_BLOCK, block))){
+
+        drop_block(block);
+    }
+    post_SDlog(SD_JOB_LOG_STOP, 0);
+}
+
+bool is_liveLoggerRecording(void){
+
+    return recording;
+}
+
+// Copy a response on the active block. It never blocks: if both blocks are waiting
+// for the SD card the record is dropped and counted.
+void log_PIDrecord(uint32_t ECU_ID, uint8_t PID, const uint8_t data[], uint8_t numBytes){
+
+    tLiveLogRecord *record;
+    bool full = false;
+    uint8_t block = 0;
+
+    taskENTER_CRITICAL();
+    if ((!recording) || (capturing)){
+
+        taskEXIT_CRITICAL();
+        return;
+    }
+    if (block_full[active_block]){
+
+        dropped_records++;
+        dropped_since_block++;
+        taskEXIT_CRITICAL();
+        return;
+    }
+
+    record = &log_blocks[active_block].log.records[active_records++];
+    record->time_ms = xTaskGetTickCount()*portTICK_PERIOD_MS;
+    record->ECU_ID = ECU_ID;
+    record->PID = PID;
+    record->numBytes = (numBytes > LIVE_LOG_DATA_BYTES) ? LIVE_LOG_DATA_BYTES : numBytes;
+    memcpy(record->data, data, LIVE_LOG_DATA_BYTES);
+    full = end_record(LIVE_LOG_RECORDS_PER_BLOCK, &block);
+    taskEXIT_CRITICAL();
+
+    if ((full) && (!post_SDlog(SD_JOB_LOG_BLOCK, block))){
+
+        drop_block(block);
+    }
+}
+
+// The mode is taken by the next start_liveLogger
+void set_liveLoggerCapture(bool capture){
+
+    capture_mode = capture;
+}
+
+bool is_liveLoggerCapture(void){
+
+    return capture_mode;
+}
+
+// Copy a frame sent or received by the device on the active block (only while a capture
+// is being recorded). Like log_PIDrecord it never blocks.
+void log_CANframe(uint32_t ID, const uint8_t data[], uint8_t length, uint8_t flags){
+
+    tCANCaptureRecord *frame;
+    bool full = false;
+    uint8_t block = 0;
+
+    taskENTER_CRITICAL();
+    if ((!recording) || (!capturing)){
+
+        taskEXIT_CRITICAL();
+        return;
+    }
+    if (block_full[active_block]){
+
+        dropped_records++;
+        dropped_since_block++;
+        taskEXIT_CRITICAL();
+        return;
+    }
+
+    frame = &log_blocks[active_block].capture.frames[active_records++];
+    get_captureTime(&frame->time_ms, &frame->time_us);
+    frame->flags = flags;
+    frame->length = (length > 8) ? 8 : length;
+    frame->ID = ID;
+    memset(frame->data, 0, sizeof(frame->data));
+    memcpy(frame->data, data, frame->length);
+    full = end_record(CAN_CAPTURE_RECORDS_PER_BLOCK, &block);
+    taskEXIT_CRITICAL();
+
+    if ((full) && (!post_SDlog(SD_JOB_LOG_BLOCK, block))){
+
+        drop_block(block);
+    }
+}
+
+// Copy a frame with its time (taken by the CAN sniffer) on the active block of a capture. Unlike
+// log_CANframe it waits up to timeout_ms for the SD writer task when both blocks are full,
+// so a capture saved from memory is not lost. False if there is no capture or it timed out.
+bool log_CANrecord(const tCANCaptureRecord *record, uint32_t timeout_ms){
+
+    TickType_t start = xTaskGetTickCount();
+    bool full = false;
+    uint8_t block = 0;
+
+    while (1){
+
+        taskENTER_CRITICAL();
+        if ((!recording) || (!capturing)){
+
+            taskEXIT_CRITICAL();
+            return false;
+        }
+        if (!block_full[active_block]){
+
+            break;
+        }
+        taskEXIT_CRITICAL();
+        if ((xTaskGetTickCount() - start)*portTICK_PERIOD_MS >= timeout_ms){
+
+            return false;
+        }
+        vTaskDelay(1);
+    }
+
+    log_blocks[active_block].capture.frames[active_records++] = *record;
+    full = end_record(CAN_CAPTURE_RECORDS_PER_BLOCK, &block);
+    taskEXIT_CRITICAL();
+
+    while ((full) && (!post_SDlog(SD_JOB_LOG_BLOCK, block))){
+
+        // The queue of the SD writer is full: the block waits, nothing else can be written
+        if ((xTaskGetTickCount() - start)*portTICK_PERIOD_MS >= timeout_ms){
+
+            drop_block(block);
+            return false;
+        }
+        vTaskDelay(1);
+    }
+
+    return true;
+}
+
+// Complete the header of a full block and return the sector to be written
+const uint8_t *seal_liveLogBlock(uint8_t block){
+
+    tLiveLogHeader *header = &log_blocks[block].log.header;
+    uint16_t numRecords = header->numRecords;
+    uint8_t record_size = block_capture[block] ? sizeof(tCANCaptureRecord) : sizeof(tLiveLogRecord);
+    uint8_t *records = (uint8_t *)log_blocks[block].log.records;
+
+    // The rest of the sector is cleared, so the old records are not on the card
+    memset(&records[numRecords*record_size], 0, sizeof(log_blocks[block]) - sizeof(tLiveLogHeader) - numRecords*record_size);
+    header->magic = block_capture[block] ? CAN_CAPTURE_MAGIC : LIVE_LOG_MAGIC;
+    header->version = block_capture[block] ? CAN_CAPTURE_VERSION : LIVE_LOG_VERSION;
+    header->record_size = record_size;
+    header->checksum = liveLog_CRC16(records, numRecords*record_size);
+
+    return (const uint8_t *)log_blocks[block].words;
+}
+
+// The block has been written (or dropped) and it can be filled again
+void release_liveLogBlock(uint8_t block){
+
+    taskENTER_CRITICAL();
+    block_full[block] = false;
+    taskEXIT_CRITICAL();
+}
+
+// CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF)
+uint16_t liveLog_CRC16(const uint8_t data[], uint16_t length){
+
+    uint16_t crc = 0xFFFF;
+
+    for (uint16_t i = 0; i < length; i++){
+
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++){
+
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+uint32_t get_liveLoggerRecords(void){
+
+    return logged_records;
+}
+
+uint32_t get_liveLoggerDrops(void){
+
+    return dropped_records;
+}
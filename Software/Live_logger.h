@@ -0,0 +1,106 @@
+/*
+ * Live_logger.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef LIVE_LOGGER_H_
+#define LIVE_LOGGER_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Log format (LIVEnnnn.BIN, little endian)
+// The file is a sequence of blocks of 512 bytes (one sector): a header and up to
+// LIVE_LOG_RECORDS_PER_BLOCK records. Every block can be checked on its own (magic, CRC of
+// the records), so after a power cut the blocks written before the last checkpoint are read.
+#define LIVE_LOG_BLOCK_SIZE 512
+#define LIVE_LOG_MAGIC 0x4C44424FUL     // "OBDL"
+#define LIVE_LOG_VERSION 1
+#define LIVE_LOG_DATA_BYTES 4
+#define LIVE_LOG_RECORDS_PER_BLOCK ((LIVE_LOG_BLOCK_SIZE - sizeof(tLiveLogHeader)) / sizeof(tLiveLogRecord))
+
+// Capture format (CAPTnnnn.BIN): the same blocks with another magic, and the records are
+// the frames sent and received by the device (request_ECUdata, request_ISOTPdata...)
+#define CAN_CAPTURE_MAGIC 0x4644424FUL  // "OBDF"
+#define CAN_CAPTURE_VERSION 1
+#define CAN_CAPTURE_RECORDS_PER_BLOCK ((LIVE_LOG_BLOCK_SIZE - sizeof(tLiveLogHeader)) / sizeof(tCANCaptureRecord))
+#define CAN_CAPTURE_TX 0x01             // Flags of a record
+#define CAN_CAPTURE_EXTENDED 0x02
+
+// Logger configuration
+// The CAN tasks fill one block while the SD writer task writes the other one.
+// The directory entry (size) is updated every LIVE_LOGGER_SYNC_BLOCKS blocks.
+// With the capture mode the live data view records the frames instead of the responses.
+#define LIVE_LOGGER_NUM_BLOCKS 2
+#define LIVE_LOGGER_SYNC_BLOCKS 16
+#define LIVE_LOGGER_CAPTURE false       // Mode after reset (set_liveLoggerCapture)
+
+typedef struct{
+
+    uint32_t magic;
+    uint32_t sequence;          // Block number since the start of the recording
+    uint16_t numRecords;
+    uint16_t dropped;           // Records lost just before this block
+    uint16_t checksum;          // CRC-16/CCITT of the records
+    uint8_t version;
+    uint8_t record_size;
+}tLiveLogHeader;
+
+typedef struct{
+
+    uint32_t time_ms;
+    uint16_t ECU_ID;
+    uint8_t PID;
+    uint8_t numBytes;
+    uint8_t data[LIVE_LOG_DATA_BYTES];
+}tLiveLogRecord;
+
+typedef struct{
+
+    uint32_t time_ms;
+    uint16_t time_us;           // Microseconds of the ms (0-999)
+    uint8_t flags;
+    uint8_t length;
+    uint32_t ID;
+    uint8_t data[8];
+}tCANCaptureRecord;
+
+typedef union{
+
+    uint32_t words[LIVE_LOG_BLOCK_SIZE/4];      // Aligned to 4 bytes
+    struct{
+
+        tLiveLogHeader header;
+        tLiveLogRecord records[(LIVE_LOG_BLOCK_SIZE - sizeof(tLiveLogHeader)) / sizeof(tLiveLogRecord)];
+    }log;
+    struct{
+
+        tLiveLogHeader header;
+        tCANCaptureRecord frames[(LIVE_LOG_BLOCK_SIZE - sizeof(tLiveLogHeader)) / sizeof(tCANCaptureRecord)];
+    }capture;
+}tLiveLogBlock;
+
+void start_liveLogger(void);
+void stop_liveLogger(void);
+bool is_liveLoggerRecording(void);
+void log_PIDrecord(uint32_t ECU_ID, uint8_t PID, const uint8_t data[], uint8_t numBytes);
+void set_liveLoggerCapture(bool capture);
+bool is_liveLoggerCapture(void);
+void log_CANframe(uint32_t ID, const uint8_t data[], uint8_t length, uint8_t flags);
+bool log_CANrecord(const tCANCaptureRecord *record, uint32_t timeout_ms);
+void get_captureTime(uint32_t *time_ms, uint16_t *time_us);
+const uint8_t *seal_liveLogBlock(uint8_t block);
+void release_liveLogBlock(uint8_t block);
+uint16_t liveLog_CRC16(const uint8_t data[], uint16_t length);
+uint32_t get_liveLoggerRecords(void);
+uint32_t get_liveLoggerDrops(void);
+
+#endif /* LIVE_LOGGER_H_ */
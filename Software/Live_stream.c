@@ -0,0 +1,596 @@
+/*
+ * Live_stream.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef LIVE_STREAM_HOST
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+// TIVA libraries
+#include "driverlib/sw_crc.h"
+
+// Programmer libraries
+#include "OBD_HAL.h"
+#include "OBD_protocol.h"
+#include "Live_logger.h"
+#include "Live_stream.h"
+#ifndef LIVE_STREAM_HOST
+#include "CAN_device.h"
+#include "PID_cache.h"
+#endif
+
+// The host build (Host/Live_stream) has no other task on the bus
+#ifdef LIVE_STREAM_HOST
+#define take_streamBus()
+#define give_streamBus()
+#else
+#define take_streamBus() take_CANbus(portMAX_DELAY)
+#define give_streamBus() give_CANbus()
+#endif
+
+// Data bytes of the response of every PID of pids_liveData
+static const uint8_t liveData_bytes[NUM_LIVE_DATA_PIDS] = {1, 1, 1, 1, 2, 1, 1, 1, 1, 2, 1, 2};
+
+typedef struct{
+
+    uint16_t period_ms;                     // 0: not subscribed
+    uint32_t next_ms;                       // Next request
+}tStreamChannel;
+
+typedef struct{
+
+    uint32_t time_ms;
+    uint32_t ID;                            // With the STREAM_CAN_xxx flags
+    uint8_t length;
+    uint8_t data[MAX_BYTES];
+}tStreamFrame;
+
+// Global variables
+static tStreamWrite stream_write;
+static tStreamStats stream_stats;
+static tStreamChannel channels[NUM_LIVE_DATA_PIDS];
+static uint32_t stream_requestID, stream_responseID;
+static uint8_t next_channel;                // First one looked at, so every channel gets its turn
+static uint32_t supported_mask;             // Channels the ECU has (bit per channel)
+static bool supported_read;
+static uint32_t next_status_ms;
+static bool active = false;
+static volatile bool send_frames = false;
+static bool send_info = false;
+// Frames of the task that has the bus (one at a time), sent by stream_service (the only reader)
+static tStreamFrame CAN_frames[STREAM_CAN_FRAMES];
+static volatile uint32_t CAN_head = 0, CAN_tail = 0;
+// Command being received
+static uint8_t command[STREAM_MAX_FRAME];
+static uint32_t command_bytes;
+static bool command_overflow;
+#ifndef LIVE_STREAM_HOST
+extern uint32_t ECU_ID_Response;
+#endif
+
+
+static void put_uint16(uint8_t buffer[], uint16_t value){
+
+    buffer[0] = (uint8_t)value;
+    buffer[1] = (uint8_t)(value >> 8);
+}
+
+static void put_uint32(uint8_t buffer[], uint32_t value){
+
+    buffer[0] = (uint8_t)value;
+    buffer[1] = (uint8_t)(value >> 8);
+    buffer[2] = (uint8_t)(value >> 16);
+    buffer[3] = (uint8_t)(value >> 24);
+}
+
+// The packets are shorter than 254 bytes, so every 0 ends a block
+static uint32_t encode_COBS(const uint8_t packet[], uint32_t length, uint8_t frame[]){
+
+    uint32_t code_position = 0, size = 1;
+    uint8_t code = 1;
+
+    for (uint32_t i = 0; i < length; i++){
+
+        if (packet[i] == 0){
+
+            frame[code_position] = code;
+            code_position = size++;
+            code = 1;
+        }else {
+
+            frame[size++] = packet[i];
+            code++;
+        }
+    }
+    frame[code_position] = code;
+    frame[size++] = 0;
+
+    return size;
+}
+
+// Frame without the final 0, return the length of the packet or -1 if it is wrong
+static int32_t decode_COBS(const uint8_t frame[], uint32_t length, uint8_t packet[]){
+
+    uint32_t i = 0, size = 0;
+    uint8_t code;
+
+    while (i < length){
+
+        code = frame[i++];
+        if ((code == 0) || (i + code - 1 > length)){
+
+            return -1;
+        }
+        for (uint8_t j = 1; j < code; j++){
+
+            packet[size++] = frame[i++];
+        }
+        if ((code < 0xFF) && (i < length)){
+
+            packet[size++] = 0;
+        }
+    }
+
+    return (int32_t)size;
+}
+
+static void send_packet(tStreamPacket type, const uint8_t payload[], uint32_t length){
+
+    static uint8_t packet[STREAM_MAX_PACKET];
+    static uint8_t frame[STREAM_MAX_FRAME];
+    uint32_t size;
+    uint16_t CRC;
+
+    packet[0] = type;
+    memcpy(packet + 1, payload, length);
+    CRC = Crc16(0, packet, 1 + length);
+    put_uint16(packet + 1 + length, CRC);
+    size = encode_COBS(packet, 1 + length + 2, frame);
+
+    if (stream_write(frame, size) == size){
+
+        stream_stats.packets++;
+    }else {
+
+        stream_stats.dropped++;
+    }
+}
+
+static void send_ack(uint8_t type, bool done){
+
+    uint8_t payload[2] = {type, done ? 0 : 1};
+
+    send_packet(STREAM_ACK, payload, sizeof(payload));
+}
+
+static void send_status(void){
+
+    const uint32_t *counters = (const uint32_t *)&stream_stats;
+    uint8_t payload[4 + sizeof(tStreamStats)];
+
+    put_uint32(payload, hal_timeMs());
+    for (uint32_t i = 0; i < sizeof(tStreamStats)/sizeof(uint32_t); i++){
+
+        put_uint32(payload + 4 + 4*i, counters[i]);
+    }
+    send_packet(STREAM_STATUS, payload, sizeof(payload));
+}
+
+// Version and channels, at the start and for STREAM_INFO
+static void send_hello(void){
+
+    uint8_t payload[6 + 16];
+    uint8_t length;
+
+    payload[0] = STREAM_VERSION;
+    payload[1] = NUM_LIVE_DATA_PIDS;
+    put_uint32(payload + 2, stream_responseID);
+    send_packet(STREAM_HELLO, payload, 6);
+
+    for (uint8_t i = 0; i < NUM_LIVE_DATA_PIDS; i++){
+
+        payload[0] = i;
+        payload[1] = pids_liveData[i];
+        put_uint16(payload + 2, (uint16_t)liveData_ranges[i][0]);
+        put_uint16(payload + 4, (uint16_t)liveData_ranges[i][1]);
+        length = 6;
+        for (const char *name = liveData_shortStrings[i]; (*name != '\0') && (length < sizeof(payload)); name++){
+
+            payload[length++] = (uint8_t)*name;
+        }
+        send_packet(STREAM_CHANNEL, payload, length);
+    }
+}
+
+static void subscribe(uint8_t channel, uint16_t period_ms){
+
+    if ((period_ms != 0) && (period_ms < STREAM_MIN_PERIOD_MS)){
+
+        period_ms = STREAM_MIN_PERIOD_MS;
+    }
+    channels[channel].period_ms = period_ms;
+    channels[channel].next_ms = hal_timeMs();
+}
+
+static void run_command(const uint8_t packet[], uint32_t length){
+
+    bool done = true;
+
+    switch (packet[0]){
+
+    case STREAM_SUBSCRIBE:
+        if ((length != 4) || ((packet[1] >= NUM_LIVE_DATA_PIDS) && (packet[1] != STREAM_ALL_CHANNELS))){
+
+            done = false;
+            break;
+        }
+        for (uint8_t i = 0; i < NUM_LIVE_DATA_PIDS; i++){
+
+            if ((packet[1] == i) || (packet[1] == STREAM_ALL_CHANNELS)){
+
+                subscribe(i, (uint16_t)(packet[2] | (packet[3] << 8)));
+            }
+        }
+        break;
+    case STREAM_RAW:
+        if (length != 2){
+
+            done = false;
+            break;
+        }
+        // The frames before it are not sent
+        CAN_tail = CAN_head;
+        send_frames = (packet[1] != 0);
+        break;
+    case STREAM_INFO:
+        // Sent by stream_service, after the ACK
+        send_info = (length == 1);
+        done = send_info;
+        break;
+    case STREAM_STOP:
+        active = false;
+        send_frames = false;
+        break;
+    default:
+        done = false;
+        break;
+    }
+    if (!done){
+
+        stream_stats.bad_commands++;
+    }
+    send_ack(packet[0], done);
+}
+
+static void end_command(void){
+
+    uint8_t packet[STREAM_MAX_FRAME];
+    int32_t length = command_overflow ? -1 : decode_COBS(command, command_bytes, packet);
+
+    command_bytes = 0;
+    command_overflow = false;
+    // Type and CRC at least
+    if ((length < 3) || (Crc16(0, packet, length - 2) != (packet[length-2] | (packet[length-1] << 8)))){
+
+        // A 0 alone only ends what was before it
+        if (length != 0){
+
+            stream_stats.bad_commands++;
+        }
+        return;
+    }
+    run_command(packet, length - 2);
+}
+
+// Responses of mode 01: the PID and its bytes, for every PID of the request that the ECU has
+static uint8_t decode_samples(const uint8_t response[], int16_t length, uint8_t samples[]){
+
+    uint8_t numSamples = 0;
+    uint8_t posPID;
+    float value;
+    uint32_t bits;
+    int16_t i = 1;
+
+    while (i < length){
+
+        for (posPID = 0; (posPID < NUM_LIVE_DATA_PIDS) && (pids_liveData[posPID] != response[i]); posPID++);
+        if ((posPID == NUM_LIVE_DATA_PIDS) || (i + 1 + liveData_bytes[posPID] > length)){
+
+            break;
+        }
+        value = (float)decode_CANdata(posPID, response[i+1], (liveData_bytes[posPID] > 1) ? response[i+2] : 0);
+        memcpy(&bits, &value, sizeof(bits));
+        samples[5*numSamples] = posPID;
+        put_uint32(samples + 5*numSamples + 1, bits);
+        numSamples++;
+        i += 1 + liveData_bytes[posPID];
+    }
+
+    return numSamples;
+}
+
+// PIDs 01-20 the ECU has (01 00). The response of a request with several PIDs starts with the first
+// one the ECU has, and the transport takes it as a wrong answer if it is not the first one asked,
+// so only these are requested. Without an answer every channel is tried.
+static void read_supported(void){
+
+    uint8_t request[2] = {0x01, 0x00};
+    uint8_t response[6];
+    int16_t length;
+
+    supported_read = true;
+    supported_mask = (1UL << NUM_LIVE_DATA_PIDS) - 1;
+    stream_stats.requests++;
+    take_streamBus();
+    length = request_ISOTPmessage(stream_requestID, stream_responseID, request, sizeof(request), response, sizeof(response));
+    give_streamBus();
+    if ((length < 6) || (response[0] != 0x41) || (response[1] != 0x00)){
+
+        stream_stats.timeouts++;
+        return;
+    }
+    supported_mask = 0;
+    for (uint8_t i = 0; i < NUM_LIVE_DATA_PIDS; i++){
+
+        uint8_t PID = pids_liveData[i];
+
+        if (response[2 + (PID - 1)/8] & (0x80 >> ((PID - 1) % 8))){
+
+            supported_mask |= 1UL << i;
+        }
+    }
+}
+
+// True if the channel is due, then its next time is set
+static bool due_channel(uint8_t channel, uint32_t now){
+
+    if ((channels[channel].period_ms == 0) || ((int32_t)(channels[channel].next_ms - now) > 0)){
+
+        return false;
+    }
+    // Late channels start again from now instead of catching up
+    channels[channel].next_ms += channels[channel].period_ms;
+    if ((int32_t)(channels[channel].next_ms - now) <= 0){
+
+        channels[channel].next_ms = now + channels[channel].period_ms;
+    }
+
+    return true;
+}
+
+#ifndef LIVE_STREAM_HOST
+// The due channels of the ECU of the menu come from PID_cache.h, with their period as the
+// maximum age: a PID that the live data view or the logger has just read is not asked again.
+// get_PIDvalue takes the bus for the older ones.
+static void read_cachedChannels(uint32_t now){
+
+    uint8_t payload[4 + 5*NUM_LIVE_DATA_PIDS];
+    uint8_t numSamples = 0;
+    tPIDCacheEntry entry;
+    float value;
+    uint32_t bits;
+
+    for (uint8_t channel = 0; channel < NUM_LIVE_DATA_PIDS; channel++){
+
+        if ((!due_channel(channel, now)) || (!(supported_mask & (1UL << channel)))){
+
+            continue;
+        }
+        stream_stats.requests++;
+        if (!get_PIDvalue(channel, channels[channel].period_ms/portTICK_PERIOD_MS, &entry)){
+
+            stream_stats.timeouts++;
+            continue;
+        }
+        value = (float)entry.value;
+        memcpy(&bits, &value, sizeof(bits));
+        payload[4 + 5*numSamples] = channel;
+        put_uint32(payload + 4 + 5*numSamples + 1, bits);
+        numSamples++;
+    }
+    if (numSamples != 0){
+
+        put_uint32(payload, hal_timeMs());
+        send_packet(STREAM_SAMPLES, payload, 4 + 5*numSamples);
+        stream_stats.samples += numSamples;
+    }
+}
+#endif
+
+// One request with the due channels
+static void request_channels(uint32_t now){
+
+    uint8_t request[1 + STREAM_PIDS_PER_REQUEST];
+    uint8_t response[1 + 3*STREAM_PIDS_PER_REQUEST];     // 0x41, PIDs and up to 2 bytes each
+    uint8_t payload[4 + 5*STREAM_PIDS_PER_REQUEST];
+    uint8_t numPIDs = 0, numSamples, channel = next_channel;
+    int16_t length;
+
+#ifndef LIVE_STREAM_HOST
+    // The cache only has the values of the ECU of the menu
+    if (stream_responseID == ECU_ID_Response){
+
+        read_cachedChannels(now);
+        return;
+    }
+#endif
+
+    request[0] = 0x01;
+    for (uint8_t i = 0; (i < NUM_LIVE_DATA_PIDS) && (numPIDs < STREAM_PIDS_PER_REQUEST); i++){
+
+        channel = (next_channel + i) % NUM_LIVE_DATA_PIDS;
+        if (due_channel(channel, now) && (supported_mask & (1UL << channel))){
+
+            request[1 + numPIDs++] = pids_liveData[channel];
+        }
+    }
+    if (numPIDs == 0){
+
+        return;
+    }
+    next_channel = (channel + 1) % NUM_LIVE_DATA_PIDS;
+
+    stream_stats.requests++;
+    take_streamBus();
+    length = request_ISOTPmessage(stream_requestID, stream_responseID, request, 1 + numPIDs, response, sizeof(response));
+    give_streamBus();
+    if ((length < 3) || (response[0] != 0x41)){
+
+        stream_stats.timeouts++;
+        return;
+    }
+    numSamples = decode_samples(response, (length > (int16_t)sizeof(response)) ? (int16_t)sizeof(response) : length, payload + 4);
+    if (numSamples != 0){
+
+        put_uint32(payload, hal_timeMs());
+        send_packet(STREAM_SAMPLES, payload, 4 + 5*numSamples);
+        stream_stats.samples += numSamples;
+    }
+}
+
+// The CAN frames of the queue, as many in a packet as fit
+static void send_CANframes(void){
+
+    uint8_t payload[STREAM_MAX_PAYLOAD];
+    uint32_t length = 0;
+
+    while (CAN_tail != CAN_head){
+
+        const tStreamFrame *frame = &CAN_frames[CAN_tail % STREAM_CAN_FRAMES];
+
+        if (length + 9 + frame->length > sizeof(payload)){
+
+            send_packet(STREAM_CAN, payload, length);
+            length = 0;
+        }
+        put_uint32(payload + length, frame->time_ms);
+        put_uint32(payload + length + 4, frame->ID);
+        payload[length + 8] = frame->length;
+        memcpy(payload + length + 9, frame->data, frame->length);
+        length += 9 + frame->length;
+        CAN_tail++;
+        stream_stats.CAN_frames++;
+    }
+    if (length != 0){
+
+        send_packet(STREAM_CAN, payload, length);
+    }
+}
+
+void init_stream(tStreamWrite write, uint32_t request_ID, uint32_t response_ID){
+
+    stream_write = write;
+    stream_requestID = request_ID;
+    stream_responseID = response_ID;
+    memset(&stream_stats, 0, sizeof(stream_stats));
+    memset(channels, 0, sizeof(channels));
+    next_channel = 0;
+    supported_read = false;
+    command_bytes = 0;
+    command_overflow = false;
+    send_frames = false;
+    send_info = false;
+    CAN_tail = CAN_head;
+    active = true;
+    next_status_ms = hal_timeMs() + STREAM_STATUS_MS;
+
+    // The text of the console before the first frame is discarded by the PC with this 0
+    stream_write((const uint8_t *)"", 1);
+    send_hello();
+}
+
+void stream_input(uint8_t byte){
+
+    if (byte == 0){
+
+        end_command();
+    }else if (command_bytes < sizeof(command)){
+
+        command[command_bytes++] = byte;
+    }else {
+
+        command_overflow = true;
+    }
+}
+
+uint32_t stream_service(void){
+
+    uint32_t now = hal_timeMs();
+    int32_t wait = STREAM_IDLE_MS;
+
+    if (send_info){
+
+        send_info = false;
+        send_hello();
+        send_status();
+    }
+    if (!supported_read){
+
+        read_supported();
+        now = hal_timeMs();
+    }
+    request_channels(now);
+    send_CANframes();
+
+    now = hal_timeMs();
+    if ((int32_t)(next_status_ms - now) <= 0){
+
+        next_status_ms = now + STREAM_STATUS_MS;
+        send_status();
+    }
+    for (uint8_t i = 0; i < NUM_LIVE_DATA_PIDS; i++){
+
+        if ((channels[i].period_ms != 0) && ((int32_t)(channels[i].next_ms - now) < wait)){
+
+            wait = (int32_t)(channels[i].next_ms - now);
+        }
+    }
+
+    return (wait > 0) ? (uint32_t)wait : 0;
+}
+
+bool stream_active(void){
+
+    return active;
+}
+
+void stream_CANframe(uint32_t ID, const uint8_t data[], uint8_t length, uint8_t flags){
+
+    tStreamFrame *frame;
+
+    if (!send_frames){
+
+        return;
+    }
+    if (CAN_head - CAN_tail >= STREAM_CAN_FRAMES){
+
+        stream_stats.CAN_lost++;
+        return;
+    }
+    frame = &CAN_frames[CAN_head % STREAM_CAN_FRAMES];
+    frame->time_ms = hal_timeMs();
+    frame->ID = ID | ((flags & CAN_CAPTURE_EXTENDED) ? STREAM_CAN_EXTENDED : 0) | ((flags & CAN_CAPTURE_TX) ? STREAM_CAN_TX : 0);
+    frame->length = (length > MAX_BYTES) ? MAX_BYTES : length;
+    memcpy(frame->data, data, frame->length);
+    CAN_head++;
+}
+
+void get_streamStats(tStreamStats *stats){
+
+    *stats = stream_stats;
+}
@@ -0,0 +1,108 @@
+/*
+ * Live_stream.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Binary stream of the live data for a PC ('stream' on the shell, Diag_shell.h). The PC
+ *      subscribes to the channels (the PIDs of pids_liveData) with a period, and the stream sends
+ *      their decoded values with the time, and the CAN frames of the device if asked. The due
+ *      channels go in one request of up to STREAM_PIDS_PER_REQUEST PIDs, so a response of the
+ *      ECU gives several samples, and the PIDs the ECU does not have (01 00) are not asked. A
+ *      sample takes 5 bytes instead of the 18 of an ELM327 request and its line.
+ *      On the device the channels of the ECU of the menu are read through PID_cache.h, with their
+ *      period as the maximum age, so the stream does not add requests for the PIDs that the live
+ *      data view already reads. Built with LIVE_STREAM_HOST it only uses OBD_HAL.h and the OBD
+ *      protocol, like ELM327_interface.c, and it runs on a PC (Host/Live_stream, with the decoder
+ *      of the stream).
+ *
+ *      Frames: COBS encoded packets, each one ended by a 0. Packet: type, payload and the CRC-16
+ *      of type and payload (Crc16 of driverlib/sw_crc.c, initial value 0). Little endian.
+ *      From the device:
+ *          STREAM_HELLO        version, number of channels, response ID (uint32)
+ *          STREAM_CHANNEL      channel, PID, min and max of the chart (int16), short name
+ *          STREAM_SAMPLES      time ms (uint32), then channel and value (float) of every sample
+ *          STREAM_CAN          frames: time ms (uint32), ID (uint32, STREAM_CAN_xxx flags), length, data
+ *          STREAM_STATUS       time ms and the counters of tStreamStats (uint32)
+ *          STREAM_ACK          command and result (0 done, 1 invalid)
+ *      From the PC:
+ *          STREAM_SUBSCRIBE    channel (STREAM_ALL_CHANNELS for all), period ms (uint16, 0 stops it)
+ *          STREAM_RAW          1 to send the CAN frames, 0 to stop them
+ *          STREAM_INFO         HELLO, CHANNELs and STATUS again
+ *          STREAM_STOP         end of the stream, the console goes back to the shell
+ */
+
+#ifndef LIVE_STREAM_H_
+#define LIVE_STREAM_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define STREAM_VERSION 1
+#define STREAM_MAX_PAYLOAD 120
+#define STREAM_MAX_PACKET (1 + STREAM_MAX_PAYLOAD + 2)     // Type, payload and CRC
+#define STREAM_MAX_FRAME (STREAM_MAX_PACKET + 2)            // COBS code of the only block and the 0
+#define STREAM_PIDS_PER_REQUEST 6                           // Of a request of mode 01
+#define STREAM_ALL_CHANNELS 0xFF
+#define STREAM_MIN_PERIOD_MS 10
+#define STREAM_IDLE_MS 20                                   // Longest wait, for the commands
+#define STREAM_STATUS_MS 1000
+#define STREAM_CAN_FRAMES 16                                // Queue of the CAN frames. A power of 2.
+#define STREAM_CAN_EXTENDED 0x80000000UL                    // Flags on the ID of a CAN frame
+#define STREAM_CAN_TX 0x40000000UL
+
+typedef enum{
+
+    STREAM_HELLO = 1,
+    STREAM_CHANNEL,
+    STREAM_SAMPLES,
+    STREAM_CAN,
+    STREAM_STATUS,
+    STREAM_ACK
+}tStreamPacket;
+
+typedef enum{
+
+    STREAM_SUBSCRIBE = 0x81,
+    STREAM_RAW,
+    STREAM_INFO,
+    STREAM_STOP
+}tStreamCommand;
+
+// Since init_stream. Sent by STREAM_STATUS in this order.
+typedef struct{
+
+    uint32_t packets;               // Sent
+    uint32_t dropped;               // No room on the output
+    uint32_t samples;
+    uint32_t CAN_frames;
+    uint32_t CAN_lost;              // The queue of the CAN frames was full
+    uint32_t requests;
+    uint32_t timeouts;              // No response or a negative one
+    uint32_t bad_commands;          // Wrong COBS, CRC or arguments
+}tStreamStats;
+
+// Output of the frames: the length written, 0 if the frame does not fit now (it is dropped)
+typedef uint32_t (*tStreamWrite)(const uint8_t data[], uint32_t length);
+
+// Sends HELLO and the channels. The requests go to request_ID (the functional one or an ECU).
+void init_stream(tStreamWrite write, uint32_t request_ID, uint32_t response_ID);
+// A byte from the PC
+void stream_input(uint8_t byte);
+// Requests the due channels and sends the samples, the CAN frames and the status. The CAN bus is
+// taken here for every request (PID_cache.h for the ECU of the menu), not by the caller. Return the
+// ms until the next due channel (up to STREAM_IDLE_MS).
+uint32_t stream_service(void);
+// False after STREAM_STOP
+bool stream_active(void);
+// A frame sent or received by the device (flags of Live_logger.h), from the task that has the bus
+void stream_CANframe(uint32_t ID, const uint8_t data[], uint8_t length, uint8_t flags);
+void get_streamStats(tStreamStats *stats);
+
+#endif /* LIVE_STREAM_H_ */
@@ -0,0 +1,67 @@
+/*
+ * OBD_HAL.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Timer, display and storage of OBD_HAL.h on the Tiva. The CAN functions are in
+ *      CAN_device.c, next to the message objects they use.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Programmer libraries
+#include "OBD_HAL.h"
+#include "CAN_device.h"
+#include "Graphic_interface.h"
+#include "ST7735.h"
+#include "Live_logger.h"
+
+
+uint32_t hal_timeMs(void){
+
+    return xTaskGetTickCount()*portTICK_PERIOD_MS;
+}
+
+void hal_displayClear(void){
+
+    cleanScreen();
+}
+
+void hal_displayString(int16_t x, int16_t y, const char *text, uint8_t style){
+
+    uint16_t colour;
+
+    switch (style){
+
+    case HAL_TEXT_TITLE:
+        colour = ST7735_WHITE;
+        break;
+
+    case HAL_TEXT_DESCRIPTION:
+        colour = MENU_ITEM_UNSELECTED_TEXT_COLOUR;
+        break;
+
+    default:
+        colour = MENU_DATA_TEXT_COLOUR;
+        break;
+    }
+    // A long text goes on under its first character
+    drawString(x, y, text, colour, ST7735_BLACK, 1, x);
+}
+
+void hal_storeRecord(uint32_t ECU_ID, uint8_t PID, const uint8_t data[], uint8_t numBytes){
+
+    log_PIDrecord(ECU_ID, PID, data, numBytes);
+}
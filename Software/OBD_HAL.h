@@ -0,0 +1,47 @@
+/*
+ * OBD_HAL.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Interfaces the OBD protocol (OBD_protocol.c) needs from the device: CAN, timer, display
+ *      and storage. On the Tiva the CAN functions are in CAN_device.c (message objects and
+ *      interrupt events) and the rest in OBD_HAL.c. Host/OBD_host has in-memory ones, so the
+ *      protocol builds and runs on a PC.
+ */
+
+#ifndef OBD_HAL_H_
+#define OBD_HAL_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Text styles of the display
+#define HAL_TEXT_DATA 0             // Values and messages (MENU_DATA_TEXT_COLOUR)
+#define HAL_TEXT_TITLE 1            // Titles (white)
+#define HAL_TEXT_DESCRIPTION 2      // Second line of an item (MENU_ITEM_UNSELECTED_TEXT_COLOUR)
+
+// CAN: the frames of the ECU that answers pass the filter (response_ID and mask) until it is changed
+void hal_CANsetReception(uint32_t response_ID, uint32_t mask);
+// Send a frame and wait until it is transmitted. Return false on timeout.
+bool hal_CANsend(uint32_t ID, const uint8_t data[], uint8_t length);
+// Wait up to timeout_ms for the next frame that passes the filter (8 bytes on data). Return false on timeout.
+bool hal_CANreceive(uint32_t *ID, uint8_t data[], uint32_t timeout_ms);
+
+// Timer: ms since the power up
+uint32_t hal_timeMs(void);
+
+// Display: x and y in pixels of the 160x128 screen, 6x10 pixels per character
+void hal_displayClear(void);
+void hal_displayString(int16_t x, int16_t y, const char *text, uint8_t style);
+
+// Storage: record of a live data response (data bytes A, B... of PID)
+void hal_storeRecord(uint32_t ECU_ID, uint8_t PID, const uint8_t data[], uint8_t numBytes);
+
+#endif /* OBD_HAL_H_ */
@@ -0,0 +1,429 @@
+/*
+ * OBD_protocol.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Programmer libraries
+#include "OBD_HAL.h"
+#include "OBD_protocol.h"
+#include "Cycle_probes.h"
+
+// Global variables
+static tOBDStats OBD_stats;
+
+
+// End of a transaction started at start_ms
+static void count_response(uint32_t start_ms){
+
+    uint32_t latency = hal_timeMs() - start_ms;
+
+    OBD_stats.responses++;
+    OBD_stats.latency_sum_ms += latency;
+    if (latency > OBD_stats.latency_max_ms){
+
+        OBD_stats.latency_max_ms = latency;
+    }
+}
+
+// Wait for the answer of a request of mode (and PID if it is not negative) on frame, a
+// positive or a negative response in a single or first frame. Other frames of response_ID
+// are skipped: with functional requests an ECU can still be answering an earlier request,
+// and taking that answer would shift all the following ones. Return false on timeout.
+static bool receive_answer(uint32_t *ECU_ID, uint8_t frame[], uint8_t mode, int16_t PID){
+
+    uint32_t start_ms = hal_timeMs();
+    uint32_t elapsed_ms = 0;
+    uint8_t service;
+
+    while ((elapsed_ms < MAX_TIME_TO_WAIT_MS) && (hal_CANreceive(ECU_ID, frame, MAX_TIME_TO_WAIT_MS - elapsed_ms))){
+
+        if ((frame[0] >> 4) <= 1){
+
+            // Single frame: length + service, first frame: 12 bits length + service
+            service = ((frame[0] >> 4) == 0) ? 1 : 2;
+            if ((frame[service] == 0x7F) && (frame[service+1] == mode)){
+
+                return true;
+            }
+            if ((frame[service] == (mode + 0x40)) && ((PID < 0) || (frame[service+1] == PID))){
+
+                return true;
+            }
+        }
+        elapsed_ms = hal_timeMs() - start_ms;
+    }
+
+    return false;
+}
+
+// Send a single frame request (mode and PID) to request_ID and copy the response of
+// response_ID on response_data_frame, ECU_ID is the ID of the ECU that answered.
+// The CAN bus has to be taken by the caller. Return false without answer.
+bool request_ECUdata(uint32_t request_ID, uint32_t response_ID, uint8_t mode, uint8_t PID, uint8_t response_data_frame[], uint32_t *ECU_ID){
+
+    uint8_t request_data_frame[MAX_BYTES];
+    uint32_t start_ms = hal_timeMs();
+
+    request_data_frame[0] = 0x02;
+    request_data_frame[1] = mode;
+    request_data_frame[2] = PID;
+    for (int i = 3; i < MAX_BYTES; i++){
+
+        request_data_frame[i] = 0xA5;
+    }
+
+    // Other tasks could have changed the reception filter
+    hal_CANsetReception(response_ID, MASK_RESPONSE_ID);
+
+    OBD_stats.requests++;
+    if ((!hal_CANsend(request_ID, request_data_frame, 3)) || (!receive_answer(ECU_ID, response_data_frame, mode, PID))){
+
+        OBD_stats.timeouts++;
+        return false;
+    }
+
+    // Positive response: mode + 0x40 and the same PID
+    if ((response_data_frame[1] != (mode + 0x40)) || (response_data_frame[2] != PID)){
+
+        OBD_stats.errors++;
+        return false;
+    }
+    count_response(start_ms);
+
+    return true;
+}
+
+// Send a request of a mode without PID (03, 07...) to request_ID and reassemble the
+// response (single frame or first frame + consecutive frames) on payload, starting
+// from the mode byte. Return the number of bytes copied or -1 on error.
+// The CAN bus has to be taken by the caller.
+int16_t request_ISOTPdata(uint32_t request_ID, uint32_t response_ID, uint8_t mode, uint8_t payload[], uint16_t max_bytes){
+
+    return request_ISOTPmessage(request_ID, response_ID, &mode, 1, payload, max_bytes);
+}
+
+// Same as request_ISOTPdata with a request of numBytes (mode and PIDs, up to 7 bytes)
+int16_t request_ISOTPmessage(uint32_t request_ID, uint32_t response_ID, const uint8_t request[], uint8_t numBytes, uint8_t payload[], uint16_t max_bytes){
+
+    uint8_t request_data_frame[MAX_BYTES];
+    uint8_t response_data_frame[MAX_BYTES];
+    uint16_t length, received = 0;
+    uint8_t sequence = 1;
+    uint32_t ECU_ID;
+    uint32_t start_ms = hal_timeMs();
+    uint32_t probe;
+
+    if ((numBytes == 0) || (numBytes > (MAX_BYTES-1))){
+
+        return -1;
+    }
+    request_data_frame[0] = numBytes;
+    for (int i = 1; i < MAX_BYTES; i++){
+
+        request_data_frame[i] = (i <= numBytes) ? request[i-1] : 0x55;
+    }
+
+    hal_CANsetReception(response_ID, MASK_RESPONSE_ID);
+
+    OBD_stats.requests++;
+    if ((!hal_CANsend(request_ID, request_data_frame, 8)) ||
+        (!receive_answer(&ECU_ID, response_data_frame, request[0], (numBytes > 1) ? request[1] : -1))){
+
+        OBD_stats.timeouts++;
+        return -1;
+    }
+
+    switch (response_data_frame[0] >> 4){
+
+    case 0:
+        // Single frame: length + 7 bytes
+        length = response_data_frame[0] & 0x0F;
+        if (length > (MAX_BYTES-1)){
+
+            OBD_stats.errors++;
+            return -1;
+        }
+        for (int i = 1; (received < length) && (received < max_bytes); i++, received++){
+
+            payload[received] = response_data_frame[i];
+        }
+        count_response(start_ms);
+        return received;
+
+    case 1:
+        // First frame: 12 bits length + 6 bytes
+        probe = PROBE_START();
+        length = ((uint16_t)(response_data_frame[0] & 0x0F) << 8) | response_data_frame[1];
+        for (int i = 2; i < MAX_BYTES; i++, received++){
+
+            if (received < max_bytes){
+
+                payload[received] = response_data_frame[i];
+            }
+        }
+        probe_end(PROBE_ISOTP_FRAME, probe);
+
+        // Flow control: continue to send, without block size limit
+        request_data_frame[0] = 0x30;
+        request_data_frame[1] = 0x00;
+        request_data_frame[2] = ISOTP_SEPARATION_TIME_MS;
+        for (int i = 3; i < MAX_BYTES; i++){
+
+            request_data_frame[i] = 0x00;
+        }
+        if (!hal_CANsend(request_ID, request_data_frame, 8)){
+
+            OBD_stats.timeouts++;
+            return -1;
+        }
+
+        // Consecutive frames: sequence number + 7 bytes
+        while (received < length){
+
+            if (!hal_CANreceive(&ECU_ID, response_data_frame, MAX_TIME_TO_WAIT_MS)){
+
+                OBD_stats.timeouts++;
+                return -1;
+            }
+            probe = PROBE_START();
+            if (response_data_frame[0] != (0x20 | (sequence & 0x0F))){
+
+                OBD_stats.errors++;
+                return -1;
+            }
+            sequence++;
+
+            for (int i = 1; (i < MAX_BYTES) && (received < length); i++, received++){
+
+                if (received < max_bytes){
+
+                    payload[received] = response_data_frame[i];
+                }
+            }
+            probe_end(PROBE_ISOTP_FRAME, probe);
+        }
+        count_response(start_ms);
+        return (length < max_bytes) ? length : max_bytes;
+
+    default:
+        OBD_stats.errors++;
+        return -1;
+    }
+}
+
+// Request a live data PID (position on pids_liveData) and decode it. Every response is
+// stored (hal_storeRecord). The CAN bus has to be taken by the caller.
+bool read_PIDvalue(uint32_t request_ID, uint32_t response_ID, uint8_t posPID, tOBDValue *value){
+
+    uint8_t response_data_frame[MAX_BYTES];
+
+    if ((posPID >= NUM_LIVE_DATA_PIDS) ||
+        (!request_ECUdata(request_ID, response_ID, 0x01, pids_liveData[posPID], response_data_frame, &value->ECU_ID))){
+
+        return false;
+    }
+
+    // Response: length, 0x41, PID, A, B, C, D. Subtract the mode byte and the PID byte.
+    uint32_t probe = PROBE_START();
+    value->numBytes = (response_data_frame[0] > 2) ? (response_data_frame[0] - 2) : 0;
+    if (value->numBytes > OBD_VALUE_DATA_BYTES){
+
+        value->numBytes = OBD_VALUE_DATA_BYTES;
+    }
+    memcpy(value->data, response_data_frame+3, OBD_VALUE_DATA_BYTES);
+    value->value = decode_CANdata(posPID, (double)response_data_frame[3], (double)response_data_frame[4]);
+    probe_end(PROBE_FRAME_DECODE, probe);
+    hal_storeRecord(value->ECU_ID, response_data_frame[2], value->data, value->numBytes);
+
+    return true;
+}
+
+// Read the DTCs of a mode (03, 07 or 0A) on codes. Return the number of DTCs (up to
+// max_DTCs) or -1 on error. The CAN bus has to be taken by the caller.
+int16_t read_DTCs(uint32_t request_ID, uint32_t response_ID, uint8_t mode, char codes[][NUM_CHAR_DTC+1], uint8_t max_DTCs){
+
+    uint8_t payload[2+2*OBD_MAX_DTCS];
+    int16_t numBytes, numDTCs = 0;
+
+    numBytes = request_ISOTPdata(request_ID, response_ID, mode, payload, sizeof(payload));
+    if ((numBytes < 2) || (payload[0] != (mode + 0x40))){
+
+        if (numBytes >= 0){
+
+            OBD_stats.errors++;
+        }
+        return -1;
+    }
+
+    // payload: mode + 0x40, number of DTCs and 2 bytes per DTC
+    for (int i = 0; (i < payload[1]) && (numDTCs < max_DTCs) && ((3+2*i) < numBytes); i++){
+
+        decode_DTCbytes(payload[2+2*i], payload[3+2*i], codes[numDTCs]);
+        numDTCs++;
+    }
+
+    return numDTCs;
+}
+
+// Read the VIN (mode 09 PID 02) on VIN (MAX_VIN_BYTES). The CAN bus has to be taken by the caller.
+bool read_VIN(uint32_t request_ID, uint32_t response_ID, char VIN[]){
+
+    static const uint8_t request[] = {0x09, 0x02};
+    uint8_t payload[3+VIN_CHARS];
+    int16_t numBytes;
+    uint8_t numChars = 0;
+
+    numBytes = request_ISOTPmessage(request_ID, response_ID, request, sizeof(request), payload, sizeof(payload));
+    // Response: 0x49, 0x02, number of items and the characters
+    if ((numBytes <= 3) || (payload[0] != 0x49) || (payload[1] != 0x02)){
+
+        if (numBytes >= 0){
+
+            OBD_stats.errors++;
+        }
+        return false;
+    }
+    for (int i = 3; i < numBytes; i++){
+
+        // Some ECUs fill the VIN with zeros at the start
+        if ((payload[i] >= ' ') && (payload[i] <= '~')){
+
+            VIN[numChars++] = (char)payload[i];
+        }
+    }
+    VIN[numChars] = '\0';
+
+    return (numChars > 0);
+}
+
+double decode_CANdata(uint8_t posPID, double dataA, double dataB){
+
+    double data_decoded;
+
+    switch(posPID){
+    case 0:
+        data_decoded = (double)dataA*100/255;
+        break;
+
+    case 1:
+        data_decoded = dataA-40;
+        break;
+
+    case 2:
+        data_decoded = (dataA-128)*100/128;
+        break;
+
+    case 3:
+        data_decoded = (dataA-128)*100/128;
+        break;
+
+    case 4:
+        data_decoded = ((dataA*256)+dataB)/4;
+        break;
+
+    case 5:
+        data_decoded = dataA;
+        break;
+
+    case 6:
+        data_decoded = dataA;
+        break;
+
+    case 7:
+        data_decoded = (dataA/2)-64;
+        break;
+
+    case 8:
+        data_decoded = dataA-40;
+        break;
+
+    case 9:
+        data_decoded = ((dataA*256)+dataB)/100;
+        break;
+
+    case 10:
+        data_decoded = (double)dataA*100/255;
+        break;
+
+    case 11:
+        data_decoded = (dataA*256)+dataB;
+        break;
+
+    default:
+        data_decoded = 0;
+        break;
+    }
+
+    return data_decoded;
+}
+
+// Decode the 2 bytes of a DTC without going through the hex and binary strings.
+// First 2 bits: P, C, B or U. Next 2 bits: first digit. Rest: 3 hex digits.
+void decode_DTCbytes(uint8_t DTC_high, uint8_t DTC_low, char DTC_decoded[]){
+
+    static const char DTC_system[] = {'P', 'C', 'B', 'U'};
+    static const char hex_digits[] = "0123456789ABCDEF";
+
+    DTC_decoded[0] = DTC_system[DTC_high >> 6];
+    DTC_decoded[1] = '0' + ((DTC_high >> 4) & 0x03);
+    DTC_decoded[2] = hex_digits[DTC_high & 0x0F];
+    DTC_decoded[3] = hex_digits[DTC_low >> 4];
+    DTC_decoded[4] = hex_digits[DTC_low & 0x0F];
+    DTC_decoded[5] = '\0';
+}
+
+// Text of a value on the 5 characters of the data column (output of 7 bytes):
+// 4 integer digits are shown without the decimal point, right aligned
+void format_liveDataValue(double value, char output[]){
+
+    // Only the first 5 characters fit on the column
+    if (snprintf(output, 6, "%f", value) < 0){
+
+        output[0] = '\0';
+    }
+
+    if (output[4] == '.'){
+
+        memmove(output+1, output, 4);
+        output[0] = ' ';
+        output[5] = '\0';
+    }
+}
+
+void show_liveDataValue(double value, uint8_t row){
+
+    char output[7];
+
+    format_liveDataValue(value, output);
+    hal_displayString(120, 5+(row*10), output, HAL_TEXT_DATA);
+}
+
+void show_VIN(const char VIN[]){
+
+    hal_displayClear();
+    hal_displayString(70, 50, "VIN", HAL_TEXT_TITLE);
+    hal_displayString(25, 70, VIN, HAL_TEXT_TITLE);
+}
+
+void get_OBDstats(tOBDStats *stats){
+
+    *stats = OBD_stats;
+}
+
+void reset_OBDstats(void){
+
+    memset(&OBD_stats, 0, sizeof(OBD_stats));
+}
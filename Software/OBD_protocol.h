@@ -0,0 +1,134 @@
+/*
+ * OBD_protocol.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Core of the OBD protocol: transport (single frame requests and ISO-TP responses), services
+ *      (live data, DTCs, VIN), decoding and the views of their results. It only uses OBD_HAL.h,
+ *      not driverlib nor FreeRTOS, so the same file builds on the Tiva and on a PC (Host/OBD_host).
+ */
+
+#ifndef OBD_PROTOCOL_H_
+#define OBD_PROTOCOL_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// ECU address
+#define ECM_REQUEST 0x7E0
+#define ECM_RESPONSE 0x7E8
+
+#define TCM_REQUEST 0x7E1
+#define TCM_RESPONSE 0x7E9
+
+#define ABS_REQUEST 0x7E2
+#define ABS_RESPONSE 0x7EA
+
+#define REMOTE_REQUEST_ID 0x7DF
+#define MASK_RESPONSE_ID 0x7FFU
+
+// Protocol configuration
+#define MAX_BYTES 8
+#define NUM_CHAR_DTC 5
+#define NUM_LIVE_DATA_PIDS 12
+#define MAX_VIN_BYTES 20
+#define VIN_CHARS 17
+#define OBD_VALUE_DATA_BYTES 4          // Data bytes (A, B, C, D) of a live data response
+#define OBD_MAX_DTCS 16                 // DTCs of a read_DTCs
+
+#define MAX_TIME_TO_WAIT_MS 200
+#define ISOTP_SEPARATION_TIME_MS 5 // Between consecutive frames, asked on the flow control
+
+static const uint8_t pids_liveData[] = {0x04, 0x05, 0x06, 0x07, 0x0C, 0x0D, 0x0B, 0x0E, 0x0F, 0x10, 0x11, 0x1F};
+static const char * const liveData_strings[]= {"Charge motor:",
+                                     "Motor temperature:",
+                                     "S.F.C.(Bank 1):",
+                                     "L.F.C.(Bank 1):",
+                                     "RPM:",
+                                     "Speed:",
+                                     "Intake MAP:",
+                                     "Timing adv.:",
+                                     "Intake temp:",
+                                     "MAF rate:",
+                                     "Throttle pos.:",
+                                     "Run time:"
+};
+// Short names and chart ranges (min, max) of the live data PIDs
+static const char * const liveData_shortStrings[]= {"LOAD",
+                                          "ECT",
+                                          "STFT1",
+                                          "LTFT1",
+                                          "RPM",
+                                          "SPEED",
+                                          "MAP",
+                                          "ADV",
+                                          "IAT",
+                                          "MAF",
+                                          "TPS",
+                                          "RUN"
+};
+static const int16_t liveData_ranges[][2] = {{0, 100},
+                                             {-40, 215},
+                                             {-100, 100},
+                                             {-100, 100},
+                                             {0, 8000},
+                                             {0, 255},
+                                             {0, 255},
+                                             {-64, 64},
+                                             {-40, 215},
+                                             {0, 300},
+                                             {0, 100},
+                                             {0, 3600}
+};
+
+// Live data response of a PID
+typedef struct{
+
+    double value;                           // Decoded value
+    uint8_t data[OBD_VALUE_DATA_BYTES];     // Raw data bytes of the response
+    uint8_t numBytes;
+    uint32_t ECU_ID;                        // Response ID of the ECU that answered
+}tOBDValue;
+
+// Transactions since the last reset_OBDstats. The latency goes from the request to the
+// whole response (hal_timeMs).
+typedef struct{
+
+    uint32_t requests;
+    uint32_t responses;
+    uint32_t timeouts;                      // Request not transmitted or no frame
+    uint32_t errors;                        // Negative or wrong response, ISO-TP sequence
+    uint32_t latency_sum_ms;
+    uint32_t latency_max_ms;
+}tOBDStats;
+
+// Transport. The CAN bus has to be taken by the caller.
+bool request_ECUdata(uint32_t request_ID, uint32_t response_ID, uint8_t mode, uint8_t PID, uint8_t response_data_frame[], uint32_t *ECU_ID);
+int16_t request_ISOTPdata(uint32_t request_ID, uint32_t response_ID, uint8_t mode, uint8_t payload[], uint16_t max_bytes);
+int16_t request_ISOTPmessage(uint32_t request_ID, uint32_t response_ID, const uint8_t request[], uint8_t numBytes, uint8_t payload[], uint16_t max_bytes);
+
+// Services. The CAN bus has to be taken by the caller.
+bool read_PIDvalue(uint32_t request_ID, uint32_t response_ID, uint8_t posPID, tOBDValue *value);
+int16_t read_DTCs(uint32_t request_ID, uint32_t response_ID, uint8_t mode, char codes[][NUM_CHAR_DTC+1], uint8_t max_DTCs);
+bool read_VIN(uint32_t request_ID, uint32_t response_ID, char VIN[]);
+
+// Decoding
+double decode_CANdata(uint8_t posPID, double dataA, double dataB);
+void decode_DTCbytes(uint8_t DTC_high, uint8_t DTC_low, char DTC_decoded[]);
+void format_liveDataValue(double value, char output[]);
+
+// Views
+void show_liveDataValue(double value, uint8_t row);
+void show_VIN(const char VIN[]);
+
+void get_OBDstats(tOBDStats *stats);
+void reset_OBDstats(void);
+
+#endif /* OBD_PROTOCOL_H_ */
@@ -0,0 +1,164 @@
+/*
+ * PID_cache.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+// Programmer libraries
+#include "CAN_device.h"
+#include "PID_history.h"
+#include "PID_cache.h"
+
+// Bit of the cache events set when the request of a PID has finished
+#define PID_CACHE_BIT(posPID) (1UL << (posPID))
+
+// Global variables
+static tPIDCacheEntry PID_cache[NUM_LIVE_DATA_PIDS];
+static EventGroupHandle_t PIDcacheEvents;
+static uint32_t cache_bus_requests = 0;
+static uint32_t cache_hits = 0;
+extern uint32_t ECU_ID_Response;
+
+
+// Entry holds a value of the current ECU not older than max_age ticks.
+// Called inside a critical section.
+static bool is_freshEntry(const tPIDCacheEntry *cached, TickType_t max_age){
+
+    if ((!cached->valid) || (cached->ECU_ID != ECU_ID_Response)){
+
+        return false;
+    }
+
+    return ((xTaskGetTickCount() - cached->timestamp) <= max_age);
+}
+
+// Update the entry with a response (already decoded and recorded by read_PIDvalue).
+// Only the owner of the request of posPID gets here.
+static void store_PIDresponse(uint8_t posPID, const tOBDValue *response){
+
+    tPIDCacheEntry *cached = &PID_cache[posPID];
+
+    // Every response is a sample of the history, whoever requested it
+    add_PIDhistorySample(posPID, response->value);
+
+    taskENTER_CRITICAL();
+    cached->value = response->value;
+    memcpy(cached->data, response->data, PID_CACHE_DATA_BYTES);
+    cached->numBytes = response->numBytes;
+    cached->timestamp = xTaskGetTickCount();
+    cached->ECU_ID = response->ECU_ID;
+    cached->sequence++;
+    cached->valid = true;
+    taskEXIT_CRITICAL();
+}
+
+void init_PIDcache(void){
+
+    PIDcacheEvents = xEventGroupCreate();
+    configASSERT(PIDcacheEvents != NULL);
+
+    invalidate_PIDcache();
+}
+
+// The values belong to the previous ECU (or the view was restarted)
+void invalidate_PIDcache(void){
+
+    taskENTER_CRITICAL();
+    for (int i = 0; i < NUM_LIVE_DATA_PIDS; i++){
+
+        PID_cache[i].valid = false;
+    }
+    taskEXIT_CRITICAL();
+}
+
+// Return on entry the value of posPID not older than max_age ticks. If the cached one is
+// older, the PID is requested to the ECU. When other task is already requesting the same
+// PID, no new request is sent: the task waits for that response and shares it.
+// Return false if there is not a fresh value (no answer from the ECU).
+bool get_PIDvalue(uint8_t posPID, TickType_t max_age, tPIDCacheEntry *entry){
+
+    tPIDCacheEntry *cached;
+    tOBDValue response;
+    uint32_t sequence;
+    bool owner = false;
+    bool received = false;
+
+    if (posPID >= NUM_LIVE_DATA_PIDS){
+
+        return false;
+    }
+    cached = &PID_cache[posPID];
+
+    taskENTER_CRITICAL();
+    if (is_freshEntry(cached, max_age)){
+
+        *entry = *cached;
+        cache_hits++;
+        taskEXIT_CRITICAL();
+        return true;
+    }
+    sequence = cached->sequence;
+    if (!cached->pending){
+
+        cached->pending = true;
+        owner = true;
+        xEventGroupClearBits(PIDcacheEvents, PID_CACHE_BIT(posPID));
+    }
+    taskEXIT_CRITICAL();
+
+    if (owner){
+
+        if (take_CANbus(MAX_TIME_TO_WAIT_MS)){
+
+            cache_bus_requests++;
+            received = read_PIDvalue(REMOTE_REQUEST_ID, ECU_ID_Response, posPID, &response);
+            give_CANbus();
+        }
+        if (received){
+
+            store_PIDresponse(posPID, &response);
+        }
+
+        taskENTER_CRITICAL();
+        cached->pending = false;
+        taskEXIT_CRITICAL();
+        // Wake up the tasks waiting for this PID
+        xEventGroupSetBits(PIDcacheEvents, PID_CACHE_BIT(posPID));
+    }else {
+
+        // The bit is not cleared, all the waiting tasks have to see it
+        xEventGroupWaitBits(PIDcacheEvents, PID_CACHE_BIT(posPID), pdFALSE, pdTRUE, 2*MAX_TIME_TO_WAIT_MS);
+    }
+
+    taskENTER_CRITICAL();
+    *entry = *cached;
+    taskEXIT_CRITICAL();
+
+    return (entry->valid && (entry->sequence != sequence));
+}
+
+uint32_t get_PIDcacheBusRequests(void){
+
+    return cache_bus_requests;
+}
+
+uint32_t get_PIDcacheHits(void){
+
+    return cache_hits;
+}
@@ -0,0 +1,42 @@
+/*
+ * PID_cache.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef PID_CACHE_H_
+#define PID_CACHE_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Cache configuration
+#define PID_CACHE_TTL_MS 50         // Default maximum age used by the live data view
+#define PID_CACHE_DATA_BYTES 4      // Data bytes (A, B, C, D) kept from the response
+
+typedef struct{
+
+    double value;                           // Decoded value
+    uint8_t data[PID_CACHE_DATA_BYTES];     // Raw data bytes of the response
+    uint8_t numBytes;
+    TickType_t timestamp;                   // Tick count when the response was received
+    uint32_t ECU_ID;                        // Response ID of the ECU that answered
+    uint32_t sequence;                      // Incremented on every response
+    bool valid;
+    bool pending;                           // Request on the bus
+}tPIDCacheEntry;
+
+void init_PIDcache(void);
+void invalidate_PIDcache(void);
+bool get_PIDvalue(uint8_t posPID, TickType_t max_age, tPIDCacheEntry *entry);
+uint32_t get_PIDcacheBusRequests(void);
+uint32_t get_PIDcacheHits(void);
+
+#endif /* PID_CACHE_H_ */
@@ -0,0 +1,184 @@
+/*
+ * PID_history.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Programmer libraries
+#include "CAN_device.h"
+#include "PID_history.h"
+
+// Columns reserved for each entry of pids_liveData. A 0 disables the history of that PID.
+// Only RPM and speed fill the chart (CHART_COLUMNS), the pool is in the RAM budget of
+// FreeRTOSConfig.h.
+static const uint16_t PID_history_columns[NUM_LIVE_DATA_PIDS] = {32,    // Charge motor
+                                                                 32,    // Motor temperature
+                                                                 32,    // S.F.C.(Bank 1)
+                                                                 32,    // L.F.C.(Bank 1)
+                                                                 128,   // RPM
+                                                                 128,   // Speed
+                                                                 32,    // Intake MAP
+                                                                 0,     // Timing advance
+                                                                 0,     // Intake temperature
+                                                                 32,    // MAF rate
+                                                                 32,    // Throttle position
+                                                                 0      // Run time
+};
+
+// Global variables
+static tPIDHistoryColumn history_pool[PID_HISTORY_POOL_COLUMNS];
+static tPIDHistory PID_history[NUM_LIVE_DATA_PIDS];
+
+
+void init_PIDhistory(void){
+
+    uint16_t offset = 0;
+
+    for (int i = 0; i < NUM_LIVE_DATA_PIDS; i++){
+
+        // The pool has to be big enough for all the columns configured
+        configASSERT((offset + PID_history_columns[i]) <= PID_HISTORY_POOL_COLUMNS);
+
+        PID_history[i].columns = history_pool + offset;
+        PID_history[i].size = PID_history_columns[i];
+        offset += PID_history_columns[i];
+        clear_PIDhistory(i);
+    }
+}
+
+void clear_PIDhistory(uint8_t posPID){
+
+    if (posPID >= NUM_LIVE_DATA_PIDS){
+
+        return;
+    }
+
+    PID_history[posPID].head = 0;
+    PID_history[posPID].count = 0;
+    PID_history[posPID].bucket_samples = 0;
+    PID_history[posPID].total_samples = 0;
+}
+
+// Fold a new sample on the column being built. Only a few comparisons per sample,
+// the column is committed to the ring when PID_HISTORY_DECIMATION samples are folded.
+// Return true if a new column has been committed.
+bool add_PIDhistorySample(uint8_t posPID, double value){
+
+    tPIDHistory *history;
+    int16_t sample;
+
+    if (posPID >= NUM_LIVE_DATA_PIDS){
+
+        return false;
+    }
+
+    history = &PID_history[posPID];
+    if (history->size == 0){
+
+        return false;
+    }
+
+    // Saturate the decoded value to the range of the column
+    if (value >= INT16_MAX){
+        sample = INT16_MAX;
+    }else if (value <= INT16_MIN){
+        sample = INT16_MIN;
+    }else {
+        sample = (int16_t)((value >= 0) ? (value + 0.5) : (value - 0.5));
+    }
+
+    if (history->bucket_samples == 0){
+
+        history->bucket_min = sample;
+        history->bucket_max = sample;
+    }else {
+
+        if (sample < history->bucket_min){
+            history->bucket_min = sample;
+        }
+        if (sample > history->bucket_max){
+            history->bucket_max = sample;
+        }
+    }
+    history->bucket_samples++;
+    history->total_samples++;
+
+    if (history->bucket_samples < PID_HISTORY_DECIMATION){
+
+        return false;
+    }
+
+    history->columns[history->head].min = history->bucket_min;
+    history->columns[history->head].max = history->bucket_max;
+    history->bucket_samples = 0;
+
+    history->head++;
+    if (history->head == history->size){
+
+        history->head = 0;
+    }
+    if (history->count < history->size){
+
+        history->count++;
+    }
+
+    return true;
+}
+
+// Return on column the committed column with the given age (0 is the newest one).
+bool get_PIDhistoryColumn(uint8_t posPID, uint16_t age, tPIDHistoryColumn *column){
+
+    tPIDHistory *history;
+    uint16_t pos;
+
+    if (posPID >= NUM_LIVE_DATA_PIDS){
+
+        return false;
+    }
+
+    history = &PID_history[posPID];
+    if (age >= history->count){
+
+        return false;
+    }
+
+    pos = (history->head + history->size - 1 - age) % history->size;
+    *column = history->columns[pos];
+
+    return true;
+}
+
+uint16_t get_PIDhistoryCount(uint8_t posPID){
+
+    if (posPID >= NUM_LIVE_DATA_PIDS){
+
+        return 0;
+    }
+
+    return PID_history[posPID].count;
+}
+
+uint32_t get_PIDhistoryTotalSamples(uint8_t posPID){
+
+    if (posPID >= NUM_LIVE_DATA_PIDS){
+
+        return 0;
+    }
+
+    return PID_history[posPID].total_samples;
+}
@@ -0,0 +1,53 @@
+/*
+ * PID_history.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef PID_HISTORY_H_
+#define PID_HISTORY_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// History configuration
+// Every column of the history keeps the min/max of PID_HISTORY_DECIMATION samples,
+// so a PID with 128 columns represents 128*PID_HISTORY_DECIMATION samples.
+// The number of columns of each PID is set on PID_history_columns[] (PID_history.c)
+// and all of them are taken from a static pool of PID_HISTORY_POOL_COLUMNS columns.
+#define PID_HISTORY_DECIMATION 8
+#define PID_HISTORY_POOL_COLUMNS 480
+
+typedef struct{
+
+    int16_t min;
+    int16_t max;
+}tPIDHistoryColumn;
+
+typedef struct{
+
+    tPIDHistoryColumn *columns;
+    uint16_t size;              // Number of columns reserved for this PID
+    uint16_t head;              // Next column to be written
+    uint16_t count;             // Columns already committed
+    int16_t bucket_min;         // Column being built (not committed yet)
+    int16_t bucket_max;
+    uint16_t bucket_samples;
+    uint32_t total_samples;
+}tPIDHistory;
+
+void init_PIDhistory(void);
+void clear_PIDhistory(uint8_t posPID);
+bool add_PIDhistorySample(uint8_t posPID, double value);
+bool get_PIDhistoryColumn(uint8_t posPID, uint16_t age, tPIDHistoryColumn *column);
+uint16_t get_PIDhistoryCount(uint8_t posPID);
+uint32_t get_PIDhistoryTotalSamples(uint8_t posPID);
+
+#endif /* PID_HISTORY_H_ */
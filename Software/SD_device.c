@@ -0,0 +1,72 @@
+/*
+ * SD_device.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Programmer libraries
+#include "sdcard.h"
+#include "SD_fat.h"
+#include "SD_device.h"
+#include "Cycle_probes.h"
+
+
+static bool read_SDcard(uint32_t lba, uint8_t *buffer, uint32_t count){
+
+    return sd_read_blocks(lba, buffer, count, SD_SSI) != 0;
+}
+
+static bool write_SDcard(uint32_t lba, const uint8_t *buffer, uint32_t count){
+
+    uint32_t probe = PROBE_START();
+    bool ok = sd_write_blocks(lba, buffer, count, SD_SSI) != 0;
+
+    probe_end(PROBE_SD_WRITE, probe);
+    return ok;
+}
+
+static bool start_SDstream(uint32_t lba){
+
+    return sd_stream_start(lba, SD_SSI) != 0;
+}
+
+static bool write_SDstream(const uint8_t *buffer){
+
+    uint32_t probe = PROBE_START();
+    bool ok = sd_stream_write(buffer, SD_SSI) != 0;
+
+    probe_end(PROBE_SD_WRITE, probe);
+    return ok;
+}
+
+static bool stop_SDstream(void){
+
+    return sd_stream_stop(SD_SSI) != 0;
+}
+
+// Block device of the card for SD_fat.c
+const tSDBlockDevice SD_card = {read_SDcard, write_SDcard, start_SDstream, write_SDstream, stop_SDstream};
+
+// SSI and the timer of the timeouts of sdcard.c (10 ms)
+void init_SDdevice(void){
+
+    startSSI1();
+    Timer5_Init();
+}
+
+// Initialize the card (it can be inserted later) and go to the fast clock
+void start_SDdevice(void){
+
+    initialize_sd(SD_SSI);
+    change_speed(SD_SSI);
+}
@@ -0,0 +1,30 @@
+/*
+ * SD_device.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef SD_DEVICE_H_
+#define SD_DEVICE_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// The card is on SSI1: PF0-PF2 and CS on PF3.
+// sdcard.h includes inc/tm4c123gh6pm.h, which redefines the interrupts of hw_ints.h
+// (FreeRTOSConfig.h), so the FreeRTOS files only use the card through this module.
+#define SD_SSI SSI1
+
+extern const tSDBlockDevice SD_card;
+
+void init_SDdevice(void);
+void start_SDdevice(void);
+
+#endif /* SD_DEVICE_H_ */
@@ -0,0 +1,884 @@
+/*
+ * SD_fat.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      FAT32 append writer. It does not use the hardware nor FreeRTOS, every sector goes
+ *      through the block device of the volume, so it is also compiled on the host against
+ *      a disk image (Host/SD_image).
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Programmer libraries
+#include "SD_fat.h"
+
+// Boot sector, MBR and FSInfo offsets
+#define BPB_BYTES_PER_SECTOR 11
+#define BPB_SECTORS_PER_CLUSTER 13
+#define BPB_RESERVED_SECTORS 14
+#define BPB_NUM_FATS 16
+#define BPB_TOTAL_SECTORS_16 19
+#define BPB_TOTAL_SECTORS_32 32
+#define BPB_SECTORS_PER_FAT_32 36
+#define BPB_ROOT_CLUSTER 44
+#define BPB_FSINFO_SECTOR 48
+#define BPB_FS_TYPE 82
+#define MBR_FIRST_PARTITION 446
+#define MBR_PARTITION_TYPE 4
+#define MBR_PARTITION_LBA 8
+#define SIGNATURE_OFFSET 510
+#define FSINFO_LEAD_SIGNATURE 0x41615252UL
+#define FSINFO_STRUCT_SIGNATURE 0x61417272UL
+#define FSINFO_STRUCT_OFFSET 484
+#define FSINFO_FREE_COUNT 488
+#define FSINFO_NEXT_FREE 492
+#define FSINFO_UNKNOWN 0xFFFFFFFFUL
+
+// Directory entry offsets
+#define DIR_ATTRIBUTES 11
+#define DIR_CREATION_TIME 14
+#define DIR_CREATION_DATE 16
+#define DIR_ACCESS_DATE 18
+#define DIR_CLUSTER_HIGH 20
+#define DIR_WRITE_TIME 22
+#define DIR_WRITE_DATE 24
+#define DIR_CLUSTER_LOW 26
+#define DIR_SIZE 28
+#define DIR_END_MARK 0x00
+#define DIR_DELETED_MARK 0xE5
+
+#define FAT_ENTRIES_PER_SECTOR (SD_SECTOR_SIZE/4)
+#define FIRST_CLUSTER 2
+
+typedef struct{
+
+    uint32_t lba;                   // Sector and offset of the entry
+    uint16_t offset;
+    uint32_t first_cluster;
+    uint32_t size;
+}tDirEntry;
+
+
+static uint16_t get_le16(const uint8_t *data){
+
+    return (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+}
+
+static uint32_t get_le32(const uint8_t *data){
+
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void set_le16(uint8_t *data, uint16_t value){
+
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+}
+
+static void set_le32(uint8_t *data, uint32_t value){
+
+    data[0] = value & 0xFF;
+    data[1] = (value >> 8) & 0xFF;
+    data[2] = (value >> 16) & 0xFF;
+    data[3] = value >> 24;
+}
+
+uint32_t SD_cluster2lba(const tSDVolume *volume, uint32_t cluster){
+
+    return volume->cluster_lba + (cluster - FIRST_CLUSTER)*volume->sectors_per_cluster;
+}
+
+// Write the cached sector if it was modified. A sector of the first FAT is written on every copy.
+bool flush_SDsectorCache(tSDVolume *volume){
+
+    uint32_t lba = volume->sector_lba;
+
+    if (!volume->sector_dirty){
+
+        return true;
+    }
+
+    if ((lba >= volume->fat_lba) && (lba < volume->fat_lba + volume->sectors_per_fat)){
+
+        for (uint8_t i = 0; i < volume->num_fats; i++){
+
+            if (!volume->device->write(lba + i*volume->sectors_per_fat, volume->sector, 1)){
+
+                return false;
+            }
+        }
+    }else if (!volume->device->write(lba, volume->sector, 1)){
+
+        return false;
+    }
+    volume->sector_dirty = false;
+
+    return true;
+}
+
+static bool read_sector(tSDVolume *volume, uint32_t lba){
+
+    if ((volume->sector_valid) && (volume->sector_lba == lba)){
+
+        return true;
+    }
+    if (!flush_SDsectorCache(volume)){
+
+        return false;
+    }
+
+    volume->sector_valid = volume->device->read(lba, volume->sector, 1);
+    volume->sector_lba = lba;
+
+    return volume->sector_valid;
+}
+
+bool read_SDfatEntry(tSDVolume *volume, uint32_t cluster, uint32_t *value){
+
+    if (!read_sector(volume, volume->fat_lba + cluster/FAT_ENTRIES_PER_SECTOR)){
+
+        return false;
+    }
+    *value = get_le32(&volume->sector[(cluster % FAT_ENTRIES_PER_SECTOR)*4]) & SD_FAT_CLUSTER_MASK;
+
+    return true;
+}
+
+static bool write_fat_entry(tSDVolume *volume, uint32_t cluster, uint32_t value){
+
+    uint8_t *entry;
+
+    if (!read_sector(volume, volume->fat_lba + cluster/FAT_ENTRIES_PER_SECTOR)){
+
+        return false;
+    }
+    // The 4 high bits are reserved and they are kept
+    entry = &volume->sector[(cluster % FAT_ENTRIES_PER_SECTOR)*4];
+    set_le32(entry, (get_le32(entry) & ~SD_FAT_CLUSTER_MASK) | (value & SD_FAT_CLUSTER_MASK));
+    volume->sector_dirty = true;
+
+    return true;
+}
+
+static bool is_valid_cluster(const tSDVolume *volume, uint32_t cluster){
+
+    return (cluster >= FIRST_CLUSTER) && (cluster < volume->num_clusters + FIRST_CLUSTER);
+}
+
+// Mount the first FAT32 partition of the MBR or a volume without partition table
+bool mount_SDvolume(tSDVolume *volume, const tSDBlockDevice *device){
+
+    uint32_t total_sectors;
+    uint32_t reserved;
+    uint8_t type;
+
+    memset(volume, 0, sizeof(tSDVolume));
+    volume->device = device;
+
+    if ((!read_sector(volume, 0)) || (get_le16(&volume->sector[SIGNATURE_OFFSET]) != 0xAA55)){
+
+        return false;
+    }
+
+    if (memcmp(&volume->sector[BPB_FS_TYPE], "FAT32   ", 8) != 0){
+
+        type = volume->sector[MBR_FIRST_PARTITION + MBR_PARTITION_TYPE];
+        if ((type != 0x0B) && (type != 0x0C)){
+
+            return false;
+        }
+        volume->partition_lba = get_le32(&volume->sector[MBR_FIRST_PARTITION + MBR_PARTITION_LBA]);
+        if ((!read_sector(volume, volume->partition_lba)) || (get_le16(&volume->sector[SIGNATURE_OFFSET]) != 0xAA55)){
+
+            return false;
+        }
+    }
+
+    if ((get_le16(&volume->sector[BPB_BYTES_PER_SECTOR]) != SD_SECTOR_SIZE)
+            || (get_le16(&volume->sector[BPB_TOTAL_SECTORS_16]) != 0)
+            || (volume->sector[BPB_SECTORS_PER_CLUSTER] == 0)){
+
+        return false;
+    }
+
+    reserved = get_le16(&volume->sector[BPB_RESERVED_SECTORS]);
+    total_sectors = get_le32(&volume->sector[BPB_TOTAL_SECTORS_32]);
+    volume->sectors_per_cluster = volume->sector[BPB_SECTORS_PER_CLUSTER];
+    volume->num_fats = volume->sector[BPB_NUM_FATS];
+    volume->sectors_per_fat = get_le32(&volume->sector[BPB_SECTORS_PER_FAT_32]);
+    volume->root_cluster = get_le32(&volume->sector[BPB_ROOT_CLUSTER]);
+    volume->fsinfo_lba = volume->partition_lba + get_le16(&volume->sector[BPB_FSINFO_SECTOR]);
+    volume->fat_lba = volume->partition_lba + reserved;
+    volume->cluster_lba = volume->fat_lba + volume->num_fats*volume->sectors_per_fat;
+    volume->num_clusters = (total_sectors - (volume->cluster_lba - volume->partition_lba)) / volume->sectors_per_cluster;
+
+    // The FAT can have less entries than the data region
+    if (volume->num_clusters + FIRST_CLUSTER > volume->sectors_per_fat*FAT_ENTRIES_PER_SECTOR){
+
+        volume->num_clusters = volume->sectors_per_fat*FAT_ENTRIES_PER_SECTOR - FIRST_CLUSTER;
+    }
+    if ((volume->num_fats == 0) || (!is_valid_cluster(volume, volume->root_cluster))){
+
+        return false;
+    }
+
+    // The hint of FSInfo saves the search from the beginning of the FAT
+    volume->next_free = FIRST_CLUSTER;
+    if ((read_sector(volume, volume->fsinfo_lba)) && (get_le32(volume->sector) == FSINFO_LEAD_SIGNATURE)
+            && (get_le32(&volume->sector[FSINFO_STRUCT_OFFSET]) == FSINFO_STRUCT_SIGNATURE)
+            && (is_valid_cluster(volume, get_le32(&volume->sector[FSINFO_NEXT_FREE])))){
+
+        volume->next_free = get_le32(&volume->sector[FSINFO_NEXT_FREE]);
+    }
+    volume->mounted = true;
+
+    return true;
+}
+
+static bool is_pending_cluster(const tSDFile *file, uint32_t cluster){
+
+    for (uint8_t i = 0; i < file->num_runs; i++){
+
+        if ((cluster >= file->new_runs[i].start) && (cluster < file->new_runs[i].start + file->new_runs[i].length)){
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Look for a free cluster from the hint. The clusters of the file that are not linked
+// yet are free on the FAT, so they are skipped.
+static bool find_free_cluster(tSDVolume *volume, const tSDFile *file, uint32_t *cluster){
+
+    uint32_t candidate = volume->next_free;
+    uint32_t value;
+
+    for (uint32_t i = 0; i < volume->num_clusters; i++){
+
+        if (!is_valid_cluster(volume, candidate)){
+
+            candidate = FIRST_CLUSTER;
+        }
+        if (!read_SDfatEntry(volume, candidate, &value)){
+
+            return false;
+        }
+        if ((value == SD_FAT_FREE_CLUSTER) && (!is_pending_cluster(file, candidate))){
+
+            *cluster = candidate;
+            volume->next_free = candidate + 1;
+            return true;
+        }
+        candidate++;
+    }
+
+    return false;   // Full
+}
+
+// Write the sectors of the buffer, the contiguous ones with a single device write.
+// The last sector is kept on the buffer if it is not complete.
+// SD_FILE_BUFFER_SECTORS bounds the indexes too: with a single sector they are never used.
+static bool flush_buffer(tSDVolume *volume, tSDFile *file){
+
+    uint16_t sectors = (file->buffered + SD_SECTOR_SIZE - 1) / SD_SECTOR_SIZE;
+    uint16_t first = 0, last;
+
+    while (first < sectors){
+
+        last = first;
+        while ((last+1 < SD_FILE_BUFFER_SECTORS) && (last+1 < sectors) && (file->buffer_lba[last+1] == file->buffer_lba[last] + 1)){
+
+            last++;
+        }
+        if (!volume->device->write(file->buffer_lba[first], &file->buffer[first*SD_SECTOR_SIZE], last - first + 1)){
+
+            return false;
+        }
+        first = last + 1;
+    }
+
+    if ((file->buffered % SD_SECTOR_SIZE) != 0){
+
+        if ((SD_FILE_BUFFER_SECTORS > 1) && (sectors > 1)){
+
+            memmove(file->buffer, &file->buffer[(sectors-1)*SD_SECTOR_SIZE], SD_SECTOR_SIZE);
+            file->buffer_lba[0] = file->buffer_lba[sectors-1];
+        }
+        file->buffered %= SD_SECTOR_SIZE;
+    }else {
+
+        file->buffered = 0;
+    }
+
+    return true;
+}
+
+static bool update_dir_entry(tSDVolume *volume, uint32_t dir_lba, uint16_t dir_offset, uint32_t first_cluster, uint32_t size){
+
+    uint8_t *entry;
+
+    if (!read_sector(volume, dir_lba)){
+
+        return false;
+    }
+    entry = &volume->sector[dir_offset];
+    set_le16(&entry[DIR_CLUSTER_HIGH], first_cluster >> 16);
+    set_le16(&entry[DIR_CLUSTER_LOW], first_cluster & 0xFFFF);
+    set_le32(&entry[DIR_SIZE], size);
+    set_le16(&entry[DIR_WRITE_DATE], SD_FAT_DEFAULT_DATE);
+    set_le16(&entry[DIR_ACCESS_DATE], SD_FAT_DEFAULT_DATE);
+    volume->sector_dirty = true;
+
+    return true;
+}
+
+// allocated clusters since the last update (negative if they have been freed)
+static bool update_fsinfo(tSDVolume *volume, int32_t allocated){
+
+    uint32_t free_clusters;
+
+    if ((!read_sector(volume, volume->fsinfo_lba)) || (get_le32(volume->sector) != FSINFO_LEAD_SIGNATURE)){
+
+        return true;   // FSInfo is optional
+    }
+
+    free_clusters = get_le32(&volume->sector[FSINFO_FREE_COUNT]);
+    if ((free_clusters != FSINFO_UNKNOWN) && ((int32_t)free_clusters >= allocated)
+            && (free_clusters - allocated <= volume->num_clusters)){
+
+        set_le32(&volume->sector[FSINFO_FREE_COUNT], free_clusters - allocated);
+    }else {
+
+        set_le32(&volume->sector[FSINFO_FREE_COUNT], FSINFO_UNKNOWN);
+    }
+    set_le32(&volume->sector[FSINFO_NEXT_FREE], volume->next_free);
+    volume->sector_dirty = true;
+
+    return true;
+}
+
+// Data, then chain and then size: if the card is removed in the middle the directory never
+// points to clusters that are not written. The file stays open.
+bool sync_SDfile(tSDVolume *volume, tSDFile *file){
+
+    uint32_t cluster;
+
+    if (!flush_buffer(volume, file)){
+
+        return false;
+    }
+
+    for (uint8_t i = 0; i < file->num_runs; i++){
+
+        cluster = file->new_runs[i].start;
+        if ((file->link_from != 0) && (!write_fat_entry(volume, file->link_from, cluster))){
+
+            return false;
+        }
+        for (uint32_t j = 1; j < file->new_runs[i].length; j++, cluster++){
+
+            if (!write_fat_entry(volume, cluster, cluster + 1)){
+
+                return false;
+            }
+        }
+        if (!write_fat_entry(volume, cluster, SD_FAT_END_OF_CHAIN)){
+
+            return false;
+        }
+        file->link_from = cluster;
+    }
+    file->num_runs = 0;
+
+    if ((!update_dir_entry(volume, file->dir_lba, file->dir_offset, file->first_cluster, file->size))
+            || (!update_fsinfo(volume, file->new_clusters))){
+
+        return false;
+    }
+    file->new_clusters = 0;
+
+    return flush_SDsectorCache(volume);
+}
+
+static bool allocate_cluster(tSDVolume *volume, tSDFile *file){
+
+    tSDClusterRun *run = (file->num_runs > 0) ? &file->new_runs[file->num_runs-1] : NULL;
+    uint32_t cluster;
+
+    if (!find_free_cluster(volume, file, &cluster)){
+
+        return false;
+    }
+
+    if ((run != NULL) && (cluster == run->start + run->length)){
+
+        run->length++;
+    }else {
+
+        // Without space for a new run the previous ones are linked first
+        if ((file->num_runs == SD_FAT_MAX_RUNS) && (!sync_SDfile(volume, file))){
+
+            return false;
+        }
+        file->new_runs[file->num_runs].start = cluster;
+        file->new_runs[file->num_runs].length = 1;
+        file->num_runs++;
+    }
+
+    if (file->first_cluster == 0){
+
+        file->first_cluster = cluster;
+    }
+    file->current_cluster = cluster;
+    file->next_sector = 0;
+    file->new_clusters++;
+
+    return true;
+}
+
+// Look for the entry on the root directory or create it (if create) on the first free entry.
+// The root directory is not extended. Without found only the name is looked for.
+static bool find_dir_entry(tSDVolume *volume, const uint8_t name[SD_FAT_NAME_SIZE], tDirEntry *found, bool create){
+
+    uint32_t cluster = volume->root_cluster;
+    uint32_t free_lba = 0;
+    uint16_t free_offset = 0;
+    uint32_t lba;
+    uint8_t *entry;
+
+    while (is_valid_cluster(volume, cluster)){
+
+        for (uint8_t sector = 0; sector < volume->sectors_per_cluster; sector++){
+
+            lba = SD_cluster2lba(volume, cluster) + sector;
+            if (!read_sector(volume, lba)){
+
+                return false;
+            }
+            for (uint16_t offset = 0; offset < SD_SECTOR_SIZE; offset += SD_FAT_DIR_ENTRY_SIZE){
+
+                entry = &volume->sector[offset];
+                if ((entry[0] == DIR_END_MARK) || (entry[0] == DIR_DELETED_MARK)){
+
+                    if (free_lba == 0){
+
+                        free_lba = lba;
+                        free_offset = offset;
+                    }
+                    if (entry[0] == DIR_END_MARK){
+
+                        goto create;
+                    }
+                }else if ((entry[DIR_ATTRIBUTES] != SD_FAT_ATTR_LONG_NAME)
+                        && (memcmp(entry, name, SD_FAT_NAME_SIZE) == 0)){
+
+                    if (found != NULL){
+
+                        found->lba = lba;
+                        found->offset = offset;
+                        found->first_cluster = ((uint32_t)get_le16(&entry[DIR_CLUSTER_HIGH]) << 16)
+                                               | get_le16(&entry[DIR_CLUSTER_LOW]);
+                        found->size = get_le32(&entry[DIR_SIZE]);
+                    }
+                    return true;
+                }
+            }
+        }
+        if (!read_SDfatEntry(volume, cluster, &cluster)){
+
+            return false;
+        }
+    }
+
+create:
+    if ((!create) || (found == NULL) || (free_lba == 0)){
+
+        return false;   // Root directory full
+    }
+    if (!read_sector(volume, free_lba)){
+
+        return false;
+    }
+    entry = &volume->sector[free_offset];
+    memset(entry, 0, SD_FAT_DIR_ENTRY_SIZE);
+    memcpy(entry, name, SD_FAT_NAME_SIZE);
+    entry[DIR_ATTRIBUTES] = SD_FAT_ATTR_ARCHIVE;
+    set_le16(&entry[DIR_CREATION_DATE], SD_FAT_DEFAULT_DATE);
+    set_le16(&entry[DIR_WRITE_DATE], SD_FAT_DEFAULT_DATE);
+    set_le16(&entry[DIR_ACCESS_DATE], SD_FAT_DEFAULT_DATE);
+    volume->sector_dirty = true;
+
+    found->lba = free_lba;
+    found->offset = free_offset;
+    found->first_cluster = 0;
+    found->size = 0;
+
+    return flush_SDsectorCache(volume);
+}
+
+// Open (or create) a file of the root directory to append data at the end
+bool open_SDfile(tSDVolume *volume, tSDFile *file, const char name[SD_FAT_NAME_SIZE]){
+
+    tDirEntry entry;
+    uint32_t cluster_bytes = (uint32_t)volume->sectors_per_cluster*SD_SECTOR_SIZE;
+    uint32_t clusters, offset;
+    uint32_t cluster;
+
+    if (!volume->mounted){
+
+        return false;
+    }
+
+    memset(file, 0, sizeof(tSDFile));
+    memcpy(file->name, name, SD_FAT_NAME_SIZE);
+    if (!find_dir_entry(volume, file->name, &entry, true)){
+
+        return false;
+    }
+    file->dir_lba = entry.lba;
+    file->dir_offset = entry.offset;
+    file->first_cluster = entry.first_cluster;
+    file->size = entry.size;
+
+    if (file->first_cluster == 0){
+
+        file->size = 0;
+        file->open = true;
+        return true;
+    }
+
+    // Last cluster of the data
+    clusters = (file->size + cluster_bytes - 1) / cluster_bytes;
+    cluster = file->first_cluster;
+    for (uint32_t i = 1; i < clusters; i++){
+
+        if ((!read_SDfatEntry(volume, cluster, &cluster)) || (!is_valid_cluster(volume, cluster))){
+
+            return false;
+        }
+    }
+    file->current_cluster = cluster;
+    file->link_from = cluster;
+
+    offset = file->size % cluster_bytes;
+    if ((file->size > 0) && (offset == 0)){
+
+        file->next_sector = volume->sectors_per_cluster;
+    }else {
+
+        file->next_sector = offset / SD_SECTOR_SIZE;
+    }
+
+    // The last sector is not complete: it goes to the buffer to append there
+    if ((file->size % SD_SECTOR_SIZE) != 0){
+
+        file->buffer_lba[0] = SD_cluster2lba(volume, cluster) + file->next_sector;
+        if (!volume->device->read(file->buffer_lba[0], file->buffer, 1)){
+
+            return false;
+        }
+        file->buffered = file->size % SD_SECTOR_SIZE;
+        file->next_sector++;
+    }
+    file->open = true;
+
+    return true;
+}
+
+// The file is on the root directory
+bool find_SDfile(tSDVolume *volume, const char name[SD_FAT_NAME_SIZE]){
+
+    return (volume->mounted) && (find_dir_entry(volume, (const uint8_t *)name, NULL, false));
+}
+
+bool write_SDfile(tSDVolume *volume, tSDFile *file, const void *data, uint32_t size){
+
+    const uint8_t *source = data;
+    uint16_t sector, in_sector, length;
+
+    if (!file->open){
+
+        return false;
+    }
+
+    while (size > 0){
+
+        in_sector = file->buffered % SD_SECTOR_SIZE;
+        if (in_sector == 0){
+
+            // New sector on the buffer
+            if ((file->buffered == sizeof(file->buffer)) && (!flush_buffer(volume, file))){
+
+                return false;
+            }
+            if ((file->current_cluster == 0) || (file->next_sector == volume->sectors_per_cluster)){
+
+                if (!allocate_cluster(volume, file)){
+
+                    return false;
+                }
+            }
+            sector = file->buffered / SD_SECTOR_SIZE;
+            file->buffer_lba[sector] = SD_cluster2lba(volume, file->current_cluster) + file->next_sector;
+            file->next_sector++;
+            memset(&file->buffer[sector*SD_SECTOR_SIZE], 0, SD_SECTOR_SIZE);
+        }
+
+        length = SD_SECTOR_SIZE - in_sector;
+        if (length > size){
+
+            length = size;
+        }
+        memcpy(&file->buffer[file->buffered], source, length);
+        file->buffered += length;
+        file->size += length;
+        source += length;
+        size -= length;
+    }
+
+    return true;
+}
+
+bool close_SDfile(tSDVolume *volume, tSDFile *file){
+
+    bool result;
+
+    if (!file->open){
+
+        return false;
+    }
+    result = sync_SDfile(volume, file);
+    file->open = false;
+
+    return result;
+}
+
+// Look for the first free run of clusters from the hint. If there is not one with the
+// length that is asked, the longest one is taken (at least SD_RECORD_MIN_CLUSTERS).
+static bool find_free_run(tSDVolume *volume, uint32_t clusters, uint32_t *start, uint32_t *length){
+
+    uint32_t candidate = volume->next_free;
+    uint32_t run_start = 0, run_length = 0;
+    uint32_t value;
+
+    *length = 0;
+    for (uint32_t i = 0; i < volume->num_clusters; i++){
+
+        if (!is_valid_cluster(volume, candidate)){
+
+            // A run does not go from the end to the beginning of the FAT
+            candidate = FIRST_CLUSTER;
+            run_length = 0;
+        }
+        if (!read_SDfatEntry(volume, candidate, &value)){
+
+            return false;
+        }
+        if (value == SD_FAT_FREE_CLUSTER){
+
+            if (run_length == 0){
+
+                run_start = candidate;
+            }
+            run_length++;
+            if (run_length > *length){
+
+                *start = run_start;
+                *length = run_length;
+            }
+            if (run_length == clusters){
+
+                return true;
+            }
+        }else {
+
+            run_length = 0;
+        }
+        candidate++;
+    }
+
+    return *length >= SD_RECORD_MIN_CLUSTERS;
+}
+
+// Create a record file on the root directory with a run of clusters (or less if the card
+// does not have it). The whole chain is written now.
+bool open_SDrecord(tSDVolume *volume, tSDRecord *record, const char name[SD_FAT_NAME_SIZE], uint32_t clusters){
+
+    tDirEntry entry;
+    uint32_t start = 0, length;
+
+    if (!volume->mounted){
+
+        return false;
+    }
+
+    memset(record, 0, sizeof(tSDRecord));
+    if ((!find_dir_entry(volume, (const uint8_t *)name, &entry, true)) || (entry.first_cluster != 0)){
+
+        return false;   // The data of a file is not overwritten
+    }
+    if ((clusters < SD_RECORD_MIN_CLUSTERS) || (!find_free_run(volume, clusters, &start, &length))){
+
+        return false;
+    }
+
+    for (uint32_t cluster = start; cluster < start + length - 1; cluster++){
+
+        if (!write_fat_entry(volume, cluster, cluster + 1)){
+
+            return false;
+        }
+    }
+    if (!write_fat_entry(volume, start + length - 1, SD_FAT_END_OF_CHAIN)){
+
+        return false;
+    }
+    volume->next_free = start + length;
+    if ((!update_dir_entry(volume, entry.lba, entry.offset, start, 0)) || (!update_fsinfo(volume, length))
+            || (!flush_SDsectorCache(volume))){
+
+        return false;
+    }
+
+    record->first_cluster = start;
+    record->clusters = length;
+    record->first_lba = SD_cluster2lba(volume, start);
+    record->capacity = length*volume->sectors_per_cluster;
+    record->dir_lba = entry.lba;
+    record->dir_offset = entry.offset;
+    record->open = true;
+
+    return true;
+}
+
+// Write whole sectors after the last ones. With the stream of the device the first write
+// opens it and the next ones only send the data. It fails if the run is full.
+bool write_SDrecord(tSDVolume *volume, tSDRecord *record, const uint8_t *sectors, uint32_t count){
+
+    const tSDBlockDevice *device = volume->device;
+
+    if ((!record->open) || (count > record->capacity - record->written)){
+
+        return false;
+    }
+
+    if (device->stream_start == NULL){
+
+        if (!device->write(record->first_lba + record->written, sectors, count)){
+
+            return false;
+        }
+        record->written += count;
+        return true;
+    }
+
+    if (!record->streaming){
+
+        // The cached sector is written before, no other access to the card is possible later
+        if ((!flush_SDsectorCache(volume)) || (!device->stream_start(record->first_lba + record->written))){
+
+            return false;
+        }
+        record->streaming = true;
+    }
+    for (uint32_t i = 0; i < count; i++){
+
+        if (!device->stream_write(&sectors[i*SD_SECTOR_SIZE])){
+
+            return false;
+        }
+        record->written++;
+    }
+
+    return true;
+}
+
+// Close the stream and write the size on the directory entry: the sectors written until
+// now can be read after a power cut. The record stays open.
+bool checkpoint_SDrecord(tSDVolume *volume, tSDRecord *record){
+
+    if (!record->open){
+
+        return false;
+    }
+    if (record->streaming){
+
+        record->streaming = false;
+        if (!volume->device->stream_stop()){
+
+            return false;
+        }
+    }
+    if (record->checkpoint == record->written){
+
+        return true;
+    }
+    if ((!update_dir_entry(volume, record->dir_lba, record->dir_offset, record->first_cluster,
+                           record->written*SD_SECTOR_SIZE)) || (!flush_SDsectorCache(volume))){
+
+        return false;
+    }
+    record->checkpoint = record->written;
+
+    return true;
+}
+
+// Last checkpoint and the clusters that have not been used are freed
+bool close_SDrecord(tSDVolume *volume, tSDRecord *record){
+
+    uint32_t used, cluster;
+
+    if (!checkpoint_SDrecord(volume, record)){
+
+        record->open = false;
+        return false;
+    }
+    record->open = false;
+
+    used = (record->written + volume->sectors_per_cluster - 1) / volume->sectors_per_cluster;
+    if (used == record->clusters){
+
+        return true;
+    }
+
+    // First the directory or the end of the chain, then the free clusters
+    if (used == 0){
+
+        if (!update_dir_entry(volume, record->dir_lba, record->dir_offset, 0, 0)){
+
+            return false;
+        }
+    }else if (!write_fat_entry(volume, record->first_cluster + used - 1, SD_FAT_END_OF_CHAIN)){
+
+        return false;
+    }
+    for (cluster = record->first_cluster + used; cluster < record->first_cluster + record->clusters; cluster++){
+
+        if (!write_fat_entry(volume, cluster, SD_FAT_FREE_CLUSTER)){
+
+            return false;
+        }
+    }
+    if (volume->next_free > record->first_cluster + used){
+
+        volume->next_free = record->first_cluster + used;
+    }
+    if (!update_fsinfo(volume, -(int32_t)(record->clusters - used))){
+
+        return false;
+    }
+
+    return flush_SDsectorCache(volume);
+}
@@ -0,0 +1,138 @@
+/*
+ * SD_fat.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef SD_FAT_H_
+#define SD_FAT_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// FAT32 writer configuration
+// Files are appended on the root directory with 8.3 names ("BODY    TXT").
+// The data goes through a RAM buffer of SD_FILE_BUFFER_SECTORS sectors that is written
+// with multiple block writes, and the FAT, the directory entry and the FSInfo sector are
+// only updated when the file is closed (or when SD_FAT_MAX_RUNS runs of new clusters are
+// waiting to be linked). Without close the new data is lost but the volume is consistent.
+#define SD_SECTOR_SIZE 512
+#define SD_FILE_BUFFER_SECTORS 1
+#define SD_FAT_MAX_RUNS 8
+#define SD_FAT_NAME_SIZE 11
+#define SD_FAT_DATE(year, month, day) ((uint16_t)((((year) - 1980) << 9) | ((month) << 5) | (day)))
+#define SD_FAT_DEFAULT_DATE SD_FAT_DATE(2026, 10, 19)   // There is no RTC on the board
+
+// FAT32 values
+#define SD_FAT_FREE_CLUSTER 0x00000000UL
+#define SD_FAT_END_OF_CHAIN 0x0FFFFFFFUL
+#define SD_FAT_CLUSTER_MASK 0x0FFFFFFFUL
+#define SD_FAT_DIR_ENTRY_SIZE 32
+#define SD_FAT_ATTR_LONG_NAME 0x0F
+#define SD_FAT_ATTR_ARCHIVE 0x20
+
+// Recording files
+// A record file gets a contiguous run of clusters when it is created (the whole chain is
+// written on the FAT once) and then its sectors are sent one after the other on the same
+// multiple block write of the card (stream), without FAT nor directory updates. The size of
+// the directory entry is only written on the checkpoints, and the clusters that were not
+// used are freed when it is closed. After a power cut the file has the size of the last
+// checkpoint (and the rest of the run is still allocated to it).
+#define SD_RECORD_MIN_CLUSTERS 8        // Smaller runs are not taken
+
+// Block device: SPI card on the target (sdcard.c) or a disk image on the host.
+// The stream functions are optional (NULL): without them every sector is a write.
+typedef struct{
+
+    bool (*read)(uint32_t lba, uint8_t *buffer, uint32_t count);
+    bool (*write)(uint32_t lba, const uint8_t *buffer, uint32_t count);
+    bool (*stream_start)(uint32_t lba);
+    bool (*stream_write)(const uint8_t *buffer);
+    bool (*stream_stop)(void);
+}tSDBlockDevice;
+
+typedef struct{
+
+    const tSDBlockDevice *device;
+    uint32_t partition_lba;
+    uint32_t fat_lba;               // First FAT
+    uint32_t sectors_per_fat;
+    uint8_t num_fats;
+    uint8_t sectors_per_cluster;
+    uint32_t cluster_lba;           // First sector of cluster 2
+    uint32_t root_cluster;
+    uint32_t num_clusters;          // Clusters of the data region
+    uint32_t fsinfo_lba;
+    uint32_t next_free;             // Where the search of free clusters starts
+    bool mounted;
+    // Sector used for the FAT, the directory and FSInfo (read-modify-write)
+    uint8_t sector[SD_SECTOR_SIZE];
+    uint32_t sector_lba;
+    bool sector_valid;
+    bool sector_dirty;
+}tSDVolume;
+
+typedef struct{
+
+    uint32_t start;                 // First cluster of the run
+    uint32_t length;
+}tSDClusterRun;
+
+typedef struct{
+
+    uint8_t name[SD_FAT_NAME_SIZE];
+    uint32_t first_cluster;
+    uint32_t size;
+    uint32_t dir_lba;               // Sector and offset of the directory entry
+    uint16_t dir_offset;
+    // Write position: sector next_sector of current_cluster
+    uint32_t current_cluster;
+    uint8_t next_sector;
+    // Sectors waiting to be written and their LBA
+    uint8_t buffer[SD_FILE_BUFFER_SECTORS*SD_SECTOR_SIZE];
+    uint32_t buffer_lba[SD_FILE_BUFFER_SECTORS];
+    uint16_t buffered;
+    // Clusters allocated but not linked on the FAT yet
+    uint32_t link_from;             // Last cluster of the chain on the FAT (0 if the file was empty)
+    tSDClusterRun new_runs[SD_FAT_MAX_RUNS];
+    uint8_t num_runs;
+    uint32_t new_clusters;          // Allocated since the last update of FSInfo
+    bool open;
+}tSDFile;
+
+typedef struct{
+
+    uint32_t first_cluster;
+    uint32_t clusters;              // Length of the run
+    uint32_t first_lba;
+    uint32_t capacity;              // Sectors of the run
+    uint32_t written;               // Sectors written
+    uint32_t checkpoint;            // Sectors on the size of the directory entry
+    uint32_t dir_lba;
+    uint16_t dir_offset;
+    bool streaming;                 // Multiple block write open on the card
+    bool open;
+}tSDRecord;
+
+bool mount_SDvolume(tSDVolume *volume, const tSDBlockDevice *device);
+bool open_SDfile(tSDVolume *volume, tSDFile *file, const char name[SD_FAT_NAME_SIZE]);
+bool write_SDfile(tSDVolume *volume, tSDFile *file, const void *data, uint32_t size);
+bool sync_SDfile(tSDVolume *volume, tSDFile *file);
+bool close_SDfile(tSDVolume *volume, tSDFile *file);
+bool find_SDfile(tSDVolume *volume, const char name[SD_FAT_NAME_SIZE]);
+bool read_SDfatEntry(tSDVolume *volume, uint32_t cluster, uint32_t *value);
+bool flush_SDsectorCache(tSDVolume *volume);
+uint32_t SD_cluster2lba(const tSDVolume *volume, uint32_t cluster);
+bool open_SDrecord(tSDVolume *volume, tSDRecord *record, const char name[SD_FAT_NAME_SIZE], uint32_t clusters);
+bool write_SDrecord(tSDVolume *volume, tSDRecord *record, const uint8_t *sectors, uint32_t count);
+bool checkpoint_SDrecord(tSDVolume *volume, tSDRecord *record);
+bool close_SDrecord(tSDVolume *volume, tSDRecord *record);
+
+#endif /* SD_FAT_H_ */
@@ -0,0 +1,72 @@
+/*
+ * SD_spi.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      It does not include the headers of the microcontroller, the registers are given by
+ *      sdcard.c, so it is also compiled on the host against a simulated SSI (Host/SD_spi).
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Programmer libraries
+#include "SD_spi.h"
+
+
+// One byte out and the byte that comes in at the same time (commands and tokens)
+uint8_t exchange_SPIbyte(tSPIRegisters *port, uint8_t value){
+
+    while ((SPI_STATUS(port) & SD_SPI_SR_TNF) == 0){};
+    SPI_SEND(port, value);
+    while ((SPI_STATUS(port) & SD_SPI_SR_RNE) == 0){};
+
+    return SPI_RECEIVE(port);
+}
+
+// Receive length bytes sending 0xFF. The receive FIFO has to be empty before.
+void receive_SPIblock(tSPIRegisters *port, uint8_t *buffer, uint16_t length){
+
+    uint16_t sent = 0, received = 0;
+
+    while (received < length){
+
+        while ((sent < length) && ((uint16_t)(sent - received) < SD_SPI_FIFO_DEPTH)
+                && (SPI_STATUS(port) & SD_SPI_SR_TNF)){
+
+            SPI_SEND(port, 0xFF);
+            sent++;
+        }
+        while ((received < sent) && (SPI_STATUS(port) & SD_SPI_SR_RNE)){
+
+            buffer[received++] = SPI_RECEIVE(port);
+        }
+    }
+}
+
+// Send length bytes and discard what comes in. It returns when the last byte is on the card.
+void send_SPIblock(tSPIRegisters *port, const uint8_t *buffer, uint16_t length){
+
+    uint16_t sent = 0, received = 0;
+
+    while (received < length){
+
+        while ((sent < length) && ((uint16_t)(sent - received) < SD_SPI_FIFO_DEPTH)
+                && (SPI_STATUS(port) & SD_SPI_SR_TNF)){
+
+            SPI_SEND(port, buffer[sent++]);
+        }
+        while ((received < sent) && (SPI_STATUS(port) & SD_SPI_SR_RNE)){
+
+            (void)SPI_RECEIVE(port);
+            received++;
+        }
+    }
+}
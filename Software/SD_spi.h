@@ -0,0 +1,55 @@
+/*
+ * SD_spi.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef SD_SPI_H_
+#define SD_SPI_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Block transfers of the SD card (data of the sectors)
+// The SSI registers are taken once per block and the transmit FIFO is kept full: a byte is
+// sent while the previous ones are on the line, without a wait per byte. There are never more
+// bytes on the way than the receive FIFO holds, so none is lost.
+#define SD_SPI_FIFO_DEPTH 8
+#define SD_SPI_SR_TNF 0x00000002        // Transmit FIFO not full
+#define SD_SPI_SR_RNE 0x00000004        // Receive FIFO not empty
+
+// First registers of an SSI module (SSICR0 to SSISR)
+typedef struct{
+
+    volatile uint32_t CR0;
+    volatile uint32_t CR1;
+    volatile uint32_t DR;
+    volatile uint32_t SR;
+}tSPIRegisters;
+
+// The host test (Host/SD_spi) builds with SD_SPI_HOST and a simulated SSI and card
+#ifdef SD_SPI_HOST
+uint32_t sim_SPIstatus(tSPIRegisters *port);
+void sim_SPIsend(tSPIRegisters *port, uint8_t value);
+uint8_t sim_SPIreceive(tSPIRegisters *port);
+#define SPI_STATUS(port) sim_SPIstatus(port)
+#define SPI_SEND(port, value) sim_SPIsend(port, value)
+#define SPI_RECEIVE(port) sim_SPIreceive(port)
+#else
+#define SPI_STATUS(port) ((port)->SR)
+#define SPI_SEND(port, value) ((port)->DR = (value))
+#define SPI_RECEIVE(port) ((uint8_t)(port)->DR)
+#endif
+
+uint8_t exchange_SPIbyte(tSPIRegisters *port, uint8_t value);
+void receive_SPIblock(tSPIRegisters *port, uint8_t *buffer, uint16_t length);
+void send_SPIblock(tSPIRegisters *port, const uint8_t *buffer, uint16_t length);
+
+#endif /* SD_SPI_H_ */
@@ -0,0 +1,456 @@
+/*
+ * SD_writer.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+// Programmer libraries
+#include "CAN_device.h"
+#include "DTC_monitor.h"
+#include "SD_fat.h"
+#include "SD_device.h"
+#include "SD_writer.h"
+#include "Live_logger.h"
+
+// Global variables
+static const char SD_file_names[SD_NUM_FILES][SD_FAT_NAME_SIZE+1] = SD_FILE_NAMES;
+static tSDVolume SD_volume;
+static tSDFile SD_file;
+static uint8_t open_file = SD_NO_FILE;     // File on SD_file
+static tSDRecord SD_log;
+static char log_name[SD_FAT_NAME_SIZE+1] = SD_LOG_NAME;
+static uint16_t log_number = 0;
+static uint32_t log_blocks = 0;
+static TickType_t log_write_ticks = 0;    // Inside write_SDrecord and checkpoint_SDrecord
+static uint32_t SD_read_speed = 0;        // kB/s
+static uint32_t SD_write_speed = 0;
+static bool log_started = false;          // Between SD_JOB_LOG_START and SD_JOB_LOG_STOP
+static bool log_capture = false;          // CAPTnnnn.BIN instead of LIVEnnnn.BIN
+static bool SD_mounted = false;
+static uint32_t SD_drops = 0;
+static QueueHandle_t SD_queue = NULL;
+static TaskHandle_t SD_writer_taskHandler = NULL;
+
+
+static bool start_SDcard(void){
+
+    start_SDdevice();
+
+    return mount_SDvolume(&SD_volume, &SD_card);
+}
+
+static bool close_file(void){
+
+    bool closed = true;
+
+    if (open_file != SD_NO_FILE){
+
+        closed = close_SDfile(&SD_volume, &SD_file);
+        open_file = SD_NO_FILE;
+    }
+
+    return closed;
+}
+
+static bool write_line(const char line[]){
+
+    return write_SDfile(&SD_volume, &SD_file, line, strlen(line));
+}
+
+static void count_drop(void){
+
+    taskENTER_CRITICAL();
+    SD_drops++;
+    taskEXIT_CRITICAL();
+}
+
+// The session events are formatted here and not on the task that sends them
+static void format_SDjob(tSDWriterJob *job){
+
+    char line[SD_WRITER_LINE_CHARS];
+
+    if (job->type != SD_JOB_SESSION){
+
+        return;
+    }
+    snprintf(line, sizeof(line), "%lu %.*s %lX\r\n", (unsigned long)job->timestamp*portTICK_PERIOD_MS,
+             SD_WRITER_EVENT_CHARS, job->data.line, (unsigned long)job->value);
+    strcpy(job->data.line, line);
+    job->type = SD_JOB_LINE;
+    job->file = SD_FILE_SESSION;
+}
+
+// Keep the file open on SD_file, closing the previous one
+static bool use_file(uint8_t file){
+
+    if (open_file == file){
+
+        return true;
+    }
+    // The stream of the log is closed before any other access to the card
+    if ((SD_log.streaming) && (!checkpoint_SDrecord(&SD_volume, &SD_log))){
+
+        return false;
+    }
+    if ((open_file != SD_NO_FILE) && (!close_file())){
+
+        return false;
+    }
+    if (!open_SDfile(&SD_volume, &SD_file, SD_file_names[file])){
+
+        return false;
+    }
+    open_file = file;
+
+    return true;
+}
+
+// One line per DTC on the file of its system and a summary on the session log
+static bool write_DTCreport(const tSDWriterJob *job){
+
+    char line[SD_WRITER_LINE_CHARS];
+    unsigned long time_ms = (unsigned long)job->timestamp*portTICK_PERIOD_MS;
+    const char *list = job->pending ? "pending" : "stored";
+
+    for (uint8_t file = 0; file < SD_FILE_SESSION; file++){
+
+        for (int i = 0; i < job->data.DTCs.numDTCs; i++){
+
+            if (get_DTCfile(job->data.DTCs.codes[i]) != file){
+
+                continue;
+            }
+            snprintf(line, sizeof(line), "%lu %s %s %s\r\n", time_ms, job->ECU_name, job->data.DTCs.codes[i], list);
+            if ((!use_file(file)) || (!write_line(line))){
+
+                return false;
+            }
+        }
+    }
+
+    snprintf(line, sizeof(line), "%lu %s %d %s DTCs\r\n", time_ms, job->ECU_name, job->data.DTCs.numDTCs, list);
+
+    return use_file(SD_FILE_SESSION) && write_line(line);
+}
+
+// "time_ms name speed kB/s" on the session log
+static bool write_SDspeed(const char name[], uint32_t sectors, TickType_t ticks, uint32_t *speed){
+
+    char line[SD_WRITER_LINE_CHARS];
+    uint32_t time_ms = ticks*portTICK_PERIOD_MS;
+
+    *speed = sectors*500/((time_ms == 0) ? 1 : time_ms);
+    snprintf(line, sizeof(line), "%lu %s %lu kB/s\r\n", (unsigned long)xTaskGetTickCount()*portTICK_PERIOD_MS,
+             name, (unsigned long)*speed);
+
+    return use_file(SD_FILE_SESSION) && write_line(line);
+}
+
+// Read speed of the card after the mount, with the sectors of the FAT two by two (CMD18).
+// The buffer of SD_file is free: no file is open yet.
+static bool measure_SDread(void){
+
+    uint32_t sectors = (SD_volume.sectors_per_fat < SD_WRITER_BENCH_SECTORS) ? SD_volume.sectors_per_fat & ~1UL : SD_WRITER_BENCH_SECTORS;
+    TickType_t start = xTaskGetTickCount();
+
+    for (uint32_t i = 0; i < sectors; i += 2){
+
+        if (!SD_card.read(SD_volume.fat_lba + i, SD_file.buffer, 2)){
+
+            return false;
+        }
+    }
+
+    return write_SDspeed("SD read", sectors, xTaskGetTickCount() - start, &SD_read_speed);
+}
+
+static bool close_log(void){
+
+    if (!SD_log.open){
+
+        return true;
+    }
+    if (!close_SDrecord(&SD_volume, &SD_log)){
+
+        return false;
+    }
+
+    return (log_blocks == 0) || (write_SDspeed("Log write", log_blocks, log_write_ticks, &SD_write_speed));
+}
+
+// New LIVEnnnn.BIN (or CAPTnnnn.BIN), after the last one of the card, with its clusters preallocated
+static bool start_log(void){
+
+    uint32_t clusters = (SD_LOG_PREALLOCATE_SECTORS + SD_volume.sectors_per_cluster - 1) / SD_volume.sectors_per_cluster;
+
+    if ((!close_log()) || (!close_file())){
+
+        return false;
+    }
+
+    while (log_number < SD_LOG_MAX_FILES){
+
+        snprintf(log_name, sizeof(log_name), log_capture ? "CAPT%04uBIN" : "LIVE%04uBIN", log_number);
+        if (!find_SDfile(&SD_volume, log_name)){
+
+            log_blocks = 0;
+            log_write_ticks = 0;
+            return open_SDrecord(&SD_volume, &SD_log, log_name,
+                                 (clusters < SD_RECORD_MIN_CLUSTERS) ? SD_RECORD_MIN_CLUSTERS : clusters);
+        }
+        log_number++;
+    }
+
+    return false;
+}
+
+static bool write_logBlock(uint8_t block){
+
+    const uint8_t *sector = seal_liveLogBlock(block);
+    bool written = close_file();     // Nothing else on the card while the stream is open
+    TickType_t start;
+
+    // The run is full (or the card was mounted again): the recording goes on in a new file
+    if ((written) && (SD_log.open) && (SD_log.written == SD_log.capacity)){
+
+        written = close_log();
+    }
+    if ((written) && (!SD_log.open)){
+
+        written = start_log();
+    }
+    start = xTaskGetTickCount();
+    written = written && write_SDrecord(&SD_volume, &SD_log, sector, 1);
+    release_liveLogBlock(block);
+
+    // Checkpoint: the blocks written until now can be read after a power cut
+    if ((written) && ((++log_blocks % LIVE_LOGGER_SYNC_BLOCKS) == 0)){
+
+        written = checkpoint_SDrecord(&SD_volume, &SD_log);
+    }
+    log_write_ticks += xTaskGetTickCount() - start;
+
+    return written;
+}
+
+static bool write_SDjob(tSDWriterJob *job){
+
+    switch(job->type){
+
+        case SD_JOB_DTC_REPORT:
+            return write_DTCreport(job);
+
+        case SD_JOB_SESSION:
+        case SD_JOB_LINE:
+            format_SDjob(job);
+            return use_file(job->file) && write_line(job->data.line);
+
+        case SD_JOB_LOG_START:
+            log_capture = (job->value != 0);
+            log_started = start_log();
+            return log_started;
+
+        case SD_JOB_LOG_BLOCK:
+            if (!log_started){
+
+                release_liveLogBlock(job->value);
+                return true;
+            }
+            return write_logBlock(job->value);
+
+        case SD_JOB_LOG_STOP:
+            log_started = false;
+            return close_log();
+    }
+
+    return true;
+}
+
+static portTASK_FUNCTION(SD_writer, pvParameters){
+
+    tSDWriterJob job;
+    TickType_t wait;
+
+    init_SDdevice();
+
+    while(1){
+
+        if (!SD_mounted){
+
+            SD_mounted = start_SDcard() && measure_SDread();
+            if (!SD_mounted){
+
+                // Without card the jobs are left on the queue (and the new ones dropped)
+                vTaskDelay(SD_WRITER_MOUNT_RETRY_MS/portTICK_PERIOD_MS);
+                continue;
+            }
+        }
+
+        // A text file is closed (FAT and directory updated) when there are no more
+        // jobs. The log is kept open until the end of the recording.
+        wait = (open_file == SD_NO_FILE) ? portMAX_DELAY : 0;
+        if (xQueueReceive(SD_queue, &job, wait) != pdTRUE){
+
+            if (!close_file()){
+
+                SD_mounted = false;
+            }
+            continue;
+        }
+
+        if (!write_SDjob(&job)){
+
+            // Card removed, full or root directory full. The file is opened again after the mount
+            // and the recording goes on in a new log (the old one keeps the last checkpoint).
+            open_file = SD_NO_FILE;
+            SD_log.open = false;
+            SD_log.streaming = false;
+            SD_mounted = false;
+            count_drop();
+        }
+    }
+}
+
+void init_SDwriter(void){
+
+    SD_queue = xQueueCreate(SD_WRITER_QUEUE_LENGTH, sizeof(tSDWriterJob));
+    configASSERT(SD_queue);
+
+    if ((xTaskCreate(SD_writer, (portCHAR *)"SD_WRITER", 400, NULL,tskIDLE_PRIORITY + 0, &SD_writer_taskHandler) != pdTRUE)){
+
+            while(1);
+    }
+}
+
+static bool post_SDjob(const tSDWriterJob *job){
+
+    if (SD_queue == NULL){
+
+        return false;
+    }
+
+    if (xQueueSend(SD_queue, job, 0) != pdTRUE){
+
+        count_drop();
+        return false;
+    }
+
+    return true;
+}
+
+// Queue a line (with its end of line) for the file. It never blocks: if the queue
+// is full the line is dropped and counted.
+bool post_SDline(uint8_t file, const char line[]){
+
+    tSDWriterJob job;
+
+    if (file >= SD_NUM_FILES){
+
+        return false;
+    }
+
+    job.type = SD_JOB_LINE;
+    job.file = file;
+    job.timestamp = xTaskGetTickCount();
+    strncpy(job.data.line, line, SD_WRITER_LINE_CHARS-1);
+    job.data.line[SD_WRITER_LINE_CHARS-1] = '\0';
+
+    return post_SDjob(&job);
+}
+
+// Queue the DTC list of the ECU. ECU_name has to be a constant string.
+bool post_DTCreport(const char ECU_name[], const tDTCList *DTCs, bool pending){
+
+    tSDWriterJob job;
+
+    job.type = SD_JOB_DTC_REPORT;
+    job.pending = pending;
+    job.ECU_name = ECU_name;
+    job.timestamp = xTaskGetTickCount();
+    job.data.DTCs = *DTCs;
+
+    return post_SDjob(&job);
+}
+
+// Queue a job of the live data logger (start, full block or stop)
+bool post_SDlog(uint8_t type, uint8_t block){
+
+    tSDWriterJob job;
+
+    job.type = type;
+    job.value = block;
+    job.timestamp = xTaskGetTickCount();
+
+    return post_SDjob(&job);
+}
+
+// Queue a line "time_ms event value" for the session log
+bool post_SDsession(const char event[], uint32_t value){
+
+    tSDWriterJob job;
+
+    job.type = SD_JOB_SESSION;
+    job.value = value;
+    job.timestamp = xTaskGetTickCount();
+    strncpy(job.data.line, event, SD_WRITER_EVENT_CHARS);
+    job.data.line[SD_WRITER_EVENT_CHARS] = '\0';
+
+    return post_SDjob(&job);
+}
+
+// File of the system of the DTC: P powertrain, C chassis, B body and U network
+uint8_t get_DTCfile(const char DTC[]){
+
+    switch(DTC[0]){
+
+        case 'C':
+            return SD_FILE_CHASSIS;
+
+        case 'B':
+            return SD_FILE_BODY;
+
+        case 'U':
+            return SD_FILE_NETWORK;
+
+        default:
+            return SD_FILE_POWERTRAIN;
+    }
+}
+
+uint32_t get_SDwriterDrops(void){
+
+    return SD_drops;
+}
+
+bool is_SDmounted(void){
+
+    return SD_mounted;
+}
+
+// Speeds measured on the card (kB/s): reads after the mount, writes of the last log
+uint32_t get_SDreadSpeed(void){
+
+    return SD_read_speed;
+}
+
+uint32_t get_SDwriteSpeed(void){
+
+    return SD_write_speed;
+}
@@ -0,0 +1,84 @@
+/*
+ * SD_writer.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+#ifndef SD_WRITER_H_
+#define SD_WRITER_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Writer configuration
+// The CAN tasks only copy a line or a DTC list on the queue (without waiting). The writer
+// task keeps the file open while the following jobs go to the same file and closes it
+// (FAT and directory update) when the queue is empty or the next job is for another file.
+// A DTC report opens every file of a system once for all its codes. The live data log
+// is a record file (SD_fat.h) with SD_LOG_PREALLOCATE_SECTORS preallocated: it stays open
+// from SD_JOB_LOG_START to SD_JOB_LOG_STOP and the blocks go on the same multiple block
+// write of the card until a checkpoint or a job for another file. When the run is full the
+// recording goes on in the next LIVEnnnn.BIN. A capture of the frames (Live_logger.h) is
+// recorded the same way on CAPTnnnn.BIN.
+#define SD_WRITER_LINE_CHARS 48
+#define SD_WRITER_EVENT_CHARS 24     // Of a session event: the line adds the time (10), the value (8), 2 spaces and "\r\n"
+#define SD_WRITER_QUEUE_LENGTH 4
+#define SD_WRITER_MOUNT_RETRY_MS 10000
+#define SD_WRITER_BENCH_SECTORS 256     // Read speed test after every mount (sectors of the FAT)
+
+// Files of the root directory (8.3 names)
+#define SD_FILE_POWERTRAIN 0
+#define SD_FILE_CHASSIS 1
+#define SD_FILE_BODY 2
+#define SD_FILE_NETWORK 3
+#define SD_FILE_SESSION 4
+#define SD_NUM_FILES 5
+#define SD_FILE_NAMES {"POWERTR TXT", "CHASSIS TXT", "BODY    TXT", "NETWORK TXT", "SESSION LOG"}
+#define SD_NO_FILE 0xFF
+#define SD_LOG_NAME "LIVE0000BIN"
+#define SD_LOG_MAX_FILES 10000
+#define SD_LOG_PREALLOCATE_SECTORS 4096     // 2 MB (about 170000 records)
+
+// Jobs
+#define SD_JOB_LINE 0
+#define SD_JOB_DTC_REPORT 1
+#define SD_JOB_SESSION 2
+#define SD_JOB_LOG_START 3
+#define SD_JOB_LOG_BLOCK 4
+#define SD_JOB_LOG_STOP 5
+
+typedef struct{
+
+    uint8_t type;
+    uint8_t file;                       // SD_JOB_LINE
+    bool pending;                       // SD_JOB_DTC_REPORT: Mode 07 list
+    const char *ECU_name;               // SD_JOB_DTC_REPORT
+    uint32_t value;                     // SD_JOB_SESSION: printed after the event, SD_JOB_LOG_BLOCK: block,
+                                        // SD_JOB_LOG_START: 1 for a capture
+    TickType_t timestamp;
+    union{
+
+        char line[SD_WRITER_LINE_CHARS];
+        tDTCList DTCs;
+    }data;
+}tSDWriterJob;
+
+void init_SDwriter(void);
+bool post_SDline(uint8_t file, const char line[]);
+bool post_DTCreport(const char ECU_name[], const tDTCList *DTCs, bool pending);
+bool post_SDsession(const char event[], uint32_t value);
+bool post_SDlog(uint8_t type, uint8_t block);
+uint8_t get_DTCfile(const char DTC[]);
+uint32_t get_SDwriterDrops(void);
+bool is_SDmounted(void);
+uint32_t get_SDreadSpeed(void);
+uint32_t get_SDwriteSpeed(void);
+
+#endif /* SD_WRITER_H_ */
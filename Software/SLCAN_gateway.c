@@ -0,0 +1,450 @@
+/*
+ * SLCAN_gateway.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// TIVA libraries
+#include "inc/hw_memmap.h"
+#include "driverlib/can.h"
+#include "driverlib/sysctl.h"
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Programmer libraries
+#include "CAN_device.h"
+#include "SLCAN_gateway.h"
+
+#define STANDARD_ID_MASK 0x7FF
+#define EXTENDED_ID_MASK 0x1FFFFFFF
+#define BELL "\a"
+
+// Flags of the F command
+#define FLAG_RX_FULL 0x01
+#define FLAG_TX_FULL 0x02
+#define FLAG_WARNING 0x04
+#define FLAG_OVERRUN 0x08
+#define FLAG_PASSIVE 0x20
+#define FLAG_BUS_ERROR 0x80
+
+// S0 to S8
+static const uint32_t bit_rates[] = {10000, 20000, 50000, 100000, 125000, 250000, 500000, 800000, 1000000};
+static const char hex_digits[] = "0123456789ABCDEF";
+
+// Global variables
+static tSLCANWrite SLCAN_write;
+static tSLCANStats SLCAN_stats;
+static uint32_t bit_rate = BIT_RATE;
+static bool channel_open = false, listen_only = false;
+static volatile bool timestamps = false;
+// Text of the frames (written by CANIntHandler and by the task in a critical section)
+static uint8_t *text_ring = NULL;
+static volatile uint32_t text_write = 0, text_read = 0;
+// Message objects of the transmission waiting for the bus (bit per object) and next one to fill
+static volatile uint32_t tx_busy = 0;
+static uint32_t tx_next = 0;
+static uint32_t tx_bits[SLCAN_TX_OBJECTS];
+// Counters already given by the F command
+static uint32_t flagged_dropped = 0, flagged_tx_dropped = 0, flagged_overruns = 0;
+
+
+// Bits of a frame on the bus without the stuff bits, like CAN_frameBits of CAN_device.c
+static uint32_t frame_bits(uint32_t length, bool extended){
+
+    return (extended ? 67 : 47) + 8*length;
+}
+
+// All or nothing, so the PC never gets half a frame
+static bool put_text(const char text[], uint32_t length){
+
+    if ((text_ring == NULL) || (length > SLCAN_TEXT_BUFFER - (text_write - text_read))){
+
+        return false;
+    }
+    for (uint32_t i = 0; i < length; i++){
+
+        text_ring[(text_write + i) % SLCAN_TEXT_BUFFER] = text[i];
+    }
+    text_write += length;
+
+    return true;
+}
+
+// Answers of the task go among the frames of the interrupt
+static void reply(const char text[]){
+
+    taskENTER_CRITICAL();
+    put_text(text, strlen(text));
+    taskEXIT_CRITICAL();
+}
+
+static char *put_hex(char *text, uint32_t value, uint8_t digits){
+
+    for (int8_t i = digits - 1; i >= 0; i--){
+
+        *text++ = hex_digits[(value >> (4*i)) & 0xF];
+    }
+
+    return text;
+}
+
+// Value of the hex digits, false if one is not a digit
+static bool get_hex(const char *text, uint8_t digits, uint32_t *value){
+
+    *value = 0;
+    for (uint8_t i = 0; i < digits; i++){
+
+        char c = text[i];
+
+        if ((c >= '0') && (c <= '9')){
+
+            *value = (*value << 4) | (c - '0');
+        }else if ((c >= 'A') && (c <= 'F')){
+
+            *value = (*value << 4) | (c - 'A' + 10);
+        }else if ((c >= 'a') && (c <= 'f')){
+
+            *value = (*value << 4) | (c - 'a' + 10);
+        }else {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void set_objects(bool on){
+
+    tCANMsgObject message;
+    static uint8_t data[8];
+
+    for (uint32_t i = 0; i < SLCAN_RX_OBJECTS; i++){
+
+        if (on){
+            // Every ID of 11 and 29 bits (the IDE bit is not filtered). All but the last one
+            // are chained to the next one.
+            message.ui32MsgID = 0;
+            message.ui32MsgIDMask = 0;
+            message.ui32Flags = MSG_OBJ_RX_INT_ENABLE | MSG_OBJ_USE_ID_FILTER |
+                                ((i < SLCAN_RX_OBJECTS - 1) ? MSG_OBJ_FIFO : 0);
+            message.ui32MsgLen = 8;
+            message.pui8MsgData = data;
+            CANMessageSet(CAN0_BASE, SLCAN_FIRST_RX_OBJECT + i, &message, MSG_OBJ_TYPE_RX);
+        }else {
+
+            CANMessageClear(CAN0_BASE, SLCAN_FIRST_RX_OBJECT + i);
+        }
+    }
+    if (!on){
+
+        for (uint32_t i = 0; i < SLCAN_TX_OBJECTS; i++){
+
+            CANMessageClear(CAN0_BASE, SLCAN_FIRST_TX_OBJECT + i);
+        }
+        tx_busy = 0;
+        tx_next = 0;
+    }
+}
+
+static bool open_channel(bool silent){
+
+    if (channel_open){
+
+        return false;
+    }
+    // The reception of the OBD protocol would take the frames of its ID
+    CANMessageClear(CAN0_BASE, RXOBJECT);
+    CANBitRateSet(CAN0_BASE, SysCtlClockGet(), bit_rate);
+    set_CANsilent(silent);
+    listen_only = silent;
+    set_objects(true);
+    channel_open = true;
+
+    return true;
+}
+
+static bool close_channel(void){
+
+    if (!channel_open){
+
+        return false;
+    }
+    set_objects(false);
+    set_CANsilent(false);
+    CANBitRateSet(CAN0_BASE, SysCtlClockGet(), BIT_RATE);
+    channel_open = false;
+
+    return true;
+}
+
+// Next message object of the transmission. The frames of the PC keep their order, so when the
+// last one is used the first one waits until all of them are sent.
+static bool send_frame(uint32_t ID, bool extended, uint8_t data[], uint8_t length){
+
+    tCANMsgObject message;
+    TickType_t start = xTaskGetTickCount();
+
+    if (tx_next == SLCAN_TX_OBJECTS){
+
+        while (tx_busy != 0){
+
+            if ((xTaskGetTickCount() - start)*portTICK_PERIOD_MS >= SLCAN_TX_TIMEOUT_MS){
+
+                SLCAN_stats.tx_dropped++;
+                return false;
+            }
+            SLCAN_service();
+            vTaskDelay(1);
+        }
+        tx_next = 0;
+    }
+
+    taskENTER_CRITICAL();
+    tx_busy |= 1UL << tx_next;
+    tx_bits[tx_next] = frame_bits(length, extended);
+    taskEXIT_CRITICAL();
+
+    message.ui32MsgID = ID;
+    message.ui32MsgIDMask = 0;
+    message.ui32Flags = MSG_OBJ_TX_INT_ENABLE | (extended ? MSG_OBJ_EXTENDED_ID : 0);
+    message.ui32MsgLen = length;
+    message.pui8MsgData = data;
+    CANMessageSet(CAN0_BASE, SLCAN_FIRST_TX_OBJECT + tx_next, &message, MSG_OBJ_TYPE_TX);
+    tx_next++;
+
+    return true;
+}
+
+// t or T: ID, length and the bytes, all in hex
+static bool command_frame(const char *line){
+
+    bool extended = (line[0] == 'T');
+    uint8_t digits = extended ? 8 : 3;
+    uint32_t ID, length, byte;
+    uint8_t data[8];
+
+    if ((!channel_open) || listen_only || (strlen(line) < 1 + digits + 1u) || (!get_hex(line + 1, digits, &ID)) ||
+        (ID > (extended ? EXTENDED_ID_MASK : STANDARD_ID_MASK)) || (!get_hex(line + 1 + digits, 1, &length)) ||
+        (length > 8) || (strlen(line) != 1 + digits + 1 + 2*length)){
+
+        return false;
+    }
+    for (uint32_t i = 0; i < length; i++){
+
+        if (!get_hex(line + 2 + digits + 2*i, 2, &byte)){
+
+            return false;
+        }
+        data[i] = (uint8_t)byte;
+    }
+
+    return send_frame(ID, extended, data, (uint8_t)length);
+}
+
+// F: the errors since the last F
+static void command_flags(void){
+
+    tCANStats CAN;
+    uint8_t flags = 0;
+    char text[5] = "F";
+
+    get_CANstats(&CAN);
+    flags |= (SLCAN_stats.rx_dropped != flagged_dropped) ? FLAG_RX_FULL : 0;
+    flags |= (SLCAN_stats.tx_dropped != flagged_tx_dropped) ? FLAG_TX_FULL : 0;
+    flags |= (CAN.status & CAN_STATUS_EWARN) ? FLAG_WARNING : 0;
+    flags |= (SLCAN_stats.rx_overruns != flagged_overruns) ? FLAG_OVERRUN : 0;
+    flags |= CAN.passive ? FLAG_PASSIVE : 0;
+    flags |= (CAN.status & CAN_STATUS_BUS_OFF) ? FLAG_BUS_ERROR : 0;
+    flagged_dropped = SLCAN_stats.rx_dropped;
+    flagged_tx_dropped = SLCAN_stats.tx_dropped;
+    flagged_overruns = SLCAN_stats.rx_overruns;
+
+    put_hex(text + 1, flags, 2);
+    text[3] = '\r';
+    text[4] = '\0';
+    reply(text);
+}
+
+bool init_SLCAN(tSLCANWrite write){
+
+    text_ring = (uint8_t *)pvPortMalloc(SLCAN_TEXT_BUFFER);
+    if (text_ring == NULL){
+
+        return false;
+    }
+    SLCAN_write = write;
+    memset(&SLCAN_stats, 0, sizeof(SLCAN_stats));
+    flagged_dropped = flagged_tx_dropped = flagged_overruns = 0;
+    text_write = text_read = 0;
+    bit_rate = BIT_RATE;
+    timestamps = false;
+    channel_open = false;
+
+    return true;
+}
+
+void end_SLCAN(void){
+
+    uint8_t *ring = text_ring;
+
+    close_channel();
+    // The interrupt of a frame already received can not write on it any more
+    taskENTER_CRITICAL();
+    text_ring = NULL;
+    taskEXIT_CRITICAL();
+    vPortFree(ring);
+}
+
+void SLCAN_command(const char *line){
+
+    bool done = false;
+    uint32_t value;
+
+    SLCAN_stats.commands++;
+    switch (line[0]){
+
+    case 'S':
+        if ((!channel_open) && (strlen(line) == 2) && (line[1] >= '0') && (line[1] <= '8')){
+
+            bit_rate = bit_rates[line[1] - '0'];
+            done = true;
+        }
+        break;
+    case 'O':
+    case 'L':
+        done = (line[1] == '\0') && open_channel(line[0] == 'L');
+        break;
+    case 'C':
+        done = (line[1] == '\0') && close_channel();
+        break;
+    case 't':
+    case 'T':
+        if (command_frame(line)){
+
+            reply((line[0] == 't') ? "z\r" : "Z\r");
+            return;
+        }
+        break;
+    case 'F':
+        if (line[1] == '\0'){
+
+            command_flags();
+            return;
+        }
+        break;
+    case 'V':
+        reply(SLCAN_VERSION "\r");
+        return;
+    case 'N':
+        reply(SLCAN_SERIAL "\r");
+        return;
+    case 'Z':
+        if ((!channel_open) && (strlen(line) == 2) && get_hex(line + 1, 1, &value) && (value <= 1)){
+
+            timestamps = (value == 1);
+            done = true;
+        }
+        break;
+    case 'M':
+    case 'm':
+        // Acceptance code and mask: every frame is received anyway
+        done = (strlen(line) == 9) && get_hex(line + 1, 8, &value);
+        break;
+    default:
+        break;
+    }
+    if (done){
+
+        reply("\r");
+    }else {
+
+        SLCAN_stats.errors++;
+        reply(BELL);
+    }
+}
+
+void SLCAN_service(void){
+
+    uint32_t pending, offset, block;
+
+    while ((pending = text_write - text_read) > 0){
+
+        offset = text_read % SLCAN_TEXT_BUFFER;
+        block = (pending < SLCAN_TEXT_BUFFER - offset) ? pending : SLCAN_TEXT_BUFFER - offset;
+        block = (block < SLCAN_BLOCK) ? block : SLCAN_BLOCK;
+        if (SLCAN_write(text_ring + offset, block) == 0){
+
+            break;
+        }
+        text_read += block;
+    }
+}
+
+uint32_t SLCAN_CANinterrupt(uint32_t object){
+
+    tCANMsgObject message;
+    uint8_t data[16];                   // CANMessageGet copies up to 15 bytes with a DLC over 8
+    char text[SLCAN_LINE_CHARS], *end;
+    bool extended;
+    uint32_t index, length;
+
+    if (object >= SLCAN_FIRST_TX_OBJECT){
+
+        index = object - SLCAN_FIRST_TX_OBJECT;
+        CANIntClear(CAN0_BASE, object);
+        tx_busy &= ~(1UL << index);
+        SLCAN_stats.tx_frames++;
+
+        return tx_bits[index];
+    }
+
+    message.pui8MsgData = data;
+    CANMessageGet(CAN0_BASE, object, &message, true);
+    if (message.ui32Flags & MSG_OBJ_DATA_LOST){
+
+        SLCAN_stats.rx_overruns++;
+    }
+    extended = (message.ui32Flags & MSG_OBJ_EXTENDED_ID) != 0;
+    // A DLC of 9 to 15 still carries 8 bytes, and the line only has room for them
+    length = (message.ui32MsgLen > 8) ? 8 : message.ui32MsgLen;
+    text[0] = extended ? 'T' : 't';
+    end = put_hex(text + 1, message.ui32MsgID, extended ? 8 : 3);
+    *end++ = hex_digits[length];
+    for (uint32_t i = 0; i < length; i++){
+
+        end = put_hex(end, data[i], 2);
+    }
+    if (timestamps){
+
+        end = put_hex(end, (xTaskGetTickCountFromISR()*portTICK_PERIOD_MS) % 60000, 4);
+    }
+    *end++ = '\r';
+    if (put_text(text, end - text)){
+
+        SLCAN_stats.rx_frames++;
+    }else {
+
+        SLCAN_stats.rx_dropped++;
+    }
+
+    return frame_bits(length, extended);
+}
+
+void get_SLCANstats(tSLCANStats *stats){
+
+    *stats = SLCAN_stats;
+}
@@ -0,0 +1,80 @@
+/*
+ * SLCAN_gateway.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      CAN interface for a PC with the SLCAN (Lawicel) protocol ('slcan' on the shell, Diag_shell.h),
+ *      so slcand and can-utils see the bus of the device:
+ *          slcand -o -s6 -S 2000000 /dev/ttyACM0 can0 && ip link set can0 up && candump can0
+ *      The frames of the bus go to a FIFO of SLCAN_RX_OBJECTS message objects that takes every
+ *      ID. CANIntHandler writes their text ("tIIILDD..\r", "TIIIIIIIILDD..\r" and the time in ms
+ *      with Z1) on a ring of the heap, and the shell gives it to the binary output of uartstdio
+ *      in blocks, so the UART interrupt sends it without a call per frame. The ring shares its
+ *      line of the RAM budget (FreeRTOSConfig.h) with the one of the sniffer: the shell runs one
+ *      of them at a time. At full load 1024 bytes are 10 ms of text at 1 Mbaud. The frames of the PC
+ *      go to SLCAN_TX_OBJECTS message objects, filled in order: the Tiva sends the lowest object
+ *      first, so an object is only used again when all of them are sent and the frames keep the
+ *      order of the PC. At 500 kbit/s and full load the text needs about 1 Mbaud (2000000 with
+ *      the times).
+ *      Commands: S0-S8 (bit rate while closed), O (open), L (open listen only, nothing is
+ *      sent, not even the ACK), C (close), t and T (frames), F (status flags), V and N (version
+ *      and serial number), Z0/Z1 (times), M and m (taken, every ID is received). Remote frames
+ *      (r, R) are not sent and the answer is BELL like for any wrong command.
+ */
+
+#ifndef SLCAN_GATEWAY_H_
+#define SLCAN_GATEWAY_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Message objects of the gateway. The ones of the OBD protocol (RXOBJECT, TXOBJECT) are lower.
+#define SLCAN_FIRST_RX_OBJECT 3
+#define SLCAN_RX_OBJECTS 16                 // FIFO of the reception
+#define SLCAN_FIRST_TX_OBJECT (SLCAN_FIRST_RX_OBJECT + SLCAN_RX_OBJECTS)
+#define SLCAN_TX_OBJECTS 8
+#define SLCAN_FIRST_OBJECT SLCAN_FIRST_RX_OBJECT
+#define SLCAN_LAST_OBJECT (SLCAN_FIRST_TX_OBJECT + SLCAN_TX_OBJECTS - 1)
+
+#define SLCAN_TEXT_BUFFER 1024              // Ring of the frames received, on the heap. A power of 2.
+#define SLCAN_BLOCK 256                     // Largest block given to the output
+#define SLCAN_LINE_CHARS 32                 // Longest command: T, ID, length and 8 bytes
+#define SLCAN_TX_TIMEOUT_MS 100             // Wait for a free message object
+#define SLCAN_VERSION "V1013"
+#define SLCAN_SERIAL "NTIVA"
+
+// Since init_SLCAN
+typedef struct{
+
+    uint32_t rx_frames;                     // Of the bus, to the PC
+    uint32_t rx_dropped;                    // No room on the ring of the text
+    uint32_t rx_overruns;                   // Lost by the FIFO of the message objects
+    uint32_t tx_frames;                     // Of the PC, sent on the bus
+    uint32_t tx_dropped;                    // No free message object in SLCAN_TX_TIMEOUT_MS
+    uint32_t commands;
+    uint32_t errors;                        // Answered with BELL
+}tSLCANStats;
+
+// Output of the text: the length written, 0 if it does not fit now (it is tried again)
+typedef uint32_t (*tSLCANWrite)(const uint8_t data[], uint32_t length);
+
+// The channel starts closed at BIT_RATE. False if there is no memory for the ring.
+bool init_SLCAN(tSLCANWrite write);
+// Closes the channel, the bit rate goes back to BIT_RATE and the ring is freed
+void end_SLCAN(void);
+// A line of the PC without the '\r'. The CAN bus has to be taken by the caller.
+void SLCAN_command(const char *line);
+// Gives the text of the frames received to the output
+void SLCAN_service(void);
+// Interrupt of a message object of the gateway (CANIntHandler). Return the bits of the frame.
+uint32_t SLCAN_CANinterrupt(uint32_t object);
+void get_SLCANstats(tSLCANStats *stats);
+
+#endif /* SLCAN_GATEWAY_H_ */
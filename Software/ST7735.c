@@ -36,6 +36,7 @@ as well as Adafruit raw 1.8" TFT display
 #include "driverlib/ssi.h"
 
 #include "ST7735.h"
+#include "Cycle_probes.h"
 
 //*****************************************************************************
 //
@@ -295,6 +296,7 @@ void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
   uint16_t colour)
 {
   if((x >= width) || (y >= height)) return;
+  uint32_t probe = PROBE_START();
   if((x + w - 1) >= width)  {
     w = width  - x;
   }
@@ -312,6 +314,7 @@ void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
       spiWrite(lo);
     }
   }
+  probe_end(PROBE_LCD_FILL, probe);
 }
 
 // For specific color request
@@ -359,6 +362,28 @@ void invertDisplay(int8_t i)
   writeCommand(i ? ST7735_INVON : ST7735_INVOFF);
 }
 
+// Hardware scrolling. It works on the lines of the frame memory (the long side
+// of the panel), so on landscape rotations it scrolls the screen horizontally.
+// Lines out of the fixed areas form the scrolling area.
+void setScrollArea(uint8_t top_fixed, uint8_t bottom_fixed)
+{
+  writeCommand(ST7735_SCRLAR);
+  writeData(0x00);
+  writeData(top_fixed);
+  writeData(0x00);
+  writeData(SCREEN_HEIGHT - top_fixed - bottom_fixed);
+  writeData(0x00);
+  writeData(bottom_fixed);
+}
+
+// Frame memory line shown on the first line of the scrolling area
+void scrollTo(uint8_t line)
+{
+  writeCommand(ST7735_VSCSAD);
+  writeData(0x00);
+  writeData(line);
+}
+
 
 //*****************************************************************************
 //
@@ -658,6 +683,7 @@ void drawXBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
 }
 
 void drawString(int16_t x, int16_t y, const char *c, uint16_t colour, uint16_t bg, uint8_t size, uint8_t align) {
+  uint32_t probe = PROBE_START();
   cursor_x = x;
   cursor_y = y;
   textsize = size;
@@ -680,7 +706,7 @@ void drawString(int16_t x, int16_t y, const char *c, uint16_t colour, uint16_t b
     }
     c++;
   }
-
+  probe_end(PROBE_LCD_TEXT, probe);
 }
 
 void drawChar(int16_t x, int16_t y, unsigned char c,
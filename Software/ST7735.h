@@ -54,6 +54,8 @@ as well as Adafruit raw 1.8" TFT display
 #define ST7735_RAMRD   0x2E
 
 #define ST7735_PTLAR   0x30
+#define ST7735_SCRLAR  0x33
+#define ST7735_VSCSAD  0x37
 #define ST7735_COLMOD  0x3A
 #define ST7735_MADCTL  0x36
 
@@ -124,6 +126,8 @@ void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
 uint16_t Color565(uint8_t r, uint8_t g, uint8_t b);
 void setRotation(uint8_t m);
 void invertDisplay(int8_t i);
+void setScrollArea(uint8_t top_fixed, uint8_t bottom_fixed);
+void scrollTo(uint8_t line);
 void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t colour);
 void drawCircleHelper( int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t colour);
 void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t colour);
@@ -0,0 +1,70 @@
+/*
+ * Signal_database_data.c
+ *
+ *      Generated by Host/Signal_database/dbc_gen.c from example.dbc, do not edit it.
+ *      5 messages, 18 signals.
+ *      Flash image: 747 bytes.
+ *      Lookup: hash of 16 entries, 3 probes at most.
+ */
+
+#include <stdint.h>
+
+#include "Signal_decoder.h"
+
+const uint16_t Signal_database_numMessages = 5;
+const uint16_t Signal_database_numSignals = 18;
+const uint8_t Signal_database_hashBits = 4;
+
+const uint8_t Signal_database_hash[16] = {
+    2, 1, 4, 5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0
+};
+
+const tSignalMessage Signal_database_messages[5] = {
+    {0x000001A0, 0, 4, 255},
+    {0x00000186, 4, 3, 255},
+    {0x00000324, 7, 4, 255},
+    {0x98FEF100, 11, 2, 255},
+    {0x00000500, 13, 5, 0}
+};
+
+const tSignalDef Signal_database_signals[18] = {
+    {0.00999999978f, 0.0f, 0, 0, 16, 0x00, 2},      // WheelSpeedFL (km/h)
+    {0.00999999978f, 0.0f, 0, 16, 16, 0x00, 4},      // WheelSpeedFR (km/h)
+    {0.00999999978f, 0.0f, 0, 32, 16, 0x00, 6},      // WheelSpeedRL (km/h)
+    {0.00999999978f, 0.0f, 0, 48, 16, 0x00, 8},      // WheelSpeedRR (km/h)
+    {0.100000001f, 0.0f, 0, 7, 16, 0x03, 2},      // SteeringAngle (deg)
+    {1.0f, 0.0f, 0, 23, 12, 0x01, 4},      // SteeringRate (deg/s)
+    {1.0f, 0.0f, 0, 59, 4, 0x01, 8},      // SteeringCounter
+    {0.400000006f, 0.0f, 0, 0, 8, 0x00, 1},      // AccelPedal (%)
+    {0.100000001f, 0.0f, 0, 8, 12, 0x00, 3},      // BrakePressure (bar)
+    {1.0f, 0.0f, 0, 20, 1, 0x00, 3},      // BrakeSwitch
+    {2.0f, 0.0f, 0, 24, 8, 0x02, 4},      // EngineTorque (Nm)
+    {0.00390625f, 0.0f, 0, 8, 16, 0x00, 3},      // WheelBasedSpeed (km/h)
+    {1.0f, 0.0f, 0, 24, 2, 0x00, 4},      // CruiseActive
+    {1.0f, 0.0f, 0, 0, 8, 0x04, 1},      // InfoPage
+    {0.00100000005f, 0.0f, 0, 8, 16, 0x08, 3},      // CellVoltageMin (V)
+    {0.00100000005f, 0.0f, 0, 24, 16, 0x08, 5},      // CellVoltageMax (V)
+    {1.0f, -40.0f, 1, 8, 8, 0x08, 2},      // PackTemperature (degC)
+    {0.100000001f, 0.0f, 1, 23, 16, 0x09, 4}      // CoolantFlow (l/min)
+};
+
+const char * const Signal_database_labels[18] = {
+    "WheelSpeedFL:",
+    "WheelSpeedFR:",
+    "WheelSpeedRL:",
+    "WheelSpeedRR:",
+    "SteeringAngle:",
+    "SteeringRate:",
+    "SteeringCounter:",
+    "AccelPedal:",
+    "BrakePressure:",
+    "BrakeSwitch:",
+    "EngineTorque:",
+    "WheelBasedSpeed:",
+    "CruiseActive:",
+    "InfoPage:",
+    "CellVoltageMin:",
+    "CellVoltageMax:",
+    "PackTemperature:",
+    "CoolantFlow:"
+};
@@ -0,0 +1,135 @@
+/*
+ * Signal_decoder.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Programmer libraries
+#include "Signal_decoder.h"
+
+
+// The 8 bytes of the frame as one word for each byte order: byte 0 is the lowest byte of
+// little_endian and the highest one of big_endian
+static void frame_words(const uint8_t data[8], uint64_t *little_endian, uint64_t *big_endian){
+
+    uint64_t little = 0, big = 0;
+
+    for (uint8_t i = 0; i < 8; i++){
+
+        little |= (uint64_t)data[i] << (8*i);
+        big = (big << 8) | data[i];
+    }
+    *little_endian = little;
+    *big_endian = big;
+}
+
+static int64_t signal_raw(const tSignalDef *signal, uint64_t little_endian, uint64_t big_endian){
+
+    uint64_t mask = (signal->length >= 64) ? ~0ULL : ((1ULL << signal->length) - 1);
+    uint64_t raw;
+    uint8_t last_bit;
+
+    if (signal->flags & SIGNAL_BIG_ENDIAN){
+        // Position of the most significant bit counted from the first bit sent
+        last_bit = (signal->start_bit & ~0x07) + (7 - (signal->start_bit & 0x07)) + signal->length - 1;
+        raw = (big_endian >> (63 - last_bit)) & mask;
+    }else {
+        raw = (little_endian >> signal->start_bit) & mask;
+    }
+
+    if ((signal->flags & SIGNAL_SIGNED) && (signal->length < 64) && (raw & (1ULL << (signal->length - 1)))){
+
+        raw |= ~mask;
+    }
+
+    return (int64_t)raw;
+}
+
+// Return the position of the message of the ID or -1 if it is not on the database
+int16_t find_signalMessage(uint32_t ID, bool extended){
+
+    uint32_t key = ID | (extended ? SIGNAL_ID_EXTENDED : 0);
+    uint32_t mask = (1UL << Signal_database_hashBits) - 1;
+    uint32_t entry = SIGNAL_HASH(key, Signal_database_hashBits);
+    uint8_t position;
+
+    // The table always has empty entries, so the probe ends
+    while ((position = Signal_database_hash[entry]) != 0){
+
+        if (Signal_database_messages[position-1].key == key){
+
+            return position - 1;
+        }
+        entry = (entry + 1) & mask;
+    }
+
+    return -1;
+}
+
+int64_t extract_signalRaw(const tSignalDef *signal, const uint8_t data[8]){
+
+    uint64_t little_endian, big_endian;
+
+    frame_words(data, &little_endian, &big_endian);
+
+    return signal_raw(signal, little_endian, big_endian);
+}
+
+uint8_t decode_signalFrame(uint32_t ID, bool extended, const uint8_t data[], uint8_t length, float values[], uint64_t *updated){
+
+    int16_t position = find_signalMessage(ID, extended);
+    const tSignalMessage *message;
+    const tSignalDef *signal;
+    uint8_t bytes[8] = {0};
+    uint64_t little_endian, big_endian;
+    int64_t mux = -1;
+    uint8_t decoded = 0;
+
+    if (position < 0){
+
+        return 0;
+    }
+    message = &Signal_database_messages[position];
+    if (length > 8){
+
+        length = 8;
+    }
+    memcpy(bytes, data, length);
+    frame_words(bytes, &little_endian, &big_endian);
+
+    // Without the multiplexor no multiplexed signal is taken
+    if (message->multiplexor != SIGNAL_NO_MULTIPLEXOR){
+
+        signal = &Signal_database_signals[message->first_signal + message->multiplexor];
+        if (signal->min_length <= length){
+
+            mux = signal_raw(signal, little_endian, big_endian);
+        }
+    }
+
+    for (uint16_t i = message->first_signal; i < message->first_signal + message->num_signals; i++){
+
+        signal = &Signal_database_signals[i];
+        if ((signal->min_length > length) ||
+            ((signal->flags & SIGNAL_MULTIPLEXED) && (mux != signal->mux_value))){
+
+            continue;
+        }
+        values[i] = (float)signal_raw(signal, little_endian, big_endian)*signal->scale + signal->offset;
+        *updated |= 1ULL << i;
+        decoded++;
+    }
+
+    return decoded;
+}
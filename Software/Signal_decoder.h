@@ -0,0 +1,83 @@
+/*
+ * Signal_decoder.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Signals of the frames broadcast by the ECUs (wheel speeds, steering angle, pedals...), that
+ *      are sent many times faster than a Mode 01 request could read them. The database is a DBC
+ *      file compiled on the host ("Broadcast signals" screen of CAN_device.c): the SD card could
+ *      hold the DBC file, but the compiled tables in flash need no parser on the device and no
+ *      RAM, and the decoding runs on the CAN interrupt.
+ *      The message of a frame is found on a hash table of its ID and only its own signals are
+ *      extracted: the cost of a frame is one lookup plus one shift and mask per signal.
+ */
+
+#ifndef SIGNAL_DECODER_H_
+#define SIGNAL_DECODER_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Database format
+// The tables are generated by Host/Signal_database/dbc_gen.c on Signal_database_data.c (flash).
+// Every message has its signals in a row of Signal_database_signals, the multiplexor among them.
+// The key of a message is its ID with SIGNAL_ID_EXTENDED for the 29 bit ones. The hash table has
+// 2^Signal_database_hashBits entries with the position of the message + 1 (0 is empty), placed at
+// SIGNAL_HASH(key) or on the next free entries (linear probing), and it is never full.
+// The start bit and the byte order are the ones of the DBC file: the least significant bit for
+// Intel (little endian) and the most significant bit, numbered 7..0 on every byte, for Motorola.
+#define SIGNAL_ID_EXTENDED 0x80000000UL
+#define SIGNAL_HASH(key, bits) ((uint32_t)((uint32_t)(key)*2654435761UL) >> (32 - (bits)))
+#define SIGNAL_NO_MULTIPLEXOR 0xFF
+#define SIGNAL_MAX_SIGNALS 64                   // Bits of the updated mask (checked by dbc_gen)
+#define SIGNAL_LABEL_CHARS 18                   // Like liveData_strings
+
+// Flags of a signal
+#define SIGNAL_BIG_ENDIAN 0x01                  // Motorola
+#define SIGNAL_SIGNED 0x02                      // Two's complement
+#define SIGNAL_MULTIPLEXOR 0x04                 // M
+#define SIGNAL_MULTIPLEXED 0x08                 // mN, only when the multiplexor is N
+
+typedef struct{
+
+    uint32_t key;
+    uint16_t first_signal;
+    uint8_t num_signals;
+    uint8_t multiplexor;                        // Of the message, or SIGNAL_NO_MULTIPLEXOR
+}tSignalMessage;
+
+typedef struct{
+
+    float scale;
+    float offset;
+    uint16_t mux_value;                         // With SIGNAL_MULTIPLEXED
+    uint8_t start_bit;
+    uint8_t length;                             // 1 to 64 bits
+    uint8_t flags;
+    uint8_t min_length;                         // Bytes of the frame up to the signal
+}tSignalDef;
+
+extern const uint16_t Signal_database_numMessages;
+extern const uint16_t Signal_database_numSignals;
+extern const uint8_t Signal_database_hashBits;
+extern const uint8_t Signal_database_hash[];
+extern const tSignalMessage Signal_database_messages[];
+extern const tSignalDef Signal_database_signals[];
+extern const char * const Signal_database_labels[];
+
+// Return the position of the message of the ID or -1 if it is not on the database
+int16_t find_signalMessage(uint32_t ID, bool extended);
+// Raw value of a signal on the data of a frame (sign extended with SIGNAL_SIGNED)
+int64_t extract_signalRaw(const tSignalDef *signal, const uint8_t data[8]);
+// Decodes the signals of the frame on values[] (positions of Signal_database_signals) and
+// sets their bits on updated. Return the number of signals decoded.
+uint8_t decode_signalFrame(uint32_t ID, bool extended, const uint8_t data[], uint8_t length, float values[], uint64_t *updated);
+
+#endif /* SIGNAL_DECODER_H_ */
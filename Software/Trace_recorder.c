@@ -0,0 +1,290 @@
+/*
+ * Trace_recorder.c
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ */
+
+// C libraries
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// TIVA libraries
+#include "utils/uartstdio.h"
+
+// FreeRTOS libraries
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Programmer libraries
+#include "Trace_recorder.h"
+#include "Cycle_probes.h"
+
+#define TRACE_RING_EVENTS 64                // 512 bytes, 45 ms of the stream. A power of 2.
+#define TRACE_EVENTS_PER_PACKET 12
+#define TRACE_MAX_TASKS 16
+#define TRACE_MAX_PACKET (3 + TRACE_EVENTS_PER_PACKET*TRACE_EVENT_BYTES + 1)
+
+// Time of the events: the cycle counter of the probes, unless the build has another clock
+// (the virtual clock of the firmware simulator, Host/Firmware_sim/host_target.h)
+#ifndef TRACE_TIMESTAMP
+#define TRACE_TIMESTAMP() PROBE_START()
+#define TRACE_COUNTER_HZ() get_probeCounterHz()
+#endif
+
+typedef struct{
+
+    uint32_t time;
+    uint8_t type;
+    uint8_t object;
+    uint16_t data;
+}tTraceRecord;
+
+// Global variables
+static tTraceRecord ring[TRACE_RING_EVENTS];
+static volatile uint32_t ring_head = 0, ring_tail = 0;
+static uint32_t lost = 0;
+static volatile bool streaming = false, send_names = false;
+static bool initialized = false;
+static uint8_t objects = 0;
+static uint32_t last_task = 0;
+static char task_names[TRACE_MAX_TASKS][configMAX_TASK_NAME_LEN];
+static const char * const isr_names[NUM_TRACE_ISRS] = {"CAN", "Buttons edge", "Buttons read", "Pause timer"};
+
+
+void trace_eventAt(uint32_t time, tTraceEvent type, uint8_t object, uint16_t data){
+
+    UBaseType_t mask;
+
+    if (!streaming){
+
+        return;
+    }
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    if ((ring_head - ring_tail) < TRACE_RING_EVENTS){
+
+        tTraceRecord *record = &ring[ring_head % TRACE_RING_EVENTS];
+
+        record->time = time;
+        record->type = type;
+        record->object = object;
+        record->data = data;
+        ring_head++;
+    }else {
+
+        lost++;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+void trace_event(tTraceEvent type, uint8_t object, uint16_t data){
+
+    trace_eventAt(TRACE_TIMESTAMP(), type, object, data);
+}
+
+// Number of a new queue or event group (0: not traced)
+uint8_t trace_objectNumber(void){
+
+    if ((!initialized) || (objects == UINT8_MAX)){
+
+        return 0;
+    }
+
+    return ++objects;
+}
+
+void trace_taskCreated(uint32_t number, const char *name){
+
+    if (number < TRACE_MAX_TASKS){
+
+        strncpy(task_names[number], name, configMAX_TASK_NAME_LEN-1);
+    }
+}
+
+void trace_taskSwitchedIn(uint32_t number){
+
+    // The scheduler can select the same task again
+    if (number != last_task){
+
+        last_task = number;
+        trace_event(TRACE_TASK_IN, (uint8_t)number, 0);
+    }
+}
+
+void trace_isrEnter(tTraceISR isr){
+
+    trace_event(TRACE_ISR_ENTER, isr, 0);
+}
+
+void trace_isrExit(tTraceISR isr){
+
+    trace_event(TRACE_ISR_EXIT, isr, 0);
+}
+
+// SLIP: END, the escaped bytes and END. Only the shell task sends, so the buffers are static
+// (not on its stack).
+static void send_packet(tTracePacket kind, const uint8_t payload[], uint8_t length){
+
+    static uint8_t packet[TRACE_MAX_PACKET];
+    static char frame[2*TRACE_MAX_PACKET + 2];
+    uint32_t size = 0;
+    uint8_t sum = 0;
+
+    packet[0] = TRACE_PACKET_MAGIC;
+    packet[1] = kind;
+    packet[2] = length;
+    memcpy(packet+3, payload, length);
+    for (int i = 1; i < 3 + length; i++){
+
+        sum += packet[i];
+    }
+    packet[3+length] = sum;
+
+    frame[size++] = (char)TRACE_SLIP_END;
+    for (int i = 0; i < 4 + length; i++){
+
+        switch (packet[i]){
+
+        case TRACE_SLIP_END:
+            frame[size++] = (char)TRACE_SLIP_ESC;
+            frame[size++] = (char)TRACE_SLIP_ESC_END;
+            break;
+        case TRACE_SLIP_ESC:
+            frame[size++] = (char)TRACE_SLIP_ESC;
+            frame[size++] = (char)TRACE_SLIP_ESC_ESC;
+            break;
+        case '\n':
+            frame[size++] = (char)TRACE_SLIP_ESC;
+            frame[size++] = (char)TRACE_SLIP_ESC_LF;
+            break;
+        default:
+            frame[size++] = (char)packet[i];
+            break;
+        }
+    }
+    frame[size++] = (char)TRACE_SLIP_END;
+
+    UARTwrite(frame, size);
+}
+
+static void send_name(tTraceName kind, uint8_t number, const char *name){
+
+    uint8_t payload[2 + configMAX_TASK_NAME_LEN + 4];
+    uint8_t length = 0;
+
+    payload[length++] = kind;
+    payload[length++] = number;
+    while ((*name != '\0') && (length < sizeof(payload))){
+
+        payload[length++] = (uint8_t)*name++;
+    }
+    send_packet(TRACE_PACKET_NAME, payload, length);
+}
+
+// Counter and names, at the start of every stream
+static void send_header(void){
+
+    uint32_t Hz = TRACE_COUNTER_HZ();
+    uint8_t info[4] = {(uint8_t)Hz, (uint8_t)(Hz >> 8), (uint8_t)(Hz >> 16), (uint8_t)(Hz >> 24)};
+
+    send_packet(TRACE_PACKET_INFO, info, sizeof(info));
+    for (int i = 0; i < TRACE_MAX_TASKS; i++){
+
+        if (task_names[i][0] != '\0'){
+
+            send_name(TRACE_NAME_TASK, i, task_names[i]);
+        }
+    }
+    for (int i = 0; i < NUM_TRACE_ISRS; i++){
+
+        send_name(TRACE_NAME_ISR, i, isr_names[i]);
+    }
+    for (int i = 0; i < NUM_PROBES; i++){
+
+        send_name(TRACE_NAME_PROBE, i, get_probeName((tProbe)i));
+    }
+}
+
+// Events of the ring, and the ones lost since the last time
+static void send_events(void){
+
+    static uint8_t payload[TRACE_EVENTS_PER_PACKET*TRACE_EVENT_BYTES];
+    uint8_t count = 0;
+    UBaseType_t mask;
+    uint32_t missed;
+
+    while ((ring_tail != ring_head) && (count < TRACE_EVENTS_PER_PACKET)){
+
+        const tTraceRecord *record = &ring[ring_tail % TRACE_RING_EVENTS];
+        uint8_t *event = payload + count*TRACE_EVENT_BYTES;
+
+        event[0] = (uint8_t)record->time;
+        event[1] = (uint8_t)(record->time >> 8);
+        event[2] = (uint8_t)(record->time >> 16);
+        event[3] = (uint8_t)(record->time >> 24);
+        event[4] = record->type;
+        event[5] = record->object;
+        event[6] = (uint8_t)record->data;
+        event[7] = (uint8_t)(record->data >> 8);
+        count++;
+        ring_tail++;
+    }
+    if (count != 0){
+
+        send_packet(TRACE_PACKET_EVENTS, payload, count*TRACE_EVENT_BYTES);
+    }
+
+    // Now the ring has room for it
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    missed = lost;
+    lost = 0;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    if (missed != 0){
+
+        trace_event(TRACE_LOST, 0, (missed > UINT16_MAX) ? UINT16_MAX : (uint16_t)missed);
+    }
+}
+
+// The stream has no task of its own: the shell calls it every TRACE_PERIOD_MS while it waits
+// at the prompt (Diag_shell.c)
+void trace_service(void){
+
+    if (send_names){
+
+        send_names = false;
+        send_header();
+    }
+    while (streaming && (ring_tail != ring_head)){
+
+        send_events();
+    }
+}
+
+// After UARTStdioConfig and init_probes (the counter), before the other queues are created
+void init_trace(void){
+
+    initialized = true;
+}
+
+// The events are only recorded while the stream is on
+void trace_stream(bool on){
+
+    if (on && (!streaming)){
+
+        ring_tail = ring_head;
+        last_task = 0;
+        send_names = true;
+    }
+    streaming = on;
+}
+
+bool trace_streaming(void){
+
+    return streaming;
+}
@@ -0,0 +1,125 @@
+/*
+ * Trace_recorder.h
+ *
+ *  Created on: 19 oct. 2026
+ *      Author: Manuel Sánchez Natera
+ *
+ *      This work is licensed under the Creative Commons Attribution-NonCommercial 4.0 International License.
+ *      To view a copy of this license, visit http://creativecommons.org/licenses/by-nc/4.0/ or send a letter to
+ *      Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+ *
+ *      Trace of the scheduler. The trace hooks of FreeRTOS (included by FreeRTOSConfig.h), the
+ *      interrupts and the probes of Cycle_probes.h add events of 8 bytes to a ring in RAM, and
+ *      the shell task sends them on UART0 while the stream is on ('trace on' on the shell) and it
+ *      waits at the prompt: while a command runs or a line is typed the events that do not fit
+ *      on the ring are lost, and counted with TRACE_LOST. The stream is converted to the trace
+ *      of Chrome/Perfetto by Host/RTOS_trace.
+ *
+ *      Stream: packets framed like SLIP (END before and after, ESC for END, ESC and '\n', so
+ *      uartstdio does not add '\r' inside a packet and the texts of the console can go in
+ *      between). Packet: 'T', kind, length, payload, 8 bit sum of kind, length and payload.
+ *          TRACE_PACKET_INFO       counter Hz (uint32)
+ *          TRACE_PACKET_NAME       kind of object, number, name
+ *          TRACE_PACKET_EVENTS     events: time (uint32), type, object, data (uint16)
+ *      Little endian, like the Tiva.
+ */
+
+#ifndef TRACE_RECORDER_H_
+#define TRACE_RECORDER_H_
+
+// Libraries
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRACE_SLIP_END 0xC0
+#define TRACE_SLIP_ESC 0xDB
+#define TRACE_SLIP_ESC_END 0xDC
+#define TRACE_SLIP_ESC_ESC 0xDD
+#define TRACE_SLIP_ESC_LF 0xDE
+#define TRACE_PACKET_MAGIC 'T'
+#define TRACE_EVENT_BYTES 8
+#define TRACE_PERIOD_MS 20                  // 115200 bauds: about 1400 events per second
+
+typedef enum{
+
+    TRACE_PACKET_INFO = 1,
+    TRACE_PACKET_NAME,
+    TRACE_PACKET_EVENTS
+}tTracePacket;
+
+typedef enum{
+
+    TRACE_NAME_TASK = 1,
+    TRACE_NAME_ISR,
+    TRACE_NAME_PROBE
+}tTraceName;
+
+typedef enum{
+
+    TRACE_TASK_IN = 1,              // Object: task number (the one switched out is the last in)
+    TRACE_ISR_ENTER,                // Object: tTraceISR
+    TRACE_ISR_EXIT,
+    TRACE_QUEUE_SEND,               // Object: queue, semaphore or mutex. Also from an ISR.
+    TRACE_QUEUE_RECEIVE,
+    TRACE_QUEUE_BLOCK,              // Data: 1 sending, 0 receiving
+    TRACE_EVENT_SET,                // Object: event group. Data: bits set (from an ISR it only
+                                    // asks the timer task to set them)
+    TRACE_EVENT_WAIT,               // Data: bits waited for
+    TRACE_EVENT_WAIT_END,           // Data: 1 timeout
+    TRACE_PROBE_BEGIN,              // Object: tProbe
+    TRACE_PROBE_END,
+    TRACE_LOST                      // Data: events lost because the ring was full
+}tTraceEvent;
+
+typedef enum{
+
+    TRACE_ISR_CAN = 0,              // CANIntHandler
+    TRACE_ISR_BUTTONS_EDGE,         // AntiBounceIntHandler
+    TRACE_ISR_BUTTONS_READ,         // ButtonsIntHandler
+    TRACE_ISR_PAUSE,                // systemPause_TimerISR
+    NUM_TRACE_ISRS
+}tTraceISR;
+
+void init_trace(void);
+// Sends the events of the ring (the shell task)
+void trace_service(void);
+void trace_stream(bool on);
+bool trace_streaming(void);
+uint8_t trace_objectNumber(void);
+void trace_event(tTraceEvent type, uint8_t object, uint16_t data);
+void trace_eventAt(uint32_t time, tTraceEvent type, uint8_t object, uint16_t data);
+void trace_taskCreated(uint32_t number, const char *name);
+void trace_taskSwitchedIn(uint32_t number);
+void trace_isrEnter(tTraceISR isr);
+void trace_isrExit(tTraceISR isr);
+
+// Hooks of FreeRTOS. They are expanded inside tasks.c, queue.c and event_groups.c, where the
+// structures of the kernel are known. The queues and event groups created before init_trace
+// (the ones of uartstdio) have the number 0 and are not traced, so the stream does not trace
+// itself. traceTASK_SWITCHED_OUT is not used: vTaskSwitchContext calls it just before
+// traceTASK_SWITCHED_IN, a few cycles apart, and often for the same task selected again, so the
+// switch in closes the slice of the previous task at the same time and the ring holds twice as
+// many switches.
+#define traceTASK_CREATE(pxNewTCB) trace_taskCreated((pxNewTCB)->uxTCBNumber, (pxNewTCB)->pcTaskName)
+#define traceTASK_SWITCHED_IN() trace_taskSwitchedIn(pxCurrentTCB->uxTCBNumber)
+#define traceQUEUE_CREATE(pxNewQueue) (pxNewQueue)->uxQueueNumber = trace_objectNumber()
+#define traceQUEUE_SEND(pxQueue) TRACE_OBJECT(TRACE_QUEUE_SEND, (pxQueue)->uxQueueNumber, 0)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) TRACE_OBJECT(TRACE_QUEUE_SEND, (pxQueue)->uxQueueNumber, 0)
+#define traceQUEUE_RECEIVE(pxQueue) TRACE_OBJECT(TRACE_QUEUE_RECEIVE, (pxQueue)->uxQueueNumber, 0)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) TRACE_OBJECT(TRACE_QUEUE_RECEIVE, (pxQueue)->uxQueueNumber, 0)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) TRACE_OBJECT(TRACE_QUEUE_BLOCK, (pxQueue)->uxQueueNumber, 1)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) TRACE_OBJECT(TRACE_QUEUE_BLOCK, (pxQueue)->uxQueueNumber, 0)
+#define traceEVENT_GROUP_CREATE(pxEventBits) (pxEventBits)->uxEventGroupNumber = trace_objectNumber()
+#define traceEVENT_GROUP_SET_BITS(xEventGroup, uxBitsToSet) \
+    TRACE_OBJECT(TRACE_EVENT_SET, ((EventGroup_t *)(xEventGroup))->uxEventGroupNumber, (uint16_t)(uxBitsToSet))
+#define traceEVENT_GROUP_SET_BITS_FROM_ISR(xEventGroup, uxBitsToSet) \
+    TRACE_OBJECT(TRACE_EVENT_SET, ((EventGroup_t *)(xEventGroup))->uxEventGroupNumber, (uint16_t)(uxBitsToSet))
+#define traceEVENT_GROUP_WAIT_BITS_BLOCK(xEventGroup, uxBitsToWaitFor) \
+    TRACE_OBJECT(TRACE_EVENT_WAIT, ((EventGroup_t *)(xEventGroup))->uxEventGroupNumber, (uint16_t)(uxBitsToWaitFor))
+#define traceEVENT_GROUP_WAIT_BITS_END(xEventGroup, uxBitsToWaitFor, xTimeoutOccurred) \
+    TRACE_OBJECT(TRACE_EVENT_WAIT_END, ((EventGroup_t *)(xEventGroup))->uxEventGroupNumber, (uint16_t)(xTimeoutOccurred))
+
+// Only the objects with a number
+#define TRACE_OBJECT(type, number, data) do{ if ((number) != 0){ trace_event((type), (uint8_t)(number), (data)); } }while(0)
+
+#endif /* TRACE_RECORDER_H_ */
@@ -47,6 +47,13 @@
 #include "ST7735.h"
 #include "Graphic_interface.h"
 #include "Buttons.h"
+#include "PID_history.h"
+#include "PID_cache.h"
+#include "DTC_monitor.h"
+#include "SD_writer.h"
+#include "Cycle_probes.h"
+#include "Trace_recorder.h"
+#include "Diag_shell.h"
 //#include "sdcard.h"
 
 
@@ -125,6 +132,17 @@ int main(void){
     // Get the system clock speed.
     g_ulSystemClock = ROM_SysCtlClockGet();
 
+    // Console of UART0 (USB of the debugger): diagnostic shell, with the table of the execution
+    // time probes and the stream of the trace. The trace numbers the queues created from now on.
+    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    GPIOPinConfigure(GPIO_PA0_U0RX);
+    GPIOPinConfigure(GPIO_PA1_U0TX);
+    GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    UARTStdioConfig(0, 115200, g_ulSystemClock);
+    init_probes();
+    init_trace();
+    init_shell();
+
     // Initializes the subsystem of measurement of the CPU usage (it measures the time that the CPU is not asleep).
     // For that it uses a timer, that here we have put that it is the TIMER0 (last parameter that is passed to the function)
     // (and therefore this one should not be used for another thing).
@@ -133,6 +151,8 @@ int main(void){
     init_CanDevice(GPIO_PORTB_BASE, CAN0_BASE, GPIO_PIN_5, GPIO_PIN_4, BIT_RATE, true);
     init_graphicInterface();
     init_Buttons();
+    init_PIDhistory();
+    init_PIDcache();
 
     drawECUMenu();
 
@@ -141,6 +161,8 @@ int main(void){
 
     // Task creation
     init_deviceTasks();
+    init_DTCmonitor();
+    init_SDwriter();
     init_buttonTasks();
 
     ROM_IntMasterEnable();
@@ -38,6 +38,7 @@
  */
 
 #include "sdcard.h"
+#include "SD_spi.h"
 #include "inc/tm4c123gh6pm.h"
 #include <stdio.h>
 
@@ -80,52 +81,34 @@ typedef struct
 
 tfile_dir file_dir[40];
 
+/*
+ * Sector cache (LRU) for the reads of the FAT and cluster run: the clusters from run_start to run_end-1
+ * are followed by the next one, so a contiguous file only reads the FAT once per run
+ */
+typedef struct
+{
+	unsigned long lba;
+	unsigned long last_use;
+	unsigned char valid;
+	unsigned char data[512];
+}tsector_cache;
+
+tsector_cache sector_cache[SD_CACHE_SECTORS];
+unsigned long cache_uses=0;
+unsigned long run_start=0,run_end=0;
+unsigned long stream_lba=0;
+
+/*
+ * Registers of each SSI module: the base is taken once and not with a switch for every byte
+ */
+tSPIRegisters * const ssi_ports[4]={(tSPIRegisters *)&SSI0_CR0_R,(tSPIRegisters *)&SSI1_CR0_R,(tSPIRegisters *)&SSI2_CR0_R,(tSPIRegisters *)&SSI3_CR0_R};
+
 /**
  * Writes to the SD card
  */
 void sd_write(char message,enum SSI SSI_number)
 {
-	unsigned short volatile rcvdata;
-	switch(SSI_number)
-	{
-		case SSI0:
-		{
-			// wait until transmit FIFO not full
-			while((SSI0_SR_R&SSI_SR_TNF)==0){};
-			//DC = DC_DATA;
-			SSI0_DR_R = message;
-			while((SSI0_SR_R&SSI_SR_RNE)==0){};
-			rcvdata = SSI0_DR_R;
-			break;
-		}
-		case SSI1:
-		{
-			while((SSI1_SR_R&SSI_SR_TNF)==0){};
-			//DC = DC_DATA;
-			SSI1_DR_R = message;
-			while((SSI1_SR_R&SSI_SR_RNE)==0){};
-			rcvdata = SSI1_DR_R;
-			break;
-		}
-		case SSI2:
-		{
-			while((SSI2_SR_R&SSI_SR_TNF)==0){};
-			//DC = DC_DATA;
-			SSI2_DR_R = message;
-			while((SSI2_SR_R&SSI_SR_RNE)==0){};
-			rcvdata = SSI2_DR_R;
-			break;
-		}
-		case SSI3:
-		{
-			while((SSI1_SR_R&SSI_SR_TNF)==0){};
-			//DC = DC_DATA;
-			SSI3_DR_R = message;
-			while((SSI3_SR_R&SSI_SR_RNE)==0){};
-			rcvdata = SSI3_DR_R;
-			break;
-		}
-	}
+	exchange_SPIbyte(ssi_ports[SSI_number],message);
 }
 
 /*
@@ -133,41 +116,7 @@ void sd_write(char message,enum SSI SSI_number)
  */
 unsigned char sd_read(enum SSI SSI_number)
 {
-	switch(SSI_number)
-	{
-		case SSI0:
-		{
-			while((SSI0_SR_R&SSI_SR_TNF)==0){};    // wait until room in FIFO
-			SSI0_DR_R = 0xFF;                      // data out, garbage
-			while((SSI0_SR_R&SSI_SR_RNE)==0){};    // wait until response
-			return (unsigned char) SSI0_DR_R;      // read received data
-			break;
-		}
-		case SSI1:
-		{
-			while((SSI1_SR_R&SSI_SR_TNF)==0){};    // wait until room in FIFO
-			SSI1_DR_R = 0xFF;                      // data out, garbage
-			while((SSI1_SR_R&SSI_SR_RNE)==0){};    // wait until response
-			return (unsigned char) SSI1_DR_R;      // read received data
-			break;
-		}
-		case SSI2:
-		{
-			while((SSI2_SR_R&SSI_SR_TNF)==0){};    // wait until room in FIFO
-			SSI2_DR_R = 0xFF;                      // data out, garbage
-			while((SSI2_SR_R&SSI_SR_RNE)==0){};    // wait until response
-			return (unsigned char) SSI2_DR_R;      // read received data
-			break;
-		}
-		case SSI3:
-		{
-			while((SSI3_SR_R&SSI_SR_TNF)==0){};    // wait until room in FIFO
-			SSI3_DR_R = 0xFF;                      // data out, garbage
-			while((SSI3_SR_R&SSI_SR_RNE)==0){};    // wait until response
-			return (unsigned char) SSI3_DR_R;      // read received data
-			break;
-		}
-	}
+	return exchange_SPIbyte(ssi_ports[SSI_number],0xFF);     // data out garbage, read received data
 }
 
 /*
@@ -229,6 +178,7 @@ void initialize_sd(enum SSI SSI_number)
 	unsigned char i;
 	unsigned char ocr[4];
 	unsigned char sd_type;
+	sd_cache_clear();                       /* It can be another card */
 	//Sends a 1 through CS and MOSI lines for at least 74 clock cycles
 	cs_high(SSI_number);
 	dummy_clock(SSI_number);
@@ -292,10 +242,7 @@ void initialize_sd(enum SSI SSI_number)
 			}
 		}
 	}
-	else
-	{
-		printf("Failure in CMD0");
-	}
+	/* No printf when CMD0 fails: it is the only one of the firmware and takes the stdio of the C library to the RAM. The mount fails on the first read. */
 }
 
 
@@ -589,37 +536,45 @@ void tx_SSI(enum SSI SSI_number)
 	}
 }
 
-/*Change speed to (?) 8 MHz*/
+/*Change speed to 25 MHz (CPSDVSR=2 and SCR=0), the maximum of the SSI as master*/
 void change_speed(enum SSI SSI_number)
 {
 	switch(SSI_number)
 	{
 		case SSI0:
 		{
+			SSI0_CR1_R&=~SSI_CR1_SSE;		  		// Disable SSI while configuring it
 			SSI0_CC_R|=SSI_CPSR_CPSDVSR_M;// Configure prescale divisor
 			SSI0_CPSR_R = (SSI0_CPSR_R&~SSI_CPSR_CPSDVSR_M)+2; // must be even number
-			SSI0_CR0_R |=0x0000;
+			SSI0_CR0_R &=~SSI_CR0_SCR_M;		// SCR=0: system clock/2 (25 MHz at 50 MHz)
+			SSI0_CR1_R|=SSI_CR1_SSE;		  		// Enable SSI
 			break;
 		}
 		case SSI1:
 		{
+			SSI1_CR1_R&=~SSI_CR1_SSE;		  		// Disable SSI while configuring it
 			SSI1_CC_R|=SSI_CPSR_CPSDVSR_M;// Configure prescale divisor
 			SSI1_CPSR_R = (SSI1_CPSR_R&~SSI_CPSR_CPSDVSR_M)+2; // must be even number
-			SSI1_CR0_R |=0x0000;
+			SSI1_CR0_R &=~SSI_CR0_SCR_M;		// SCR=0: system clock/2 (25 MHz at 50 MHz)
+			SSI1_CR1_R|=SSI_CR1_SSE;		  		// Enable SSI
 			break;
 		}
 		case SSI2:
 		{
+			SSI2_CR1_R&=~SSI_CR1_SSE;		  		// Disable SSI while configuring it
 			SSI2_CC_R|=SSI_CPSR_CPSDVSR_M;// Configure prescale divisor
 			SSI2_CPSR_R = (SSI2_CPSR_R&~SSI_CPSR_CPSDVSR_M)+2; // must be even number
-			SSI2_CR0_R |=0x0000;
+			SSI2_CR0_R &=~SSI_CR0_SCR_M;		// SCR=0: system clock/2 (25 MHz at 50 MHz)
+			SSI2_CR1_R|=SSI_CR1_SSE;		  		// Enable SSI
 			break;
 		}
 		case SSI3:
 		{
+			SSI3_CR1_R&=~SSI_CR1_SSE;		  		// Disable SSI while configuring it
 			SSI3_CC_R|=SSI_CPSR_CPSDVSR_M;// Configure prescale divisor
 			SSI3_CPSR_R = (SSI3_CPSR_R&~SSI_CPSR_CPSDVSR_M)+2; // must be even number
-			SSI3_CR0_R |=0x0000;
+			SSI3_CR0_R &=~SSI_CR0_SCR_M;		// SCR=0: system clock/2 (25 MHz at 50 MHz)
+			SSI3_CR1_R|=SSI_CR1_SSE;		  		// Enable SSI
 			break;
 		}
 	}
@@ -679,7 +634,7 @@ long list_dirs_and_files(long next_cluster,enum name_type name, enum get_subdirs
 	unsigned char buffer[512];
 	int position=0,filename_position=0;
 	int n=0;
-	unsigned long count=10,sector=0,sectors_to_be_read=sectors_per_cluster;//Calculate this
+	unsigned long count=10,sectors_to_be_read=sectors_per_cluster;//Calculate this
 	long address=cluster_begin_lba + ((next_cluster - 2) * (unsigned long)sectors_per_cluster);
 	if(cluster_dir == next_cluster)
 	{
@@ -893,18 +848,7 @@ long list_dirs_and_files(long next_cluster,enum name_type name, enum get_subdirs
 		}while(sectors_to_be_read>0);
 	}
 	send_command(CMD12,0,SSI_number);
-	sectors_to_be_read=(next_cluster*4)/512;
-	if(send_command(CMD18,fat_begin_lba,SSI_number)==0)
-	{
-		do
-		{
-			sector++;
-			rcvr_datablock(buffer, 512,SSI_number);
-		}while(sector<=sectors_to_be_read);
-		sector--;
-	}
-	send_command(CMD12,0,SSI_number);
-	next_cluster=(((long)(buffer[((next_cluster*4)-(sector*512))+3]))<<24)+(((long)(buffer[((next_cluster*4)-(sector*512))+2]))<<16)+(((long)(buffer[((next_cluster*4)-(sector*512))+1]))<<8)+(long)(buffer[((next_cluster*4)-(sector*512))]);
+	next_cluster=get_next_cluster(next_cluster,SSI_number);
 	if((next_cluster==0x0FFFFFFF || next_cluster==0xFFFFFFFF) && current_count<40 && subdirs==GET_SUBDIRS)
 	{
 		while(current_count<40&&file_dir[current_count].type!=IS_DIR)
@@ -943,7 +887,6 @@ long open_file(long next_cluster,enum SSI SSI_number)
 {
 
 	unsigned char buffer[512];
-	long sector=0;
 	long sectors_to_be_read=sectors_per_cluster;
 	long address=cluster_begin_lba + ((next_cluster - 2) * (unsigned long)sectors_per_cluster);
 	if(send_command(CMD18,address,SSI_number)==0)
@@ -968,18 +911,7 @@ long open_file(long next_cluster,enum SSI SSI_number)
 		}while(sectors_to_be_read>0 && finish!=1);
 	}
 	send_command(CMD12,0,SSI_number);
-	sectors_to_be_read=(next_cluster*4)/512;
-	if(send_command(CMD18,fat_begin_lba,SSI_number)==0)
-	{
-		do
-		{
-			sector++;
-			rcvr_datablock(buffer, 512,SSI_number);
-		}while(sector<=sectors_to_be_read);
-		sector--;
-	}
-	send_command(CMD12,0,SSI_number);
-	next_cluster=(((long)(buffer[((next_cluster*4)-(sector*512))+3]))<<24)+(((long)(buffer[((next_cluster*4)-(sector*512))+2]))<<16)+(((long)(buffer[((next_cluster*4)-(sector*512))+1]))<<8)+(long)(buffer[((next_cluster*4)-(sector*512))]);
+	next_cluster=get_next_cluster(next_cluster,SSI_number);
 	if(next_cluster==0x0FFFFFFF || next_cluster==0x0FFFFFFF)
 	{
 		finish=0;
@@ -1022,7 +954,7 @@ void Timer5_Init(void)
 	TIMER5_CTL_R = 0x00000000;       // 1) disable timer5A during setup
 	TIMER5_CFG_R = 0x00000000;       // 2) configure for 32-bit mode
 	TIMER5_TAMR_R = 0x00000002;      // 3) configure for periodic mode, default down-count settings
-	TIMER5_TAILR_R = 159999;         // 4) reload value, 10 ms, 16 MHz clock
+	TIMER5_TAILR_R = 499999;         // 4) reload value, 10 ms, 50 MHz clock
 	TIMER5_TAPR_R = 0;               // 5) bus clock resolution
 	TIMER5_ICR_R |= 0x00000001;       // 6) clear timer5A timeout flag
 	TIMER5_IMR_R |= 0x00000001;       // 7) arm timeout interrupt
@@ -1057,10 +989,7 @@ unsigned int rcvr_datablock (
   } while ((token == 0xFF) && Timer1);
   if(token != 0xFE) return 0;    /* If not valid data token, retutn with error */
 
-  do {                            /* Receive the data block into buffer */
-    rcvr_spi_m(buff++,SSI_number);
-    rcvr_spi_m(buff++,SSI_number);
-  } while (btr -= 2);
+  receive_SPIblock(ssi_ports[SSI_number],buff,btr);    /* Receive the data block into buffer */
   sd_write(0xFF,SSI_number);                        /* Discard CRC */
   sd_write(0xFF,SSI_number);
 
@@ -1070,3 +999,204 @@ unsigned int rcvr_datablock (
 void rcvr_spi_m(unsigned char *dst,enum SSI SSI_number){
   *dst = sd_read(SSI_number);
 }
+
+/*
+ * Sends a data block of 512 bytes with its token (0xFE for CMD24, 0xFC for each block of CMD25) and checks the data response
+ */
+unsigned int xmit_datablock(const unsigned char *buff, unsigned char token, enum SSI SSI_number)
+{
+	unsigned char response;
+	if (is_ready(SSI_number) != 0xFF) return 0;    /* The previous block is still being programmed */
+	sd_write(token,SSI_number);
+	send_SPIblock(ssi_ports[SSI_number],buff,512);
+	sd_write(0xFF,SSI_number);                        /* Dummy CRC */
+	sd_write(0xFF,SSI_number);
+	response = sd_read(SSI_number);
+	if ((response & 0x1F) != 0x05) return 0;    /* Data response xxx0 0101: data accepted */
+	return 1;
+}
+
+/*
+ * Reads count sectors from lba (CMD17 for a single sector, CMD18 and CMD12 for more)
+ */
+unsigned int sd_read_blocks(unsigned long lba, unsigned char *buff, unsigned int count, enum SSI SSI_number)
+{
+	unsigned int result=1;
+	if(count==1)
+	{
+		return (send_command(CMD17,lba,SSI_number)==0) && rcvr_datablock(buff,512,SSI_number);
+	}
+	if(send_command(CMD18,lba,SSI_number)!=0)
+	{
+		return 0;
+	}
+	do
+	{
+		if(!rcvr_datablock(buff,512,SSI_number))
+		{
+			result=0;
+			break;
+		}
+		buff+=512;
+	}while(--count);
+	send_command(CMD12,0,SSI_number);
+	return result;
+}
+
+/*
+ * Writes count sectors from lba (CMD24 for a single sector, CMD25 and the stop token for more)
+ */
+unsigned int sd_write_blocks(unsigned long lba, const unsigned char *buff, unsigned int count, enum SSI SSI_number)
+{
+	unsigned int result=1;
+	sd_cache_invalidate(lba,count);
+	if(count==1)
+	{
+		result=(send_command(CMD24,lba,SSI_number)==0) && xmit_datablock(buff,0xFE,SSI_number);
+		if(is_ready(SSI_number)!=0xFF)                  /* Wait until the card has programmed the data */
+		{
+			result=0;
+		}
+		return result;
+	}
+	if(!sd_stream_start(lba,SSI_number))
+	{
+		return 0;
+	}
+	do
+	{
+		if(!sd_stream_write(buff,SSI_number))
+		{
+			result=0;
+			break;
+		}
+		buff+=512;
+	}while(--count);
+	return sd_stream_stop(SSI_number) && result;
+}
+
+/*
+ * Recording mode: a multiple block write (CMD25) is kept open and the sectors are sent one by one,
+ * without a command per sector. No other command can be sent until sd_stream_stop.
+ */
+unsigned int sd_stream_start(unsigned long lba, enum SSI SSI_number)
+{
+	stream_lba=lba;
+	return send_command(CMD25,lba,SSI_number)==0;
+}
+
+/*
+ * Sends the next sector of the recording (512 bytes)
+ */
+unsigned int sd_stream_write(const unsigned char *buff, enum SSI SSI_number)
+{
+	sd_cache_invalidate(stream_lba++,1);
+	return xmit_datablock(buff,0xFC,SSI_number);
+}
+
+/*
+ * Ends the recording with the stop token and waits until the card has programmed the data
+ */
+unsigned int sd_stream_stop(enum SSI SSI_number)
+{
+	is_ready(SSI_number);
+	sd_write(0xFD,SSI_number);                /* Stop token */
+	return is_ready(SSI_number)==0xFF;
+}
+
+/*
+ * Empties the sector cache and the cluster run
+ */
+void sd_cache_clear(void)
+{
+	unsigned char i;
+	for(i=0;i<SD_CACHE_SECTORS;i++)
+	{
+		sector_cache[i].valid=0;
+	}
+	run_start=0;
+	run_end=0;
+}
+
+/*
+ * The sectors written from lba are not valid on the cache anymore. A write of the FAT also ends the cluster run.
+ */
+void sd_cache_invalidate(unsigned long lba, unsigned int count)
+{
+	unsigned char i;
+	for(i=0;i<SD_CACHE_SECTORS;i++)
+	{
+		if(sector_cache[i].valid && sector_cache[i].lba>=lba && sector_cache[i].lba-lba<count)
+		{
+			sector_cache[i].valid=0;
+		}
+	}
+	if(lba<fat_begin_lba+sectors_per_fat && lba+count>fat_begin_lba)
+	{
+		run_start=0;
+		run_end=0;
+	}
+}
+
+/*
+ * Returns the sector from the cache, reading it (CMD17) on the least recently used entry if it is not there.
+ * Returns 0 if the card does not answer.
+ */
+unsigned char *sd_cache_read(unsigned long lba, enum SSI SSI_number)
+{
+	unsigned char i,oldest=0;
+	for(i=0;i<SD_CACHE_SECTORS;i++)
+	{
+		if(sector_cache[i].valid && sector_cache[i].lba==lba)
+		{
+			sector_cache[i].last_use=++cache_uses;
+			return sector_cache[i].data;
+		}
+		if(sector_cache[oldest].valid && (!sector_cache[i].valid || sector_cache[i].last_use<sector_cache[oldest].last_use))
+		{
+			oldest=i;               /* A free entry or the least recently used one */
+		}
+	}
+	sector_cache[oldest].valid=sd_read_blocks(lba,sector_cache[oldest].data,1,SSI_number);
+	sector_cache[oldest].lba=lba;
+	sector_cache[oldest].last_use=++cache_uses;
+	return sector_cache[oldest].valid ? sector_cache[oldest].data : 0;
+}
+
+/*
+ * Reads a FAT entry (through the cache). Returns 0 if the card does not answer.
+ */
+unsigned long read_fat_entry(unsigned long cluster, enum SSI SSI_number)
+{
+	unsigned char *buffer=sd_cache_read(fat_begin_lba+(cluster*4)/512,SSI_number);
+	unsigned int offset=(cluster*4)%512;
+	if(buffer==0)
+	{
+		return 0;
+	}
+	return (((unsigned long)buffer[offset+3])<<24)+(((unsigned long)buffer[offset+2])<<16)+(((unsigned long)buffer[offset+1])<<8)+(unsigned long)buffer[offset];
+}
+
+/*
+ * Next cluster of the chain. Inside the cluster run there is no read; otherwise the FAT entry is read and
+ * the run that starts on this cluster is measured (entries pointing to the next cluster).
+ */
+unsigned long get_next_cluster(unsigned long cluster, enum SSI SSI_number)
+{
+	unsigned long next;
+	if(cluster>=run_start && cluster<run_end)
+	{
+		return cluster+1;
+	}
+	next=read_fat_entry(cluster,SSI_number);
+	if((next&0x0FFFFFFF)==cluster+1)
+	{
+		run_start=cluster;
+		run_end=cluster+1;
+		while((run_end+1)*4/512<sectors_per_fat && (read_fat_entry(run_end,SSI_number)&0x0FFFFFFF)==run_end+1)
+		{
+			run_end++;
+		}
+	}
+	return next;
+}
@@ -38,6 +38,9 @@
 #define CMD55    0x77    	/* APP_CMD */
 #define CMD58    0x7A    	/* READ_OCR */
 
+/* Sectors of the cache for the reads of the FAT (512 bytes each) */
+#define SD_CACHE_SECTORS 1
+
 enum typeOfWrite{
   COMMAND,                              // the transmission is an LCD command
   DATA                                  // the transmission is data
@@ -80,4 +83,15 @@ long list_dirs_and_files(long next_cluster,enum name_type name, enum get_subdirs
 void tx_SSI(enum SSI);
 void clean_name(void);
 void disk_timerproc(void);
+unsigned int xmit_datablock(const unsigned char *buff, unsigned char token, enum SSI SSI_number);
+unsigned int sd_read_blocks(unsigned long lba, unsigned char *buff, unsigned int count, enum SSI SSI_number);
+unsigned int sd_write_blocks(unsigned long lba, const unsigned char *buff, unsigned int count, enum SSI SSI_number);
+unsigned int sd_stream_start(unsigned long lba, enum SSI SSI_number);
+unsigned int sd_stream_write(const unsigned char *buff, enum SSI SSI_number);
+unsigned int sd_stream_stop(enum SSI SSI_number);
+void sd_cache_clear(void);
+void sd_cache_invalidate(unsigned long lba, unsigned int count);
+unsigned char *sd_cache_read(unsigned long lba, enum SSI SSI_number);
+unsigned long read_fat_entry(unsigned long cluster, enum SSI SSI_number);
+unsigned long get_next_cluster(unsigned long cluster, enum SSI SSI_number);
 
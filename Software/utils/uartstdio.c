@@ -83,6 +83,18 @@ static QueueHandle_t xCharsForTx;
 
 static SemaphoreHandle_t TxMutex; //Enables the use of UARTprintf and UARTWrite in more than one task
 
+//*****************************************************************************
+//
+// Ring of the binary output (UARTwriteRaw). It goes out after the characters
+// of the queue, and the interrupt moves it to the FIFO without any call to the
+// RTOS. The indexes only grow: the task moves the write one and the interrupt
+// (or the task with the TX interrupt disabled) the read one.
+//
+//*****************************************************************************
+static uint8_t g_pui8RawBuffer[UART_RAW_BUFFER_SIZE];
+static volatile uint32_t g_ui32RawWrite = 0;
+static volatile uint32_t g_ui32RawRead = 0;
+
 
 #ifdef WANT_CMDLINE_HISTORY
 // Extended History support variables
@@ -102,6 +114,13 @@ static unsigned char g_ubEscMode = 0;
 //*****************************************************************************
 static uint32_t g_ui32Base = 0;
 
+//*****************************************************************************
+//
+// The clock of the UART, for UARTBaudSet.
+//
+//*****************************************************************************
+static uint32_t g_ui32SrcClock = 0;
+
 //*****************************************************************************
 //
 // A mapping from an integer between 0 and 15 to its ASCII character
@@ -177,6 +196,15 @@ static void UARTPrimeTransmit(uint32_t ui32Base)
 			MAP_UARTCharPutNonBlocking(ui32Base,data);
 		}
 
+		//
+		// Then the binary output.
+		//
+		while(UARTSpaceAvail(ui32Base) && (g_ui32RawRead != g_ui32RawWrite))
+		{
+			MAP_UARTCharPutNonBlocking(ui32Base,g_pui8RawBuffer[g_ui32RawRead % UART_RAW_BUFFER_SIZE]);
+			g_ui32RawRead++;
+		}
+
 		//
 		// Reenable the UART interrupt.
 		//
@@ -228,6 +256,7 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
 	// Select the base address of the UART.
 	//
 	g_ui32Base = g_ui32UARTBase[ui32PortNum];
+	g_ui32SrcClock = ui32SrcClock;
 
 	//
 	// Enable the UART peripheral for use.
@@ -369,6 +398,71 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
 }
 
 
+//*****************************************************************************
+//
+//! Writes a block of binary data to the UART output.
+//!
+//! \param pui8Buf points to the bytes to transmit.
+//! \param ui32Len is the number of bytes.
+//!
+//! Unlike UARTwrite(), the bytes are not translated and the call never blocks:
+//! the whole block goes to the ring of the binary output, or nothing if it does
+//! not fit, so the caller can drop it (a frame of a stream). Only one task may
+//! use it. The block goes out after the characters already in the queue of
+//! UARTwrite().
+//!
+//! \return Returns \e ui32Len, or 0 if the block did not fit.
+//
+//*****************************************************************************
+int
+UARTwriteRaw(const uint8_t *pui8Buf, uint32_t ui32Len)
+{
+	uint32_t ui32Idx;
+
+	ASSERT(pui8Buf != 0);
+	ASSERT(g_ui32Base != 0);
+
+	if(ui32Len > UART_RAW_BUFFER_SIZE - (g_ui32RawWrite - g_ui32RawRead))
+	{
+		return(0);
+	}
+	for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+	{
+		g_pui8RawBuffer[(g_ui32RawWrite + ui32Idx) % UART_RAW_BUFFER_SIZE] = pui8Buf[ui32Idx];
+	}
+	g_ui32RawWrite += ui32Len;
+	UARTPrimeTransmit(g_ui32Base);
+
+	return(ui32Len);
+}
+
+//*****************************************************************************
+//
+//! Changes the bit rate of the console.
+//!
+//! \param ui32Baud is the new bit rate.
+//!
+//! The characters and the binary output already written are transmitted with
+//! the old one first. Only from a task.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTBaudSet(uint32_t ui32Baud)
+{
+	ASSERT(g_ui32Base != 0);
+
+	UARTFlushTx(false);
+	while(MAP_UARTBusy(g_ui32Base))
+	{
+	}
+	MAP_UARTConfigSetExpClk(g_ui32Base, g_ui32SrcClock, ui32Baud,
+			(UART_CONFIG_PAR_NONE | UART_CONFIG_STOP_ONE |
+					UART_CONFIG_WLEN_8));
+}
+
+
 //*****************************************************************************
 //
 //! A simple UART based get string function, with some line processing.
@@ -1361,6 +1455,9 @@ void UARTFlushTx(bool bDiscard)
 	if(bDiscard)
 	{
 		xQueueReset( xCharsForTx );
+		MAP_UARTIntDisable(g_ui32Base, UART_INT_TX);
+		g_ui32RawRead = g_ui32RawWrite;
+		MAP_UARTIntEnable(g_ui32Base, UART_INT_TX);
 
 	}
 	else
@@ -1368,7 +1465,7 @@ void UARTFlushTx(bool bDiscard)
 		//
 		// Wait for all remaining data to be transmitted before returning.
 		//
-		while(uxQueueMessagesWaiting(xCharsForTx))
+		while(uxQueueMessagesWaiting(xCharsForTx) || (g_ui32RawRead != g_ui32RawWrite))
 		{
 		}
 	}
@@ -1447,11 +1544,16 @@ void UARTStdioIntHandler(void)
 			xQueueReceiveFromISR(xCharsForTx,&data,&xHigherPriorityTaskWoken);
 			MAP_UARTCharPutNonBlocking(g_ui32Base,data);
 		}
+		while(MAP_UARTSpaceAvail(g_ui32Base) && (g_ui32RawRead != g_ui32RawWrite))
+		{
+			MAP_UARTCharPutNonBlocking(g_ui32Base,g_pui8RawBuffer[g_ui32RawRead % UART_RAW_BUFFER_SIZE]);
+			g_ui32RawRead++;
+		}
 
 		//
-		// If the output buffer is empty, turn off the transmit interrupt.
+		// If both output buffers are empty, turn off the transmit interrupt.
 		//
-		if(xQueueIsQueueEmptyFromISR(xCharsForTx))
+		if(xQueueIsQueueEmptyFromISR(xCharsForTx) && (g_ui32RawRead == g_ui32RawWrite))
 		{
 			MAP_UARTIntDisable(g_ui32Base, UART_INT_TX);
 		}
@@ -52,6 +52,9 @@ extern "C"
 #ifndef UART_TX_BUFFER_SIZE
 #define UART_TX_BUFFER_SIZE     256
 #endif
+#ifndef UART_RAW_BUFFER_SIZE
+#define UART_RAW_BUFFER_SIZE    512         // Of UARTwriteRaw. A power of 2.
+#endif
 
 //*****************************************************************************
 //
@@ -64,6 +67,8 @@ extern unsigned char UARTgetc(void);
 extern void UARTprintf(const char *pcString, ...);
 extern void UARTvprintf(const char *pcString, va_list vaArgP);
 extern int UARTwrite(const char *pcBuf, uint32_t ui32Len);
+extern int UARTwriteRaw(const uint8_t *pui8Buf, uint32_t ui32Len);
+extern void UARTBaudSet(uint32_t ui32Baud);
 extern void UARTFlushTx(bool bDiscard);
 extern void UARTFlushRx(void);
 extern int UARTRxBytesAvail(void);